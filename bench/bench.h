@@ -0,0 +1,46 @@
+//--------------------------------------------------------------------------
+// BENCHMARK HARNESS - Fixed-iteration timing with the platform clock
+//--------------------------------------------------------------------------
+// Each bench/bench_*.c file is its own executable. Results are printed as
+//   <name> <iterations> <ns/op>
+// so CI can collect them with a one-line awk script.
+
+#ifndef PS_BENCH_H
+#define PS_BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "platform.h"
+
+// Written by benchmark bodies so the optimizer cannot delete the work
+static volatile uint64_t g_benchSink;
+
+typedef void (*BenchFn)(void* ctx);
+
+static inline double BenchRun(const char* name, uint64_t iterations, BenchFn fn, void* ctx)
+{
+    // WARM-UP: Fault in pages and train branch predictors first
+    for (uint64_t i = 0; i < iterations / 10 + 1; i++)
+        fn(ctx);
+
+    uint64_t start = PlatMonotonicNanos();
+    for (uint64_t i = 0; i < iterations; i++)
+        fn(ctx);
+    uint64_t elapsed = PlatMonotonicNanos() - start;
+
+    double perOp = (double)elapsed / (double)iterations;
+    printf("%-44s %10llu %12.1f ns/op\n", name, (unsigned long long)iterations, perOp);
+    return perOp;
+}
+
+// Iteration count scaled by the PSL_BENCH_SCALE environment variable
+static inline uint64_t BenchIterations(uint64_t base)
+{
+    const char* scale = getenv("PSL_BENCH_SCALE");
+    double factor = scale ? atof(scale) : 1.0;
+    uint64_t n = (uint64_t)((double)base * (factor > 0 ? factor : 1.0));
+    return n ? n : 1;
+}
+
+#endif // PS_BENCH_H
@@ -0,0 +1,118 @@
+//--------------------------------------------------------------------------
+// BENCHMARK: adaptive concurrency against fixed run limits
+//--------------------------------------------------------------------------
+// Usage: bench_adaptive <fake_interpreter>
+// Two batches on the stand-in interpreter: CPU-bound runs (-CpuMs 20,
+// which only finish sooner with more CPUs) and I/O-bound runs (-SleepMs
+// 20, which overlap freely). Each runs with the limit fixed at one run
+// per CPU, at four per CPU and at 64, then adaptive with maxRuns 64. A
+// row gives throughput and the mean run's wall time, which is where an
+// oversubscribed limit shows; the adaptive rows add the time-weighted
+// mean limit, where it ended, and the throughput of the second half of
+// the batch, once the ramp is behind it. The host starts what it can after
+// every poll, as an adaptive batch must.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "engine.h"
+
+#define MAX_RUNS 64
+
+static char g_script[] = "/dev/null";
+
+typedef struct Profile
+{
+    const char* name;
+    const char* params[2];
+    int jobs;
+} Profile;
+
+typedef struct Batch
+{
+    int finished;
+    int half;
+    uint64_t halfNanos;              // When half the batch had finished
+    uint64_t wallMicros;
+} Batch;
+
+static void Finished(void* ctx, PslRun* run, const PslStats* stats)
+{
+    (void)run;
+    Batch* b = (Batch*)ctx;
+    if (++b->finished == b->half)
+        b->halfNanos = PlatMonotonicNanos();
+    b->wallMicros += stats->wallMicros;
+}
+
+static void RunBatch(const Profile* p, uint32_t maxRuns, bool adaptive)
+{
+    PslEngine* e = PslCreate(maxRuns);
+    if (!e)
+        return;
+    PslSetAdaptive(e, adaptive);
+    PslCommand cmd = { g_script, p->params, 2, NULL, 0, NULL, NULL };
+    Batch b = { 0, p->jobs / 2, 0, 0 };
+    PslCallbacks callbacks = { NULL, Finished, &b };
+    int toStart = p->jobs;
+    uint64_t start = PlatMonotonicNanos(), last = start, limitNanos = 0;
+
+    while (toStart > 0 || PslRunning(e) > 0)
+    {
+        PslRun* run;
+        while (toStart > 0 && PslStart(e, &cmd, &callbacks, &run) == PSL_OK)
+            toStart--;
+        PslPoll(e, PSL_WAIT_FOREVER);
+        uint64_t now = PlatMonotonicNanos();
+        limitNanos += (uint64_t)PslRunLimit(e) * (now - last);
+        last = now;
+    }
+    uint64_t end = PlatMonotonicNanos(), elapsed = end - start;
+
+    char name[64];
+    if (adaptive)
+        snprintf(name, sizeof(name), "adaptive/%s (max %u)", p->name, maxRuns);
+    else
+        snprintf(name, sizeof(name), "adaptive/%s (fixed %u)", p->name, maxRuns);
+    printf("%-44s %10d %12.0f runs/s %8.1f ms/run", name, b.finished,
+           elapsed > 0 ? b.finished * 1e9 / (double)elapsed : 0.0,
+           b.finished > 0 ? (double)b.wallMicros / b.finished / 1000 : 0.0);
+    if (adaptive)
+        printf("   limit mean %.1f, end %u; second half %.0f runs/s",
+               elapsed > 0 ? (double)limitNanos / (double)elapsed : 0.0, PslRunLimit(e),
+               end > b.halfNanos ? (b.finished - b.half) * 1e9 / (double)(end - b.halfNanos) : 0.0);
+    printf("\n");
+    PslDestroy(e);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: bench_adaptive <fake_interpreter>\n");
+        return 2;
+    }
+    // The engine only accepts an absolute interpreter path
+    char interpreter[4096];
+    if (!realpath(argv[1], interpreter))
+    {
+        fprintf(stderr, "cannot resolve %s\n", argv[1]);
+        return 2;
+    }
+    setenv("PS_LAUNCHER_INTERPRETER", interpreter, 1);
+
+    uint32_t cpus = PlatProcessorCount();
+    Profile profiles[] = {
+        { "cpu", { "-CpuMs", "20" }, (int)(BenchIterations(150) * cpus) },
+        { "io", { "-SleepMs", "20" }, (int)BenchIterations(1500) },
+    };
+    uint32_t fixed[] = { cpus, 4 * cpus < MAX_RUNS ? 4 * cpus : MAX_RUNS, MAX_RUNS };
+    for (size_t i = 0; i < sizeof(profiles) / sizeof(profiles[0]); i++)
+    {
+        for (size_t j = 0; j < sizeof(fixed) / sizeof(fixed[0]); j++)
+            RunBatch(&profiles[i], fixed[j], false);
+        RunBatch(&profiles[i], MAX_RUNS, true);
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+//--------------------------------------------------------------------------
+// BENCHMARK: command line building, quoting and splitting
+//--------------------------------------------------------------------------
+#include "args.h"
+#include "bench.h"
+#include "cmdline.h"
+#include "config.h"
+
+static PSCHAR* g_params[] = {
+    PS_T("-Path"), PS_T("C:\\Data\\Reports\\Quarterly Results"),
+    PS_T("-Name"), PS_T("John \"JD\" Doe"),
+    PS_T("-Count"), PS_T("-42"),
+    PS_T("-Verbose"),
+};
+
+static Arena g_arena;
+
+static void BuildTypical(void* ctx)
+{
+    LaunchArgs* args = (LaunchArgs*)ctx;
+    ArenaMark mark = ArenaSave(&g_arena);
+    StrBuf cmd;
+    if (StrBufInit(&cmd, &g_arena, 1024, PS_MAX_COMMAND_LINE))
+    {
+        BuildCommandLine(&cmd, PS_T("C:\\Windows\\System32\\WindowsPowerShell\\v1.0\\powershell.exe"),
+                         args, NULL);
+        g_benchSink += cmd.len;
+    }
+    ArenaRestore(&g_arena, mark);
+}
+
+static void SplitTypical(void* ctx)
+{
+    const PSCHAR* cmd = (const PSCHAR*)ctx;
+    PSCHAR storage[1024];
+    PSCHAR* argv[64];
+    g_benchSink += (uint64_t)SplitCommandLine(cmd, storage, argv, 64);
+}
+
+int main(void)
+{
+    LaunchArgs args = { PS_T("\\\\server\\share\\scripts\\backup.ps1"), g_params, 7 };
+    StrBuf cmd;
+
+    if (!ArenaInit(&g_arena, ARENA_DEFAULT_RESERVE) ||
+        !StrBufInit(&cmd, &g_arena, 1024, PS_MAX_COMMAND_LINE))
+        return 1;
+    BuildCommandLine(&cmd, PS_T("powershell.exe"), &args, NULL);
+
+    BenchRun("cmdline/build_typical", BenchIterations(2000000), BuildTypical, &args);
+    BenchRun("cmdline/split_typical", BenchIterations(2000000), SplitTypical, cmd.data);
+    ArenaRelease(&g_arena);
+    return 0;
+}
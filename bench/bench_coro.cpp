@@ -0,0 +1,147 @@
+//--------------------------------------------------------------------------
+// BENCHMARK: coroutine façade overhead over the raw engine
+//--------------------------------------------------------------------------
+// Usage: bench_coro <fake_interpreter>
+// Awaiting a finished task (frame allocation plus symmetric transfer),
+// one co_await Launch at a time against PslRunSync, and a WhenAll matrix
+// of 512 jobs through 64 run slots against the same batch driven by
+// engine callbacks. Runs use the stand-in interpreter on /dev/null.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "coro.hpp"
+
+using namespace ps;
+
+#define IN_FLIGHT   64
+#define MATRIX_JOBS 512
+
+static const PSCHAR g_script[] = "/dev/null";
+static EventLoop* g_loop;
+
+static Task<int> Leaf(int value)
+{
+    co_return value;
+}
+
+static Task<int> AwaitLeaves(int count)
+{
+    int sum = 0;
+    for (int i = 0; i < count; i++)
+        sum += co_await Leaf(i);
+    co_return sum;
+}
+
+static void TaskAwait(void* ctx)
+{
+    (void)ctx;
+    Task<int> task = AwaitLeaves(1000);
+    g_loop->Run(task);
+    g_benchSink = g_benchSink + (uint64_t)task.Result();
+}
+
+static Task<uint32_t> OneLaunch(EventLoop& loop)
+{
+    LaunchResult r = co_await Launch(loop, g_script, { "-Name", "bench" });
+    co_return r.stats.exitCode;
+}
+
+static void CoroLaunch(void* ctx)
+{
+    (void)ctx;
+    Task<uint32_t> task = OneLaunch(*g_loop);
+    g_loop->Run(task);
+    g_benchSink = g_benchSink + task.Result();
+}
+
+static void EngineRunSync(void* ctx)
+{
+    (void)ctx;
+    const PSCHAR* params[] = { "-Name", "bench" };
+    PslCommand cmd = { g_script, params, 2, NULL, 0, NULL, NULL };
+    PslStats stats;
+    if (PslRunSync(g_loop->Engine(), &cmd, NULL, NULL, &stats) == PSL_OK)
+        g_benchSink = g_benchSink + stats.exitCode;
+}
+
+static Task<void> AwaitAll(Task<uint32_t>* jobs, size_t count)
+{
+    co_await WhenAll(jobs, count);
+}
+
+static void Matrix(void* ctx)
+{
+    (void)ctx;
+    static Task<uint32_t> jobs[MATRIX_JOBS];
+    for (int i = 0; i < MATRIX_JOBS; i++)
+        jobs[i] = OneLaunch(*g_loop);
+    Task<void> all = AwaitAll(jobs, MATRIX_JOBS);
+    g_loop->Run(all);
+}
+
+// The same batch without coroutines: each exit starts the next run
+static int g_toStart;
+
+static void Refill(void* ctx, PslRun* run, const PslStats* stats)
+{
+    (void)ctx;
+    (void)run;
+    g_benchSink = g_benchSink + (stats ? stats->exitCode : 0);
+    if (g_toStart <= 0)
+        return;
+    const PSCHAR* params[] = { "-Name", "bench" };
+    PslCommand cmd = { g_script, params, 2, NULL, 0, NULL, NULL };
+    PslCallbacks callbacks = { NULL, Refill, NULL };
+    PslRun* next;
+    if (PslStart(g_loop->Engine(), &cmd, &callbacks, &next) == PSL_OK)
+        g_toStart--;
+}
+
+static void Callbacks(void* ctx)
+{
+    (void)ctx;
+    g_toStart = MATRIX_JOBS;
+    for (int i = 0; i < IN_FLIGHT; i++)
+        Refill(NULL, NULL, NULL);
+    while (PslRunning(g_loop->Engine()) > 0)
+        PslPoll(g_loop->Engine(), PSL_WAIT_FOREVER);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: bench_coro <fake_interpreter>\n");
+        return 2;
+    }
+    // The engine only accepts an absolute interpreter path
+    char interpreter[4096];
+    if (!realpath(argv[1], interpreter))
+    {
+        fprintf(stderr, "cannot resolve %s\n", argv[1]);
+        return 2;
+    }
+    setenv("PS_LAUNCHER_INTERPRETER", interpreter, 1);
+    EventLoop loop(IN_FLIGHT);
+    if (!loop.Valid())
+        return 1;
+    g_loop = &loop;
+
+    double perThousand =
+        BenchRun("coro/task_await (x1000, frame each)", BenchIterations(2000), TaskAwait, NULL);
+    printf("%-44s %10d %12.1f ns/await\n", "coro/task_await per await", 1000, perThousand / 1000);
+
+    uint64_t n = BenchIterations(200);
+    BenchRun("coro/launch (co_await, 1 in flight)", n, CoroLaunch, NULL);
+    BenchRun("engine/run_sync (1 in flight)", n, EngineRunSync, NULL);
+
+    double coro = BenchRun("coro/when_all (512 jobs, 64 slots)", 3, Matrix, NULL);
+    double raw = BenchRun("engine/callbacks (512 jobs, 64 slots)", 3, Callbacks, NULL);
+    printf("%-44s %10d %12.0f runs/s\n", "coro/when_all throughput", MATRIX_JOBS,
+           coro > 0 ? MATRIX_JOBS * 1e9 / coro : 0.0);
+    printf("%-44s %10d %12.0f runs/s\n", "engine/callbacks throughput", MATRIX_JOBS,
+           raw > 0 ? MATRIX_JOBS * 1e9 / raw : 0.0);
+    return 0;
+}
@@ -0,0 +1,118 @@
+//--------------------------------------------------------------------------
+// BENCHMARK: embedding API against starting the launcher executable
+//--------------------------------------------------------------------------
+// Usage: bench_engine <ps-launcher> <fake_interpreter>
+// An agent calling PslRunSync creates one process per run; one starting
+// ps-launcher creates two. Both run the stand-in interpreter, and both
+// have its output read (a pipe for the engine, /dev/null for the
+// launcher). The last line is throughput with 64 runs in flight on one
+// engine, driven by PslPoll.
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+
+#include "bench.h"
+#include "engine.h"
+
+#define IN_FLIGHT 64
+
+extern char** environ;
+
+static char g_script[] = "/dev/null";
+static const char* g_params[] = { "-Name", "bench" };
+static char** g_launcherArgv;
+static posix_spawn_file_actions_t g_quiet;
+static PslEngine* g_engine;
+
+static void CountOutput(void* ctx, PslRun* run, const void* data, size_t size)
+{
+    (void)ctx;
+    (void)run;
+    (void)data;
+    g_benchSink += size;
+}
+
+static void EngineSync(void* ctx)
+{
+    (void)ctx;
+    PslCommand cmd = { g_script, g_params, 2, NULL, 0, NULL, NULL };
+    PslStats stats;
+    if (PslRunSync(g_engine, &cmd, CountOutput, NULL, &stats) == PSL_OK)
+        g_benchSink += stats.exitCode;
+}
+
+static void ViaLauncher(void* ctx)
+{
+    (void)ctx;
+    pid_t pid;
+    int status;
+    if (posix_spawn(&pid, g_launcherArgv[0], &g_quiet, NULL, g_launcherArgv, environ) == 0)
+        waitpid(pid, &status, 0);
+}
+
+// IN_FLIGHT runs, each exit starting the next until the batch is done
+static int g_toStart;
+
+static void Refill(void* ctx, PslRun* run, const PslStats* stats)
+{
+    (void)run;
+    g_benchSink += stats->exitCode;
+    if (g_toStart <= 0)
+        return;
+    PslCommand cmd = { g_script, g_params, 2, NULL, 0, NULL, NULL };
+    PslCallbacks callbacks = { CountOutput, Refill, ctx };
+    PslRun* next;
+    if (PslStart(g_engine, &cmd, &callbacks, &next) == PSL_OK)
+        g_toStart--;
+}
+
+static void EngineAsync(void* ctx)
+{
+    g_toStart = *(int*)ctx;
+    for (int i = 0; i < IN_FLIGHT && g_toStart > 0; i++)
+        Refill(NULL, NULL, &(PslStats){ 0 });
+    while (PslRunning(g_engine) > 0)
+        PslPoll(g_engine, PSL_WAIT_FOREVER);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "usage: bench_engine <ps-launcher> <fake_interpreter>\n");
+        return 2;
+    }
+    // Both paths only accept an absolute interpreter path
+    char interpreter[4096];
+    if (!realpath(argv[2], interpreter))
+    {
+        fprintf(stderr, "cannot resolve %s\n", argv[2]);
+        return 2;
+    }
+    setenv("PS_LAUNCHER_INTERPRETER", interpreter, 1);
+    setenv("XDG_STATE_HOME", "/tmp/ps-launcher-bench", 1);
+
+    char* launcherArgv[] = { argv[1], "-Script", g_script, "-Name", "bench", NULL };
+    g_launcherArgv = launcherArgv;
+    posix_spawn_file_actions_init(&g_quiet);
+    posix_spawn_file_actions_addopen(&g_quiet, 1, "/dev/null", O_WRONLY, 0);
+    g_engine = PslCreate(IN_FLIGHT);
+    if (!g_engine)
+        return 1;
+
+    uint64_t n = BenchIterations(200);
+    BenchRun("engine/run_sync (1 process)", n, EngineSync, NULL);
+    BenchRun("engine/via_launcher (2 processes)", n, ViaLauncher, NULL);
+
+    int batch = (int)BenchIterations(512);
+    double perBatch = BenchRun("engine/async (64 in flight, per batch)", 3, EngineAsync, &batch);
+    printf("%-44s %10d %12.0f runs/s\n", "engine/async throughput", batch,
+           perBatch > 0 ? batch * 1e9 / perBatch : 0.0);
+
+    PslDestroy(g_engine);
+    posix_spawn_file_actions_destroy(&g_quiet);
+    return 0;
+}
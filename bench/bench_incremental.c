@@ -0,0 +1,91 @@
+//--------------------------------------------------------------------------
+// BENCHMARK: incremental mode change detection
+//--------------------------------------------------------------------------
+// Usage: bench_incremental [base directory]
+// 20,000 input files of 4 KB in 20 directories, matched by one "**" glob.
+// Compares the check against an up-to-date manifest (glob walk plus one
+// metadata query per file, nothing read) with the first check, which has
+// no manifest and hashes every file. Pass a directory on a network share
+// to see the round trips; the default is /tmp.
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "incremental.h"
+
+#define DIRS 20
+#define FILES_PER_DIR 1000
+#define FILE_SIZE 4096
+
+static char g_base[512];
+static char g_manifest[600];
+static PSCHAR* g_inputs[] = { "**/*.dat" };
+static const uint8_t g_scriptSha[SHA256_DIGEST_SIZE] = { 0 };
+static Arena g_arena;
+
+static void Check(void* ctx)
+{
+    (void)ctx;
+    IncrementalState state;
+    ArenaMark mark = ArenaSave(&g_arena);
+    g_benchSink += CheckIncremental(&g_arena, g_manifest, g_scriptSha, g_base, g_inputs, 1, NULL, 0, &state);
+    ArenaRestore(&g_arena, mark);
+}
+
+static void FirstCheck(void* ctx)
+{
+    unlink(g_manifest);
+    Check(ctx);
+}
+
+int main(int argc, char** argv)
+{
+    snprintf(g_base, sizeof(g_base), "%s/ps-launcher-bench-incremental",
+             argc > 1 ? argv[1] : "/tmp");
+    snprintf(g_manifest, sizeof(g_manifest), "/tmp/ps-launcher-bench.manifest");
+    mkdir(g_base, 0700);
+
+    // Written once, back-dated so identities are outside the racy window
+    static char content[FILE_SIZE];
+    struct timespec times[2] = { { 1000000000, 0 }, { 1000000000, 0 } };
+    for (int d = 0; d < DIRS; d++)
+    {
+        char path[700];
+        snprintf(path, sizeof(path), "%s/dir%02d", g_base, d);
+        mkdir(path, 0700);
+        for (int f = 0; f < FILES_PER_DIR; f++)
+        {
+            snprintf(path, sizeof(path), "%s/dir%02d/input%04d.dat", g_base, d, f);
+            if (access(path, F_OK) == 0)
+                continue;
+            snprintf(content, sizeof(content), "%d/%d", d, f);
+            FILE* file = fopen(path, "w");
+            if (file)
+            {
+                fwrite(content, 1, sizeof(content), file);
+                fclose(file);
+            }
+            utimensat(AT_FDCWD, path, times, 0);
+        }
+    }
+
+    if (!ArenaInit(&g_arena, ARENA_DEFAULT_RESERVE))
+        return 1;
+    BenchRun("incremental/first_check_20000_files", BenchIterations(3), FirstCheck, NULL);
+
+    // Record once, then every check finds the inputs unchanged
+    IncrementalState state;
+    unlink(g_manifest);
+    if (CheckIncremental(&g_arena, g_manifest, g_scriptSha, g_base, g_inputs, 1, NULL, 0, &state) !=
+            INCREMENTAL_OUT_OF_DATE || !RecordIncremental(&g_arena, &state, 0))
+        return 1;
+    BenchRun("incremental/unchanged_20000_files", BenchIterations(10), Check, NULL);
+    ArenaRelease(&g_arena);
+    unlink(g_manifest);
+    return 0;
+}
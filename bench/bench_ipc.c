@@ -0,0 +1,137 @@
+//--------------------------------------------------------------------------
+// BENCHMARK: submission protocol cost, without the runs
+//--------------------------------------------------------------------------
+// Usage: bench_ipc [endpoint]
+// A stand-in server thread answers every submission the moment it is
+// parsed, so what is measured is framing plus the local socket: one
+// submission waiting for its completion (latency), and batches of 64 per
+// flush (throughput - the way a busy client pipelines). The default
+// endpoint is /tmp/ps-launcher-bench.sock.
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "ipc.h"
+#include "psatomic.h"
+
+#define PIPELINE_DEPTH 64
+
+static const char* g_endpoint;
+static volatile uint32_t g_listening;
+static Arena g_arena;
+
+static void StandInServer(void* arg)
+{
+    (void)arg;
+    Arena arena;
+    PlatIpc listener, conn;
+    IpcWriter out;
+    static uint8_t in[IPC_MAX_FRAME];
+    size_t inLen = 0, got;
+    if (!ArenaInit(&arena, ARENA_DEFAULT_RESERVE) || !IpcWriterInit(&out, &arena, 64 * 1024) ||
+        !PlatIpcListen(&listener, g_endpoint))
+        return;
+    PsAtomicFetchAdd(&g_listening, 1);
+    if (PlatIpcAccept(&listener, &conn) != PLAT_IPC_OK)
+        return;
+
+    while (PlatIpcRead(&conn, in + inLen, sizeof(in) - inLen, PLAT_WAIT_FOREVER, &got) == PLAT_IPC_OK)
+    {
+        inLen += got;
+        size_t pos = 0, size;
+        IpcFrame frame;
+        bool bad;
+        while ((size = IpcParseFrame(in + pos, inLen - pos, &frame, &bad)) > 0)
+        {
+            IpcCompletion c = { frame.id, IPC_COMPLETED, 0, 0 };
+            IpcEncodeCompletion(&out, &c);
+            pos += size;
+        }
+        memmove(in, in + pos, inLen - pos);
+        inLen -= pos;
+        if (out.len && !PlatIpcWrite(&conn, out.data, out.len))
+            break;
+        out.len = 0;
+    }
+    PlatIpcClose(&conn);
+    PlatIpcClose(&listener);
+    ArenaRelease(&arena);
+}
+
+static char* const g_args[] = { "-Name", "John Doe", "-Verbose" };
+static char* const g_env[] = { "PS_LAUNCHER_TAG=bench" };
+
+static void Ignore(void* ctx, const IpcCompletion* c)
+{
+    (void)ctx;
+    g_benchSink += c->id;
+}
+
+static void EncodeDecode(void* ctx)
+{
+    (void)ctx;
+    static uint64_t id;
+    IpcSubmit s = { ++id, "C:\\scripts\\nightly.ps1", g_args, 3, g_env, 1, "C:\\work", NULL, NULL, NULL, NULL };
+    ArenaMark mark = ArenaSave(&g_arena);
+    IpcWriter w;
+    IpcFrame frame;
+    IpcSubmit out;
+    bool bad;
+    if (IpcWriterInit(&w, &g_arena, 256) && IpcEncodeSubmit(&w, &s) &&
+        IpcParseFrame(w.data, w.len, &frame, &bad) == w.len && IpcDecodeSubmit(&g_arena, &frame, &out))
+        g_benchSink += (uint64_t)out.argCount;
+    ArenaRestore(&g_arena, mark);
+}
+
+// Submit count, flush once, wait for every completion
+static void Batch(IpcClient* client, int count)
+{
+    static uint64_t id;
+    for (int i = 0; i < count; i++)
+    {
+        IpcSubmit s = { ++id, "C:\\scripts\\nightly.ps1", g_args, 3, g_env, 1, "C:\\work", NULL, NULL, NULL, NULL };
+        IpcClientSubmit(client, &s);
+    }
+    IpcClientFlush(client);
+    while (client->pending > 0 && IpcClientPoll(client, 5000, Ignore, NULL) > 0)
+        ;
+}
+
+static void RoundTrip(void* ctx)
+{
+    Batch((IpcClient*)ctx, 1);
+}
+
+static void Pipelined(void* ctx)
+{
+    Batch((IpcClient*)ctx, PIPELINE_DEPTH);
+}
+
+int main(int argc, char** argv)
+{
+    g_endpoint = argc > 1 ? argv[1] : "/tmp/ps-launcher-bench.sock";
+    if (!ArenaInit(&g_arena, ARENA_DEFAULT_RESERVE))
+        return 1;
+    BenchRun("ipc_encode_decode (3 args, 1 variable)", BenchIterations(1000000), EncodeDecode, NULL);
+
+    PlatThread server;
+    if (!PlatStartThread(&server, StandInServer, NULL))
+        return 1;
+    for (int i = 0; i < 500 && PsAtomicFetchAdd(&g_listening, 0) == 0; i++)
+        PlatSleepMillis(10);
+    IpcClient client;
+    if (!IpcClientConnect(&client, g_endpoint))
+        return 1;
+
+    BenchRun("ipc_round_trip (1 in flight)", BenchIterations(50000), RoundTrip, &client);
+    double perBatch = BenchRun("ipc_pipelined (64 per flush)", BenchIterations(5000), Pipelined, &client);
+    printf("%-44s %10d %12.0f submissions/s\n", "ipc_pipelined throughput", PIPELINE_DEPTH,
+           perBatch > 0 ? PIPELINE_DEPTH * 1e9 / perBatch : 0.0);
+
+    IpcClientClose(&client);
+    PlatJoinThread(&server);
+    ArenaRelease(&g_arena);
+    return 0;
+}
@@ -0,0 +1,95 @@
+//--------------------------------------------------------------------------
+// BENCHMARK: job queue - push and pop with 1k to 100k jobs pending, and
+// where an urgent job lands behind a large batch
+//--------------------------------------------------------------------------
+#include "bench.h"
+#include "jobqueue.h"
+
+#define MAX_PENDING 100000
+#define SUBMITTERS  1000
+
+static Arena g_arena;
+static JobQueue g_queue;
+static JobItem g_items[MAX_PENDING + 1];
+static uint64_t g_random = 88172645463325252ull;
+
+static uint64_t Next(void)
+{
+    g_random ^= g_random << 13;
+    g_random ^= g_random >> 7;
+    g_random ^= g_random << 17;
+    return g_random;
+}
+
+// A mix of classes, a third with deadlines, a thousand submitters
+static bool PushRandom(JobItem* item)
+{
+    uint64_t r = Next();
+    JobClass cls = (JobClass)(r % JOB_CLASSES);
+    uint64_t deadline = (r >> 8) % 3 == 0 ? (r >> 16) % 1000000 : JOB_NO_DEADLINE;
+    return JobQueuePush(&g_queue, item, cls, deadline, 1 + (r >> 32) % SUBMITTERS, 1 + (uint32_t)(r >> 48) % 4);
+}
+
+// Steady state: one out, one in
+static void PopPush(void* ctx)
+{
+    (void)ctx;
+    JobItem* item = JobQueuePop(&g_queue);
+    PushRandom(item);
+    g_benchSink += item->stamp;
+}
+
+// A job taken out from anywhere and queued again
+static void RemovePush(void* ctx)
+{
+    uint32_t pending = *(const uint32_t*)ctx;
+    JobItem* item = &g_items[Next() % pending];
+    JobQueueRemove(&g_queue, item);
+    PushRandom(item);
+    g_benchSink += item->slot;
+}
+
+int main(void)
+{
+    if (!ArenaInit(&g_arena, ARENA_DEFAULT_RESERVE) || !JobQueueInit(&g_queue, &g_arena, MAX_PENDING + 1))
+        return 1;
+
+    static const uint32_t sizes[] = { 1000, 10000, MAX_PENDING };
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        uint32_t pending = sizes[s];
+        while (JobQueuePop(&g_queue))
+            ;
+        for (uint32_t i = 0; i < pending; i++)
+            PushRandom(&g_items[i]);
+        char name[64];
+        snprintf(name, sizeof(name), "jobqueue/pop_push_%u_pending", pending);
+        BenchRun(name, BenchIterations(2000000), PopPush, NULL);
+        snprintf(name, sizeof(name), "jobqueue/remove_push_%u_pending", pending);
+        BenchRun(name, BenchIterations(2000000), RemovePush, &pending);
+    }
+
+    // A 100k-job bulk batch from one submitter, then one interactive job
+    // and one normal job from another: how many leave before each
+    while (JobQueuePop(&g_queue))
+        ;
+    for (uint32_t i = 0; i < MAX_PENDING - 1; i++)
+        JobQueuePush(&g_queue, &g_items[i], JOB_BULK, JOB_NO_DEADLINE, 1, 1);
+    JobQueuePush(&g_queue, &g_items[MAX_PENDING - 1], JOB_BULK, JOB_NO_DEADLINE, 2, 1);
+    JobQueuePush(&g_queue, &g_items[MAX_PENDING], JOB_INTERACTIVE, JOB_NO_DEADLINE, 2, 1);
+    uint32_t interactive = 0, late = 0, popped = 0;
+    JobItem* item;
+    while ((item = JobQueuePop(&g_queue)) != NULL)
+    {
+        if (item == &g_items[MAX_PENDING])
+            interactive = popped;
+        if (item == &g_items[MAX_PENDING - 1])
+            late = popped;
+        popped++;
+    }
+    printf("  behind a %u-job batch: interactive job out after %u, bulk job from another after %u\n",
+           MAX_PENDING - 1, interactive, late);
+
+    ArenaRelease(&g_arena);
+    return 0;
+}
@@ -0,0 +1,77 @@
+//--------------------------------------------------------------------------
+// BENCHMARK: end-to-end launch latency
+//--------------------------------------------------------------------------
+// Usage: bench_launch <ps-launcher> <fake_interpreter>
+// Times full launcher runs against the stand-in interpreter (so the number
+// is launcher overhead plus one process creation), and a direct spawn of
+// the interpreter for comparison.
+
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+extern char** environ;
+
+typedef struct LaunchCtx
+{
+    char** argv;
+} LaunchCtx;
+
+static void SpawnAndWait(void* ctx)
+{
+    LaunchCtx* c = (LaunchCtx*)ctx;
+    pid_t pid;
+    int status;
+    if (posix_spawn(&pid, c->argv[0], NULL, NULL, c->argv, environ) == 0)
+        waitpid(pid, &status, 0);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "usage: bench_launch <ps-launcher> <fake_interpreter>\n");
+        return 2;
+    }
+
+    // The stand-in prints its arguments; send them nowhere
+    char script[] = "/dev/null";
+    // The launcher only accepts an absolute interpreter path
+    char interpreter[4096];
+    if (!realpath(argv[2], interpreter))
+    {
+        fprintf(stderr, "cannot resolve %s\n", argv[2]);
+        return 2;
+    }
+    setenv("PS_LAUNCHER_INTERPRETER", interpreter, 1);
+    setenv("XDG_STATE_HOME", "/tmp/ps-launcher-bench", 1);
+    freopen("/dev/null", "w", stdout);
+
+    char* launcherArgv[] = { argv[1], "-Script", script, "-Name", "bench", NULL };
+    char* directArgv[] = { argv[2], "-File", script, "-Name", "bench", NULL };
+    LaunchCtx launcher = { launcherArgv };
+    LaunchCtx direct = { directArgv };
+
+    // Results go to stderr because stdout is discarded
+    uint64_t n = BenchIterations(200);
+    uint64_t start = PlatMonotonicNanos();
+    for (uint64_t i = 0; i < n; i++)
+        SpawnAndWait(&direct);
+    double directUs = (double)(PlatMonotonicNanos() - start) / (double)n / 1000.0;
+
+    start = PlatMonotonicNanos();
+    for (uint64_t i = 0; i < n; i++)
+        SpawnAndWait(&launcher);
+    double launcherUs = (double)(PlatMonotonicNanos() - start) / (double)n / 1000.0;
+
+    fprintf(stderr, "%-44s %10llu %12.1f us/op\n", "launch/direct_interpreter",
+            (unsigned long long)n, directUs);
+    fprintf(stderr, "%-44s %10llu %12.1f us/op\n", "launch/via_launcher",
+            (unsigned long long)n, launcherUs);
+    return 0;
+}
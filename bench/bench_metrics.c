@@ -0,0 +1,103 @@
+//--------------------------------------------------------------------------
+// BENCHMARK: histogram recording, series lookup and exposition
+//--------------------------------------------------------------------------
+// Usage: bench_metrics
+// A private table under /tmp with 200 series. "record" is the atomic add
+// every launch pays per metric; "find+record" adds the series lookup; the
+// last lines are what -Metrics costs before printing, and the Prometheus
+// text written to /dev/null. "writer busy" records while a thread adds to
+// the same histogram without pause.
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "metrics.h"
+#include "psatomic.h"
+
+static MetricsStore g_store;
+static Histogram* g_hist;
+static Arena g_arena;
+static char g_path[64];
+static volatile uint32_t g_stop;
+static PlatFile g_null;
+
+static void Record(void* ctx)
+{
+    (void)ctx;
+    HistogramRecord(g_hist, g_benchSink++ & 0xFFFFF);
+}
+
+static void FindRecord(void* ctx)
+{
+    Histogram* h = MetricsFind(&g_store, (const char*)ctx, EXIT_CLASS_OK, METRIC_DURATION, NULL);
+    HistogramRecord(h, g_benchSink++ & 0xFFFFF);
+}
+
+static void Merge(void* ctx)
+{
+    (void)ctx;
+    MetricsSet set;
+    ArenaRestore(&g_arena, 0);
+    if (MetricsSetInit(&set, &g_arena, METRICS_SLOTS) && MetricsSetMerge(&set, g_store.shared.base, g_store.shared.size))
+        g_benchSink += set.count;
+}
+
+static void Expose(void* ctx)
+{
+    (void)ctx;
+    MetricsSet set;
+    ArenaRestore(&g_arena, 0);
+    if (MetricsSetInit(&set, &g_arena, METRICS_SLOTS) && MetricsSetMerge(&set, g_store.shared.base, g_store.shared.size))
+        g_benchSink += MetricsFormatPrometheus(&g_arena, &set, g_null);
+}
+
+static void Writer(void* arg)
+{
+    (void)arg;
+    for (uint64_t v = 0; !PsAtomicLoad(&g_stop); v++)
+        HistogramRecord(g_hist, v & 0xFFFFF);
+}
+
+int main(void)
+{
+    snprintf(g_path, sizeof(g_path), "/tmp/psl-metrics-bench-%d", (int)getpid());
+    if (!MetricsOpen(&g_store, g_path) || !ArenaInit(&g_arena, 64 << 20))
+    {
+        fprintf(stderr, "cannot create the table\n");
+        return 1;
+    }
+    g_null = (PlatFile)open("/dev/null", O_WRONLY);
+    char name[64];
+    for (int i = 0; i < 200; i++)
+    {
+        snprintf(name, sizeof(name), "/srv/jobs/job-%03d.ps1", i);
+        for (int k = 0; k < METRIC_KINDS; k++)
+        {
+            Histogram* h = MetricsFind(&g_store, name, (ExitClass)(i % 3), (MetricKind)k, NULL);
+            for (uint64_t v = 1; v < 5000; v += 7)
+                HistogramRecord(h, v * (uint64_t)(i + 1));
+        }
+    }
+    g_hist = MetricsFind(&g_store, "/srv/jobs/nightly-report.ps1", EXIT_CLASS_OK, METRIC_DURATION, NULL);
+
+    uint64_t n = BenchIterations(1000000);
+    BenchRun("metrics/record", n, Record, NULL);
+    BenchRun("metrics/find+record (200 series)", n / 10, FindRecord, "/srv/jobs/nightly-report.ps1");
+    PlatThread writer;
+    if (PlatStartThread(&writer, Writer, NULL))
+    {
+        BenchRun("metrics/record (writer busy)", n, Record, NULL);
+        PsAtomicStore(&g_stop, 1);
+        PlatJoinThread(&writer);
+    }
+    BenchRun("metrics/merge table (201 series)", n / 1000, Merge, NULL);
+    BenchRun("metrics/prometheus text (201 series)", n / 10000, Expose, NULL);
+
+    close((int)g_null);
+    ArenaRelease(&g_arena);
+    MetricsClose(&g_store);
+    unlink(g_path);
+    return 0;
+}
@@ -0,0 +1,154 @@
+//--------------------------------------------------------------------------
+// BENCHMARK: embedded script payload
+//--------------------------------------------------------------------------
+// Usage: bench_payload <ps-launcher> <fake_interpreter> [script]
+// Codec throughput on a generated script, then launch latency for the same
+// script run from a file (-Script <path>) and embedded in a packed copy of
+// the launcher (-Pack). Pass a script on a network share (SMB/NFS mount)
+// as the third argument to measure what the packed launcher saves there;
+// without it the script is a local file in /tmp, the best case for -Script.
+
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "lz.h"
+
+extern char** environ;
+
+#define SCRIPT_SIZE 32768
+
+static uint8_t g_script[SCRIPT_SIZE];
+static uint8_t g_packed[LZ_COMPRESS_BOUND(SCRIPT_SIZE)];
+static uint8_t g_unpacked[SCRIPT_SIZE];
+static uint32_t g_workspace[LZ_WORKSPACE_SIZE / 4];
+static size_t g_packedSize;
+
+static void GenerateScript(void)
+{
+    static const char* const lines[] = {
+        "param([string]$Path, [int]$Retries = 3)\r\n",
+        "$items = Get-ChildItem -Path $Path -Recurse -File\r\n",
+        "foreach ($item in $items) {\r\n",
+        "    Write-Verbose \"Processing $($item.FullName)\"\r\n",
+        "    if ($item.Length -gt 1MB) { Compress-Archive -Path $item.FullName -Update }\r\n",
+        "}\r\n",
+        "# Retry loop for transient failures on the share\r\n",
+        "for ($i = 0; $i -lt $Retries; $i++) { Start-Sleep -Milliseconds (100 * $i) }\r\n",
+    };
+    // Numbered step comments keep it from being unrealistically repetitive
+    size_t pos = 0;
+    for (unsigned i = 0; pos < SCRIPT_SIZE; i++)
+    {
+        char line[160];
+        int len = snprintf(line, sizeof(line), "# step %u\r\n%s", i * 37 % 1009, lines[(i * 7) % 8]);
+        for (int j = 0; j < len && pos < SCRIPT_SIZE; j++)
+            g_script[pos++] = (uint8_t)line[j];
+    }
+}
+
+static void Compress(void* ctx)
+{
+    (void)ctx;
+    g_packedSize = LzCompress(g_script, SCRIPT_SIZE, g_packed, sizeof(g_packed), g_workspace);
+    g_benchSink += g_packedSize;
+}
+
+static void Decompress(void* ctx)
+{
+    (void)ctx;
+    g_benchSink += LzDecompress(g_packed, g_packedSize, g_unpacked, SCRIPT_SIZE);
+}
+
+static int Run(char** argv)
+{
+    pid_t pid;
+    int status = -1;
+    if (posix_spawn(&pid, argv[0], NULL, NULL, argv, environ) != 0)
+        return -1;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+static double LaunchMicros(char** argv, uint64_t n)
+{
+    uint64_t start = PlatMonotonicNanos();
+    for (uint64_t i = 0; i < n; i++)
+        Run(argv);
+    return (double)(PlatMonotonicNanos() - start) / (double)n / 1000.0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3 && argc != 4)
+    {
+        fprintf(stderr, "usage: bench_payload <ps-launcher> <fake_interpreter> [script]\n");
+        return 2;
+    }
+
+    //----------------------------------------------------------------------
+    // CODEC
+    //----------------------------------------------------------------------
+    GenerateScript();
+    uint64_t n = BenchIterations(2000);
+    double compressNs = BenchRun("lz/compress_32k_script", n, Compress, NULL);
+    double decompressNs = BenchRun("lz/decompress_32k_script", n, Decompress, NULL);
+    printf("lz: %zu -> %zu bytes (%.2fx), %.0f MB/s compress, %.0f MB/s decompress\n",
+           (size_t)SCRIPT_SIZE, g_packedSize, (double)SCRIPT_SIZE / (double)g_packedSize,
+           SCRIPT_SIZE / compressNs * 1000.0, SCRIPT_SIZE / decompressNs * 1000.0);
+    fflush(stdout);
+
+    //----------------------------------------------------------------------
+    // LAUNCH: script file vs embedded
+    //----------------------------------------------------------------------
+    // The launcher only accepts an absolute interpreter path
+    char interpreter[4096];
+    if (!realpath(argv[2], interpreter))
+    {
+        fprintf(stderr, "cannot resolve %s\n", argv[2]);
+        return 2;
+    }
+    setenv("PS_LAUNCHER_INTERPRETER", interpreter, 1);
+    setenv("XDG_STATE_HOME", "/tmp/ps-launcher-bench", 1);
+
+    char script[4096] = "/tmp/ps-launcher-bench-script.ps1";
+    if (argc == 4)
+        snprintf(script, sizeof(script), "%s", argv[3]);
+    else
+    {
+        FILE* f = fopen(script, "wb");
+        if (!f || fwrite(g_script, 1, SCRIPT_SIZE, f) != SCRIPT_SIZE)
+            return 1;
+        fclose(f);
+    }
+
+    char packed[] = "/tmp/ps-launcher-bench-packed";
+    char* packArgv[] = { argv[1], "-Pack", packed, script, NULL };
+    if (Run(packArgv) != 0)
+    {
+        fprintf(stderr, "packing %s failed\n", script);
+        return 1;
+    }
+
+    // The stand-in echoes the script; send it nowhere
+    freopen("/dev/null", "w", stdout);
+    char* fileArgv[] = { argv[1], "-Script", script, "-Name", "bench", NULL };
+    char* embeddedArgv[] = { packed, "-Name", "bench", NULL };
+    n = BenchIterations(200);
+    LaunchMicros(fileArgv, n / 10 + 1);           // Warm-up: page cache, state dir
+    LaunchMicros(embeddedArgv, n / 10 + 1);
+    double fileUs = LaunchMicros(fileArgv, n);
+    double embeddedUs = LaunchMicros(embeddedArgv, n);
+
+    // Results go to stderr because stdout is discarded
+    fprintf(stderr, "%-44s %10llu %12.1f us/op\n", "launch/script_file",
+            (unsigned long long)n, fileUs);
+    fprintf(stderr, "%-44s %10llu %12.1f us/op\n", "launch/embedded_payload",
+            (unsigned long long)n, embeddedUs);
+    unlink(packed);
+    return 0;
+}
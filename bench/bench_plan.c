@@ -0,0 +1,223 @@
+//--------------------------------------------------------------------------
+// BENCHMARK: batch makespan, as given against longest/critical path first
+//--------------------------------------------------------------------------
+// Usage: bench_plan <fake_interpreter> [journal]
+// Simulated (plan.h, every job taking exactly its expected time) on 2 to
+// 16 slots, each row the makespan in the order given (FIFO), ordered by
+// history, and the lower bound neither can beat - the longer of the
+// longest chain and the total work spread evenly:
+//   journal  the completed runs of a run journal, in journal order, each
+//            taking as long as it did (with a journal argument)
+//   tail     200 five-second jobs, then 4 ten-minute ones
+//   dag      pipelines of fetch, build and test after 100 ten-second jobs
+// Then real batches on the stand-in interpreter through PslRunBatch:
+// 40 short runs and 2 long ones last, 4 at a time, with a journal written
+// first so the engine knows which is which.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "engine.h"
+#include "plan.h"
+
+#define SECONDS        1000000ull
+#define MAX_JOURNAL    16384
+#define SHORT_RUNS     40
+#define LONG_RUNS      2
+
+static Arena g_arena;
+
+static void Simulate(const char* name, const PlanJob* jobs, uint32_t count)
+{
+    uint64_t total = 0, chain = 0;
+    PlanGraph g;
+    ArenaMark mark = ArenaSave(&g_arena);
+    if (PlanBuild(&g, &g_arena, jobs, count, true) != PLAN_OK)
+        return;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        total += jobs[i].micros;
+        if (g.rank[i] > chain)
+            chain = g.rank[i];
+    }
+    ArenaRestore(&g_arena, mark);
+
+    static const uint32_t slots[] = { 2, 4, 8, 16 };
+    for (size_t i = 0; i < sizeof(slots) / sizeof(slots[0]); i++)
+    {
+        uint64_t fifo = 0, ranked = 0;
+        PlanSimulate(&g_arena, jobs, count, slots[i], false, &fifo);
+        PlanSimulate(&g_arena, jobs, count, slots[i], true, &ranked);
+        uint64_t bound = total / slots[i] > chain ? total / slots[i] : chain;
+        char label[64];
+        snprintf(label, sizeof(label), "plan/%s (%u jobs, %u slots)", name, count, slots[i]);
+        printf("%-44s fifo %9.1f s   history %9.1f s   bound %9.1f s   %5.1f%% shorter\n", label,
+               fifo / 1e6, ranked / 1e6, bound / 1e6, fifo > 0 ? 100.0 * (double)(fifo - ranked) / (double)fifo : 0.0);
+    }
+}
+
+// Completed runs of the journal in order, each as long as it took
+static void SimulateJournal(const char* path)
+{
+    FILE* f = fopen(path, "r");
+    if (!f)
+    {
+        fprintf(stderr, "cannot read %s\n", path);
+        return;
+    }
+    // The newest MAX_JOURNAL runs, in a ring until the end
+    uint64_t* ring = (uint64_t*)ArenaAlloc(&g_arena, MAX_JOURNAL * sizeof(uint64_t));
+    PlanJob* jobs = (PlanJob*)ArenaAlloc(&g_arena, MAX_JOURNAL * sizeof(PlanJob));
+    uint64_t seen = 0;
+    char line[4096];
+    while (ring && jobs && fgets(line, sizeof(line), f))
+    {
+        char* fields[4];
+        char* p = line;
+        int n = 0;
+        while (n < 4 && p)
+            fields[n++] = strsep(&p, "\t");
+        if (n == 4 && p && strcmp(fields[3], "completed") == 0)
+            ring[seen++ % MAX_JOURNAL] = strtoull(fields[1], NULL, 10);
+    }
+    fclose(f);
+    uint32_t count = seen < MAX_JOURNAL ? (uint32_t)seen : MAX_JOURNAL;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        PlanJob job = { ring[(seen - count + i) % MAX_JOURNAL], NULL, 0 };
+        jobs[i] = job;
+    }
+    if (count > 0)
+        Simulate("journal", jobs, count);
+}
+
+static void SimulateTail(void)
+{
+    PlanJob jobs[204];
+    for (uint32_t i = 0; i < 204; i++)
+    {
+        PlanJob job = { i < 200 ? 5 * SECONDS : 600 * SECONDS, NULL, 0 };
+        jobs[i] = job;
+    }
+    Simulate("tail", jobs, 204);
+}
+
+static void SimulateDag(void)
+{
+    // 100 independent jobs, then 8 pipelines of three whose builds vary
+    enum { INDEPENDENT = 100, PIPELINES = 8, COUNT = INDEPENDENT + 3 * PIPELINES };
+    static uint32_t edges[2 * PIPELINES];
+    PlanJob jobs[COUNT];
+    for (uint32_t i = 0; i < INDEPENDENT; i++)
+    {
+        PlanJob job = { 10 * SECONDS, NULL, 0 };
+        jobs[i] = job;
+    }
+    for (uint32_t p = 0; p < PIPELINES; p++)
+    {
+        uint32_t fetch = INDEPENDENT + 3 * p;
+        edges[2 * p] = fetch;
+        edges[2 * p + 1] = fetch + 1;
+        PlanJob stages[3] = { { 5 * SECONDS, NULL, 0 },
+                              { (30 + 40 * (uint64_t)p) * SECONDS, &edges[2 * p], 1 },
+                              { 60 * SECONDS, &edges[2 * p + 1], 1 } };
+        memcpy(&jobs[fetch], stages, sizeof(stages));
+    }
+    Simulate("dag", jobs, COUNT);
+}
+
+//--------------------------------------------------------------------------
+// REAL BATCHES
+//--------------------------------------------------------------------------
+static void RunBatches(void)
+{
+    char dir[] = "/tmp/psl-plan-XXXXXX";
+    if (!mkdtemp(dir))
+        return;
+    char state[64], journalDir[96], journal[128], shortScript[64], longScript[64];
+    snprintf(state, sizeof(state), "%s/state", dir);
+    snprintf(journalDir, sizeof(journalDir), "%s/ps-launcher", state);
+    snprintf(journal, sizeof(journal), "%s/ps-launcher.runs", journalDir);
+    snprintf(shortScript, sizeof(shortScript), "%s/short.ps1", dir);
+    snprintf(longScript, sizeof(longScript), "%s/long.ps1", dir);
+    mkdir(state, 0700);
+    mkdir(journalDir, 0700);
+    setenv("XDG_STATE_HOME", state, 1);
+    FILE* f = fopen(journal, "w");
+    if (f)
+    {
+        fprintf(f, "0\t20000\t0\tcompleted\t%s\n0\t500000\t0\tcompleted\t%s\n", shortScript, longScript);
+        fclose(f);
+    }
+    const char* scripts[] = { shortScript, longScript };
+    for (int i = 0; i < 2; i++)
+    {
+        f = fopen(scripts[i], "w");
+        if (f)
+            fclose(f);
+    }
+
+    static const char* shortParams[] = { "-SleepMs", "20" };
+    static const char* longParams[] = { "-SleepMs", "500" };
+    PslJob jobs[SHORT_RUNS + LONG_RUNS];
+    PslJobResult results[SHORT_RUNS + LONG_RUNS];
+    memset(jobs, 0, sizeof(jobs));
+    for (uint32_t i = 0; i < SHORT_RUNS + LONG_RUNS; i++)
+    {
+        bool isLong = i >= SHORT_RUNS;
+        jobs[i].command.script = isLong ? longScript : shortScript;
+        jobs[i].command.params = isLong ? longParams : shortParams;
+        jobs[i].command.paramCount = 2;
+    }
+
+    PslEngine* e = PslCreate(4);
+    static const PslOrder orders[] = { PSL_ORDER_FIFO, PSL_ORDER_HISTORY };
+    static const char* names[] = { "plan/engine batch (fifo)", "plan/engine batch (history)" };
+    for (int i = 0; e && i < 2; i++)
+    {
+        uint64_t start = PlatMonotonicNanos();
+        PslStatus status = PslRunBatch(e, jobs, SHORT_RUNS + LONG_RUNS, orders[i], results);
+        uint64_t elapsed = PlatMonotonicNanos() - start;
+        printf("%-44s %10d %12.1f ms makespan%s\n", names[i], SHORT_RUNS + LONG_RUNS, elapsed / 1e6,
+               status == PSL_OK ? "" : " (failed)");
+    }
+    PslDestroy(e);
+
+    unlink(journal);
+    unlink(shortScript);
+    unlink(longScript);
+    rmdir(journalDir);
+    rmdir(state);
+    rmdir(dir);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: bench_plan <fake_interpreter> [journal]\n");
+        return 2;
+    }
+    // The engine only accepts an absolute interpreter path
+    char interpreter[4096];
+    if (!realpath(argv[1], interpreter))
+    {
+        fprintf(stderr, "cannot resolve %s\n", argv[1]);
+        return 2;
+    }
+    setenv("PS_LAUNCHER_INTERPRETER", interpreter, 1);
+    if (!ArenaInit(&g_arena, ARENA_DEFAULT_RESERVE))
+        return 1;
+
+    if (argc > 2)
+        SimulateJournal(argv[2]);
+    SimulateTail();
+    SimulateDag();
+    RunBatches();
+    ArenaRelease(&g_arena);
+    return 0;
+}
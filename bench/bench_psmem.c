@@ -0,0 +1,93 @@
+//--------------------------------------------------------------------------
+// BENCHMARK: psmem.c primitives against the C library
+//--------------------------------------------------------------------------
+// Sizes cover what the launcher actually handles: switch names (8), typical
+// parameters (64), MAX_PATH (260 chars) and a full command line buffer.
+
+#include <string.h>
+
+#include "bench.h"
+#include "psmem.h"
+
+typedef struct MemCtx
+{
+    unsigned char* dst;
+    unsigned char* src;
+    size_t size;
+} MemCtx;
+
+static void* (*volatile g_libcMemSet)(void*, int, size_t) = memset;
+static void* (*volatile g_libcMemCpy)(void*, const void*, size_t) = memcpy;
+static void* (*volatile g_libcMemChr)(const void*, int, size_t) = (void* (*)(const void*, int, size_t))memchr;
+static size_t (*volatile g_libcStrLen)(const char*) = strlen;
+static int (*volatile g_libcStrCmp)(const char*, const char*) = strcmp;
+
+static void PsSet(void* p)  { MemCtx* c = p; PsMemSet(c->dst, 1, c->size); g_benchSink += c->dst[0]; }
+static void LibSet(void* p) { MemCtx* c = p; g_libcMemSet(c->dst, 1, c->size); g_benchSink += c->dst[0]; }
+static void PsCpy(void* p)  { MemCtx* c = p; PsMemCpy(c->dst, c->src, c->size); g_benchSink += c->dst[0]; }
+static void LibCpy(void* p) { MemCtx* c = p; g_libcMemCpy(c->dst, c->src, c->size); g_benchSink += c->dst[0]; }
+static void PsChr(void* p)  { MemCtx* c = p; g_benchSink += (uintptr_t)PsMemChr(c->src, ';', c->size); }
+static void LibChr(void* p) { MemCtx* c = p; g_benchSink += (uintptr_t)g_libcMemChr(c->src, ';', c->size); }
+static void PsLen(void* p)  { MemCtx* c = p; g_benchSink += PsStrLen8((const char*)c->src); }
+static void LibLen(void* p) { MemCtx* c = p; g_benchSink += g_libcStrLen((const char*)c->src); }
+static void PsCmp(void* p)  { MemCtx* c = p; g_benchSink += (uint64_t)PsStrCmp8((const char*)c->src, (const char*)c->dst); }
+static void LibCmp(void* p) { MemCtx* c = p; g_benchSink += (uint64_t)g_libcStrCmp((const char*)c->src, (const char*)c->dst); }
+
+static void PsLen16(void* p)
+{
+    MemCtx* c = p;
+    g_benchSink += PsStrLen16((const uint16_t*)c->dst);
+}
+
+static void ScalarLen16(void* p)
+{
+    MemCtx* c = p;
+    const volatile uint16_t* s = (const uint16_t*)c->dst;
+    size_t n = 0;
+    while (s[n])
+        n++;
+    g_benchSink += n;
+}
+
+int main(void)
+{
+    static unsigned char dst[8192 + 64];
+    static unsigned char src[8192 + 64];
+    static const size_t sizes[] = { 8, 64, 260, 2048 };
+    char name[64];
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        size_t n = sizes[i];
+        uint64_t iters = BenchIterations(n < 256 ? 5000000 : 1000000);
+        MemCtx ctx = { dst + 1, src + 3, n };   // Deliberately misaligned
+
+        memset(src, 'a', sizeof(src));
+        src[3 + n] = 0;
+        memset(dst, 'a', sizeof(dst));
+        dst[1 + n] = 0;
+
+        snprintf(name, sizeof(name), "memset/%zu/ps", n);    BenchRun(name, iters, PsSet, &ctx);
+        snprintf(name, sizeof(name), "memset/%zu/libc", n);  BenchRun(name, iters, LibSet, &ctx);
+        dst[1 + n] = 0;
+        snprintf(name, sizeof(name), "memcpy/%zu/ps", n);    BenchRun(name, iters, PsCpy, &ctx);
+        snprintf(name, sizeof(name), "memcpy/%zu/libc", n);  BenchRun(name, iters, LibCpy, &ctx);
+        dst[1 + n] = 0;
+        snprintf(name, sizeof(name), "memchr/%zu/ps", n);    BenchRun(name, iters, PsChr, &ctx);
+        snprintf(name, sizeof(name), "memchr/%zu/libc", n);  BenchRun(name, iters, LibChr, &ctx);
+        snprintf(name, sizeof(name), "strlen/%zu/ps", n);    BenchRun(name, iters, PsLen, &ctx);
+        snprintf(name, sizeof(name), "strlen/%zu/libc", n);  BenchRun(name, iters, LibLen, &ctx);
+        snprintf(name, sizeof(name), "strcmp/%zu/ps", n);    BenchRun(name, iters, PsCmp, &ctx);
+        snprintf(name, sizeof(name), "strcmp/%zu/libc", n);  BenchRun(name, iters, LibCmp, &ctx);
+
+        // UTF-16 strings (the Windows PSCHAR) against the old scalar loop
+        MemCtx wide = { dst, src, n };
+        uint16_t* w = (uint16_t*)dst;
+        for (size_t k = 0; k < n; k++)
+            w[k] = 'a';
+        w[n] = 0;
+        snprintf(name, sizeof(name), "strlen16/%zu/ps", n);     BenchRun(name, iters, PsLen16, &wide);
+        snprintf(name, sizeof(name), "strlen16/%zu/scalar", n); BenchRun(name, iters, ScalarLen16, &wide);
+    }
+    return 0;
+}
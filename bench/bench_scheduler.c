@@ -0,0 +1,139 @@
+//--------------------------------------------------------------------------
+// BENCHMARK: resident scheduler - schedule parsing, cron matching and the
+// timer wheel with thousands of entries
+//--------------------------------------------------------------------------
+#include "bench.h"
+#include "cron.h"
+#include "psmem.h"
+#include "psstr.h"
+#include "scheduler.h"
+#include "strbuf.h"
+#include "timerwheel.h"
+
+#define ENTRY_COUNT 10000
+#define DAY_SECONDS 86400
+
+static Arena g_arena;
+static PSCHAR* g_text;
+static size_t g_textLen;
+static Schedule g_schedule;
+static TimerWheel g_wheel;
+static uint64_t g_wakes;
+static uint64_t g_fires;
+
+static const PSCHAR* const g_forms[] = {
+    PS_T("*/5 * * * *"), PS_T("0 * * * *"), PS_T("15,45 8-18 * * mon-fri"),
+    PS_T("@daily"), PS_T("@every 90s"), PS_T("@every 17m"), PS_T("30 2 1 * *"),
+    PS_T("*/2 9-17 * * *"),
+};
+
+static void ParseEntries(void* ctx)
+{
+    (void)ctx;
+    ArenaMark mark = ArenaSave(&g_arena);
+    PSCHAR* copy = (PSCHAR*)ArenaAlloc(&g_arena, (g_textLen + 1) * sizeof(PSCHAR));
+    PsMemCpy(copy, g_text, (g_textLen + 1) * sizeof(PSCHAR));
+    Schedule s;
+    g_benchSink += ParseSchedule(&g_arena, copy, g_textLen, &s) ? s.count : 0;
+    ArenaRestore(&g_arena, mark);
+}
+
+static void NextMatch(void* ctx)
+{
+    static int64_t minute = 28000000;
+    static uint32_t i;
+    const Schedule* s = (const Schedule*)ctx;
+    const ScheduleEntry* e = &s->entries[i++ % 8];
+    int64_t next = 0;
+    CronNext(&e->cron, minute, &next);
+    minute += 7;
+    g_benchSink += (uint64_t)next;
+}
+
+static void AddCancel(void* ctx)
+{
+    static TimerNode node;
+    static uint64_t delta;
+    (void)ctx;
+    delta = delta * 6364136223846793005ull + 1442695040888963407ull;
+    TimerWheelAdd(&g_wheel, &node, g_wheel.now + 1 + (delta >> 40) % DAY_SECONDS);
+    TimerWheelCancel(&g_wheel, &node);
+    g_benchSink += g_wheel.count;
+}
+
+// One day of the whole schedule: sleep to the next expiry, fire, re-arm
+// (UTC local time, no processes)
+static void SimulateDay(void* ctx)
+{
+    (void)ctx;
+    uint64_t start = 1710460800;            // 2024-03-15 00:00 UTC
+    TimerWheelInit(&g_wheel, start);
+    for (uint32_t i = 0; i < g_schedule.count; i++)
+    {
+        ScheduleEntry* e = &g_schedule.entries[i];
+        e->timer.pprev = NULL;
+        TimerWheelAdd(&g_wheel, &e->timer, ScheduleNextRun(e, start));
+    }
+
+    uint64_t now = start;
+    uint64_t due;
+    while (TimerWheelNextExpiry(&g_wheel, &due) && due < start + DAY_SECONDS)
+    {
+        now = due;
+        g_wakes++;
+        for (TimerNode* node = TimerWheelAdvance(&g_wheel, now); node;)
+        {
+            TimerNode* next = node->next;
+            ScheduleEntry* e = (ScheduleEntry*)node;
+            uint64_t at = e->everySeconds ? e->timer.expires + e->everySeconds : ScheduleNextRun(e, now);
+            if (at)
+                TimerWheelAdd(&g_wheel, &e->timer, at);
+            g_fires++;
+            node = next;
+        }
+    }
+    g_benchSink += now;
+}
+
+int main(void)
+{
+    if (!ArenaInit(&g_arena, ARENA_DEFAULT_RESERVE))
+        return 1;
+
+    StrBuf text;
+    if (!StrBufInit(&text, &g_arena, 1 << 20, STRBUF_NO_LIMIT))
+        return 1;
+    for (uint32_t i = 0; i < ENTRY_COUNT; i++)
+    {
+        StrBufAppend(&text, g_forms[i % 8]);
+        StrBufAppend(&text, PS_T(" -Script @job"));
+        StrBufAppendUInt(&text, i);
+        StrBufAppend(&text, PS_T(" -Region west\n"));
+    }
+    g_text = text.data;
+    g_textLen = text.len;
+
+    PSCHAR* copy = (PSCHAR*)ArenaAlloc(&g_arena, (g_textLen + 1) * sizeof(PSCHAR));
+    PsMemCpy(copy, g_text, (g_textLen + 1) * sizeof(PSCHAR));
+    if (!ParseSchedule(&g_arena, copy, g_textLen, &g_schedule) || g_schedule.count != ENTRY_COUNT)
+        return 1;
+
+    BenchRun("scheduler/parse_10000_entries", BenchIterations(20), ParseEntries, NULL);
+    BenchRun("scheduler/cron_next", BenchIterations(2000000), NextMatch, &g_schedule);
+
+    // Single add + cancel with the whole schedule in the wheel
+    TimerWheelInit(&g_wheel, 1710460800);
+    for (uint32_t i = 0; i < g_schedule.count; i++)
+        TimerWheelAdd(&g_wheel, &g_schedule.entries[i].timer, 1710460800 + 1 + i * 7);
+    BenchRun("scheduler/wheel_add_cancel_10000_pending", BenchIterations(5000000), AddCancel, NULL);
+
+    g_wakes = g_fires = 0;
+    double perDay = BenchRun("scheduler/simulated_day_10000_entries", BenchIterations(3), SimulateDay, NULL);
+    uint64_t runs = BenchIterations(3) + BenchIterations(3) / 10 + 1;
+    printf("  %llu runs and %llu wakes per simulated day, %.1f ns per run\n",
+           (unsigned long long)(g_fires / runs), (unsigned long long)(g_wakes / runs),
+           perDay / (double)(g_fires / runs));
+
+    ArenaRelease(&g_arena);
+    return 0;
+}
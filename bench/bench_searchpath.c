@@ -0,0 +1,103 @@
+//--------------------------------------------------------------------------
+// BENCHMARK: script search path
+//--------------------------------------------------------------------------
+// Usage: bench_searchpath [base directory]
+// Ten search directories of 200 scripts each, the wanted script in the
+// last one. Compares a lookup through the listing cache (one stamp query
+// per directory) with probing for the script in every directory, and
+// with a cold cache (every directory listed). Pass a directory on a
+// network share to see the round trips; the default is /tmp.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "searchpath.h"
+
+#define DIRS 10
+#define FILES_PER_DIR 200
+
+static char g_base[512];
+static char g_path[DIRS * 600];
+static char g_cache[600];
+static Arena g_arena;
+
+static void Cached(void* ctx)
+{
+    (void)ctx;
+    SearchStats stats;
+    ArenaMark mark = ArenaSave(&g_arena);
+    g_benchSink += SearchScriptPath(&g_arena, g_path, g_cache, "wanted.ps1", &stats) != NULL;
+    ArenaRestore(&g_arena, mark);
+}
+
+static void Cold(void* ctx)
+{
+    unlink(g_cache);
+    Cached(ctx);
+}
+
+// What the launcher would do without the cache: try each directory
+static void Probe(void* ctx)
+{
+    (void)ctx;
+    char path[700];
+    for (int d = 0; d < DIRS; d++)
+    {
+        snprintf(path, sizeof(path), "%s/dir%d/wanted.ps1", g_base, d);
+        if (PlatFileExists(path))
+        {
+            g_benchSink++;
+            break;
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    snprintf(g_base, sizeof(g_base), "%s/ps-launcher-bench-searchpath",
+             argc > 1 ? argv[1] : "/tmp");
+    snprintf(g_cache, sizeof(g_cache), "/tmp/ps-launcher-bench.dircache");
+    mkdir(g_base, 0700);
+
+    size_t pos = 0;
+    for (int d = 0; d < DIRS; d++)
+    {
+        char path[700];
+        snprintf(path, sizeof(path), "%s/dir%d", g_base, d);
+        mkdir(path, 0700);
+        for (int f = 0; f < FILES_PER_DIR; f++)
+        {
+            snprintf(path, sizeof(path), "%s/dir%d/task%03d.ps1", g_base, d, f);
+            FILE* file = fopen(path, "w");
+            if (file)
+                fclose(file);
+        }
+        pos += (size_t)snprintf(g_path + pos, sizeof(g_path) - pos, "%s%s/dir%d",
+                                d ? ":" : "", g_base, d);
+    }
+    char wanted[700];
+    snprintf(wanted, sizeof(wanted), "%s/dir%d/wanted.ps1", g_base, DIRS - 1);
+    FILE* file = fopen(wanted, "w");
+    if (file)
+        fclose(file);
+
+    // Let the directories age past the racy window so listings are kept
+    printf("waiting for directory stamps to settle...\n");
+    fflush(stdout);
+    sleep(3);
+
+    if (!ArenaInit(&g_arena, ARENA_DEFAULT_RESERVE))
+        return 1;
+    uint64_t n = BenchIterations(5000);
+    unlink(g_cache);
+    BenchRun("searchpath/cached_10_dirs", n, Cached, NULL);
+    BenchRun("searchpath/probe_10_dirs", n, Probe, NULL);
+    BenchRun("searchpath/cold_10_dirs", BenchIterations(200), Cold, NULL);
+    ArenaRelease(&g_arena);
+    unlink(g_cache);
+    return 0;
+}
@@ -0,0 +1,97 @@
+//--------------------------------------------------------------------------
+// BENCHMARK: status board publish, claim and snapshot
+//--------------------------------------------------------------------------
+// Usage: bench_status
+// A private board with 64 and then all 256 slots published. The snapshot
+// is what -Status costs before printing; the last line repeats it while a
+// writer thread republishes one slot without pause, so some reads retry.
+
+#include <stdio.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "psatomic.h"
+#include "status.h"
+
+static StatusBoard g_board;
+static StatusEntry g_entries[STATUS_SLOTS];
+static volatile uint32_t g_stop;
+
+static void Publish(void* ctx)
+{
+    StatusEntry* e = (StatusEntry*)ctx;
+    e->cpuMicros++;
+    StatusPublish(&g_board, 0, e);
+}
+
+static void ClaimRelease(void* ctx)
+{
+    (void)ctx;
+    int slot = StatusClaim(&g_board, (uint32_t)getpid());
+    if (slot >= 0)
+        StatusRelease(&g_board, slot);
+}
+
+static void Snapshot(void* ctx)
+{
+    (void)ctx;
+    g_benchSink += StatusSnapshot(&g_board, g_entries, STATUS_SLOTS);
+}
+
+static void Writer(void* arg)
+{
+    StatusEntry e = *(StatusEntry*)arg;
+    while (!PsAtomicLoad(&g_stop))
+    {
+        e.cpuMicros++;
+        StatusPublish(&g_board, 0, &e);
+    }
+}
+
+static void Fill(int from, int to, StatusEntry* e)
+{
+    for (int i = from; i < to; i++)
+    {
+        int slot = StatusClaim(&g_board, (uint32_t)getpid());
+        e->runId = StatusNextRunId(&g_board);
+        StatusPublish(&g_board, slot, e);
+    }
+}
+
+int main(void)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "psl-status-bench-%d", (int)getpid());
+    if (!StatusBoardOpen(&g_board, name, true))
+    {
+        fprintf(stderr, "cannot create the board\n");
+        return 1;
+    }
+    StatusEntry e = { 0 };
+    e.launcherPid = (uint32_t)getpid();
+    e.startMillis = PlatWallClockMillis();
+    StatusSetScript(&e, "/srv/jobs/nightly-report.ps1");
+
+    uint64_t n = BenchIterations(100000);
+    Fill(0, 64, &e);
+    BenchRun("status/publish (one slot)", n * 10, Publish, &e);
+    BenchRun("status/claim_release (64 held)", n, ClaimRelease, NULL);
+    BenchRun("status/snapshot (64 live)", n, Snapshot, NULL);
+    Fill(64, STATUS_SLOTS, &e);
+    BenchRun("status/snapshot (256 live)", n, Snapshot, NULL);
+
+    PlatThread writer;
+    if (PlatStartThread(&writer, Writer, &e))
+    {
+        BenchRun("status/snapshot (256 live, writer busy)", n, Snapshot, NULL);
+        PsAtomicStore(&g_stop, 1);
+        PlatJoinThread(&writer);
+    }
+
+    StatusBoardClose(&g_board);
+    char object[128];
+    snprintf(object, sizeof(object), "/%s-%u", name, (unsigned)getuid());
+    shm_unlink(object);
+    return 0;
+}
@@ -0,0 +1,70 @@
+//--------------------------------------------------------------------------
+// BENCHMARK: trace recording and flushing
+//--------------------------------------------------------------------------
+// Usage: bench_trace
+// "record" is what each traced phase costs its thread; "record (off)" is
+// the same call with tracing off, which is what every untraced launch
+// pays. "flush 500-job batch" formats and appends what a -Serve batch of
+// 500 jobs records (a track name and three spans each) to a file under
+// /tmp, truncated between iterations.
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "trace.h"
+
+#define BATCH_JOBS 500
+
+static Arena g_arena;
+static TraceBuffer g_trace;
+static TraceBuffer g_off;
+static char g_path[64];
+static RunId g_run = { 0x018BCFE568000000ull, 0x0123456789ABCDEFull };
+
+static void Record(void* ctx)
+{
+    TraceBuffer* trace = (TraceBuffer*)ctx;
+    uint64_t at = g_benchSink++;
+    TraceSpanArg(trace, 1, &g_run, "run", at, at + 1000, "exitCode", 0);
+    trace->count &= 1023;                   // Measure the store, not the flush
+}
+
+static void FlushBatch(void* ctx)
+{
+    (void)ctx;
+    truncate(g_path, 0);
+    for (uint32_t job = 1; job <= BATCH_JOBS; job++)
+    {
+        uint64_t at = (uint64_t)job * 1000000;
+        TraceNameTrack(&g_trace, job + 1, "job", job);
+        TraceSpan(&g_trace, job + 1, &g_run, "admission", at, at + 50000);
+        TraceSpanArg(&g_trace, job + 1, &g_run, "spawn", at + 50000, at + 400000, "pid", 4000 + job);
+        TraceSpanArg(&g_trace, job + 1, &g_run, "run", at + 400000, at + 900000, "exitCode", 0);
+    }
+    g_benchSink += TraceFlush(&g_trace);
+}
+
+int main(void)
+{
+    snprintf(g_path, sizeof(g_path), "/tmp/psl-trace-bench-%d.json", (int)getpid());
+    unlink(g_path);
+    if (!ArenaInit(&g_arena, 16 << 20) ||
+        !TraceOpen(&g_trace, &g_arena, g_path, "ps-launcher -Serve", BATCH_JOBS * 4))
+    {
+        fprintf(stderr, "cannot create the trace\n");
+        return 1;
+    }
+    g_off.events = NULL;
+
+    uint64_t n = BenchIterations(1000000);
+    BenchRun("trace/record", n, Record, &g_trace);
+    BenchRun("trace/record (off)", n, Record, &g_off);
+    g_trace.count = 0;
+    BenchRun("trace/flush 500-job batch", n / 10000, FlushBatch, NULL);
+
+    TraceClose(&g_trace);
+    ArenaRelease(&g_arena);
+    unlink(g_path);
+    return 0;
+}
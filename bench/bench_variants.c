@@ -0,0 +1,79 @@
+//--------------------------------------------------------------------------
+// BENCHMARK: binary size and launch latency per launcher variant
+//--------------------------------------------------------------------------
+// Usage: bench_variants <fake_interpreter> <launcher> [launcher...]
+// For each launcher binary prints its file size and the mean time of a
+// full launch against the stand-in interpreter, so the policy variants
+// (ps-launcher-silent, -verbose, -batch) can be compared with the C and
+// default C++ builds.
+
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+extern char** environ;
+
+static const char* BaseName(const char* path)
+{
+    const char* slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+static double LaunchMicros(char** argv, uint64_t n)
+{
+    uint64_t start = PlatMonotonicNanos();
+    for (uint64_t i = 0; i < n; i++)
+    {
+        pid_t pid;
+        int status;
+        if (posix_spawn(&pid, argv[0], NULL, NULL, argv, environ) == 0)
+            waitpid(pid, &status, 0);
+    }
+    return (double)(PlatMonotonicNanos() - start) / (double)n / 1000.0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: bench_variants <fake_interpreter> <launcher> [launcher...]\n");
+        return 2;
+    }
+
+    char script[] = "/dev/null";
+    // The launcher only accepts an absolute interpreter path
+    char interpreter[4096];
+    if (!realpath(argv[1], interpreter))
+    {
+        fprintf(stderr, "cannot resolve %s\n", argv[1]);
+        return 2;
+    }
+    setenv("PS_LAUNCHER_INTERPRETER", interpreter, 1);
+    setenv("XDG_STATE_HOME", "/tmp/ps-launcher-bench", 1);
+    freopen("/dev/null", "w", stdout);
+
+    // Results go to stderr because stdout is discarded
+    fprintf(stderr, "%-28s %12s %12s\n", "variant", "bytes", "us/launch");
+    uint64_t n = BenchIterations(200);
+    for (int i = 2; i < argc; i++)
+    {
+        struct stat st;
+        if (stat(argv[i], &st) != 0)
+        {
+            fprintf(stderr, "%-28s %12s\n", BaseName(argv[i]), "missing");
+            continue;
+        }
+
+        char* launcherArgv[] = { argv[i], "-Script", script, "-Name", "bench", NULL };
+        LaunchMicros(launcherArgv, n / 10 + 1);      // Warm-up: page cache, state dir
+        double us = LaunchMicros(launcherArgv, n);
+        fprintf(stderr, "%-28s %12lld %12.1f\n", BaseName(argv[i]), (long long)st.st_size, us);
+    }
+    return 0;
+}
@@ -0,0 +1,138 @@
+//--------------------------------------------------------------------------
+// BENCHMARK: watch mode under a burst of file events
+//--------------------------------------------------------------------------
+// Usage: bench_watch [base directory]
+// A producer thread creates 100,000 files as fast as it can while the main
+// thread drains the directory watch into a change set and cuts a batch
+// whenever the directory has been quiet for the debounce window - the
+// resident loop of watch.c without the runs. Reports event throughput,
+// the number of batches and overflow rescans, and checks that every file
+// appeared in some batch. The default directory is /tmp.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "bench.h"
+#include "psatomic.h"
+#include "watch.h"
+
+#define BURST_FILES 100000
+#define DEBOUNCE_MS 50
+
+static char g_dir[512];
+static ChangeSet g_set;
+static volatile uint32_t g_produced;
+
+static void Produce(void* arg)
+{
+    (void)arg;
+    char path[600];
+    for (int i = 0; i < BURST_FILES; i++)
+    {
+        snprintf(path, sizeof(path), "%s/f%06d", g_dir, i);
+        FILE* f = fopen(path, "w");
+        if (f)
+            fclose(f);
+    }
+    PsAtomicFetchAdd(&g_produced, 1);
+}
+
+static void AddChange(void* ctx, const PSCHAR* name, size_t nameLen)
+{
+    ChangeSetAdd((ChangeSet*)ctx, name, nameLen);
+}
+
+// Mark every name in the batch as seen
+static void Collect(const ChangeSet* set, unsigned char* seen)
+{
+    const char* name = set->names.data;
+    const char* end = name + set->names.len;
+    for (; name < end; name += strlen(name) + 1)
+    {
+        int index = atoi(name + 1);
+        if (name[0] == 'f' && index >= 0 && index < BURST_FILES)
+            seen[index] = 1;
+    }
+}
+
+static void AddRemove(void* ctx)
+{
+    uint64_t* i = (uint64_t*)ctx;
+    char name[16];
+    int n = snprintf(name, sizeof(name), "n%llu", (unsigned long long)(*i)++);
+    g_benchSink += ChangeSetAdd(&g_set, name, (size_t)n);
+    if (g_set.count >= 50000)
+        ChangeSetReset(&g_set);
+}
+
+int main(int argc, char** argv)
+{
+    snprintf(g_dir, sizeof(g_dir), "%s/ps-launcher-bench-watch", argc > 1 ? argv[1] : "/tmp");
+    char cmd[600];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", g_dir);
+    if (system(cmd) != 0 || mkdir(g_dir, 0700) != 0 || !ChangeSetInit(&g_set))
+        return 1;
+
+    uint64_t next = 0;
+    BenchRun("changeset_add (distinct names)", BenchIterations(1000000), AddRemove, &next);
+    ChangeSetReset(&g_set);
+
+    PlatWatch watch;
+    if (!PlatWatchOpen(&watch, g_dir))
+        return 1;
+    static unsigned char seen[BURST_FILES];
+    uint32_t batches = 0, rescans = 0, largest = 0;
+
+    PlatThread producer;
+    uint64_t start = PlatMonotonicNanos();
+    if (!PlatStartThread(&producer, Produce, NULL))
+        return 1;
+
+    // Drain until the producer is done and the directory has gone quiet
+    uint64_t lastEvent = PlatMonotonicNanos();
+    for (;;)
+    {
+        PlatWatchWake wake = PlatWatchWait(&watch, NULL, DEBOUNCE_MS);
+        bool overflow = false;
+        uint32_t before = g_set.count;
+        if (wake == PLAT_WAKE_ERROR || !PlatWatchRead(&watch, AddChange, &g_set, &overflow))
+            break;
+        if (overflow)
+            g_set.overflowed = true;
+        if (g_set.count != before || overflow)
+            lastEvent = PlatMonotonicNanos();
+
+        bool quiet = PlatMonotonicNanos() - lastEvent >= (uint64_t)DEBOUNCE_MS * 1000000;
+        if (quiet && (g_set.count > 0 || g_set.overflowed))
+        {
+            if (g_set.overflowed)
+            {
+                ChangeSetScan(&g_set, g_dir);
+                rescans++;
+            }
+            Collect(&g_set, seen);
+            largest = g_set.count > largest ? g_set.count : largest;
+            batches++;
+            ChangeSetReset(&g_set);
+        }
+        else if (quiet && PsAtomicFetchAdd(&g_produced, 0) != 0)
+            break;                      // Nothing more is coming
+    }
+    PlatJoinThread(&producer);
+    double seconds = (double)(lastEvent - start) / 1e9;
+    PlatWatchClose(&watch);
+
+    uint32_t missing = 0;
+    for (int i = 0; i < BURST_FILES; i++)
+        missing += !seen[i];
+    printf("%-44s %10d %12.0f events/s\n", "watch_burst (create + close)", BURST_FILES,
+           seconds > 0 ? BURST_FILES / seconds : 0.0);
+    printf("batches %u, largest %u, overflow rescans %u, missing %u\n", batches, largest, rescans, missing);
+
+    ChangeSetRelease(&g_set);
+    if (system(cmd) != 0)
+        return 1;
+    return missing == 0 ? 0 : 1;
+}
@@ -1,6 +1,6 @@
 @echo off
 call "%ProgramFiles(x86)%\Microsoft Visual Studio\2022\BuildTools\VC\Auxiliary\Build\vcvarsall.bat" x64
-cl /c /GS- /O1 /Os ps-launcher.c
+cl /c /GS- /O1 /Os /Isrc\core /Isrc\platform ps-launcher.c src\core\*.c src\platform\platform_win32.c
 rc ps-launcher.rc
-link /NODEFAULTLIB /ENTRY:WinMain /SUBSYSTEM:WINDOWS kernel32.lib user32.lib shell32.lib ps-launcher.res /OUT:ps-launcher.exe ps-launcher.obj
-del *.obj *.res
\ No newline at end of file
+link /NODEFAULTLIB /ENTRY:WinMain /SUBSYSTEM:WINDOWS kernel32.lib user32.lib ps-launcher.res /OUT:ps-launcher.exe *.obj
+del *.obj *.res
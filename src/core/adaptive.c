@@ -0,0 +1,131 @@
+//--------------------------------------------------------------------------
+// ADAPTIVE CONCURRENCY - A run limit that follows what the machine can take
+//--------------------------------------------------------------------------
+#include "adaptive.h"
+#include "psmem.h"
+
+#define NANOS_PER_MS 1000000ull
+
+void AdaptiveRestart(Adaptive* adaptive, uint64_t nowNanos)
+{
+    adaptive->windowStart = nowNanos;
+    adaptive->nextSample = nowNanos;
+    adaptive->completions = 0;
+    adaptive->refused = false;
+    adaptive->runnableSum = 0;
+    adaptive->samples = 0;
+    adaptive->availableLow = UINT64_MAX;
+}
+
+void AdaptiveInit(Adaptive* adaptive, uint32_t maxLimit, uint32_t cpus, uint64_t nowNanos)
+{
+    PsMemSet(adaptive, 0, sizeof(*adaptive));
+    adaptive->maxLimit = maxLimit ? maxLimit : 1;
+    adaptive->cpus = cpus ? cpus : 1;
+    adaptive->limit = adaptive->cpus < adaptive->maxLimit ? adaptive->cpus : adaptive->maxLimit;
+    adaptive->slowStart = true;
+    adaptive->raisedFrom = adaptive->limit;
+    AdaptiveRestart(adaptive, nowNanos);
+}
+
+bool AdaptiveSample(Adaptive* adaptive, uint64_t nowNanos, const AdaptiveSignals* signals,
+                    AdaptiveDecision* decision)
+{
+    Adaptive* a = adaptive;
+    a->nextSample = nowNanos + ADAPTIVE_SAMPLE_MS * NANOS_PER_MS;
+    a->runnableSum += signals->runnable;
+    a->samples++;
+    if (signals->totalBytes)
+    {
+        a->totalBytes = signals->totalBytes;
+        if (signals->availableBytes < a->availableLow)
+            a->availableLow = signals->availableBytes;
+    }
+
+    // WINDOW: Long enough to count, or as long as it may get
+    uint64_t elapsed = nowNanos - a->windowStart;
+    bool counted = a->completions >= ADAPTIVE_MIN_COMPLETIONS;
+    if (elapsed < ADAPTIVE_WINDOW_MS * NANOS_PER_MS ||
+        (!counted && elapsed < ADAPTIVE_LONG_WINDOW_MS * NANOS_PER_MS))
+        return false;
+
+    uint64_t rate = (uint64_t)a->completions * 1000000000ull / (elapsed / 1000);
+    uint32_t runnable = (uint32_t)((a->runnableSum + a->samples / 2) / a->samples);
+    bool memoryKnown = a->availableLow != UINT64_MAX && a->totalBytes > 0;
+    uint64_t floor = a->totalBytes / 100 * ADAPTIVE_MEMORY_FLOOR_PCT;
+    uint32_t queueMax = a->cpus + (a->cpus / 4 > 1 ? a->cpus / 4 : 1);
+    uint32_t limit = a->limit;
+    AdaptiveReason reason = ADAPT_HOLD;
+
+    if (memoryKnown && a->availableLow < floor)
+    {
+        reason = ADAPT_MEMORY;
+        limit -= limit / 4 > 1 ? limit / 4 : 1;
+    }
+    else if (runnable > queueMax)
+    {
+        // EXCESS: Threads waiting for a CPU are runs too many; at most half
+        // at once, since not all of the queue need be ours
+        reason = ADAPT_CPU;
+        uint32_t excess = runnable - a->cpus;
+        limit = excess < limit / 2 ? limit - excess : limit / 2;
+    }
+    else if (counted && a->raisedFrom < limit && rate * 100 < a->raisedRate * (100 + ADAPTIVE_GAIN_PCT))
+    {
+        reason = ADAPT_BACK;
+        limit = a->raisedFrom;
+    }
+    else if (a->settle > 0)
+    {
+        a->settle--;
+    }
+    else if (a->refused && limit < a->maxLimit && (!memoryKnown || a->availableLow >= 2 * floor) &&
+             (counted || runnable < a->cpus))
+    {
+        // RAISE: Remember what this limit bought, to judge the next one
+        reason = ADAPT_RAISE;
+        a->raisedFrom = limit;
+        a->raisedRate = counted ? rate : 0;
+        limit = a->slowStart ? limit * 2 : limit + 1;
+        if (limit > a->maxLimit)
+            limit = a->maxLimit;
+    }
+
+    if (limit == 0)
+        limit = 1;
+    if (reason != ADAPT_HOLD && reason != ADAPT_RAISE)
+    {
+        a->slowStart = false;
+        a->settle = ADAPTIVE_SETTLE;
+    }
+    if (reason != ADAPT_RAISE)
+        a->raisedFrom = limit;
+
+    decision->limit = limit;
+    decision->previous = a->limit;
+    decision->reason = reason;
+    decision->completions = a->completions;
+    decision->ratePerKs = rate;
+    decision->runnable = runnable;
+    decision->availableBytes = memoryKnown ? a->availableLow : 0;
+    a->limit = limit;
+    AdaptiveRestart(a, nowNanos);
+    return true;
+}
+
+const char* AdaptiveReasonText(AdaptiveReason reason)
+{
+    switch (reason)
+    {
+    case ADAPT_RAISE:
+        return "raise";
+    case ADAPT_BACK:
+        return "back";
+    case ADAPT_CPU:
+        return "cut: run queue";
+    case ADAPT_MEMORY:
+        return "cut: memory";
+    default:
+        return "hold";
+    }
+}
@@ -0,0 +1,134 @@
+//--------------------------------------------------------------------------
+// ADAPTIVE CONCURRENCY - A run limit that follows what the machine can take
+//--------------------------------------------------------------------------
+// A fixed number of runs at once oversubscribes a laptop and leaves most
+// of a large server idle. With adaptation on (PslSetAdaptive, engine.h)
+// the engine's run limit moves between 1 and its maxRuns, decided once per
+// window of at least ADAPTIVE_WINDOW_MS from:
+// - completions in the window: the throughput the current limit buys;
+// - the run queue: threads on the machine running or waiting for a CPU
+//   (Linux /proc/loadavg), averaged over samples ADAPTIVE_SAMPLE_MS apart;
+// - available memory (MemAvailable, GlobalMemoryStatusEx);
+// - whether the limit was what held runs back (a start refused at it).
+//
+// It is AIMD steered by the throughput gradient. In order:
+// - cut: available memory under ADAPTIVE_MEMORY_FLOOR_PCT of the total
+//   cuts the limit by a quarter; a run queue longer than the CPUs plus a
+//   quarter of them (and at least one) cuts it by the excess, so CPU-bound
+//   runs settle on one per CPU in a single step;
+// - back: the last raise did not lift throughput by ADAPTIVE_GAIN_PCT, so
+//   the limit returns to where it was and holds for ADAPTIVE_SETTLE
+//   windows before probing again;
+// - raise: while the limit is what holds runs back, double it (slow start,
+//   until the first back or cut), then add one;
+// - hold: otherwise. A window with fewer than ADAPTIVE_MIN_COMPLETIONS
+//   extends to ADAPTIVE_LONG_WINDOW_MS; long runs then raise only while
+//   the run queue leaves CPUs idle.
+// The limit starts at one per CPU. It never overshoots the peak by more
+// than one step, for one window.
+//
+// Plain integer arithmetic over the caller's samples: no clock, no OS.
+
+#ifndef PS_ADAPTIVE_H
+#define PS_ADAPTIVE_H
+
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+#define ADAPTIVE_SAMPLE_MS         100
+#define ADAPTIVE_WINDOW_MS         500
+#define ADAPTIVE_LONG_WINDOW_MS    5000
+#define ADAPTIVE_MIN_COMPLETIONS   8
+#define ADAPTIVE_GAIN_PCT          5
+#define ADAPTIVE_SETTLE            8
+#define ADAPTIVE_MEMORY_FLOOR_PCT  10
+
+typedef enum AdaptiveReason
+{
+    ADAPT_HOLD,
+    ADAPT_RAISE,           // Slow start or probe while the limit binds
+    ADAPT_BACK,            // The last raise bought no throughput
+    ADAPT_CPU,             // Run queue longer than the CPUs
+    ADAPT_MEMORY           // Available memory under the floor
+} AdaptiveReason;
+
+// One sample of the machine; zero where unknown
+typedef struct AdaptiveSignals
+{
+    uint32_t runnable;                // Threads running or ready, not counting the caller
+    uint64_t availableBytes;
+    uint64_t totalBytes;
+} AdaptiveSignals;
+
+typedef struct AdaptiveDecision
+{
+    uint32_t limit;                   // From now on
+    uint32_t previous;
+    AdaptiveReason reason;
+    uint32_t completions;             // In the window
+    uint64_t ratePerKs;               // Completions per 1000 seconds
+    uint32_t runnable;                // Mean over the window
+    uint64_t availableBytes;          // Lowest in the window
+} AdaptiveDecision;
+
+typedef struct Adaptive
+{
+    uint32_t limit;
+    uint32_t maxLimit;
+    uint32_t cpus;
+    bool slowStart;
+    uint32_t settle;                  // Windows left before probing again
+    uint32_t raisedFrom;              // Limit before the last raise; == limit: none pending
+    uint64_t raisedRate;              // Throughput measured at raisedFrom
+    // The open window
+    uint64_t windowStart;
+    uint64_t nextSample;
+    uint32_t completions;
+    bool refused;
+    uint64_t runnableSum;
+    uint32_t samples;
+    uint64_t availableLow;
+    uint64_t totalBytes;
+} Adaptive;
+
+void AdaptiveInit(Adaptive* adaptive, uint32_t maxLimit, uint32_t cpus, uint64_t nowNanos);
+
+// Open a fresh window, keeping the limit: after a spell with nothing to
+// run, which says nothing about throughput
+void AdaptiveRestart(Adaptive* adaptive, uint64_t nowNanos);
+
+static inline uint32_t AdaptiveLimit(const Adaptive* adaptive)
+{
+    return adaptive->limit;
+}
+
+// A run finished
+static inline void AdaptiveCompleted(Adaptive* adaptive)
+{
+    adaptive->completions++;
+}
+
+// A start was turned away at the limit: the limit is what binds
+static inline void AdaptiveRefused(Adaptive* adaptive)
+{
+    adaptive->refused = true;
+}
+
+// Whether AdaptiveSample wants signals yet
+static inline bool AdaptiveSampleDue(const Adaptive* adaptive, uint64_t nowNanos)
+{
+    return nowNanos >= adaptive->nextSample;
+}
+
+// Take one sample; true when it closed a window, with the decision made
+// (every one, holds included) in *decision
+bool AdaptiveSample(Adaptive* adaptive, uint64_t nowNanos, const AdaptiveSignals* signals,
+                    AdaptiveDecision* decision);
+
+// "hold", "raise", "back", "cut: run queue", "cut: memory"
+const char* AdaptiveReasonText(AdaptiveReason reason);
+
+PS_EXTERN_C_END
+
+#endif // PS_ADAPTIVE_H
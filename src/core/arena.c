@@ -0,0 +1,90 @@
+//--------------------------------------------------------------------------
+// BUMP ARENA - One reservation, lazy commits, freed in a single step
+//--------------------------------------------------------------------------
+#include "arena.h"
+#include "platform.h"
+
+static inline size_t AlignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+bool ArenaInit(Arena* arena, size_t reserve)
+{
+    reserve = AlignUp(reserve, ARENA_COMMIT_GRANULE);
+    arena->base = (unsigned char*)PlatReserve(reserve);
+    arena->reserved = arena->base ? reserve : 0;
+    arena->committed = 0;
+    arena->used = 0;
+    return arena->base != NULL;
+}
+
+void ArenaRelease(Arena* arena)
+{
+    if (arena->base)
+        PlatRelease(arena->base, arena->reserved);
+    arena->base = NULL;
+    arena->reserved = arena->committed = arena->used = 0;
+}
+
+// Make sure [base, base + end) is committed - one system call per growth
+static bool EnsureCommitted(Arena* arena, size_t end)
+{
+    if (end <= arena->committed)
+        return true;
+    if (end > arena->reserved)
+        return false;
+
+    size_t target = AlignUp(end, ARENA_COMMIT_GRANULE);
+    if (!PlatCommit(arena->base + arena->committed, target - arena->committed))
+        return false;
+    arena->committed = target;
+    return true;
+}
+
+void* ArenaAlloc(Arena* arena, size_t size)
+{
+    size_t start = AlignUp(arena->used, ARENA_ALIGNMENT);
+
+    // OVERFLOW CHECK: size near SIZE_MAX must not wrap around
+    if (start > arena->reserved || size > arena->reserved - start)
+        return NULL;
+    if (!EnsureCommitted(arena, start + size))
+        return NULL;
+
+    arena->used = start + size;
+    return arena->base + start;
+}
+
+bool ArenaExtend(Arena* arena, void* block, size_t oldSize, size_t newSize)
+{
+    size_t start = (size_t)((unsigned char*)block - arena->base);
+
+    // Only the top block can grow without moving
+    if (start + oldSize != arena->used || newSize > arena->reserved - start)
+        return false;
+    if (!EnsureCommitted(arena, start + newSize))
+        return false;
+
+    arena->used = start + newSize;
+    return true;
+}
+
+void* ArenaReadFile(Arena* arena, const PSCHAR* path, size_t maxSize, size_t* size)
+{
+    PlatFile file = PlatOpenFile(path);
+    if (file == PLAT_INVALID_FILE)
+        return NULL;
+
+    uint64_t fileSize = 0;
+    void* data = NULL;
+    if (PlatFileSize(file, &fileSize) && fileSize <= maxSize)
+    {
+        data = ArenaAlloc(arena, (size_t)fileSize + 1);
+        if (data && !PlatReadFile(file, data, (size_t)fileSize))
+            data = NULL;
+    }
+    PlatCloseFile(file);
+    *size = (size_t)fileSize;
+    return data;
+}
@@ -0,0 +1,65 @@
+//--------------------------------------------------------------------------
+// BUMP ARENA - One reservation, lazy commits, freed in a single step
+//--------------------------------------------------------------------------
+// Every variable-size structure of a launch (argument views, command line,
+// log lines, environment block, run record) is carved from one arena:
+// - ArenaInit reserves address space only; nothing is committed yet
+// - ArenaAlloc bumps a pointer and commits more in ARENA_COMMIT_GRANULE steps
+// - ArenaExtend grows the most recent block in place (no copy)
+// - ArenaSave/ArenaRestore give cheap scratch space for temporaries
+// - ArenaRelease returns the whole region to the OS at exit
+//
+// There is no per-block free. This replaces the fixed stack buffers whose
+// sizes used to be the launcher's hard limits.
+
+#ifndef PS_ARENA_H
+#define PS_ARENA_H
+
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+// Address space reserved per arena - far more than a launch ever commits
+#if UINTPTR_MAX > 0xFFFFFFFFu
+    #define ARENA_DEFAULT_RESERVE ((size_t)256 << 20)
+#else
+    #define ARENA_DEFAULT_RESERVE ((size_t)32 << 20)
+#endif
+
+// Commit step: the Windows allocation granularity, a multiple of any page
+#define ARENA_COMMIT_GRANULE ((size_t)64 << 10)
+
+// Every block starts on this boundary (enough for SSE2 loads)
+#define ARENA_ALIGNMENT 16
+
+typedef struct Arena
+{
+    unsigned char* base;
+    size_t reserved;       // Bytes of address space
+    size_t committed;      // Bytes backed by memory, from base
+    size_t used;           // Bump offset, from base
+} Arena;
+
+typedef size_t ArenaMark;
+
+bool ArenaInit(Arena* arena, size_t reserve);
+void ArenaRelease(Arena* arena);
+
+// Uninitialized block of size bytes, or NULL if the reservation is exhausted
+void* ArenaAlloc(Arena* arena, size_t size);
+
+// Grow block (the most recent allocation) from oldSize to newSize in place
+// Returns false if block is not the most recent or the arena is full
+bool ArenaExtend(Arena* arena, void* block, size_t oldSize, size_t newSize);
+
+// Whole file in a new block with one spare byte after it (room for a
+// terminator). NULL if it cannot be read or is larger than maxSize.
+void* ArenaReadFile(Arena* arena, const PSCHAR* path, size_t maxSize, size_t* size);
+
+// Scratch space: everything allocated after Save is dropped by Restore
+static inline ArenaMark ArenaSave(const Arena* arena) { return arena->used; }
+static inline void ArenaRestore(Arena* arena, ArenaMark mark) { arena->used = mark; }
+
+PS_EXTERN_C_END
+
+#endif // PS_ARENA_H
@@ -0,0 +1,124 @@
+//--------------------------------------------------------------------------
+// ARGUMENT PARSING - Launcher switches and command line splitting
+//--------------------------------------------------------------------------
+#include "args.h"
+#include "psstr.h"
+
+bool ParseLaunchArgs(int argc, PSCHAR* const* argv, LaunchArgs* out)
+{
+    // LOGICAL OPERATORS: Short-circuit evaluation with ||
+    // STRING COMPARISON: Case-insensitive comparison of the switch name
+    if (argc < 3 || PsStrCmpI(argv[1], PS_T("-Script")) != 0)
+        return false;
+
+    out->script = argv[2];
+    out->params = argv + 3;
+    out->paramCount = argc - 3;
+    return true;
+}
+
+bool IsResidentMode(const PSCHAR* arg)
+{
+    return PsStrCmpI(arg, PS_T("-Schedule")) == 0 || PsStrCmpI(arg, PS_T("-Watch")) == 0 ||
+           PsStrCmpI(arg, PS_T("-Serve")) == 0;
+}
+
+static inline bool IsBlank(PSCHAR c)
+{
+    return c == PS_T(' ') || c == PS_T('\t');
+}
+
+int SplitCommandLine(const PSCHAR* cmdline, PSCHAR* storage, PSCHAR** argv, int maxArgs)
+{
+    const PSCHAR* p = cmdline;
+    PSCHAR* out = storage;
+    int argc = 0;
+
+    //----------------------------------------------------------------------
+    // PROGRAM NAME: Quotes group, no backslash processing
+    //----------------------------------------------------------------------
+    if (*p)
+    {
+        if (argc >= maxArgs)
+            return -1;
+        argv[argc++] = out;
+        if (*p == PS_T('"'))
+        {
+            for (p++; *p && *p != PS_T('"'); p++)
+                *out++ = *p;
+            if (*p)
+                p++;
+        }
+        else
+        {
+            for (; *p && !IsBlank(*p); p++)
+                *out++ = *p;
+        }
+        *out++ = 0;
+    }
+
+    //----------------------------------------------------------------------
+    // PARAMETERS: Full quote and backslash rules
+    //----------------------------------------------------------------------
+    for (;;)
+    {
+        while (IsBlank(*p))
+            p++;
+        if (!*p)
+            break;
+
+        if (argc >= maxArgs)
+            return -1;
+        argv[argc++] = out;
+
+        bool quoted = false;
+        while (*p && (quoted || !IsBlank(*p)))
+        {
+            if (*p == PS_T('\\'))
+            {
+                size_t slashes = 0;
+                while (*p == PS_T('\\'))
+                {
+                    slashes++;
+                    p++;
+                }
+                if (*p == PS_T('"'))
+                {
+                    // Backslashes before a quote are halved
+                    for (size_t i = 0; i < slashes / 2; i++)
+                        *out++ = PS_T('\\');
+                    if (slashes % 2)
+                    {
+                        *out++ = PS_T('"');
+                        p++;
+                    }
+                }
+                else
+                {
+                    for (size_t i = 0; i < slashes; i++)
+                        *out++ = PS_T('\\');
+                }
+            }
+            else if (*p == PS_T('"'))
+            {
+                if (quoted && p[1] == PS_T('"'))
+                {
+                    *out++ = PS_T('"');
+                    p += 2;
+                }
+                else
+                {
+                    quoted = !quoted;
+                    p++;
+                }
+            }
+            else
+            {
+                *out++ = *p++;
+            }
+        }
+        *out++ = 0;
+    }
+
+    return argc;
+}
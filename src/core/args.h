@@ -0,0 +1,38 @@
+//--------------------------------------------------------------------------
+// ARGUMENT PARSING - Launcher switches and command line splitting
+//--------------------------------------------------------------------------
+#ifndef PS_ARGS_H
+#define PS_ARGS_H
+
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+// Parsed launcher invocation: ps-launcher -Script <path> [parameters]
+typedef struct LaunchArgs
+{
+    const PSCHAR* script;        // Script path exactly as given
+    PSCHAR* const* params;       // Parameters forwarded to the script
+    int paramCount;
+} LaunchArgs;
+
+// Returns false if the command line does not match the usage syntax
+bool ParseLaunchArgs(int argc, PSCHAR* const* argv, LaunchArgs* out);
+
+// True for a switch that keeps the launcher resident (-Schedule, -Watch,
+// -Serve). Resident modes start launches, never another resident launcher.
+bool IsResidentMode(const PSCHAR* arg);
+
+// Split a command line using the CommandLineToArgvW rules:
+// - First token is the program name; quotes group, backslashes are literal
+// - 2n backslashes + quote   -> n backslashes, quote toggles quoting
+// - 2n+1 backslashes + quote -> n backslashes and a literal quote
+// - "" inside a quoted run   -> literal quote
+// storage must hold PsStrLen(cmdline) + 1 characters. Arguments are stored
+// back to back, so argv[i + 1] - argv[i] - 1 is the length of argv[i].
+// Returns the argument count, or -1 if there are more than maxArgs.
+int SplitCommandLine(const PSCHAR* cmdline, PSCHAR* storage, PSCHAR** argv, int maxArgs);
+
+PS_EXTERN_C_END
+
+#endif // PS_ARGS_H
@@ -0,0 +1,366 @@
+//--------------------------------------------------------------------------
+// SCRIPT CATALOGUE - "-Script @alias" through a memory-mapped index
+//--------------------------------------------------------------------------
+#include "catalog.h"
+#include "args.h"
+#include "encoding.h"
+#include "psmem.h"
+#include "psstr.h"
+
+static inline char FoldAscii(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+}
+
+uint64_t CatalogHashAlias(const char* alias, size_t len)
+{
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < len; i++)
+        h = (h ^ (uint8_t)FoldAscii(alias[i])) * 1099511628211ull;
+    return h;
+}
+
+//--------------------------------------------------------------------------
+// INDEX ACCESS
+//--------------------------------------------------------------------------
+bool CatalogAttach(Catalog* cat, const void* data, size_t size)
+{
+    const CatalogHeader* h = (const CatalogHeader*)data;
+    PsMemSet(cat, 0, sizeof(*cat));
+    if (!data || size < sizeof(CatalogHeader) ||
+        h->magic[0] != 'P' || h->magic[1] != 'S' || h->magic[2] != 'C' || h->magic[3] != 'I' ||
+        h->version != CATALOG_VERSION || h->entryCount > CATALOG_MAX_ENTRIES ||
+        h->bucketCount == 0 || (h->bucketCount & (h->bucketCount - 1)) != 0 ||
+        h->bucketCount < 2 * (uint64_t)h->entryCount || h->profileCount > CATALOG_MAX_ENTRIES)
+        return false;
+
+    // FRAMING: Every section must lie inside the file (64-bit math, no wrap)
+    uint64_t bucketsAt = sizeof(CatalogHeader);
+    uint64_t entriesAt = bucketsAt + (uint64_t)h->bucketCount * sizeof(uint32_t);
+    uint64_t profilesAt = entriesAt + (uint64_t)h->entryCount * sizeof(CatalogEntry);
+    uint64_t poolAt = profilesAt + (uint64_t)h->profileCount * sizeof(CatalogProfile);
+    if (poolAt + h->poolSize > size)
+        return false;
+
+    const uint8_t* base = (const uint8_t*)data;
+    cat->size = size;
+    cat->header = h;
+    cat->buckets = (const uint32_t*)(base + bucketsAt);
+    cat->entries = (const CatalogEntry*)(base + entriesAt);
+    cat->profiles = (const CatalogProfile*)(base + profilesAt);
+    cat->pool = (const char*)(base + poolAt);
+    return true;
+}
+
+bool CatalogOpen(Catalog* cat, const PSCHAR* indexPath)
+{
+    size_t size = 0;
+    const void* view = PlatMapFile(indexPath, &size);
+    if (!view)
+    {
+        PsMemSet(cat, 0, sizeof(*cat));
+        return false;
+    }
+    if (!CatalogAttach(cat, view, size))
+    {
+        PlatUnmapFile(view, size);
+        return false;
+    }
+    cat->view = view;
+    return true;
+}
+
+void CatalogClose(Catalog* cat)
+{
+    if (cat->view)
+        PlatUnmapFile(cat->view, cat->size);
+    PsMemSet(cat, 0, sizeof(*cat));
+}
+
+const char* CatalogString(const Catalog* cat, uint32_t offset, size_t len)
+{
+    uint32_t poolSize = cat->header->poolSize;
+    if (offset > poolSize || len > poolSize - offset)
+        return NULL;
+    return cat->pool + offset;
+}
+
+const CatalogEntry* CatalogFind(const Catalog* cat, const char* alias, size_t aliasLen)
+{
+    if (!cat->header || cat->header->entryCount == 0)
+        return NULL;
+
+    // LINEAR PROBING: The table is at most half full, so probes stay short
+    uint64_t hash = CatalogHashAlias(alias, aliasLen);
+    uint32_t mask = cat->header->bucketCount - 1;
+    for (uint32_t i = 0, slot = (uint32_t)hash & mask; i <= mask; i++, slot = (slot + 1) & mask)
+    {
+        uint32_t index = cat->buckets[slot];
+        if (index == 0)
+            return NULL;
+        if (index > cat->header->entryCount)
+            return NULL;                                 // Corrupt bucket
+
+        const CatalogEntry* e = &cat->entries[index - 1];
+        if (e->aliasHash != hash || e->aliasLen != aliasLen)
+            continue;
+        const char* name = CatalogString(cat, e->aliasOffset, e->aliasLen);
+        size_t j = 0;
+        while (name && j < aliasLen && FoldAscii(name[j]) == FoldAscii(alias[j]))
+            j++;
+        if (name && j == aliasLen)
+            return e;
+    }
+    return NULL;
+}
+
+bool CatalogHashFile(Arena* arena, const PSCHAR* path, uint8_t digest[SHA256_DIGEST_SIZE])
+{
+    enum { CHUNK = 64 * 1024 };
+    PlatFile file = PlatOpenFile(path);
+    if (file == PLAT_INVALID_FILE)
+        return false;
+
+    ArenaMark mark = ArenaSave(arena);
+    uint8_t* buffer = (uint8_t*)ArenaAlloc(arena, CHUNK);
+    uint64_t remaining = 0;
+    bool ok = buffer && PlatFileSize(file, &remaining);
+
+    Sha256 ctx;
+    Sha256Init(&ctx);
+    while (ok && remaining > 0)
+    {
+        size_t chunk = remaining < CHUNK ? (size_t)remaining : CHUNK;
+        ok = PlatReadFile(file, buffer, chunk);
+        Sha256Update(&ctx, buffer, chunk);
+        remaining -= chunk;
+    }
+    Sha256Final(&ctx, digest);
+
+    ArenaRestore(arena, mark);
+    PlatCloseFile(file);
+    return ok;
+}
+
+//--------------------------------------------------------------------------
+// LAUNCH-TIME RESOLUTION
+//--------------------------------------------------------------------------
+// UTF-8 pool string -> terminated PSCHAR copy in the arena
+static PSCHAR* CopyString(Arena* arena, const char* s, size_t len)
+{
+    PSCHAR* out = (PSCHAR*)ArenaAlloc(arena, (len + 1) * sizeof(PSCHAR));
+    if (!out)
+        return NULL;
+#ifdef _WIN32
+    len = Utf8ToUtf16(s, len, (uint16_t*)out, len);
+#else
+    PsMemCpy(out, s, len);
+#endif
+    out[len] = 0;
+    return out;
+}
+
+// Profile fields are stored as command line fragments; split one with a
+// stand-in program name in front, leaving room for extra more arguments
+static bool SplitFragment(Arena* arena, const char* fragment, size_t len, int extra,
+                          PSCHAR*** argvOut, int* countOut)
+{
+    PSCHAR* line = (PSCHAR*)ArenaAlloc(arena, (len + 3) * sizeof(PSCHAR));
+    if (!line)
+        return false;
+#ifdef _WIN32
+    len = Utf8ToUtf16(fragment, len, (uint16_t*)line + 2, len);
+#else
+    PsMemCpy(line + 2, fragment, len);
+#endif
+    line[0] = PS_T('x');
+    line[1] = PS_T(' ');
+    line[len + 2] = 0;
+
+    int maxArgs = (int)((len + 2) / 2 + 2);
+    PSCHAR* storage = (PSCHAR*)ArenaAlloc(arena, (len + 3) * sizeof(PSCHAR));
+    PSCHAR** argv = (PSCHAR**)ArenaAlloc(arena, sizeof(PSCHAR*) * (size_t)(maxArgs + extra));
+    int argc = (storage && argv) ? SplitCommandLine(line, storage, argv, maxArgs) : -1;
+    if (argc < 1)
+        return false;
+
+    // Drop the stand-in program name
+    for (int i = 0; i < argc - 1; i++)
+        argv[i] = argv[i + 1];
+    *argvOut = argv;
+    *countOut = argc - 1;
+    return true;
+}
+
+// Profile parameters first, then the caller's, then its input and output
+// lists for incremental mode
+static CatalogStatus ApplyProfile(Arena* arena, const Catalog* cat, uint32_t profile,
+                                  PSCHAR* const* params, int paramCount, CatalogScript* out)
+{
+    if (profile >= cat->header->profileCount)
+        return CATALOG_NO_INDEX;
+    const CatalogProfile* p = &cat->profiles[profile];
+    const char* fragment = CatalogString(cat, p->paramsOffset, p->paramsLen);
+    const char* inputs = CatalogString(cat, p->inputsOffset, p->inputsLen);
+    const char* outputs = CatalogString(cat, p->outputsOffset, p->outputsLen);
+    if (!fragment || !inputs || !outputs)
+        return CATALOG_NO_INDEX;
+
+    int count = 0;
+    if (!SplitFragment(arena, fragment, p->paramsLen, paramCount, &out->params, &count) ||
+        !SplitFragment(arena, inputs, p->inputsLen, 0, &out->inputs, &out->inputCount) ||
+        !SplitFragment(arena, outputs, p->outputsLen, 0, &out->outputs, &out->outputCount))
+        return CATALOG_NO_MEMORY;
+    for (int i = 0; i < paramCount; i++)
+        out->params[count + i] = params[i];
+    out->paramCount = count + paramCount;
+    out->cacheSeconds = p->cacheSeconds;
+    out->cacheOutput = (p->cacheFlags & CATALOG_CACHE_OUTPUT) != 0;
+    return CATALOG_OK;
+}
+
+static bool IndexPath(PSCHAR* out, size_t outSize)
+{
+    if (!PlatGetStateDirectory(out, outSize))
+        return false;
+    size_t pos = PsStrLen(out);
+    return AppendChar(out, outSize, PS_PATH_SEP, &pos) &&
+           AppendStr(out, outSize, CATALOG_INDEX_NAME, &pos);
+}
+
+CatalogStatus CatalogResolve(Arena* arena, const PSCHAR* alias, PSCHAR* const* params,
+                             int paramCount, CatalogScript* out)
+{
+    PSCHAR indexPath[PS_MAX_PATH];
+    if (!IndexPath(indexPath, PS_MAX_PATH))
+        return CATALOG_NO_INDEX;
+
+    char name[PS_MAX_PATH * 3];
+    size_t nameLen = PlatToUtf8(alias, PsStrLen(alias), name, sizeof(name));
+    if (nameLen == 0)
+        return CATALOG_NOT_FOUND;
+
+    Catalog cat;
+    if (!CatalogOpen(&cat, indexPath))
+        return CATALOG_NO_INDEX;
+
+    // Copy what the launch needs out of the mapping before closing it
+    CatalogStatus status = CATALOG_OK;
+    const CatalogEntry* e = CatalogFind(&cat, name, nameLen);
+    const char* path = e ? CatalogString(&cat, e->pathOffset, e->pathLen) : NULL;
+    CatalogEntry entry;
+    if (!path)
+        status = CATALOG_NOT_FOUND;
+    else
+    {
+        entry = *e;
+        PsMemSet(out, 0, sizeof(*out));
+        out->path = CopyString(arena, path, e->pathLen);
+        out->params = (PSCHAR**)params;
+        out->paramCount = paramCount;
+        PsMemCpy(out->sha256, e->sha256, SHA256_DIGEST_SIZE);
+
+        if (e->profile != CATALOG_NO_PROFILE)
+            status = ApplyProfile(arena, &cat, e->profile, params, paramCount, out);
+        if (!out->path)
+            status = CATALOG_NO_MEMORY;
+    }
+    CatalogClose(&cat);
+    if (status != CATALOG_OK)
+        return status;
+
+    //----------------------------------------------------------------------
+    // STALENESS - Identity first; read and hash only if it moved
+    //----------------------------------------------------------------------
+    PlatFileInfo info;
+    if (!PlatGetFileInfo(out->path, &info))
+        return CATALOG_MISSING;
+    if (info.volume == entry.file.volume && info.fileId == entry.file.fileId &&
+        info.size == entry.file.size && info.mtime == entry.file.mtime)
+        return CATALOG_OK;
+
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    if (!CatalogHashFile(arena, out->path, digest))
+        return CATALOG_MISSING;
+    for (int i = 0; i < SHA256_DIGEST_SIZE; i++)
+    {
+        if (digest[i] != entry.sha256[i])
+            return CATALOG_STALE;
+    }
+    return CATALOG_OK;
+}
+
+bool CatalogAliasUsesProfile(const PSCHAR* alias, const PSCHAR* profile)
+{
+    PSCHAR indexPath[PS_MAX_PATH];
+    char name[PS_MAX_PATH * 3];
+    char wanted[PS_MAX_PATH * 3];
+    size_t nameLen = PlatToUtf8(alias, PsStrLen(alias), name, sizeof(name));
+    size_t wantedLen = PlatToUtf8(profile, PsStrLen(profile), wanted, sizeof(wanted));
+    Catalog cat;
+    if (nameLen == 0 || wantedLen == 0 || !IndexPath(indexPath, PS_MAX_PATH) || !CatalogOpen(&cat, indexPath))
+        return false;
+
+    bool same = false;
+    const CatalogEntry* e = CatalogFind(&cat, name, nameLen);
+    if (e && e->profile < cat.header->profileCount)
+    {
+        const CatalogProfile* p = &cat.profiles[e->profile];
+        const char* used = CatalogString(&cat, p->nameOffset, p->nameLen);
+        same = used && p->nameLen == wantedLen;
+        for (size_t i = 0; same && i < wantedLen; i++)
+            same = FoldAscii(used[i]) == FoldAscii(wanted[i]);
+    }
+    CatalogClose(&cat);
+    return same;
+}
+
+bool CatalogAliasResources(Arena* arena, const PSCHAR* alias, CatalogResources* out)
+{
+    PSCHAR indexPath[PS_MAX_PATH];
+    char name[PS_MAX_PATH * 3];
+    size_t nameLen = PlatToUtf8(alias, PsStrLen(alias), name, sizeof(name));
+    out->count = 0;
+    Catalog cat;
+    if (nameLen == 0 || !IndexPath(indexPath, PS_MAX_PATH) || !CatalogOpen(&cat, indexPath))
+        return false;
+
+    const CatalogEntry* e = CatalogFind(&cat, name, nameLen);
+    bool ok = e != NULL;
+    if (e && e->profile != CATALOG_NO_PROFILE)
+    {
+        const CatalogProfile* p = e->profile < cat.header->profileCount ? &cat.profiles[e->profile] : NULL;
+        const char* fragment = p ? CatalogString(&cat, p->resourcesOffset, p->resourcesLen) : NULL;
+        PSCHAR** pairs;
+        int count = 0;
+        ok = fragment && SplitFragment(arena, fragment, p->resourcesLen, 0, &pairs, &count) &&
+             count % 2 == 0 && count / 2 <= RESOURCE_MAX_HELD;
+
+        // Limits were checked by the indexer; a bad one here is a bad index
+        for (int i = 0; ok && i < count; i += 2)
+        {
+            uint32_t limit = 0;
+            const PSCHAR* digits = pairs[i + 1];
+            while (*digits >= PS_T('0') && *digits <= PS_T('9') && limit <= RESOURCE_MAX_LIMIT)
+                limit = limit * 10 + (uint32_t)(*digits++ - PS_T('0'));
+            ok = *digits == 0 && limit > 0;
+            out->names[out->count] = pairs[i];
+            out->limits[out->count++] = limit;
+        }
+    }
+    CatalogClose(&cat);
+    if (!ok)
+        out->count = 0;
+    return ok;
+}
+
+bool CatalogClaimResources(const CatalogResources* resources, ResourceTable* table, ResourceClaim* claim)
+{
+    for (uint32_t i = 0; i < resources->count; i++)
+    {
+        if (!ResourceDeclare(table, resources->names[i], resources->limits[i]) ||
+            !ResourceClaimAdd(table, claim, resources->names[i]))
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,180 @@
+//--------------------------------------------------------------------------
+// SCRIPT CATALOGUE - "-Script @alias" through a memory-mapped index
+//--------------------------------------------------------------------------
+// The catalogue source <state directory>/ps-launcher.catalog is a text
+// file (UTF-8), one directive per line, fields split like a command line:
+//   root    <directory> [profile]        every *.ps1 below the directory,
+//                                        alias = file name without .ps1
+//   alias   <name> <script path> [profile]
+//   profile <name> [parameter...]        placed before the caller's own
+//   inputs  <profile> <glob...>          incremental mode (incremental.h):
+//   outputs <profile> <file...>          skip runs whose inputs are unchanged
+//   cache   <profile> <seconds> [stdout] result cache (resultcache.h): reuse
+//                                        the exit code (and output) this long
+//   resource <name> <limit>              at most <limit> scheduled runs hold
+//   tags    <profile> <resource...>      the resource at once (resource.h)
+// Lines starting with # are comments. Explicit aliases win over roots, and
+// earlier roots over later ones.
+//
+// "ps-launcher -Index" (indexer.c) compiles the source into
+// ps-launcher.catalog.idx, which the launcher maps read-only: one hash,
+// one or two bucket probes and one entry compare per lookup, whatever the
+// catalogue size. Each entry carries the script's SHA-256 and the file
+// identity it was hashed at; an unchanged identity means an unchanged file,
+// so neither the launcher nor the next -Index run has to read it again.
+//
+// Index layout (little-endian, naturally aligned, used in place):
+//   CatalogHeader
+//   uint32_t buckets[bucketCount]      entry index + 1, 0 = empty
+//   CatalogEntry entries[entryCount]
+//   CatalogProfile profiles[profileCount]
+//   char pool[poolSize]                UTF-8 strings, not terminated
+
+#ifndef PS_CATALOG_H
+#define PS_CATALOG_H
+
+#include "arena.h"
+#include "platform.h"
+#include "pstypes.h"
+#include "resource.h"
+#include "sha256.h"
+
+PS_EXTERN_C_BEGIN
+
+#define CATALOG_SOURCE_NAME PS_T("ps-launcher.catalog")
+#define CATALOG_INDEX_NAME  PS_T("ps-launcher.catalog.idx")
+
+#define CATALOG_VERSION    4
+#define CATALOG_NO_PROFILE 0xFFFFFFFFu
+#define CATALOG_MAX_ENTRIES (1u << 24)
+
+// CatalogProfile.cacheFlags
+#define CATALOG_CACHE_OUTPUT 0x1u    // Capture and replay stdout as well
+
+typedef struct CatalogHeader
+{
+    char magic[4];                   // "PSCI"
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t bucketCount;            // Power of two, at least 2 x entryCount
+    uint32_t profileCount;
+    uint32_t poolSize;
+    uint64_t builtMillis;
+} CatalogHeader;
+
+typedef struct CatalogEntry
+{
+    uint64_t aliasHash;              // CatalogHashAlias of the alias
+    uint32_t aliasOffset;            // Pool offsets
+    uint32_t pathOffset;
+    uint16_t aliasLen;
+    uint16_t pathLen;
+    uint32_t profile;                // Profile index or CATALOG_NO_PROFILE
+    PlatFileInfo file;               // Identity the hash was taken at
+    uint8_t sha256[SHA256_DIGEST_SIZE];
+} CatalogEntry;
+
+typedef struct CatalogProfile
+{
+    uint32_t nameOffset;
+    uint32_t paramsOffset;           // Parameters as one command line fragment
+    uint32_t nameLen;
+    uint32_t paramsLen;
+    uint32_t inputsOffset;           // Input globs, fragment like the parameters
+    uint32_t inputsLen;
+    uint32_t outputsOffset;          // Output files, the same
+    uint32_t outputsLen;
+    uint32_t cacheSeconds;           // Result cache lifetime, 0 = off
+    uint32_t cacheFlags;             // CATALOG_CACHE_*
+    uint32_t resourcesOffset;        // Resource tags, each its name then its
+    uint32_t resourcesLen;           // limit, fragment like the parameters
+} CatalogProfile;
+
+// A validated view of an index
+typedef struct Catalog
+{
+    const void* view;                // Mapping owned by CatalogOpen, or NULL
+    size_t size;
+    const CatalogHeader* header;
+    const uint32_t* buckets;
+    const CatalogEntry* entries;
+    const CatalogProfile* profiles;
+    const char* pool;
+} Catalog;
+
+// FNV-1a 64 over the ASCII-lowercased alias
+uint64_t CatalogHashAlias(const char* alias, size_t len);
+
+// Check the framing of an index in memory and fill in the view
+bool CatalogAttach(Catalog* cat, const void* data, size_t size);
+
+// Map and validate an index file; CatalogClose unmaps it
+bool CatalogOpen(Catalog* cat, const PSCHAR* indexPath);
+void CatalogClose(Catalog* cat);
+
+// Entry for alias (ASCII case-insensitive), or NULL
+const CatalogEntry* CatalogFind(const Catalog* cat, const char* alias, size_t aliasLen);
+
+// Pool string, or NULL if offset/length fall outside the pool
+const char* CatalogString(const Catalog* cat, uint32_t offset, size_t len);
+
+// SHA-256 of a file's contents (64KB reads in arena scratch space)
+bool CatalogHashFile(Arena* arena, const PSCHAR* path, uint8_t digest[SHA256_DIGEST_SIZE]);
+
+//--------------------------------------------------------------------------
+// LAUNCH-TIME RESOLUTION
+//--------------------------------------------------------------------------
+typedef enum CatalogStatus
+{
+    CATALOG_OK = 0,
+    CATALOG_NO_INDEX,      // No index, or it failed validation
+    CATALOG_NOT_FOUND,     // Alias not in the index
+    CATALOG_MISSING,       // Indexed script no longer exists
+    CATALOG_STALE,         // Script content differs from the indexed hash
+    CATALOG_NO_MEMORY
+} CatalogStatus;
+
+typedef struct CatalogScript
+{
+    PSCHAR* path;
+    PSCHAR** params;                 // Profile parameters, then the caller's
+    int paramCount;
+    PSCHAR** inputs;                 // Profile input globs (none: run always)
+    int inputCount;
+    PSCHAR** outputs;
+    int outputCount;
+    uint8_t sha256[SHA256_DIGEST_SIZE];   // Script content as indexed
+    uint32_t cacheSeconds;           // Profile's result cache lifetime, 0 = off
+    bool cacheOutput;
+} CatalogScript;
+
+// Resolve alias (without the '@') through the index in the state
+// directory. The script is only read when its file identity changed since
+// indexing; then its hash must still match.
+CatalogStatus CatalogResolve(Arena* arena, const PSCHAR* alias, PSCHAR* const* params,
+                             int paramCount, CatalogScript* out);
+
+// True if alias (without the '@') is indexed with the profile named
+// profile (ASCII case-insensitive); submissions naming a profile (server.h)
+bool CatalogAliasUsesProfile(const PSCHAR* alias, const PSCHAR* profile);
+
+// Resource tags a profile's runs hold, with their limits
+typedef struct CatalogResources
+{
+    PSCHAR* names[RESOURCE_MAX_HELD];
+    uint32_t limits[RESOURCE_MAX_HELD];
+    uint32_t count;
+} CatalogResources;
+
+// Tags of the profile alias (without the '@') is indexed with, names on
+// arena; none when it has no profile or tags. False if the index cannot
+// be read or the alias is not in it.
+bool CatalogAliasResources(Arena* arena, const PSCHAR* alias, CatalogResources* out);
+
+// Declare each tag in table with its limit and add it to a free claim;
+// false if the table is full
+bool CatalogClaimResources(const CatalogResources* resources, ResourceTable* table, ResourceClaim* claim);
+
+PS_EXTERN_C_END
+
+#endif // PS_CATALOG_H
@@ -0,0 +1,197 @@
+//--------------------------------------------------------------------------
+// COMMAND LINE BUILDING - Interpreter invocation for one script run
+//--------------------------------------------------------------------------
+#include "cmdline.h"
+#include "encoding.h"
+#include "policy.h"
+#include "psstr.h"
+#include "quote.h"
+
+CmdStatus BuildCommandLine(StrBuf* cmd, const PSCHAR* interpreter,
+                           const LaunchArgs* args, int* blockedIndex)
+{
+    // "interpreter" -NonInteractive ... -File "script"
+    if (!AppendQuotedPath(cmd, interpreter) ||
+        !StrBufAppend(cmd, PS_INTERPRETER_SWITCHES) ||
+        !AppendQuotedPath(cmd, args->script))
+    {
+        return CMD_OVERFLOW;
+    }
+
+    //----------------------------------------------------------------------
+    // PARAMETER PROCESSING - Security filtering then quoting
+    //----------------------------------------------------------------------
+    for (int i = 0; i < args->paramCount; i++)
+    {
+        if (CheckParameterPolicy(args->params[i]) != POLICY_OK)
+        {
+            if (blockedIndex)
+                *blockedIndex = i;
+            return CMD_BLOCKED;
+        }
+
+        // ADD SPACE SEPARATOR, then the quoted parameter
+        if (!StrBufAppendChar(cmd, PS_T(' ')) ||
+            !AppendQuotedParameter(cmd, args->params[i]))
+        {
+            return CMD_OVERFLOW;
+        }
+    }
+
+    return CMD_OK;
+}
+
+//--------------------------------------------------------------------------
+// EMBEDDED SCRIPTS - -EncodedCommand wrapper around a script on stdin
+//--------------------------------------------------------------------------
+static inline bool IsNameChar(PSCHAR c)
+{
+    return (c >= PS_T('a') && c <= PS_T('z')) || (c >= PS_T('A') && c <= PS_T('Z')) ||
+           (c >= PS_T('0') && c <= PS_T('9')) || c == PS_T('_');
+}
+
+// -Name or -Name: (the colon form takes the next token as its value)
+static bool IsParameterName(const PSCHAR* p)
+{
+    if (p[0] != PS_T('-') || !IsNameChar(p[1]) || (p[1] >= PS_T('0') && p[1] <= PS_T('9')))
+        return false;
+    for (p += 2; *p; p++)
+    {
+        if (*p == PS_T(':') && p[1] == 0)
+            return true;
+        if (!IsNameChar(*p))
+            return false;
+    }
+    return true;
+}
+
+// PowerShell treats the typographic single quotes U+2018..U+201B as quotes
+// too, so they are doubled along with the apostrophe
+static bool AppendSingleQuoted(StrBuf* sb, const PSCHAR* s, size_t len)
+{
+    if (!StrBufAppendChar(sb, PS_T('\'')))
+        return false;
+
+    size_t start = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+#ifdef _WIN32
+        size_t quoteLen = (s[i] == L'\'' || (s[i] >= 0x2018 && s[i] <= 0x201B)) ? 1 : 0;
+#else
+        const unsigned char* u = (const unsigned char*)s + i;
+        size_t quoteLen = s[i] == '\'' ? 1 :
+            (i + 2 < len && u[0] == 0xE2 && u[1] == 0x80 && u[2] >= 0x98 && u[2] <= 0x9B) ? 3 : 0;
+#endif
+        if (quoteLen == 0)
+            continue;
+
+        // Flush through the quote, then repeat it
+        if (!StrBufAppendN(sb, s + start, i + quoteLen - start) ||
+            !StrBufAppendN(sb, s + i, quoteLen))
+            return false;
+        i += quoteLen - 1;
+        start = i + 1;
+    }
+
+    return StrBufAppendN(sb, s + start, len - start) && StrBufAppendChar(sb, PS_T('\''));
+}
+
+// The parameters of a wrapper, each after a space
+static CmdStatus AppendWrapperParams(StrBuf* out, const LaunchArgs* args, int* blockedIndex)
+{
+    for (int i = 0; i < args->paramCount; i++)
+    {
+        const PSCHAR* param = args->params[i];
+        if (CheckParameterPolicy(param) != POLICY_OK)
+        {
+            if (blockedIndex)
+                *blockedIndex = i;
+            return CMD_BLOCKED;
+        }
+
+        // ALREADY QUOTED: -File hands the script the text inside the quotes,
+        // so the wrapper does the same
+        size_t len = PsStrLen(param);
+        if (IsAlreadyQuoted(param, len))
+        {
+            param++;
+            len -= 2;
+        }
+
+        bool ok = StrBufAppendChar(out, PS_T(' ')) &&
+                  (IsParameterName(param) ? StrBufAppendN(out, param, len)
+                                          : AppendSingleQuoted(out, param, len));
+        if (!ok)
+            return CMD_OVERFLOW;
+    }
+    return CMD_OK;
+}
+
+CmdStatus BuildEmbeddedWrapper(StrBuf* out, const LaunchArgs* args, int* blockedIndex)
+{
+    if (!StrBufAppend(out, PS_EMBEDDED_PROLOGUE))
+        return CMD_OVERFLOW;
+    return AppendWrapperParams(out, args, blockedIndex);
+}
+
+CmdStatus BuildProbeWrapper(StrBuf* out, const LaunchArgs* args, int* blockedIndex)
+{
+    if (!StrBufAppend(out, PS_PROBE_PROLOGUE) ||
+        !AppendSingleQuoted(out, args->script, PsStrLen(args->script)))
+        return CMD_OVERFLOW;
+    CmdStatus status = AppendWrapperParams(out, args, blockedIndex);
+    if (status != CMD_OK)
+        return status;
+    return StrBufAppend(out, PS_PROBE_EPILOGUE) ? CMD_OK : CMD_OVERFLOW;
+}
+
+typedef CmdStatus (*WrapperFn)(StrBuf* out, const LaunchArgs* args, int* blockedIndex);
+
+static CmdStatus BuildEncodedCommandLine(StrBuf* cmd, const PSCHAR* interpreter, const LaunchArgs* args,
+                                         int* blockedIndex, WrapperFn buildWrapper)
+{
+    if (!AppendQuotedPath(cmd, interpreter) || !StrBufAppend(cmd, PS_EMBEDDED_SWITCHES))
+        return CMD_OVERFLOW;
+
+    // WRAPPER: Built after cmd in the same arena, so cmd moves once when the
+    // encoded text is appended - a single copy of a short prefix
+    StrBuf wrapper;
+    if (!StrBufInit(&wrapper, cmd->arena, 256, cmd->limit))
+        return CMD_OVERFLOW;
+    CmdStatus status = buildWrapper(&wrapper, args, blockedIndex);
+    if (status != CMD_OK)
+        return status;
+
+    // -EncodedCommand takes UTF-16LE on every platform
+    size_t units = wrapper.len;
+    uint8_t* bytes = (uint8_t*)ArenaAlloc(cmd->arena, units * 2 + 1);
+    if (!bytes)
+        return CMD_OVERFLOW;
+#ifdef _WIN32
+    const uint16_t* text = (const uint16_t*)wrapper.data;
+#else
+    uint16_t* text = (uint16_t*)ArenaAlloc(cmd->arena, units * sizeof(uint16_t) + 1);
+    if (!text)
+        return CMD_OVERFLOW;
+    units = Utf8ToUtf16(wrapper.data, wrapper.len, text, units);
+#endif
+    for (size_t i = 0; i < units; i++)
+    {
+        bytes[2 * i] = (uint8_t)text[i];
+        bytes[2 * i + 1] = (uint8_t)(text[i] >> 8);
+    }
+
+    return StrBufAppendBase64(cmd, bytes, units * 2) ? CMD_OK : CMD_OVERFLOW;
+}
+
+CmdStatus BuildEmbeddedCommandLine(StrBuf* cmd, const PSCHAR* interpreter,
+                                   const LaunchArgs* args, int* blockedIndex)
+{
+    return BuildEncodedCommandLine(cmd, interpreter, args, blockedIndex, BuildEmbeddedWrapper);
+}
+
+CmdStatus BuildProbeCommandLine(StrBuf* cmd, const PSCHAR* interpreter,
+                                const LaunchArgs* args, int* blockedIndex)
+{
+    return BuildEncodedCommandLine(cmd, interpreter, args, blockedIndex, BuildProbeWrapper);
+}
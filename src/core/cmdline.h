@@ -0,0 +1,66 @@
+//--------------------------------------------------------------------------
+// COMMAND LINE BUILDING - Interpreter invocation for one script run
+//--------------------------------------------------------------------------
+#ifndef PS_CMDLINE_H
+#define PS_CMDLINE_H
+
+#include "args.h"
+#include "pstypes.h"
+#include "strbuf.h"
+
+PS_EXTERN_C_BEGIN
+
+// Switches placed between the interpreter and the script path
+#define PS_INTERPRETER_SWITCHES PS_T(" -NonInteractive -NoProfile -ExecutionPolicy Bypass -File ")
+
+// Embedded scripts: the script arrives on stdin, the command is a wrapper
+#define PS_EMBEDDED_SWITCHES PS_T(" -NonInteractive -NoProfile -ExecutionPolicy Bypass -EncodedCommand ")
+
+// Reads all of stdin as UTF-8 (a BOM wins) and runs it as a script block
+#define PS_EMBEDDED_PROLOGUE \
+    PS_T("& ([ScriptBlock]::Create([IO.StreamReader]::new(") \
+    PS_T("[Console]::OpenStandardInput(),[Text.Encoding]::UTF8).ReadToEnd()))")
+
+// Startup probes: the first statement prints PROBE_MARKER, then the script
+// runs as "& '<script>' <params>" and its exit code is passed on. Without
+// an explicit exit that is the last native command's code, not -File's 0.
+#define PS_PROBE_PROLOGUE \
+    PS_T("[Console]::Out.Write([string][char]27+']psl;prologue'+[char]7);[Console]::Out.Flush();& ")
+#define PS_PROBE_EPILOGUE PS_T(";exit $LASTEXITCODE")
+
+typedef enum CmdStatus
+{
+    CMD_OK = 0,
+    CMD_OVERFLOW,       // Command line exceeds the builder's limit
+    CMD_BLOCKED         // A parameter was rejected by the policy
+} CmdStatus;
+
+// Build: "<interpreter>" <switches> "<script>" "<param>" ...
+// Appends to cmd (usually empty, limited to PS_MAX_COMMAND_LINE).
+// On CMD_BLOCKED, *blockedIndex receives the offending parameter index.
+CmdStatus BuildCommandLine(StrBuf* cmd, const PSCHAR* interpreter,
+                           const LaunchArgs* args, int* blockedIndex);
+
+// Wrapper text for an embedded script: PS_EMBEDDED_PROLOGUE then the
+// parameters in PowerShell syntax. "-Name" style parameters pass bare so
+// they bind by name; everything else becomes a single-quoted literal with
+// quotes doubled, so no parameter is ever evaluated. Parameters go through
+// the same policy check as BuildCommandLine.
+CmdStatus BuildEmbeddedWrapper(StrBuf* out, const LaunchArgs* args, int* blockedIndex);
+
+// Build: "<interpreter>" <embedded switches> <Base64 of the UTF-16LE wrapper>
+// args->script is only a label here; the script itself goes to stdin.
+CmdStatus BuildEmbeddedCommandLine(StrBuf* cmd, const PSCHAR* interpreter,
+                                   const LaunchArgs* args, int* blockedIndex);
+
+// Wrapper text for a probed run: PS_PROBE_PROLOGUE, the script and the
+// parameters quoted as in BuildEmbeddedWrapper, then PS_PROBE_EPILOGUE
+CmdStatus BuildProbeWrapper(StrBuf* out, const LaunchArgs* args, int* blockedIndex);
+
+// Build: "<interpreter>" <embedded switches> <Base64 of the probe wrapper>
+CmdStatus BuildProbeCommandLine(StrBuf* cmd, const PSCHAR* interpreter,
+                                const LaunchArgs* args, int* blockedIndex);
+
+PS_EXTERN_C_END
+
+#endif // PS_CMDLINE_H
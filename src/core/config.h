@@ -0,0 +1,75 @@
+//--------------------------------------------------------------------------
+// BUILD CONFIGURATION - Feature switches shared by every translation unit
+//--------------------------------------------------------------------------
+// Each switch can also be set from the build system (see CMakeLists.txt),
+// so the defaults below only apply to hand-driven builds like compile.bat.
+
+#ifndef PS_CONFIG_H
+#define PS_CONFIG_H
+
+// Command line limit in characters, without the terminating NUL (StrBuf
+// limits count only the text). CreateProcessW allows 32767 including the
+// NUL. The buffer itself grows on the arena (arena.h), so this is the
+// only limit.
+#define PS_MAX_COMMAND_LINE 32766
+
+// Enable comprehensive logging to AppData\Local\ps-launcher\ps-launcher.log
+// (~/.local/state/ps-launcher/ps-launcher.log on POSIX)
+// Define PS_DISABLE_LOGGING to turn it off
+#if !defined(ENABLE_LOGGING) && !defined(PS_DISABLE_LOGGING)
+    #define ENABLE_LOGGING
+#endif
+
+// Run journal - one record per launch appended to ps-launcher.runs
+// Define PS_DISABLE_RUN_JOURNAL to turn it off
+#if !defined(ENABLE_RUN_JOURNAL) && !defined(PS_DISABLE_RUN_JOURNAL)
+    #define ENABLE_RUN_JOURNAL
+#endif
+
+// Script catalogue - "-Script @alias" and "-Index" (catalog.h)
+// Define PS_DISABLE_CATALOG to turn it off
+#if !defined(ENABLE_CATALOG) && !defined(PS_DISABLE_CATALOG)
+    #define ENABLE_CATALOG
+#endif
+
+// Resident scheduler - "-Schedule" (scheduler.h)
+// Define PS_DISABLE_SCHEDULER to turn it off
+#if !defined(ENABLE_SCHEDULER) && !defined(PS_DISABLE_SCHEDULER)
+    #define ENABLE_SCHEDULER
+#endif
+
+// Watch mode - "-Watch" (watch.h)
+// Define PS_DISABLE_WATCH to turn it off
+#if !defined(ENABLE_WATCH) && !defined(PS_DISABLE_WATCH)
+    #define ENABLE_WATCH
+#endif
+
+// Submission server - "-Serve" (server.h)
+// Define PS_DISABLE_SERVER to turn it off
+#if !defined(ENABLE_SERVER) && !defined(PS_DISABLE_SERVER)
+    #define ENABLE_SERVER
+#endif
+
+// Status board - live runs in shared memory and "-Status" (status.h)
+// Define PS_DISABLE_STATUS_BOARD to turn it off
+#if !defined(ENABLE_STATUS_BOARD) && !defined(PS_DISABLE_STATUS_BOARD)
+    #define ENABLE_STATUS_BOARD
+#endif
+
+// Run metrics - duration histograms and "-Metrics" (metrics.h)
+// Define PS_DISABLE_METRICS to turn it off
+#if !defined(ENABLE_METRICS) && !defined(PS_DISABLE_METRICS)
+    #define ENABLE_METRICS
+#endif
+
+// Trace export - Chrome trace events to PS_LAUNCHER_TRACE (trace.h)
+// Define PS_DISABLE_TRACE to turn it off
+#if !defined(ENABLE_TRACE) && !defined(PS_DISABLE_TRACE)
+    #define ENABLE_TRACE
+#endif
+
+// Silent mode - disable MessageBox popups for automated execution
+// Define ENABLE_ERROR_DIALOGS to enable error message popups for debugging
+// #define ENABLE_ERROR_DIALOGS
+
+#endif // PS_CONFIG_H
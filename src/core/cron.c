@@ -0,0 +1,234 @@
+//--------------------------------------------------------------------------
+// CRON EXPRESSIONS - Five-field schedules for the resident scheduler
+//--------------------------------------------------------------------------
+#include "cron.h"
+#include "psbits.h"
+#include "psmem.h"
+#include "psstr.h"
+
+#define MINUTES_PER_DAY 1440
+#define SEARCH_DAYS     (8 * 366)
+
+typedef struct FieldSpec
+{
+    unsigned min;
+    unsigned max;
+    const char* names;               // Three letters per value from min, or NULL
+} FieldSpec;
+
+static const FieldSpec g_fields[CRON_FIELDS] = {
+    { 0, 59, NULL },
+    { 0, 23, NULL },
+    { 1, 31, NULL },
+    { 1, 12, "janfebmaraprmayjunjulaugsepoctnovdec" },
+    { 0, 7,  "sunmontuewedthufrisat" },
+};
+
+//--------------------------------------------------------------------------
+// CALENDAR - Days since 1970-01-01 (H. Hinnant's civil algorithms)
+//--------------------------------------------------------------------------
+int64_t CronDaysFromCivil(int64_t year, unsigned month, unsigned day)
+{
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yoe = year - era * 400;
+    int64_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+void CronCivilFromDays(int64_t days, int64_t* year, unsigned* month, unsigned* day)
+{
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t doe = days - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    *day = (unsigned)(doy - (153 * mp + 2) / 5 + 1);
+    *month = (unsigned)(mp < 10 ? mp + 3 : mp - 9);
+    *year = yoe + era * 400 + (*month <= 2);
+}
+
+//--------------------------------------------------------------------------
+// PARSING
+//--------------------------------------------------------------------------
+static bool ParseValue(const PSCHAR** p, const FieldSpec* spec, unsigned* value)
+{
+    const PSCHAR* s = *p;
+    if (*s >= PS_T('0') && *s <= PS_T('9'))
+    {
+        unsigned v = 0;
+        while (*s >= PS_T('0') && *s <= PS_T('9') && v <= spec->max)
+            v = v * 10 + (unsigned)(*s++ - PS_T('0'));
+        *value = v;
+        *p = s;
+        return true;
+    }
+
+    // Names: exactly three letters, any case
+    for (unsigned i = 0; spec->names && i <= spec->max - spec->min; i++)
+    {
+        const char* name = spec->names + i * 3;
+        if (!name[0])
+            break;
+        unsigned k = 0;
+        while (k < 3 && s[k] && (PSCHAR)(s[k] | 0x20) == (PSCHAR)name[k])
+            k++;
+        if (k == 3)
+        {
+            *value = spec->min + i;
+            *p = s + 3;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool ParseField(const PSCHAR* s, const FieldSpec* spec, uint64_t* mask, bool* star)
+{
+    *mask = 0;
+    *star = s[0] == PS_T('*');
+    for (;;)
+    {
+        unsigned lo, hi, step = 1;
+        bool range = true;
+        if (*s == PS_T('*'))
+        {
+            lo = spec->min;
+            hi = spec->max;
+            s++;
+        }
+        else
+        {
+            if (!ParseValue(&s, spec, &lo))
+                return false;
+            hi = lo;
+            range = false;
+            if (*s == PS_T('-'))
+            {
+                s++;
+                if (!ParseValue(&s, spec, &hi))
+                    return false;
+                range = true;
+            }
+        }
+        if (*s == PS_T('/'))
+        {
+            s++;
+            step = 0;
+            while (*s >= PS_T('0') && *s <= PS_T('9') && step <= spec->max)
+                step = step * 10 + (unsigned)(*s++ - PS_T('0'));
+            if (step == 0)
+                return false;
+            if (!range)
+                hi = spec->max;       // "5/15" is "5-max/15"
+        }
+        if (lo < spec->min || hi > spec->max || lo > hi)
+            return false;
+        for (unsigned v = lo; v <= hi; v += step)
+            *mask |= (uint64_t)1 << v;
+
+        if (*s == 0)
+            return true;
+        if (*s++ != PS_T(','))
+            return false;
+    }
+}
+
+bool CronParse(PSCHAR* const* fields, CronExpr* expr)
+{
+    uint64_t masks[CRON_FIELDS];
+    bool stars[CRON_FIELDS];
+    for (int i = 0; i < CRON_FIELDS; i++)
+    {
+        if (!ParseField(fields[i], &g_fields[i], &masks[i], &stars[i]))
+            return false;
+    }
+
+    // Sunday is both 0 and 7
+    if (masks[4] & 0x80)
+        masks[4] = (masks[4] | 1) & 0x7F;
+
+    expr->minutes = masks[0];
+    expr->hours = (uint32_t)masks[1];
+    expr->days = (uint32_t)masks[2];
+    expr->months = (uint16_t)masks[3];
+    expr->weekdays = (uint8_t)masks[4];
+    expr->anyDay = stars[2];
+    expr->anyWeekday = stars[4];
+    return true;
+}
+
+bool CronParseMacro(const PSCHAR* macro, CronExpr* expr)
+{
+    static const struct { const PSCHAR* name; const PSCHAR* fields[CRON_FIELDS]; } macros[] = {
+        { PS_T("@yearly"),   { PS_T("0"), PS_T("0"), PS_T("1"), PS_T("1"), PS_T("*") } },
+        { PS_T("@annually"), { PS_T("0"), PS_T("0"), PS_T("1"), PS_T("1"), PS_T("*") } },
+        { PS_T("@monthly"),  { PS_T("0"), PS_T("0"), PS_T("1"), PS_T("*"), PS_T("*") } },
+        { PS_T("@weekly"),   { PS_T("0"), PS_T("0"), PS_T("*"), PS_T("*"), PS_T("0") } },
+        { PS_T("@daily"),    { PS_T("0"), PS_T("0"), PS_T("*"), PS_T("*"), PS_T("*") } },
+        { PS_T("@midnight"), { PS_T("0"), PS_T("0"), PS_T("*"), PS_T("*"), PS_T("*") } },
+        { PS_T("@hourly"),   { PS_T("0"), PS_T("*"), PS_T("*"), PS_T("*"), PS_T("*") } },
+    };
+    for (size_t i = 0; i < sizeof(macros) / sizeof(macros[0]); i++)
+    {
+        if (PsStrCmpI(macro, macros[i].name) == 0)
+            return CronParse((PSCHAR* const*)macros[i].fields, expr);
+    }
+    return false;
+}
+
+//--------------------------------------------------------------------------
+// MATCHING
+//--------------------------------------------------------------------------
+static bool DayMatches(const CronExpr* expr, unsigned day, unsigned weekday)
+{
+    bool dayOk = (expr->days >> day) & 1;
+    bool weekdayOk = (expr->weekdays >> weekday) & 1;
+    if (expr->anyDay || expr->anyWeekday)
+        return dayOk && weekdayOk;
+    return dayOk || weekdayOk;
+}
+
+bool CronNext(const CronExpr* expr, int64_t localMinute, int64_t* next)
+{
+    int64_t t = localMinute + 1;
+    int64_t limit = t + (int64_t)SEARCH_DAYS * MINUTES_PER_DAY;
+    while (t < limit)
+    {
+        int64_t days = (t >= 0 ? t : t - (MINUTES_PER_DAY - 1)) / MINUTES_PER_DAY;
+        int64_t year;
+        unsigned month, day;
+        CronCivilFromDays(days, &year, &month, &day);
+
+        // MONTH: Skip to the first of the next one
+        if (!((expr->months >> month) & 1))
+        {
+            t = CronDaysFromCivil(month == 12 ? year + 1 : year, month == 12 ? 1 : month + 1, 1) *
+                MINUTES_PER_DAY;
+            continue;
+        }
+
+        // DAY: 1970-01-01 was a Thursday
+        unsigned weekday = (unsigned)(((days + 4) % 7 + 7) % 7);
+        if (!DayMatches(expr, day, weekday))
+        {
+            t = (days + 1) * MINUTES_PER_DAY;
+            continue;
+        }
+
+        // HOUR, then the first set minute bit in it
+        unsigned minuteOfDay = (unsigned)(t - days * MINUTES_PER_DAY);
+        unsigned hour = minuteOfDay / 60;
+        uint64_t rest = ((expr->hours >> hour) & 1) ? expr->minutes >> (minuteOfDay % 60) : 0;
+        if (!rest)
+        {
+            t = days * MINUTES_PER_DAY + (hour + 1) * 60;
+            continue;
+        }
+        *next = t + LowestBit64(rest);
+        return true;
+    }
+    return false;
+}
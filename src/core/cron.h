@@ -0,0 +1,55 @@
+//--------------------------------------------------------------------------
+// CRON EXPRESSIONS - Five-field schedules for the resident scheduler
+//--------------------------------------------------------------------------
+//   minute hour day-of-month month day-of-week
+// Each field is "*", a value, a range "a-b", or a comma list of those,
+// each optionally stepped ("*/15", "8-18/2"). Months and weekdays also take
+// English three-letter names; Sunday is 0 or 7. As in cron, when both day
+// fields are restricted a day matching either one counts.
+//
+// The macros @yearly (@annually), @monthly, @weekly, @daily (@midnight)
+// and @hourly stand for their usual five-field forms.
+//
+// Fields compile to bit masks, and CronNext walks forward a month, a day,
+// an hour at a time, finishing within the hour with a bit scan, so finding
+// the next match costs a few dozen steps at most - nothing per minute.
+// Times are minutes on the local calendar since 1970-01-01 00:00; the
+// scheduler converts them to and from the wall clock.
+
+#ifndef PS_CRON_H
+#define PS_CRON_H
+
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+#define CRON_FIELDS 5
+
+typedef struct CronExpr
+{
+    uint64_t minutes;                // Bit n: minute n (0-59)
+    uint32_t hours;                  // Bit n: hour n (0-23)
+    uint32_t days;                   // Bit n: day of the month n (1-31)
+    uint16_t months;                 // Bit n: month n (1-12)
+    uint8_t weekdays;                // Bit n: weekday n (0 = Sunday)
+    bool anyDay;                     // Day-of-month field was "*"
+    bool anyWeekday;                 // Day-of-week field was "*"
+} CronExpr;
+
+// Five fields, as split from a schedule line
+bool CronParse(PSCHAR* const* fields, CronExpr* expr);
+
+// "@daily" and friends
+bool CronParseMacro(const PSCHAR* macro, CronExpr* expr);
+
+// First matching minute after localMinute; false if the expression never
+// matches (30 February) within the next eight years
+bool CronNext(const CronExpr* expr, int64_t localMinute, int64_t* next);
+
+// Calendar helpers (proleptic Gregorian, days since 1970-01-01)
+int64_t CronDaysFromCivil(int64_t year, unsigned month, unsigned day);
+void CronCivilFromDays(int64_t days, int64_t* year, unsigned* month, unsigned* day);
+
+PS_EXTERN_C_END
+
+#endif // PS_CRON_H
@@ -0,0 +1,24 @@
+//--------------------------------------------------------------------------
+// MANUAL CRT REPLACEMENT - Low-level memory operations
+//--------------------------------------------------------------------------
+// Only linked into the /NODEFAULTLIB build. The compiler still emits calls
+// to memset and memcpy for struct zeroing (= { 0 }) and struct copies, so
+// they must exist somewhere. Both forward to the vectorized versions in
+// psmem.c.
+
+#include "psmem.h"
+
+#ifdef _MSC_VER
+#pragma function(memset, memcpy)   // Allow definitions even when /Oi is enabled
+#endif
+
+// FUNCTION LINKAGE: __cdecl specifies calling convention (standard C convention)
+void* __cdecl memset(void* dest, int c, size_t count)
+{
+    return PsMemSet(dest, c, count);
+}
+
+void* __cdecl memcpy(void* dest, const void* src, size_t count)
+{
+    return PsMemCpy(dest, src, count);
+}
@@ -0,0 +1,116 @@
+//--------------------------------------------------------------------------
+// ENCODING - UTF-8 to UTF-16 and Base64, CRT-free
+//--------------------------------------------------------------------------
+#include "encoding.h"
+
+#define REPLACEMENT_CHAR 0xFFFDu
+
+size_t Utf8ToUtf16(const char* src, size_t len, uint16_t* out, size_t outCap)
+{
+    const uint8_t* p = (const uint8_t*)src;
+    const uint8_t* end = p + len;
+    size_t n = 0;
+
+    while (p < end)
+    {
+        uint32_t cp = *p++;
+        int extra = 0;
+        uint32_t min = 0;
+
+        // LEAD BYTE: Sequence length and the smallest legal value for it
+        if (cp >= 0xF0 && cp <= 0xF4)      { extra = 3; cp &= 0x07; min = 0x10000; }
+        else if (cp >= 0xE0 && cp <= 0xEF) { extra = 2; cp &= 0x0F; min = 0x800; }
+        else if (cp >= 0xC2 && cp <= 0xDF) { extra = 1; cp &= 0x1F; min = 0x80; }
+        else if (cp >= 0x80)               { cp = REPLACEMENT_CHAR; }
+
+        for (; extra > 0; extra--)
+        {
+            if (p >= end || (*p & 0xC0) != 0x80)
+            {
+                cp = REPLACEMENT_CHAR;
+                min = 0;
+                break;
+            }
+            cp = (cp << 6) | (*p++ & 0x3F);
+        }
+
+        // Overlong forms, surrogates and values past U+10FFFF are invalid
+        if (cp < min || (cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF)
+            cp = REPLACEMENT_CHAR;
+
+        if (cp >= 0x10000)
+        {
+            if (outCap - n < 2)
+                return 0;
+            cp -= 0x10000;
+            out[n++] = (uint16_t)(0xD800 + (cp >> 10));
+            out[n++] = (uint16_t)(0xDC00 + (cp & 0x3FF));
+        }
+        else
+        {
+            if (n >= outCap)
+                return 0;
+            out[n++] = (uint16_t)cp;
+        }
+    }
+    return n;
+}
+
+bool StrBufAppendBase64(StrBuf* sb, const void* data, size_t size)
+{
+    static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const uint8_t* p = (const uint8_t*)data;
+
+    if (!StrBufReserve(sb, BASE64_LENGTH(size)))
+        return false;
+
+    PSCHAR* out = sb->data + sb->len;
+    size_t i = 0;
+    for (; i + 3 <= size; i += 3)
+    {
+        uint32_t v = ((uint32_t)p[i] << 16) | ((uint32_t)p[i + 1] << 8) | p[i + 2];
+        *out++ = (PSCHAR)alphabet[v >> 18];
+        *out++ = (PSCHAR)alphabet[(v >> 12) & 63];
+        *out++ = (PSCHAR)alphabet[(v >> 6) & 63];
+        *out++ = (PSCHAR)alphabet[v & 63];
+    }
+    if (i < size)
+    {
+        uint32_t v = (uint32_t)p[i] << 16;
+        if (i + 1 < size)
+            v |= (uint32_t)p[i + 1] << 8;
+        *out++ = (PSCHAR)alphabet[v >> 18];
+        *out++ = (PSCHAR)alphabet[(v >> 12) & 63];
+        *out++ = (i + 1 < size) ? (PSCHAR)alphabet[(v >> 6) & 63] : PS_T('=');
+        *out++ = PS_T('=');
+    }
+
+    sb->len = (size_t)(out - sb->data);
+    *out = 0;
+    return true;
+}
+
+PSCHAR* ArenaReadText(Arena* arena, const PSCHAR* path, size_t maxSize, size_t* len)
+{
+    size_t size = 0;
+    char* raw = (char*)ArenaReadFile(arena, path, maxSize, &size);
+    if (!raw)
+        return NULL;
+    if (size >= 3 && (uint8_t)raw[0] == 0xEF && (uint8_t)raw[1] == 0xBB && (uint8_t)raw[2] == 0xBF)
+    {
+        raw += 3;
+        size -= 3;
+    }
+#ifdef _WIN32
+    PSCHAR* text = (PSCHAR*)ArenaAlloc(arena, (size + 1) * sizeof(PSCHAR));
+    if (!text)
+        return NULL;
+    size = Utf8ToUtf16(raw, size, (uint16_t*)text, size);
+#else
+    PSCHAR* text = raw;
+#endif
+    text[size] = 0;
+    *len = size;
+    return text;
+}
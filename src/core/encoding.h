@@ -0,0 +1,35 @@
+//--------------------------------------------------------------------------
+// ENCODING - UTF-8 to UTF-16 and Base64, CRT-free
+//--------------------------------------------------------------------------
+// Needed to hand an embedded script's wrapper to the interpreter as
+// -EncodedCommand, which takes Base64 of UTF-16LE text on every platform,
+// and to read the UTF-8 configuration files (catalogue, schedule).
+
+#ifndef PS_ENCODING_H
+#define PS_ENCODING_H
+
+#include "arena.h"
+#include "pstypes.h"
+#include "strbuf.h"
+
+PS_EXTERN_C_BEGIN
+
+// Decode len bytes of UTF-8 into UTF-16 code units (no terminator written)
+// Invalid or truncated sequences become U+FFFD. Never writes more units
+// than len, so an output of len units always fits.
+// Returns the units written, or 0 if outCap is too small.
+size_t Utf8ToUtf16(const char* src, size_t len, uint16_t* out, size_t outCap);
+
+// A UTF-8 text file (optional BOM) as terminated native text on arena;
+// len gets its length in PSCHAR units. NULL if unreadable or too large.
+PSCHAR* ArenaReadText(Arena* arena, const PSCHAR* path, size_t maxSize, size_t* len);
+
+// Characters produced by Base64 for n bytes (padded, no line breaks)
+#define BASE64_LENGTH(n) ((((n) + 2) / 3) * 4)
+
+// Append the RFC 4648 Base64 encoding of data (with '=' padding)
+bool StrBufAppendBase64(StrBuf* sb, const void* data, size_t size);
+
+PS_EXTERN_C_END
+
+#endif // PS_ENCODING_H
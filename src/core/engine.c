@@ -0,0 +1,653 @@
+//--------------------------------------------------------------------------
+// LAUNCH ENGINE - C API for running scripts from another program
+//--------------------------------------------------------------------------
+#include "engine.h"
+#include "adaptive.h"
+#include "arena.h"
+#include "cmdline.h"
+#include "config.h"
+#include "envblock.h"
+#include "history.h"
+#include "metrics.h"
+#include "plan.h"
+#include "platform.h"
+#include "psmem.h"
+#include "psstr.h"
+#include "resource.h"
+#include "runid.h"
+#include "runrecord.h"
+#include "searchpath.h"
+#include "strbuf.h"
+#include "trace.h"
+
+#define PSL_READ_CHUNK     (64 * 1024)
+#define PSL_READS_PER_PASS 4             // Per run and pass: a chatty child cannot starve the rest
+#define PSL_FINAL_READS    1024          // After exit: what the child left in the pipe
+#define PSL_EXIT_CHECK_MS  100           // While a grandchild may hold the pipe open
+
+#if PSL_MAX_RESOURCES != RESOURCE_MAX_HELD
+#error PSL_MAX_RESOURCES must match RESOURCE_MAX_HELD
+#endif
+
+struct PslRun
+{
+    PlatProcess proc;
+    PlatFile output;                     // PLAT_INVALID_FILE once closed
+    PslCallbacks callbacks;
+    uint64_t startNanos;
+    uint64_t spawnedNanos;
+    uint64_t outputBytes;
+    uint32_t track;                      // Trace track (trace.h)
+    RunId id;
+    RunId parent;
+    uint64_t startMillis;
+    PSCHAR script[PS_MAX_PATH];          // As the command named it; empty if too long to journal
+    PslStats* waitStats;                 // Set by PslWait
+    uint32_t generation;                 // Bumped as the slot is freed
+    bool active;
+    bool cancelled;
+    PslRun* nextFree;
+};
+
+struct PslEngine
+{
+    Arena arena;                         // The engine, its slots and buffers
+    Arena scratch;                       // One command at a time
+    PSCHAR interpreter[PS_MAX_PATH];
+    bool haveInterpreter;
+    PslRun* runs;
+    PslRun** active;                     // Dense: the first running entries
+    PlatFile* pipes;                     // Wait set, rebuilt every pass:
+    PlatProcess* exiting;                // ...and runs whose output has closed
+    PslRun* freeList;
+    uint8_t* buffer;
+    uint32_t running;
+    uint32_t maxRuns;
+    uint32_t limit;                      // maxRuns unless adaptive
+    bool adaptive;
+    Adaptive control;
+    uint64_t idleSince;                  // Last time running fell to zero
+    uint32_t lastError;
+    uint32_t tracks;
+    TraceBuffer trace;
+    RunIdSource ids;
+    RunId id;                            // Default parent of every run
+    RunId parent;
+    ResourceTable resources;             // Batch jobs' tags
+};
+
+//--------------------------------------------------------------------------
+// ENGINE
+//--------------------------------------------------------------------------
+PslEngine* PslCreate(uint32_t maxRuns)
+{
+    if (maxRuns == 0)
+        maxRuns = PSL_DEFAULT_MAX_RUNS;
+    Arena arena;
+    if (!ArenaInit(&arena, ARENA_DEFAULT_RESERVE))
+        return NULL;
+    PslEngine* e = (PslEngine*)ArenaAlloc(&arena, sizeof(PslEngine));
+    PslRun* runs = (PslRun*)ArenaAlloc(&arena, maxRuns * sizeof(PslRun));
+    PslRun** active = (PslRun**)ArenaAlloc(&arena, maxRuns * sizeof(PslRun*));
+    PlatFile* pipes = (PlatFile*)ArenaAlloc(&arena, maxRuns * sizeof(PlatFile));
+    PlatProcess* exiting = (PlatProcess*)ArenaAlloc(&arena, maxRuns * sizeof(PlatProcess));
+    uint8_t* buffer = (uint8_t*)ArenaAlloc(&arena, PSL_READ_CHUNK);
+    if (!e || !runs || !active || !pipes || !exiting || !buffer)
+    {
+        ArenaRelease(&arena);
+        return NULL;
+    }
+    PsMemSet(e, 0, sizeof(*e));
+    PsMemSet(runs, 0, maxRuns * sizeof(PslRun));
+    if (!ArenaInit(&e->scratch, ARENA_DEFAULT_RESERVE))
+    {
+        ArenaRelease(&arena);
+        return NULL;
+    }
+    e->arena = arena;                   // From here on only e->arena is used
+    e->runs = runs;
+    e->active = active;
+    e->pipes = pipes;
+    e->exiting = exiting;
+    e->buffer = buffer;
+    e->maxRuns = maxRuns;
+    e->limit = maxRuns;
+    ResourceInit(&e->resources);
+    RunIdBegin(&e->ids, &e->id, &e->parent);
+    TraceBegin(&e->trace, &e->arena, "ps-launcher engine", TRACE_DEFAULT_EVENTS);
+    TraceSetRun(&e->trace, &e->id, &e->parent);
+    for (uint32_t i = maxRuns; i > 0; i--)
+    {
+        runs[i - 1].nextFree = e->freeList;
+        e->freeList = &runs[i - 1];
+    }
+
+    // Resolved once: every run of the engine uses the same interpreter
+    e->haveInterpreter = PlatGetInterpreterPath(e->interpreter, PS_MAX_PATH) &&
+                         PlatFileExists(e->interpreter);
+    return e;
+}
+
+void PslDestroy(PslEngine* engine)
+{
+    if (!engine)
+        return;
+    for (uint32_t i = 0; i < engine->running; i++)
+    {
+        PslRun* r = engine->active[i];
+        if (r->output != PLAT_INVALID_FILE)
+            PlatCloseFile(r->output);
+        PlatCloseProcess(&r->proc);
+    }
+    TraceClose(&engine->trace);
+    ArenaRelease(&engine->scratch);
+    Arena arena = engine->arena;        // The engine lives in its own arena
+    ArenaRelease(&arena);
+}
+
+//--------------------------------------------------------------------------
+// COMMANDS
+//--------------------------------------------------------------------------
+// Script lookup as the launcher does it, with a relative script taken
+// from the run's own directory when it has one. The child starts in that
+// directory, so such a script is passed on as given, not joined to it.
+static PslStatus Build(PslEngine* e, const PslCommand* command, StrBuf* cmd)
+{
+    if (!e->haveInterpreter || !command->script || !command->script[0])
+        return PSL_NOT_FOUND;
+
+    const PSCHAR* script = command->script;
+    const PSCHAR* probe = script;
+    bool relative = IsRelativePath(script);
+    if (command->directory && relative)
+    {
+        StrBuf joined;
+        if (!StrBufInit(&joined, &e->scratch, PS_MAX_PATH, PS_MAX_COMMAND_LINE) ||
+            !StrBufAppend(&joined, command->directory) || !StrBufAppendChar(&joined, PS_PATH_SEP) ||
+            !StrBufAppend(&joined, script))
+            return PSL_NO_MEMORY;
+        probe = joined.data;
+    }
+    if (!PlatFileExists(probe))
+    {
+        script = relative ? FindOnScriptPath(&e->scratch, command->script) : NULL;
+        if (!script)
+            return PSL_NOT_FOUND;
+    }
+
+    LaunchArgs args = { script, (PSCHAR* const*)command->params, command->paramCount };
+    int blocked = -1;
+    if (!StrBufInit(cmd, &e->scratch, 1024, PS_MAX_COMMAND_LINE))
+        return PSL_NO_MEMORY;
+    switch (BuildCommandLine(cmd, e->interpreter, &args, &blocked))
+    {
+    case CMD_OK:
+        return PSL_OK;
+    case CMD_BLOCKED:
+        return PSL_BLOCKED;
+    default:
+        return PSL_TOO_LONG;
+    }
+}
+
+PslStatus PslBuildCommand(PslEngine* engine, const PslCommand* command, PSCHAR* out, size_t outSize)
+{
+    ArenaRestore(&engine->scratch, 0);
+    StrBuf cmd;
+    PslStatus status = Build(engine, command, &cmd);
+    if (status == PSL_OK && cmd.len + 1 > outSize)
+        status = PSL_TOO_LONG;
+    if (status == PSL_OK)
+        PsMemCpy(out, cmd.data, (cmd.len + 1) * sizeof(PSCHAR));
+    ArenaRestore(&engine->scratch, 0);
+    return status;
+}
+
+//--------------------------------------------------------------------------
+// RUNS
+//--------------------------------------------------------------------------
+PslStatus PslStart(PslEngine* engine, const PslCommand* command, const PslCallbacks* callbacks,
+                   PslRun** run)
+{
+    PslEngine* e = engine;
+    *run = NULL;
+    if (!e->freeList || e->running >= e->limit)
+    {
+        if (e->adaptive)
+            AdaptiveRefused(&e->control);
+        return PSL_BUSY;
+    }
+
+    // An empty entry would end the environment block early
+    for (int i = 0; i < command->envCount; i++)
+    {
+        if (!command->env[i] || !command->env[i][0])
+            return PSL_BLOCKED;
+    }
+
+    ArenaRestore(&e->scratch, 0);
+    StrBuf cmd;
+    PslStatus status = Build(e, command, &cmd);
+    if (status != PSL_OK)
+        return status;
+    RunId parent = e->id;
+    if (command->parent && !RunIdParse(command->parent, &parent))
+        return PSL_BLOCKED;
+
+    // ENVIRONMENT: The command's variables, then the run ids over them
+    RunId id = RunIdNext(&e->ids, PlatWallClockMillis());
+    const PSCHAR** vars = (const PSCHAR**)ArenaAlloc(&e->scratch,
+                                                     (size_t)(command->envCount + RUN_ID_VARS) * sizeof(PSCHAR*));
+    if (!vars || !RunIdVariables(&e->scratch, &id, &parent, NULL, vars + command->envCount))
+        return PSL_NO_MEMORY;
+    for (int i = 0; i < command->envCount; i++)
+        vars[i] = command->env[i];
+    const PSCHAR* envBlock = BuildEnvironmentBlock(&e->scratch, NULL, vars, command->envCount + RUN_ID_VARS);
+    if (!envBlock)
+        return PSL_NO_MEMORY;
+
+    PslRun* r = e->freeList;
+    r->startNanos = PlatMonotonicNanos();
+    if (!PlatSpawnCaptured(e->interpreter, cmd.data, envBlock, command->directory, &r->proc, &r->output))
+    {
+        e->lastError = PlatLastError();
+        return PSL_SPAWN_FAILED;
+    }
+    r->spawnedNanos = PlatMonotonicNanos();
+    r->startMillis = PlatWallClockMillis();
+    r->id = id;
+    r->parent = parent;
+    size_t scriptLen = 0;
+    if (!AppendStr(r->script, PS_MAX_PATH, command->script, &scriptLen))
+        r->script[0] = 0;
+    r->track = ++e->tracks;
+    TraceNameTrack(&e->trace, r->track, "run", r->track);
+    TraceSpanArg(&e->trace, r->track, &r->id, "spawn", r->startNanos, r->spawnedNanos, "pid", r->proc.pid);
+    e->freeList = r->nextFree;
+    PsMemSet(&r->callbacks, 0, sizeof(r->callbacks));
+    if (callbacks)
+        r->callbacks = *callbacks;
+    r->outputBytes = 0;
+    r->waitStats = NULL;
+    r->cancelled = false;
+    r->active = true;
+    // IDLE: A spell with nothing to run says nothing about throughput;
+    // the moment between one run and the next at a limit of one is no spell
+    if (e->adaptive && e->running == 0 && r->startNanos - e->idleSince > ADAPTIVE_SAMPLE_MS * 1000000ull)
+        AdaptiveRestart(&e->control, r->startNanos);
+    e->active[e->running++] = r;
+    *run = r;
+    return PSL_OK;
+}
+
+// Whatever the pipe holds now; after exit, everything the child left
+static void Drain(PslEngine* e, PslRun* r, bool exited)
+{
+    if (r->output == PLAT_INVALID_FILE)
+        return;
+    int limit = exited ? PSL_FINAL_READS : PSL_READS_PER_PASS;
+    for (int n = 0; n < limit; n++)
+    {
+        size_t got;
+        bool open = PlatReadAvailable(r->output, e->buffer, PSL_READ_CHUNK, &got);
+        if (got > 0)
+        {
+            if (r->outputBytes == 0)
+                TraceInstant(&e->trace, r->track, &r->id, "first output", PlatMonotonicNanos());
+            r->outputBytes += got;
+            if (r->callbacks.output)
+                r->callbacks.output(r->callbacks.ctx, r, e->buffer, got);
+        }
+        if (!open || (got == 0 && exited))
+        {
+            // A grandchild still holding the pipe loses the rest
+            PlatCloseFile(r->output);
+            r->output = PLAT_INVALID_FILE;
+            return;
+        }
+        if (got == 0)
+            return;
+    }
+}
+
+// Journal and metrics, as the launcher records its own runs, so history
+// ordering (PSL_ORDER_HISTORY) learns from engine batches too
+static void RecordRun(PslEngine* e, const PslRun* r, uint32_t exitCode, uint64_t exitNanos)
+{
+    if (!r->script[0])
+        return;
+    RunRecord record = { 0 };
+    record.script = r->script;
+    record.startMillis = r->startMillis;
+    record.durationMicros = (exitNanos - r->startNanos) / 1000;
+    record.exitCode = exitCode;
+    record.status = r->cancelled ? RUN_CANCELLED : RUN_COMPLETED;
+    record.id = r->id;
+    record.parent = r->parent;
+    RunTiming timing = { r->startNanos, 0, r->spawnedNanos, exitNanos, 0, 0 };
+    ArenaMark mark = ArenaSave(&e->scratch);
+    AppendRunRecord(&record, &e->scratch);
+    ArenaRestore(&e->scratch, mark);
+    RecordRunMetrics(&record, &timing);
+}
+
+static void Finish(PslEngine* e, PslRun* r, uint32_t exitCode, const PlatUsage* usage)
+{
+    uint64_t exitNanos = PlatMonotonicNanos();
+    PslStats stats;
+    stats.exitCode = exitCode;
+    stats.cancelled = r->cancelled ? 1 : 0;
+    stats.wallMicros = (exitNanos - r->startNanos) / 1000;
+    stats.userMicros = usage->userMicros;
+    stats.kernelMicros = usage->kernelMicros;
+    stats.peakMemoryBytes = usage->peakMemoryBytes;
+    stats.outputBytes = r->outputBytes;
+    TraceSpanArg(&e->trace, r->track, &r->id, "run", r->spawnedNanos, exitNanos, "exitCode", exitCode);
+    RecordRun(e, r, exitCode, exitNanos);
+    PlatCloseProcess(&r->proc);
+    r->active = false;
+    if (e->adaptive)
+        AdaptiveCompleted(&e->control);
+    if (e->running == 0)
+        e->idleSince = PlatMonotonicNanos();
+
+    if (r->waitStats)
+        *r->waitStats = stats;
+    r->generation++;
+    if (r->callbacks.exit)
+        r->callbacks.exit(r->callbacks.ctx, r, &stats);
+    r->nextFree = e->freeList;
+    e->freeList = r;
+}
+
+//--------------------------------------------------------------------------
+// ADAPTIVE CONCURRENCY
+//--------------------------------------------------------------------------
+void PslSetAdaptive(PslEngine* engine, bool enabled)
+{
+    PslEngine* e = engine;
+    e->adaptive = enabled;
+    e->limit = e->maxRuns;
+    if (!enabled)
+        return;
+    AdaptiveInit(&e->control, e->maxRuns, PlatProcessorCount(), PlatMonotonicNanos());
+    e->limit = AdaptiveLimit(&e->control);
+    TraceNameTrack(&e->trace, 0, "concurrency, max", e->maxRuns);
+    TraceCounter(&e->trace, "run limit", "limit", e->limit, PlatMonotonicNanos());
+}
+
+bool PslSetResourceLimit(PslEngine* engine, const PSCHAR* name, uint32_t limit)
+{
+    return ResourceDeclare(&engine->resources, name, limit);
+}
+
+uint32_t PslRunLimit(const PslEngine* engine)
+{
+    return engine->limit;
+}
+
+// Sample the machine now and then; true when a decision raised the limit
+static bool Adapt(PslEngine* e)
+{
+    uint64_t now = PlatMonotonicNanos();
+    if (!e->adaptive || !AdaptiveSampleDue(&e->control, now))
+        return false;
+    PlatLoad load;
+    PlatSystemLoad(&load);
+    AdaptiveSignals signals = { load.runnable, load.availableBytes, load.totalBytes };
+    AdaptiveDecision d;
+    if (!AdaptiveSample(&e->control, now, &signals, &d))
+        return false;
+
+    // EVERY DECISION: What it was, and what it was made from
+    TracePut(&e->trace, TRACE_INSTANT, 0, NULL, AdaptiveReasonText(d.reason), now, now, "limit", d.limit);
+    TraceCounter(&e->trace, "run limit", "limit", d.limit, now);
+    TraceCounter(&e->trace, "completion rate", "perKs", d.ratePerKs, now);
+    TraceCounter(&e->trace, "run queue", "runnable", d.runnable, now);
+    TraceCounter(&e->trace, "available memory", "MB", d.availableBytes >> 20, now);
+    e->limit = d.limit;
+    return d.limit > d.previous;
+}
+
+int PslPoll(PslEngine* engine, uint32_t timeoutMillis)
+{
+    PslEngine* e = engine;
+    uint64_t start = PlatMonotonicNanos();
+    int finished = 0;
+    while (e->running > 0)
+    {
+        // PASS: Output of every run, then the exits. Finish may start new
+        // runs from a callback; they land at the end and are seen below.
+        uint32_t open = 0, closed = 0;
+        for (uint32_t i = 0; i < e->running;)
+        {
+            PslRun* r = e->active[i];
+            uint32_t exitCode;
+            PlatUsage usage;
+            bool exited = PlatPollProcessUsage(&r->proc, &exitCode, &usage);
+            Drain(e, r, exited);
+            if (!exited)
+            {
+                if (r->output != PLAT_INVALID_FILE)
+                    e->pipes[open++] = r->output;
+                else
+                    e->exiting[closed++] = r->proc;
+                i++;
+                continue;
+            }
+            e->active[i] = e->active[--e->running];
+            Finish(e, r, exitCode, &usage);
+            finished++;
+        }
+
+        // RAISED: The host may have runs waiting for the room
+        bool raised = Adapt(e);
+        uint64_t elapsed = (PlatMonotonicNanos() - start) / 1000000;
+        if (finished > 0 || raised || e->running == 0 ||
+            (timeoutMillis != PLAT_WAIT_FOREVER && elapsed >= timeoutMillis))
+            break;
+
+        // WAIT: For output, or for the exit that follows a pipe closing. A
+        // pipe a grandchild holds open hides the exit, so look now and then.
+        uint32_t wait = timeoutMillis == PLAT_WAIT_FOREVER ? PLAT_WAIT_FOREVER
+                                                           : timeoutMillis - (uint32_t)elapsed;
+        PlatWaitOutput(e->pipes, open, e->exiting, closed,
+                       wait < PSL_EXIT_CHECK_MS ? wait : PSL_EXIT_CHECK_MS);
+    }
+    return finished;
+}
+
+//--------------------------------------------------------------------------
+// BATCHES
+//--------------------------------------------------------------------------
+typedef struct Batch
+{
+    PslEngine* engine;
+    PlanGraph graph;
+    const PslJob* jobs;
+    PslJobResult* results;
+    uint32_t running;
+} Batch;
+
+typedef struct BatchJob
+{
+    ResourceClaim claim;                 // First member: a claim is its job
+    Batch* batch;
+    uint32_t job;
+} BatchJob;
+
+static void BatchOutput(void* ctx, PslRun* run, const void* data, size_t size)
+{
+    BatchJob* j = (BatchJob*)ctx;
+    const PslCallbacks* callbacks = &j->batch->jobs[j->job].callbacks;
+    if (callbacks->output)
+        callbacks->output(callbacks->ctx, run, data, size);
+}
+
+static void BatchExit(void* ctx, PslRun* run, const PslStats* stats)
+{
+    BatchJob* j = (BatchJob*)ctx;
+    Batch* b = j->batch;
+    b->results[j->job].status = PSL_OK;
+    b->results[j->job].stats = *stats;
+    b->running--;
+    ResourceRelease(&b->engine->resources, &j->claim);
+    PlanDone(&b->graph, j->job, stats->exitCode == 0 && !stats->cancelled);
+    const PslCallbacks* callbacks = &b->jobs[j->job].callbacks;
+    if (callbacks->exit)
+        callbacks->exit(callbacks->ctx, run, stats);
+}
+
+PslStatus PslRunBatch(PslEngine* engine, const PslJob* jobs, uint32_t count, PslOrder order,
+                      PslJobResult* results)
+{
+    PslEngine* e = engine;
+    Arena arena;
+    if (!ArenaInit(&arena, ARENA_DEFAULT_RESERVE))
+        return PSL_NO_MEMORY;
+    PsMemSet(results, 0, count * sizeof(PslJobResult));
+
+    // EXPECTED DURATIONS: From the journal, or none at all for FIFO, which
+    // leaves every rank equal and the batch in its own order
+    PlanJob* plan = (PlanJob*)ArenaAlloc(&arena, (count ? count : 1) * sizeof(PlanJob));
+    BatchJob* contexts = (BatchJob*)ArenaAlloc(&arena, (count ? count : 1) * sizeof(BatchJob));
+    History history;
+    if (!plan || !contexts || (order == PSL_ORDER_HISTORY && !HistoryLoad(&history, &arena, NULL)))
+    {
+        ArenaRelease(&arena);
+        return PSL_NO_MEMORY;
+    }
+    bool tagged = true;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        bool known;
+        plan[i].micros = order == PSL_ORDER_HISTORY ? HistoryEstimate(&history, jobs[i].command.script, &known) : 0;
+        plan[i].after = jobs[i].after;
+        plan[i].afterCount = jobs[i].afterCount;
+        contexts[i].job = i;
+        ResourceClaimInit(&contexts[i].claim);
+        for (uint32_t t = 0; t < jobs[i].resourceCount; t++)
+            tagged = tagged && ResourceClaimAdd(&e->resources, &contexts[i].claim, jobs[i].resources[t]);
+    }
+    if (!tagged)
+    {
+        ArenaRelease(&arena);
+        return PSL_BLOCKED;
+    }
+
+    Batch b;
+    b.engine = e;
+    b.jobs = jobs;
+    b.results = results;
+    b.running = 0;
+    switch (PlanBuild(&b.graph, &arena, plan, count, order == PSL_ORDER_HISTORY))
+    {
+    case PLAN_OK:
+        break;
+    case PLAN_BAD_GRAPH:
+        ArenaRelease(&arena);
+        return PSL_BLOCKED;
+    default:
+        ArenaRelease(&arena);
+        return PSL_NO_MEMORY;
+    }
+
+    for (;;)
+    {
+        // START: While there is room, jobs whose tags came free, then ready
+        // jobs - those whose tags are busy wait in line for them. One that
+        // cannot start fails, and so do the jobs after it.
+        uint32_t job;
+        while (e->running < e->limit && e->freeList)
+        {
+            ResourceClaim* freed = ResourceNext(&e->resources);
+            if (freed)
+                job = ((BatchJob*)freed)->job;
+            else if (!PlanNext(&b.graph, &job))
+                break;
+            else if (!ResourceAcquire(&e->resources, &contexts[job].claim))
+                continue;
+            contexts[job].batch = &b;
+            PslCallbacks callbacks = { BatchOutput, BatchExit, &contexts[job] };
+            PslRun* run;
+            PslStatus status = PslStart(e, &jobs[job].command, &callbacks, &run);
+            if (status == PSL_OK)
+            {
+                b.running++;
+                continue;
+            }
+            ResourceRelease(&e->resources, &contexts[job].claim);
+            results[job].status = status;
+            PlanDone(&b.graph, job, false);
+        }
+        if (b.running == 0 && b.graph.ready == 0 && e->resources.waiting == 0)
+            break;
+        if (e->adaptive && b.graph.ready > 0)
+            AdaptiveRefused(&e->control);
+        PslPoll(e, PSL_WAIT_FOREVER);
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (b.graph.skipped[i])
+            results[i].status = PSL_SKIPPED;
+    }
+    ArenaRelease(&arena);
+    return PSL_OK;
+}
+
+void PslWait(PslEngine* engine, PslRun* run, PslStats* stats)
+{
+    // The slot may be reused by a callback before this returns
+    if (!run->active)
+        return;
+    uint32_t generation = run->generation;
+    run->waitStats = stats;
+    while (run->generation == generation)
+        PslPoll(engine, PLAT_WAIT_FOREVER);
+}
+
+PslStatus PslRunSync(PslEngine* engine, const PslCommand* command, PslOutputFn output, void* ctx,
+                     PslStats* stats)
+{
+    PslCallbacks callbacks = { output, NULL, ctx };
+    PslRun* run;
+    PslStatus status = PslStart(engine, command, &callbacks, &run);
+    if (status == PSL_OK)
+        PslWait(engine, run, stats);
+    return status;
+}
+
+bool PslCancel(PslEngine* engine, PslRun* run)
+{
+    (void)engine;
+    if (!run->active || !PlatKillProcess(&run->proc))
+        return false;
+    run->cancelled = true;
+    return true;
+}
+
+uint32_t PslRunning(const PslEngine* engine)
+{
+    return engine->running;
+}
+
+uint32_t PslRunPid(const PslRun* run)
+{
+    return run->proc.pid;
+}
+
+void PslRunId(const PslRun* run, PSCHAR* out)
+{
+    RunIdFormat(&run->id, out);
+}
+
+void PslEngineId(const PslEngine* engine, PSCHAR* out)
+{
+    RunIdFormat(&engine->id, out);
+}
+
+uint32_t PslLastError(const PslEngine* engine)
+{
+    return engine->lastError;
+}
@@ -0,0 +1,201 @@
+//--------------------------------------------------------------------------
+// LAUNCH ENGINE - C API for running scripts from another program
+//--------------------------------------------------------------------------
+// An agent that links pscore runs scripts itself instead of starting
+// ps-launcher.exe, which then starts the interpreter: one process per run
+// instead of two. The engine applies the launcher's rules (interpreter
+// lookup, PS_LAUNCHER_SCRIPT_PATH, the parameter policy, quoting) and adds
+// what an embedding program needs: captured output, resource usage, and
+// many runs at once.
+//
+//   PslEngine* engine = PslCreate(0);
+//   PslStats stats;
+//   PslRunSync(engine, &command, OnOutput, ctx, &stats);     // blocking
+//
+//   PslStart(engine, &command, &callbacks, &run);            // asynchronous
+//   while (PslRunning(engine) > 0)
+//       PslPoll(engine, 1000);       // output and exit callbacks fire here
+//
+// An engine belongs to one thread: every call, and every callback, happens
+// on the thread that drives it. Use one engine per thread to run from
+// several. Callbacks may start and cancel runs, but not destroy the engine.
+//
+// Output is the child's stdout and stderr together, delivered in the
+// order it was read. Scripts are paths; "@alias" and embedded scripts stay
+// with the launcher executable.
+//
+// Batches can let the engine choose how many run at once: with
+// PslSetAdaptive the run limit follows the machine's run queue, its free
+// memory and the runs' completion rate (adaptive.h), and PslStart returns
+// PSL_BUSY at it. A host that starts what it can after every PslPoll
+// (and after PSL_BUSY, once the next run finishes) follows the limit as
+// it moves.
+//
+// PslRunBatch runs a whole batch, optionally with dependencies between
+// its jobs: each starts once the jobs it names have succeeded, and is
+// skipped if one of them failed. Ordered by history, ready jobs start
+// longest expected critical path first (plan.h), from the durations in
+// the run journal (history.h); a batch with no history runs in the order
+// given, as it does with PSL_ORDER_FIFO.
+//
+// Jobs of a batch may name resource tags, each limited with
+// PslSetResourceLimit: a job starts only while every tag it names is
+// below its limit, so jobs that use the same database take turns while
+// the rest run alongside them. A job held back keeps its place in line
+// for its tags (resource.h); a tag without a limit holds nothing back.
+//
+// Every run gets a run id (runid.h), seen by the script in
+// PS_LAUNCHER_RUN_ID; its parent is the engine's own id unless the command
+// names another run, so a host's batches and dependency graphs can be
+// rebuilt from the ids alone. Finished runs go to the run journal and the
+// metrics as launches do (a cancelled one as "cancelled"), which is where
+// history ordering learns their durations.
+//
+// Everything here is plain C with fixed-width types and opaque handles,
+// so the header is the whole ABI; PSL_API_VERSION changes when it does.
+
+#ifndef PS_ENGINE_H
+#define PS_ENGINE_H
+
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+#define PSL_API_VERSION      5
+#define PSL_RUN_ID_CHARS     26          // Run ids, without the terminator
+#define PSL_DEFAULT_MAX_RUNS 256
+#define PSL_MAX_RESOURCES    8           // Tags one job names
+#define PSL_WAIT_FOREVER     0xFFFFFFFFu // Same value as PLAT_WAIT_FOREVER
+
+typedef struct PslEngine PslEngine;
+typedef struct PslRun PslRun;        // Valid until its exit callback returns
+
+typedef enum PslStatus
+{
+    PSL_OK = 0,
+    PSL_NOT_FOUND = 1,               // Interpreter or script missing
+    PSL_BLOCKED = 2,                 // A parameter failed the policy (policy.h),
+                                     // a batch's dependencies have a cycle, or
+                                     // a job names too many resource tags
+    PSL_TOO_LONG = 3,                // Command line over PS_MAX_COMMAND_LINE
+    PSL_SPAWN_FAILED = 4,            // PslLastError has the OS error
+    PSL_BUSY = 5,                    // The run limit already running
+    PSL_NO_MEMORY = 6,
+    PSL_SKIPPED = 7                  // A job this one depends on failed
+} PslStatus;
+
+typedef struct PslCommand
+{
+    const PSCHAR* script;
+    const PSCHAR* const* params;     // Forwarded to the script, in order
+    int paramCount;
+    const PSCHAR* const* env;        // "NAME=value" on top of ours
+    int envCount;
+    const PSCHAR* directory;         // Working directory; NULL: ours
+    const PSCHAR* parent;            // Run id of the run this one follows from
+                                     // (PslRunId); NULL: the engine's
+} PslCommand;
+
+typedef struct PslStats
+{
+    uint32_t exitCode;
+    uint32_t cancelled;              // 1 if PslCancel ended the run
+    uint64_t wallMicros;             // Spawn to exit
+    uint64_t userMicros;
+    uint64_t kernelMicros;
+    uint64_t peakMemoryBytes;
+    uint64_t outputBytes;
+} PslStats;
+
+typedef void (*PslOutputFn)(void* ctx, PslRun* run, const void* data, size_t size);
+typedef void (*PslExitFn)(void* ctx, PslRun* run, const PslStats* stats);
+
+typedef struct PslCallbacks
+{
+    PslOutputFn output;              // Either may be NULL
+    PslExitFn exit;
+    void* ctx;
+} PslCallbacks;
+
+typedef enum PslOrder
+{
+    PSL_ORDER_FIFO = 0,              // As given, as each job becomes ready
+    PSL_ORDER_HISTORY = 1            // Longest expected critical path first
+} PslOrder;
+
+typedef struct PslJob
+{
+    PslCommand command;
+    const uint32_t* after;           // Jobs that must succeed first, by index
+    uint32_t afterCount;
+    PslCallbacks callbacks;
+    const PSCHAR* const* resources;  // Tags it holds while it runs
+    uint32_t resourceCount;          // At most PSL_MAX_RESOURCES
+} PslJob;
+
+typedef struct PslJobResult
+{
+    PslStatus status;                // PSL_OK: it ran, and stats say how
+    PslStats stats;
+} PslJobResult;
+
+// maxRuns 0: PSL_DEFAULT_MAX_RUNS. NULL if out of memory.
+PslEngine* PslCreate(uint32_t maxRuns);
+
+// Runs still going are left running; only their handles are closed
+void PslDestroy(PslEngine* engine);
+
+// The interpreter command line command would run, terminated, into out
+PslStatus PslBuildCommand(PslEngine* engine, const PslCommand* command, PSCHAR* out, size_t outSize);
+
+// Start a run; its callbacks fire from PslPoll, PslWait or PslRunSync.
+// PSL_BLOCKED also covers a parent that is not a run id.
+PslStatus PslStart(PslEngine* engine, const PslCommand* command, const PslCallbacks* callbacks,
+                   PslRun** run);
+
+// Deliver output and exits, waiting up to timeoutMillis (PSL_WAIT_FOREVER
+// allowed) for the first exit. Returns the number of runs that finished;
+// returns at once when nothing is running, and early when an adaptive
+// limit rose.
+int PslPoll(PslEngine* engine, uint32_t timeoutMillis);
+
+// Poll until run finishes; stats may be NULL
+void PslWait(PslEngine* engine, PslRun* run, PslStats* stats);
+
+// PslStart and PslWait in one call
+PslStatus PslRunSync(PslEngine* engine, const PslCommand* command, PslOutputFn output, void* ctx,
+                     PslStats* stats);
+
+// Run every job of the batch, up to the run limit at once, and return
+// when all have finished or been skipped; results has count entries. A
+// job succeeds with exit code 0. Returns PSL_BLOCKED for a cycle, an
+// index out of range or too many tags, before anything starts.
+PslStatus PslRunBatch(PslEngine* engine, const PslJob* jobs, uint32_t count, PslOrder order,
+                      PslJobResult* results);
+
+// Terminate the run; it finishes through the next poll with cancelled set
+bool PslCancel(PslEngine* engine, PslRun* run);
+
+// Adapt the run limit between 1 and maxRuns (on), or fix it at maxRuns
+// (off, the default). Every decision goes to the trace (trace.h).
+void PslSetAdaptive(PslEngine* engine, bool enabled);
+
+// At most limit batch jobs naming the tag run at once (names ASCII
+// case-insensitive). False if limit is 0, the name
+// empty or of 64 characters or more, or 64 tags already have limits.
+bool PslSetResourceLimit(PslEngine* engine, const PSCHAR* name, uint32_t limit);
+
+// How many runs PslStart accepts at once, right now
+uint32_t PslRunLimit(const PslEngine* engine);
+
+uint32_t PslRunning(const PslEngine* engine);
+uint32_t PslRunPid(const PslRun* run);
+
+// PSL_RUN_ID_CHARS characters and a terminator into out
+void PslRunId(const PslRun* run, PSCHAR* out);
+void PslEngineId(const PslEngine* engine, PSCHAR* out);
+uint32_t PslLastError(const PslEngine* engine);
+
+PS_EXTERN_C_END
+
+#endif // PS_ENGINE_H
@@ -0,0 +1,84 @@
+//--------------------------------------------------------------------------
+// ENVIRONMENT BLOCK - Child environment built in the arena
+//--------------------------------------------------------------------------
+#include "envblock.h"
+#include "platform.h"
+#include "psstr.h"
+#include "strbuf.h"
+
+// Length of the NAME part of "NAME=value". Windows keeps per-drive
+// directories as "=C:=C:\dir", so a leading '=' belongs to the name.
+static size_t NameLength(const PSCHAR* entry)
+{
+    const PSCHAR* eq = PsStrChr(entry + (entry[0] == PS_T('=') ? 1 : 0), PS_T('='));
+    return eq ? (size_t)(eq - entry) : PsStrLen(entry);
+}
+
+static bool SameName(const PSCHAR* a, size_t aLen, const PSCHAR* b, size_t bLen)
+{
+    if (aLen != bLen)
+        return false;
+    for (size_t i = 0; i < aLen; i++)
+    {
+        PSCHAR ca = a[i], cb = b[i];
+#ifdef _WIN32
+        // Windows variable names are case-insensitive
+        if (ca >= 'a' && ca <= 'z') ca = (PSCHAR)(ca - ('a' - 'A'));
+        if (cb >= 'a' && cb <= 'z') cb = (PSCHAR)(cb - ('a' - 'A'));
+#endif
+        if (ca != cb)
+            return false;
+    }
+    return true;
+}
+
+const PSCHAR* BuildEnvironmentBlock(Arena* arena, const PSCHAR* base,
+                                    const PSCHAR* const* overrides, int overrideCount)
+{
+    const PSCHAR* source = base ? base : PlatGetEnvironment();
+    StrBuf sb;
+    bool ok = source != NULL && StrBufInit(&sb, arena, 4096, STRBUF_NO_LIMIT);
+
+    // Inherited variables that are not overridden, in their original order
+    for (const PSCHAR* entry = source; ok && *entry; )
+    {
+        size_t entryLen = PsStrLen(entry);
+        size_t nameLen = NameLength(entry);
+        bool replaced = false;
+        for (int i = 0; i < overrideCount && !replaced; i++)
+            replaced = SameName(entry, nameLen, overrides[i], NameLength(overrides[i]));
+
+        if (!replaced)
+            ok = StrBufAppendN(&sb, entry, entryLen + 1);   // Keep the NUL
+        entry += entryLen + 1;
+    }
+
+    // REMOVALS: A bare "NAME" only takes the inherited one out
+    for (int i = 0; ok && i < overrideCount; i++)
+    {
+        size_t len = PsStrLen(overrides[i]);
+        if (NameLength(overrides[i]) < len)
+            ok = StrBufAppendN(&sb, overrides[i], len + 1);
+    }
+
+    // DOUBLE TERMINATOR: The builder already holds one NUL after the last
+    // entry; an empty environment needs the explicit pair
+    if (ok && sb.len == 0)
+        ok = StrBufAppendChar(&sb, 0);
+
+    if (!base && source)
+        PlatFreeEnvironment(source);
+    return ok ? sb.data : NULL;
+}
+
+const PSCHAR* FindEnvironmentValue(const PSCHAR* block, const PSCHAR* name)
+{
+    size_t nameLen = PsStrLen(name);
+    for (const PSCHAR* entry = block; *entry; entry += PsStrLen(entry) + 1)
+    {
+        size_t entryNameLen = NameLength(entry);
+        if (SameName(entry, entryNameLen, name, nameLen))
+            return entry[entryNameLen] ? entry + entryNameLen + 1 : entry + entryNameLen;
+    }
+    return NULL;
+}
@@ -0,0 +1,27 @@
+//--------------------------------------------------------------------------
+// ENVIRONMENT BLOCK - Child environment built in the arena
+//--------------------------------------------------------------------------
+// Layout is the one CreateProcessW takes: "NAME=value\0NAME=value\0\0".
+// The block starts as a copy of the launcher's own environment; each
+// override "NAME=value" replaces a variable of the same name (compared
+// case-insensitively on Windows) or is added at the end; an override
+// "NAME" without a value removes the variable.
+
+#ifndef PS_ENVBLOCK_H
+#define PS_ENVBLOCK_H
+
+#include "arena.h"
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+// base may be NULL to start from the current process environment
+const PSCHAR* BuildEnvironmentBlock(Arena* arena, const PSCHAR* base,
+                                    const PSCHAR* const* overrides, int overrideCount);
+
+// Value of name in block, or NULL (points into the block)
+const PSCHAR* FindEnvironmentValue(const PSCHAR* block, const PSCHAR* name);
+
+PS_EXTERN_C_END
+
+#endif // PS_ENVBLOCK_H
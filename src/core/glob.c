@@ -0,0 +1,231 @@
+//--------------------------------------------------------------------------
+// GLOBS - Wildcard file patterns for incremental mode inputs
+//--------------------------------------------------------------------------
+#include "glob.h"
+#include "platform.h"
+#include "psmem.h"
+#include "psstr.h"
+
+static inline PSCHAR FoldName(PSCHAR c)
+{
+#ifdef _WIN32
+    return (c >= L'A' && c <= L'Z') ? (PSCHAR)(c | 0x20) : c;
+#else
+    return c;
+#endif
+}
+
+static bool IsSeparator(PSCHAR c)
+{
+    return c == PS_PATH_SEP || c == PS_T('/');
+}
+
+static bool HasWildcard(const PSCHAR* s, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        if (s[i] == PS_T('*') || s[i] == PS_T('?'))
+            return true;
+    }
+    return false;
+}
+
+// Iterative matcher: on a mismatch, retry from the last * with one more
+// character consumed. Linear in practice, never exponential.
+bool WildcardMatch(const PSCHAR* pattern, size_t patternLen, const PSCHAR* name, size_t nameLen)
+{
+    size_t p = 0, n = 0;
+    size_t starP = (size_t)-1, starN = 0;
+    while (n < nameLen)
+    {
+        if (p < patternLen && pattern[p] == PS_T('*'))
+        {
+            starP = p++;
+            starN = n;
+        }
+        else if (p < patternLen && (pattern[p] == PS_T('?') || FoldName(pattern[p]) == FoldName(name[n])))
+        {
+            p++;
+            n++;
+        }
+        else if (starP != (size_t)-1)
+        {
+            p = starP + 1;
+            n = ++starN;
+        }
+        else
+            return false;
+    }
+    while (p < patternLen && pattern[p] == PS_T('*'))
+        p++;
+    return p == patternLen;
+}
+
+//--------------------------------------------------------------------------
+// WALK
+//--------------------------------------------------------------------------
+typedef struct Component
+{
+    const PSCHAR* text;
+    size_t len;
+} Component;
+
+typedef struct Name
+{
+    struct Name* next;
+    PlatEntryType type;
+    size_t len;
+    PSCHAR text[1];
+} Name;
+
+typedef struct Glob
+{
+    Arena* arena;
+    const Component* parts;
+    size_t partCount;
+    GlobCallback fn;
+    void* ctx;
+    bool stopped;
+} Glob;
+
+typedef struct Collect
+{
+    Arena* arena;
+    Name* first;
+    bool failed;
+} Collect;
+
+static bool OnName(void* ctx, const PSCHAR* name, size_t nameLen, PlatEntryType type)
+{
+    Collect* c = (Collect*)ctx;
+    Name* n = (Name*)ArenaAlloc(c->arena, sizeof(Name) + nameLen * sizeof(PSCHAR));
+    if (!n)
+    {
+        c->failed = true;
+        return false;
+    }
+    n->type = type;
+    n->len = nameLen;
+    PsMemCpy(n->text, name, nameLen * sizeof(PSCHAR));
+    n->text[nameLen] = 0;
+    n->next = c->first;
+    c->first = n;
+    return true;
+}
+
+// dir + separator + name in the arena
+static PSCHAR* Join(Arena* arena, const PSCHAR* dir, size_t dirLen, const PSCHAR* name,
+                    size_t nameLen, size_t* outLen)
+{
+    PSCHAR* out = (PSCHAR*)ArenaAlloc(arena, (dirLen + nameLen + 2) * sizeof(PSCHAR));
+    if (!out)
+        return NULL;
+    PsMemCpy(out, dir, dirLen * sizeof(PSCHAR));
+    size_t len = dirLen;
+    if (len > 0 && !IsSeparator(dir[len - 1]))
+        out[len++] = PS_PATH_SEP;
+    PsMemCpy(out + len, name, nameLen * sizeof(PSCHAR));
+    len += nameLen;
+    out[len] = 0;
+    *outLen = len;
+    return out;
+}
+
+static void Walk(Glob* g, const PSCHAR* dir, size_t dirLen, size_t part)
+{
+    const Component* c = &g->parts[part];
+    bool last = part + 1 == g->partCount;
+    bool recursive = c->len == 2 && c->text[0] == PS_T('*') && c->text[1] == PS_T('*');
+
+    // "**" also matches no directory at all
+    if (recursive)
+    {
+        if (last)
+            return;
+        Walk(g, dir, dirLen, part + 1);
+    }
+
+    Collect names = { g->arena, NULL, false };
+    if (!PlatListDirectory(dirLen ? dir : PS_T("."), OnName, &names) && names.failed)
+    {
+        g->stopped = true;
+        return;
+    }
+
+    for (Name* n = names.first; n && !g->stopped; n = n->next)
+    {
+        bool isDirectory = n->type == PLAT_ENTRY_DIRECTORY;
+        if (recursive)
+        {
+            if (!isDirectory)
+                continue;
+        }
+        else if (!WildcardMatch(c->text, c->len, n->text, n->len) || (!last && !isDirectory) ||
+                 (last && isDirectory))
+            continue;
+
+        size_t childLen;
+        PSCHAR* child = Join(g->arena, dir, dirLen, n->text, n->len, &childLen);
+        if (!child)
+            g->stopped = true;
+        else if (recursive)
+            Walk(g, child, childLen, part);
+        else if (!last)
+            Walk(g, child, childLen, part + 1);
+        else if (!g->fn(g->ctx, child, childLen))
+            g->stopped = true;
+    }
+}
+
+bool ExpandGlob(Arena* arena, const PSCHAR* pattern, GlobCallback fn, void* ctx)
+{
+    size_t len = PsStrLen(pattern);
+    if (!HasWildcard(pattern, len))
+    {
+        PlatFileInfo info;
+        return !PlatGetFileInfo(pattern, &info) || fn(ctx, pattern, len);
+    }
+
+    // Components from the first one with a wildcard on; the rest is the base
+    size_t count = 1;
+    for (size_t i = 0; i < len; i++)
+        count += IsSeparator(pattern[i]);
+    Component* parts = (Component*)ArenaAlloc(arena, count * sizeof(Component));
+    if (!parts)
+        return false;
+
+    size_t baseLen = 0, partCount = 0;
+    for (size_t start = 0; start <= len;)
+    {
+        size_t end = start;
+        while (end < len && !IsSeparator(pattern[end]))
+            end++;
+        if (partCount == 0 && !HasWildcard(pattern + start, end - start))
+            baseLen = end;
+        else if (end > start)
+        {
+            parts[partCount].text = pattern + start;
+            parts[partCount].len = end - start;
+            partCount++;
+        }
+        start = end + 1;
+    }
+
+    // Keep the root's separator ("/" or "C:\") in the base
+    size_t dirLen = baseLen;
+    if (dirLen == 0 && IsSeparator(pattern[0]))
+        dirLen = 1;
+#ifdef _WIN32
+    if (dirLen == 2 && pattern[1] == L':')
+        dirLen = 3;
+#endif
+    PSCHAR* dir = (PSCHAR*)ArenaAlloc(arena, (dirLen + 1) * sizeof(PSCHAR));
+    if (!dir)
+        return false;
+    PsMemCpy(dir, pattern, dirLen * sizeof(PSCHAR));
+    dir[dirLen] = 0;
+
+    Glob g = { arena, parts, partCount, fn, ctx, false };
+    Walk(&g, dir, dirLen, 0);
+    return !g.stopped;
+}
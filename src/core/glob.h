@@ -0,0 +1,32 @@
+//--------------------------------------------------------------------------
+// GLOBS - Wildcard file patterns for incremental mode inputs
+//--------------------------------------------------------------------------
+// Within one path component, * matches any run of characters and ? any one
+// character; a component that is exactly ** matches any number of
+// directories (including none):
+//   C:\Data\*.csv          D:\Reports\**\summary-??.xml
+// Matching is case-insensitive on Windows, exact on POSIX. Directory
+// links are not followed, so a walk cannot loop.
+
+#ifndef PS_GLOB_H
+#define PS_GLOB_H
+
+#include "arena.h"
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+// Does name match a single-component pattern (no separators)?
+bool WildcardMatch(const PSCHAR* pattern, size_t patternLen, const PSCHAR* name, size_t nameLen);
+
+// Called with the full path of each matching file; return false to stop
+typedef bool (*GlobCallback)(void* ctx, const PSCHAR* path, size_t pathLen);
+
+// Call fn for every file matching pattern. A pattern without wildcards is
+// a plain path and matches if that file exists. False if the walk was
+// stopped or ran out of memory; unreadable directories are skipped.
+bool ExpandGlob(Arena* arena, const PSCHAR* pattern, GlobCallback fn, void* ctx);
+
+PS_EXTERN_C_END
+
+#endif // PS_GLOB_H
@@ -0,0 +1,126 @@
+//--------------------------------------------------------------------------
+// GOVERNOR - Bulk runs step aside while the machine is under pressure
+//--------------------------------------------------------------------------
+#include "governor.h"
+#include "psmem.h"
+
+// "<digits>" up to max; advances *p past them
+static bool ParseWhole(const PSCHAR** p, uint64_t max, uint64_t* value)
+{
+    const PSCHAR* s = *p;
+    *value = 0;
+    if (*s < PS_T('0') || *s > PS_T('9'))
+        return false;
+    while (*s >= PS_T('0') && *s <= PS_T('9'))
+    {
+        *value = *value * 10 + (uint64_t)(*s++ - PS_T('0'));
+        if (*value > max)
+            return false;
+    }
+    *p = s;
+    return true;
+}
+
+bool GovernorParse(Governor* g, const PSCHAR* text)
+{
+    PsMemSet(g, 0, sizeof(*g));
+    uint64_t suspend, resume, cap = GOVERNOR_CAP_SECONDS;
+    const PSCHAR* p = text;
+    if (!ParseWhole(&p, 100, &suspend) || suspend == 0)
+        return false;
+    resume = suspend / 2;
+    if (*p == PS_T(','))
+    {
+        p++;
+        if (!ParseWhole(&p, 100, &resume) || resume >= suspend)
+            return false;
+    }
+    if (*p == PS_T(','))
+    {
+        p++;
+        if (!ParseWhole(&p, 7 * 24 * 3600, &cap))
+            return false;
+    }
+    if (*p != 0)
+        return false;
+    g->suspendAbove = (uint32_t)suspend * 100;
+    g->resumeBelow = (uint32_t)resume * 100;
+    g->capMillis = cap * 1000;
+    return true;
+}
+
+bool GovernorInit(Governor* g)
+{
+    PSCHAR text[64];
+    if (!PlatGetEnv(GOVERNOR_ENV, text, 64) || !GovernorParse(g, text))
+    {
+        PsMemSet(g, 0, sizeof(*g));
+        return false;
+    }
+    return true;
+}
+
+bool GovernorUpdate(Governor* g, uint32_t pressure, uint64_t now)
+{
+    // HYSTERESIS: Suspend at the upper mark, resume at the lower one, and
+    // hold whichever was chosen last for the dwell time
+    g->pressure = pressure;
+    bool want = g->pressed ? pressure > g->resumeBelow : pressure >= g->suspendAbove;
+    if (want != g->pressed && (g->changed == 0 || now - g->changed >= GOVERNOR_DWELL_MS))
+    {
+        g->pressed = want;
+        g->changed = now;
+    }
+    return g->pressed;
+}
+
+bool GovernorCheck(Governor* g, uint64_t now)
+{
+    if (!GovernorEnabled(g) || now < g->nextCheck)
+        return g->pressed;
+    g->nextCheck = now + GOVERNOR_CHECK_MS;
+    PlatPressure pressure;
+    if (!PlatSystemPressure(&pressure))
+        return g->pressed;
+    return GovernorUpdate(g, pressure.cpu > pressure.io ? pressure.cpu : pressure.io, now);
+}
+
+void GovernorAttach(const Governor* g, GovernedRun* run, const PlatProcess* proc, JobClass cls)
+{
+    PsMemSet(run, 0, sizeof(*run));
+    run->tree.handle = -1;
+    run->governed = GovernorEnabled(g) && cls == JOB_BULK && PlatTreeOpen(&run->tree, proc);
+}
+
+void GovernorApply(const Governor* g, GovernedRun* run, bool pressed, uint64_t now)
+{
+    if (!run->governed)
+        return;
+
+    // CAP: Suspended long enough in all, so going from now on
+    uint64_t total = run->suspendedMillis + (run->since ? now - run->since : 0);
+    if (total >= g->capMillis)
+        run->exempt = true;
+
+    bool suspend = pressed && !run->exempt;
+    if (suspend == (run->since != 0) || !PlatTreeSuspend(&run->tree, suspend))
+        return;
+    if (suspend)
+        run->since = now ? now : 1;
+    else
+    {
+        run->suspendedMillis += now - run->since;
+        run->since = 0;
+    }
+}
+
+void GovernorRelease(GovernedRun* run)
+{
+    if (!run->governed)
+        return;
+    if (run->since)
+        PlatTreeSuspend(&run->tree, false);
+    PlatTreeClose(&run->tree);
+    run->since = 0;
+    run->governed = false;
+}
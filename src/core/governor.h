@@ -0,0 +1,89 @@
+//--------------------------------------------------------------------------
+// GOVERNOR - Bulk runs step aside while the machine is under pressure
+//--------------------------------------------------------------------------
+// With PS_LAUNCHER_GOVERN set, the resident scheduler and the submission
+// server suspend their running bulk-class jobs (jobqueue.h) while other
+// work is stalling, and resume them once it is not:
+//
+//   PS_LAUNCHER_GOVERN=<suspend>[,<resume>[,<cap seconds>]]
+//
+// Pressure is the higher of processor and I/O stall time
+// (PlatSystemPressure), sampled at most every GOVERNOR_CHECK_MS. At
+// <suspend> percent or more, bulk runs are suspended, each as its whole
+// process tree (PlatTree); at <resume> percent or less (default half of
+// <suspend>) they go on. In between nothing changes, and no change follows
+// the last within GOVERNOR_DWELL_MS, so a reading that hovers, or that
+// the resumed runs push straight back up, does not flap.
+//
+// A run that has spent <cap seconds> suspended in all (default
+// GOVERNOR_CAP_SECONDS) is resumed for good: a busy machine delays bulk
+// work, it never starves it. Interactive and normal runs are never
+// touched.
+
+#ifndef PS_GOVERNOR_H
+#define PS_GOVERNOR_H
+
+#include "jobqueue.h"
+#include "platform.h"
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+#define GOVERNOR_ENV           PS_T("PS_LAUNCHER_GOVERN")
+#define GOVERNOR_CHECK_MS      1000
+#define GOVERNOR_DWELL_MS      10000
+#define GOVERNOR_CAP_SECONDS   600
+
+// Times are milliseconds on any monotonic clock, the same throughout
+typedef struct Governor
+{
+    uint32_t suspendAbove;           // Hundredths of a percent; 0: off
+    uint32_t resumeBelow;
+    uint64_t capMillis;
+    uint64_t nextCheck;
+    uint64_t changed;                // Last change of pressed; 0: none yet
+    uint32_t pressure;               // Latest sample
+    bool pressed;                    // Bulk runs are to be suspended
+} Governor;
+
+typedef struct GovernedRun
+{
+    PlatTree tree;
+    uint64_t since;                  // Suspended since; 0: going
+    uint64_t suspendedMillis;        // In all, before since
+    bool governed;                   // A bulk run with a tree
+    bool exempt;                     // Its cap is used up
+} GovernedRun;
+
+// Settings in the PS_LAUNCHER_GOVERN form; false, and off, if not valid
+bool GovernorParse(Governor* g, const PSCHAR* text);
+
+// From PS_LAUNCHER_GOVERN; false, and off, when unset or not valid
+bool GovernorInit(Governor* g);
+
+static inline bool GovernorEnabled(const Governor* g)
+{
+    return g->suspendAbove != 0;
+}
+
+// Take a pressure sample (hundredths of a percent); whether bulk runs are
+// to be suspended now
+bool GovernorUpdate(Governor* g, uint32_t pressure, uint64_t now);
+
+// GovernorUpdate with a fresh sample when one is due, else the state as is
+bool GovernorCheck(Governor* g, uint64_t now);
+
+// Govern a run just spawned if it is bulk and the governor is on; always
+// call it, it sets up run
+void GovernorAttach(const Governor* g, GovernedRun* run, const PlatProcess* proc, JobClass cls);
+
+// Suspend or resume the run to match pressed, within its cap
+void GovernorApply(const Governor* g, GovernedRun* run, bool pressed, uint64_t now);
+
+// Resume the run and stop governing it: once it has exited, or before it
+// is left to run unwatched
+void GovernorRelease(GovernedRun* run);
+
+PS_EXTERN_C_END
+
+#endif // PS_GOVERNOR_H
@@ -0,0 +1,290 @@
+//--------------------------------------------------------------------------
+// DURATION HISTORY - How long each script usually runs, from the journal
+//--------------------------------------------------------------------------
+#include "history.h"
+#include "platform.h"
+#include "psmem.h"
+#include "psstr.h"
+
+#define HISTORY_WEIGHT 4                 // A new run moves the estimate a quarter of the way
+
+enum
+{
+    KEY_PATH = 1,
+    KEY_NAME = 2
+};
+
+// FNV-1a 64 over the key, case-folded where file names are, then the kind
+static uint64_t KeyHash(const char* key, size_t len, uint32_t kind)
+{
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < len; i++)
+    {
+        uint8_t c = (uint8_t)key[i];
+#ifdef _WIN32
+        if (c >= 'A' && c <= 'Z')
+            c |= 0x20;
+#endif
+        hash = (hash ^ c) * 0x100000001B3ull;
+    }
+    hash = (hash ^ kind) * 0x100000001B3ull;
+    return hash ? hash : 1;                 // 0 marks an empty slot
+}
+
+static bool SameKey(const HistoryEntry* e, const char* key, size_t len, uint32_t kind)
+{
+    if (e->kind != kind || e->keyLen != len)
+        return false;
+    for (size_t i = 0; i < len; i++)
+    {
+        uint8_t a = (uint8_t)e->key[i], b = (uint8_t)key[i];
+#ifdef _WIN32
+        if (a >= 'A' && a <= 'Z')
+            a |= 0x20;
+        if (b >= 'A' && b <= 'Z')
+            b |= 0x20;
+#endif
+        if (a != b)
+            return false;
+    }
+    return true;
+}
+
+// The entry for key, or the empty slot where it belongs
+static HistoryEntry* Find(const History* h, const char* key, size_t len, uint32_t kind, uint64_t hash)
+{
+    uint32_t mask = h->capacity - 1;
+    for (uint32_t i = (uint32_t)hash & mask;; i = (i + 1) & mask)
+    {
+        HistoryEntry* e = &h->slots[i];
+        if (e->hash == 0 || (e->hash == hash && SameKey(e, key, len, kind)))
+            return e;
+    }
+}
+
+static bool Record(History* h, Arena* arena, const char* key, size_t len, uint32_t kind, uint64_t micros)
+{
+    uint64_t hash = KeyHash(key, len, kind);
+    HistoryEntry* e = Find(h, key, len, kind, hash);
+    if (e->hash == 0)
+    {
+        char* copy = (char*)ArenaAlloc(arena, len);
+        if (!copy)
+            return false;
+        PsMemCpy(copy, key, len);
+        e->hash = hash;
+        e->key = copy;
+        e->keyLen = (uint32_t)len;
+        e->kind = kind;
+        e->runs = 0;
+        if (kind == KEY_PATH)
+            h->scripts++;
+    }
+    if (e->runs == 0)
+        e->micros = micros;
+    else if (micros > e->micros)
+        e->micros += (micros - e->micros) / HISTORY_WEIGHT;
+    else
+        e->micros -= (e->micros - micros) / HISTORY_WEIGHT;
+    e->runs++;
+    return true;
+}
+
+static uint64_t ParseNumber(const char* p, const char* end)
+{
+    uint64_t value = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+        value = value * 10 + (uint64_t)(*p++ - '0');
+    return value;
+}
+
+// One journal line: <start> \t <duration> \t <exit> \t <status> \t ... \t <script>
+static bool ParseLine(History* h, Arena* arena, const char* line, const char* end)
+{
+    const char* tabs[4];
+    int found = 0;
+    const char* lastTab = NULL;
+    for (const char* p = line; p < end; p++)
+    {
+        if (*p != '\t')
+            continue;
+        if (found < 4)
+            tabs[found++] = p;
+        lastTab = p;
+    }
+    if (found < 4)
+        return true;                        // Not a record
+    static const char completed[] = "completed";
+    const char* status = tabs[2] + 1;
+    if ((size_t)(tabs[3] - status) != sizeof(completed) - 1)
+        return true;
+    for (size_t i = 0; i < sizeof(completed) - 1; i++)
+    {
+        if (status[i] != completed[i])
+            return true;
+    }
+
+    const char* script = lastTab + 1;
+    size_t len = (size_t)(end - script);
+    if (len > 0 && script[len - 1] == '\r')
+        len--;
+    if (len == 0 || len > HISTORY_KEY_MAX)
+        return true;
+    uint64_t micros = ParseNumber(tabs[0] + 1, tabs[1]);
+
+    const char* name = script + len;
+    while (name > script && name[-1] != '/' && name[-1] != '\\')
+        name--;
+    return Record(h, arena, script, len, KEY_PATH, micros) &&
+           Record(h, arena, name, (size_t)(script + len - name), KEY_NAME, micros);
+}
+
+static void Swap(uint64_t* values, size_t a, size_t b)
+{
+    uint64_t t = values[a];
+    values[a] = values[b];
+    values[b] = t;
+}
+
+// Quickselect: the k-th smallest, reordering values. Three-way partitions,
+// so runs of equal estimates cost nothing extra.
+static uint64_t Select(uint64_t* values, size_t count, size_t k)
+{
+    size_t lo = 0, hi = count - 1;
+    for (;;)
+    {
+        uint64_t pivot = values[lo + (hi - lo) / 2];
+        size_t lt = lo, i = lo, gt = hi;        // [lo,lt) < pivot <= [lt,i), (gt,hi] > pivot
+        while (i <= gt)
+        {
+            if (values[i] < pivot)
+                Swap(values, lt++, i++);
+            else if (values[i] > pivot)
+                Swap(values, i, gt--);          // The pivot's own copy keeps gt >= lo
+            else
+                i++;
+        }
+        if (k < lt)
+            hi = lt - 1;
+        else if (k > gt)
+            lo = gt + 1;
+        else
+            return pivot;
+    }
+}
+
+bool HistoryParse(History* history, Arena* arena, const char* text, size_t size)
+{
+    History* h = history;
+    PsMemSet(h, 0, sizeof(*h));
+
+    // TAIL: Recent runs only, so the table is bounded however long the
+    // journal gets
+    const char* start = text + size;
+    uint32_t lines = 0;
+    if (start > text && start[-1] == '\n')
+        start--;
+    while (start > text && lines < HISTORY_LINES)
+    {
+        start--;
+        if (*start == '\n' && ++lines == HISTORY_LINES)
+        {
+            start++;
+            break;
+        }
+    }
+
+    // Two keys per line at most, at no more than half full
+    uint32_t capacity = 16;
+    while (capacity < (lines + 1) * 4)
+        capacity <<= 1;
+    h->slots = (HistoryEntry*)ArenaAlloc(arena, capacity * sizeof(HistoryEntry));
+    if (!h->slots)
+        return false;
+    PsMemSet(h->slots, 0, capacity * sizeof(HistoryEntry));
+    h->capacity = capacity;
+
+    const char* end = text + size;
+    for (const char* line = start; line < end;)
+    {
+        const char* eol = (const char*)PsMemChr(line, '\n', (size_t)(end - line));
+        if (!eol)
+            eol = end;
+        if (!ParseLine(h, arena, line, eol))
+            return false;
+        line = eol + 1;
+    }
+
+    // TYPICAL: The median script, for scripts never seen
+    if (h->scripts > 0)
+    {
+        uint64_t* values = (uint64_t*)ArenaAlloc(arena, h->scripts * sizeof(uint64_t));
+        if (!values)
+            return false;
+        size_t n = 0;
+        for (uint32_t i = 0; i < capacity; i++)
+        {
+            if (h->slots[i].hash != 0 && h->slots[i].kind == KEY_PATH)
+                values[n++] = h->slots[i].micros;
+        }
+        h->typicalMicros = Select(values, n, n / 2);
+    }
+    return true;
+}
+
+bool HistoryLoad(History* history, Arena* arena, const PSCHAR* path)
+{
+    PSCHAR journal[PS_MAX_PATH];
+    if (!path)
+    {
+        size_t pos;
+        if (!PlatGetStateDirectory(journal, PS_MAX_PATH))
+        {
+            PsMemSet(history, 0, sizeof(*history));
+            return true;
+        }
+        pos = PsStrLen(journal);
+        if (!AppendChar(journal, PS_MAX_PATH, PS_PATH_SEP, &pos) ||
+            !AppendStr(journal, PS_MAX_PATH, PS_T("ps-launcher.runs"), &pos))
+        {
+            PsMemSet(history, 0, sizeof(*history));
+            return true;
+        }
+        path = journal;
+    }
+
+    size_t size = 0;
+    const char* text = (const char*)PlatMapFile(path, &size);
+    if (!text)
+    {
+        PsMemSet(history, 0, sizeof(*history));
+        return true;
+    }
+    bool parsed = HistoryParse(history, arena, text, size);
+    PlatUnmapFile(text, size);
+    return parsed;
+}
+
+uint64_t HistoryEstimate(const History* history, const PSCHAR* script, bool* known)
+{
+    const History* h = history;
+    *known = false;
+    char key[HISTORY_KEY_MAX];
+    size_t len = h->capacity ? PlatToUtf8(script, PsStrLen(script), key, sizeof(key)) : 0;
+    if (len == 0)
+        return h->typicalMicros;
+
+    const HistoryEntry* e = Find(h, key, len, KEY_PATH, KeyHash(key, len, KEY_PATH));
+    if (e->hash == 0)
+    {
+        const char* name = key + len;
+        while (name > key && name[-1] != '/' && name[-1] != '\\')
+            name--;
+        size_t nameLen = (size_t)(key + len - name);
+        e = Find(h, name, nameLen, KEY_NAME, KeyHash(name, nameLen, KEY_NAME));
+    }
+    if (e->hash == 0)
+        return h->typicalMicros;
+    *known = true;
+    return e->micros;
+}
@@ -0,0 +1,62 @@
+//--------------------------------------------------------------------------
+// DURATION HISTORY - How long each script usually runs, from the journal
+//--------------------------------------------------------------------------
+// The run journal (runrecord.h) has the duration of every completed run.
+// HistoryLoad reads its last HISTORY_LINES lines into a table of expected
+// durations: per script as it was launched, and per file name, so a batch
+// naming "nightly.ps1" finds runs of "C:\jobs\nightly.ps1". The estimate
+// is a moving average that gives each newer run a quarter of the weight,
+// so a script that got slower is believed within a few runs.
+//
+// Only completed runs count: up-to-date, cached and failed-to-start
+// records did not run the script. A script with no history is expected
+// to take the median of the scripts that have one (HistoryEstimate), so
+// it sorts among them rather than first or last.
+//
+// Lookups are UTF-8 keys in an open-addressing table on the caller's
+// arena; the journal itself is only mapped while it is read.
+
+#ifndef PS_HISTORY_H
+#define PS_HISTORY_H
+
+#include "arena.h"
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+#define HISTORY_LINES    16384       // Most recent journal lines read
+#define HISTORY_KEY_MAX  512         // UTF-8 bytes of a script key
+
+typedef struct HistoryEntry
+{
+    uint64_t hash;                   // 0: empty slot
+    const char* key;                 // On the arena
+    uint32_t keyLen;
+    uint32_t kind;                   // The script as launched, or its file name
+    uint32_t runs;
+    uint64_t micros;                 // Expected duration
+} HistoryEntry;
+
+typedef struct History
+{
+    HistoryEntry* slots;
+    uint32_t capacity;               // Power of two; 0 when nothing was read
+    uint32_t scripts;                // Distinct scripts as launched
+    uint64_t typicalMicros;          // Median over those; 0 with no history
+} History;
+
+// Parse journal text (whole lines, oldest first). False only when out of
+// memory; a journal without completed runs gives an empty history.
+bool HistoryParse(History* history, Arena* arena, const char* text, size_t size);
+
+// HistoryParse over the tail of the journal at path (NULL: the journal in
+// the state directory). A missing journal is an empty history.
+bool HistoryLoad(History* history, Arena* arena, const PSCHAR* path);
+
+// Expected duration of script, and whether it has runs of its own (by
+// path, else by file name); otherwise typicalMicros
+uint64_t HistoryEstimate(const History* history, const PSCHAR* script, bool* known);
+
+PS_EXTERN_C_END
+
+#endif // PS_HISTORY_H
@@ -0,0 +1,479 @@
+//--------------------------------------------------------------------------
+// INCREMENTAL MODE - Skip runs whose declared inputs have not changed
+//--------------------------------------------------------------------------
+#include "incremental.h"
+#include "catalog.h"
+#include "glob.h"
+#include "psmem.h"
+#include "psstr.h"
+#include "searchpath.h"
+#include "strbuf.h"
+#include "workpool.h"
+
+// Manifest file layout (native byte order, rewritten whole):
+//   ManifestHeader
+//   ManifestFile files[inputCount + outputCount]
+//   PSCHAR pool[poolLen]            each path followed by a 0
+#define MANIFEST_MAX_SIZE ((size_t)256 << 20)
+
+// Identities recorded this soon after the file's last write are re-hashed,
+// since a second write in the same clock tick would leave them as they were
+#define RACY_WINDOW (2 * PLAT_FILE_TICKS_PER_SECOND)
+
+// Workers only need a read buffer each
+#define WORKER_RESERVE ((size_t)1 << 20)
+
+static bool SameIdentity(const PlatFileInfo* a, const PlatFileInfo* b)
+{
+    return a->volume == b->volume && a->fileId == b->fileId &&
+           a->size == b->size && a->mtime == b->mtime;
+}
+
+static bool SameDigest(const uint8_t* a, const uint8_t* b)
+{
+    for (int i = 0; i < SHA256_DIGEST_SIZE; i++)
+    {
+        if (a[i] != b[i])
+            return false;
+    }
+    return true;
+}
+
+// Ordinal comparison: the order only has to be stable, not meaningful
+static int ComparePaths(const PSCHAR* a, size_t aLen, const PSCHAR* b, size_t bLen)
+{
+    size_t n = aLen < bLen ? aLen : bLen;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (a[i] != b[i])
+            return a[i] < b[i] ? -1 : 1;
+    }
+    return aLen < bLen ? -1 : aLen > bLen ? 1 : 0;
+}
+
+// Relative paths are taken from the script's directory
+static PSCHAR* ResolvePath(Arena* arena, const PSCHAR* baseDir, const PSCHAR* path)
+{
+    size_t pathLen = PsStrLen(path);
+    size_t baseLen = (baseDir && IsRelativePath(path)) ? PsStrLen(baseDir) : 0;
+    PSCHAR* out = (PSCHAR*)ArenaAlloc(arena, (baseLen + pathLen + 2) * sizeof(PSCHAR));
+    if (!out)
+        return NULL;
+    size_t len = 0;
+    if (baseLen > 0)
+    {
+        PsMemCpy(out, baseDir, baseLen * sizeof(PSCHAR));
+        len = baseLen;
+        if (out[len - 1] != PS_PATH_SEP && out[len - 1] != PS_T('/'))
+            out[len++] = PS_PATH_SEP;
+    }
+    PsMemCpy(out + len, path, (pathLen + 1) * sizeof(PSCHAR));
+    return out;
+}
+
+//--------------------------------------------------------------------------
+// MANIFEST PATH
+//--------------------------------------------------------------------------
+static void HashString(Sha256* ctx, const PSCHAR* s)
+{
+    Sha256Update(ctx, s, (PsStrLen(s) + 1) * sizeof(PSCHAR));
+}
+
+PSCHAR* IncrementalManifestPath(Arena* arena, const PSCHAR* stateDir, const PSCHAR* script,
+                                PSCHAR* const* params, int paramCount)
+{
+    // Each string with its terminator, so ("a b") and ("a", "b") differ
+    Sha256 ctx;
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    Sha256Init(&ctx);
+    HashString(&ctx, script);
+    for (int i = 0; i < paramCount; i++)
+        HashString(&ctx, params[i]);
+    Sha256Final(&ctx, digest);
+
+    static const char hex[] = "0123456789abcdef";
+    StrBuf path;
+    if (!StrBufInit(&path, arena, PsStrLen(stateDir) + 64, STRBUF_NO_LIMIT) ||
+        !StrBufAppend(&path, stateDir) || !StrBufAppendChar(&path, PS_PATH_SEP) ||
+        !StrBufAppend(&path, MANIFEST_DIRECTORY) || !StrBufAppendChar(&path, PS_PATH_SEP))
+        return NULL;
+    for (int i = 0; i < 16; i++)
+    {
+        if (!StrBufAppendChar(&path, (PSCHAR)hex[digest[i] >> 4]) ||
+            !StrBufAppendChar(&path, (PSCHAR)hex[digest[i] & 15]))
+            return NULL;
+    }
+    if (!StrBufAppend(&path, PS_T(".manifest")))
+        return NULL;
+    return path.data;
+}
+
+//--------------------------------------------------------------------------
+// INPUT SET - Expand, sort, drop duplicates
+//--------------------------------------------------------------------------
+typedef struct PathNode
+{
+    struct PathNode* next;
+    size_t len;
+    PSCHAR text[1];
+} PathNode;
+
+typedef struct PathList
+{
+    Arena* arena;
+    PathNode* first;
+    uint32_t count;
+    bool failed;
+} PathList;
+
+static bool OnMatch(void* ctx, const PSCHAR* path, size_t pathLen)
+{
+    PathList* list = (PathList*)ctx;
+    PathNode* n = (PathNode*)ArenaAlloc(list->arena, sizeof(PathNode) + pathLen * sizeof(PSCHAR));
+    if (!n || list->count >= MANIFEST_MAX_FILES)
+    {
+        list->failed = true;
+        return false;
+    }
+    PsMemCpy(n->text, path, pathLen * sizeof(PSCHAR));
+    n->text[pathLen] = 0;
+    n->len = pathLen;
+    n->next = list->first;
+    list->first = n;
+    list->count++;
+    return true;
+}
+
+// Heap sort by path: no recursion, no allocation, O(n log n) worst case
+static void SiftDown(InputFile* a, size_t root, size_t count)
+{
+    for (;;)
+    {
+        size_t child = root * 2 + 1;
+        if (child >= count)
+            return;
+        if (child + 1 < count &&
+            ComparePaths(a[child + 1].path, a[child + 1].pathLen, a[child].path, a[child].pathLen) > 0)
+            child++;
+        if (ComparePaths(a[root].path, a[root].pathLen, a[child].path, a[child].pathLen) >= 0)
+            return;
+        InputFile t = a[root];
+        a[root] = a[child];
+        a[child] = t;
+        root = child;
+    }
+}
+
+static void SortByPath(InputFile* a, size_t count)
+{
+    for (size_t i = count / 2; i > 0; i--)
+        SiftDown(a, i - 1, count);
+    for (size_t end = count; end > 1; end--)
+    {
+        InputFile t = a[0];
+        a[0] = a[end - 1];
+        a[end - 1] = t;
+        SiftDown(a, 0, end - 1);
+    }
+}
+
+//--------------------------------------------------------------------------
+// MANIFEST FILE
+//--------------------------------------------------------------------------
+typedef struct Manifest
+{
+    const ManifestHeader* header;
+    const ManifestFile* files;
+    const PSCHAR* pool;
+} Manifest;
+
+static bool LoadManifest(Arena* arena, const PSCHAR* path, Manifest* out)
+{
+    size_t size = 0;
+    const uint8_t* data = (const uint8_t*)ArenaReadFile(arena, path, MANIFEST_MAX_SIZE, &size);
+    if (!data || size < sizeof(ManifestHeader))
+        return false;
+
+    const ManifestHeader* h = (const ManifestHeader*)data;
+    if (h->magic[0] != 'P' || h->magic[1] != 'S' || h->magic[2] != 'I' || h->magic[3] != 'M' ||
+        h->version != MANIFEST_VERSION || h->inputCount > MANIFEST_MAX_FILES ||
+        h->outputCount > MANIFEST_MAX_FILES)
+        return false;
+
+    // FRAMING: 64-bit math, so a hostile count cannot wrap the check
+    uint64_t filesSize = (uint64_t)(h->inputCount + h->outputCount) * sizeof(ManifestFile);
+    uint64_t expected = sizeof(ManifestHeader) + filesSize + (uint64_t)h->poolLen * sizeof(PSCHAR);
+    if (expected != size)
+        return false;
+
+    const ManifestFile* files = (const ManifestFile*)(h + 1);
+    const PSCHAR* pool = (const PSCHAR*)((const uint8_t*)files + filesSize);
+    for (uint32_t i = 0; i < h->inputCount + h->outputCount; i++)
+    {
+        uint64_t end = (uint64_t)files[i].pathOffset + files[i].pathLen;
+        if (end >= h->poolLen || pool[end] != 0)
+            return false;
+    }
+
+    out->header = h;
+    out->files = files;
+    out->pool = pool;
+    return true;
+}
+
+// Recorded input with this path, or NULL (inputs are sorted by path)
+static const ManifestFile* FindInput(const Manifest* m, const PSCHAR* path, size_t pathLen)
+{
+    size_t lo = 0, hi = m->header->inputCount;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        const ManifestFile* f = &m->files[mid];
+        int cmp = ComparePaths(m->pool + f->pathOffset, f->pathLen, path, pathLen);
+        if (cmp == 0)
+            return f;
+        if (cmp < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return NULL;
+}
+
+//--------------------------------------------------------------------------
+// CHECK
+//--------------------------------------------------------------------------
+typedef struct CheckCtx
+{
+    InputFile* inputs;
+    const Manifest* manifest;        // NULL: everything is new
+    uint64_t checkedAt;
+} CheckCtx;
+
+// Runs on a pool worker: one metadata query, a read only if it moved
+static void CheckItem(void* ctx, Arena* arena, uint32_t index)
+{
+    CheckCtx* c = (CheckCtx*)ctx;
+    InputFile* in = &c->inputs[index];
+    if (!PlatGetFileInfo(in->path, &in->file))
+    {
+        in->failed = true;
+        return;
+    }
+
+    const ManifestFile* old = c->manifest ? FindInput(c->manifest, in->path, in->pathLen) : NULL;
+    if (old && SameIdentity(&old->file, &in->file) &&
+        c->manifest->header->recordedAt >= in->file.mtime + RACY_WINDOW)
+    {
+        PsMemCpy(in->sha256, old->sha256, SHA256_DIGEST_SIZE);
+        return;
+    }
+
+    in->hashed = true;
+    if (!CatalogHashFile(arena, in->path, in->sha256))
+        in->failed = true;
+    else
+        in->changed = !old || !SameDigest(old->sha256, in->sha256);
+}
+
+IncrementalStatus CheckIncremental(Arena* arena, const PSCHAR* manifestPath,
+                                   const uint8_t scriptSha256[SHA256_DIGEST_SIZE], const PSCHAR* baseDir,
+                                   PSCHAR* const* inputs, int inputCount,
+                                   PSCHAR* const* outputs, int outputCount,
+                                   IncrementalState* state)
+{
+    PsMemSet(state, 0, sizeof(*state));
+    state->manifestPath = manifestPath;
+    PsMemCpy(state->scriptSha256, scriptSha256, SHA256_DIGEST_SIZE);
+    state->checkedAt = PlatFileTimeNow();
+
+    //----------------------------------------------------------------------
+    // EXPAND - Every glob, then one sorted list without duplicates
+    //----------------------------------------------------------------------
+    PathList list = { arena, NULL, 0, false };
+    for (int i = 0; i < inputCount && !list.failed; i++)
+    {
+        PSCHAR* pattern = ResolvePath(arena, baseDir, inputs[i]);
+        if (!pattern || !ExpandGlob(arena, pattern, OnMatch, &list))
+            list.failed = true;
+    }
+    if (list.failed)
+        return INCREMENTAL_ERROR;
+
+    InputFile* files = (InputFile*)ArenaAlloc(arena, (list.count + 1) * sizeof(InputFile));
+    if (!files)
+        return INCREMENTAL_ERROR;
+    PsMemSet(files, 0, (list.count + 1) * sizeof(InputFile));
+    uint32_t count = 0;
+    for (PathNode* n = list.first; n; n = n->next)
+    {
+        files[count].path = n->text;
+        files[count].pathLen = n->len;
+        count++;
+    }
+    SortByPath(files, count);
+    uint32_t unique = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (unique == 0 || ComparePaths(files[unique - 1].path, files[unique - 1].pathLen,
+                                        files[i].path, files[i].pathLen) != 0)
+            files[unique++] = files[i];
+    }
+    state->inputs = files;
+    state->inputCount = unique;
+    state->stats.inputs = unique;
+
+    state->outputs = (PSCHAR**)ArenaAlloc(arena, ((size_t)outputCount + 1) * sizeof(PSCHAR*));
+    if (!state->outputs)
+        return INCREMENTAL_ERROR;
+    for (int i = 0; i < outputCount; i++)
+    {
+        state->outputs[i] = ResolvePath(arena, baseDir, outputs[i]);
+        if (!state->outputs[i])
+            return INCREMENTAL_ERROR;
+    }
+    state->outputCount = (uint32_t)outputCount;
+
+    //----------------------------------------------------------------------
+    // COMPARE - Identity and content of each input, in parallel
+    //----------------------------------------------------------------------
+    Manifest manifest;
+    bool haveManifest = LoadManifest(arena, manifestPath, &manifest);
+    CheckCtx ctx = { files, haveManifest ? &manifest : NULL, state->checkedAt };
+
+    WorkPool pool;
+    if (!WorkPoolInit(&pool, WORKER_RESERVE))
+        return INCREMENTAL_ERROR;
+    WorkPoolRun(&pool, unique, CheckItem, &ctx);
+    WorkPoolRelease(&pool);
+
+    // An edited script is a changed input of its own
+    bool upToDate = haveManifest && manifest.header->inputCount == unique &&
+                    manifest.header->outputCount == state->outputCount &&
+                    SameDigest(manifest.header->scriptSha256, scriptSha256);
+    for (uint32_t i = 0; i < unique; i++)
+    {
+        if (files[i].failed)
+            return INCREMENTAL_ERROR;
+        state->stats.hashed += files[i].hashed;
+        state->stats.changed += files[i].changed;
+        if (files[i].changed)
+            upToDate = false;
+    }
+
+    //----------------------------------------------------------------------
+    // OUTPUTS - Must still be exactly what the recorded run left
+    //----------------------------------------------------------------------
+    for (uint32_t i = 0; i < state->outputCount && upToDate; i++)
+    {
+        const ManifestFile* f = &manifest.files[manifest.header->inputCount + i];
+        const PSCHAR* path = state->outputs[i];
+        PlatFileInfo info;
+        if (ComparePaths(manifest.pool + f->pathOffset, f->pathLen, path, PsStrLen(path)) != 0 ||
+            !PlatGetFileInfo(path, &info) || !SameIdentity(&f->file, &info))
+            upToDate = false;
+    }
+
+    if (!upToDate)
+        return INCREMENTAL_OUT_OF_DATE;
+    state->exitCode = manifest.header->exitCode;
+    return INCREMENTAL_UP_TO_DATE;
+}
+
+//--------------------------------------------------------------------------
+// RECORD
+//--------------------------------------------------------------------------
+bool RecordIncremental(Arena* arena, const IncrementalState* state, uint32_t exitCode)
+{
+    ArenaMark mark = ArenaSave(arena);
+    uint32_t fileCount = state->inputCount + state->outputCount;
+    ManifestFile* files = (ManifestFile*)ArenaAlloc(arena, ((size_t)fileCount + 1) * sizeof(ManifestFile));
+    StrBuf pool;
+    if (!files || !StrBufInit(&pool, arena, 4096, STRBUF_NO_LIMIT))
+    {
+        ArenaRestore(arena, mark);
+        return false;
+    }
+    PsMemSet(files, 0, ((size_t)fileCount + 1) * sizeof(ManifestFile));
+
+    bool ok = true;
+    for (uint32_t i = 0; i < fileCount && ok; i++)
+    {
+        ManifestFile* f = &files[i];
+        const PSCHAR* path;
+        size_t pathLen;
+        if (i < state->inputCount)
+        {
+            // As checked before the run: a change made by the run itself
+            // must still count as a change next time
+            const InputFile* in = &state->inputs[i];
+            path = in->path;
+            pathLen = in->pathLen;
+            f->file = in->file;
+            PsMemCpy(f->sha256, in->sha256, SHA256_DIGEST_SIZE);
+        }
+        else
+        {
+            // An output the run did not produce: nothing worth recording
+            path = state->outputs[i - state->inputCount];
+            pathLen = PsStrLen(path);
+            ok = PlatGetFileInfo(path, &f->file);
+        }
+        f->pathOffset = (uint32_t)pool.len;
+        f->pathLen = (uint32_t)pathLen;
+        ok = ok && StrBufAppendN(&pool, path, pathLen) && StrBufAppendChar(&pool, 0);
+    }
+
+    size_t filesSize = (size_t)fileCount * sizeof(ManifestFile);
+    size_t total = sizeof(ManifestHeader) + filesSize + pool.len * sizeof(PSCHAR);
+    uint8_t* image = ok ? (uint8_t*)ArenaAlloc(arena, total) : NULL;
+    if (!image)
+    {
+        ArenaRestore(arena, mark);
+        return false;
+    }
+    ManifestHeader* h = (ManifestHeader*)image;
+    PsMemSet(h, 0, sizeof(*h));
+    h->magic[0] = 'P';
+    h->magic[1] = 'S';
+    h->magic[2] = 'I';
+    h->magic[3] = 'M';
+    h->version = MANIFEST_VERSION;
+    h->exitCode = exitCode;
+    h->inputCount = state->inputCount;
+    h->outputCount = state->outputCount;
+    h->poolLen = (uint32_t)pool.len;
+    h->recordedAt = state->checkedAt;
+    PsMemCpy(h->scriptSha256, state->scriptSha256, SHA256_DIGEST_SIZE);
+    PsMemCpy(image + sizeof(ManifestHeader), files, filesSize);
+    PsMemCpy(image + sizeof(ManifestHeader) + filesSize, pool.data, pool.len * sizeof(PSCHAR));
+
+    // Parent directory on first use, then a whole-file replace
+    StrBuf tmp;
+    ok = StrBufInit(&tmp, arena, 64, STRBUF_NO_LIMIT) && StrBufAppend(&tmp, state->manifestPath);
+    if (ok)
+    {
+        size_t cut = tmp.len;
+        while (cut > 0 && tmp.data[cut - 1] != PS_PATH_SEP)
+            cut--;
+        if (cut > 1)
+        {
+            tmp.data[cut - 1] = 0;
+            PlatCreateDirectory(tmp.data);
+            tmp.data[cut - 1] = PS_PATH_SEP;
+        }
+        ok = StrBufAppend(&tmp, PS_T(".tmp")) && StrBufAppendUInt(&tmp, PlatMonotonicNanos());
+    }
+    PlatFile file = ok ? PlatCreateFile(tmp.data, PLAT_FILE_OVERWRITE) : PLAT_INVALID_FILE;
+    if (file != PLAT_INVALID_FILE)
+    {
+        ok = PlatWriteFile(file, image, total);
+        PlatCloseFile(file);
+        ok = ok && PlatRenameFile(tmp.data, state->manifestPath);
+    }
+    else
+        ok = false;
+
+    ArenaRestore(arena, mark);
+    return ok;
+}
@@ -0,0 +1,116 @@
+//--------------------------------------------------------------------------
+// INCREMENTAL MODE - Skip runs whose declared inputs have not changed
+//--------------------------------------------------------------------------
+// A catalogue profile with "inputs" (globs) and "outputs" (files) makes
+// its scripts run make-style. After a run that exits with 0 the launcher
+// writes a manifest: the script's SHA-256, every input's path, file
+// identity and SHA-256, the outputs' identities and the exit code. The
+// next launch with the same script and parameters skips PowerShell and
+// returns that exit code when
+// - the script's content is what it was (its catalogue hash),
+// - the globs match exactly the same set of files,
+// - every input has the same content (identity unchanged, or re-hashed
+//   to the same SHA-256 after a touch or copy), and
+// - every output still exists as the run left it.
+//
+// Change detection is one directory walk for the globs plus one metadata
+// query per input; only inputs whose identity moved are read. Both run
+// on the work pool (workpool.h), so large input sets on a share overlap
+// their round trips.
+//
+// Manifests live in <state directory>/manifests, one file per script and
+// parameter list, and are replaced with a temp file and a rename.
+
+#ifndef PS_INCREMENTAL_H
+#define PS_INCREMENTAL_H
+
+#include "arena.h"
+#include "platform.h"
+#include "pstypes.h"
+#include "sha256.h"
+
+PS_EXTERN_C_BEGIN
+
+#define MANIFEST_DIRECTORY PS_T("manifests")
+#define MANIFEST_VERSION   2
+#define MANIFEST_MAX_FILES (1u << 22)
+
+typedef struct ManifestHeader
+{
+    char magic[4];                   // "PSIM"
+    uint32_t version;
+    uint32_t exitCode;               // Of the recorded run
+    uint32_t inputCount;
+    uint32_t outputCount;
+    uint32_t poolLen;                // PSCHAR units
+    uint64_t recordedAt;             // PlatFileTimeNow() when the inputs were checked
+    uint8_t scriptSha256[SHA256_DIGEST_SIZE];   // Of the script that ran
+} ManifestHeader;
+
+// Inputs sorted by path (ordinal), then outputs in declaration order
+typedef struct ManifestFile
+{
+    uint32_t pathOffset;             // Pool offset, PSCHAR units
+    uint32_t pathLen;
+    PlatFileInfo file;
+    uint8_t sha256[SHA256_DIGEST_SIZE];   // Zero for outputs
+} ManifestFile;
+
+typedef enum IncrementalStatus
+{
+    INCREMENTAL_UP_TO_DATE = 0,      // Skip the run; exitCode is the cached one
+    INCREMENTAL_OUT_OF_DATE,         // Run, then RecordIncremental
+    INCREMENTAL_ERROR                // Inputs could not be checked; just run
+} IncrementalStatus;
+
+typedef struct IncrementalStats
+{
+    uint32_t inputs;
+    uint32_t hashed;                 // Inputs read because their identity moved
+    uint32_t changed;                // Inputs new or different since the manifest
+} IncrementalStats;
+
+typedef struct InputFile
+{
+    const PSCHAR* path;
+    size_t pathLen;
+    PlatFileInfo file;
+    uint8_t sha256[SHA256_DIGEST_SIZE];
+    bool changed;
+    bool hashed;
+    bool failed;
+} InputFile;
+
+// Everything CheckIncremental learnt, for RecordIncremental after the run
+typedef struct IncrementalState
+{
+    const PSCHAR* manifestPath;
+    uint8_t scriptSha256[SHA256_DIGEST_SIZE];
+    InputFile* inputs;
+    uint32_t inputCount;
+    PSCHAR** outputs;
+    uint32_t outputCount;
+    uint32_t exitCode;               // Cached exit code when up to date
+    uint64_t checkedAt;              // PlatFileTimeNow() before the inputs were read
+    IncrementalStats stats;
+} IncrementalState;
+
+// Manifest path for this script and parameter list (SHA-256 of both)
+PSCHAR* IncrementalManifestPath(Arena* arena, const PSCHAR* stateDir, const PSCHAR* script,
+                                PSCHAR* const* params, int paramCount);
+
+// Compare the script's hash, the inputs and the outputs against the
+// manifest. Relative globs and outputs are taken from baseDir (the
+// script's directory).
+IncrementalStatus CheckIncremental(Arena* arena, const PSCHAR* manifestPath,
+                                   const uint8_t scriptSha256[SHA256_DIGEST_SIZE], const PSCHAR* baseDir,
+                                   PSCHAR* const* inputs, int inputCount,
+                                   PSCHAR* const* outputs, int outputCount,
+                                   IncrementalState* state);
+
+// Write the manifest for a successful run (inputs as checked before it)
+bool RecordIncremental(Arena* arena, const IncrementalState* state, uint32_t exitCode);
+
+PS_EXTERN_C_END
+
+#endif // PS_INCREMENTAL_H
@@ -0,0 +1,777 @@
+//--------------------------------------------------------------------------
+// CATALOGUE INDEXER - Compiles ps-launcher.catalog into the index
+//--------------------------------------------------------------------------
+#include "indexer.h"
+#include "args.h"
+#include "catalog.h"
+#include "encoding.h"
+#include "log.h"
+#include "platform.h"
+#include "psmem.h"
+#include "psstr.h"
+#include "quote.h"
+#include "resource.h"
+#include "strbuf.h"
+#include "workpool.h"
+
+#define WORKER_RESERVE ((size_t)64 << 20)
+#define CATALOG_MAX_SOURCE ((size_t)4 << 20)
+
+//--------------------------------------------------------------------------
+// SOURCE PARSING
+//--------------------------------------------------------------------------
+typedef struct Item
+{
+    struct Item* next;
+    const PSCHAR* alias;
+    size_t aliasLen;
+    const PSCHAR* path;
+    uint32_t profile;
+} Item;
+
+typedef struct Root
+{
+    const PSCHAR* path;
+    uint32_t profile;
+    Item* first;           // Scripts found below it, filled in by one worker
+    Item* last;
+    uint32_t count;
+    struct DirNode* unlisted;  // Directories that could not be listed, newest first
+} Root;
+
+// Profile fields, each a command line fragment (quoted like BuildCommandLine)
+enum { FIELD_NAME, FIELD_PARAMS, FIELD_INPUTS, FIELD_OUTPUTS, FIELD_RESOURCES, FIELD_COUNT };
+
+typedef struct Profile
+{
+    StrBuf fields[FIELD_COUNT];
+    uint32_t cacheSeconds;
+    uint32_t cacheFlags;
+    uint32_t tagCount;
+} Profile;
+
+typedef struct Resource
+{
+    const PSCHAR* name;
+    PSCHAR limit[12];                // As written, for the profiles' fragments
+} Resource;
+
+typedef struct Source
+{
+    Root* roots;
+    uint32_t rootCount;
+    Item* aliases;
+    uint32_t aliasCount;
+    Profile* profiles;
+    uint32_t profileCount;
+    Resource* resources;
+    uint32_t resourceCount;
+} Source;
+
+static PSCHAR* CopyArg(Arena* arena, const PSCHAR* s)
+{
+    size_t len = PsStrLen(s);
+    PSCHAR* out = (PSCHAR*)ArenaAlloc(arena, (len + 1) * sizeof(PSCHAR));
+    if (out)
+        PsMemCpy(out, s, (len + 1) * sizeof(PSCHAR));
+    return out;
+}
+
+// Profile name -> index; names were collected before aliases and roots
+static bool FindProfile(const Source* src, const PSCHAR* name, uint32_t* index)
+{
+    if (!name)
+    {
+        *index = CATALOG_NO_PROFILE;
+        return true;
+    }
+    for (uint32_t i = 0; i < src->profileCount; i++)
+    {
+        if (PsStrCmpI(src->profiles[i].fields[FIELD_NAME].data, name) == 0)
+        {
+            *index = i;
+            return true;
+        }
+    }
+    LogFormat(PS_T("ERROR: Unknown catalogue profile: %s"), name);
+    return false;
+}
+
+static const Resource* FindResource(const Source* src, const PSCHAR* name)
+{
+    for (uint32_t i = 0; i < src->resourceCount; i++)
+    {
+        if (PsStrCmpI(src->resources[i].name, name) == 0)
+            return &src->resources[i];
+    }
+    return NULL;
+}
+
+// "resource <name> <limit>": a name a tag table takes and a whole limit
+static bool ParseResource(Arena* arena, Source* src, PSCHAR* const* argv)
+{
+    size_t len = PsStrLen(argv[1]);
+    uint32_t limit = 0;
+    const PSCHAR* p = argv[2];
+    while (*p >= PS_T('0') && *p <= PS_T('9') && limit <= RESOURCE_MAX_LIMIT)
+        limit = limit * 10 + (uint32_t)(*p++ - PS_T('0'));
+    if (*p != 0 || limit == 0 || limit > RESOURCE_MAX_LIMIT || len >= RESOURCE_NAME_CHARS ||
+        FindResource(src, argv[1]) || src->resourceCount == RESOURCE_MAX_TAGS)
+        return false;
+
+    Resource* r = &src->resources[src->resourceCount++];
+    size_t pos = 0;
+    r->name = CopyArg(arena, argv[1]);
+    return r->name && AppendUInt(r->limit, 12, limit, &pos);
+}
+
+// Whole decimal seconds, at least 1 and at most a year
+static bool ParseSeconds(const PSCHAR* text, uint32_t* seconds)
+{
+    uint32_t value = 0;
+    for (const PSCHAR* p = text; *p; p++)
+    {
+        if (*p < PS_T('0') || *p > PS_T('9') || value > 365u * 24 * 3600)
+            return false;
+        value = value * 10 + (uint32_t)(*p - PS_T('0'));
+    }
+    *seconds = value;
+    return value > 0 && value <= 365u * 24 * 3600;
+}
+
+// Quote args onto a profile field, space-separated
+static bool AppendFragment(StrBuf* field, PSCHAR* const* args, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if ((field->len > 0 && !StrBufAppendChar(field, PS_T(' '))) ||
+            !AppendQuotedParameter(field, args[i]))
+            return false;
+    }
+    return true;
+}
+
+// Two passes over the lines: profiles and resources first so they can be
+// used before their definition, then everything that refers to them
+static bool ParseSource(Arena* arena, PSCHAR* text, size_t len, Source* src)
+{
+    uint32_t lines = 1;
+    for (size_t i = 0; i < len; i++)
+    {
+        if (text[i] == PS_T('\n'))
+        {
+            text[i] = 0;
+            lines++;
+        }
+        else if (text[i] == PS_T('\r'))
+            text[i] = 0;
+    }
+
+    src->roots = (Root*)ArenaAlloc(arena, sizeof(Root) * lines);
+    src->aliases = (Item*)ArenaAlloc(arena, sizeof(Item) * lines);
+    src->profiles = (Profile*)ArenaAlloc(arena, sizeof(Profile) * lines);
+    src->resources = (Resource*)ArenaAlloc(arena, sizeof(Resource) * RESOURCE_MAX_TAGS);
+    PSCHAR* storage = (PSCHAR*)ArenaAlloc(arena, (len + 1) * sizeof(PSCHAR));
+    PSCHAR** argv = (PSCHAR**)ArenaAlloc(arena, sizeof(PSCHAR*) * (len / 2 + 2));
+    if (!src->roots || !src->aliases || !src->profiles || !src->resources || !storage || !argv)
+        return false;
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (PSCHAR* line = text; line < text + len + 1; line += PsStrLen(line) + 1)
+        {
+            const PSCHAR* p = line;
+            while (*p == PS_T(' ') || *p == PS_T('\t'))
+                p++;
+            if (*p == 0 || *p == PS_T('#'))
+                continue;
+
+            int argc = SplitCommandLine(p, storage, argv, (int)(len / 2 + 2));
+            bool isProfile = PsStrCmpI(argv[0], PS_T("profile")) == 0;
+            bool isResource = PsStrCmpI(argv[0], PS_T("resource")) == 0;
+            if (argc < 2 || (pass == 0) != (isProfile || isResource))
+                continue;
+
+            if (isResource)
+            {
+                if (argc != 3 || !ParseResource(arena, src, argv))
+                {
+                    LogFormat(PS_T("ERROR: Invalid catalogue line: %s"), p);
+                    return false;
+                }
+            }
+            else if (isProfile)
+            {
+                Profile* pr = &src->profiles[src->profileCount++];
+                pr->cacheSeconds = 0;
+                pr->cacheFlags = 0;
+                pr->tagCount = 0;
+                for (int f = 0; f < FIELD_COUNT; f++)
+                {
+                    if (!StrBufInit(&pr->fields[f], arena, 64, STRBUF_NO_LIMIT))
+                        return false;
+                }
+                if (!StrBufAppend(&pr->fields[FIELD_NAME], argv[1]) ||
+                    !AppendFragment(&pr->fields[FIELD_PARAMS], argv + 2, argc - 2))
+                    return false;
+            }
+            else if ((PsStrCmpI(argv[0], PS_T("inputs")) == 0 ||
+                      PsStrCmpI(argv[0], PS_T("outputs")) == 0) && argc >= 3)
+            {
+                // Lists accumulate over repeated lines
+                uint32_t profile;
+                if (!FindProfile(src, argv[1], &profile))
+                    return false;
+                int field = (argv[0][0] | 0x20) == PS_T('i') ? FIELD_INPUTS : FIELD_OUTPUTS;
+                if (!AppendFragment(&src->profiles[profile].fields[field], argv + 2, argc - 2))
+                    return false;
+            }
+            else if (PsStrCmpI(argv[0], PS_T("tags")) == 0 && argc >= 3)
+            {
+                // Each tag goes in as its name and its limit
+                uint32_t profile;
+                if (!FindProfile(src, argv[1], &profile))
+                    return false;
+                Profile* pr = &src->profiles[profile];
+                for (int i = 2; i < argc; i++)
+                {
+                    const Resource* r = FindResource(src, argv[i]);
+                    if (!r)
+                    {
+                        LogFormat(PS_T("ERROR: Unknown catalogue resource: %s"), argv[i]);
+                        return false;
+                    }
+                    if (++pr->tagCount > RESOURCE_MAX_HELD)
+                    {
+                        LogFormat(PS_T("ERROR: Too many resource tags: %s"), p);
+                        return false;
+                    }
+                    PSCHAR* pair[2] = { (PSCHAR*)r->name, (PSCHAR*)r->limit };
+                    if (!AppendFragment(&pr->fields[FIELD_RESOURCES], pair, 2))
+                        return false;
+                }
+            }
+            else if (PsStrCmpI(argv[0], PS_T("cache")) == 0 && argc >= 3 && argc <= 4)
+            {
+                uint32_t profile;
+                if (!FindProfile(src, argv[1], &profile))
+                    return false;
+                Profile* pr = &src->profiles[profile];
+                if (!ParseSeconds(argv[2], &pr->cacheSeconds) ||
+                    (argc == 4 && PsStrCmpI(argv[3], PS_T("stdout")) != 0))
+                {
+                    LogFormat(PS_T("ERROR: Invalid catalogue line: %s"), p);
+                    return false;
+                }
+                pr->cacheFlags = argc == 4 ? CATALOG_CACHE_OUTPUT : 0;
+            }
+            else if (PsStrCmpI(argv[0], PS_T("root")) == 0 && argc <= 3)
+            {
+                Root* r = &src->roots[src->rootCount];
+                PsMemSet(r, 0, sizeof(*r));
+                r->path = CopyArg(arena, argv[1]);
+                if (!FindProfile(src, argc == 3 ? argv[2] : NULL, &r->profile))
+                    return false;
+                src->rootCount++;
+            }
+            else if (PsStrCmpI(argv[0], PS_T("alias")) == 0 && argc >= 3 && argc <= 4)
+            {
+                Item* a = &src->aliases[src->aliasCount];
+                a->alias = CopyArg(arena, argv[1]);
+                a->aliasLen = PsStrLen(argv[1]);
+                a->path = CopyArg(arena, argv[2]);
+                if (!FindProfile(src, argc == 4 ? argv[3] : NULL, &a->profile))
+                    return false;
+                src->aliasCount++;
+            }
+            else
+            {
+                LogFormat(PS_T("ERROR: Invalid catalogue line: %s"), p);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//--------------------------------------------------------------------------
+// PARALLEL WORK - Directory walks, then hashing
+//--------------------------------------------------------------------------
+typedef struct Entry
+{
+    const PSCHAR* path;
+    const char* alias;             // UTF-8
+    const char* pathUtf8;
+    uint16_t aliasLen;
+    uint16_t pathLen;
+    uint32_t profile;
+    uint64_t aliasHash;
+    PlatFileInfo file;
+    uint8_t sha256[SHA256_DIGEST_SIZE];
+    bool needsHash;
+    bool failed;
+} Entry;
+
+typedef struct DirNode
+{
+    struct DirNode* next;
+    PSCHAR* path;
+} DirNode;
+
+typedef struct WalkCtx
+{
+    Arena* arena;
+    Root* root;
+    const PSCHAR* dir;
+    DirNode** stack;
+    bool outOfMemory;
+} WalkCtx;
+
+static PSCHAR* JoinPath(Arena* arena, const PSCHAR* dir, const PSCHAR* name, size_t nameLen)
+{
+    size_t dirLen = PsStrLen(dir);
+    PSCHAR* out = (PSCHAR*)ArenaAlloc(arena, (dirLen + nameLen + 2) * sizeof(PSCHAR));
+    if (!out)
+        return NULL;
+    PsMemCpy(out, dir, dirLen * sizeof(PSCHAR));
+    if (dirLen > 0 && dir[dirLen - 1] != PS_PATH_SEP && dir[dirLen - 1] != PS_T('/'))
+        out[dirLen++] = PS_PATH_SEP;
+    PsMemCpy(out + dirLen, name, nameLen * sizeof(PSCHAR));
+    out[dirLen + nameLen] = 0;
+    return out;
+}
+
+static bool IsScriptName(const PSCHAR* name, size_t len)
+{
+    return len > 4 && name[len - 4] == PS_T('.') &&
+           (name[len - 3] | 0x20) == PS_T('p') && (name[len - 2] | 0x20) == PS_T('s') &&
+           name[len - 1] == PS_T('1');
+}
+
+static bool OnDirEntry(void* ctx, const PSCHAR* name, size_t nameLen, PlatEntryType type)
+{
+    WalkCtx* w = (WalkCtx*)ctx;
+    bool isDirectory = type == PLAT_ENTRY_DIRECTORY;
+    if (type == PLAT_ENTRY_LINK || (!isDirectory && !IsScriptName(name, nameLen)))
+        return true;
+
+    PSCHAR* path = JoinPath(w->arena, w->dir, name, nameLen);
+    void* node = ArenaAlloc(w->arena, isDirectory ? sizeof(DirNode) : sizeof(Item));
+    if (!path || !node)
+    {
+        w->outOfMemory = true;
+        return false;
+    }
+
+    if (isDirectory)
+    {
+        DirNode* d = (DirNode*)node;
+        d->path = path;
+        d->next = *w->stack;
+        *w->stack = d;
+        return true;
+    }
+
+    // Alias: the file name without ".ps1", pointing into the path
+    Item* item = (Item*)node;
+    item->next = NULL;
+    item->path = path;
+    item->aliasLen = nameLen - 4;
+    item->alias = path + PsStrLen(path) - nameLen;
+    item->profile = w->root->profile;
+    if (w->root->last)
+        w->root->last->next = item;
+    else
+        w->root->first = item;
+    w->root->last = item;
+    w->root->count++;
+    return true;
+}
+
+static void WalkRoot(Arena* arena, Root* root)
+{
+    DirNode first = { NULL, (PSCHAR*)root->path };
+    DirNode* stack = &first;
+    WalkCtx ctx = { arena, root, NULL, &stack, false };
+
+    while (stack && !ctx.outOfMemory)
+    {
+        DirNode* dir = stack;
+        stack = dir->next;
+        ctx.dir = dir->path;
+        if (!PlatListDirectory(dir->path, OnDirEntry, &ctx) && !ctx.outOfMemory)
+        {
+            // Logged by the caller: the logger is not safe on pool workers
+            DirNode* failed = (DirNode*)ArenaAlloc(arena, sizeof(DirNode));
+            if (!failed)
+            {
+                ctx.outOfMemory = true;
+                break;
+            }
+            failed->path = dir->path;
+            failed->next = root->unlisted;
+            root->unlisted = failed;
+        }
+    }
+}
+
+// Work pool items: roots to walk, then entries to hash
+static void WalkItem(void* ctx, Arena* arena, uint32_t index)
+{
+    WalkRoot(arena, &((Source*)ctx)->roots[index]);
+}
+
+static void HashItem(void* ctx, Arena* arena, uint32_t index)
+{
+    Entry* e = &((Entry*)ctx)[index];
+    if (e->needsHash && !CatalogHashFile(arena, e->path, e->sha256))
+        e->failed = true;
+}
+
+//--------------------------------------------------------------------------
+// INDEX BUILDING
+//--------------------------------------------------------------------------
+static char* ToUtf8(Arena* arena, const PSCHAR* s, size_t len, size_t* outLen)
+{
+    char* out = (char*)ArenaAlloc(arena, len * 3 + 1);
+    *outLen = (out && len) ? PlatToUtf8(s, len, out, len * 3) : 0;
+    return out;
+}
+
+static uint32_t BucketCountFor(uint32_t entries)
+{
+    uint32_t n = 8;
+    while (n < entries * 2)
+        n <<= 1;
+    return n;
+}
+
+// Insert entry index into an open-addressed table; false if alias exists
+static bool InsertBucket(uint32_t* buckets, uint32_t mask, const Entry* entries, uint32_t index)
+{
+    const Entry* e = &entries[index];
+    for (uint32_t slot = (uint32_t)e->aliasHash & mask;; slot = (slot + 1) & mask)
+    {
+        if (buckets[slot] == 0)
+        {
+            buckets[slot] = index + 1;
+            return true;
+        }
+        const Entry* other = &entries[buckets[slot] - 1];
+        if (other->aliasHash == e->aliasHash && other->aliasLen == e->aliasLen)
+        {
+            size_t j = 0;
+            while (j < e->aliasLen && (other->alias[j] | 0x20) == (e->alias[j] | 0x20))
+                j++;
+            if (j == e->aliasLen)
+                return false;
+        }
+    }
+}
+
+static bool AddEntry(Arena* arena, Entry* entries, uint32_t* count, uint32_t* buckets,
+                     uint32_t mask, const Item* item, IndexStats* stats)
+{
+    Entry* e = &entries[*count];
+    size_t aliasLen, pathLen;
+    PsMemSet(e, 0, sizeof(*e));
+    e->path = item->path;
+    e->profile = item->profile;
+    e->alias = ToUtf8(arena, item->alias, item->aliasLen, &aliasLen);
+    e->pathUtf8 = ToUtf8(arena, item->path, PsStrLen(item->path), &pathLen);
+    if (!e->alias || !e->pathUtf8)
+        return false;
+
+    if (aliasLen == 0 || aliasLen > 0xFFFF || pathLen == 0 || pathLen > 0xFFFF)
+    {
+        stats->skipped++;
+        return true;
+    }
+    e->aliasLen = (uint16_t)aliasLen;
+    e->pathLen = (uint16_t)pathLen;
+    e->aliasHash = CatalogHashAlias(e->alias, aliasLen);
+
+    if (!InsertBucket(buckets, mask, entries, *count))
+    {
+        LogFormat(PS_T("Duplicate alias skipped: %s"), item->path);
+        stats->skipped++;
+        return true;
+    }
+    (*count)++;
+    return true;
+}
+
+static bool SamePath(const Catalog* old, const CatalogEntry* oe, const Entry* e)
+{
+    const char* path = CatalogString(old, oe->pathOffset, oe->pathLen);
+    if (!path || oe->pathLen != e->pathLen)
+        return false;
+    for (size_t i = 0; i < e->pathLen; i++)
+    {
+        if (path[i] != e->pathUtf8[i])
+            return false;
+    }
+    return true;
+}
+
+static bool WriteIndex(Arena* arena, const PSCHAR* indexPath, const Source* src,
+                       const Entry* entries, uint32_t count)
+{
+    // Survivors only: entries that were found and hashed
+    uint32_t live = 0;
+    for (uint32_t i = 0; i < count; i++)
+        live += !entries[i].failed;
+
+    // Profile strings in UTF-8
+    size_t fieldCount = (size_t)src->profileCount * FIELD_COUNT + 1;
+    char** texts = (char**)ArenaAlloc(arena, sizeof(char*) * fieldCount);
+    size_t* lens = (size_t*)ArenaAlloc(arena, sizeof(size_t) * fieldCount);
+    if (!texts || !lens)
+        return false;
+
+    uint64_t poolSize = 0;
+    for (size_t i = 0; i + 1 < fieldCount; i++)
+    {
+        const StrBuf* field = &src->profiles[i / FIELD_COUNT].fields[i % FIELD_COUNT];
+        texts[i] = ToUtf8(arena, field->data, field->len, &lens[i]);
+        if (!texts[i])
+            return false;
+        poolSize += lens[i];
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (!entries[i].failed)
+            poolSize += (uint64_t)entries[i].aliasLen + entries[i].pathLen;
+    }
+    if (poolSize > 0xFFFFFFFFu)
+        return false;
+
+    uint32_t bucketCount = BucketCountFor(live);
+    size_t total = sizeof(CatalogHeader) + bucketCount * sizeof(uint32_t) +
+                   live * sizeof(CatalogEntry) + src->profileCount * sizeof(CatalogProfile) +
+                   (size_t)poolSize;
+    uint8_t* image = (uint8_t*)ArenaAlloc(arena, total);
+    if (!image)
+        return false;
+    PsMemSet(image, 0, total);
+
+    CatalogHeader* h = (CatalogHeader*)image;
+    h->magic[0] = 'P';
+    h->magic[1] = 'S';
+    h->magic[2] = 'C';
+    h->magic[3] = 'I';
+    h->version = CATALOG_VERSION;
+    h->entryCount = live;
+    h->bucketCount = bucketCount;
+    h->profileCount = src->profileCount;
+    h->poolSize = (uint32_t)poolSize;
+    h->builtMillis = PlatWallClockMillis();
+
+    Catalog cat;
+    if (!CatalogAttach(&cat, image, total))
+        return false;
+    uint32_t* buckets = (uint32_t*)cat.buckets;
+    CatalogEntry* out = (CatalogEntry*)cat.entries;
+    CatalogProfile* profiles = (CatalogProfile*)cat.profiles;
+    char* pool = (char*)cat.pool;
+    uint32_t poolPos = 0;
+
+    for (uint32_t i = 0; i < src->profileCount; i++)
+    {
+        uint32_t* offsets[FIELD_COUNT] = { &profiles[i].nameOffset, &profiles[i].paramsOffset,
+                                           &profiles[i].inputsOffset, &profiles[i].outputsOffset,
+                                           &profiles[i].resourcesOffset };
+        uint32_t* fieldLens[FIELD_COUNT] = { &profiles[i].nameLen, &profiles[i].paramsLen,
+                                             &profiles[i].inputsLen, &profiles[i].outputsLen,
+                                             &profiles[i].resourcesLen };
+        for (int f = 0; f < FIELD_COUNT; f++)
+        {
+            size_t at = (size_t)i * FIELD_COUNT + f;
+            *offsets[f] = poolPos;
+            *fieldLens[f] = (uint32_t)lens[at];
+            PsMemCpy(pool + poolPos, texts[at], lens[at]);
+            poolPos += (uint32_t)lens[at];
+        }
+        profiles[i].cacheSeconds = src->profiles[i].cacheSeconds;
+        profiles[i].cacheFlags = src->profiles[i].cacheFlags;
+    }
+
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const Entry* e = &entries[i];
+        if (e->failed)
+            continue;
+        CatalogEntry* ce = &out[n];
+        ce->aliasHash = e->aliasHash;
+        ce->aliasOffset = poolPos;
+        ce->aliasLen = e->aliasLen;
+        PsMemCpy(pool + poolPos, e->alias, e->aliasLen);
+        poolPos += e->aliasLen;
+        ce->pathOffset = poolPos;
+        ce->pathLen = e->pathLen;
+        PsMemCpy(pool + poolPos, e->pathUtf8, e->pathLen);
+        poolPos += e->pathLen;
+        ce->profile = e->profile;
+        ce->file = e->file;
+        PsMemCpy(ce->sha256, e->sha256, SHA256_DIGEST_SIZE);
+
+        // Aliases are unique by now, so this only finds a free slot
+        uint32_t mask = bucketCount - 1;
+        uint32_t slot = (uint32_t)e->aliasHash & mask;
+        while (buckets[slot] != 0)
+            slot = (slot + 1) & mask;
+        buckets[slot] = ++n;
+    }
+
+    //----------------------------------------------------------------------
+    // PUBLISH - Temporary file in the same directory, then one rename
+    //----------------------------------------------------------------------
+    StrBuf tmp;
+    if (!StrBufInit(&tmp, arena, 64, STRBUF_NO_LIMIT) || !StrBufAppend(&tmp, indexPath) ||
+        !StrBufAppend(&tmp, PS_T(".tmp")) || !StrBufAppendUInt(&tmp, PlatMonotonicNanos()))
+        return false;
+
+    PlatFile file = PlatCreateFile(tmp.data, PLAT_FILE_OVERWRITE);
+    if (file == PLAT_INVALID_FILE)
+        return false;
+    bool ok = PlatWriteFile(file, image, total);
+    PlatCloseFile(file);
+    return ok && PlatRenameFile(tmp.data, indexPath);
+}
+
+bool BuildCatalogIndex(Arena* arena, const PSCHAR* sourcePath, const PSCHAR* indexPath,
+                       IndexStats* stats)
+{
+    PsMemSet(stats, 0, sizeof(*stats));
+
+    //----------------------------------------------------------------------
+    // SOURCE - UTF-8 text, optional BOM
+    //----------------------------------------------------------------------
+    size_t size = 0;
+    PSCHAR* text = ArenaReadText(arena, sourcePath, CATALOG_MAX_SOURCE, &size);
+    if (!text)
+    {
+        LogFormat(PS_T("ERROR: Cannot read catalogue source: %s"), sourcePath);
+        return false;
+    }
+
+    Source src;
+    PsMemSet(&src, 0, sizeof(src));
+    if (!ParseSource(arena, text, size, &src))
+        return false;
+
+    //----------------------------------------------------------------------
+    // WALK - Scripts found below each root stay in the worker arenas
+    //----------------------------------------------------------------------
+    WorkPool pool;
+    bool ok = WorkPoolInit(&pool, WORKER_RESERVE);
+    if (ok)
+        WorkPoolRun(&pool, src.rootCount, WalkItem, &src);
+    for (uint32_t r = 0; r < src.rootCount; r++)
+    {
+        for (const DirNode* d = src.roots[r].unlisted; d; d = d->next)
+            LogFormat(PS_T("WARNING: Cannot list directory: %s"), d->path);
+    }
+
+    //----------------------------------------------------------------------
+    // MERGE - Explicit aliases, then roots in order; first alias wins
+    //----------------------------------------------------------------------
+    uint32_t candidates = src.aliasCount;
+    for (uint32_t i = 0; i < src.rootCount; i++)
+        candidates += src.roots[i].count;
+
+    uint32_t mask = BucketCountFor(candidates) - 1;
+    Entry* entries = (Entry*)ArenaAlloc(arena, sizeof(Entry) * (candidates + 1));
+    uint32_t* buckets = (uint32_t*)ArenaAlloc(arena, sizeof(uint32_t) * (mask + 1));
+    ok = ok && entries && buckets && candidates <= CATALOG_MAX_ENTRIES;
+    if (ok)
+        PsMemSet(buckets, 0, sizeof(uint32_t) * (mask + 1));
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; ok && i < src.aliasCount; i++)
+        ok = AddEntry(arena, entries, &count, buckets, mask, &src.aliases[i], stats);
+    for (uint32_t r = 0; ok && r < src.rootCount; r++)
+    {
+        for (const Item* item = src.roots[r].first; ok && item; item = item->next)
+            ok = AddEntry(arena, entries, &count, buckets, mask, item, stats);
+    }
+
+    //----------------------------------------------------------------------
+    // IDENTITY - Reuse hashes of unchanged files from the previous index
+    //----------------------------------------------------------------------
+    Catalog old;
+    bool haveOld = ok && CatalogOpen(&old, indexPath);
+    uint32_t queued = 0;
+    for (uint32_t i = 0; ok && i < count; i++)
+    {
+        Entry* e = &entries[i];
+        if (!PlatGetFileInfo(e->path, &e->file))
+        {
+            LogFormat(PS_T("Missing script skipped: %s"), e->path);
+            e->failed = true;
+            stats->skipped++;
+            continue;
+        }
+
+        const CatalogEntry* oe = haveOld ? CatalogFind(&old, e->alias, e->aliasLen) : NULL;
+        if (oe && SamePath(&old, oe, e) &&
+            oe->file.volume == e->file.volume && oe->file.fileId == e->file.fileId &&
+            oe->file.size == e->file.size && oe->file.mtime == e->file.mtime)
+        {
+            PsMemCpy(e->sha256, oe->sha256, SHA256_DIGEST_SIZE);
+            stats->reused++;
+        }
+        else
+        {
+            e->needsHash = true;
+            queued++;
+        }
+    }
+    if (haveOld)
+        CatalogClose(&old);
+
+    if (ok && queued > 0)
+        WorkPoolRun(&pool, count, HashItem, entries);
+
+    for (uint32_t i = 0; ok && i < count; i++)
+    {
+        if (entries[i].needsHash && entries[i].failed)
+        {
+            LogFormat(PS_T("Unreadable script skipped: %s"), entries[i].path);
+            stats->skipped++;
+        }
+        else if (entries[i].needsHash)
+            stats->hashed++;
+        if (!entries[i].failed)
+            stats->scripts++;
+    }
+
+    ok = ok && WriteIndex(arena, indexPath, &src, entries, count);
+    WorkPoolRelease(&pool);
+    return ok;
+}
+
+bool IndexCatalog(Arena* arena, IndexStats* stats)
+{
+    PSCHAR source[PS_MAX_PATH];
+    PSCHAR index[PS_MAX_PATH];
+    if (!PlatGetStateDirectory(source, PS_MAX_PATH))
+        return false;
+    size_t dirLen = PsStrLen(source);
+    size_t sourceLen = dirLen;
+    size_t indexLen = 0;
+    if (!AppendChar(source, PS_MAX_PATH, PS_PATH_SEP, &sourceLen) ||
+        !AppendStrN(index, PS_MAX_PATH, source, sourceLen, &indexLen) ||
+        !AppendStr(source, PS_MAX_PATH, CATALOG_SOURCE_NAME, &sourceLen) ||
+        !AppendStr(index, PS_MAX_PATH, CATALOG_INDEX_NAME, &indexLen))
+        return false;
+
+    LogFormat(PS_T("Catalogue source: %s"), source);
+    bool ok = BuildCatalogIndex(arena, source, index, stats);
+    LogNumber(PS_T("Scripts indexed: "), stats->scripts);
+    LogNumber(PS_T("Scripts hashed: "), stats->hashed);
+    LogNumber(PS_T("Hashes reused: "), stats->reused);
+    LogNumber(PS_T("Scripts skipped: "), stats->skipped);
+    return ok;
+}
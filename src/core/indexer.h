@@ -0,0 +1,40 @@
+//--------------------------------------------------------------------------
+// CATALOGUE INDEXER - Compiles ps-launcher.catalog into the index
+//--------------------------------------------------------------------------
+// "ps-launcher -Index" runs this separately from launches:
+// 1. Parse the source (catalog.h describes the directives)
+// 2. Walk the root directories, one root per worker thread
+// 3. Take each script's file identity; if the old index holds the same
+//    path with the same identity, reuse its hash, otherwise queue it
+// 4. Hash the queued scripts (SHA-256) on the same workers
+// 5. Write the new index to a temporary file and rename it over the old,
+//    so a launcher always maps either the old or the new index, whole
+// Only new and changed scripts are read, so refreshing a large share
+// costs one directory walk plus one metadata query per script.
+
+#ifndef PS_INDEXER_H
+#define PS_INDEXER_H
+
+#include "arena.h"
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+typedef struct IndexStats
+{
+    uint32_t scripts;      // Entries written
+    uint32_t hashed;       // Read and hashed this run
+    uint32_t reused;       // Hash carried over from the previous index
+    uint32_t skipped;      // Missing, unreadable or duplicate alias
+} IndexStats;
+
+// Compile sourcePath into indexPath
+bool BuildCatalogIndex(Arena* arena, const PSCHAR* sourcePath, const PSCHAR* indexPath,
+                       IndexStats* stats);
+
+// -Index: the catalogue source and index in the state directory
+bool IndexCatalog(Arena* arena, IndexStats* stats);
+
+PS_EXTERN_C_END
+
+#endif // PS_INDEXER_H
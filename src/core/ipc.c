@@ -0,0 +1,349 @@
+//--------------------------------------------------------------------------
+// SUBMISSION PROTOCOL - Framed requests to a resident launcher
+//--------------------------------------------------------------------------
+#include "ipc.h"
+#include "encoding.h"
+#include "psmem.h"
+#include "psstr.h"
+
+#define IPC_FIELD_HEADER   5         // Tag and length
+#define IPC_CLIENT_BUFFER  (64 * 1024)
+#define IPC_CLIENT_RESERVE ((size_t)64 << 20)
+
+//--------------------------------------------------------------------------
+// ENCODING
+//--------------------------------------------------------------------------
+static void PutU32(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static void PutU64(uint8_t* p, uint64_t v)
+{
+    PutU32(p, (uint32_t)v);
+    PutU32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint32_t GetU32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t GetU64(const uint8_t* p)
+{
+    return (uint64_t)GetU32(p) | ((uint64_t)GetU32(p + 4) << 32);
+}
+
+bool IpcWriterInit(IpcWriter* w, Arena* arena, size_t cap)
+{
+    w->arena = arena;
+    w->len = 0;
+    w->cap = cap;
+    w->data = (uint8_t*)ArenaAlloc(arena, cap);
+    return w->data != NULL;
+}
+
+// GEOMETRIC GROWTH: In place while the buffer is the arena's top block
+static bool Reserve(IpcWriter* w, size_t extra)
+{
+    if (extra <= w->cap - w->len)
+        return true;
+    size_t newCap = w->cap * 2;
+    if (newCap < w->len + extra)
+        newCap = w->len + extra;
+    if (ArenaExtend(w->arena, w->data, w->cap, newCap))
+    {
+        w->cap = newCap;
+        return true;
+    }
+    uint8_t* moved = (uint8_t*)ArenaAlloc(w->arena, newCap);
+    if (!moved)
+        return false;
+    PsMemCpy(moved, w->data, w->len);
+    w->data = moved;
+    w->cap = newCap;
+    return true;
+}
+
+static bool PutHeader(IpcWriter* w, IpcFrameType type, uint64_t id)
+{
+    if (!Reserve(w, IPC_HEADER_SIZE))
+        return false;
+    uint8_t* h = w->data + w->len;
+    PutU32(h, 0);                       // Patched once the body is known
+    h[4] = (uint8_t)type;
+    h[5] = IPC_VERSION;
+    h[6] = 0;
+    h[7] = 0;
+    PutU64(h + 8, id);
+    w->len += IPC_HEADER_SIZE;
+    return true;
+}
+
+static bool PutField(IpcWriter* w, IpcFieldTag tag, const PSCHAR* s)
+{
+    size_t len = PsStrLen(s);
+    if (len > IPC_MAX_FRAME || !Reserve(w, IPC_FIELD_HEADER + len * 3))
+        return false;
+    uint8_t* f = w->data + w->len;
+    size_t n = len ? PlatToUtf8(s, len, (char*)f + IPC_FIELD_HEADER, len * 3) : 0;
+    if (len && n == 0)
+        return false;
+    f[0] = (uint8_t)tag;
+    PutU32(f + 1, (uint32_t)n);
+    w->len += IPC_FIELD_HEADER + n;
+    return true;
+}
+
+bool IpcEncodeSubmit(IpcWriter* w, const IpcSubmit* submit)
+{
+    size_t start = w->len;
+    bool ok = PutHeader(w, IPC_SUBMIT, submit->id) && PutField(w, IPC_FIELD_SCRIPT, submit->script);
+    for (int i = 0; ok && i < submit->argCount; i++)
+        ok = PutField(w, IPC_FIELD_ARG, submit->args[i]);
+    for (int i = 0; ok && i < submit->envCount; i++)
+        ok = PutField(w, IPC_FIELD_ENV, submit->env[i]);
+    if (ok && submit->cwd)
+        ok = PutField(w, IPC_FIELD_CWD, submit->cwd);
+    if (ok && submit->profile)
+        ok = PutField(w, IPC_FIELD_PROFILE, submit->profile);
+    if (ok && submit->priority)
+        ok = PutField(w, IPC_FIELD_PRIORITY, submit->priority);
+    if (ok && submit->deadline)
+        ok = PutField(w, IPC_FIELD_DEADLINE, submit->deadline);
+    if (ok && submit->submitter)
+        ok = PutField(w, IPC_FIELD_SUBMITTER, submit->submitter);
+    if (!ok || w->len - start > IPC_MAX_FRAME)
+    {
+        w->len = start;
+        return false;
+    }
+    PutU32(w->data + start, (uint32_t)(w->len - start - 4));
+    return true;
+}
+
+bool IpcEncodeCompletion(IpcWriter* w, const IpcCompletion* completion)
+{
+    size_t start = w->len;
+    if (!PutHeader(w, IPC_COMPLETE, completion->id) || !Reserve(w, IPC_COMPLETE_BODY))
+    {
+        w->len = start;
+        return false;
+    }
+    uint8_t* b = w->data + w->len;
+    PutU32(b, completion->status);
+    PutU32(b + 4, completion->exitCode);
+    PutU64(b + 8, completion->durationMicros);
+    w->len += IPC_COMPLETE_BODY;
+    PutU32(w->data + start, (uint32_t)(w->len - start - 4));
+    return true;
+}
+
+//--------------------------------------------------------------------------
+// DECODING
+//--------------------------------------------------------------------------
+size_t IpcParseFrame(const uint8_t* data, size_t len, IpcFrame* frame, bool* bad)
+{
+    *bad = false;
+    if (len < 4)
+        return 0;
+    uint32_t size = GetU32(data) + 4;
+    if (size < IPC_HEADER_SIZE || size > IPC_MAX_FRAME)
+    {
+        *bad = true;
+        return 0;
+    }
+    if (len < IPC_HEADER_SIZE)
+        return 0;
+    if (data[5] != IPC_VERSION)
+    {
+        *bad = true;
+        return 0;
+    }
+    if (len < size)
+        return 0;
+    frame->type = data[4];
+    frame->id = GetU64(data + 8);
+    frame->body = data + IPC_HEADER_SIZE;
+    frame->bodySize = size - IPC_HEADER_SIZE;
+    return size;
+}
+
+static PSCHAR* DecodeString(Arena* arena, const uint8_t* s, uint32_t len)
+{
+    // SECURITY CHECK: An embedded NUL would silently cut the value short
+    if (PsMemChr(s, 0, len))
+        return NULL;
+    PSCHAR* out = (PSCHAR*)ArenaAlloc(arena, ((size_t)len + 1) * sizeof(PSCHAR));
+    if (!out)
+        return NULL;
+#ifdef _WIN32
+    len = (uint32_t)(len ? Utf8ToUtf16((const char*)s, len, (uint16_t*)out, len) : 0);
+#else
+    PsMemCpy(out, s, len);
+#endif
+    out[len] = 0;
+    return out;
+}
+
+bool IpcDecodeSubmit(Arena* arena, const IpcFrame* frame, IpcSubmit* submit)
+{
+    PsMemSet(submit, 0, sizeof(*submit));
+    submit->id = frame->id;
+    if (frame->type != IPC_SUBMIT)
+        return false;
+
+    // Pass 1: framing, and how many parameters and variables
+    const uint8_t* end = frame->body + frame->bodySize;
+    uint32_t fields = 0, args = 0, env = 0;
+    for (const uint8_t* p = frame->body; p < end; fields++)
+    {
+        if ((size_t)(end - p) < IPC_FIELD_HEADER || fields >= IPC_MAX_FIELDS)
+            return false;
+        uint32_t len = GetU32(p + 1);
+        if (len > (size_t)(end - p) - IPC_FIELD_HEADER)
+            return false;
+        args += p[0] == IPC_FIELD_ARG;
+        env += p[0] == IPC_FIELD_ENV;
+        p += IPC_FIELD_HEADER + len;
+    }
+
+    PSCHAR** argv = (PSCHAR**)ArenaAlloc(arena, (args + env + 1) * sizeof(PSCHAR*));
+    if (!argv)
+        return false;
+    submit->args = argv;
+    submit->env = argv + args;
+
+    // Pass 2: the strings
+    PSCHAR** envv = argv + args;
+    for (const uint8_t* p = frame->body; p < end;)
+    {
+        uint8_t tag = p[0];
+        uint32_t len = GetU32(p + 1);
+        const uint8_t* value = p + IPC_FIELD_HEADER;
+        p = value + len;
+        if (tag < IPC_FIELD_SCRIPT || tag > IPC_FIELD_SUBMITTER)
+            continue;                   // Newer field, not for us
+
+        PSCHAR* s = DecodeString(arena, value, len);
+        if (!s)
+            return false;
+        switch (tag)
+        {
+        case IPC_FIELD_SCRIPT:   submit->script = s;             break;
+        case IPC_FIELD_ARG:      argv[submit->argCount++] = s;   break;
+        case IPC_FIELD_ENV:      envv[submit->envCount++] = s;   break;
+        case IPC_FIELD_CWD:      submit->cwd = s;                break;
+        case IPC_FIELD_PROFILE:  submit->profile = s;            break;
+        case IPC_FIELD_PRIORITY: submit->priority = s;           break;
+        case IPC_FIELD_DEADLINE: submit->deadline = s;           break;
+        default:                 submit->submitter = s;          break;
+        }
+    }
+    return submit->script != NULL && submit->script[0] != 0;
+}
+
+bool IpcDecodeCompletion(const IpcFrame* frame, IpcCompletion* completion)
+{
+    if (frame->type != IPC_COMPLETE || frame->bodySize < IPC_COMPLETE_BODY)
+        return false;
+    completion->id = frame->id;
+    completion->status = GetU32(frame->body);
+    completion->exitCode = GetU32(frame->body + 4);
+    completion->durationMicros = GetU64(frame->body + 8);
+    return true;
+}
+
+bool IpcEndpoint(PSCHAR* out, size_t outSize)
+{
+    return PlatGetEnv(IPC_ENDPOINT_ENV, out, outSize) || PlatIpcDefaultEndpoint(out, outSize);
+}
+
+//--------------------------------------------------------------------------
+// CLIENT
+//--------------------------------------------------------------------------
+bool IpcClientConnect(IpcClient* client, const PSCHAR* endpoint)
+{
+    PSCHAR defaultEndpoint[PS_MAX_PATH];
+    PsMemSet(client, 0, sizeof(*client));
+    if (!endpoint)
+    {
+        if (!IpcEndpoint(defaultEndpoint, PS_MAX_PATH))
+            return false;
+        endpoint = defaultEndpoint;
+    }
+    if (!ArenaInit(&client->arena, IPC_CLIENT_RESERVE))
+        return false;
+
+    // Receive buffer first: the send buffer then grows in place
+    client->in = (uint8_t*)ArenaAlloc(&client->arena, IPC_CLIENT_BUFFER);
+    if (client->in && IpcWriterInit(&client->out, &client->arena, IPC_CLIENT_BUFFER) &&
+        PlatIpcConnect(&client->conn, endpoint))
+        return true;
+    ArenaRelease(&client->arena);
+    return false;
+}
+
+bool IpcClientSubmit(IpcClient* client, const IpcSubmit* submit)
+{
+    if (!IpcEncodeSubmit(&client->out, submit))
+        return false;
+    client->pending++;
+    return true;
+}
+
+bool IpcClientFlush(IpcClient* client)
+{
+    bool ok = client->out.len == 0 || PlatIpcWrite(&client->conn, client->out.data, client->out.len);
+    client->out.len = 0;
+    return ok;
+}
+
+int IpcClientPoll(IpcClient* client, uint32_t timeoutMillis, IpcCompletionFn fn, void* ctx)
+{
+    int delivered = 0;
+    for (;;)
+    {
+        // Every whole frame in the buffer, then move the rest down
+        size_t pos = 0, size;
+        IpcFrame frame;
+        bool bad;
+        while ((size = IpcParseFrame(client->in + pos, client->inLen - pos, &frame, &bad)) > 0)
+        {
+            IpcCompletion completion;
+            if (IpcDecodeCompletion(&frame, &completion))
+            {
+                client->pending--;
+                delivered++;
+                fn(ctx, &completion);
+            }
+            pos += size;
+        }
+        if (bad)
+            return -1;
+        // OVERLAP: Less than a frame is left, so a forward byte copy is safe
+        client->inLen -= pos;
+        for (size_t i = 0; pos && i < client->inLen; i++)
+            client->in[i] = client->in[pos + i];
+
+        // Wait only for the first; after that take what is already there
+        size_t got;
+        PlatIpcStatus status = PlatIpcRead(&client->conn, client->in + client->inLen,
+                                           IPC_CLIENT_BUFFER - client->inLen,
+                                           delivered ? 0 : timeoutMillis, &got);
+        if (status == PLAT_IPC_CLOSED)
+            return delivered ? delivered : -1;
+        if (status == PLAT_IPC_TIMEOUT)
+            return delivered;
+        client->inLen += got;
+    }
+}
+
+void IpcClientClose(IpcClient* client)
+{
+    PlatIpcClose(&client->conn);
+    ArenaRelease(&client->arena);
+}
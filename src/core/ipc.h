@@ -0,0 +1,165 @@
+//--------------------------------------------------------------------------
+// SUBMISSION PROTOCOL - Framed requests to a resident launcher
+//--------------------------------------------------------------------------
+// Clients hand launches to "ps-launcher -Serve" (server.h) over a local
+// stream (platform.h LOCAL IPC). Everything is a frame:
+//
+//   offset  size  field
+//   0       4     length   bytes after this field (12 + body)
+//   4       1     type     IPC_SUBMIT or IPC_COMPLETE
+//   5       1     version  IPC_VERSION
+//   6       2     reserved 0
+//   8       8     id       correlation id, chosen by the client
+//   16      ...   body
+//
+// All integers are little-endian. A submission's body is a list of
+// fields, each a one-byte tag, a four-byte length and that many bytes of
+// UTF-8 (not terminated):
+//   IPC_FIELD_SCRIPT   once     script path or @alias
+//   IPC_FIELD_ARG      0..n     script parameters, in order
+//   IPC_FIELD_ENV      0..n     "NAME=value" on top of the server's environment
+//   IPC_FIELD_CWD      0..1     working directory of the run
+//   IPC_FIELD_PROFILE  0..1     catalogue profile the alias must use
+//   IPC_FIELD_PRIORITY 0..1     "interactive", "normal" or "bulk" (jobqueue.h)
+//   IPC_FIELD_DEADLINE 0..1     milliseconds from arrival, in decimal
+//   IPC_FIELD_SUBMITTER 0..1    fair-share group, "name" or "name:weight"
+// Unknown tags are skipped, so fields can be added without a new version.
+// A completion's body is fixed: status, exit code (u32 each) and the run's
+// duration in microseconds (u64).
+//
+// Clients pipeline: any number of submissions go out in one write, and
+// completions come back as runs finish, in any order, matched by id.
+
+#ifndef PS_IPC_H
+#define PS_IPC_H
+
+#include "arena.h"
+#include "platform.h"
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+#define IPC_VERSION        1
+#define IPC_HEADER_SIZE    16
+#define IPC_MAX_FRAME      ((uint32_t)1 << 20)      // Header included
+#define IPC_COMPLETE_BODY  16
+#define IPC_MAX_FIELDS     4096
+#define IPC_ENDPOINT_ENV   PS_T("PS_LAUNCHER_ENDPOINT")  // Overrides the default endpoint
+#define IPC_PRIORITY_ENV   PS_T("PS_LAUNCHER_PRIORITY")  // Daemon-client queue fields
+#define IPC_DEADLINE_ENV   PS_T("PS_LAUNCHER_DEADLINE_MS")
+#define IPC_SUBMITTER_ENV  PS_T("PS_LAUNCHER_SUBMITTER")
+
+typedef enum IpcFrameType
+{
+    IPC_SUBMIT = 1,
+    IPC_COMPLETE = 2
+} IpcFrameType;
+
+typedef enum IpcFieldTag
+{
+    IPC_FIELD_SCRIPT = 1,
+    IPC_FIELD_ARG = 2,
+    IPC_FIELD_ENV = 3,
+    IPC_FIELD_CWD = 4,
+    IPC_FIELD_PROFILE = 5,
+    IPC_FIELD_PRIORITY = 6,
+    IPC_FIELD_DEADLINE = 7,
+    IPC_FIELD_SUBMITTER = 8
+} IpcFieldTag;
+
+typedef enum IpcStatus
+{
+    IPC_COMPLETED = 0,               // Ran; exitCode is the launcher's
+    IPC_REJECTED = 1,                // Malformed, the profile does not match,
+                                     // or the queue fields are not valid
+    IPC_SPAWN_FAILED = 2             // exitCode is the OS error
+} IpcStatus;
+
+typedef struct IpcSubmit
+{
+    uint64_t id;
+    const PSCHAR* script;
+    PSCHAR* const* args;
+    int argCount;
+    PSCHAR* const* env;              // "NAME=value"
+    int envCount;
+    const PSCHAR* cwd;               // NULL: the server's
+    const PSCHAR* profile;           // NULL: none
+    const PSCHAR* priority;          // NULL: normal
+    const PSCHAR* deadline;          // NULL: none
+    const PSCHAR* submitter;         // NULL: the connection
+} IpcSubmit;
+
+typedef struct IpcCompletion
+{
+    uint64_t id;
+    uint32_t status;                 // IpcStatus
+    uint32_t exitCode;
+    uint64_t durationMicros;
+} IpcCompletion;
+
+typedef struct IpcFrame
+{
+    uint8_t type;
+    uint64_t id;
+    const uint8_t* body;
+    uint32_t bodySize;
+} IpcFrame;
+
+// Growable byte buffer on an arena, for outgoing frames
+typedef struct IpcWriter
+{
+    Arena* arena;
+    uint8_t* data;
+    size_t len;
+    size_t cap;
+} IpcWriter;
+
+bool IpcWriterInit(IpcWriter* w, Arena* arena, size_t cap);
+
+// Append one frame; on failure the writer is unchanged
+bool IpcEncodeSubmit(IpcWriter* w, const IpcSubmit* submit);
+bool IpcEncodeCompletion(IpcWriter* w, const IpcCompletion* completion);
+
+// The frame at the start of data: its size in bytes, or 0 if more bytes
+// are needed. *bad is set (and 0 returned) for a frame that can never be
+// valid: wrong version, shorter than a header, or over IPC_MAX_FRAME.
+size_t IpcParseFrame(const uint8_t* data, size_t len, IpcFrame* frame, bool* bad);
+
+// Fields into terminated native strings on arena; false if malformed
+bool IpcDecodeSubmit(Arena* arena, const IpcFrame* frame, IpcSubmit* submit);
+bool IpcDecodeCompletion(const IpcFrame* frame, IpcCompletion* completion);
+
+// PS_LAUNCHER_ENDPOINT if set, else PlatIpcDefaultEndpoint
+bool IpcEndpoint(PSCHAR* out, size_t outSize);
+
+//--------------------------------------------------------------------------
+// CLIENT
+//--------------------------------------------------------------------------
+// Submissions are queued by IpcClientSubmit and written together by
+// IpcClientFlush; IpcClientPoll delivers completions as they arrive.
+typedef void (*IpcCompletionFn)(void* ctx, const IpcCompletion* completion);
+
+typedef struct IpcClient
+{
+    PlatIpc conn;
+    Arena arena;
+    IpcWriter out;                   // Queued, not yet written
+    uint8_t* in;                     // Received, not yet delivered
+    size_t inLen;
+    uint32_t pending;                // Submitted without a completion yet
+} IpcClient;
+
+// endpoint NULL: IpcEndpoint
+bool IpcClientConnect(IpcClient* client, const PSCHAR* endpoint);
+bool IpcClientSubmit(IpcClient* client, const IpcSubmit* submit);
+bool IpcClientFlush(IpcClient* client);
+
+// Deliver every completion received, waiting up to timeoutMillis for the
+// first. Returns the number delivered, or -1 once the connection is gone.
+int IpcClientPoll(IpcClient* client, uint32_t timeoutMillis, IpcCompletionFn fn, void* ctx);
+void IpcClientClose(IpcClient* client);
+
+PS_EXTERN_C_END
+
+#endif // PS_IPC_H
@@ -0,0 +1,201 @@
+//--------------------------------------------------------------------------
+// JOB QUEUE - Pending launches by class, deadline and fair share
+//--------------------------------------------------------------------------
+#include "jobqueue.h"
+#include "psmem.h"
+#include "psstr.h"
+
+static const PSCHAR* const g_classNames[JOB_CLASSES] = { PS_T("interactive"), PS_T("normal"), PS_T("bulk") };
+
+//--------------------------------------------------------------------------
+// SUBMITTERS
+//--------------------------------------------------------------------------
+static bool Stale(const JobQueue* q, const JobSubmitter* s)
+{
+    for (int c = 0; c < JOB_CLASSES; c++)
+    {
+        if (s->stamp[c] > q->clock[c])
+            return false;
+    }
+    return true;
+}
+
+// The submitter's slot, claiming an empty or stale one for a new key.
+// NULL when every slot within JOB_PROBES is in use: the job is then
+// stamped as a newcomer's would be.
+static JobSubmitter* FindSubmitter(JobQueue* q, uint64_t key)
+{
+    JobSubmitter* reuse = NULL;
+    for (uint32_t i = 0; i < JOB_PROBES; i++)
+    {
+        JobSubmitter* s = &q->submitters[(key + i) & (JOB_SUBMITTERS - 1)];
+        if (s->key == key)
+            return s;
+        if (s->key == 0)
+        {
+            if (!reuse)
+                reuse = s;
+            break;
+        }
+        if (!reuse && Stale(q, s))
+            reuse = s;
+    }
+    if (reuse)
+    {
+        reuse->key = key;
+        for (int c = 0; c < JOB_CLASSES; c++)
+            reuse->stamp[c] = 0;
+    }
+    return reuse;
+}
+
+uint64_t JobSubmitterKey(const PSCHAR* name, size_t len)
+{
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < len; i++)
+        hash = (hash ^ (uint64_t)name[i]) * 0x100000001B3ull;
+    return hash ? hash : 1;
+}
+
+//--------------------------------------------------------------------------
+// HEAP
+//--------------------------------------------------------------------------
+static bool Before(const JobItem* a, const JobItem* b)
+{
+    if (a->cls != b->cls)
+        return a->cls < b->cls;
+    if (a->deadline != b->deadline)
+        return a->deadline < b->deadline;
+    if (a->stamp != b->stamp)
+        return a->stamp < b->stamp;
+    return a->arrival < b->arrival;
+}
+
+static void Place(JobQueue* q, JobItem* item, uint32_t slot)
+{
+    q->heap[slot] = item;
+    item->slot = slot;
+}
+
+static void SiftUp(JobQueue* q, JobItem* item, uint32_t slot)
+{
+    while (slot > 0)
+    {
+        uint32_t parent = (slot - 1) / 2;
+        if (!Before(item, q->heap[parent]))
+            break;
+        Place(q, q->heap[parent], slot);
+        slot = parent;
+    }
+    Place(q, item, slot);
+}
+
+static void SiftDown(JobQueue* q, JobItem* item, uint32_t slot)
+{
+    for (;;)
+    {
+        uint32_t child = 2 * slot + 1;
+        if (child >= q->count)
+            break;
+        if (child + 1 < q->count && Before(q->heap[child + 1], q->heap[child]))
+            child++;
+        if (!Before(q->heap[child], item))
+            break;
+        Place(q, q->heap[child], slot);
+        slot = child;
+    }
+    Place(q, item, slot);
+}
+
+//--------------------------------------------------------------------------
+// QUEUE
+//--------------------------------------------------------------------------
+bool JobQueueInit(JobQueue* queue, Arena* arena, uint32_t capacity)
+{
+    PsMemSet(queue, 0, sizeof(*queue));
+    queue->heap = (JobItem**)ArenaAlloc(arena, (capacity ? capacity : 1) * sizeof(JobItem*));
+    queue->submitters = (JobSubmitter*)ArenaAlloc(arena, JOB_SUBMITTERS * sizeof(JobSubmitter));
+    if (!queue->heap || !queue->submitters)
+        return false;
+    PsMemSet(queue->submitters, 0, JOB_SUBMITTERS * sizeof(JobSubmitter));
+    queue->capacity = capacity;
+    return true;
+}
+
+bool JobQueuePush(JobQueue* queue, JobItem* item, JobClass cls, uint64_t deadline, uint64_t submitter,
+                  uint32_t weight)
+{
+    JobQueue* q = queue;
+    if (q->count == q->capacity || (uint32_t)cls >= JOB_CLASSES)
+        return false;
+    if (weight == 0)
+        weight = 1;
+    if (weight > JOB_MAX_WEIGHT)
+        weight = JOB_MAX_WEIGHT;
+
+    // STAMP: One turn past the later of the class clock and the
+    // submitter's last job
+    JobSubmitter* s = FindSubmitter(q, submitter ? submitter : 1);
+    uint64_t start = q->clock[cls];
+    if (s && s->stamp[cls] > start)
+        start = s->stamp[cls];
+    item->stamp = start + JOB_COST / weight;
+    if (s)
+        s->stamp[cls] = item->stamp;
+
+    item->cls = (uint32_t)cls;
+    item->deadline = deadline;
+    item->arrival = q->arrivals++;
+    SiftUp(q, item, q->count++);
+    return true;
+}
+
+JobItem* JobQueuePop(JobQueue* queue)
+{
+    JobQueue* q = queue;
+    if (q->count == 0)
+        return NULL;
+    JobItem* item = q->heap[0];
+    JobQueueRemove(q, item);
+    if (item->stamp > q->clock[item->cls])
+        q->clock[item->cls] = item->stamp;
+    return item;
+}
+
+void JobQueueRemove(JobQueue* queue, JobItem* item)
+{
+    JobQueue* q = queue;
+    uint32_t slot = item->slot;
+    if (slot >= q->count || q->heap[slot] != item)
+        return;
+    item->slot = JOB_NOT_QUEUED;
+    JobItem* last = q->heap[--q->count];
+    if (last == item)
+        return;
+    // The last job fills the hole, then moves whichever way it must
+    if (slot > 0 && Before(last, q->heap[(slot - 1) / 2]))
+        SiftUp(q, last, slot);
+    else
+        SiftDown(q, last, slot);
+}
+
+//--------------------------------------------------------------------------
+// CLASSES
+//--------------------------------------------------------------------------
+bool JobParseClass(const PSCHAR* text, JobClass* cls)
+{
+    for (int c = 0; c < JOB_CLASSES; c++)
+    {
+        if (PsStrCmpI(text, g_classNames[c]) == 0)
+        {
+            *cls = (JobClass)c;
+            return true;
+        }
+    }
+    return false;
+}
+
+const PSCHAR* JobClassName(JobClass cls)
+{
+    return (uint32_t)cls < JOB_CLASSES ? g_classNames[cls] : PS_T("normal");
+}
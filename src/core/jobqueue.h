@@ -0,0 +1,111 @@
+//--------------------------------------------------------------------------
+// JOB QUEUE - Pending launches by class, deadline and fair share
+//--------------------------------------------------------------------------
+// The submission server (server.h) and the resident scheduler
+// (scheduler.h) run so many launches at once; the rest wait here, and the
+// next one out is decided by, in turn:
+//   1. Class: interactive before normal before bulk, so a logon script
+//      never waits for maintenance.
+//   2. Deadline, earliest first (EDF); a job without one comes after every
+//      job of its class that has one.
+//   3. Fair share between submitters, by weight.
+//   4. Arrival.
+//
+// Fair share is weighted fair queueing on a virtual clock per class. A job
+// is stamped as it is queued with the later of the class clock (the stamp
+// of the last job out) and its submitter's previous stamp, plus
+// JOB_COST / weight. A 500-job batch queued at once stamps out 500 turns
+// ahead; a job from anyone else queued behind it stamps one turn past the
+// clock, so it goes after at most a turn of the batch, and a submitter of
+// weight 2 gets two turns to another's one.
+//
+// Everything is one binary heap on those four keys: push, pop and removal
+// are O(log n), each job keeping its heap position. Submitters are known
+// by a 64-bit key (JobSubmitterKey) in a fixed open-addressing table; one
+// whose stamps the clocks have passed is no different from a new one, so
+// its slot is reused and the table never grows. Jobs are intrusive: the
+// caller embeds a JobItem in its own record. Nothing is allocated after
+// JobQueueInit, and nothing here is thread safe.
+
+#ifndef PS_JOBQUEUE_H
+#define PS_JOBQUEUE_H
+
+#include "arena.h"
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+#define JOB_NO_DEADLINE   UINT64_MAX
+#define JOB_NOT_QUEUED    UINT32_MAX
+#define JOB_COST          ((uint64_t)1 << 20)   // Virtual time of one turn at weight 1
+#define JOB_MAX_WEIGHT    100
+#define JOB_SUBMITTERS    4096                  // Fair-share table slots
+#define JOB_PROBES        32                    // Longest submitter lookup
+
+typedef enum JobClass
+{
+    JOB_INTERACTIVE = 0,
+    JOB_NORMAL = 1,
+    JOB_BULK = 2,
+    JOB_CLASSES = 3
+} JobClass;
+
+typedef struct JobItem
+{
+    uint64_t deadline;               // Any clock, the same for every job; JOB_NO_DEADLINE
+    uint64_t stamp;                  // Fair-share position
+    uint64_t arrival;
+    uint32_t cls;
+    uint32_t slot;                   // Heap position; JOB_NOT_QUEUED when out
+} JobItem;
+
+typedef struct JobSubmitter
+{
+    uint64_t key;                    // 0: empty slot
+    uint64_t stamp[JOB_CLASSES];     // Its latest job's stamp per class
+} JobSubmitter;
+
+typedef struct JobQueue
+{
+    JobItem** heap;
+    uint32_t count;
+    uint32_t capacity;
+    uint64_t arrivals;
+    uint64_t clock[JOB_CLASSES];     // Stamp of the last job out
+    JobSubmitter* submitters;
+} JobQueue;
+
+// Room for capacity pending jobs. False if out of memory.
+bool JobQueueInit(JobQueue* queue, Arena* arena, uint32_t capacity);
+
+// Queue item for submitter at weight 1..JOB_MAX_WEIGHT (0: 1). False when
+// the queue is full.
+bool JobQueuePush(JobQueue* queue, JobItem* item, JobClass cls, uint64_t deadline, uint64_t submitter,
+                  uint32_t weight);
+
+// The next job, out of the queue; NULL when it is empty
+JobItem* JobQueuePop(JobQueue* queue);
+
+// Take a pending job out without running it (no effect if it is not queued)
+void JobQueueRemove(JobQueue* queue, JobItem* item);
+
+static inline bool JobQueued(const JobItem* item)
+{
+    return item->slot != JOB_NOT_QUEUED;
+}
+
+static inline uint32_t JobQueueCount(const JobQueue* queue)
+{
+    return queue->count;
+}
+
+// Submitter key of a name (user, task or agent); never 0
+uint64_t JobSubmitterKey(const PSCHAR* name, size_t len);
+
+// "interactive", "normal" or "bulk", any case
+bool JobParseClass(const PSCHAR* text, JobClass* cls);
+const PSCHAR* JobClassName(JobClass cls);
+
+PS_EXTERN_C_END
+
+#endif // PS_JOBQUEUE_H
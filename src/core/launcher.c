@@ -0,0 +1,675 @@
+//--------------------------------------------------------------------------
+// LAUNCHER - The complete launch sequence behind WinMain/main
+//--------------------------------------------------------------------------
+#include "launcher.h"
+#include "arena.h"
+#include "args.h"
+#include "catalog.h"
+#include "cmdline.h"
+#include "config.h"
+#include "envblock.h"
+#include "incremental.h"
+#include "indexer.h"
+#include "log.h"
+#include "metrics.h"
+#include "payload.h"
+#include "platform.h"
+#include "probe.h"
+#include "psmem.h"
+#include "psstr.h"
+#include "resultcache.h"
+#include "runid.h"
+#include "runrecord.h"
+#include "scheduler.h"
+#include "searchpath.h"
+#include "server.h"
+#include "status.h"
+#include "strbuf.h"
+#include "trace.h"
+#include "watch.h"
+
+#ifdef ENABLE_ERROR_DIALOGS
+static void ShowError(const PSCHAR* msg, const PSCHAR* title)
+{
+    PlatShowMessage(msg, title, PLAT_MESSAGE_ERROR);
+}
+#else
+    #define ShowError(msg, title) ((void)0)  // No-op macro - silent mode
+#endif
+
+static const PSCHAR g_usage[] =
+    PS_T("PS-Launcher Usage:\n\n")
+    PS_T("ps-launcher.exe -Script <script_path> [parameters]\n\n")
+    PS_T("Examples:\n")
+    PS_T("  ps-launcher.exe -Script test.ps1\n")
+    PS_T("  ps-launcher.exe -Script test.ps1 -FilePath \"C:\\temp\\test.txt\"\n")
+    PS_T("  ps-launcher.exe -Script test.ps1 -FileList \"file1.txt,file2.txt\"\n")
+    PS_T("  ps-launcher.exe -Script test.ps1 -Name \"John Doe\" -Verbose\n\n")
+    PS_T("Self-contained launcher (scripts embedded, no file access at run time):\n")
+    PS_T("  ps-launcher.exe -Pack <output.exe> <script.ps1> [more scripts]\n")
+    PS_T("  output.exe [parameters]                  runs the first script\n")
+    PS_T("  output.exe -Script <name> [parameters]   runs the named script\n\n")
+    PS_T("Script catalogue (aliases from ps-launcher.catalog in the state directory):\n")
+    PS_T("  ps-launcher.exe -Index                    refresh the catalogue index\n")
+    PS_T("  ps-launcher.exe -Script @<alias> [parameters]\n")
+    PS_T("  Profiles with \"inputs\" skip runs whose inputs are unchanged;\n")
+    PS_T("  profiles with \"cache\" reuse recent results.\n\n")
+    PS_T("Resident scheduler (cron-style entries from ps-launcher.schedule):\n")
+    PS_T("  ps-launcher.exe -Schedule [schedule file]  runs until the file is deleted\n\n")
+    PS_T("Watch mode (one run per batch of changed files, listed in -ChangeList):\n")
+    PS_T("  ps-launcher.exe -Watch <directory> [-Debounce <ms>] -Script <script_path> [parameters]\n\n")
+    PS_T("Submission server (launches submitted over a local socket or named pipe):\n")
+    PS_T("  ps-launcher.exe -Serve [endpoint]          default from PS_LAUNCHER_ENDPOINT\n\n")
+    PS_T("Status board (every launch of this user that is running now):\n")
+    PS_T("  ps-launcher.exe -Status\n\n")
+    PS_T("Run metrics (histograms per script and exit class, Prometheus text or JSON):\n")
+    PS_T("  ps-launcher.exe -Metrics [-Json] [metrics files from other machines]\n\n")
+    PS_T("Relative script paths not found in the current directory are looked up\n")
+    PS_T("in the directories listed in PS_LAUNCHER_SCRIPT_PATH.\n\n")
+    PS_T("Notes:\n")
+    PS_T("- Parameters with spaces must be quoted\n")
+    PS_T("- Array parameters should be comma-separated within quotes\n")
+    PS_T("- Returns 0 for success, 1 for errors or if no script specified");
+
+// TRACE: A launch is one track of consecutive phases, each ending where
+// the next begins (trace.h)
+#define LAUNCH_TRACK 1
+
+static TraceBuffer g_trace;
+static uint64_t g_phaseNanos;
+
+static void TracePhase(const char* name)
+{
+    if (!g_trace.events)
+        return;
+    uint64_t now = PlatMonotonicNanos();
+    TraceSpan(&g_trace, LAUNCH_TRACK, &g_trace.run, name, g_phaseNanos, now);
+    g_phaseNanos = now;
+}
+
+// Record the outcome of this launch, close the log and pass the code through
+static int Finish(RunRecord* record, RunStatus status, uint32_t exitCode,
+                  const RunTiming* timing, Arena* arena)
+{
+    record->status = status;
+    record->exitCode = exitCode;
+    record->durationMicros = (PlatMonotonicNanos() - timing->startNanos) / 1000;
+    AppendRunRecord(record, arena);
+    RecordRunMetrics(record, timing);
+    (void)arena;                        // Unused when the journal is compiled out
+    TracePhase("finish");
+    TraceClose(&g_trace);
+    StatusEnd();
+    CloseLog();
+    return (int)exitCode;
+}
+
+// Packed launcher: pick the embedded script this invocation runs
+// - "-Script <name>" naming an embedded script (case-insensitive)
+// - no -Script at all: the first script, with every argument as a parameter
+// Anything else (including -Script with a real path) takes the file path.
+static bool FindEmbeddedScript(Arena* arena, int argc, PSCHAR* const* argv,
+                               LaunchArgs* args, PayloadScript* script)
+{
+    size_t size = 0;
+    const void* payload = PlatFindPayload(&size);
+    if (!payload || PayloadCount(payload, size) <= 0)
+        return false;
+
+    if (argc >= 2 && PsStrCmpI(argv[1], PS_T("-Script")) == 0)
+    {
+        if (argc < 3)
+            return false;
+        char name[PS_MAX_PATH * 3];
+        size_t nameLen = PlatToUtf8(argv[2], PsStrLen(argv[2]), name, sizeof(name));
+        int index = nameLen ? PayloadFind(payload, size, name, nameLen) : -1;
+        if (index < 0 || !PayloadGet(payload, size, index, script))
+            return false;
+        args->script = argv[2];
+        args->params = argv + 3;
+        args->paramCount = argc - 3;
+        return true;
+    }
+
+    if (!PayloadGet(payload, size, 0, script))
+        return false;
+    args->script = PayloadScriptName(arena, script);
+    args->params = argv + 1;
+    args->paramCount = argc > 1 ? argc - 1 : 0;
+    return args->script != NULL;
+}
+
+#ifdef ENABLE_CATALOG
+// "-Script @alias": swap in the indexed path and the profile's parameters
+static bool ResolveAlias(Arena* arena, LaunchArgs* args, CatalogScript* resolved,
+                         RunStatus* failure)
+{
+    CatalogStatus status = CatalogResolve(arena, args->script + 1, args->params,
+                                          args->paramCount, resolved);
+    switch (status)
+    {
+    case CATALOG_OK:
+        LogFormat(PS_T("Catalogue script: %s"), resolved->path);
+        args->script = resolved->path;
+        args->params = resolved->params;
+        args->paramCount = resolved->paramCount;
+        return true;
+    case CATALOG_NO_INDEX:
+        LogWrite(PS_T("ERROR: No catalogue index - run ps-launcher -Index"));
+        *failure = RUN_NOT_FOUND;
+        break;
+    case CATALOG_NOT_FOUND:
+        LogWrite(PS_T("ERROR: Alias not in the catalogue"));
+        *failure = RUN_NOT_FOUND;
+        break;
+    case CATALOG_MISSING:
+        LogWrite(PS_T("ERROR: Catalogue script no longer exists"));
+        *failure = RUN_NOT_FOUND;
+        break;
+    case CATALOG_STALE:
+        // SECURITY CHECK: Never run content other than what was indexed
+        LogWrite(PS_T("ERROR: Catalogue script changed since indexing - run ps-launcher -Index"));
+        *failure = RUN_STALE;
+        break;
+    default:
+        LogWrite(PS_T("ERROR: Out of memory resolving the alias"));
+        *failure = RUN_NOT_FOUND;
+        break;
+    }
+    ShowError(PS_T("Catalogue alias could not be resolved."), PS_T("Error"));
+    return false;
+}
+
+// Profiles with inputs: compare them with the last successful run's
+// manifest. False means run the script (out of date or not checkable).
+static bool CheckInputs(Arena* arena, const LaunchArgs* args, const CatalogScript* resolved,
+                        IncrementalState* state)
+{
+    PSCHAR stateDir[PS_MAX_PATH];
+    if (!PlatGetStateDirectory(stateDir, PS_MAX_PATH))
+        return false;
+    PSCHAR* manifestPath = IncrementalManifestPath(arena, stateDir, args->script,
+                                                   args->params, args->paramCount);
+
+    // Relative globs and outputs belong to the script's directory
+    size_t dirLen = PsStrLen(args->script);
+    while (dirLen > 0 && args->script[dirLen - 1] != PS_PATH_SEP && args->script[dirLen - 1] != PS_T('/'))
+        dirLen--;
+    PSCHAR* baseDir = (PSCHAR*)ArenaAlloc(arena, (dirLen + 1) * sizeof(PSCHAR));
+    if (!manifestPath || !baseDir)
+        return false;
+    PsMemCpy(baseDir, args->script, dirLen * sizeof(PSCHAR));
+    baseDir[dirLen] = 0;
+
+    IncrementalStatus status = CheckIncremental(arena, manifestPath, resolved->sha256, dirLen ? baseDir : NULL,
+                                                resolved->inputs, resolved->inputCount,
+                                                resolved->outputs, resolved->outputCount, state);
+    LogNumber(PS_T("Incremental inputs: "), state->stats.inputs);
+    LogNumber(PS_T("Incremental inputs hashed: "), state->stats.hashed);
+    LogNumber(PS_T("Incremental inputs changed: "), state->stats.changed);
+    if (status == INCREMENTAL_ERROR)
+        LogWrite(PS_T("WARNING: Inputs could not be checked - running the script"));
+    return status == INCREMENTAL_UP_TO_DATE;
+}
+
+// Profiles with a cache lifetime: key this call for the result cache
+static bool OpenResultCache(Arena* arena, const LaunchArgs* args, const CatalogScript* resolved,
+                            ResultCache* cache)
+{
+    PSCHAR stateDir[PS_MAX_PATH];
+    return PlatGetStateDirectory(stateDir, PS_MAX_PATH) &&
+           ResultCacheOpen(arena, stateDir, resolved->sha256, args->script, args->params,
+                           args->paramCount, resolved->cacheSeconds, resolved->cacheOutput, cache);
+}
+#endif
+
+#ifdef ENABLE_LOGGING
+// Where a probed run's time went, in microseconds from the child's creation
+static void LogProbe(const RunTiming* timing)
+{
+    if (!timing->prologueNanos)
+    {
+        LogWrite(PS_T("WARNING: The startup probe did not report (the script never started)"));
+        return;
+    }
+    LogNumber(PS_T("Interpreter startup (us): "), (timing->prologueNanos - timing->spawnNanos) / 1000);
+    LogNumber(PS_T("Script body (us): "), (timing->exitNanos - timing->prologueNanos) / 1000);
+    if (timing->firstOutputNanos)
+        LogNumber(PS_T("Time to first output (us): "), (timing->firstOutputNanos - timing->spawnNanos) / 1000);
+}
+#else
+    #define LogProbe(timing) ((void)0)
+#endif
+
+// Wait for the child, publishing its CPU time and captured output as it goes
+static bool WaitForScript(PlatProcess* proc, PlatFile capture, uint32_t* exitCode)
+{
+#ifdef ENABLE_STATUS_BOARD
+    PlatChildState state;
+    while ((state = PlatWaitTimeout(proc, STATUS_REFRESH_MS, exitCode)) == PLAT_CHILD_RUNNING)
+    {
+        uint64_t cpuMicros = 0, outputBytes = 0;
+        PlatProcessCpuMicros(proc, &cpuMicros);
+        if (capture != PLAT_INVALID_FILE)
+            PlatFileSize(capture, &outputBytes);
+        StatusProgress(cpuMicros, outputBytes);
+    }
+    return state == PLAT_CHILD_EXITED;
+#else
+    (void)capture;
+    return PlatWait(proc, exitCode);
+#endif
+}
+
+static int Launch(Arena* arena, int argc, PSCHAR* const* argv, RunTiming* timing)
+{
+    RunRecord record = { 0 };
+    record.startMillis = PlatWallClockMillis();
+
+#ifdef ENABLE_STATUS_BOARD
+    //----------------------------------------------------------------------
+    // STATUS MODE - ps-launcher -Status (before the log: it touches no file)
+    //----------------------------------------------------------------------
+    if (argc == 2 && PsStrCmpI(argv[1], PS_T("-Status")) == 0)
+        return ShowStatusBoard(arena);
+#endif
+
+#ifdef ENABLE_METRICS
+    //----------------------------------------------------------------------
+    // METRICS MODE - ps-launcher -Metrics [-Json] [file...] (no log either)
+    //----------------------------------------------------------------------
+    if (argc >= 2 && PsStrCmpI(argv[1], PS_T("-Metrics")) == 0)
+        return ShowMetrics(arena, argc - 2, argv + 2);
+#endif
+
+    // Initialize logging
+    InitLog(arena);
+    LogWrite(PS_T("========================================"));
+    LogWrite(PS_T("PS-Launcher Execution Log"));
+    LogWrite(PS_T("========================================"));
+
+    //----------------------------------------------------------------------
+    // PACK MODE - ps-launcher -Pack <output> <script> [script...]
+    //----------------------------------------------------------------------
+    if (argc >= 2 && PsStrCmpI(argv[1], PS_T("-Pack")) == 0)
+    {
+        if (argc < 4)
+        {
+            LogWrite(PS_T("ERROR: -Pack needs an output path and at least one script"));
+            PlatShowMessage(g_usage, PS_T("PS-Launcher Help"), PLAT_MESSAGE_INFO);
+            CloseLog();
+            return 1;
+        }
+        bool packed = PackScripts(arena, argv[2], argv + 3, argc - 3);
+        if (!packed)
+            ShowError(PS_T("Failed to create the packed launcher."), PS_T("Error"));
+        CloseLog();
+        return packed ? 0 : 1;
+    }
+
+#ifdef ENABLE_CATALOG
+    //----------------------------------------------------------------------
+    // INDEX MODE - ps-launcher -Index
+    //----------------------------------------------------------------------
+    if (argc == 2 && PsStrCmpI(argv[1], PS_T("-Index")) == 0)
+    {
+        IndexStats stats;
+        bool indexed = IndexCatalog(arena, &stats);
+        if (!indexed)
+            ShowError(PS_T("Failed to build the catalogue index."), PS_T("Error"));
+        CloseLog();
+        return indexed ? 0 : 1;
+    }
+#endif
+
+#ifdef ENABLE_SCHEDULER
+    //----------------------------------------------------------------------
+    // SCHEDULE MODE - ps-launcher -Schedule [schedule file]
+    //----------------------------------------------------------------------
+    if (argc >= 2 && argc <= 3 && PsStrCmpI(argv[1], PS_T("-Schedule")) == 0)
+    {
+        StatusBegin(argc == 3 ? argv[2] : NULL, STATUS_SCHEDULE);
+        int code = RunScheduler(arena, argc == 3 ? argv[2] : NULL);
+        StatusEnd();
+        if (code != 0)
+            ShowError(PS_T("Failed to load the schedule."), PS_T("Error"));
+        CloseLog();
+        return code;
+    }
+#endif
+
+#ifdef ENABLE_WATCH
+    //----------------------------------------------------------------------
+    // WATCH MODE - ps-launcher -Watch <dir> [-Debounce <ms>] <arguments>
+    //----------------------------------------------------------------------
+    if (argc >= 2 && PsStrCmpI(argv[1], PS_T("-Watch")) == 0)
+    {
+        StatusBegin(argc >= 3 ? argv[2] : NULL, STATUS_WATCH);
+        int code = RunWatch(arena, argc - 2, argv + 2);
+        StatusEnd();
+        if (code != 0)
+            ShowError(PS_T("Failed to watch the directory."), PS_T("Error"));
+        CloseLog();
+        return code;
+    }
+#endif
+
+#ifdef ENABLE_SERVER
+    //----------------------------------------------------------------------
+    // SERVE MODE - ps-launcher -Serve [endpoint]
+    //----------------------------------------------------------------------
+    if (argc >= 2 && argc <= 3 && PsStrCmpI(argv[1], PS_T("-Serve")) == 0)
+    {
+        StatusBegin(argc == 3 ? argv[2] : NULL, STATUS_SERVE);
+        int code = RunServer(arena, argc == 3 ? argv[2] : NULL);
+        StatusEnd();
+        if (code != 0)
+            ShowError(PS_T("Failed to start the submission server."), PS_T("Error"));
+        CloseLog();
+        return code;
+    }
+#endif
+
+    // RUN IDS: Ours (or the one our starter assigned) and the run we were
+    // started from; the script sees both (runid.h)
+    RunIdSource ids;
+    RunIdBegin(&ids, &record.id, &record.parent);
+
+    TraceBegin(&g_trace, arena, "ps-launcher", TRACE_LAUNCH_EVENTS);
+    TraceSetRun(&g_trace, &record.id, &record.parent);
+    TraceNameTrack(&g_trace, LAUNCH_TRACK, "launch", PlatCurrentProcessId());
+    if (timing->queuedNanos && timing->queuedNanos <= timing->startNanos)
+        TraceSpan(&g_trace, LAUNCH_TRACK, &record.id, "queued", timing->queuedNanos, timing->startNanos);
+    g_phaseNanos = timing->startNanos;
+
+    //----------------------------------------------------------------------
+    // INPUT VALIDATION - Defensive programming
+    //----------------------------------------------------------------------
+    LaunchArgs args;
+    PayloadScript embedded;
+    bool isEmbedded = FindEmbeddedScript(arena, argc, argv, &args, &embedded);
+    if (!isEmbedded && !ParseLaunchArgs(argc, argv, &args))
+    {
+        LogWrite(PS_T("ERROR: Invalid arguments - must provide -Script parameter"));
+        PlatShowMessage(g_usage, PS_T("PS-Launcher Help"), PLAT_MESSAGE_INFO);
+        return Finish(&record, RUN_USAGE, 1, timing, arena);
+    }
+
+    record.script = args.script;
+    StatusBegin(args.script, STATUS_RUN);
+    TraceSetDetail(&g_trace, args.script);
+    TracePhase("startup");
+    LogFormat(isEmbedded ? PS_T("Embedded script: %s") : PS_T("Script file: %s"), args.script);
+    PSCHAR idText[RUN_ID_CHARS + 1];
+    RunIdFormat(&record.id, idText);
+    LogFormat(PS_T("Run id: %s"), idText);
+    RunIdFormat(&record.parent, idText);
+    LogFormat(PS_T("Parent run id: %s"), idText);
+
+#ifdef ENABLE_CATALOG
+    // The journal keeps the alias; everything below sees the real path
+    RunStatus failure;
+    CatalogScript resolved = { 0 };
+    if (!isEmbedded && args.script[0] == PS_T('@') && !ResolveAlias(arena, &args, &resolved, &failure))
+        return Finish(&record, failure, 1, timing, arena);
+#endif
+
+    // STARTUP PROBE: Script files only, and not while the result cache
+    // takes the output
+    bool isProbed = !isEmbedded && ProbeRequested();
+#ifdef ENABLE_CATALOG
+    isProbed = isProbed && !(resolved.cacheSeconds > 0 && resolved.cacheOutput);
+#endif
+
+    //----------------------------------------------------------------------
+    // FILE VALIDATION - Interpreter and script must both exist
+    //----------------------------------------------------------------------
+    PSCHAR psPath[PS_MAX_PATH];
+    if (!PlatGetInterpreterPath(psPath, PS_MAX_PATH))
+    {
+        LogWrite(PS_T("ERROR: PowerShell path too long"));
+        ShowError(PS_T("PowerShell path too long."), PS_T("Error"));
+        return Finish(&record, RUN_NOT_FOUND, 1, timing, arena);
+    }
+
+    LogFormat(PS_T("PowerShell path: %s"), psPath);
+
+    if (!PlatFileExists(psPath))
+    {
+        LogWrite(PS_T("ERROR: PowerShell executable not found"));
+        ShowError(PS_T("PowerShell executable not found."), PS_T("Error"));
+        return Finish(&record, RUN_NOT_FOUND, 1, timing, arena);
+    }
+
+    // Relative scripts missing from the current directory are looked up on
+    // PS_LAUNCHER_SCRIPT_PATH (the journal keeps the name as given)
+    bool scriptExists = isEmbedded || PlatFileExists(args.script);
+    if (!scriptExists && IsRelativePath(args.script))
+    {
+        PSCHAR* onPath = FindOnScriptPath(arena, args.script);
+        if (onPath)
+        {
+            LogFormat(PS_T("Found on script path: %s"), onPath);
+            args.script = onPath;
+            scriptExists = true;
+        }
+    }
+
+    if (!scriptExists)
+    {
+        LogWrite(PS_T("ERROR: Script file not found"));
+        ShowError(PS_T("Specified script file not found."), PS_T("Error"));
+        return Finish(&record, RUN_NOT_FOUND, 1, timing, arena);
+    }
+
+    //----------------------------------------------------------------------
+    // COMMAND LINE BUILDING - Arena string builder, capped at the OS limit
+    //----------------------------------------------------------------------
+    LogWrite(PS_T("Processing script parameters..."));
+
+    StrBuf cmd;
+    int blocked = -1;
+    CmdStatus status = CMD_OVERFLOW;
+    if (StrBufInit(&cmd, arena, 1024, PS_MAX_COMMAND_LINE))
+    {
+        status = isEmbedded ? BuildEmbeddedCommandLine(&cmd, psPath, &args, &blocked)
+               : isProbed   ? BuildProbeCommandLine(&cmd, psPath, &args, &blocked)
+                            : BuildCommandLine(&cmd, psPath, &args, &blocked);
+    }
+    switch (status)
+    {
+    case CMD_OK:
+        break;
+    case CMD_BLOCKED:
+        // Silent failure - return exit code 1 for semicolon injection attempts
+        LogWrite(PS_T("ERROR: Semicolon detected in parameter (security block)"));
+        return Finish(&record, RUN_BLOCKED, 1, timing, arena);
+    default:
+        LogWrite(PS_T("ERROR: Command line exceeds the maximum length"));
+        ShowError(PS_T("Command line too long."), PS_T("Error"));
+        return Finish(&record, RUN_OVERFLOW, 1, timing, arena);
+    }
+
+    LogWrite(PS_T("Final command line:"));
+    LogWrite(cmd.data);
+    TracePhase("resolve");
+
+    //----------------------------------------------------------------------
+    // EMBEDDED SCRIPT - Decompressed into the arena, sent over stdin
+    //----------------------------------------------------------------------
+    const uint8_t* script = NULL;
+    if (isEmbedded)
+    {
+        script = PayloadExtract(arena, &embedded);
+        if (!script)
+        {
+            LogWrite(PS_T("ERROR: Embedded script is corrupt"));
+            ShowError(PS_T("Embedded script is corrupt."), PS_T("Error"));
+            return Finish(&record, RUN_NOT_FOUND, 1, timing, arena);
+        }
+        LogNumber(PS_T("Embedded script bytes: "), embedded.rawSize);
+    }
+
+#ifdef ENABLE_CATALOG
+    //----------------------------------------------------------------------
+    // INCREMENTAL MODE - Skip the run when its declared inputs are unchanged
+    //----------------------------------------------------------------------
+    IncrementalState incremental;
+    bool isIncremental = resolved.inputCount > 0;
+    if (isIncremental && CheckInputs(arena, &args, &resolved, &incremental))
+    {
+        LogNumber(PS_T("Inputs unchanged - skipped, recorded exit code: "), incremental.exitCode);
+        return Finish(&record, RUN_UP_TO_DATE, incremental.exitCode, timing, arena);
+    }
+
+    //----------------------------------------------------------------------
+    // RESULT CACHE - A recent result of the same call stands in for a run
+    //----------------------------------------------------------------------
+    ResultCache cache;
+    bool isCached = resolved.cacheSeconds > 0 && OpenResultCache(arena, &args, &resolved, &cache);
+    uint32_t cachedCode = 0;
+    if (isCached && ResultCacheLookup(&cache, PlatWallClockMillis(), PlatStandardOutput(), &cachedCode))
+    {
+        LogNumber(PS_T("Served from the result cache, exit code: "), cachedCode);
+        return Finish(&record, RUN_CACHED, cachedCode, timing, arena);
+    }
+#endif
+
+    // The script's environment: ours plus its run ids (unchanged when
+    // there is no memory for the copy)
+    const PSCHAR* vars[RUN_ID_VARS];
+    const PSCHAR* envBlock = RunIdVariables(arena, &record.id, &record.parent, NULL, vars)
+                           ? BuildEnvironmentBlock(arena, NULL, vars, RUN_ID_VARS) : NULL;
+
+    LogWrite(PS_T("Creating PowerShell process..."));
+    TracePhase("checks");
+
+    //----------------------------------------------------------------------
+    // PROCESS CREATION - Spawn, wait and collect the exit code
+    //----------------------------------------------------------------------
+    PlatProcess proc = { 0 };
+    PlatFile capture = PLAT_INVALID_FILE;
+    PlatFile probe = PLAT_INVALID_FILE;
+#ifdef ENABLE_CATALOG
+    // Cached output is captured to a file and replayed once the run ends
+    if (isCached && resolved.cacheOutput)
+        capture = ResultCacheBeginCapture(&cache);
+#endif
+    bool spawned = isEmbedded
+        ? PlatSpawnWithInput(psPath, cmd.data, envBlock, script, embedded.rawSize, &proc)
+        : isProbed ? PlatSpawnCaptured(psPath, cmd.data, envBlock, NULL, &proc, &probe)
+        : capture != PLAT_INVALID_FILE ? PlatSpawnToFile(psPath, cmd.data, envBlock, capture, &proc)
+                                       : PlatSpawn(psPath, cmd.data, envBlock, &proc);
+    if (!spawned)
+    {
+#ifdef ENABLE_CATALOG
+        if (isCached)
+            ResultCacheAbort(&cache);
+#endif
+        LogWrite(PS_T("ERROR: Failed to create PowerShell process"));
+        uint32_t err = PlatLastError();
+
+        // ERROR MESSAGE FORMATTING: Convert error code to human-readable text
+        PSCHAR* errMsg = (PSCHAR*)ArenaAlloc(arena, 256 * sizeof(PSCHAR));
+        if (!errMsg)
+            return Finish(&record, RUN_SPAWN_FAILED, err, timing, arena);
+        PlatFormatError(err, errMsg, 256);
+        LogFormat(PS_T("System error: %s"), errMsg);
+        ShowError(errMsg, PS_T("Process Creation Failed"));
+        return Finish(&record, RUN_SPAWN_FAILED, err, timing, arena);
+    }
+
+    timing->spawnNanos = PlatMonotonicNanos();
+    TracePhase("spawn");
+    LogWrite(PS_T("Process created successfully"));
+    LogWrite(PS_T("Waiting for script execution to complete..."));
+    StatusSetPhase(STATUS_RUNNING, proc.pid);
+
+    uint32_t exitCode = 0;
+    bool waited = true;
+    if (isProbed)
+    {
+        waited = ProbeRelay(&proc, probe, PlatStandardOutput(), timing, &exitCode);
+        PlatCloseFile(probe);
+    }
+    else
+    {
+        waited = WaitForScript(&proc, capture, &exitCode);
+        timing->exitNanos = waited ? PlatMonotonicNanos() : 0;
+    }
+    if (g_trace.events)
+    {
+        uint64_t now = PlatMonotonicNanos();
+        TraceSpanArg(&g_trace, LAUNCH_TRACK, &record.id, "run", g_phaseNanos, now, "exitCode", exitCode);
+        if (timing->prologueNanos)
+        {
+            TraceSpan(&g_trace, LAUNCH_TRACK, &record.id, "interpreter startup", timing->spawnNanos,
+                      timing->prologueNanos);
+            TraceSpan(&g_trace, LAUNCH_TRACK, &record.id, "script body", timing->prologueNanos,
+                      timing->exitNanos);
+        }
+        if (timing->firstOutputNanos)
+            TraceInstant(&g_trace, LAUNCH_TRACK, &record.id, "first output", timing->firstOutputNanos);
+        g_phaseNanos = now;
+    }
+    StatusSetPhase(STATUS_FINISHING, proc.pid);
+    if (!waited)
+        LogWrite(PS_T("ERROR: Failed to retrieve script exit code"));
+    PlatCloseProcess(&proc);
+
+    LogNumber(PS_T("Script completed with exit code: "), exitCode);
+    if (isProbed)
+        LogProbe(timing);
+
+#ifdef ENABLE_CATALOG
+    // Only a successful run vouches for its inputs
+    if (isIncremental && waited && exitCode == 0 && !RecordIncremental(arena, &incremental, exitCode))
+        LogWrite(PS_T("WARNING: Could not record the incremental manifest"));
+
+    // Any exit code is a result; an unknown one is not
+    if (isCached && !waited)
+        ResultCacheAbort(&cache);
+    else if (isCached && !ResultCacheStore(arena, &cache, exitCode, PlatWallClockMillis(), PlatStandardOutput()))
+        LogWrite(PS_T("WARNING: Could not store the result in the cache"));
+#endif
+    LogWrite(PS_T("========================================"));
+    LogWrite(PS_T("Execution completed successfully"));
+    LogWrite(PS_T("========================================"));
+
+    // RETURN: Pass through PowerShell's exit code to caller
+    return Finish(&record, RUN_COMPLETED, exitCode, timing, arena);
+}
+
+int RunLauncher(int argc, PSCHAR* const* argv)
+{
+    RunTiming timing = { PlatMonotonicNanos(), QueuedSince(), 0, 0, 0, 0 };
+    Arena arena;
+    if (!ArenaInit(&arena, ARENA_DEFAULT_RESERVE))
+        return 1;
+
+    int exitCode = Launch(&arena, argc, argv, &timing);
+
+    // MEMORY CLEANUP: Every allocation of the launch goes in one call
+    ArenaRelease(&arena);
+    return exitCode;
+}
+
+int RunLauncherCommandLine(const PSCHAR* cmdline)
+{
+    RunTiming timing = { PlatMonotonicNanos(), QueuedSince(), 0, 0, 0, 0 };
+    Arena arena;
+    if (!ArenaInit(&arena, ARENA_DEFAULT_RESERVE))
+        return 1;
+
+    // ARGUMENT VIEWS: Every argument needs at least one character and a
+    // separator, so len / 2 + 2 slots always suffice
+    size_t len = PsStrLen(cmdline);
+    int maxArgs = (int)(len / 2 + 2);
+    PSCHAR* storage = (PSCHAR*)ArenaAlloc(&arena, (len + 1) * sizeof(PSCHAR));
+    PSCHAR** argv = (PSCHAR**)ArenaAlloc(&arena, (size_t)maxArgs * sizeof(PSCHAR*));
+    int argc = (storage && argv) ? SplitCommandLine(cmdline, storage, argv, maxArgs) : -1;
+
+    int exitCode = argc < 0 ? 1 : Launch(&arena, argc, argv, &timing);
+    ArenaRelease(&arena);
+    return exitCode;
+}
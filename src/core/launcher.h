@@ -0,0 +1,22 @@
+//--------------------------------------------------------------------------
+// LAUNCHER - The complete launch sequence behind WinMain/main
+//--------------------------------------------------------------------------
+#ifndef PS_LAUNCHER_H
+#define PS_LAUNCHER_H
+
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+// Parse, validate, build, spawn, wait, record.
+// Returns the script's exit code, 1 for launcher errors, or the OS error
+// code if the interpreter could not be started.
+int RunLauncher(int argc, PSCHAR* const* argv);
+
+// Same, for an unsplit command line (GetCommandLineW on Windows). The
+// argument views are split into the launch arena with SplitCommandLine.
+int RunLauncherCommandLine(const PSCHAR* cmdline);
+
+PS_EXTERN_C_END
+
+#endif // PS_LAUNCHER_H
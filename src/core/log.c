@@ -0,0 +1,115 @@
+//--------------------------------------------------------------------------
+// LOGGING FUNCTIONS - Comprehensive troubleshooting support
+//--------------------------------------------------------------------------
+#include "log.h"
+
+#ifdef ENABLE_LOGGING
+
+#include "platform.h"
+#include "psstr.h"
+#include "strbuf.h"
+
+static PlatFile g_hLogFile = PLAT_INVALID_FILE;
+static Arena* g_logArena;
+
+void InitLog(Arena* arena)
+{
+    PSCHAR logPath[PS_MAX_PATH];
+    size_t pos;
+
+    g_logArena = arena;
+    if (!PlatGetStateDirectory(logPath, PS_MAX_PATH))
+        return;
+    pos = PsStrLen(logPath);
+    if (!AppendChar(logPath, PS_MAX_PATH, PS_PATH_SEP, &pos) ||
+        !AppendStr(logPath, PS_MAX_PATH, PS_T("ps-launcher.log"), &pos))
+        return;
+
+    // Create new log file (overwrite existing)
+    g_hLogFile = PlatCreateFile(logPath, PLAT_FILE_OVERWRITE);
+}
+
+void LogWrite(const PSCHAR* message)
+{
+    if (g_hLogFile != PLAT_INVALID_FILE)
+        LogWriteN(message, PsStrLen(message));
+}
+
+void LogWriteN(const PSCHAR* message, size_t len)
+{
+    if (g_hLogFile == PLAT_INVALID_FILE)
+        return;
+
+    // SCRATCH BUFFER: Sized for the worst case (3 UTF-8 bytes per UTF-16
+    // unit) plus CRLF, and handed back to the arena after the write
+    ArenaMark mark = ArenaSave(g_logArena);
+    char* utf8Buffer = (char*)ArenaAlloc(g_logArena, len * 3 + 2);
+    if (utf8Buffer)
+    {
+        size_t utf8Len = PlatToUtf8(message, len, utf8Buffer, len * 3);
+        utf8Buffer[utf8Len] = '\r';
+        utf8Buffer[utf8Len + 1] = '\n';
+
+        // Return value intentionally not checked - logging is best-effort
+        // If logging fails, we continue execution rather than failing the entire operation
+        PlatWriteFile(g_hLogFile, utf8Buffer, utf8Len + 2);
+    }
+    ArenaRestore(g_logArena, mark);
+}
+
+void LogFormat(const PSCHAR* format, const PSCHAR* arg)
+{
+    if (g_hLogFile == PLAT_INVALID_FILE)
+        return;
+
+    ArenaMark mark = ArenaSave(g_logArena);
+    StrBuf line;
+    if (StrBufInit(&line, g_logArena, 256, STRBUF_NO_LIMIT))
+    {
+        // Simple format string processor - only handles one %s
+        const PSCHAR* spec = format;
+        while ((spec = PsStrChr(spec, PS_T('%'))) != NULL && spec[1] != PS_T('s'))
+            spec++;
+
+        if (spec)
+        {
+            // Text before %s, the argument, then the rest of the format
+            if (StrBufAppendN(&line, format, (size_t)(spec - format)) &&
+                (!arg || StrBufAppend(&line, arg)))
+                StrBufAppend(&line, spec + 2);
+        }
+        else
+        {
+            StrBufAppend(&line, format);
+        }
+        LogWriteN(line.data, line.len);
+    }
+    ArenaRestore(g_logArena, mark);
+}
+
+void LogNumber(const PSCHAR* message, uint64_t value)
+{
+    if (g_hLogFile == PLAT_INVALID_FILE)
+        return;
+
+    ArenaMark mark = ArenaSave(g_logArena);
+    StrBuf line;
+    if (StrBufInit(&line, g_logArena, 128, STRBUF_NO_LIMIT) &&
+        StrBufAppend(&line, message) &&
+        StrBufAppendUInt(&line, value))
+    {
+        LogWriteN(line.data, line.len);
+    }
+    ArenaRestore(g_logArena, mark);
+}
+
+void CloseLog(void)
+{
+    if (g_hLogFile != PLAT_INVALID_FILE)
+    {
+        PlatCloseFile(g_hLogFile);
+        g_hLogFile = PLAT_INVALID_FILE;
+    }
+}
+
+#endif // ENABLE_LOGGING
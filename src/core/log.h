@@ -0,0 +1,48 @@
+//--------------------------------------------------------------------------
+// LOGGING FUNCTIONS - Comprehensive troubleshooting support
+//--------------------------------------------------------------------------
+// Log file: <state directory>/ps-launcher.log, overwritten on each run.
+// With ENABLE_LOGGING undefined every call compiles away to nothing.
+
+#ifndef PS_LOG_H
+#define PS_LOG_H
+
+#include "arena.h"
+#include "config.h"
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+#ifdef ENABLE_LOGGING
+
+// Initialize log file (overwrites previous log)
+// Log lines are formatted in scratch space on arena, released per line.
+void InitLog(Arena* arena);
+
+// Write a line to the log file
+void LogWrite(const PSCHAR* message);
+
+// Write a line whose length is already known (message need not be terminated)
+void LogWriteN(const PSCHAR* message, size_t len);
+
+// Log formatted message (simple sprintf replacement - one %s)
+void LogFormat(const PSCHAR* format, const PSCHAR* arg);
+
+// Log a message followed by a decimal number
+void LogNumber(const PSCHAR* message, uint64_t value);
+
+// Close log file
+void CloseLog(void);
+
+#else
+    #define InitLog(arena) ((void)0)
+    #define LogWrite(msg) ((void)0)
+    #define LogWriteN(msg, len) ((void)0)
+    #define LogFormat(fmt, arg) ((void)0)
+    #define LogNumber(msg, value) ((void)0)
+    #define CloseLog() ((void)0)
+#endif
+
+PS_EXTERN_C_END
+
+#endif // PS_LOG_H
@@ -0,0 +1,199 @@
+//--------------------------------------------------------------------------
+// LZ CODEC - LZ4 block format, CRT-free
+//--------------------------------------------------------------------------
+#include "lz.h"
+#include "psmem.h"
+
+#define MIN_MATCH     4
+#define LAST_LITERALS 5       // Final bytes that are always literals
+#define MF_LIMIT      12      // No match may start in the last 12 bytes
+#define MAX_OFFSET    65535
+
+static inline uint32_t Read32(const uint8_t* p)
+{
+    uint32_t v;
+    PsMemCpy(&v, p, 4);
+    return v;
+}
+
+static inline uint32_t Hash(uint32_t sequence)
+{
+    // Knuth multiplicative hash of the next four bytes
+    return (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+// Length extension: 255 per byte, then the remainder
+static inline uint8_t* WriteLength(uint8_t* op, size_t len)
+{
+    for (; len >= 255; len -= 255)
+        *op++ = 255;
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+// Emit literals [anchor, ip) followed by a match (offset 0 = literals only)
+// Returns the new output position, or NULL if dst would overflow
+static uint8_t* EmitSequence(uint8_t* op, const uint8_t* oend, const uint8_t* anchor,
+                             size_t litLen, size_t offset, size_t matchLen)
+{
+    // Worst case: token, literal extension, literals, offset, match extension
+    size_t need = 1 + litLen / 255 + 1 + litLen + 2 + matchLen / 255 + 1;
+    if (need > (size_t)(oend - op))
+        return NULL;
+
+    uint8_t* token = op++;
+    *token = (uint8_t)((litLen >= 15 ? 15 : litLen) << 4);
+    if (litLen >= 15)
+        op = WriteLength(op, litLen - 15);
+    PsMemCpy(op, anchor, litLen);
+    op += litLen;
+
+    if (offset == 0)
+        return op;
+
+    *op++ = (uint8_t)offset;
+    *op++ = (uint8_t)(offset >> 8);
+    size_t ml = matchLen - MIN_MATCH;
+    *token |= (uint8_t)(ml >= 15 ? 15 : ml);
+    if (ml >= 15)
+        op = WriteLength(op, ml - 15);
+    return op;
+}
+
+size_t LzCompress(const void* src, size_t srcLen, void* dst, size_t dstCap, void* workspace)
+{
+    const uint8_t* base = (const uint8_t*)src;
+    const uint8_t* ip = base;
+    const uint8_t* anchor = base;
+    const uint8_t* iend = base + srcLen;
+    uint8_t* op = (uint8_t*)dst;
+    const uint8_t* oend = op + dstCap;
+    uint32_t* table = (uint32_t*)workspace;
+
+    if (srcLen > MF_LIMIT)
+    {
+        const uint8_t* mflimit = iend - MF_LIMIT;
+        const uint8_t* matchlimit = iend - LAST_LITERALS;
+        PsMemSet(table, 0, LZ_WORKSPACE_SIZE);
+
+        // Skip ahead faster through data that does not compress
+        unsigned misses = 0;
+        ip++;
+        while (ip < mflimit)
+        {
+            uint32_t h = Hash(Read32(ip));
+            const uint8_t* candidate = base + table[h];
+            table[h] = (uint32_t)(ip - base);
+
+            if (candidate >= ip || (size_t)(ip - candidate) > MAX_OFFSET ||
+                Read32(candidate) != Read32(ip))
+            {
+                ip += 1 + (misses++ >> 6);
+                continue;
+            }
+            misses = 0;
+
+            // Extend backwards over literals, then forwards to the limit
+            while (ip > anchor && candidate > base && ip[-1] == candidate[-1])
+            {
+                ip--;
+                candidate--;
+            }
+            const uint8_t* mp = ip + MIN_MATCH;
+            const uint8_t* cp = candidate + MIN_MATCH;
+            while (mp < matchlimit && *mp == *cp)
+            {
+                mp++;
+                cp++;
+            }
+
+            size_t matchLen = (size_t)(mp - ip);
+            op = EmitSequence(op, oend, anchor, (size_t)(ip - anchor),
+                              (size_t)(ip - candidate), matchLen);
+            if (!op)
+                return 0;
+            ip = mp;
+            anchor = ip;
+
+            // Index a position inside the match so repeats are found sooner
+            if (ip - 2 > base && ip < mflimit)
+                table[Hash(Read32(ip - 2))] = (uint32_t)(ip - 2 - base);
+        }
+    }
+
+    op = EmitSequence(op, oend, anchor, (size_t)(iend - anchor), 0, 0);
+    return op ? (size_t)(op - (uint8_t*)dst) : 0;
+}
+
+// Read a length extension; false if the input ends first
+static inline bool ReadLength(const uint8_t** ip, const uint8_t* iend, size_t* len)
+{
+    uint8_t b;
+    do
+    {
+        if (*ip >= iend)
+            return false;
+        b = *(*ip)++;
+        *len += b;
+    } while (b == 255);
+    return true;
+}
+
+bool LzDecompress(const void* src, size_t srcLen, void* dst, size_t dstLen)
+{
+    const uint8_t* ip = (const uint8_t*)src;
+    const uint8_t* iend = ip + srcLen;
+    uint8_t* op = (uint8_t*)dst;
+    uint8_t* const ostart = op;
+    uint8_t* const oend = op + dstLen;
+
+    while (ip < iend)
+    {
+        uint8_t token = *ip++;
+
+        // LITERALS
+        size_t litLen = token >> 4;
+        if (litLen == 15 && !ReadLength(&ip, iend, &litLen))
+            return false;
+        if (litLen > (size_t)(iend - ip) || litLen > (size_t)(oend - op))
+            return false;
+        PsMemCpy(op, ip, litLen);
+        ip += litLen;
+        op += litLen;
+
+        // The last sequence ends after its literals
+        if (ip == iend)
+            break;
+
+        // MATCH
+        if (iend - ip < 2)
+            return false;
+        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - ostart))
+            return false;
+
+        size_t matchLen = token & 15;
+        if (matchLen == 15 && !ReadLength(&ip, iend, &matchLen))
+            return false;
+        matchLen += MIN_MATCH;
+        if (matchLen > (size_t)(oend - op))
+            return false;
+
+        // Overlapping copies (offset < length) repeat the pattern, so
+        // non-overlapping ones can go in bulk and the rest byte by byte
+        const uint8_t* match = op - offset;
+        if (offset >= matchLen)
+        {
+            PsMemCpy(op, match, matchLen);
+            op += matchLen;
+        }
+        else
+        {
+            for (size_t i = 0; i < matchLen; i++)
+                *op++ = *match++;
+        }
+    }
+
+    return op == oend;
+}
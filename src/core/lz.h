@@ -0,0 +1,40 @@
+//--------------------------------------------------------------------------
+// LZ CODEC - LZ4 block format, CRT-free
+//--------------------------------------------------------------------------
+// Used for the embedded script payload (payload.c). Scripts are small and
+// decompressed once per launch, so the priorities are a tiny, bounds-safe
+// decoder and a fast greedy encoder; the ratio on PowerShell source is
+// typically 2-3x.
+//
+// Block format (LZ4): a sequence is
+//   token (literal length << 4 | match length - 4), length extension bytes
+//   (255 = keep going), literals, 2-byte little-endian offset, match length
+//   extension bytes. The last sequence has literals only. The last 5 bytes
+//   are always literals and no match starts in the last 12 bytes.
+
+#ifndef PS_LZ_H
+#define PS_LZ_H
+
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+// Encoder hash table: 2^LZ_HASH_BITS 32-bit positions
+#define LZ_HASH_BITS 12
+#define LZ_WORKSPACE_SIZE ((size_t)4 << LZ_HASH_BITS)
+
+// Largest possible output for srcLen input bytes (incompressible data)
+#define LZ_COMPRESS_BOUND(srcLen) ((srcLen) + (srcLen) / 255 + 16)
+
+// Compress into dst; workspace holds LZ_WORKSPACE_SIZE bytes (4-byte aligned)
+// Returns the compressed size, or 0 if dstCap is too small
+size_t LzCompress(const void* src, size_t srcLen, void* dst, size_t dstCap, void* workspace);
+
+// Decompress exactly dstLen bytes. Returns false for malformed or
+// truncated input, or if the block does not produce exactly dstLen bytes;
+// never reads or writes outside the given buffers.
+bool LzDecompress(const void* src, size_t srcLen, void* dst, size_t dstLen);
+
+PS_EXTERN_C_END
+
+#endif // PS_LZ_H
@@ -0,0 +1,822 @@
+//--------------------------------------------------------------------------
+// RUN METRICS - Duration histograms across runs, per script and exit class
+//--------------------------------------------------------------------------
+#include "metrics.h"
+#include "psatomic.h"
+#include "psbits.h"
+#include "psmem.h"
+#include "psstr.h"
+
+#define METRICS_MAGIC   0x4D4C5350u    // "PSLM"
+#define METRICS_VERSION 3
+
+#define SLOT_FREE     0
+#define SLOT_CLAIMING 1                // Name and key being written
+#define SLOT_READY    2
+
+#define CLAIM_SPINS   4096              // Waits on a slot being claimed before moving on
+#define READ_TRIES    64                // Reads of an exemplar being written before giving up
+
+struct MetricsHeader
+{
+    volatile uint32_t magic;
+    volatile uint32_t version;
+    volatile uint32_t slotCount;
+    volatile uint32_t bucketCount;
+    volatile uint32_t slotSize;
+    volatile uint32_t overflow;        // Samples dropped: every slot taken
+    uint32_t reserved[10];             // 64 bytes
+};
+
+struct MetricsSlot
+{
+    volatile uint32_t state;
+    uint8_t cls;                       // ExitClass
+    uint8_t reserved;
+    uint16_t nameLen;
+    uint64_t key;
+    char name[METRICS_NAME_BYTES];     // Not terminated
+    Histogram hist[METRIC_KINDS];
+    MetricsExemplar last[METRIC_KINDS];
+};
+
+// LAYOUT: Shared with other builds and other machines' copies; any change
+// needs a new METRICS_VERSION
+typedef char MetricsHeaderSize[sizeof(struct MetricsHeader) == 64 ? 1 : -1];
+typedef char MetricsExemplarSize[sizeof(MetricsExemplar) == 40 ? 1 : -1];
+typedef char MetricsSlotSize[sizeof(struct MetricsSlot) ==
+                             136 + METRIC_KINDS * (sizeof(Histogram) + sizeof(MetricsExemplar)) ? 1 : -1];
+
+#define METRICS_TABLE_BYTES (sizeof(struct MetricsHeader) + METRICS_SLOTS * sizeof(struct MetricsSlot))
+
+static const char* const g_classNames[EXIT_CLASSES] = { "ok", "error", "abnormal", "failed", "skipped" };
+
+//--------------------------------------------------------------------------
+// HISTOGRAMS
+//--------------------------------------------------------------------------
+uint32_t HistogramIndex(uint64_t value)
+{
+    if (value < 2 * METRICS_SUB_COUNT)
+        return (uint32_t)value;
+    unsigned shift = HighestBit64(value) - METRICS_SUB_BITS;
+    uint64_t index = (uint64_t)(shift + 1) * METRICS_SUB_COUNT + (value >> shift) - METRICS_SUB_COUNT;
+    return index < METRICS_BUCKETS ? (uint32_t)index : METRICS_BUCKETS - 1;
+}
+
+uint64_t HistogramLowest(uint32_t index)
+{
+    if (index < 2 * METRICS_SUB_COUNT)
+        return index;
+    unsigned shift = index / METRICS_SUB_COUNT - 1;
+    return (uint64_t)(METRICS_SUB_COUNT + index % METRICS_SUB_COUNT) << shift;
+}
+
+uint64_t HistogramHighest(uint32_t index)
+{
+    return HistogramLowest(index + 1) - 1;
+}
+
+void HistogramRecord(Histogram* h, uint64_t value)
+{
+    PsAtomicFetchAdd(&h->buckets[HistogramIndex(value)], 1);
+    PsAtomicFetchAdd64(&h->sum, value);
+    PsAtomicFetchAdd64(&h->count, 1);
+}
+
+void HistogramMerge(Histogram* into, const Histogram* from)
+{
+    into->count += from->count;
+    into->sum += from->sum;
+    for (uint32_t i = 0; i < METRICS_BUCKETS; i++)
+        into->buckets[i] += from->buckets[i];
+}
+
+void ExemplarRecord(MetricsExemplar* x, const RunId* run, uint64_t value, uint64_t atMillis)
+{
+    // TRY LOCK: An odd sequence is a writer inside; this sample is as
+    // recent as that one, so it is dropped rather than waited on
+    uint32_t seq = PsAtomicLoad(&x->sequence);
+    if ((seq & 1) || !PsAtomicCompareExchange(&x->sequence, seq, seq + 1))
+        return;
+    PsAtomicFence();
+    if (atMillis >= x->atMillis)
+    {
+        x->atMillis = atMillis;
+        x->value = value;
+        x->run = *run;
+    }
+    PsAtomicStore(&x->sequence, seq + 2);
+}
+
+void ExemplarMerge(MetricsExemplar* into, const MetricsExemplar* from)
+{
+    for (int tries = 0; tries < READ_TRIES; tries++)
+    {
+        uint32_t before = PsAtomicLoad(&from->sequence);
+        if (before & 1)
+            continue;
+        MetricsExemplar copy = *from;
+        PsAtomicFence();
+        if (PsAtomicLoad(&from->sequence) != before)
+            continue;
+        if (copy.atMillis > into->atMillis)
+        {
+            into->atMillis = copy.atMillis;
+            into->value = copy.value;
+            into->run = copy.run;
+        }
+        return;
+    }
+}
+
+uint64_t HistogramQuantile(const Histogram* h, uint32_t perMillion)
+{
+    // The buckets, not count: a recorder may be between its two adds
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < METRICS_BUCKETS; i++)
+        total += h->buckets[i];
+    if (total == 0)
+        return 0;
+    uint64_t rank = (total * perMillion + 999999) / 1000000;
+    if (rank == 0)
+        rank = 1;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < METRICS_BUCKETS; i++)
+    {
+        seen += h->buckets[i];
+        if (seen >= rank)
+            return HistogramHighest(i);
+    }
+    return HistogramHighest(METRICS_BUCKETS - 1);
+}
+
+ExitClass ClassifyRun(RunStatus status, uint32_t exitCode)
+{
+    switch (status)
+    {
+    case RUN_COMPLETED:
+        return exitCode == 0 ? EXIT_CLASS_OK : exitCode < 128 ? EXIT_CLASS_ERROR : EXIT_CLASS_ABNORMAL;
+    case RUN_CANCELLED:
+        return EXIT_CLASS_ABNORMAL;
+    case RUN_UP_TO_DATE:
+    case RUN_CACHED:
+    case RUN_OVERLAP:
+        return EXIT_CLASS_SKIPPED;
+    default:
+        return EXIT_CLASS_FAILED;
+    }
+}
+
+//--------------------------------------------------------------------------
+// THE TABLE
+//--------------------------------------------------------------------------
+// A series must not be keyed on a cut inside a character
+static bool IsContinuation(PSCHAR c)
+{
+    return sizeof(PSCHAR) == 1 ? ((unsigned)c & 0xC0u) == 0x80u
+                               : ((unsigned)c & 0xFC00u) == 0xDC00u;
+}
+
+// UTF-8 series name; a path too long to fit keeps its end after "..."
+static size_t SeriesName(const PSCHAR* script, char* name)
+{
+    size_t len = PsStrLen(script);
+    size_t utf8 = PlatToUtf8(script, len, name, METRICS_NAME_BYTES);
+    if (utf8 > 0 || len == 0)
+        return utf8;
+
+    PsMemCpy(name, "...", 3);
+    size_t keep = METRICS_NAME_BYTES - 3 < len ? METRICS_NAME_BYTES - 3 : len;
+    for (; keep > 0; keep--)
+    {
+        const PSCHAR* tail = script + len - keep;
+        if (IsContinuation(tail[0]))
+            continue;
+        utf8 = PlatToUtf8(tail, keep, name + 3, METRICS_NAME_BYTES - 3);
+        if (utf8 > 0)
+            break;
+    }
+    return 3 + utf8;
+}
+
+// FNV-1a 64 over the name, then the class
+static uint64_t SeriesKey(const char* name, size_t len, ExitClass cls)
+{
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < len; i++)
+        hash = (hash ^ (uint8_t)name[i]) * 0x100000001B3ull;
+    return (hash ^ (uint64_t)cls) * 0x100000001B3ull;
+}
+
+static bool SameSeries(uint64_t key, ExitClass cls, const char* name, size_t len,
+                       uint64_t otherKey, uint32_t otherCls, const char* otherName, size_t otherLen)
+{
+    if (key != otherKey || (uint32_t)cls != otherCls || len != otherLen)
+        return false;
+    for (size_t i = 0; i < len; i++)
+    {
+        if (name[i] != otherName[i])
+            return false;
+    }
+    return true;
+}
+
+bool MetricsOpen(MetricsStore* store, const PSCHAR* path)
+{
+    if (!PlatMapSharedFile(path, METRICS_TABLE_BYTES, &store->shared))
+        return false;
+    store->header = (struct MetricsHeader*)store->shared.base;
+    store->slots = (struct MetricsSlot*)(store->header + 1);
+
+    // FIRST OPEN: A new file is all zeros; everyone racing to set the
+    // header writes the same values, and the magic goes last
+    struct MetricsHeader* h = store->header;
+    if (PsAtomicLoad(&h->magic) == 0)
+    {
+        PsAtomicStore(&h->version, METRICS_VERSION);
+        PsAtomicStore(&h->slotCount, METRICS_SLOTS);
+        PsAtomicStore(&h->bucketCount, METRICS_BUCKETS);
+        PsAtomicStore(&h->slotSize, (uint32_t)sizeof(struct MetricsSlot));
+        PsAtomicCompareExchange(&h->magic, 0, METRICS_MAGIC);
+    }
+    if (PsAtomicLoad(&h->magic) != METRICS_MAGIC || h->version != METRICS_VERSION ||
+        h->slotCount != METRICS_SLOTS || h->bucketCount != METRICS_BUCKETS ||
+        h->slotSize != sizeof(struct MetricsSlot))
+    {
+        MetricsClose(store);
+        return false;
+    }
+    return true;
+}
+
+void MetricsClose(MetricsStore* store)
+{
+    PlatCloseShared(&store->shared);
+    store->header = NULL;
+    store->slots = NULL;
+}
+
+Histogram* MetricsFind(MetricsStore* store, const PSCHAR* script, ExitClass cls, MetricKind kind,
+                       MetricsExemplar** exemplar)
+{
+    char name[METRICS_NAME_BYTES];
+    size_t len = SeriesName(script, name);
+    uint64_t key = SeriesKey(name, len, cls);
+
+    // PROBE: Linear from the key. A slot left mid-claim by a launcher that
+    // died is passed over; the pair then gets a second slot, which the
+    // export merges with the first.
+    for (uint32_t i = 0; i < METRICS_SLOTS; i++)
+    {
+        struct MetricsSlot* slot = &store->slots[(key + i) % METRICS_SLOTS];
+        uint32_t state = PsAtomicLoad(&slot->state);
+        if (state == SLOT_FREE && PsAtomicCompareExchange(&slot->state, SLOT_FREE, SLOT_CLAIMING))
+        {
+            slot->key = key;
+            slot->cls = (uint8_t)cls;
+            slot->nameLen = (uint16_t)len;
+            PsMemCpy(slot->name, name, len);
+            PsAtomicStore(&slot->state, SLOT_READY);
+            if (exemplar)
+                *exemplar = &slot->last[kind];
+            return &slot->hist[kind];
+        }
+        for (int spin = 0; state == SLOT_CLAIMING && spin < CLAIM_SPINS; spin++)
+            state = PsAtomicLoad(&slot->state);
+        if (state == SLOT_READY &&
+            SameSeries(key, cls, name, len, slot->key, slot->cls, slot->name, slot->nameLen))
+        {
+            if (exemplar)
+                *exemplar = &slot->last[kind];
+            return &slot->hist[kind];
+        }
+    }
+    PsAtomicFetchAdd(&store->header->overflow, 1);
+    return NULL;
+}
+
+//--------------------------------------------------------------------------
+// MERGED SETS
+//--------------------------------------------------------------------------
+bool MetricsSetInit(MetricsSet* set, Arena* arena, size_t capacity)
+{
+    set->series = (MetricsSeries*)ArenaAlloc(arena, capacity * sizeof(MetricsSeries));
+    set->order = (uint32_t*)ArenaAlloc(arena, capacity * sizeof(uint32_t));
+    set->count = 0;
+    set->capacity = capacity;
+    return set->series && set->order;
+}
+
+// Output order: by name, then class
+static bool SeriesBefore(const MetricsSeries* a, const MetricsSeries* b)
+{
+    size_t len = a->nameLen < b->nameLen ? a->nameLen : b->nameLen;
+    for (size_t i = 0; i < len; i++)
+    {
+        if (a->name[i] != b->name[i])
+            return (uint8_t)a->name[i] < (uint8_t)b->name[i];
+    }
+    return a->nameLen != b->nameLen ? a->nameLen < b->nameLen : a->cls < b->cls;
+}
+
+static MetricsSeries* FindSeries(MetricsSet* set, const struct MetricsSlot* slot)
+{
+    for (size_t i = 0; i < set->count; i++)
+    {
+        MetricsSeries* s = &set->series[i];
+        if (SameSeries(s->key, s->cls, s->name, s->nameLen, slot->key, slot->cls, slot->name, slot->nameLen))
+            return s;
+    }
+    if (set->count == set->capacity)
+        return NULL;
+
+    MetricsSeries* s = &set->series[set->count];
+    PsMemSet(s, 0, sizeof(*s));
+    s->key = slot->key;
+    s->cls = (ExitClass)slot->cls;
+    s->nameLen = slot->nameLen;
+    PsMemCpy(s->name, slot->name, slot->nameLen);
+
+    size_t at = set->count++;
+    for (; at > 0 && SeriesBefore(s, &set->series[set->order[at - 1]]); at--)
+        set->order[at] = set->order[at - 1];
+    set->order[at] = (uint32_t)(s - set->series);
+    return s;
+}
+
+bool MetricsSetMerge(MetricsSet* set, const void* image, size_t size)
+{
+    const struct MetricsHeader* h = (const struct MetricsHeader*)image;
+    if (size < METRICS_TABLE_BYTES || h->magic != METRICS_MAGIC || h->version != METRICS_VERSION ||
+        h->slotCount != METRICS_SLOTS || h->bucketCount != METRICS_BUCKETS ||
+        h->slotSize != sizeof(struct MetricsSlot))
+        return false;
+
+    const struct MetricsSlot* slots = (const struct MetricsSlot*)(h + 1);
+    for (uint32_t i = 0; i < METRICS_SLOTS; i++)
+    {
+        const struct MetricsSlot* slot = &slots[i];
+        if (PsAtomicLoad(&slot->state) != SLOT_READY || slot->cls >= EXIT_CLASSES ||
+            slot->nameLen > METRICS_NAME_BYTES)
+            continue;
+        MetricsSeries* s = FindSeries(set, slot);
+        if (!s)
+            return false;
+        for (int k = 0; k < METRIC_KINDS; k++)
+        {
+            HistogramMerge(&s->hist[k], &slot->hist[k]);
+            ExemplarMerge(&s->last[k], &slot->last[k]);
+        }
+    }
+    return true;
+}
+
+//--------------------------------------------------------------------------
+// EXPOSITION
+//--------------------------------------------------------------------------
+typedef struct MetricsOut
+{
+    PlatFile file;
+    bool ok;
+    size_t len;
+    char text[4096];
+} MetricsOut;
+
+// The buffer is over a page: from the arena, not the stack
+static MetricsOut* OutBegin(Arena* arena, PlatFile file)
+{
+    MetricsOut* out = (MetricsOut*)ArenaAlloc(arena, sizeof(MetricsOut));
+    if (out)
+    {
+        out->file = file;
+        out->ok = true;
+        out->len = 0;
+    }
+    return out;
+}
+
+static void Flush(MetricsOut* out)
+{
+    if (out->len > 0 && !PlatWriteFile(out->file, out->text, out->len))
+        out->ok = false;
+    out->len = 0;
+}
+
+static void Put(MetricsOut* out, const char* text, size_t len)
+{
+    while (len > 0)
+    {
+        if (out->len == sizeof(out->text))
+            Flush(out);
+        size_t room = sizeof(out->text) - out->len;
+        size_t n = len < room ? len : room;
+        PsMemCpy(out->text + out->len, text, n);
+        out->len += n;
+        text += n;
+        len -= n;
+    }
+}
+
+static void PutLabel(MetricsOut* out, const char* text)
+{
+    Put(out, text, PsStrLen8(text));
+}
+
+static void PutNumber(MetricsOut* out, uint64_t value)
+{
+    char digits[20];
+    size_t n = 0;
+    do
+    {
+        digits[sizeof(digits) - ++n] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    Put(out, digits + sizeof(digits) - n, n);
+}
+
+// Microseconds as seconds, without trailing zeros ("0.0025", "30")
+static void PutSeconds(MetricsOut* out, uint64_t micros)
+{
+    PutNumber(out, micros / 1000000);
+    uint32_t fraction = (uint32_t)(micros % 1000000);
+    if (fraction == 0)
+        return;
+    char digits[7] = { '.' };
+    int last = 0;
+    for (int i = 6; i >= 1; i--, fraction /= 10)
+    {
+        digits[i] = (char)('0' + fraction % 10);
+        if (!last && fraction % 10)
+            last = i;
+    }
+    Put(out, digits, (size_t)last + 1);
+}
+
+// Label values: backslash, quote and newline escaped. JSON additionally
+// escapes the other control characters.
+static void PutEscaped(MetricsOut* out, const char* text, size_t len, bool json)
+{
+    static const char hex[] = "0123456789abcdef";
+    for (size_t i = 0; i < len; i++)
+    {
+        char c = text[i];
+        if (c == '\\' || c == '"')
+        {
+            Put(out, "\\", 1);
+            Put(out, &c, 1);
+        }
+        else if (c == '\n')
+            Put(out, "\\n", 2);
+        else if (json && (uint8_t)c < 0x20)
+        {
+            char u[6] = { '\\', 'u', '0', '0', hex[(uint8_t)c >> 4], hex[c & 15] };
+            Put(out, u, 6);
+        }
+        else
+            Put(out, &c, 1);
+    }
+}
+
+static const char* const g_kindNames[METRIC_KINDS] = {
+    "launch_overhead", "queue_wait", "duration", "interpreter_startup", "script_body", "first_output",
+};
+
+static const char* const g_kindHelp[METRIC_KINDS] = {
+    "Launcher start to script process created",
+    "Run requested to launcher start",
+    "Script process created to exit",
+    "Script process created to its first statement (probed runs)",
+    "First statement to exit (probed runs)",
+    "Script process created to its first output (probed runs)",
+};
+
+// Prometheus bucket bounds in microseconds; +Inf follows
+static const uint64_t g_bounds[] = {
+    1000, 5000, 10000, 50000, 100000, 250000, 500000, 1000000, 2500000,
+    5000000, 10000000, 30000000, 60000000, 300000000, 1800000000,
+};
+
+static const struct { uint32_t perMillion; const char* label; } g_quantiles[] = {
+    { 500000, "0.5" }, { 900000, "0.9" }, { 990000, "0.99" }, { 999000, "0.999" },
+};
+
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+
+static void PutSeriesLabels(MetricsOut* out, const MetricsSeries* s)
+{
+    PutLabel(out, "script=\"");
+    PutEscaped(out, s->name, s->nameLen, false);
+    PutLabel(out, "\",exit=\"");
+    PutLabel(out, g_classNames[s->cls]);
+    Put(out, "\"", 1);
+}
+
+static void PutFamily(MetricsOut* out, const char* kind, const char* suffix, const char* type, const char* help)
+{
+    PutLabel(out, "# HELP ps_launcher_");
+    PutLabel(out, kind);
+    PutLabel(out, suffix);
+    Put(out, " ", 1);
+    PutLabel(out, help);
+    PutLabel(out, "\n# TYPE ps_launcher_");
+    PutLabel(out, kind);
+    PutLabel(out, suffix);
+    Put(out, " ", 1);
+    PutLabel(out, type);
+    Put(out, "\n", 1);
+}
+
+bool MetricsFormatPrometheus(Arena* arena, const MetricsSet* set, PlatFile file)
+{
+    ArenaMark mark = ArenaSave(arena);
+    MetricsOut* out = OutBegin(arena, file);
+    if (!out)
+        return false;
+
+    for (int k = 0; k < METRIC_KINDS; k++)
+    {
+        PutFamily(out, g_kindNames[k], "_seconds", "histogram", g_kindHelp[k]);
+        for (size_t i = 0; i < set->count; i++)
+        {
+            const MetricsSeries* s = &set->series[set->order[i]];
+            const Histogram* h = &s->hist[k];
+            if (h->count == 0)
+                continue;
+
+            // BUCKETS: A bound counts the buckets wholly below it, so no
+            // sample counted under a bound is above it
+            uint64_t below = 0;
+            uint32_t index = 0;
+            for (size_t b = 0; b <= COUNT_OF(g_bounds); b++)
+            {
+                for (; index < METRICS_BUCKETS &&
+                       (b == COUNT_OF(g_bounds) || HistogramHighest(index) <= g_bounds[b]); index++)
+                    below += h->buckets[index];
+                PutLabel(out, "ps_launcher_");
+                PutLabel(out, g_kindNames[k]);
+                PutLabel(out, "_seconds_bucket{");
+                PutSeriesLabels(out, s);
+                PutLabel(out, ",le=\"");
+                if (b == COUNT_OF(g_bounds))
+                    PutLabel(out, "+Inf");
+                else
+                    PutSeconds(out, g_bounds[b]);
+                PutLabel(out, "\"} ");
+                PutNumber(out, below);
+                Put(out, "\n", 1);
+            }
+            PutLabel(out, "ps_launcher_");
+            PutLabel(out, g_kindNames[k]);
+            PutLabel(out, "_seconds_sum{");
+            PutSeriesLabels(out, s);
+            PutLabel(out, "} ");
+            PutSeconds(out, h->sum);
+            PutLabel(out, "\nps_launcher_");
+            PutLabel(out, g_kindNames[k]);
+            PutLabel(out, "_seconds_count{");
+            PutSeriesLabels(out, s);
+            PutLabel(out, "} ");
+            PutNumber(out, below);
+            Put(out, "\n", 1);
+        }
+    }
+
+    // QUANTILES: From the full-resolution buckets, as gauges of their own
+    for (int k = 0; k < METRIC_KINDS; k++)
+    {
+        PutFamily(out, g_kindNames[k], "_quantile_seconds", "gauge", "Quantiles of the histogram above");
+        for (size_t i = 0; i < set->count; i++)
+        {
+            const MetricsSeries* s = &set->series[set->order[i]];
+            if (s->hist[k].count == 0)
+                continue;
+            for (size_t q = 0; q < COUNT_OF(g_quantiles); q++)
+            {
+                PutLabel(out, "ps_launcher_");
+                PutLabel(out, g_kindNames[k]);
+                PutLabel(out, "_quantile_seconds{");
+                PutSeriesLabels(out, s);
+                PutLabel(out, ",quantile=\"");
+                PutLabel(out, g_quantiles[q].label);
+                PutLabel(out, "\"} ");
+                PutSeconds(out, HistogramQuantile(&s->hist[k], g_quantiles[q].perMillion));
+                Put(out, "\n", 1);
+            }
+        }
+    }
+
+    // LATEST: The exemplar's sample only; its run id and time are in the
+    // JSON output (see MetricsFormatPrometheus in metrics.h)
+    for (int k = 0; k < METRIC_KINDS; k++)
+    {
+        PutFamily(out, g_kindNames[k], "_last_seconds", "gauge", "Latest sample");
+        for (size_t i = 0; i < set->count; i++)
+        {
+            const MetricsSeries* s = &set->series[set->order[i]];
+            const MetricsExemplar* x = &s->last[k];
+            if (x->atMillis == 0)
+                continue;
+            PutLabel(out, "ps_launcher_");
+            PutLabel(out, g_kindNames[k]);
+            PutLabel(out, "_last_seconds{");
+            PutSeriesLabels(out, s);
+            PutLabel(out, "} ");
+            PutSeconds(out, x->value);
+            Put(out, "\n", 1);
+        }
+    }
+    Flush(out);
+    bool ok = out->ok;
+    ArenaRestore(arena, mark);
+    return ok;
+}
+
+bool MetricsFormatJson(Arena* arena, const MetricsSet* set, PlatFile file)
+{
+    ArenaMark mark = ArenaSave(arena);
+    MetricsOut* out = OutBegin(arena, file);
+    if (!out)
+        return false;
+
+    PutLabel(out, "{\"unit\":\"us\",\"subBuckets\":");
+    PutNumber(out, METRICS_SUB_COUNT);
+    PutLabel(out, ",\"series\":[");
+    bool first = true;
+    for (size_t i = 0; i < set->count; i++)
+    {
+        const MetricsSeries* s = &set->series[set->order[i]];
+        for (int k = 0; k < METRIC_KINDS; k++)
+        {
+            const Histogram* h = &s->hist[k];
+            if (h->count == 0)
+                continue;
+            PutLabel(out, first ? "\n{\"script\":\"" : ",\n{\"script\":\"");
+            first = false;
+            PutEscaped(out, s->name, s->nameLen, true);
+            PutLabel(out, "\",\"exit\":\"");
+            PutLabel(out, g_classNames[s->cls]);
+            PutLabel(out, "\",\"metric\":\"");
+            PutLabel(out, g_kindNames[k]);
+            PutLabel(out, "\",\"count\":");
+            PutNumber(out, h->count);
+            PutLabel(out, ",\"sum\":");
+            PutNumber(out, h->sum);
+            PutLabel(out, ",\"p50\":");
+            PutNumber(out, HistogramQuantile(h, 500000));
+            PutLabel(out, ",\"p90\":");
+            PutNumber(out, HistogramQuantile(h, 900000));
+            PutLabel(out, ",\"p99\":");
+            PutNumber(out, HistogramQuantile(h, 990000));
+            PutLabel(out, ",\"p999\":");
+            PutNumber(out, HistogramQuantile(h, 999000));
+            PutLabel(out, ",\"max\":");
+            PutNumber(out, HistogramQuantile(h, 1000000));
+
+            // SPARSE: [index, count] for the non-empty buckets only
+            PutLabel(out, ",\"buckets\":[");
+            bool firstBucket = true;
+            for (uint32_t b = 0; b < METRICS_BUCKETS; b++)
+            {
+                if (h->buckets[b] == 0)
+                    continue;
+                PutLabel(out, firstBucket ? "[" : ",[");
+                firstBucket = false;
+                PutNumber(out, b);
+                Put(out, ",", 1);
+                PutNumber(out, h->buckets[b]);
+                Put(out, "]", 1);
+            }
+            PutLabel(out, "]");
+            const MetricsExemplar* x = &s->last[k];
+            if (x->atMillis != 0)
+            {
+                char run[RUN_ID_CHARS + 1];
+                RunIdFormat8(&x->run, run);
+                PutLabel(out, ",\"last\":{\"runId\":\"");
+                PutLabel(out, run);
+                PutLabel(out, "\",\"value\":");
+                PutNumber(out, x->value);
+                PutLabel(out, ",\"at\":");
+                PutNumber(out, x->atMillis);
+                Put(out, "}", 1);
+            }
+            Put(out, "}", 1);
+        }
+    }
+    PutLabel(out, "\n]}\n");
+    Flush(out);
+    bool ok = out->ok;
+    ArenaRestore(arena, mark);
+    return ok;
+}
+
+#ifdef ENABLE_METRICS
+
+static bool MetricsPath(PSCHAR* path)
+{
+    size_t pos;
+    if (!PlatGetStateDirectory(path, PS_MAX_PATH))
+        return false;
+    pos = PsStrLen(path);
+    return AppendChar(path, PS_MAX_PATH, PS_PATH_SEP, &pos) &&
+           AppendStr(path, PS_MAX_PATH, METRICS_FILE_NAME, &pos);
+}
+
+void RecordRunMetrics(const RunRecord* record, const RunTiming* timing)
+{
+    PSCHAR path[PS_MAX_PATH];
+    MetricsStore store;
+    if (!record->script || !MetricsPath(path) || !MetricsOpen(&store, path))
+        return;
+
+    ExitClass cls = ClassifyRun(record->status, record->exitCode);
+    uint64_t now = timing->exitNanos ? timing->exitNanos : PlatMonotonicNanos();
+    uint64_t wall = PlatWallClockMillis();
+    uint64_t values[METRIC_KINDS];
+    bool present[METRIC_KINDS];
+
+    // OVERHEAD: Up to the child's creation, or all of it when there was none
+    values[METRIC_OVERHEAD] = ((timing->spawnNanos ? timing->spawnNanos : now) - timing->startNanos) / 1000;
+    present[METRIC_OVERHEAD] = true;
+    present[METRIC_QUEUE] = timing->queuedNanos && timing->queuedNanos <= timing->startNanos;
+    values[METRIC_QUEUE] = present[METRIC_QUEUE] ? (timing->startNanos - timing->queuedNanos) / 1000 : 0;
+    present[METRIC_DURATION] = timing->spawnNanos && timing->exitNanos;
+    values[METRIC_DURATION] = present[METRIC_DURATION] ? (timing->exitNanos - timing->spawnNanos) / 1000 : 0;
+
+    // PROBED: The first statement splits the duration in two
+    present[METRIC_STARTUP] = timing->spawnNanos && timing->prologueNanos >= timing->spawnNanos;
+    values[METRIC_STARTUP] = present[METRIC_STARTUP] ? (timing->prologueNanos - timing->spawnNanos) / 1000 : 0;
+    present[METRIC_BODY] = present[METRIC_STARTUP] && timing->exitNanos >= timing->prologueNanos;
+    values[METRIC_BODY] = present[METRIC_BODY] ? (timing->exitNanos - timing->prologueNanos) / 1000 : 0;
+    present[METRIC_FIRST_OUTPUT] = timing->spawnNanos && timing->firstOutputNanos >= timing->spawnNanos;
+    values[METRIC_FIRST_OUTPUT] = present[METRIC_FIRST_OUTPUT]
+                                ? (timing->firstOutputNanos - timing->spawnNanos) / 1000 : 0;
+
+    for (int k = 0; k < METRIC_KINDS; k++)
+    {
+        MetricsExemplar* last;
+        Histogram* h = present[k] ? MetricsFind(&store, record->script, cls, (MetricKind)k, &last) : NULL;
+        if (!h)
+            continue;
+        HistogramRecord(h, values[k]);
+        ExemplarRecord(last, &record->id, values[k], wall);
+    }
+    MetricsClose(&store);
+}
+
+uint64_t QueuedSince(void)
+{
+    PSCHAR text[32];
+    if (!PlatGetEnv(METRICS_QUEUED_ENV, text, 32))
+        return 0;
+    uint64_t value = 0;
+    for (const PSCHAR* p = text; *p; p++)
+    {
+        if (*p < PS_T('0') || *p > PS_T('9') || value > (UINT64_MAX - 9) / 10)
+            return 0;
+        value = value * 10 + (uint64_t)(*p - PS_T('0'));
+    }
+    return value;
+}
+
+//--------------------------------------------------------------------------
+// METRICS MODE - ps-launcher -Metrics [-Json] [file...]
+//--------------------------------------------------------------------------
+int ShowMetrics(Arena* arena, int argc, PSCHAR* const* argv)
+{
+    bool json = argc > 0 && PsStrCmpI(argv[0], PS_T("-Json")) == 0;
+    if (json)
+    {
+        argc--;
+        argv++;
+    }
+    MetricsSet set;
+    if (!MetricsSetInit(&set, arena, (size_t)METRICS_SLOTS * (size_t)(argc + 1)))
+        return 1;
+
+    // LOCAL: Missing until something has been recorded, which is no error
+    PSCHAR path[PS_MAX_PATH];
+    size_t size = 0;
+    const void* image = MetricsPath(path) ? PlatMapFile(path, &size) : NULL;
+    if (image)
+    {
+        MetricsSetMerge(&set, image, size);
+        PlatUnmapFile(image, size);
+    }
+
+    int code = 0;
+    for (int i = 0; i < argc; i++)
+    {
+        image = PlatMapFile(argv[i], &size);
+        if (!image || !MetricsSetMerge(&set, image, size))
+            code = 1;
+        if (image)
+            PlatUnmapFile(image, size);
+    }
+
+    bool written = json ? MetricsFormatJson(arena, &set, PlatStandardOutput())
+                        : MetricsFormatPrometheus(arena, &set, PlatStandardOutput());
+    return written ? code : 1;
+}
+
+#endif // ENABLE_METRICS
@@ -0,0 +1,202 @@
+//--------------------------------------------------------------------------
+// RUN METRICS - Duration histograms across runs, per script and exit class
+//--------------------------------------------------------------------------
+// <state directory>/ps-launcher.metrics holds one histogram set per
+// (script, exit class): launch overhead (launcher start to child created),
+// queue wait (run requested to launcher start, when the starter says) and
+// duration (child created to child exit), all in microseconds. Probed
+// launches (probe.h) add interpreter startup (child created to the
+// script's first statement), script body (first statement to exit) and
+// first output (child created to the first byte the script prints).
+//
+// Histograms are log-linear, HDR style: values below 32 us have a bucket
+// each, and every power of two above is split into 16 buckets, so a
+// bucket is at most 1/16 (6.25%) of its values wide, up to 2^37 us (38
+// hours, larger values land in the last bucket). Two histograms merge by
+// adding their buckets.
+//
+// The file is a fixed table mapped into every launcher that records
+// (PlatMapSharedFile), so nothing is read, parsed or rewritten per run:
+// - a (script, class) slot is claimed by compare-and-swap on its state,
+//   probing linearly from the script's hash;
+// - a sample is an atomic add to one bucket, the count and the sum.
+// Concurrent launchers never wait for each other except on the few
+// instructions between a claim and its slot becoming ready.
+//
+// Each histogram also keeps its latest sample with the run it came from
+// (runid.h), an exemplar that leads from a bucket to the journal line.
+// Only the JSON output names the run; see MetricsFormatPrometheus.
+//
+// "ps-launcher -Metrics [-Json] [file...]" merges the local table with any
+// copies from other machines and prints Prometheus text exposition (for
+// node_exporter's textfile collector) or JSON with the non-empty buckets.
+//
+// A starter that queues runs (the submission server) passes when each was
+// asked for in PS_LAUNCHER_QUEUED_NS, a PlatMonotonicNanos reading.
+
+#ifndef PS_METRICS_H
+#define PS_METRICS_H
+
+#include "arena.h"
+#include "config.h"
+#include "platform.h"
+#include "pstypes.h"
+#include "runid.h"
+#include "runrecord.h"
+
+PS_EXTERN_C_BEGIN
+
+#define METRICS_FILE_NAME   PS_T("ps-launcher.metrics")
+#define METRICS_QUEUED_ENV  PS_T("PS_LAUNCHER_QUEUED_NS")
+#define METRICS_SUB_BITS    4
+#define METRICS_SUB_COUNT   (1u << METRICS_SUB_BITS)
+#define METRICS_BUCKETS     544         // 16 exact, then 16 per power of two to 2^37
+#define METRICS_SLOTS       256         // (script, class) pairs per file
+#define METRICS_NAME_BYTES  120         // UTF-8; longer scripts keep their end
+
+typedef enum MetricKind
+{
+    METRIC_OVERHEAD,
+    METRIC_QUEUE,
+    METRIC_DURATION,
+    METRIC_STARTUP,
+    METRIC_BODY,
+    METRIC_FIRST_OUTPUT,
+    METRIC_KINDS
+} MetricKind;
+
+typedef enum ExitClass
+{
+    EXIT_CLASS_OK,         // Exit code 0
+    EXIT_CLASS_ERROR,      // 1 - 127
+    EXIT_CLASS_ABNORMAL,   // 128 and up: signals (POSIX), crashes (Windows)
+    EXIT_CLASS_FAILED,     // The launcher did not start the script
+    EXIT_CLASS_SKIPPED,    // Up to date or served from the result cache
+    EXIT_CLASSES
+} ExitClass;
+
+typedef struct Histogram
+{
+    volatile uint64_t count;
+    volatile uint64_t sum;
+    volatile uint32_t buckets[METRICS_BUCKETS];
+} Histogram;
+
+// The latest sample of a histogram and its run; a writer that finds
+// another inside drops its sample, which is no older than that one
+typedef struct MetricsExemplar
+{
+    volatile uint32_t sequence;    // Odd while being written
+    uint32_t reserved;
+    uint64_t atMillis;             // Wall clock; 0: no sample yet
+    uint64_t value;
+    RunId run;
+} MetricsExemplar;
+
+// Timestamps of one launch (PlatMonotonicNanos); 0 where it did not happen
+typedef struct RunTiming
+{
+    uint64_t startNanos;       // The launcher started
+    uint64_t queuedNanos;      // The run was asked for (PS_LAUNCHER_QUEUED_NS)
+    uint64_t spawnNanos;       // The child was created
+    uint64_t exitNanos;        // The child exited
+    uint64_t prologueNanos;    // The script's first statement ran (probe.h)
+    uint64_t firstOutputNanos; // The script's first output arrived (probe.h)
+} RunTiming;
+
+struct MetricsHeader;
+struct MetricsSlot;
+
+typedef struct MetricsStore
+{
+    PlatShared shared;
+    struct MetricsHeader* header;
+    struct MetricsSlot* slots;
+} MetricsStore;
+
+// Bucket of a value, and the smallest and largest value a bucket holds
+uint32_t HistogramIndex(uint64_t value);
+uint64_t HistogramLowest(uint32_t index);
+uint64_t HistogramHighest(uint32_t index);
+
+// Safe from any number of threads and processes at once
+void HistogramRecord(Histogram* h, uint64_t value);
+
+// Not atomic: into must be private to the caller
+void HistogramMerge(Histogram* into, const Histogram* from);
+
+// Safe from any number of threads and processes at once
+void ExemplarRecord(MetricsExemplar* x, const RunId* run, uint64_t value, uint64_t atMillis);
+
+// A settled copy of from, kept in into if it is later; not atomic on into
+void ExemplarMerge(MetricsExemplar* into, const MetricsExemplar* from);
+
+// Highest value of the bucket holding the sample at perMillion of the
+// count (990000 = p99); 0 for an empty histogram
+uint64_t HistogramQuantile(const Histogram* h, uint32_t perMillion);
+
+ExitClass ClassifyRun(RunStatus status, uint32_t exitCode);
+
+// Map the table at path, creating it if needed
+bool MetricsOpen(MetricsStore* store, const PSCHAR* path);
+void MetricsClose(MetricsStore* store);
+
+// The histogram for (script, class, kind), claiming a slot for a new
+// pair; NULL once every slot is taken. exemplar (may be NULL) receives
+// the histogram's exemplar.
+Histogram* MetricsFind(MetricsStore* store, const PSCHAR* script, ExitClass cls, MetricKind kind,
+                       MetricsExemplar** exemplar);
+
+// One (script, class) of a merged view, private to the reader
+typedef struct MetricsSeries
+{
+    uint64_t key;
+    ExitClass cls;
+    uint16_t nameLen;
+    char name[METRICS_NAME_BYTES];
+    Histogram hist[METRIC_KINDS];
+    MetricsExemplar last[METRIC_KINDS];
+} MetricsSeries;
+
+typedef struct MetricsSet
+{
+    MetricsSeries* series;
+    uint32_t* order;               // Indexes into series by name, then class
+    size_t count;
+    size_t capacity;
+} MetricsSet;
+
+bool MetricsSetInit(MetricsSet* set, Arena* arena, size_t capacity);
+
+// Add a table image (a mapped metrics file) to the set, series by series;
+// false if the image is not a metrics table of this layout or the set is
+// full
+bool MetricsSetMerge(MetricsSet* set, const void* image, size_t size);
+
+// Text exposition of a set into out: Prometheus or JSON. The output
+// buffer is scratch space in arena. The Prometheus text has no sample
+// timestamps and no run id label, which node_exporter's textfile
+// collector rejects and which would add a series per run.
+bool MetricsFormatPrometheus(Arena* arena, const MetricsSet* set, PlatFile out);
+bool MetricsFormatJson(Arena* arena, const MetricsSet* set, PlatFile out);
+
+#ifdef ENABLE_METRICS
+
+// Add one launch to <state directory>/ps-launcher.metrics (best-effort)
+void RecordRunMetrics(const RunRecord* record, const RunTiming* timing);
+
+// When this launch was asked for: PS_LAUNCHER_QUEUED_NS, or 0
+uint64_t QueuedSince(void);
+
+// -Metrics: merged histograms on stdout. Returns 0, or 1 if a file given
+// is missing or not a metrics table.
+int ShowMetrics(Arena* arena, int argc, PSCHAR* const* argv);
+
+#else
+    #define RecordRunMetrics(record, timing) ((void)0)
+    #define QueuedSince() ((uint64_t)0)
+#endif
+
+PS_EXTERN_C_END
+
+#endif // PS_METRICS_H
@@ -0,0 +1,264 @@
+//--------------------------------------------------------------------------
+// EMBEDDED PAYLOAD - Compressed scripts carried inside the executable
+//--------------------------------------------------------------------------
+#include "payload.h"
+#include "encoding.h"
+#include "log.h"
+#include "lz.h"
+#include "platform.h"
+#include "psmem.h"
+#include "psstr.h"
+
+#define PAYLOAD_HEADER_SIZE 8    // Magic + count
+#define ENTRY_FIXED_SIZE   14    // nameLen + rawSize + packedSize + checksum
+
+static uint32_t Fnv1a32(const uint8_t* p, size_t n)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; i++)
+        h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+static inline char FoldAscii(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+}
+
+static inline uint32_t Get32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint8_t* Put32(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+    return p + 4;
+}
+
+//--------------------------------------------------------------------------
+// READING
+//--------------------------------------------------------------------------
+// Parse the entry at *pos; advances *pos past it
+static bool ReadEntry(const uint8_t* base, size_t size, size_t* pos, PayloadScript* out)
+{
+    size_t p = *pos;
+    if (size - p < 2)
+        return false;
+    size_t nameLen = (size_t)base[p] | ((size_t)base[p + 1] << 8);
+    p += 2;
+    if (nameLen == 0 || size - p < nameLen + 12)
+        return false;
+
+    out->name = (const char*)base + p;
+    out->nameLen = nameLen;
+    p += nameLen;
+    out->rawSize = Get32(base + p);
+    out->packedSize = Get32(base + p + 4);
+    out->checksum = Get32(base + p + 8);
+    p += 12;
+
+    if (out->packedSize > size - p || out->rawSize > PAYLOAD_MAX_SCRIPT_SIZE)
+        return false;
+    out->packed = base + p;
+    *pos = p + out->packedSize;
+    return true;
+}
+
+int PayloadCount(const void* payload, size_t size)
+{
+    const uint8_t* base = (const uint8_t*)payload;
+    if (!payload || size < PAYLOAD_HEADER_SIZE ||
+        base[0] != 'P' || base[1] != 'S' || base[2] != 'P' || base[3] != 'K')
+        return -1;
+
+    uint32_t count = Get32(base + 4);
+    if (count > PAYLOAD_MAX_SCRIPTS)
+        return -1;
+
+    // VALIDATION: Walk every entry once so later lookups can trust the framing
+    size_t pos = PAYLOAD_HEADER_SIZE;
+    PayloadScript entry;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (!ReadEntry(base, size, &pos, &entry))
+            return -1;
+    }
+    return (int)count;
+}
+
+bool PayloadGet(const void* payload, size_t size, int index, PayloadScript* out)
+{
+    int count = PayloadCount(payload, size);
+    if (index < 0 || index >= count)
+        return false;
+
+    size_t pos = PAYLOAD_HEADER_SIZE;
+    for (int i = 0; i <= index; i++)
+    {
+        if (!ReadEntry((const uint8_t*)payload, size, &pos, out))
+            return false;
+    }
+    return true;
+}
+
+int PayloadFind(const void* payload, size_t size, const char* name, size_t nameLen)
+{
+    int count = PayloadCount(payload, size);
+    size_t pos = PAYLOAD_HEADER_SIZE;
+    PayloadScript entry;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (!ReadEntry((const uint8_t*)payload, size, &pos, &entry))
+            return -1;
+        if (entry.nameLen != nameLen)
+            continue;
+
+        size_t j = 0;
+        while (j < nameLen && FoldAscii(entry.name[j]) == FoldAscii(name[j]))
+            j++;
+        if (j == nameLen)
+            return i;
+    }
+    return -1;
+}
+
+uint8_t* PayloadExtract(Arena* arena, const PayloadScript* script)
+{
+    // One spare byte so a zero-length script still gets a valid pointer
+    uint8_t* raw = (uint8_t*)ArenaAlloc(arena, (size_t)script->rawSize + 1);
+    if (!raw)
+        return NULL;
+
+    // INTEGRITY CHECK: A damaged payload must never run a partial script
+    if (!LzDecompress(script->packed, script->packedSize, raw, script->rawSize) ||
+        Fnv1a32(raw, script->rawSize) != script->checksum)
+        return NULL;
+    return raw;
+}
+
+PSCHAR* PayloadScriptName(Arena* arena, const PayloadScript* script)
+{
+    PSCHAR* name = (PSCHAR*)ArenaAlloc(arena, (script->nameLen + 1) * sizeof(PSCHAR));
+    if (!name)
+        return NULL;
+#ifdef _WIN32
+    size_t n = Utf8ToUtf16(script->name, script->nameLen, (uint16_t*)name, script->nameLen);
+#else
+    PsMemCpy(name, script->name, script->nameLen);
+    size_t n = script->nameLen;
+#endif
+    name[n] = 0;
+    return name;
+}
+
+//--------------------------------------------------------------------------
+// WRITING
+//--------------------------------------------------------------------------
+void* PayloadBuild(Arena* arena, const PayloadSource* sources, int count, size_t* outSize)
+{
+    if (count < 0 || count > PAYLOAD_MAX_SCRIPTS)
+        return NULL;
+
+    // Worst case for every script, so the payload is one block
+    size_t capacity = PAYLOAD_HEADER_SIZE;
+    for (int i = 0; i < count; i++)
+    {
+        if (sources[i].nameLen == 0 || sources[i].nameLen > 0xFFFF ||
+            sources[i].size > PAYLOAD_MAX_SCRIPT_SIZE)
+            return NULL;
+        capacity += ENTRY_FIXED_SIZE + sources[i].nameLen + LZ_COMPRESS_BOUND(sources[i].size);
+    }
+
+    uint8_t* payload = (uint8_t*)ArenaAlloc(arena, capacity);
+    void* workspace = ArenaAlloc(arena, LZ_WORKSPACE_SIZE);
+    if (!payload || !workspace)
+        return NULL;
+
+    uint8_t* p = payload;
+    *p++ = 'P';
+    *p++ = 'S';
+    *p++ = 'P';
+    *p++ = 'K';
+    p = Put32(p, (uint32_t)count);
+
+    for (int i = 0; i < count; i++)
+    {
+        const PayloadSource* s = &sources[i];
+        *p++ = (uint8_t)s->nameLen;
+        *p++ = (uint8_t)(s->nameLen >> 8);
+        PsMemCpy(p, s->name, s->nameLen);
+        p += s->nameLen;
+
+        uint8_t* sizes = p;
+        p += 12;
+        size_t packed = LzCompress(s->data, s->size, p, LZ_COMPRESS_BOUND(s->size), workspace);
+        if (packed == 0)
+            return NULL;
+
+        sizes = Put32(sizes, (uint32_t)s->size);
+        sizes = Put32(sizes, (uint32_t)packed);
+        Put32(sizes, Fnv1a32((const uint8_t*)s->data, s->size));
+        p += packed;
+    }
+
+    *outSize = (size_t)(p - payload);
+    return payload;
+}
+
+bool PackScripts(Arena* arena, const PSCHAR* output, PSCHAR* const* scripts, int count)
+{
+    if (count <= 0 || count > PAYLOAD_MAX_SCRIPTS)
+        return false;
+
+    PayloadSource* sources = (PayloadSource*)ArenaAlloc(arena, sizeof(PayloadSource) * (size_t)count);
+    if (!sources)
+        return false;
+
+    size_t totalRaw = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const PSCHAR* path = scripts[i];
+        const PSCHAR* base = path;
+        for (const PSCHAR* c = path; *c; c++)
+        {
+            if (*c == PS_T('/') || *c == PS_PATH_SEP)
+                base = c + 1;
+        }
+
+        size_t baseLen = PsStrLen(base);
+        char* name = (char*)ArenaAlloc(arena, baseLen * 3 + 1);
+        size_t nameLen = name ? PlatToUtf8(base, baseLen, name, baseLen * 3) : 0;
+        sources[i].data = ArenaReadFile(arena, path, PAYLOAD_MAX_SCRIPT_SIZE, &sources[i].size);
+        if (nameLen == 0 || !sources[i].data)
+        {
+            LogFormat(PS_T("ERROR: Cannot read script: %s"), path);
+            return false;
+        }
+        sources[i].name = name;
+        sources[i].nameLen = nameLen;
+        totalRaw += sources[i].size;
+        LogFormat(PS_T("Packing script: %s"), path);
+    }
+
+    size_t size = 0;
+    void* payload = PayloadBuild(arena, sources, count, &size);
+    if (!payload)
+    {
+        LogWrite(PS_T("ERROR: Failed to build payload"));
+        return false;
+    }
+    LogNumber(PS_T("Script bytes: "), totalRaw);
+    LogNumber(PS_T("Payload bytes: "), size);
+
+    if (!PlatCopySelf(output) || !PlatEmbedPayload(output, payload, size))
+    {
+        LogFormat(PS_T("ERROR: Cannot write packed launcher: %s"), output);
+        return false;
+    }
+    return true;
+}
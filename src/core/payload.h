@@ -0,0 +1,73 @@
+//--------------------------------------------------------------------------
+// EMBEDDED PAYLOAD - Compressed scripts carried inside the executable
+//--------------------------------------------------------------------------
+// "ps-launcher -Pack <output> <script>..." writes a copy of the launcher
+// with the scripts attached (PlatEmbedPayload: an RCDATA resource on
+// Windows, an appended block on POSIX). A packed launcher runs its scripts
+// without touching the file system: the script is decompressed into the
+// arena and written to the interpreter's stdin (see BuildEmbeddedCommandLine).
+//
+// Layout, all integers little-endian:
+//   "PSPK"  u32 count
+//   count x { u16 nameLen, name (UTF-8), u32 rawSize, u32 packedSize,
+//             u32 checksum (FNV-1a of the raw script), packed bytes (lz.h) }
+// The payload is untrusted input as far as parsing goes: every field is
+// bounds-checked and a checksum mismatch rejects the script.
+
+#ifndef PS_PAYLOAD_H
+#define PS_PAYLOAD_H
+
+#include "arena.h"
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+#define PAYLOAD_MAX_SCRIPTS 256
+#define PAYLOAD_MAX_SCRIPT_SIZE ((size_t)16 << 20)   // 16MB per script
+
+// One script inside a payload; pointers refer into the payload
+typedef struct PayloadScript
+{
+    const char* name;            // UTF-8, not terminated
+    size_t nameLen;
+    const uint8_t* packed;
+    uint32_t packedSize;
+    uint32_t rawSize;
+    uint32_t checksum;
+} PayloadScript;
+
+// Number of scripts, or -1 if the payload is malformed
+int PayloadCount(const void* payload, size_t size);
+
+bool PayloadGet(const void* payload, size_t size, int index, PayloadScript* out);
+
+// Index of the script called name (ASCII case-insensitive), or -1
+int PayloadFind(const void* payload, size_t size, const char* name, size_t nameLen);
+
+// Decompress and verify a script into the arena (rawSize bytes)
+// Returns NULL if the data is corrupt or the arena is exhausted.
+uint8_t* PayloadExtract(Arena* arena, const PayloadScript* script);
+
+// Terminated PSCHAR copy of the script's name
+PSCHAR* PayloadScriptName(Arena* arena, const PayloadScript* script);
+
+// Input for PayloadBuild
+typedef struct PayloadSource
+{
+    const char* name;            // UTF-8
+    size_t nameLen;
+    const void* data;
+    size_t size;
+} PayloadSource;
+
+// Compress the sources into a new payload in the arena
+// Returns NULL if a source is too large or the arena is exhausted.
+void* PayloadBuild(Arena* arena, const PayloadSource* sources, int count, size_t* outSize);
+
+// Pack mode: read the scripts, copy this executable to output and attach
+// them. Script names are the file names without their directories.
+bool PackScripts(Arena* arena, const PSCHAR* output, PSCHAR* const* scripts, int count);
+
+PS_EXTERN_C_END
+
+#endif // PS_PAYLOAD_H
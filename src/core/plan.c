@@ -0,0 +1,250 @@
+//--------------------------------------------------------------------------
+// BATCH PLAN - Which ready job of a batch or dependency graph goes next
+//--------------------------------------------------------------------------
+#include "plan.h"
+#include "psmem.h"
+
+//--------------------------------------------------------------------------
+// READY HEAP
+//--------------------------------------------------------------------------
+// Higher rank first; the earlier job in the batch on a tie
+static bool Before(const PlanGraph* g, uint32_t a, uint32_t b)
+{
+    return g->rank[a] != g->rank[b] ? g->rank[a] > g->rank[b] : a < b;
+}
+
+static void Push(PlanGraph* g, uint32_t job)
+{
+    uint32_t i = g->ready++;
+    while (i > 0)
+    {
+        uint32_t parent = (i - 1) / 2;
+        if (!Before(g, job, g->heap[parent]))
+            break;
+        g->heap[i] = g->heap[parent];
+        i = parent;
+    }
+    g->heap[i] = job;
+}
+
+bool PlanNext(PlanGraph* graph, uint32_t* job)
+{
+    PlanGraph* g = graph;
+    if (g->ready == 0)
+        return false;
+    *job = g->heap[0];
+    uint32_t last = g->heap[--g->ready];
+    uint32_t i = 0;
+    for (;;)
+    {
+        uint32_t child = 2 * i + 1;
+        if (child >= g->ready)
+            break;
+        if (child + 1 < g->ready && Before(g, g->heap[child + 1], g->heap[child]))
+            child++;
+        if (!Before(g, g->heap[child], last))
+            break;
+        g->heap[i] = g->heap[child];
+        i = child;
+    }
+    g->heap[i] = last;
+    return true;
+}
+
+//--------------------------------------------------------------------------
+// GRAPH
+//--------------------------------------------------------------------------
+PlanStatus PlanBuild(PlanGraph* graph, Arena* arena, const PlanJob* jobs, uint32_t count, bool byRank)
+{
+    PlanGraph* g = graph;
+    PsMemSet(g, 0, sizeof(*g));
+    uint64_t edges = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        for (uint32_t k = 0; k < jobs[i].afterCount; k++)
+        {
+            if (jobs[i].after[k] >= count || jobs[i].after[k] == i)
+                return PLAN_BAD_GRAPH;
+        }
+        edges += jobs[i].afterCount;
+    }
+    if (edges > UINT32_MAX)
+        return PLAN_BAD_GRAPH;
+
+    g->successorStart = (uint32_t*)ArenaAlloc(arena, ((size_t)count + 1) * sizeof(uint32_t));
+    g->successors = (uint32_t*)ArenaAlloc(arena, (edges ? (size_t)edges : 1) * sizeof(uint32_t));
+    g->waiting = (uint32_t*)ArenaAlloc(arena, (count ? count : 1) * sizeof(uint32_t));
+    g->rank = (uint64_t*)ArenaAlloc(arena, (count ? count : 1) * sizeof(uint64_t));
+    g->skipped = (uint8_t*)ArenaAlloc(arena, count ? count : 1);
+    g->heap = (uint32_t*)ArenaAlloc(arena, (count ? count : 1) * sizeof(uint32_t));
+    g->stack = (uint32_t*)ArenaAlloc(arena, (count ? count : 1) * sizeof(uint32_t));
+    if (!g->successorStart || !g->successors || !g->waiting || !g->rank || !g->skipped || !g->heap || !g->stack)
+        return PLAN_NO_MEMORY;
+    g->count = count;
+    g->open = count;
+    PsMemSet(g->successorStart, 0, ((size_t)count + 1) * sizeof(uint32_t));
+    PsMemSet(g->rank, 0, count * sizeof(uint64_t));
+    PsMemSet(g->skipped, 0, count);
+
+    // SUCCESSORS: Prerequisite lists turned around, packed per job. The
+    // heap holds each job's fill position meanwhile.
+    for (uint32_t i = 0; i < count; i++)
+    {
+        g->waiting[i] = jobs[i].afterCount;
+        for (uint32_t k = 0; k < jobs[i].afterCount; k++)
+            g->successorStart[jobs[i].after[k] + 1]++;
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        g->successorStart[i + 1] += g->successorStart[i];
+        g->heap[i] = g->successorStart[i];
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        for (uint32_t k = 0; k < jobs[i].afterCount; k++)
+            g->successors[g->heap[jobs[i].after[k]]++] = i;
+    }
+
+    // TOPOLOGICAL ORDER: Into the stack, with the heap counting down each
+    // job's unfinished prerequisites; a cycle leaves jobs out
+    uint32_t* order = g->stack;
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        g->heap[i] = g->waiting[i];
+        if (g->heap[i] == 0)
+            order[n++] = i;
+    }
+    for (uint32_t h = 0; h < n; h++)
+    {
+        uint32_t v = order[h];
+        for (uint32_t s = g->successorStart[v]; s < g->successorStart[v + 1]; s++)
+        {
+            if (--g->heap[g->successors[s]] == 0)
+                order[n++] = g->successors[s];
+        }
+    }
+    if (n < count)
+        return PLAN_BAD_GRAPH;
+
+    // CRITICAL PATH: A job's own time plus the longest chain after it,
+    // successors first
+    if (byRank)
+    {
+        for (uint32_t h = n; h > 0; h--)
+        {
+            uint32_t v = order[h - 1];
+            uint64_t longest = 0;
+            for (uint32_t s = g->successorStart[v]; s < g->successorStart[v + 1]; s++)
+            {
+                if (g->rank[g->successors[s]] > longest)
+                    longest = g->rank[g->successors[s]];
+            }
+            g->rank[v] = jobs[v].micros + longest;
+        }
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (g->waiting[i] == 0)
+            Push(g, i);
+    }
+    return PLAN_OK;
+}
+
+void PlanDone(PlanGraph* graph, uint32_t job, bool succeeded)
+{
+    PlanGraph* g = graph;
+    g->open--;
+    if (succeeded)
+    {
+        for (uint32_t s = g->successorStart[job]; s < g->successorStart[job + 1]; s++)
+        {
+            uint32_t next = g->successors[s];
+            if (--g->waiting[next] == 0 && !g->skipped[next])
+                Push(g, next);
+        }
+        return;
+    }
+
+    // FAILED: Everything downstream, each job once
+    uint32_t depth = 0;
+    g->stack[depth++] = job;
+    while (depth > 0)
+    {
+        uint32_t v = g->stack[--depth];
+        for (uint32_t s = g->successorStart[v]; s < g->successorStart[v + 1]; s++)
+        {
+            uint32_t next = g->successors[s];
+            if (g->skipped[next])
+                continue;
+            g->skipped[next] = 1;
+            g->open--;
+            g->stack[depth++] = next;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------
+// SIMULATION
+//--------------------------------------------------------------------------
+typedef struct Running
+{
+    uint64_t finish;
+    uint32_t job;
+} Running;
+
+bool PlanSimulate(Arena* arena, const PlanJob* jobs, uint32_t count, uint32_t slots, bool byRank,
+                  uint64_t* makespan)
+{
+    ArenaMark mark = ArenaSave(arena);
+    PlanGraph g;
+    Running* running = (Running*)ArenaAlloc(arena, (slots ? slots : 1) * sizeof(Running));
+    if (slots == 0 || !running || PlanBuild(&g, arena, jobs, count, byRank) != PLAN_OK)
+    {
+        ArenaRestore(arena, mark);
+        return false;
+    }
+
+    // Events in time order: a min-heap of finishing runs
+    uint32_t busy = 0;
+    uint64_t now = 0;
+    for (;;)
+    {
+        uint32_t job;
+        while (busy < slots && PlanNext(&g, &job))
+        {
+            Running r = { now + jobs[job].micros, job };
+            uint32_t i = busy++;
+            while (i > 0 && running[(i - 1) / 2].finish > r.finish)
+            {
+                running[i] = running[(i - 1) / 2];
+                i = (i - 1) / 2;
+            }
+            running[i] = r;
+        }
+        if (busy == 0)
+            break;
+
+        Running first = running[0], last = running[--busy];
+        uint32_t i = 0;
+        for (;;)
+        {
+            uint32_t child = 2 * i + 1;
+            if (child >= busy)
+                break;
+            if (child + 1 < busy && running[child + 1].finish < running[child].finish)
+                child++;
+            if (running[child].finish >= last.finish)
+                break;
+            running[i] = running[child];
+            i = child;
+        }
+        running[i] = last;
+        now = first.finish;
+        PlanDone(&g, first.job, true);
+    }
+    *makespan = now;
+    ArenaRestore(arena, mark);
+    return true;
+}
@@ -0,0 +1,76 @@
+//--------------------------------------------------------------------------
+// BATCH PLAN - Which ready job of a batch or dependency graph goes next
+//--------------------------------------------------------------------------
+// Started in the order given, a batch of a few ten-minute scripts among
+// many five-second ones ends with a long script running alone. Ranked by
+// expected duration (history.h), the long ones start first and the short
+// ones fill in around them: longest processing time first (LPT). With
+// dependencies a job's rank is the longest chain of expected durations
+// from its start to the end of the graph - its critical path - so a short
+// job that gates a long chain goes before a long job that gates nothing.
+// Without dependencies the two are the same thing.
+//
+// Ready jobs wait in a binary heap on rank, then position in the batch:
+// O(log n) a start, and equal ranks - every rank, without history or
+// when ranking is off - keep the batch's own order, which is FIFO.
+//
+// A job that fails takes every job after it (transitively) with it; they
+// are skipped, never made ready. PlanSimulate replays a batch on a number
+// of slots with known durations, for the makespan of an order without
+// running anything.
+
+#ifndef PS_PLAN_H
+#define PS_PLAN_H
+
+#include "arena.h"
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+typedef struct PlanJob
+{
+    uint64_t micros;                 // Expected duration
+    const uint32_t* after;           // Jobs that must finish first, by index
+    uint32_t afterCount;
+} PlanJob;
+
+typedef enum PlanStatus
+{
+    PLAN_OK = 0,
+    PLAN_NO_MEMORY,
+    PLAN_BAD_GRAPH                   // An index out of range, or a cycle
+} PlanStatus;
+
+typedef struct PlanGraph
+{
+    uint32_t count;
+    uint32_t open;                   // Neither finished nor skipped
+    uint32_t* successorStart;        // count + 1 offsets into successors
+    uint32_t* successors;
+    uint32_t* waiting;               // Unfinished prerequisites per job
+    uint64_t* rank;                  // Critical path; all 0 when not ranked
+    uint8_t* skipped;
+    uint32_t* heap;                  // Ready jobs
+    uint32_t ready;
+    uint32_t* stack;                 // For skipping
+} PlanGraph;
+
+// Build the graph on arena, ranked by critical path or (byRank false) in
+// batch order
+PlanStatus PlanBuild(PlanGraph* graph, Arena* arena, const PlanJob* jobs, uint32_t count, bool byRank);
+
+// Take the next ready job, highest rank first; false when none is ready
+bool PlanNext(PlanGraph* graph, uint32_t* job);
+
+// job finished: jobs that waited only for it become ready, or, when it
+// failed, everything after it is skipped
+void PlanDone(PlanGraph* graph, uint32_t job, bool succeeded);
+
+// Makespan of the batch on slots runners, each job taking exactly its
+// micros. False if the graph cannot be built.
+bool PlanSimulate(Arena* arena, const PlanJob* jobs, uint32_t count, uint32_t slots, bool byRank,
+                  uint64_t* makespan);
+
+PS_EXTERN_C_END
+
+#endif // PS_PLAN_H
@@ -0,0 +1,36 @@
+//--------------------------------------------------------------------------
+// PARAMETER POLICY - Security filtering of script parameters
+//--------------------------------------------------------------------------
+#include "policy.h"
+#include "psmem.h"
+#include "psstr.h"
+
+PolicyResult CheckParameterPolicy(const PSCHAR* param)
+{
+    // SECURITY CHECK: Prevent command injection
+    if (PsStrChr(param, PS_T(';')) != NULL)
+        return POLICY_SEMICOLON;
+    return POLICY_OK;
+}
+
+PolicyResult CheckParameterPolicyN(const PSCHAR* param, size_t len)
+{
+#ifdef _WIN32
+    if (PsMemChr16((const uint16_t*)param, (uint16_t)PS_T(';'), len) != NULL)
+#else
+    if (PsMemChr(param, PS_T(';'), len) != NULL)
+#endif
+        return POLICY_SEMICOLON;
+    return POLICY_OK;
+}
+
+const PSCHAR* PolicyResultText(PolicyResult result)
+{
+    switch (result)
+    {
+    case POLICY_SEMICOLON:
+        return PS_T("Semicolon detected in parameter (security block)");
+    default:
+        return PS_T("Parameter accepted");
+    }
+}
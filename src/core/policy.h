@@ -0,0 +1,28 @@
+//--------------------------------------------------------------------------
+// PARAMETER POLICY - Security filtering of script parameters
+//--------------------------------------------------------------------------
+#ifndef PS_POLICY_H
+#define PS_POLICY_H
+
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+typedef enum PolicyResult
+{
+    POLICY_OK = 0,
+    POLICY_SEMICOLON      // Command injection attempt - parameter rejected
+} PolicyResult;
+
+// Check one script parameter against the launcher's security rules
+PolicyResult CheckParameterPolicy(const PSCHAR* param);
+
+// Same, for a parameter whose length is already known
+PolicyResult CheckParameterPolicyN(const PSCHAR* param, size_t len);
+
+// Human-readable reason for a rejected parameter (for the log)
+const PSCHAR* PolicyResultText(PolicyResult result);
+
+PS_EXTERN_C_END
+
+#endif // PS_POLICY_H
@@ -0,0 +1,109 @@
+//--------------------------------------------------------------------------
+// STARTUP PROBE - Where a run's time goes before the script does anything
+//--------------------------------------------------------------------------
+#include "probe.h"
+#include "status.h"
+
+bool ProbeRequested(void)
+{
+    PSCHAR value[8];
+    return PlatGetEnv(PROBE_ENV, value, 8) && value[0] != 0;
+}
+
+void ProbeFeed(ProbeScan* scan, const char* data, size_t size, ProbeChunk* chunk)
+{
+    chunk->held = 0;
+    chunk->start = 0;
+    chunk->prologue = false;
+    if (scan->done)
+        return;
+
+    size_t i = 0;
+    while (i < size && scan->matched < PROBE_MARKER_LEN && data[i] == PROBE_MARKER[scan->matched])
+    {
+        i++;
+        scan->matched++;
+    }
+    if (scan->matched == PROBE_MARKER_LEN)
+    {
+        scan->done = true;
+        chunk->prologue = true;
+        chunk->start = i;
+    }
+    else if (i < size)
+    {
+        // MISMATCH: What looked like the marker was output after all
+        scan->done = true;
+        chunk->held = scan->matched - (uint32_t)i;
+        chunk->start = 0;
+    }
+    else
+    {
+        chunk->start = size;            // All marker so far; hold it
+    }
+}
+
+// Relay one chunk; the first byte relayed is the first output
+static void Relay(PlatFile out, const char* data, size_t size, RunTiming* timing)
+{
+    if (size == 0)
+        return;
+    if (!timing->firstOutputNanos)
+        timing->firstOutputNanos = PlatMonotonicNanos();
+    PlatWriteFile(out, data, size);         // Best-effort, like the child's own stdout
+}
+
+bool ProbeRelay(PlatProcess* proc, PlatFile pipe, PlatFile out, RunTiming* timing, uint32_t* exitCode)
+{
+    char buffer[PROBE_CHUNK];
+    ProbeScan scan = { 0, false };
+    ProbeChunk chunk;
+    uint64_t outputBytes = 0;
+    uint64_t nextProgress = PlatMonotonicNanos() + (uint64_t)STATUS_REFRESH_MS * 1000000;
+    bool open = true, exited = false, lost = false;
+
+    while (open || !exited)
+    {
+        // DRAINED: Only a read after the exit was seen can be the last
+        bool drained = exited;
+        size_t got = 0;
+        if (open)
+        {
+            open = PlatReadAvailable(pipe, buffer, sizeof(buffer), &got);
+            ProbeFeed(&scan, buffer, got, &chunk);
+            if (chunk.prologue)
+                timing->prologueNanos = PlatMonotonicNanos();
+            Relay(out, PROBE_MARKER, chunk.held, timing);
+            Relay(out, buffer + chunk.start, got - chunk.start, timing);
+            outputBytes += got;
+        }
+        if (!exited)
+        {
+            PlatChildState state = PlatWaitTimeout(proc, 0, exitCode);
+            exited = state != PLAT_CHILD_RUNNING;
+            lost = state == PLAT_CHILD_LOST;
+            timing->exitNanos = state == PLAT_CHILD_EXITED ? PlatMonotonicNanos() : 0;
+        }
+
+        // A grandchild still holding the pipe loses the rest
+        if (drained && got == 0)
+            open = false;
+        if (got > 0 || (!open && exited))
+            continue;
+
+        uint64_t now = PlatMonotonicNanos();
+        if (now >= nextProgress)
+        {
+            uint64_t cpuMicros = 0;
+            PlatProcessCpuMicros(proc, &cpuMicros);
+            StatusProgress(cpuMicros, outputBytes);
+            nextProgress = now + (uint64_t)STATUS_REFRESH_MS * 1000000;
+        }
+        PlatWaitOutput(&pipe, open ? 1 : 0, proc, exited ? 0 : 1, STATUS_REFRESH_MS);
+    }
+
+    // A stream that ended inside what looked like the marker
+    if (!scan.done)
+        Relay(out, PROBE_MARKER, scan.matched, timing);
+    return !lost;
+}
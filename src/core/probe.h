@@ -0,0 +1,64 @@
+//--------------------------------------------------------------------------
+// STARTUP PROBE - Where a run's time goes before the script does anything
+//--------------------------------------------------------------------------
+// With PS_LAUNCHER_PROBE set (to anything), a launch measures three points
+// after the child is created, all on the launcher's own clock:
+// - prologue: the interpreter reached the first statement. The script runs
+//   through a -EncodedCommand wrapper (PS_PROBE_PROLOGUE, cmdline.h) whose
+//   first statement prints PROBE_MARKER; its arrival stamps the moment.
+// - first output: the first byte of what the script itself prints.
+// - exit.
+// So "interpreter startup" (created to prologue) and "script body"
+// (prologue to exit) are reported apart, per run, in the log, the trace
+// and the metrics histograms.
+//
+// The child's stdout and stderr come back through one pipe, and the
+// launcher relays them to its stdout with the marker taken out. The
+// marker is an OSC escape sequence that terminals ignore, should one ever
+// get through. Embedded scripts (already on a wrapper and stdin) and runs
+// whose output goes to the result cache are not probed.
+
+#ifndef PS_PROBE_H
+#define PS_PROBE_H
+
+#include "metrics.h"
+#include "platform.h"
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+#define PROBE_ENV         PS_T("PS_LAUNCHER_PROBE")
+#define PROBE_MARKER      "\x1b]psl;prologue\x07"
+#define PROBE_MARKER_LEN  15
+#define PROBE_CHUNK       2048        // Relay buffer; its frame stays under a page (no __chkstk)
+
+// Finds the marker at the start of a stream fed in chunks of any size
+typedef struct ProbeScan
+{
+    uint32_t matched;                 // Marker bytes seen so far
+    bool done;                        // Found, or the stream did not start with it
+} ProbeScan;
+
+// What one chunk holds after the scan
+typedef struct ProbeChunk
+{
+    uint32_t held;                    // Marker bytes that turned out to be output:
+                                      // relay PROBE_MARKER[0..held) first
+    size_t start;                     // Output in the chunk from here on
+    bool prologue;                    // The marker ended in this chunk
+} ProbeChunk;
+
+// Whether this launch is probed: PS_LAUNCHER_PROBE is set
+bool ProbeRequested(void);
+
+// Scan the next chunk of the stream; zero-initialize scan first
+void ProbeFeed(ProbeScan* scan, const char* data, size_t size, ProbeChunk* chunk);
+
+// Relay pipe to out until it closes and proc exits, stamping
+// timing->prologueNanos, firstOutputNanos and exitNanos as they happen.
+// False if the child could not be waited for: *exitCode is then unknown.
+bool ProbeRelay(PlatProcess* proc, PlatFile pipe, PlatFile out, RunTiming* timing, uint32_t* exitCode);
+
+PS_EXTERN_C_END
+
+#endif // PS_PROBE_H
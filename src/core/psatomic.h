@@ -0,0 +1,80 @@
+//--------------------------------------------------------------------------
+// ATOMICS - Compiler intrinsics, no OS headers
+//--------------------------------------------------------------------------
+// Workers of the parallel indexer (indexer.c) claim work items by bumping
+// a shared counter. The status board (status.c) is shared between
+// processes: slots are claimed by compare-and-swap and published under a
+// sequence counter, so it needs loads, stores and fences with ordering.
+// Concurrent launchers add to the run metrics (metrics.c) with 64-bit adds.
+
+#ifndef PS_ATOMIC_H
+#define PS_ATOMIC_H
+
+#include "pstypes.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Returns the value before the addition (sequentially consistent)
+static inline uint32_t PsAtomicFetchAdd(volatile uint32_t* p, uint32_t value)
+{
+#ifdef _MSC_VER
+    return (uint32_t)_InterlockedExchangeAdd((volatile long*)p, (long)value);
+#else
+    return __atomic_fetch_add(p, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline uint64_t PsAtomicFetchAdd64(volatile uint64_t* p, uint64_t value)
+{
+#ifdef _MSC_VER
+    return (uint64_t)_InterlockedExchangeAdd64((volatile __int64*)p, (__int64)value);
+#else
+    return __atomic_fetch_add(p, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+// Store desired if *p holds expected; true if it did (sequentially consistent)
+static inline bool PsAtomicCompareExchange(volatile uint32_t* p, uint32_t expected, uint32_t desired)
+{
+#ifdef _MSC_VER
+    return (uint32_t)_InterlockedCompareExchange((volatile long*)p, (long)desired, (long)expected) == expected;
+#else
+    return __atomic_compare_exchange_n(p, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+// Later reads cannot move before this one
+static inline uint32_t PsAtomicLoad(const volatile uint32_t* p)
+{
+#ifdef _MSC_VER
+    // Interlocked operations are full barriers on every MSVC target
+    return (uint32_t)_InterlockedCompareExchange((volatile long*)p, 0, 0);
+#else
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+}
+
+// Earlier writes cannot move after this one
+static inline void PsAtomicStore(volatile uint32_t* p, uint32_t value)
+{
+#ifdef _MSC_VER
+    _InterlockedExchange((volatile long*)p, (long)value);
+#else
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+#endif
+}
+
+// No read or write moves across this point
+static inline void PsAtomicFence(void)
+{
+#ifdef _MSC_VER
+    volatile long barrier = 0;
+    _InterlockedOr(&barrier, 0);
+#else
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif
+}
+
+#endif // PS_ATOMIC_H
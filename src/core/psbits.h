@@ -0,0 +1,64 @@
+//--------------------------------------------------------------------------
+// BIT SCANS - Compiler intrinsics, no OS headers
+//--------------------------------------------------------------------------
+// Shared by the string primitives (psmem.c), the timer wheel and the cron
+// matcher. Every argument must be non-zero.
+
+#ifndef PS_BITS_H
+#define PS_BITS_H
+
+#include "pstypes.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Index of the lowest set bit
+static inline unsigned LowestBit(uint32_t x)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, x);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctz(x);
+#endif
+}
+
+static inline unsigned LowestBit64(uint64_t x)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return (unsigned)index;
+#elif defined(_MSC_VER)
+    uint32_t low = (uint32_t)x;
+    return low ? LowestBit(low) : 32 + LowestBit((uint32_t)(x >> 32));
+#else
+    return (unsigned)__builtin_ctzll(x);
+#endif
+}
+
+// Index of the highest set bit
+static inline unsigned HighestBit64(uint64_t x)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+    unsigned long index;
+    _BitScanReverse64(&index, x);
+    return (unsigned)index;
+#elif defined(_MSC_VER)
+    unsigned long index;
+    uint32_t high = (uint32_t)(x >> 32);
+    if (high)
+    {
+        _BitScanReverse(&index, high);
+        return 32 + (unsigned)index;
+    }
+    _BitScanReverse(&index, (uint32_t)x);
+    return (unsigned)index;
+#else
+    return 63u - (unsigned)__builtin_clzll(x);
+#endif
+}
+
+#endif // PS_BITS_H
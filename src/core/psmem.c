@@ -0,0 +1,502 @@
+//--------------------------------------------------------------------------
+// MEMORY AND STRING PRIMITIVES - CRT replacements for the no-CRT build
+//--------------------------------------------------------------------------
+// Three tiers, chosen at compile time:
+// - SSE2    : x64 and any x86 build with SSE2 enabled (16 bytes per step)
+// - SWAR    : word-at-a-time fallback for every other target
+// - Scalar  : heads and tails shorter than a word
+// Define PS_NO_SIMD to force the SWAR tier (the tests build both).
+//
+// IMPORTANT: The loops below must never be turned back into calls to
+// memset/memcpy by the optimizer - in the no-CRT build those ARE these
+// functions, and the call would recurse forever.
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize("no-tree-loop-distribute-patterns")
+#endif
+
+#include "psmem.h"
+#include "psbits.h"
+
+#if !defined(PS_NO_SIMD) && \
+    (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #define PS_HAVE_SSE2 1
+    #include <emmintrin.h>   // HEADERS: Compiler intrinsics only, no CRT code
+#endif
+
+//--------------------------------------------------------------------------
+// BUILDING BLOCKS
+//--------------------------------------------------------------------------
+// UNALIGNED ACCESS: A fixed-size __builtin_memcpy compiles to one mov on
+// GCC/Clang; MSVC targets (x86/x64/ARM64) allow unaligned word access.
+#ifdef _MSC_VER
+    #define PS_DEFINE_ACCESS(bits)                                                  \
+        static inline uint##bits##_t Load##bits(const void* p)                      \
+        { return *(const uint##bits##_t __unaligned*)p; }                           \
+        static inline void Store##bits(void* p, uint##bits##_t v)                   \
+        { *(uint##bits##_t __unaligned*)p = v; }
+#else
+    #define PS_DEFINE_ACCESS(bits)                                                  \
+        static inline uint##bits##_t Load##bits(const void* p)                      \
+        { uint##bits##_t v; __builtin_memcpy(&v, p, sizeof(v)); return v; }         \
+        static inline void Store##bits(void* p, uint##bits##_t v)                   \
+        { __builtin_memcpy(p, &v, sizeof(v)); }
+#endif
+PS_DEFINE_ACCESS(64)
+PS_DEFINE_ACCESS(32)
+PS_DEFINE_ACCESS(16)
+
+#define PS_PAGE_SIZE 4096u
+
+// True if a 16-byte load at p stays inside its page
+static inline bool PageSafe16(const void* p)
+{
+    return ((uintptr_t)p & (PS_PAGE_SIZE - 1)) <= PS_PAGE_SIZE - 16;
+}
+
+//--------------------------------------------------------------------------
+// MEMSET
+//--------------------------------------------------------------------------
+void* PsMemSet(void* dest, int c, size_t count)
+{
+    unsigned char* d = (unsigned char*)dest;
+    uint64_t word = (uint64_t)(unsigned char)c * 0x0101010101010101ull;
+
+    // SMALL SIZES: Two overlapping stores cover any length in [n, 2n]
+    if (count < 16)
+    {
+        if (count >= 8)
+        {
+            Store64(d, word);
+            Store64(d + count - 8, word);
+        }
+        else if (count >= 4)
+        {
+            Store32(d, (uint32_t)word);
+            Store32(d + count - 4, (uint32_t)word);
+        }
+        else
+        {
+            while (count--)
+                *d++ = (unsigned char)c;
+        }
+        return dest;
+    }
+
+    unsigned char* end = d + count;
+#ifdef PS_HAVE_SSE2
+    __m128i v = _mm_set1_epi8((char)c);
+
+    // HEAD: One unaligned store, then continue from the next 16-byte boundary
+    _mm_storeu_si128((__m128i*)d, v);
+    unsigned char* p = (unsigned char*)(((uintptr_t)d + 16) & ~(uintptr_t)15);
+    while (p + 64 <= end)
+    {
+        _mm_store_si128((__m128i*)p, v);
+        _mm_store_si128((__m128i*)(p + 16), v);
+        _mm_store_si128((__m128i*)(p + 32), v);
+        _mm_store_si128((__m128i*)(p + 48), v);
+        p += 64;
+    }
+    while (p + 16 <= end)
+    {
+        _mm_store_si128((__m128i*)p, v);
+        p += 16;
+    }
+
+    // TAIL: Overlapping unaligned store finishes the last partial block
+    _mm_storeu_si128((__m128i*)(end - 16), v);
+#else
+    Store64(d, word);
+    unsigned char* p = (unsigned char*)(((uintptr_t)d + 8) & ~(uintptr_t)7);
+    while (p + 8 <= end)
+    {
+        Store64(p, word);
+        p += 8;
+    }
+    Store64(end - 8, word);
+#endif
+    return dest;
+}
+
+//--------------------------------------------------------------------------
+// MEMCPY
+//--------------------------------------------------------------------------
+void* PsMemCpy(void* dest, const void* src, size_t count)
+{
+    unsigned char* d = (unsigned char*)dest;
+    const unsigned char* s = (const unsigned char*)src;
+
+    // SMALL SIZES: Load both ends first, then store - no loop at all
+    if (count < 16)
+    {
+        if (count >= 8)
+        {
+            uint64_t a = Load64(s);
+            uint64_t b = Load64(s + count - 8);
+            Store64(d, a);
+            Store64(d + count - 8, b);
+        }
+        else if (count >= 4)
+        {
+            uint32_t a = Load32(s);
+            uint32_t b = Load32(s + count - 4);
+            Store32(d, a);
+            Store32(d + count - 4, b);
+        }
+        else if (count >= 2)
+        {
+            uint16_t a = Load16(s);
+            uint16_t b = Load16(s + count - 2);
+            Store16(d, a);
+            Store16(d + count - 2, b);
+        }
+        else if (count == 1)
+        {
+            *d = *s;
+        }
+        return dest;
+    }
+
+#ifdef PS_HAVE_SSE2
+    // Stream 64/16 bytes per step, then one overlapping store of the last
+    // 16 bytes (loaded up front) finishes the partial block
+    __m128i last = _mm_loadu_si128((const __m128i*)(s + count - 16));
+    size_t i = 0;
+    for (; i + 64 <= count; i += 64)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i*)(s + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(s + i + 16));
+        __m128i c = _mm_loadu_si128((const __m128i*)(s + i + 32));
+        __m128i e = _mm_loadu_si128((const __m128i*)(s + i + 48));
+        _mm_storeu_si128((__m128i*)(d + i), a);
+        _mm_storeu_si128((__m128i*)(d + i + 16), b);
+        _mm_storeu_si128((__m128i*)(d + i + 32), c);
+        _mm_storeu_si128((__m128i*)(d + i + 48), e);
+    }
+    for (; i + 16 <= count; i += 16)
+        _mm_storeu_si128((__m128i*)(d + i), _mm_loadu_si128((const __m128i*)(s + i)));
+    _mm_storeu_si128((__m128i*)(d + count - 16), last);
+#else
+    uint64_t last = Load64(s + count - 8);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+        Store64(d + i, Load64(s + i));
+    Store64(d + count - 8, last);
+#endif
+    return dest;
+}
+
+//--------------------------------------------------------------------------
+// MEMCHR
+//--------------------------------------------------------------------------
+#ifndef PS_HAVE_SSE2
+// SWAR: Non-zero iff some byte of x is zero (exact for the lowest one)
+static inline uint64_t HasZeroByte(uint64_t x)
+{
+    return (x - 0x0101010101010101ull) & ~x & 0x8080808080808080ull;
+}
+#endif
+
+const void* PsMemChr(const void* s, int c, size_t count)
+{
+    const unsigned char* p = (const unsigned char*)s;
+    unsigned char target = (unsigned char)c;
+
+#ifdef PS_HAVE_SSE2
+    if (count >= 16)
+    {
+        __m128i needle = _mm_set1_epi8((char)target);
+        size_t i = 0;
+        for (; i + 64 <= count; i += 64)
+        {
+            __m128i m0 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + i)), needle);
+            __m128i m1 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + i + 16)), needle);
+            __m128i m2 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + i + 32)), needle);
+            __m128i m3 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + i + 48)), needle);
+            if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(m0, m1), _mm_or_si128(m2, m3))))
+                break;   // The 16-byte loop below pinpoints the match
+        }
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i block = _mm_loadu_si128((const __m128i*)(p + i));
+            uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+            if (mask)
+                return p + i + LowestBit(mask);
+        }
+        if (i == count)
+            return NULL;
+
+        // TAIL: Re-scan the last 16 bytes (overlap is harmless - it had no match)
+        const unsigned char* tail = p + count - 16;
+        __m128i block = _mm_loadu_si128((const __m128i*)tail);
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        return mask ? tail + LowestBit(mask) : NULL;
+    }
+#else
+    if (count >= 8)
+    {
+        uint64_t pattern = (uint64_t)target * 0x0101010101010101ull;
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            if (HasZeroByte(Load64(p + i) ^ pattern))
+                break;
+        }
+        p += i;
+        count -= i;
+    }
+#endif
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (p[i] == target)
+            return p + i;
+    }
+    return NULL;
+}
+
+const uint16_t* PsMemChr16(const uint16_t* s, uint16_t c, size_t count)
+{
+    size_t i = 0;
+
+#ifdef PS_HAVE_SSE2
+    __m128i needle = _mm_set1_epi16((short)c);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i*)(s + i));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi16(block, needle));
+        if (mask)
+            return s + i + LowestBit(mask) / 2;
+    }
+#else
+    // SWAR: Four units per word; a zero unit in (word ^ pattern) is a match
+    uint64_t pattern = (uint64_t)c * 0x0001000100010001ull;
+    for (; i + 4 <= count; i += 4)
+    {
+        uint64_t x = Load64(s + i) ^ pattern;
+        if ((x - 0x0001000100010001ull) & ~x & 0x8000800080008000ull)
+            break;
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        if (s[i] == c)
+            return s + i;
+    }
+    return NULL;
+}
+
+//--------------------------------------------------------------------------
+// NUL-TERMINATED SCANS
+//--------------------------------------------------------------------------
+// PAGE-SAFE VECTOR SCAN: Align the pointer down to 16 bytes and discard
+// the mask bits that belong to bytes before the string. Every load is an
+// aligned 16-byte block, so it never touches a page the string does not.
+
+#ifdef PS_HAVE_SSE2
+
+// Lanes equal to a (or to either of a and b) become all-ones
+static inline __m128i MatchOne8(__m128i block, __m128i a, __m128i b)
+{
+    (void)b;
+    return _mm_cmpeq_epi8(block, a);
+}
+
+static inline __m128i MatchTwo8(__m128i block, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_cmpeq_epi8(block, a), _mm_cmpeq_epi8(block, b));
+}
+
+static inline __m128i MatchOne16(__m128i block, __m128i a, __m128i b)
+{
+    (void)b;
+    return _mm_cmpeq_epi16(block, a);
+}
+
+static inline __m128i MatchTwo16(__m128i block, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_cmpeq_epi16(block, a), _mm_cmpeq_epi16(block, b));
+}
+
+static inline uint32_t Mask(__m128i v)
+{
+    return (uint32_t)_mm_movemask_epi8(v);
+}
+
+// Byte offset from s of the first code unit accepted by match.
+// UNROLLED: Once 64-byte aligned, four blocks are tested per step; an
+// aligned 64-byte group is still entirely inside one page.
+#define PS_DEFINE_SCAN(name, match)                                                  \
+    static size_t name(const void* s, __m128i a, __m128i b)                          \
+    {                                                                                \
+        uintptr_t offset = (uintptr_t)s & 15;                                        \
+        const __m128i* block = (const __m128i*)((const char*)s - offset);            \
+        uint32_t mask = Mask(match(_mm_load_si128(block), a, b)) >> offset;          \
+        if (mask)                                                                    \
+            return LowestBit(mask);                                                  \
+        for (block++; (uintptr_t)block & 63; block++)                                \
+        {                                                                            \
+            mask = Mask(match(_mm_load_si128(block), a, b));                         \
+            if (mask)                                                                \
+                return (size_t)((const char*)block - (const char*)s) + LowestBit(mask); \
+        }                                                                            \
+        for (;; block += 4)                                                          \
+        {                                                                            \
+            __m128i m0 = match(_mm_load_si128(block), a, b);                         \
+            __m128i m1 = match(_mm_load_si128(block + 1), a, b);                     \
+            __m128i m2 = match(_mm_load_si128(block + 2), a, b);                     \
+            __m128i m3 = match(_mm_load_si128(block + 3), a, b);                     \
+            if (Mask(_mm_or_si128(_mm_or_si128(m0, m1), _mm_or_si128(m2, m3))))     \
+            {                                                                        \
+                uint64_t lo = Mask(m0) | ((uint64_t)Mask(m1) << 16);                 \
+                uint64_t hi = Mask(m2) | ((uint64_t)Mask(m3) << 16);                 \
+                size_t base = (size_t)((const char*)block - (const char*)s);         \
+                return lo ? base + LowestBit64(lo) : base + 32 + LowestBit64(hi);    \
+            }                                                                        \
+        }                                                                            \
+    }
+
+PS_DEFINE_SCAN(ScanOne8, MatchOne8)
+PS_DEFINE_SCAN(ScanTwo8, MatchTwo8)
+PS_DEFINE_SCAN(ScanOne16, MatchOne16)     // 16-bit scans need 2-byte aligned s
+PS_DEFINE_SCAN(ScanTwo16, MatchTwo16)
+
+#endif // PS_HAVE_SSE2
+
+size_t PsStrLen8(const char* s)
+{
+#ifdef PS_HAVE_SSE2
+    __m128i zero = _mm_setzero_si128();
+    return ScanOne8(s, zero, zero);
+#else
+    const char* p = s;
+    while ((uintptr_t)p & 7)
+    {
+        if (!*p)
+            return (size_t)(p - s);
+        p++;
+    }
+    // Aligned words cannot cross a page either
+    while (!HasZeroByte(Load64(p)))
+        p += 8;
+    while (*p)
+        p++;
+    return (size_t)(p - s);
+#endif
+}
+
+size_t PsStrLen16(const uint16_t* s)
+{
+#ifdef PS_HAVE_SSE2
+    if (((uintptr_t)s & 1) == 0)
+    {
+        __m128i zero = _mm_setzero_si128();
+        return ScanOne16(s, zero, zero) / 2;
+    }
+#endif
+    const uint16_t* p = s;
+    while (*p)
+        p++;
+    return (size_t)(p - s);
+}
+
+const char* PsStrChr8(const char* s, char c)
+{
+#ifdef PS_HAVE_SSE2
+    size_t i = ScanTwo8(s, _mm_setzero_si128(), _mm_set1_epi8(c));
+    return (s[i] == c && c != 0) ? s + i : NULL;
+#else
+    for (; *s; s++)
+    {
+        if (*s == c)
+            return s;
+    }
+    return NULL;
+#endif
+}
+
+const uint16_t* PsStrChr16(const uint16_t* s, uint16_t c)
+{
+#ifdef PS_HAVE_SSE2
+    if (((uintptr_t)s & 1) == 0)
+    {
+        size_t i = ScanTwo16(s, _mm_setzero_si128(), _mm_set1_epi16((short)c)) / 2;
+        return (s[i] == c && c != 0) ? s + i : NULL;
+    }
+#endif
+    for (; *s; s++)
+    {
+        if (*s == c)
+            return s;
+    }
+    return NULL;
+}
+
+//--------------------------------------------------------------------------
+// COMPARISON
+//--------------------------------------------------------------------------
+// Two strings rarely share an alignment, so the vector path uses unaligned
+// loads and only takes them while neither pointer is within 16 bytes of a
+// page end; near a boundary it steps one code unit at a time.
+
+int PsStrCmp8(const char* a, const char* b)
+{
+    const unsigned char* pa = (const unsigned char*)a;
+    const unsigned char* pb = (const unsigned char*)b;
+    for (;;)
+    {
+#ifdef PS_HAVE_SSE2
+        if (PageSafe16(pa) && PageSafe16(pb))
+        {
+            __m128i va = _mm_loadu_si128((const __m128i*)pa);
+            __m128i vb = _mm_loadu_si128((const __m128i*)pb);
+            uint32_t differ = ~(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) & 0xFFFFu;
+            uint32_t ends = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(va, _mm_setzero_si128()));
+            uint32_t stop = differ | ends;
+            if (stop)
+            {
+                unsigned i = LowestBit(stop);
+                return (int)pa[i] - (int)pb[i];
+            }
+            pa += 16;
+            pb += 16;
+            continue;
+        }
+#endif
+        if (*pa != *pb || *pa == 0)
+            return (int)*pa - (int)*pb;
+        pa++;
+        pb++;
+    }
+}
+
+int PsStrCmp16(const uint16_t* a, const uint16_t* b)
+{
+    for (;;)
+    {
+#ifdef PS_HAVE_SSE2
+        if (PageSafe16(a) && PageSafe16(b))
+        {
+            __m128i va = _mm_loadu_si128((const __m128i*)a);
+            __m128i vb = _mm_loadu_si128((const __m128i*)b);
+            uint32_t differ = ~(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi16(va, vb)) & 0xFFFFu;
+            uint32_t ends = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi16(va, _mm_setzero_si128()));
+            uint32_t stop = differ | ends;
+            if (stop)
+            {
+                unsigned i = LowestBit(stop) / 2;
+                return (int)a[i] - (int)b[i];
+            }
+            a += 8;
+            b += 8;
+            continue;
+        }
+#endif
+        if (*a != *b || *a == 0)
+            return (int)*a - (int)*b;
+        a++;
+        b++;
+    }
+}
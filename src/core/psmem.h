@@ -0,0 +1,43 @@
+//--------------------------------------------------------------------------
+// MEMORY AND STRING PRIMITIVES - CRT replacements for the no-CRT build
+//--------------------------------------------------------------------------
+// Word-sized (SWAR) and SSE2 implementations of the handful of CRT
+// routines the launcher needs. Nothing here calls into a runtime library,
+// so the /NODEFAULTLIB build links them directly (crt.c maps memset and
+// memcpy onto them for compiler-generated calls).
+//
+// String functions come in 8-bit (UTF-8) and 16-bit (UTF-16) flavours so
+// both widths can be tested on any platform; psstr.c picks the one that
+// matches PSCHAR. Scans over NUL-terminated strings only ever load aligned
+// 16-byte blocks, which cannot cross a page boundary, so reading past the
+// terminator never faults.
+
+#ifndef PS_MEM_H
+#define PS_MEM_H
+
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+void* PsMemSet(void* dest, int c, size_t count);
+void* PsMemCpy(void* dest, const void* src, size_t count);
+const void* PsMemChr(const void* s, int c, size_t count);
+
+// memchr over count 16-bit units (s must be 2-byte aligned)
+const uint16_t* PsMemChr16(const uint16_t* s, uint16_t c, size_t count);
+
+// Length in characters before the terminator
+size_t PsStrLen8(const char* s);
+size_t PsStrLen16(const uint16_t* s);
+
+// Ordinal comparison (unsigned code units), returns <0, 0 or >0
+int PsStrCmp8(const char* a, const char* b);
+int PsStrCmp16(const uint16_t* a, const uint16_t* b);
+
+// First occurrence of c before the terminator, or NULL
+const char* PsStrChr8(const char* s, char c);
+const uint16_t* PsStrChr16(const uint16_t* s, uint16_t c);
+
+PS_EXTERN_C_END
+
+#endif // PS_MEM_H
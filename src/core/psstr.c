@@ -0,0 +1,91 @@
+//--------------------------------------------------------------------------
+// STRING HELPERS - CRT-free string operations on PSCHAR
+//--------------------------------------------------------------------------
+// Length, search and copy go through the vectorized primitives in psmem.c;
+// only the case-insensitive compare is still a plain loop.
+#include "psstr.h"
+#include "psmem.h"
+
+size_t PsStrLen(const PSCHAR* s)
+{
+#ifdef _WIN32
+    return PsStrLen16((const uint16_t*)s);   // wchar_t is UTF-16 on Windows
+#else
+    return PsStrLen8(s);
+#endif
+}
+
+// ASCII-only folding: switch names and file extensions are all ASCII
+static inline PSCHAR FoldCase(PSCHAR c)
+{
+    return (c >= 'A' && c <= 'Z') ? (PSCHAR)(c + ('a' - 'A')) : c;
+}
+
+int PsStrCmpI(const PSCHAR* a, const PSCHAR* b)
+{
+    for (;;)
+    {
+        PSCHAR ca = FoldCase(*a++);
+        PSCHAR cb = FoldCase(*b++);
+        if (ca != cb)
+            return ca < cb ? -1 : 1;
+        if (ca == 0)
+            return 0;
+    }
+}
+
+const PSCHAR* PsStrChr(const PSCHAR* s, PSCHAR c)
+{
+#ifdef _WIN32
+    return (const PSCHAR*)PsStrChr16((const uint16_t*)s, (uint16_t)c);
+#else
+    return PsStrChr8(s, c);
+#endif
+}
+
+bool AppendStrN(PSCHAR* dest, size_t destSize, const PSCHAR* src, size_t srcLen, size_t* curLen)
+{
+    // BOUNDS CHECKING: Prevent buffer overflow before it happens
+    if (*curLen + srcLen >= destSize)
+        return false;
+
+    // BULK COPY: PsMemCpy is safe in the /NODEFAULTLIB build, so the old
+    // character-at-a-time loop is no longer needed
+    PsMemCpy(dest + *curLen, src, srcLen * sizeof(PSCHAR));
+    *curLen += srcLen;
+    dest[*curLen] = 0;
+    return true;
+}
+
+bool AppendStr(PSCHAR* dest, size_t destSize, const PSCHAR* src, size_t* curLen)
+{
+    return AppendStrN(dest, destSize, src, PsStrLen(src), curLen);
+}
+
+bool AppendChar(PSCHAR* dest, size_t destSize, PSCHAR c, size_t* curLen)
+{
+    if (*curLen + 1 >= destSize)
+        return false;
+    dest[(*curLen)++] = c;
+    dest[*curLen] = 0;
+    return true;
+}
+
+bool AppendUInt(PSCHAR* dest, size_t destSize, uint64_t value, size_t* curLen)
+{
+    // Digits are produced least-significant first, then reversed on append
+    PSCHAR digits[20];
+    size_t count = 0;
+    do
+    {
+        digits[count++] = (PSCHAR)('0' + (value % 10));
+        value /= 10;
+    } while (value != 0);
+
+    if (*curLen + count >= destSize)
+        return false;
+    while (count > 0)
+        dest[(*curLen)++] = digits[--count];
+    dest[*curLen] = 0;
+    return true;
+}
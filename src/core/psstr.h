@@ -0,0 +1,38 @@
+//--------------------------------------------------------------------------
+// STRING HELPERS - CRT-free string operations on PSCHAR
+//--------------------------------------------------------------------------
+// These replace lstrlenW/lstrcmpiW/lstrcatW so the core does not depend on
+// kernel32 and behaves the same on the POSIX backend.
+
+#ifndef PS_STR_H
+#define PS_STR_H
+
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+// LENGTH: Number of characters before the terminator
+size_t PsStrLen(const PSCHAR* s);
+
+// COMPARISON: ASCII case-insensitive, returns 0 when equal (like lstrcmpiW)
+int PsStrCmpI(const PSCHAR* a, const PSCHAR* b);
+
+// SEARCH: Pointer to first occurrence of c, or NULL
+const PSCHAR* PsStrChr(const PSCHAR* s, PSCHAR c);
+
+// Append src to dest at *curLen, keeping dest terminated
+// Returns false (and leaves dest untouched) if destSize would be exceeded
+bool AppendStr(PSCHAR* dest, size_t destSize, const PSCHAR* src, size_t* curLen);
+
+// Append exactly srcLen characters (src need not be terminated)
+bool AppendStrN(PSCHAR* dest, size_t destSize, const PSCHAR* src, size_t srcLen, size_t* curLen);
+
+// Append a single character
+bool AppendChar(PSCHAR* dest, size_t destSize, PSCHAR c, size_t* curLen);
+
+// Append the decimal text of value (replaces wsprintfW "%u")
+bool AppendUInt(PSCHAR* dest, size_t destSize, uint64_t value, size_t* curLen);
+
+PS_EXTERN_C_END
+
+#endif // PS_STR_H
@@ -0,0 +1,46 @@
+//--------------------------------------------------------------------------
+// CORE TYPES - Character width and freestanding type definitions
+//--------------------------------------------------------------------------
+// The core library never includes a platform header. Everything it needs
+// comes from the freestanding headers (no CRT code is linked by these):
+// - stddef.h  : size_t, NULL
+// - stdint.h  : fixed-width integers for records and timestamps
+// - stdbool.h : bool/true/false (replaces the old "#define bool int")
+//
+// PSCHAR is the native character of the platform backend:
+// - Windows : wchar_t (UTF-16), matching WCHAR and the *W API family
+// - POSIX   : char (UTF-8), matching argv and the file system
+// PS_T("text") produces a literal of the right width, like TEXT() does.
+
+#ifndef PS_TYPES_H
+#define PS_TYPES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#ifndef __cplusplus
+#include <stdbool.h>
+#endif
+
+#ifdef _WIN32
+    typedef wchar_t PSCHAR;
+    #define PS_T(s) L##s
+    #define PS_PATH_SEP L'\\'
+#else
+    typedef char PSCHAR;
+    #define PS_T(s) s
+    #define PS_PATH_SEP '/'
+#endif
+
+// C++ translation units include the core headers directly
+#ifdef __cplusplus
+    #define PS_EXTERN_C_BEGIN extern "C" {
+    #define PS_EXTERN_C_END   }
+#else
+    #define PS_EXTERN_C_BEGIN
+    #define PS_EXTERN_C_END
+#endif
+
+// PATH BUFFERS: Same limit on both backends so behaviour is identical
+#define PS_MAX_PATH 260
+
+#endif // PS_TYPES_H
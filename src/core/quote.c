@@ -0,0 +1,61 @@
+//--------------------------------------------------------------------------
+// QUOTING - Turning one argument into command line text
+//--------------------------------------------------------------------------
+#include "quote.h"
+#include "psstr.h"
+
+bool IsAlreadyQuoted(const PSCHAR* param, size_t paramLen)
+{
+    return paramLen >= 2 && param[0] == PS_T('"') && param[paramLen - 1] == PS_T('"');
+}
+
+bool AppendEscaped(StrBuf* sb, const PSCHAR* src)
+{
+    const PSCHAR* run = src;
+    const PSCHAR* quote;
+
+    // Copy each run of ordinary characters in one go, then the escaped quote
+    while ((quote = PsStrChr(run, PS_T('"'))) != NULL)
+    {
+        if (!StrBufAppendN(sb, run, (size_t)(quote - run)) ||
+            !StrBufAppendN(sb, PS_T("\\\""), 2))
+            return false;
+        run = quote + 1;
+    }
+    return StrBufAppend(sb, run);
+}
+
+bool AppendQuotedParameter(StrBuf* sb, const PSCHAR* param)
+{
+    size_t paramLen = PsStrLen(param);
+
+    // ALREADY QUOTED: Use parameter as-is
+    if (IsAlreadyQuoted(param, paramLen))
+        return StrBufAppendN(sb, param, paramLen);
+
+    // UNQUOTED OR NEEDS QUOTING: Add quotes and escape internal quotes
+    // Reserve the common case (no escapes) up front: one growth at most
+    if (!StrBufReserve(sb, paramLen + 2) || !StrBufAppendChar(sb, PS_T('"')))
+        return false;
+
+    if (PsStrChr(param, PS_T('"')) != NULL)
+    {
+        if (!AppendEscaped(sb, param))
+            return false;
+    }
+    else
+    {
+        // No internal quotes, append normally
+        if (!StrBufAppendN(sb, param, paramLen))
+            return false;
+    }
+
+    return StrBufAppendChar(sb, PS_T('"'));
+}
+
+bool AppendQuotedPath(StrBuf* sb, const PSCHAR* path)
+{
+    return StrBufAppendChar(sb, PS_T('"'))
+        && StrBufAppend(sb, path)
+        && StrBufAppendChar(sb, PS_T('"'));
+}
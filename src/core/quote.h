@@ -0,0 +1,31 @@
+//--------------------------------------------------------------------------
+// QUOTING - Turning one argument into command line text
+//--------------------------------------------------------------------------
+// The rules match what powershell.exe expects from CommandLineToArgvW:
+// - A parameter already wrapped in quotes is passed through unchanged
+// - Anything else is wrapped in quotes, with internal quotes as \"
+
+#ifndef PS_QUOTE_H
+#define PS_QUOTE_H
+
+#include "pstypes.h"
+#include "strbuf.h"
+
+PS_EXTERN_C_BEGIN
+
+// True if param starts and ends with a double quote (and is at least "")
+bool IsAlreadyQuoted(const PSCHAR* param, size_t paramLen);
+
+// Escape internal quotes in a string for PowerShell
+// Returns false if the builder's limit would be exceeded
+bool AppendEscaped(StrBuf* sb, const PSCHAR* src);
+
+// Append a script parameter using the rules above
+bool AppendQuotedParameter(StrBuf* sb, const PSCHAR* param);
+
+// Append a path wrapped in quotes (paths cannot contain quotes on Windows)
+bool AppendQuotedPath(StrBuf* sb, const PSCHAR* path);
+
+PS_EXTERN_C_END
+
+#endif // PS_QUOTE_H
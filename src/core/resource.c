@@ -0,0 +1,175 @@
+//--------------------------------------------------------------------------
+// RESOURCE TAGS - How many jobs may hold a shared resource at once
+//--------------------------------------------------------------------------
+#include "resource.h"
+#include "psbits.h"
+#include "psmem.h"
+#include "psstr.h"
+
+void ResourceInit(ResourceTable* table)
+{
+    PsMemSet(table, 0, sizeof(*table));
+}
+
+static ResourceTag* Find(const ResourceTable* table, const PSCHAR* name)
+{
+    for (uint32_t i = 0; i < table->count; i++)
+    {
+        if (PsStrCmpI(table->tags[i].name, name) == 0)
+            return (ResourceTag*)&table->tags[i];
+    }
+    return NULL;
+}
+
+bool ResourceDeclare(ResourceTable* table, const PSCHAR* name, uint32_t limit)
+{
+    size_t len = PsStrLen(name);
+    if (len == 0 || len >= RESOURCE_NAME_CHARS || limit == 0 || limit > RESOURCE_MAX_LIMIT)
+        return false;
+    ResourceTag* tag = Find(table, name);
+    if (!tag)
+    {
+        if (table->count == RESOURCE_MAX_TAGS)
+            return false;
+        tag = &table->tags[table->count++];
+        PsMemSet(tag, 0, sizeof(*tag));
+        PsMemCpy(tag->name, name, (len + 1) * sizeof(PSCHAR));
+    }
+    // A raised limit may let its line move
+    if (limit > tag->limit)
+        table->moved |= 1ull << (tag - table->tags);
+    tag->limit = limit;
+    return true;
+}
+
+void ResourceClaimInit(ResourceClaim* claim)
+{
+    PsMemSet(claim, 0, sizeof(*claim));
+}
+
+bool ResourceClaimAdd(const ResourceTable* table, ResourceClaim* claim, const PSCHAR* name)
+{
+    const ResourceTag* tag = Find(table, name);
+    if (!tag)
+        return true;
+    uint8_t slot = (uint8_t)(tag - table->tags);
+    for (uint32_t i = 0; i < claim->count; i++)
+    {
+        if (claim->tags[i] == slot)
+            return true;
+    }
+    if (claim->count == RESOURCE_MAX_HELD)
+        return false;
+    claim->tags[claim->count++] = slot;
+    return true;
+}
+
+// Every tag below its limit, with no line ahead: empty for a new claim,
+// headed by the claim itself for one that waits
+static bool Room(const ResourceTable* table, const ResourceClaim* claim, const ResourceClaim* head)
+{
+    for (uint32_t i = 0; i < claim->count; i++)
+    {
+        const ResourceTag* tag = &table->tags[claim->tags[i]];
+        if (tag->held >= tag->limit || tag->head != head)
+            return false;
+    }
+    return true;
+}
+
+static void Take(ResourceTable* table, ResourceClaim* claim)
+{
+    for (uint32_t i = 0; i < claim->count; i++)
+        table->tags[claim->tags[i]].held++;
+    claim->state = RESOURCE_HELD;
+}
+
+// Where claim keeps its links for slot
+static ResourceLink* LinkFor(ResourceClaim* claim, uint8_t slot)
+{
+    uint32_t i = 0;
+    while (claim->tags[i] != slot)
+        i++;
+    return &claim->links[i];
+}
+
+// Out of every line; the heads behind it may go now
+static void Leave(ResourceTable* table, ResourceClaim* claim)
+{
+    for (uint32_t i = 0; i < claim->count; i++)
+    {
+        uint8_t slot = claim->tags[i];
+        ResourceTag* tag = &table->tags[slot];
+        ResourceLink* link = &claim->links[i];
+        if (link->prev)
+            LinkFor(link->prev, slot)->next = link->next;
+        else
+            tag->head = link->next;
+        if (link->next)
+            LinkFor(link->next, slot)->prev = link->prev;
+        else
+            tag->tail = link->prev;
+        table->moved |= 1ull << slot;
+    }
+    table->waiting--;
+}
+
+bool ResourceAcquire(ResourceTable* table, ResourceClaim* claim)
+{
+    if (claim->state != RESOURCE_FREE)
+        return claim->state == RESOURCE_HELD;
+    if (Room(table, claim, NULL))
+    {
+        Take(table, claim);
+        return true;
+    }
+
+    // WAIT: At the back of every line at once, so all lines share one order
+    for (uint32_t i = 0; i < claim->count; i++)
+    {
+        ResourceTag* tag = &table->tags[claim->tags[i]];
+        claim->links[i].prev = tag->tail;
+        claim->links[i].next = NULL;
+        if (tag->tail)
+            LinkFor(tag->tail, claim->tags[i])->next = claim;
+        else
+            tag->head = claim;
+        tag->tail = claim;
+    }
+    claim->state = RESOURCE_WAITING;
+    table->waiting++;
+    return false;
+}
+
+ResourceClaim* ResourceNext(ResourceTable* table)
+{
+    // A marked tag stays marked while its head goes; the next head may too
+    while (table->moved)
+    {
+        unsigned slot = LowestBit64(table->moved);
+        ResourceClaim* head = table->tags[slot].head;
+        if (head && Room(table, head, head))
+        {
+            Leave(table, head);
+            Take(table, head);
+            return head;
+        }
+        table->moved &= ~(1ull << slot);
+    }
+    return NULL;
+}
+
+void ResourceRelease(ResourceTable* table, ResourceClaim* claim)
+{
+    if (claim->state == RESOURCE_WAITING)
+        Leave(table, claim);
+    else if (claim->state == RESOURCE_HELD)
+    {
+        for (uint32_t i = 0; i < claim->count; i++)
+        {
+            table->tags[claim->tags[i]].held--;
+            table->moved |= 1ull << claim->tags[i];
+        }
+    }
+    claim->state = RESOURCE_FREE;
+}
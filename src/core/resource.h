@@ -0,0 +1,116 @@
+//--------------------------------------------------------------------------
+// RESOURCE TAGS - How many jobs may hold a shared resource at once
+//--------------------------------------------------------------------------
+// Scripts that touch the same database or share must not all run at once,
+// while scripts that share nothing should. A catalogue declares each such
+// resource with a limit and tags profiles with the resources their
+// scripts use (catalog.h):
+//
+//   resource sales-db 1
+//   resource backup-share 3
+//   tags     nightly sales-db backup-share
+//
+// A job holds every tag of its profile while it runs. The batch engine
+// (PslRunBatch), the resident scheduler and the submission server admit a
+// job only when each of its tags is below its limit, so jobs with disjoint
+// tags run side by side and only jobs that share a tag take turns.
+//
+// FAIRNESS: Every tag has a line of the jobs waiting for it. A job that
+// cannot go joins the line of each of its tags at once, and a job goes
+// only from the head of every line it is in; a new job never overtakes a
+// line, even where the tag has room. Lines are all joined in one order,
+// so the job that has waited longest heads each of its lines and goes as
+// soon as its tags have room: no job waits forever, however many jobs
+// needing only one of its tags keep coming.
+//
+// Admission is O(1): a job holds at most RESOURCE_MAX_HELD tags, and
+// checking one is a counter and a line head. When a job lets go, or leaves
+// a line, its tags are marked; ResourceNext looks only at the heads of
+// marked lines. Names are looked up once, as claims are made. Jobs are
+// intrusive: the caller embeds a ResourceClaim in its own record. Nothing
+// is allocated, and nothing here is thread safe.
+
+#ifndef PS_RESOURCE_H
+#define PS_RESOURCE_H
+
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+#define RESOURCE_MAX_TAGS     64         // Tags one table knows
+#define RESOURCE_MAX_HELD     8          // Tags one job holds
+#define RESOURCE_NAME_CHARS   64         // Longest name, with its terminator
+#define RESOURCE_MAX_LIMIT    100000
+
+typedef enum ResourceState
+{
+    RESOURCE_FREE = 0,               // Neither holding nor waiting
+    RESOURCE_WAITING = 1,
+    RESOURCE_HELD = 2
+} ResourceState;
+
+typedef struct ResourceClaim ResourceClaim;
+
+typedef struct ResourceLink
+{
+    ResourceClaim* prev;
+    ResourceClaim* next;
+} ResourceLink;
+
+struct ResourceClaim
+{
+    uint8_t tags[RESOURCE_MAX_HELD]; // Table slots
+    ResourceLink links[RESOURCE_MAX_HELD]; // Place in each tag's line, while waiting
+    uint32_t count;
+    uint32_t state;                  // ResourceState
+};
+
+typedef struct ResourceTag
+{
+    PSCHAR name[RESOURCE_NAME_CHARS];
+    uint32_t limit;
+    uint32_t held;
+    ResourceClaim* head;             // Its line, longest waiting first
+    ResourceClaim* tail;
+} ResourceTag;
+
+typedef struct ResourceTable
+{
+    ResourceTag tags[RESOURCE_MAX_TAGS];
+    uint32_t count;
+    uint32_t waiting;                // Claims in lines
+    uint64_t moved;                  // Tags whose line head may go now
+} ResourceTable;
+
+void ResourceInit(ResourceTable* table);
+
+// Add a tag, or change its limit (1 to RESOURCE_MAX_LIMIT); names compare
+// ASCII case-insensitively. False if the name is empty or too long, the
+// limit out of range, or the table full.
+bool ResourceDeclare(ResourceTable* table, const PSCHAR* name, uint32_t limit);
+
+void ResourceClaimInit(ResourceClaim* claim);
+
+// Make a free claim hold the tag too. A name never declared has no limit
+// and is left out. False only with RESOURCE_MAX_HELD tags already held.
+bool ResourceClaimAdd(const ResourceTable* table, ResourceClaim* claim, const PSCHAR* name);
+
+// Take the claim's tags now, or join their lines: true when held, false
+// when it waits for ResourceNext
+bool ResourceAcquire(ResourceTable* table, ResourceClaim* claim);
+
+// A waiting claim whose tags all have room, now held; NULL if none
+ResourceClaim* ResourceNext(ResourceTable* table);
+
+// Give back a held claim's tags, or take a waiting one out of its lines;
+// either way it is free again, with the same tags
+void ResourceRelease(ResourceTable* table, ResourceClaim* claim);
+
+static inline bool ResourceWaiting(const ResourceClaim* claim)
+{
+    return claim->state == RESOURCE_WAITING;
+}
+
+PS_EXTERN_C_END
+
+#endif // PS_RESOURCE_H
@@ -0,0 +1,393 @@
+//--------------------------------------------------------------------------
+// RESULT CACHE - Reuse recent results of read-only scripts
+//--------------------------------------------------------------------------
+#include "resultcache.h"
+#include "psmem.h"
+#include "psstr.h"
+#include "strbuf.h"
+
+#define ENTRY_SUFFIX PS_T(".result")
+#define TEMP_SUFFIX  PS_T(".tmp")
+
+// Captures this old belong to a launcher that died mid-run
+#define ABANDONED_TEMP (3600 * PLAT_FILE_TICKS_PER_SECOND)
+
+//--------------------------------------------------------------------------
+// KEY
+//--------------------------------------------------------------------------
+// PowerShell binds "-Name" case-insensitively, so "-name" is the same call;
+// values (including "-5") are kept exactly
+static void HashParameter(Sha256* ctx, const PSCHAR* param)
+{
+    PSCHAR folded[64];
+    size_t len = PsStrLen(param);
+    bool isName = len >= 2 && param[0] == PS_T('-') &&
+                  ((param[1] >= PS_T('A') && param[1] <= PS_T('Z')) ||
+                   (param[1] >= PS_T('a') && param[1] <= PS_T('z')));
+    size_t done = 0;
+    while (isName && done < len && param[done] != PS_T(':'))
+    {
+        size_t n = 0;
+        for (; n < 64 && done + n < len && param[done + n] != PS_T(':'); n++)
+        {
+            PSCHAR c = param[done + n];
+            folded[n] = (c >= PS_T('A') && c <= PS_T('Z')) ? (PSCHAR)(c | 0x20) : c;
+        }
+        Sha256Update(ctx, folded, n * sizeof(PSCHAR));
+        done += n;
+    }
+    Sha256Update(ctx, param + done, (len - done + 1) * sizeof(PSCHAR));
+}
+
+static PSCHAR* JoinName(Arena* arena, const PSCHAR* dir, const PSCHAR* name, size_t nameLen,
+                        const PSCHAR* suffix)
+{
+    StrBuf path;
+    if (!StrBufInit(&path, arena, PsStrLen(dir) + nameLen + 32, STRBUF_NO_LIMIT) ||
+        !StrBufAppend(&path, dir) || !StrBufAppendChar(&path, PS_PATH_SEP) ||
+        !StrBufAppendN(&path, name, nameLen) || !StrBufAppend(&path, suffix))
+        return NULL;
+    return path.data;
+}
+
+bool ResultCacheOpen(Arena* arena, const PSCHAR* stateDir, const uint8_t scriptSha[SHA256_DIGEST_SIZE],
+                     const PSCHAR* script, PSCHAR* const* params, int paramCount,
+                     uint32_t ttlSeconds, bool captureOutput, ResultCache* cache)
+{
+    PsMemSet(cache, 0, sizeof(*cache));
+    cache->temp = PLAT_INVALID_FILE;
+    cache->ttlSeconds = ttlSeconds;
+    cache->captureOutput = captureOutput;
+
+    // An entry without output must not answer a profile that wants it
+    uint8_t capture = captureOutput ? 1 : 0;
+    Sha256 ctx;
+    Sha256Init(&ctx);
+    Sha256Update(&ctx, scriptSha, SHA256_DIGEST_SIZE);
+    Sha256Update(&ctx, &capture, 1);
+    Sha256Update(&ctx, script, (PsStrLen(script) + 1) * sizeof(PSCHAR));
+    for (int i = 0; i < paramCount; i++)
+        HashParameter(&ctx, params[i]);
+    Sha256Final(&ctx, cache->key);
+
+    static const char hex[] = "0123456789abcdef";
+    PSCHAR name[33];
+    for (int i = 0; i < 16; i++)
+    {
+        name[i * 2] = (PSCHAR)hex[cache->key[i] >> 4];
+        name[i * 2 + 1] = (PSCHAR)hex[cache->key[i] & 15];
+    }
+    name[32] = 0;
+
+    StrBuf tempName;
+    cache->directory = JoinName(arena, stateDir, RESULT_DIRECTORY, PsStrLen(RESULT_DIRECTORY), PS_T(""));
+    if (!cache->directory || !StrBufInit(&tempName, arena, 64, STRBUF_NO_LIMIT) ||
+        !StrBufAppendN(&tempName, name, 32) || !StrBufAppend(&tempName, TEMP_SUFFIX) ||
+        !StrBufAppendUInt(&tempName, PlatMonotonicNanos()))
+        return false;
+    cache->entryPath = JoinName(arena, cache->directory, name, 32, ENTRY_SUFFIX);
+    cache->tempPath = JoinName(arena, cache->directory, tempName.data, tempName.len, PS_T(""));
+    return cache->entryPath && cache->tempPath;
+}
+
+//--------------------------------------------------------------------------
+// LOOKUP
+//--------------------------------------------------------------------------
+static bool SameKey(const uint8_t* a, const uint8_t* b)
+{
+    for (int i = 0; i < SHA256_DIGEST_SIZE; i++)
+    {
+        if (a[i] != b[i])
+            return false;
+    }
+    return true;
+}
+
+static bool SameFile(const PlatFileInfo* a, const PlatFileInfo* b)
+{
+    return a->volume == b->volume && a->fileId == b->fileId && a->size == b->size && a->mtime == b->mtime;
+}
+
+bool ResultCacheLookup(ResultCache* cache, uint64_t nowMillis, PlatFile replayTo, uint32_t* exitCode)
+{
+    // IDENTITY: Taken before the map, so a fresh entry renamed into place
+    // after it never matches what is read below
+    PlatFileInfo read;
+    if (!PlatGetFileInfo(cache->entryPath, &read))
+        return false;
+    size_t size = 0;
+    const uint8_t* view = (const uint8_t*)PlatMapFile(cache->entryPath, &size);
+    if (!view)
+        return false;
+
+    // The trailer follows output of any length, so it is copied out
+    ResultTrailer t;
+    bool valid = size >= sizeof(t);
+    if (valid)
+    {
+        PsMemCpy(&t, view + size - sizeof(t), sizeof(t));
+        valid = t.magic[0] == 'P' && t.magic[1] == 'S' && t.magic[2] == 'R' && t.magic[3] == 'C' &&
+                t.version == RESULT_VERSION && t.outputSize == size - sizeof(t) &&
+                SameKey(t.key, cache->key);
+    }
+
+    // Expired, or stored "in the future" after a clock change
+    bool live = valid && nowMillis >= t.storedMillis && nowMillis < t.expiresMillis;
+    if (live)
+    {
+        if (t.outputSize > 0 && replayTo != PLAT_INVALID_FILE)
+            PlatWriteFile(replayTo, view, (size_t)t.outputSize);
+        *exitCode = t.exitCode;
+    }
+    PlatUnmapFile(view, size);
+
+    // Another launcher may have published a fresh entry since: delete only
+    // the file that was read, and leave anything else to the trimmer
+    if (!live)
+    {
+        PlatFileInfo now;
+        if (size == read.size && PlatGetFileInfo(cache->entryPath, &now) && SameFile(&now, &read))
+            PlatDeleteFile(cache->entryPath);
+        return false;
+    }
+
+    // LRU: the last write time is the last use
+    PlatTouchFile(cache->entryPath);
+    return true;
+}
+
+//--------------------------------------------------------------------------
+// STORE
+//--------------------------------------------------------------------------
+PlatFile ResultCacheBeginCapture(ResultCache* cache)
+{
+    PlatCreateDirectory(cache->directory);
+    cache->temp = PlatCreateFile(cache->tempPath, PLAT_FILE_OVERWRITE);
+    return cache->temp;
+}
+
+void ResultCacheAbort(ResultCache* cache)
+{
+    if (cache->temp != PLAT_INVALID_FILE)
+    {
+        PlatCloseFile(cache->temp);
+        cache->temp = PLAT_INVALID_FILE;
+        PlatDeleteFile(cache->tempPath);
+    }
+}
+
+bool ResultCacheStore(Arena* arena, ResultCache* cache, uint32_t exitCode, uint64_t nowMillis,
+                      PlatFile replayTo)
+{
+    //----------------------------------------------------------------------
+    // CAPTURED OUTPUT - To the caller first, whether or not it is kept
+    //----------------------------------------------------------------------
+    uint64_t outputSize = 0;
+    if (cache->temp != PLAT_INVALID_FILE)
+    {
+        PlatCloseFile(cache->temp);
+        cache->temp = PLAT_INVALID_FILE;
+        PlatFileInfo info;
+        if (!PlatGetFileInfo(cache->tempPath, &info))
+            return false;
+        outputSize = info.size;
+
+        size_t size = 0;
+        const void* view = PlatMapFile(cache->tempPath, &size);
+        if (view)
+        {
+            if (replayTo != PLAT_INVALID_FILE)
+                PlatWriteFile(replayTo, view, size);
+            PlatUnmapFile(view, size);
+        }
+        if (outputSize > RESULT_MAX_OUTPUT || size != outputSize)
+        {
+            PlatDeleteFile(cache->tempPath);
+            return false;
+        }
+    }
+    else
+    {
+        PlatCreateDirectory(cache->directory);
+    }
+
+    //----------------------------------------------------------------------
+    // PUBLISH - Trailer last, then one rename
+    //----------------------------------------------------------------------
+    ResultTrailer t;
+    PsMemSet(&t, 0, sizeof(t));
+    PsMemCpy(t.key, cache->key, SHA256_DIGEST_SIZE);
+    t.outputSize = outputSize;
+    t.storedMillis = nowMillis;
+    t.expiresMillis = nowMillis + (uint64_t)cache->ttlSeconds * 1000;
+    t.exitCode = exitCode;
+    t.version = RESULT_VERSION;
+    t.magic[0] = 'P';
+    t.magic[1] = 'S';
+    t.magic[2] = 'R';
+    t.magic[3] = 'C';
+
+    PlatFile file = PlatCreateFile(cache->tempPath, outputSize ? PLAT_FILE_APPEND : PLAT_FILE_OVERWRITE);
+    if (file == PLAT_INVALID_FILE)
+    {
+        PlatDeleteFile(cache->tempPath);
+        return false;
+    }
+    bool ok = PlatWriteFile(file, &t, sizeof(t));
+    PlatCloseFile(file);
+    ok = ok && PlatRenameFile(cache->tempPath, cache->entryPath);
+    if (!ok)
+    {
+        PlatDeleteFile(cache->tempPath);
+        return false;
+    }
+
+    ArenaMark mark = ArenaSave(arena);
+    ResultCacheTrim(arena, cache->directory, RESULT_CACHE_LIMIT);
+    ArenaRestore(arena, mark);
+    return true;
+}
+
+//--------------------------------------------------------------------------
+// TRIM - Least recently used first
+//--------------------------------------------------------------------------
+typedef struct CacheFile
+{
+    PSCHAR* path;
+    uint64_t size;
+    uint64_t used;                   // Last write time
+} CacheFile;
+
+typedef struct TrimCtx
+{
+    Arena* arena;
+    const PSCHAR* directory;
+    CacheFile* files;
+    uint32_t count;
+    uint32_t capacity;
+    uint64_t total;
+    uint32_t deleted;
+    uint64_t now;
+    bool failed;
+} TrimCtx;
+
+static bool EndsWith(const PSCHAR* name, size_t nameLen, const PSCHAR* suffix)
+{
+    size_t len = PsStrLen(suffix);
+    if (nameLen <= len)
+        return false;
+    for (size_t i = 0; i < len; i++)
+    {
+        if (name[nameLen - len + i] != suffix[i])
+            return false;
+    }
+    return true;
+}
+
+static bool HasTempSuffix(const PSCHAR* name, size_t nameLen)
+{
+    // "<key>.tmp<nanos>"
+    for (size_t i = 0; i + 4 <= nameLen; i++)
+    {
+        if (name[i] == PS_T('.') && name[i + 1] == PS_T('t') && name[i + 2] == PS_T('m') &&
+            name[i + 3] == PS_T('p'))
+            return true;
+    }
+    return false;
+}
+
+static bool OnCacheFile(void* ctx, const PSCHAR* name, size_t nameLen, PlatEntryType type)
+{
+    TrimCtx* t = (TrimCtx*)ctx;
+    if (type != PLAT_ENTRY_FILE)
+        return true;
+    bool isEntry = EndsWith(name, nameLen, ENTRY_SUFFIX);
+    if (!isEntry && !HasTempSuffix(name, nameLen))
+        return true;
+
+    PSCHAR* path = JoinName(t->arena, t->directory, name, nameLen, PS_T(""));
+    PlatFileInfo info;
+    if (!path || !PlatGetFileInfo(path, &info))
+        return true;
+    if (!isEntry)
+    {
+        if (info.mtime + ABANDONED_TEMP < t->now && PlatDeleteFile(path))
+            t->deleted++;
+        return true;
+    }
+
+    if (t->count == t->capacity)
+    {
+        uint32_t capacity = t->capacity ? t->capacity * 2 : 64;
+        CacheFile* grown = (CacheFile*)ArenaAlloc(t->arena, capacity * sizeof(CacheFile));
+        if (!grown)
+        {
+            t->failed = true;
+            return false;
+        }
+        if (t->count)
+            PsMemCpy(grown, t->files, t->count * sizeof(CacheFile));
+        t->files = grown;
+        t->capacity = capacity;
+    }
+    t->files[t->count].path = path;
+    t->files[t->count].size = info.size;
+    t->files[t->count].used = info.mtime;
+    t->count++;
+    t->total += info.size;
+    return true;
+}
+
+// Heap sort by last use: no recursion, O(n log n) worst case
+static void SiftDown(CacheFile* a, size_t root, size_t count)
+{
+    for (;;)
+    {
+        size_t child = root * 2 + 1;
+        if (child >= count)
+            return;
+        if (child + 1 < count && a[child + 1].used > a[child].used)
+            child++;
+        if (a[root].used >= a[child].used)
+            return;
+        CacheFile t = a[root];
+        a[root] = a[child];
+        a[child] = t;
+        root = child;
+    }
+}
+
+static void SortByUse(CacheFile* a, size_t count)
+{
+    for (size_t i = count / 2; i > 0; i--)
+        SiftDown(a, i - 1, count);
+    for (size_t end = count; end > 1; end--)
+    {
+        CacheFile t = a[0];
+        a[0] = a[end - 1];
+        a[end - 1] = t;
+        SiftDown(a, 0, end - 1);
+    }
+}
+
+uint32_t ResultCacheTrim(Arena* arena, const PSCHAR* directory, uint64_t limit)
+{
+    TrimCtx t;
+    PsMemSet(&t, 0, sizeof(t));
+    t.arena = arena;
+    t.directory = directory;
+    t.now = PlatFileTimeNow();
+    if (!PlatListDirectory(directory, OnCacheFile, &t) || t.failed || t.total <= limit)
+        return t.deleted;
+
+    // Another launcher may be trimming too; an entry it already deleted
+    // still counts as gone
+    SortByUse(t.files, t.count);
+    for (uint32_t i = 0; i < t.count && t.total > limit; i++)
+    {
+        PlatDeleteFile(t.files[i].path);
+        t.total -= t.files[i].size;
+        t.deleted++;
+    }
+    return t.deleted;
+}
@@ -0,0 +1,87 @@
+//--------------------------------------------------------------------------
+// RESULT CACHE - Reuse recent results of read-only scripts
+//--------------------------------------------------------------------------
+// A catalogue profile with "cache <profile> <seconds> [stdout]" marks its
+// scripts as idempotent for that long. A launch looks for an entry keyed
+// by the script's content hash, its path and the normalised parameters
+// (parameter names folded to lowercase, values exact); on a hit the
+// recorded exit code - and with "stdout" the recorded output - is
+// returned without starting PowerShell.
+//
+// Entries are files in <state directory>/results, one per key:
+//   output bytes, then a ResultTrailer
+// The child writes its stdout straight into a temporary file, the trailer
+// is appended after it exits, and the file is renamed into place. Readers
+// map a whole entry and check the trailer, so concurrent launchers see a
+// complete entry or none, never a torn one. A hit sets the entry's last
+// write time, and after each publication the least recently used entries
+// are deleted until the directory is under RESULT_CACHE_LIMIT bytes.
+
+#ifndef PS_RESULTCACHE_H
+#define PS_RESULTCACHE_H
+
+#include "arena.h"
+#include "platform.h"
+#include "pstypes.h"
+#include "sha256.h"
+
+PS_EXTERN_C_BEGIN
+
+#define RESULT_DIRECTORY   PS_T("results")
+#define RESULT_VERSION     1
+#define RESULT_CACHE_LIMIT ((uint64_t)64 << 20)   // All entries together
+#define RESULT_MAX_OUTPUT  ((uint64_t)8 << 20)    // Larger outputs are not kept
+
+typedef struct ResultTrailer
+{
+    uint8_t key[SHA256_DIGEST_SIZE]; // Full key; the file name holds half
+    uint64_t outputSize;             // Bytes before the trailer
+    uint64_t storedMillis;           // Wall clock
+    uint64_t expiresMillis;
+    uint32_t exitCode;
+    uint32_t version;
+    char magic[4];                   // "PSRC", last so a short write fails it
+    uint32_t reserved;
+} ResultTrailer;
+
+typedef struct ResultCache
+{
+    uint8_t key[SHA256_DIGEST_SIZE];
+    const PSCHAR* directory;         // <state>/results
+    const PSCHAR* entryPath;
+    const PSCHAR* tempPath;          // While capturing
+    PlatFile temp;
+    uint32_t ttlSeconds;
+    bool captureOutput;
+} ResultCache;
+
+// Key over the script's content hash, its path and the parameters, and
+// the entry paths under stateDir
+bool ResultCacheOpen(Arena* arena, const PSCHAR* stateDir, const uint8_t scriptSha[SHA256_DIGEST_SIZE],
+                     const PSCHAR* script, PSCHAR* const* params, int paramCount,
+                     uint32_t ttlSeconds, bool captureOutput, ResultCache* cache);
+
+// Live entry for the key: its output goes to replayTo (if valid) and its
+// exit code to exitCode. Expired and damaged entries are deleted unless
+// the path no longer names the file that was read.
+bool ResultCacheLookup(ResultCache* cache, uint64_t nowMillis, PlatFile replayTo, uint32_t* exitCode);
+
+// Temporary file for the child's stdout (PlatSpawnToFile)
+PlatFile ResultCacheBeginCapture(ResultCache* cache);
+
+// After the run: replay captured output to replayTo, then publish the
+// entry and trim the directory. Without a capture only the exit code is
+// stored.
+bool ResultCacheStore(Arena* arena, ResultCache* cache, uint32_t exitCode, uint64_t nowMillis,
+                      PlatFile replayTo);
+
+// Drop a capture that will not be stored (the spawn failed)
+void ResultCacheAbort(ResultCache* cache);
+
+// Delete least recently used entries until the directory holds at most
+// limit bytes; returns the number deleted
+uint32_t ResultCacheTrim(Arena* arena, const PSCHAR* directory, uint64_t limit);
+
+PS_EXTERN_C_END
+
+#endif // PS_RESULTCACHE_H
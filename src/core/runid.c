@@ -0,0 +1,168 @@
+//--------------------------------------------------------------------------
+// RUN IDS - Time-ordered correlation ids, ULID style
+//--------------------------------------------------------------------------
+#include "runid.h"
+#include "platform.h"
+#include "psstr.h"
+
+static const char g_alphabet[33] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+
+// SplitMix64: one add and a finaliser per 64 bits
+static uint64_t Mix(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static uint64_t NextRandom(RunIdSource* source)
+{
+    source->state += 0x9E3779B97F4A7C15ull;
+    return Mix(source->state);
+}
+
+void RunIdSeed(RunIdSource* source)
+{
+    uint64_t seed = Mix(PlatCurrentProcessId());
+    seed = Mix(seed ^ PlatMonotonicNanos());
+    seed = Mix(seed ^ PlatWallClockMillis());
+    source->state = Mix(seed ^ (uint64_t)(uintptr_t)source);
+    source->lastMillis = 0;
+    source->last.high = 0;
+    source->last.low = 0;
+}
+
+RunId RunIdNext(RunIdSource* source, uint64_t unixMillis)
+{
+    RunId id;
+    if (RunIdIsSet(&source->last) && unixMillis <= source->lastMillis)
+    {
+        // SAME MILLISECOND: Or the clock went back; order is kept by
+        // counting up from the last id (a carry reaches the timestamp)
+        id = source->last;
+        if (++id.low == 0)
+            id.high++;
+    }
+    else
+    {
+        id.high = (unixMillis & 0xFFFFFFFFFFFFull) << 16 | (NextRandom(source) & 0xFFFF);
+        id.low = NextRandom(source);
+        source->lastMillis = unixMillis;
+    }
+    source->last = id;
+    return id;
+}
+
+// 130 bits in 26 characters; the top two are always zero
+static void Encode(const RunId* id, char* out)
+{
+    uint64_t high = id->high, low = id->low;
+    for (int i = RUN_ID_CHARS - 1; i >= 0; i--)
+    {
+        out[i] = g_alphabet[low & 31];
+        low = (low >> 5) | (high << 59);
+        high >>= 5;
+    }
+}
+
+void RunIdFormat8(const RunId* id, char* out)
+{
+    if (!RunIdIsSet(id))
+    {
+        out[0] = '-';
+        out[1] = 0;
+        return;
+    }
+    Encode(id, out);
+    out[RUN_ID_CHARS] = 0;
+}
+
+void RunIdFormat(const RunId* id, PSCHAR* out)
+{
+    char text[RUN_ID_CHARS + 1];
+    RunIdFormat8(id, text);
+    for (size_t i = 0; i <= RUN_ID_CHARS; i++)
+    {
+        out[i] = (PSCHAR)text[i];
+        if (!text[i])
+            break;
+    }
+}
+
+// Crockford: either case, and the look-alikes I, L (1) and O (0)
+static int Digit(PSCHAR c)
+{
+    if (c >= PS_T('a') && c <= PS_T('z'))
+        c = (PSCHAR)(c - (PS_T('a') - PS_T('A')));
+    if (c == PS_T('I') || c == PS_T('L'))
+        return 1;
+    if (c == PS_T('O'))
+        return 0;
+    for (int i = 0; i < 32; i++)
+    {
+        if ((PSCHAR)g_alphabet[i] == c)
+            return i;
+    }
+    return -1;
+}
+
+bool RunIdParse(const PSCHAR* text, RunId* id)
+{
+    uint64_t high = 0, low = 0;
+    id->high = 0;
+    id->low = 0;
+    for (size_t i = 0; i < RUN_ID_CHARS; i++)
+    {
+        int digit = text[i] ? Digit(text[i]) : -1;
+        if (digit < 0 || (i == 0 && digit > 7))
+            return false;
+        high = (high << 5) | (low >> 59);
+        low = (low << 5) | (uint64_t)digit;
+    }
+    if (text[RUN_ID_CHARS] != 0)
+        return false;
+    id->high = high;
+    id->low = low;
+    return true;
+}
+
+static bool IdFromEnv(const PSCHAR* name, RunId* id)
+{
+    PSCHAR text[RUN_ID_CHARS + 2];
+    id->high = 0;
+    id->low = 0;
+    return PlatGetEnv(name, text, RUN_ID_CHARS + 2) && RunIdParse(text, id);
+}
+
+void RunIdBegin(RunIdSource* source, RunId* id, RunId* parent)
+{
+    RunIdSeed(source);
+    if (!IdFromEnv(RUN_ASSIGNED_ENV, id))
+        *id = RunIdNext(source, PlatWallClockMillis());
+    IdFromEnv(RUN_ID_ENV, parent);
+}
+
+// "NAME=<id>", or a bare "NAME", which BuildEnvironmentBlock removes
+static const PSCHAR* Variable(Arena* arena, const PSCHAR* name, const RunId* id)
+{
+    size_t size = PsStrLen(name) + RUN_ID_CHARS + 2;
+    PSCHAR* var = (PSCHAR*)ArenaAlloc(arena, size * sizeof(PSCHAR));
+    size_t pos = 0;
+    if (!var || !AppendStr(var, size, name, &pos))
+        return NULL;
+    if (id && RunIdIsSet(id))
+    {
+        var[pos++] = PS_T('=');
+        RunIdFormat(id, var + pos);
+    }
+    return var;
+}
+
+bool RunIdVariables(Arena* arena, const RunId* run, const RunId* parent, const RunId* assigned,
+                    const PSCHAR** vars)
+{
+    vars[0] = Variable(arena, RUN_ID_ENV, run);
+    vars[1] = Variable(arena, RUN_PARENT_ENV, parent);
+    vars[2] = Variable(arena, RUN_ASSIGNED_ENV, assigned);
+    return vars[0] && vars[1] && vars[2];
+}
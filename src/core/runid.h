@@ -0,0 +1,84 @@
+//--------------------------------------------------------------------------
+// RUN IDS - Time-ordered correlation ids, ULID style
+//--------------------------------------------------------------------------
+// Every launch gets a 128-bit id: 48 bits of wall-clock milliseconds, then
+// 80 random bits. As text it is 26 Crockford base32 characters, so ids
+// sort by the time they were made ("01HF3Q2V9X8K7M6N5P4R3S2T1V"). Within
+// one millisecond a source increments the random part, so ids made in one
+// process also sort in the order they were made.
+//
+// Ids are not secrets: the random bits come from a generator seeded once
+// per source with the pid, the clocks and an address, which is enough to
+// keep processes on one machine (and machines) apart, and costs a few
+// multiplies per id.
+//
+// The ids travel to children in the environment:
+// - PS_LAUNCHER_RUN_ID     the run the process belongs to. A script sees
+//                          its own launch; a launcher that finds one set
+//                          was started from inside that run: its parent.
+// - PS_LAUNCHER_PARENT_ID  the parent of PS_LAUNCHER_RUN_ID, if any.
+// - PS_LAUNCHER_ASSIGNED_ID  set by a starter that needs to know the id of
+//                          the launch it starts (-Serve); that launcher
+//                          takes it as its own and removes it.
+// The journal, trace and metrics record the same ids, so a workflow is
+// reassembled by following parent ids.
+
+#ifndef PS_RUNID_H
+#define PS_RUNID_H
+
+#include "arena.h"
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+#define RUN_ID_CHARS      26
+#define RUN_ID_ENV        PS_T("PS_LAUNCHER_RUN_ID")
+#define RUN_PARENT_ENV    PS_T("PS_LAUNCHER_PARENT_ID")
+#define RUN_ASSIGNED_ENV  PS_T("PS_LAUNCHER_ASSIGNED_ID")
+#define RUN_ID_VARS       3              // Overrides RunIdVariables writes
+
+typedef struct RunId
+{
+    uint64_t high;         // Milliseconds << 16, then 16 random bits
+    uint64_t low;          // 64 random bits
+} RunId;                   // All zero: no id
+
+typedef struct RunIdSource
+{
+    uint64_t state;        // Generator
+    uint64_t lastMillis;
+    RunId last;
+} RunIdSource;
+
+static inline bool RunIdIsSet(const RunId* id)
+{
+    return (id->high | id->low) != 0;
+}
+
+// Seed a source; one per thread that makes ids
+void RunIdSeed(RunIdSource* source);
+
+// A new id at unixMillis, after every id the source made before
+RunId RunIdNext(RunIdSource* source, uint64_t unixMillis);
+
+// 26 characters and a terminator; "-" for no id
+void RunIdFormat(const RunId* id, PSCHAR* out);
+void RunIdFormat8(const RunId* id, char* out);
+
+// Upper or lower case; false (and no id) unless exactly one id
+bool RunIdParse(const PSCHAR* text, RunId* id);
+
+// This process's run: the id a starter assigned or a new one, and the run
+// it was started from (PS_LAUNCHER_RUN_ID), or no parent
+void RunIdBegin(RunIdSource* source, RunId* id, RunId* parent);
+
+// The environment a child of run sees: PS_LAUNCHER_RUN_ID=run,
+// PS_LAUNCHER_PARENT_ID=parent and PS_LAUNCHER_ASSIGNED_ID=assigned, each
+// removed when NULL or unset. Writes RUN_ID_VARS entries to vars for
+// BuildEnvironmentBlock.
+bool RunIdVariables(Arena* arena, const RunId* run, const RunId* parent, const RunId* assigned,
+                    const PSCHAR** vars);
+
+PS_EXTERN_C_END
+
+#endif // PS_RUNID_H
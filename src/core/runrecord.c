@@ -0,0 +1,80 @@
+//--------------------------------------------------------------------------
+// RUN RECORDS - One journal line per launch
+//--------------------------------------------------------------------------
+#include "runrecord.h"
+#include "platform.h"
+#include "psstr.h"
+
+const PSCHAR* RunStatusText(RunStatus status)
+{
+    switch (status)
+    {
+    case RUN_COMPLETED:    return PS_T("completed");
+    case RUN_USAGE:        return PS_T("usage");
+    case RUN_NOT_FOUND:    return PS_T("not-found");
+    case RUN_BLOCKED:      return PS_T("blocked");
+    case RUN_OVERFLOW:     return PS_T("overflow");
+    case RUN_SPAWN_FAILED: return PS_T("spawn-failed");
+    case RUN_STALE:        return PS_T("stale");
+    case RUN_UP_TO_DATE:   return PS_T("up-to-date");
+    case RUN_CACHED:       return PS_T("cached");
+    case RUN_OVERLAP:      return PS_T("overlap");
+    case RUN_CANCELLED:    return PS_T("cancelled");
+    default:               return PS_T("unknown");
+    }
+}
+
+bool FormatRunRecord(const RunRecord* record, StrBuf* sb)
+{
+    const PSCHAR* script = record->script ? record->script : PS_T("");
+    PSCHAR id[RUN_ID_CHARS + 1], parent[RUN_ID_CHARS + 1];
+    RunIdFormat(&record->id, id);
+    RunIdFormat(&record->parent, parent);
+    return StrBufAppendUInt(sb, record->startMillis)
+        && StrBufAppendChar(sb, PS_T('\t'))
+        && StrBufAppendUInt(sb, record->durationMicros)
+        && StrBufAppendChar(sb, PS_T('\t'))
+        && StrBufAppendUInt(sb, record->exitCode)
+        && StrBufAppendChar(sb, PS_T('\t'))
+        && StrBufAppend(sb, RunStatusText(record->status))
+        && StrBufAppendChar(sb, PS_T('\t'))
+        && StrBufAppend(sb, id)
+        && StrBufAppendChar(sb, PS_T('\t'))
+        && StrBufAppend(sb, parent)
+        && StrBufAppendChar(sb, PS_T('\t'))
+        && StrBufAppend(sb, script)
+        && StrBufAppendChar(sb, PS_T('\n'));
+}
+
+#ifdef ENABLE_RUN_JOURNAL
+
+void AppendRunRecord(const RunRecord* record, Arena* arena)
+{
+    PSCHAR path[PS_MAX_PATH];
+    size_t pos;
+    ArenaMark mark = ArenaSave(arena);
+    StrBuf line;
+
+    if (!PlatGetStateDirectory(path, PS_MAX_PATH))
+        return;
+    pos = PsStrLen(path);
+    if (!AppendChar(path, PS_MAX_PATH, PS_PATH_SEP, &pos) ||
+        !AppendStr(path, PS_MAX_PATH, PS_T("ps-launcher.runs"), &pos))
+        return;
+
+    if (StrBufInit(&line, arena, 256, STRBUF_NO_LIMIT) && FormatRunRecord(record, &line))
+    {
+        char* utf8 = (char*)ArenaAlloc(arena, line.len * 3);
+        size_t utf8Len = utf8 ? PlatToUtf8(line.data, line.len, utf8, line.len * 3) : 0;
+        PlatFile file = utf8Len ? PlatCreateFile(path, PLAT_FILE_APPEND) : PLAT_INVALID_FILE;
+        if (file != PLAT_INVALID_FILE)
+        {
+            // SINGLE WRITE: One append per record keeps concurrent writers apart
+            PlatWriteFile(file, utf8, utf8Len);
+            PlatCloseFile(file);
+        }
+    }
+    ArenaRestore(arena, mark);
+}
+
+#endif // ENABLE_RUN_JOURNAL
@@ -0,0 +1,67 @@
+//--------------------------------------------------------------------------
+// RUN RECORDS - One journal line per launch
+//--------------------------------------------------------------------------
+// Unlike ps-launcher.log (overwritten each run), the run journal
+// <state directory>/ps-launcher.runs is append-only. Each record is one
+// tab-separated UTF-8 line written with a single append, so concurrent
+// launchers never interleave:
+//
+//   <start ms since 1970> \t <duration us> \t <exit code> \t <status> \t
+//   <run id> \t <parent run id or -> \t <script>
+//
+// Run ids (runid.h) are the ones the script saw in PS_LAUNCHER_RUN_ID and
+// PS_LAUNCHER_PARENT_ID.
+
+#ifndef PS_RUNRECORD_H
+#define PS_RUNRECORD_H
+
+#include "arena.h"
+#include "config.h"
+#include "pstypes.h"
+#include "runid.h"
+#include "strbuf.h"
+
+PS_EXTERN_C_BEGIN
+
+typedef enum RunStatus
+{
+    RUN_COMPLETED = 0,     // Interpreter ran; exitCode is the script's
+    RUN_USAGE,             // Bad launcher arguments
+    RUN_NOT_FOUND,         // Interpreter or script missing
+    RUN_BLOCKED,           // Parameter rejected by policy
+    RUN_OVERFLOW,          // Command line too long
+    RUN_SPAWN_FAILED,      // Process creation failed; exitCode is the OS error
+    RUN_STALE,             // Catalogue script changed since it was indexed
+    RUN_UP_TO_DATE,        // Inputs unchanged; exitCode is the recorded run's
+    RUN_CACHED,            // Served from the result cache; exitCode is the cached one
+    RUN_OVERLAP,           // Scheduled run skipped, the previous one was still going
+    RUN_CANCELLED          // Engine run cancelled by its host (PslCancel); exitCode as killed
+} RunStatus;
+
+typedef struct RunRecord
+{
+    const PSCHAR* script;
+    uint64_t startMillis;
+    uint64_t durationMicros;
+    uint32_t exitCode;
+    RunStatus status;
+    RunId id;
+    RunId parent;          // Unset: started from outside any run
+} RunRecord;
+
+// Short lowercase name of a status ("completed", "spawn-failed", ...)
+const PSCHAR* RunStatusText(RunStatus status);
+
+// Append one journal line, including the trailing newline, to sb
+bool FormatRunRecord(const RunRecord* record, StrBuf* sb);
+
+#ifdef ENABLE_RUN_JOURNAL
+// Append a record to the run journal (best-effort, scratch space on arena)
+void AppendRunRecord(const RunRecord* record, Arena* arena);
+#else
+    #define AppendRunRecord(record, arena) ((void)0)
+#endif
+
+PS_EXTERN_C_END
+
+#endif // PS_RUNRECORD_H
@@ -0,0 +1,606 @@
+//--------------------------------------------------------------------------
+// RESIDENT SCHEDULER - One long-lived launcher firing scheduled runs
+//--------------------------------------------------------------------------
+#include "scheduler.h"
+#include "args.h"
+#include "catalog.h"
+#include "config.h"
+#include "encoding.h"
+#include "envblock.h"
+#include "log.h"
+#include "psmem.h"
+#include "psstr.h"
+#include "quote.h"
+#include "runid.h"
+#include "runrecord.h"
+#include "strbuf.h"
+
+// Runs still going when their entry left the schedule; reaped on each wake
+#define SCHEDULE_MAX_ORPHANS 64
+
+typedef struct Orphan
+{
+    PlatProcess run;
+    ResourceClaim claim;             // Held until it exits
+} Orphan;
+
+//--------------------------------------------------------------------------
+// PARSING
+//--------------------------------------------------------------------------
+static PSCHAR* SkipBlanks(PSCHAR* p)
+{
+    while (*p == PS_T(' ') || *p == PS_T('\t'))
+        p++;
+    return p;
+}
+
+// Terminate the token at p; returns the start of the next one
+static PSCHAR* CutToken(PSCHAR* p)
+{
+    while (*p && *p != PS_T(' ') && *p != PS_T('\t'))
+        p++;
+    if (*p)
+        *p++ = 0;
+    return SkipBlanks(p);
+}
+
+// "90", "90s", "15m", "2h"
+static bool ParseInterval(const PSCHAR* s, uint32_t* seconds)
+{
+    uint64_t value = 0;
+    if (*s < PS_T('0') || *s > PS_T('9'))
+        return false;
+    while (*s >= PS_T('0') && *s <= PS_T('9') && value <= SCHEDULE_MAX_EVERY)
+        value = value * 10 + (uint64_t)(*s++ - PS_T('0'));
+    switch (*s | 0x20)
+    {
+    case 'h': value *= 3600; s++; break;
+    case 'm': value *= 60;   s++; break;
+    case 's': s++;               break;
+    default:                     break;
+    }
+    *seconds = (uint32_t)value;
+    return *s == 0 && value > 0 && value <= SCHEDULE_MAX_EVERY;
+}
+
+static bool ParseEntry(PSCHAR* p, ScheduleEntry* e)
+{
+    PSCHAR* fields[CRON_FIELDS];
+    int needed = p[0] != PS_T('@') ? CRON_FIELDS : 1;
+    for (int i = 0; i < needed && *p; i++)
+    {
+        fields[i] = p;
+        p = CutToken(p);
+        if (i == 0 && PsStrCmpI(fields[0], PS_T("@every")) == 0)
+            needed = 2;
+    }
+    if (*p == 0)
+        return false;
+
+    // QUEUE: A class and "within <interval>" may come before the arguments
+    e->cls = JOB_NORMAL;
+    for (;;)
+    {
+        PSCHAR* word = p;
+        PSCHAR* rest = CutToken(p);
+        JobClass cls;
+        if (*rest && JobParseClass(word, &cls))
+        {
+            e->cls = cls;
+            p = rest;
+        }
+        else if (*rest && PsStrCmpI(word, PS_T("within")) == 0)
+        {
+            p = CutToken(rest);
+            if (*p == 0 || !ParseInterval(rest, &e->withinSeconds))
+                return false;
+        }
+        else
+            break;
+    }
+
+    // SECURITY CHECK: Entries run launches, never a resident launcher
+    PSCHAR* args = p;
+    size_t first = 0;
+    while (args[first] && args[first] != PS_T(' ') && args[first] != PS_T('\t'))
+        first++;
+    PSCHAR saved = args[first];
+    args[first] = 0;
+    bool nested = IsResidentMode(args);
+    args[first] = saved;
+    if (nested)
+        return false;
+
+    e->args = e->line + (args - fields[0]);
+    if (needed == 2)
+        return ParseInterval(fields[1], &e->everySeconds);
+    if (needed == 1)
+        return CronParseMacro(fields[0], &e->cron);
+    return CronParse(fields, &e->cron);
+}
+
+bool ParseSchedule(Arena* arena, PSCHAR* text, size_t len, Schedule* schedule)
+{
+    uint32_t lines = 1;
+    for (size_t i = 0; i < len; i++)
+    {
+        if (text[i] == PS_T('\n'))
+        {
+            text[i] = 0;
+            lines++;
+        }
+        else if (text[i] == PS_T('\r'))
+            text[i] = PS_T(' ');        // Trimmed with the other trailing blanks
+    }
+
+    schedule->count = 0;
+    schedule->entries = (ScheduleEntry*)ArenaAlloc(arena, sizeof(ScheduleEntry) * lines);
+    if (!schedule->entries)
+        return false;
+
+    uint32_t lineNumber = 0;
+    PSCHAR* next;
+    for (PSCHAR* line = text; line < text + len + 1; line = next)
+    {
+        // Parsing cuts the line up, so find the next one first
+        next = line + PsStrLen(line) + 1;
+        lineNumber++;
+        PSCHAR* p = SkipBlanks(line);
+        if (*p == 0 || *p == PS_T('#'))
+            continue;
+
+        // Keep the line as written (without trailing blanks) before the
+        // fields are cut out of it
+        size_t lineLen = PsStrLen(p);
+        while (lineLen > 0 && (p[lineLen - 1] == PS_T(' ') || p[lineLen - 1] == PS_T('\t')))
+            p[--lineLen] = 0;
+        PSCHAR* copy = (PSCHAR*)ArenaAlloc(arena, (lineLen + 1) * sizeof(PSCHAR));
+        if (!copy)
+            return false;
+        PsMemCpy(copy, p, (lineLen + 1) * sizeof(PSCHAR));
+
+        ScheduleEntry* e = &schedule->entries[schedule->count];
+        PsMemSet(e, 0, sizeof(*e));
+        e->queued.slot = JOB_NOT_QUEUED;
+        e->line = copy;
+        e->lineNumber = lineNumber;
+        if (!ParseEntry(p, e))
+        {
+            LogNumber(PS_T("ERROR: Invalid schedule line "), lineNumber);
+            LogWrite(copy);
+            return false;
+        }
+        schedule->count++;
+    }
+    return true;
+}
+
+//--------------------------------------------------------------------------
+// OCCURRENCES
+//--------------------------------------------------------------------------
+uint64_t ScheduleNextRun(const ScheduleEntry* entry, uint64_t nowSeconds)
+{
+    if (entry->everySeconds)
+        return nowSeconds + entry->everySeconds;
+
+    // Cron fields are local time: match on the local calendar, then map
+    // back with the offset in force at the result (daylight saving). A
+    // result that is not ahead - the repeated hour after clocks go back -
+    // moves on to the following match.
+    int32_t offset = PlatLocalOffsetMinutes(nowSeconds * 1000);
+    int64_t local = (int64_t)(nowSeconds / 60) + offset;
+    for (int attempt = 0; attempt < 4; attempt++)
+    {
+        int64_t next;
+        if (!CronNext(&entry->cron, local, &next))
+            return 0;
+        int32_t then = PlatLocalOffsetMinutes((uint64_t)(next - offset) * 60000);
+        uint64_t at = (uint64_t)(next - then) * 60;
+        if (at > nowSeconds)
+            return at;
+        local = next;
+    }
+    return 0;
+}
+
+//--------------------------------------------------------------------------
+// RESIDENT LOOP
+//--------------------------------------------------------------------------
+typedef struct Scheduler
+{
+    const PSCHAR* path;
+    PSCHAR self[PS_MAX_PATH];
+    Arena entries;                   // Current schedule; replaced on reload
+    Schedule schedule;
+    PlatFileInfo stamp;
+    TimerWheel* wheel;
+    JobQueue queue;                  // Occurrences waiting for a run slot
+    ResourceTable resources;         // ...or, popped, for their tags
+    Governor governor;
+    ScheduleEntry* active[SCHEDULE_MAX_RUNNING];
+    uint32_t activeCount;
+    Orphan orphans[SCHEDULE_MAX_ORPHANS];
+    uint32_t orphanCount;
+    RunIdSource ids;
+    RunId session;                   // Parent of every run fired
+    RunId parent;
+    const PSCHAR* envBlock;          // PS_LAUNCHER_RUN_ID=session; NULL: ours
+} Scheduler;
+
+// Runs that never started are journaled here, as children of the session
+static void Journal(Scheduler* s, Arena* arena, const ScheduleEntry* e, RunStatus status, uint32_t exitCode)
+{
+#ifdef ENABLE_RUN_JOURNAL
+    RunRecord record = { 0 };
+    record.script = e->args;
+    record.startMillis = PlatWallClockMillis();
+    record.status = status;
+    record.exitCode = exitCode;
+    record.id = RunIdNext(&s->ids, record.startMillis);
+    record.parent = s->session;
+    AppendRunRecord(&record, arena);
+#else
+    (void)s;
+    (void)arena;
+    (void)e;
+    (void)status;
+    (void)exitCode;
+#endif
+}
+
+static bool SameText(const PSCHAR* a, const PSCHAR* b)
+{
+    while (*a && *a == *b)
+    {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+static void Adopt(Scheduler* s, ScheduleEntry* e)
+{
+    if (s->orphanCount < SCHEDULE_MAX_ORPHANS)
+    {
+        s->orphans[s->orphanCount].run = e->run;
+        s->orphans[s->orphanCount++].claim = e->claim;
+        return;
+    }
+    ResourceRelease(&s->resources, &e->claim);
+    PlatCloseProcess(&e->run);          // Left to run unwatched
+}
+
+// Runs that have exited give up their slots
+static void Reap(Scheduler* s)
+{
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < s->activeCount; i++)
+    {
+        ScheduleEntry* e = s->active[i];
+        uint32_t code;
+        if (PlatPollProcess(&e->run, &code))
+        {
+            GovernorRelease(&e->govern);
+            ResourceRelease(&s->resources, &e->claim);
+            PlatCloseProcess(&e->run);
+            e->running = false;
+        }
+        else
+            s->active[kept++] = e;
+    }
+    s->activeCount = kept;
+
+    kept = 0;
+    for (uint32_t i = 0; i < s->orphanCount; i++)
+    {
+        uint32_t code;
+        if (PlatPollProcess(&s->orphans[i].run, &code))
+        {
+            ResourceRelease(&s->resources, &s->orphans[i].claim);
+            PlatCloseProcess(&s->orphans[i].run);
+        }
+        else
+            s->orphans[kept++] = s->orphans[i];
+    }
+    s->orphanCount = kept;
+}
+
+// The new entry an old one's run or queued occurrence carries over to
+static ScheduleEntry* Successor(Schedule* schedule, const ScheduleEntry* old)
+{
+    for (uint32_t j = 0; j < schedule->count; j++)
+    {
+        ScheduleEntry* e = &schedule->entries[j];
+        if (!e->running && !JobQueued(&e->queued) && SameText(e->line, old->line))
+            return e;
+    }
+    return NULL;
+}
+
+static bool Enqueue(JobQueue* queue, ScheduleEntry* e, uint64_t deadline)
+{
+    return JobQueuePush(queue, &e->queued, e->cls, deadline, JobSubmitterKey(e->line, PsStrLen(e->line)), 1);
+}
+
+// Read and parse the file into a fresh arena, carry runs in progress and
+// waiting occurrences over to identical lines, and rebuild the wheel. The
+// old schedule stays if the new one does not parse.
+static bool LoadSchedule(Scheduler* s, uint64_t nowSeconds)
+{
+    PlatFileInfo stamp;
+    Arena next;
+    Schedule schedule;
+    JobQueue queue;
+    if (!PlatGetFileInfo(s->path, &stamp) || !ArenaInit(&next, ARENA_DEFAULT_RESERVE))
+        return false;
+
+    size_t len = 0;
+    PSCHAR* text = ArenaReadText(&next, s->path, SCHEDULE_MAX_SOURCE, &len);
+    if (!text || !ParseSchedule(&next, text, len, &schedule) || !JobQueueInit(&queue, &next, schedule.count))
+    {
+        if (!text)
+            LogFormat(PS_T("ERROR: Cannot read schedule: %s"), s->path);
+        ArenaRelease(&next);
+        s->stamp = stamp;               // Not again until it changes
+        return false;
+    }
+
+    Reap(s);
+    uint32_t activeCount = 0;
+    for (uint32_t i = 0; s->entries.base && i < s->schedule.count; i++)
+    {
+        ScheduleEntry* old = &s->schedule.entries[i];
+        bool waiting = ResourceWaiting(&old->claim);
+        if (!old->running && !JobQueued(&old->queued) && !waiting)
+            continue;
+        ScheduleEntry* e = Successor(&schedule, old);
+        if (old->running && e)
+        {
+            e->run = old->run;
+            e->govern = old->govern;
+            e->claim = old->claim;          // Held, so in no line
+            e->running = true;
+            s->active[activeCount++] = e;
+        }
+        else if (old->running)
+        {
+            GovernorRelease(&old->govern);
+            Adopt(s, old);
+        }
+        else
+        {
+            // WAITING FOR TAGS: Out of line, and queued again like the rest
+            ResourceRelease(&s->resources, &old->claim);
+            if (e)
+                Enqueue(&queue, e, old->queued.deadline);
+        }
+    }
+
+    TimerWheelInit(s->wheel, nowSeconds);
+    for (uint32_t i = 0; i < schedule.count; i++)
+    {
+        ScheduleEntry* e = &schedule.entries[i];
+        uint64_t at = ScheduleNextRun(e, nowSeconds);
+        if (at)
+            TimerWheelAdd(s->wheel, &e->timer, at);
+        else
+            LogNumber(PS_T("WARNING: Schedule line never matches: "), e->lineNumber);
+    }
+
+    if (s->entries.base)
+        ArenaRelease(&s->entries);
+    s->entries = next;
+    s->schedule = schedule;
+    s->queue = queue;
+    s->activeCount = activeCount;
+    s->stamp = stamp;
+    LogFormat(PS_T("Schedule: %s"), s->path);
+    LogNumber(PS_T("Schedule entries: "), schedule.count);
+    return true;
+}
+
+// Queue the occurrence, unless the entry's last one is still going or
+// waiting
+static void Fire(Scheduler* s, Arena* arena, ScheduleEntry* e, uint64_t nowSeconds)
+{
+    if (e->running || JobQueued(&e->queued) || ResourceWaiting(&e->claim))
+    {
+        Journal(s, arena, e, RUN_OVERLAP, 0);
+        return;
+    }
+    Enqueue(&s->queue, e, e->withinSeconds ? nowSeconds + e->withinSeconds : JOB_NO_DEADLINE);
+}
+
+// RESOURCES: The tags of the alias's profile, looked up as the occurrence
+// is about to start so a rebuilt index applies from the next run; true if
+// they are held now, false if it waits in line for them
+static bool Claim(Scheduler* s, Arena* arena, ScheduleEntry* e)
+{
+    ResourceClaimInit(&e->claim);
+#ifdef ENABLE_CATALOG
+    ArenaMark mark = ArenaSave(arena);
+    size_t len = PsStrLen(e->args);
+    int maxArgs = (int)((len + 2) / 2 + 2);
+    PSCHAR* line = (PSCHAR*)ArenaAlloc(arena, (len + 3) * sizeof(PSCHAR));
+    PSCHAR* storage = (PSCHAR*)ArenaAlloc(arena, (len + 3) * sizeof(PSCHAR));
+    PSCHAR** argv = (PSCHAR**)ArenaAlloc(arena, sizeof(PSCHAR*) * (size_t)maxArgs);
+    LaunchArgs launch;
+    CatalogResources tags;
+    if (line && storage && argv)
+    {
+        // A stand-in program name in front, as on a real command line
+        line[0] = PS_T('x');
+        line[1] = PS_T(' ');
+        PsMemCpy(line + 2, e->args, (len + 1) * sizeof(PSCHAR));
+        int argc = SplitCommandLine(line, storage, argv, maxArgs);
+        if (ParseLaunchArgs(argc, argv, &launch) && launch.script[0] == PS_T('@') &&
+            CatalogAliasResources(arena, launch.script + 1, &tags) &&
+            !CatalogClaimResources(&tags, &s->resources, &e->claim))
+            LogNumber(PS_T("WARNING: Too many resource tags, some not limited: line "), e->lineNumber);
+    }
+    ArenaRestore(arena, mark);
+#else
+    (void)arena;
+#endif
+    return ResourceAcquire(&s->resources, &e->claim);
+}
+
+static void Start(Scheduler* s, Arena* arena, ScheduleEntry* e)
+{
+    // PlatSpawn may write to the command line, so it is built per run
+    ArenaMark mark = ArenaSave(arena);
+    StrBuf cmd;
+    bool built = StrBufInit(&cmd, arena, 256, PS_MAX_COMMAND_LINE) &&
+                 AppendQuotedPath(&cmd, s->self) &&
+                 StrBufAppendChar(&cmd, PS_T(' ')) &&
+                 StrBufAppend(&cmd, e->args);
+    if (!built)
+        Journal(s, arena, e, RUN_OVERFLOW, 1);
+    else if (PlatSpawn(s->self, cmd.data, s->envBlock, &e->run))
+    {
+        GovernorAttach(&s->governor, &e->govern, &e->run, e->cls);
+        e->running = true;
+        s->active[s->activeCount++] = e;
+    }
+    else
+        Journal(s, arena, e, RUN_SPAWN_FAILED, PlatLastError());
+    if (!e->running)
+        ResourceRelease(&s->resources, &e->claim);
+    ArenaRestore(arena, mark);
+}
+
+// DISPATCH: Waiting occurrences take the free run slots - first those
+// whose tags came free, then the most urgent of the queue, which may
+// have to wait in line for its tags instead; runs left behind by a
+// reload hold theirs until they exit
+static void Dispatch(Scheduler* s, Arena* arena)
+{
+    while (s->activeCount + s->orphanCount < SCHEDULE_MAX_RUNNING)
+    {
+        ResourceClaim* freed = ResourceNext(&s->resources);
+        if (freed)
+        {
+            Start(s, arena, (ScheduleEntry*)((uint8_t*)freed - offsetof(ScheduleEntry, claim)));
+            continue;
+        }
+        JobItem* item = JobQueuePop(&s->queue);
+        if (!item)
+            break;
+        ScheduleEntry* e = (ScheduleEntry*)((uint8_t*)item - offsetof(ScheduleEntry, queued));
+        if (Claim(s, arena, e))
+            Start(s, arena, e);
+    }
+}
+
+int RunScheduler(Arena* arena, const PSCHAR* path)
+{
+    PSCHAR defaultPath[PS_MAX_PATH];
+    if (!path)
+    {
+        if (!PlatGetStateDirectory(defaultPath, PS_MAX_PATH))
+            return 1;
+        size_t pos = PsStrLen(defaultPath);
+        if (!AppendChar(defaultPath, PS_MAX_PATH, PS_PATH_SEP, &pos) ||
+            !AppendStr(defaultPath, PS_MAX_PATH, SCHEDULE_NAME, &pos))
+            return 1;
+        path = defaultPath;
+    }
+
+    Scheduler* s = (Scheduler*)ArenaAlloc(arena, sizeof(Scheduler));
+    TimerWheel* wheel = (TimerWheel*)ArenaAlloc(arena, sizeof(TimerWheel));
+    if (!s || !wheel)
+        return 1;
+    PsMemSet(s, 0, sizeof(*s));
+    ResourceInit(&s->resources);
+    s->path = path;
+    s->wheel = wheel;
+    if (!PlatGetExecutablePath(s->self, PS_MAX_PATH))
+    {
+        LogWrite(PS_T("ERROR: Cannot locate the launcher executable"));
+        return 1;
+    }
+
+    // A schedule that does not load at start is an error, later it is not
+    if (!LoadSchedule(s, PlatWallClockMillis() / 1000))
+        return 1;
+
+    // RUN IDS: Every launch fired is a child of this session; its block is
+    // built once, as nothing changes our own environment
+    const PSCHAR* vars[RUN_ID_VARS];
+    PSCHAR idText[RUN_ID_CHARS + 1];
+    RunIdBegin(&s->ids, &s->session, &s->parent);
+    if (RunIdVariables(arena, &s->session, &s->parent, NULL, vars))
+        s->envBlock = BuildEnvironmentBlock(arena, NULL, vars, RUN_ID_VARS);
+    RunIdFormat(&s->session, idText);
+    LogFormat(PS_T("Run id: %s"), idText);
+    if (GovernorInit(&s->governor))
+        LogNumber(PS_T("Governor: bulk runs suspended at pressure (%): "), s->governor.suspendAbove / 100);
+    LogWrite(PS_T("Scheduler running"));
+    CloseLog();                         // Child launches rewrite the log
+
+    for (;;)
+    {
+        uint64_t nowSeconds = PlatWallClockMillis() / 1000;
+        Reap(s);
+
+        // FIRE: Everything due, then the next occurrence of each
+        TimerNode* node = TimerWheelAdvance(wheel, nowSeconds);
+        while (node)
+        {
+            TimerNode* next = node->next;
+            ScheduleEntry* e = (ScheduleEntry*)node;
+            Fire(s, arena, e, nowSeconds);
+            // Intervals keep their phase unless a whole period was missed
+            uint64_t at = e->everySeconds ? e->timer.expires + e->everySeconds : 0;
+            if (at <= nowSeconds)
+                at = ScheduleNextRun(e, nowSeconds);
+            if (at)
+                TimerWheelAdd(wheel, &e->timer, at);
+            node = next;
+        }
+        Dispatch(s, arena);
+
+        // GOVERNOR: Bulk runs follow the machine's pressure
+        bool governing = GovernorEnabled(&s->governor) && s->activeCount > 0;
+        if (governing)
+        {
+            uint64_t now = PlatMonotonicNanos() / 1000000;
+            bool pressed = GovernorCheck(&s->governor, now);
+            for (uint32_t i = 0; i < s->activeCount; i++)
+                GovernorApply(&s->governor, &s->active[i]->govern, pressed, now);
+        }
+
+        // FILE: Gone stops the scheduler, changed reloads it
+        PlatFileInfo stamp;
+        if (!PlatGetFileInfo(path, &stamp))
+            break;
+        if (stamp.fileId != s->stamp.fileId || stamp.size != s->stamp.size ||
+            stamp.mtime != s->stamp.mtime)
+        {
+            InitLog(arena);
+            if (!LoadSchedule(s, nowSeconds))
+                LogWrite(PS_T("WARNING: Schedule not reloaded - keeping the previous one"));
+            CloseLog();
+        }
+
+        // SLEEP: Until the next expiry, or the next file check; while
+        // occurrences wait or runs are governed, only until a run may
+        // have finished or the pressure changed
+        bool busy = JobQueueCount(&s->queue) > 0 || s->resources.waiting > 0 || governing;
+        uint64_t wake = nowSeconds + (busy ? 1 : SCHEDULE_RECHECK_SECONDS);
+        uint64_t due;
+        if (TimerWheelNextExpiry(wheel, &due) && due < wake)
+            wake = due;
+        uint64_t nowMillis = PlatWallClockMillis();
+        if (wake * 1000 > nowMillis)
+            PlatSleepMillis((uint32_t)(wake * 1000 - nowMillis));
+    }
+
+    for (uint32_t i = 0; i < s->activeCount; i++)
+    {
+        GovernorRelease(&s->active[i]->govern);
+        PlatCloseProcess(&s->active[i]->run);
+    }
+    ArenaRelease(&s->entries);
+    return 0;
+}
@@ -0,0 +1,104 @@
+//--------------------------------------------------------------------------
+// RESIDENT SCHEDULER - One long-lived launcher firing scheduled runs
+//--------------------------------------------------------------------------
+// "ps-launcher -Schedule [file]" stays resident and starts the entries of
+// a schedule file (default <state directory>/ps-launcher.schedule):
+//
+//   # minute hour day month weekday   launcher arguments
+//   */5 * * * *      -Script @inventory
+//   0 2 * * mon-fri  -Script /jobs/backup.ps1 -Target "/mnt/backup"
+//   @daily           -Script @cleanup
+//   @every 90s       -Script @heartbeat
+//
+// The schedule is a cron expression (cron.h), a cron macro, or "@every"
+// with a fixed interval in s, m or h. The rest of the line is exactly what
+// would follow ps-launcher on a command line, so catalogue aliases bring
+// their profiles (parameters, inputs, result cache) with them. Each run is
+// a child launcher of this executable, started without waiting; if an
+// entry's previous run is still going or waiting, that occurrence is
+// skipped and journaled as "overlap". Occurrences missed while the machine
+// slept fire once, not once per miss.
+//
+// Up to SCHEDULE_MAX_RUNNING runs go at once; occurrences past that wait
+// in a queue (jobqueue.h) by class, then deadline. Optional words between
+// the schedule and the launcher arguments set them:
+//
+//   0 * * * *   bulk -Script @reindex
+//   */5 * * * * interactive within 30s -Script @health
+//
+// The class is interactive, normal (the default) or bulk; "within" gives
+// the run a deadline that long after its occurrence. With
+// PS_LAUNCHER_GOVERN set, bulk runs are suspended while the machine is
+// under pressure (governor.h).
+//
+// An alias whose profile has resource tags (catalog.h) starts only while
+// each tag is below its limit; until then it waits in line for them
+// (resource.h), holding no run slot, so entries that share a database
+// take turns while the rest of the schedule runs.
+//
+// Every entry is one timer in a timer wheel (timerwheel.h) ticking in
+// seconds, so adding, firing and rescheduling an entry is O(1) whatever
+// the size of the schedule. The process sleeps until the wheel's next
+// expiry, waking at least every SCHEDULE_RECHECK_SECONDS to see whether
+// the file changed: an edited file is reloaded (runs in progress are kept
+// with their entries), a broken one is ignored until fixed, and deleting
+// the file stops the scheduler.
+
+#ifndef PS_SCHEDULER_H
+#define PS_SCHEDULER_H
+
+#include "arena.h"
+#include "cron.h"
+#include "governor.h"
+#include "jobqueue.h"
+#include "platform.h"
+#include "pstypes.h"
+#include "resource.h"
+#include "timerwheel.h"
+
+PS_EXTERN_C_BEGIN
+
+#define SCHEDULE_NAME             PS_T("ps-launcher.schedule")
+#define SCHEDULE_MAX_SOURCE       ((size_t)16 << 20)
+#define SCHEDULE_MAX_EVERY        (366u * 24 * 3600)
+#define SCHEDULE_RECHECK_SECONDS  60
+#define SCHEDULE_MAX_RUNNING      16
+
+typedef struct ScheduleEntry
+{
+    TimerNode timer;                 // First member: a node is its entry
+    CronExpr cron;
+    uint32_t everySeconds;           // "@every": fixed interval, no cron
+    const PSCHAR* line;              // As written, for reloads and the journal
+    const PSCHAR* args;              // Launcher arguments, within line
+    uint32_t lineNumber;
+    JobClass cls;
+    uint32_t withinSeconds;          // Deadline after each occurrence; 0: none
+    JobItem queued;                  // While an occurrence waits for a run slot
+    ResourceClaim claim;             // Its tags: waited for, then held while it runs
+    PlatProcess run;                 // Last run, while it may be going
+    GovernedRun govern;
+    bool running;
+} ScheduleEntry;
+
+typedef struct Schedule
+{
+    ScheduleEntry* entries;
+    uint32_t count;
+} Schedule;
+
+// Parse a schedule file's text (modified in place: lines are terminated).
+// False on the first invalid line, which is logged.
+bool ParseSchedule(Arena* arena, PSCHAR* text, size_t len, Schedule* schedule);
+
+// Unix second of the entry's first occurrence after nowSeconds; 0 if it
+// never occurs
+uint64_t ScheduleNextRun(const ScheduleEntry* entry, uint64_t nowSeconds);
+
+// Resident loop (-Schedule). path NULL means the default schedule file.
+// Returns 0 once the file is deleted, 1 if it cannot be loaded at start.
+int RunScheduler(Arena* arena, const PSCHAR* path);
+
+PS_EXTERN_C_END
+
+#endif // PS_SCHEDULER_H
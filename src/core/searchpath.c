@@ -0,0 +1,527 @@
+//--------------------------------------------------------------------------
+// SCRIPT SEARCH PATH - Relative -Script values beyond the current directory
+//--------------------------------------------------------------------------
+#include "searchpath.h"
+#include "log.h"
+#include "platform.h"
+#include "psmem.h"
+#include "psstr.h"
+#include "strbuf.h"
+
+// Cache file layout (native byte order, rewritten whole on change):
+//   DirCacheHeader
+//   per directory: DirCacheRecord, PSCHAR path[pathLen + 1],
+//                  PSCHAR names[namesLen], padding to 4 bytes,
+//                  DirCacheName index[nameCount], padding to 8 bytes
+// Each name is a type character ('f', 'd' or 'l'), the name and a 0. The
+// index is sorted by hash, so a lookup is a binary search, not a scan.
+#define DIRCACHE_VERSION   1
+#define DIRCACHE_MAX_DIRS  64
+#define DIRCACHE_MAX_NAMES 65536
+#define DIRCACHE_MAX_SIZE  ((size_t)16 << 20)
+
+// Listings taken this soon after the directory's last change are redone
+#define RACY_WINDOW (2 * PLAT_FILE_TICKS_PER_SECOND)
+
+typedef struct DirCacheHeader
+{
+    char magic[4];                   // "PSDC"
+    uint32_t version;
+    uint32_t dirCount;
+    uint32_t reserved;
+} DirCacheHeader;
+
+typedef struct DirCacheRecord
+{
+    uint32_t size;                   // Whole record, multiple of 8
+    uint32_t pathLen;                // Characters, without the terminator
+    uint32_t namesLen;               // Characters in the name block
+    uint32_t nameCount;
+    PlatFileInfo stamp;              // Directory identity when listed
+    uint64_t listedAt;               // PlatFileTimeNow() at listing
+} DirCacheRecord;
+
+typedef struct DirCacheName
+{
+    uint32_t hash;                   // NameHash of the name
+    uint32_t offset;                 // Type character's index in the names
+} DirCacheName;
+
+// One directory listing, from the cache file or freshly taken
+typedef struct Listing
+{
+    const PSCHAR* path;
+    size_t pathLen;
+    const PSCHAR* names;
+    size_t namesLen;
+    const DirCacheName* index;
+    uint32_t nameCount;
+    PlatFileInfo stamp;
+    uint64_t listedAt;
+    bool used;                       // Already placed in the new cache
+} Listing;
+
+bool IsRelativePath(const PSCHAR* path)
+{
+#ifdef _WIN32
+    // "C:..." (drive) and "\..." or "/..." (root or UNC) are not relative
+    if (path[0] && path[1] == L':')
+        return false;
+    return path[0] != L'\\' && path[0] != L'/';
+#else
+    return path[0] != '/';
+#endif
+}
+
+static bool IsSeparator(PSCHAR c)
+{
+    return c == PS_PATH_SEP || c == PS_T('/');
+}
+
+static bool NameEquals(const PSCHAR* a, const PSCHAR* b, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+#ifdef _WIN32
+        // File names on Windows are case-insensitive
+        PSCHAR ca = (a[i] >= L'A' && a[i] <= L'Z') ? (PSCHAR)(a[i] | 0x20) : a[i];
+        PSCHAR cb = (b[i] >= L'A' && b[i] <= L'Z') ? (PSCHAR)(b[i] | 0x20) : b[i];
+        if (ca != cb)
+            return false;
+#else
+        if (a[i] != b[i])
+            return false;
+#endif
+    }
+    return true;
+}
+
+// FNV-1a over the characters, case-folded where file names are
+static uint32_t NameHash(const PSCHAR* name, size_t len)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+    {
+#ifdef _WIN32
+        uint32_t c = name[i];
+        if (c >= 'A' && c <= 'Z')
+            c |= 0x20;
+#else
+        uint32_t c = (uint8_t)name[i];
+#endif
+        h = (h ^ c) * 16777619u;
+    }
+    return h;
+}
+
+// Record size with each part aligned for in-place use
+static size_t NamesEnd(size_t pathLen, size_t namesLen)
+{
+    size_t end = sizeof(DirCacheRecord) + (pathLen + 1 + namesLen) * sizeof(PSCHAR);
+    return (end + 3) & ~(size_t)3;
+}
+
+static size_t RecordSize(size_t pathLen, size_t namesLen, uint32_t nameCount)
+{
+    size_t end = NamesEnd(pathLen, namesLen) + (size_t)nameCount * sizeof(DirCacheName);
+    return (end + 7) & ~(size_t)7;
+}
+
+static bool SameStamp(const PlatFileInfo* a, const PlatFileInfo* b)
+{
+    return a->volume == b->volume && a->fileId == b->fileId &&
+           a->size == b->size && a->mtime == b->mtime;
+}
+
+//--------------------------------------------------------------------------
+// CACHE FILE
+//--------------------------------------------------------------------------
+// Parse the cache into listings; a damaged file just counts as empty
+static uint32_t LoadCache(Arena* arena, const PSCHAR* cachePath, Listing* out)
+{
+    size_t size = 0;
+    const uint8_t* data = (const uint8_t*)ArenaReadFile(arena, cachePath, DIRCACHE_MAX_SIZE, &size);
+    if (!data || size < sizeof(DirCacheHeader))
+        return 0;
+
+    const DirCacheHeader* h = (const DirCacheHeader*)data;
+    if (h->magic[0] != 'P' || h->magic[1] != 'S' || h->magic[2] != 'D' || h->magic[3] != 'C' ||
+        h->version != DIRCACHE_VERSION || h->dirCount > DIRCACHE_MAX_DIRS)
+        return 0;
+
+    size_t pos = sizeof(DirCacheHeader);
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < h->dirCount; i++)
+    {
+        if (size - pos < sizeof(DirCacheRecord))
+            return 0;
+        const DirCacheRecord* r = (const DirCacheRecord*)(data + pos);
+        if (r->pathLen > DIRCACHE_MAX_SIZE || r->namesLen > DIRCACHE_MAX_SIZE ||
+            r->nameCount > DIRCACHE_MAX_NAMES ||
+            r->size != RecordSize(r->pathLen, r->namesLen, r->nameCount) || r->size > size - pos)
+            return 0;
+
+        const PSCHAR* path = (const PSCHAR*)(r + 1);
+        const PSCHAR* names = path + r->pathLen + 1;
+        const DirCacheName* index = (const DirCacheName*)((const uint8_t*)r + NamesEnd(r->pathLen, r->namesLen));
+        if (path[r->pathLen] != 0 || (r->namesLen > 0 && names[r->namesLen - 1] != 0))
+            return 0;
+        for (uint32_t n = 0; n < r->nameCount; n++)
+        {
+            if (index[n].offset >= r->namesLen)
+                return 0;
+        }
+
+        Listing* l = &out[count++];
+        l->path = path;
+        l->pathLen = r->pathLen;
+        l->names = names;
+        l->namesLen = r->namesLen;
+        l->index = index;
+        l->nameCount = r->nameCount;
+        l->stamp = r->stamp;
+        l->listedAt = r->listedAt;
+        l->used = false;
+        pos += r->size;
+    }
+    return count;
+}
+
+// Rewrite the cache: this lookup's directories first, then the others
+// that were already cached, up to DIRCACHE_MAX_DIRS
+static void SaveCache(Arena* arena, const PSCHAR* cachePath, Listing* const* fresh,
+                      uint32_t freshCount, Listing* old, uint32_t oldCount)
+{
+    Listing* keep[DIRCACHE_MAX_DIRS];
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < freshCount && count < DIRCACHE_MAX_DIRS; i++)
+        keep[count++] = fresh[i];
+    for (uint32_t i = 0; i < oldCount && count < DIRCACHE_MAX_DIRS; i++)
+    {
+        if (!old[i].used)
+            keep[count++] = &old[i];
+    }
+
+    size_t total = sizeof(DirCacheHeader);
+    for (uint32_t i = 0; i < count; i++)
+        total += RecordSize(keep[i]->pathLen, keep[i]->namesLen, keep[i]->nameCount);
+    if (total > DIRCACHE_MAX_SIZE)
+        return;
+
+    uint8_t* image = (uint8_t*)ArenaAlloc(arena, total);
+    if (!image)
+        return;
+    PsMemSet(image, 0, total);
+
+    DirCacheHeader* h = (DirCacheHeader*)image;
+    h->magic[0] = 'P';
+    h->magic[1] = 'S';
+    h->magic[2] = 'D';
+    h->magic[3] = 'C';
+    h->version = DIRCACHE_VERSION;
+    h->dirCount = count;
+
+    size_t pos = sizeof(DirCacheHeader);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const Listing* l = keep[i];
+        DirCacheRecord* r = (DirCacheRecord*)(image + pos);
+        r->size = (uint32_t)RecordSize(l->pathLen, l->namesLen, l->nameCount);
+        r->pathLen = (uint32_t)l->pathLen;
+        r->namesLen = (uint32_t)l->namesLen;
+        r->nameCount = l->nameCount;
+        r->stamp = l->stamp;
+        r->listedAt = l->listedAt;
+        PSCHAR* path = (PSCHAR*)(r + 1);
+        PsMemCpy(path, l->path, l->pathLen * sizeof(PSCHAR));
+        PsMemCpy(path + l->pathLen + 1, l->names, l->namesLen * sizeof(PSCHAR));
+        PsMemCpy((uint8_t*)r + NamesEnd(l->pathLen, l->namesLen), l->index,
+                 (size_t)l->nameCount * sizeof(DirCacheName));
+        pos += r->size;
+    }
+
+    // Whole-file replace, so concurrent launchers read one version or the other
+    StrBuf tmp;
+    if (!StrBufInit(&tmp, arena, 64, STRBUF_NO_LIMIT) || !StrBufAppend(&tmp, cachePath) ||
+        !StrBufAppend(&tmp, PS_T(".tmp")) || !StrBufAppendUInt(&tmp, PlatMonotonicNanos()))
+        return;
+    PlatFile file = PlatCreateFile(tmp.data, PLAT_FILE_OVERWRITE);
+    if (file == PLAT_INVALID_FILE)
+        return;
+    bool ok = PlatWriteFile(file, image, total);
+    PlatCloseFile(file);
+    if (ok)
+        PlatRenameFile(tmp.data, cachePath);
+}
+
+//--------------------------------------------------------------------------
+// LISTING
+//--------------------------------------------------------------------------
+typedef struct ListCtx
+{
+    StrBuf names;
+    uint32_t count;
+    bool failed;
+} ListCtx;
+
+static bool OnEntry(void* ctx, const PSCHAR* name, size_t nameLen, PlatEntryType type)
+{
+    ListCtx* l = (ListCtx*)ctx;
+    PSCHAR tag = type == PLAT_ENTRY_DIRECTORY ? PS_T('d') : type == PLAT_ENTRY_LINK ? PS_T('l') : PS_T('f');
+    if (l->count >= DIRCACHE_MAX_NAMES || !StrBufAppendChar(&l->names, tag) ||
+        !StrBufAppendN(&l->names, name, nameLen) || !StrBufAppendChar(&l->names, 0))
+    {
+        l->failed = true;
+        return false;
+    }
+    l->count++;
+    return true;
+}
+
+// Heap sort by hash: no recursion, no allocation, O(n log n) worst case
+static void SiftDown(DirCacheName* a, size_t root, size_t count)
+{
+    for (;;)
+    {
+        size_t child = root * 2 + 1;
+        if (child >= count)
+            return;
+        if (child + 1 < count && a[child + 1].hash > a[child].hash)
+            child++;
+        if (a[root].hash >= a[child].hash)
+            return;
+        DirCacheName t = a[root];
+        a[root] = a[child];
+        a[child] = t;
+        root = child;
+    }
+}
+
+static void SortByHash(DirCacheName* a, size_t count)
+{
+    for (size_t i = count / 2; i > 0; i--)
+        SiftDown(a, i - 1, count);
+    for (size_t end = count; end > 1; end--)
+    {
+        DirCacheName t = a[0];
+        a[0] = a[end - 1];
+        a[end - 1] = t;
+        SiftDown(a, 0, end - 1);
+    }
+}
+
+// Fresh listing of dir; false if it cannot be listed or cached
+static bool ListDirectory(Arena* arena, const PSCHAR* dir, size_t dirLen,
+                          const PlatFileInfo* stamp, Listing* out)
+{
+    ListCtx ctx;
+    ctx.count = 0;
+    ctx.failed = false;
+    if (!StrBufInit(&ctx.names, arena, 1024, STRBUF_NO_LIMIT))
+        return false;
+    uint64_t now = PlatFileTimeNow();
+    if (!PlatListDirectory(dir, OnEntry, &ctx) || ctx.failed)
+        return false;
+
+    // Changed while listing: the listing may mix both states
+    PlatFileInfo after;
+    if (!PlatGetFileInfo(dir, &after) || !SameStamp(stamp, &after))
+        return false;
+
+    DirCacheName* index = (DirCacheName*)ArenaAlloc(arena, (ctx.count + 1) * sizeof(DirCacheName));
+    if (!index)
+        return false;
+    size_t offset = 0;
+    for (uint32_t i = 0; i < ctx.count; i++)
+    {
+        size_t len = PsStrLen(ctx.names.data + offset + 1);
+        index[i].hash = NameHash(ctx.names.data + offset + 1, len);
+        index[i].offset = (uint32_t)offset;
+        offset += len + 2;
+    }
+    SortByHash(index, ctx.count);
+
+    out->path = dir;
+    out->pathLen = dirLen;
+    out->names = ctx.names.data;
+    out->namesLen = ctx.names.len;
+    out->index = index;
+    out->nameCount = ctx.count;
+    out->stamp = *stamp;
+    out->listedAt = now;
+    out->used = true;
+    return true;
+}
+
+// Type character of name in the listing, or 0
+static PSCHAR FindName(const Listing* l, const PSCHAR* name, size_t nameLen)
+{
+    uint32_t hash = NameHash(name, nameLen);
+    size_t lo = 0, hi = l->nameCount;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if (l->index[mid].hash < hash)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    for (; lo < l->nameCount && l->index[lo].hash == hash; lo++)
+    {
+        // Bounded by namesLen: the cache file may not be trusted blindly
+        size_t at = l->index[lo].offset;
+        if (at + 1 + nameLen < l->namesLen && l->names[at + 1 + nameLen] == 0 &&
+            NameEquals(l->names + at + 1, name, nameLen))
+            return l->names[at];
+    }
+    return 0;
+}
+
+//--------------------------------------------------------------------------
+// LOOKUP
+//--------------------------------------------------------------------------
+static PSCHAR* JoinScript(Arena* arena, const PSCHAR* dir, size_t dirLen, const PSCHAR* script)
+{
+    size_t scriptLen = PsStrLen(script);
+    PSCHAR* out = (PSCHAR*)ArenaAlloc(arena, (dirLen + scriptLen + 2) * sizeof(PSCHAR));
+    if (!out)
+        return NULL;
+    PsMemCpy(out, dir, dirLen * sizeof(PSCHAR));
+    out[dirLen] = PS_PATH_SEP;
+    PsMemCpy(out + dirLen + 1, script, (scriptLen + 1) * sizeof(PSCHAR));
+    return out;
+}
+
+PSCHAR* SearchScriptPath(Arena* arena, const PSCHAR* searchPath, const PSCHAR* cachePath,
+                         const PSCHAR* script, SearchStats* stats)
+{
+    PsMemSet(stats, 0, sizeof(*stats));
+    if (!IsRelativePath(script) || script[0] == 0)
+        return NULL;
+
+    // First path component is what the directory listing can answer
+    size_t firstLen = 0;
+    while (script[firstLen] && !IsSeparator(script[firstLen]))
+        firstLen++;
+    bool nested = script[firstLen] != 0;
+    bool dotted = script[0] == PS_T('.') &&
+                  (firstLen == 1 || (firstLen == 2 && script[1] == PS_T('.')));
+
+    Listing* old = (Listing*)ArenaAlloc(arena, sizeof(Listing) * DIRCACHE_MAX_DIRS);
+    Listing* fresh[DIRCACHE_MAX_DIRS];
+    uint32_t freshCount = 0;
+    if (!old)
+        return NULL;
+    uint32_t oldCount = LoadCache(arena, cachePath, old);
+    bool dirty = false;
+    PSCHAR* found = NULL;
+
+    for (const PSCHAR* p = searchPath; *p && !found;)
+    {
+        //------------------------------------------------------------------
+        // NEXT ENTRY - Empty entries are skipped, trailing separators cut
+        //------------------------------------------------------------------
+        const PSCHAR* start = p;
+        while (*p && *p != PS_PATH_LIST_SEP)
+            p++;
+        size_t len = (size_t)(p - start);
+        if (*p)
+            p++;
+        while (len > 1 && IsSeparator(start[len - 1]))
+            len--;
+        if (len == 0)
+            continue;
+
+        PSCHAR* dir = (PSCHAR*)ArenaAlloc(arena, (len + 1) * sizeof(PSCHAR));
+        if (!dir)
+            break;
+        PsMemCpy(dir, start, len * sizeof(PSCHAR));
+        dir[len] = 0;
+
+        //------------------------------------------------------------------
+        // VALIDATE - One stamp query; the listing is reused if it matches
+        //------------------------------------------------------------------
+        PlatFileInfo stamp;
+        stats->validated++;
+        if (!PlatGetFileInfo(dir, &stamp))
+            continue;
+
+        Listing* listing = NULL;
+        for (uint32_t i = 0; i < oldCount && !listing; i++)
+        {
+            Listing* l = &old[i];
+            if (l->pathLen == len && NameEquals(l->path, dir, len) && !l->used)
+            {
+                l->used = true;       // Replaced or kept, never both
+                if (SameStamp(&l->stamp, &stamp) && l->listedAt >= l->stamp.mtime + RACY_WINDOW)
+                    listing = l;
+            }
+        }
+        if (!listing)
+        {
+            Listing* l = (Listing*)ArenaAlloc(arena, sizeof(Listing));
+            stats->listed++;
+            dirty = true;
+            if (l && ListDirectory(arena, dir, len, &stamp, l))
+                listing = l;
+        }
+        if (listing && freshCount < DIRCACHE_MAX_DIRS)
+            fresh[freshCount++] = listing;
+
+        //------------------------------------------------------------------
+        // MATCH - Probe the file only where the listing cannot settle it
+        //------------------------------------------------------------------
+        PSCHAR type = 0;
+        if (listing && !dotted)
+        {
+            type = FindName(listing, script, firstLen);
+            if (type == 0 || (nested && type == PS_T('f')) || (!nested && type == PS_T('d')))
+                continue;
+        }
+
+        PSCHAR* candidate = JoinScript(arena, dir, len, script);
+        if (!candidate)
+            break;
+        if (listing && !dotted && type == PS_T('f'))
+            found = candidate;
+        else
+        {
+            stats->probed++;
+            if (PlatFileExists(candidate))
+                found = candidate;
+        }
+    }
+
+    if (dirty)
+    {
+        ArenaMark mark = ArenaSave(arena);
+        SaveCache(arena, cachePath, fresh, freshCount, old, oldCount);
+        if (!found)
+            ArenaRestore(arena, mark);
+    }
+    return found;
+}
+
+PSCHAR* FindOnScriptPath(Arena* arena, const PSCHAR* script)
+{
+    // Environment variables are limited to 32,767 characters
+    size_t pathSize = 32768;
+    PSCHAR* searchPath = (PSCHAR*)ArenaAlloc(arena, pathSize * sizeof(PSCHAR));
+    if (!searchPath || !PlatGetEnv(SCRIPT_PATH_VARIABLE, searchPath, pathSize))
+        return NULL;
+
+    PSCHAR cachePath[PS_MAX_PATH];
+    size_t pos = 0;
+    if (!PlatGetStateDirectory(cachePath, PS_MAX_PATH))
+        return NULL;
+    pos = PsStrLen(cachePath);
+    if (!AppendChar(cachePath, PS_MAX_PATH, PS_PATH_SEP, &pos) ||
+        !AppendStr(cachePath, PS_MAX_PATH, DIRCACHE_NAME, &pos))
+        return NULL;
+
+    SearchStats stats;
+    PSCHAR* found = SearchScriptPath(arena, searchPath, cachePath, script, &stats);
+    LogNumber(PS_T("Script path directories checked: "), stats.validated);
+    LogNumber(PS_T("Script path directories listed: "), stats.listed);
+    return found;
+}
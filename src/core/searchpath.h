@@ -0,0 +1,55 @@
+//--------------------------------------------------------------------------
+// SCRIPT SEARCH PATH - Relative -Script values beyond the current directory
+//--------------------------------------------------------------------------
+// PS_LAUNCHER_SCRIPT_PATH lists directories like PSModulePath (';' between
+// entries on Windows, ':' on POSIX). A relative -Script that does not exist
+// in the current directory - often System32 under Task Scheduler - is
+// looked up in each directory in turn; the first match wins.
+//
+// Listings are cached in <state directory>/ps-launcher.dircache, keyed by
+// directory path and validated by the directory's change stamp (identity
+// plus last write time, which moves whenever an entry is added, removed or
+// renamed). A lookup therefore queries one stamp per directory up to the
+// match instead of opening the script in each, and re-lists a directory
+// only when it changed. Listings taken within a couple of seconds of the
+// directory's last change are not trusted, since a second change in the
+// same clock tick would leave the stamp as it was.
+
+#ifndef PS_SEARCHPATH_H
+#define PS_SEARCHPATH_H
+
+#include "arena.h"
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+#define SCRIPT_PATH_VARIABLE PS_T("PS_LAUNCHER_SCRIPT_PATH")
+#define DIRCACHE_NAME        PS_T("ps-launcher.dircache")
+
+#ifdef _WIN32
+    #define PS_PATH_LIST_SEP L';'
+#else
+    #define PS_PATH_LIST_SEP ':'
+#endif
+
+typedef struct SearchStats
+{
+    uint32_t validated;    // Directory change stamps queried
+    uint32_t listed;       // Directories (re-)listed
+    uint32_t probed;       // Files checked directly
+} SearchStats;
+
+// True for paths that depend on the current directory
+bool IsRelativePath(const PSCHAR* path);
+
+// Look script up in the directories of searchPath, using and refreshing
+// the listing cache at cachePath. Returns the full path or NULL.
+PSCHAR* SearchScriptPath(Arena* arena, const PSCHAR* searchPath, const PSCHAR* cachePath,
+                         const PSCHAR* script, SearchStats* stats);
+
+// SearchScriptPath with PS_LAUNCHER_SCRIPT_PATH and the state directory
+PSCHAR* FindOnScriptPath(Arena* arena, const PSCHAR* script);
+
+PS_EXTERN_C_END
+
+#endif // PS_SEARCHPATH_H
@@ -0,0 +1,667 @@
+//--------------------------------------------------------------------------
+// SUBMISSION SERVER - Launches submitted over the local endpoint
+//--------------------------------------------------------------------------
+#include "server.h"
+#include "catalog.h"
+#include "config.h"
+#include "envblock.h"
+#include "governor.h"
+#include "ipc.h"
+#include "jobqueue.h"
+#include "log.h"
+#include "metrics.h"
+#include "psatomic.h"
+#include "psmem.h"
+#include "psstr.h"
+#include "quote.h"
+#include "resource.h"
+#include "runid.h"
+#include "trace.h"
+
+#define SERVER_POLL_MS        1000       // Idle reads: how soon a stop is noticed
+#define SERVER_SCRATCH_RESERVE ((size_t)64 << 20)
+
+struct Connection;
+
+// A submission waiting for a run slot: its frame, kept until it starts
+typedef struct Pending
+{
+    JobItem item;                        // First member: an item is its submission
+    struct Connection* owner;
+    struct Pending* next;                // Every submission since the last reset
+    uint8_t* frame;
+    uint32_t size;
+    uint64_t readNanos;                  // When its frame arrived
+    ResourceClaim claim;                 // Its tags, until its run takes them over
+} Pending;
+
+// Shared by every connection, under the lock
+typedef struct Dispatch
+{
+    volatile uint32_t lock;
+    uint32_t running;                    // Started, or granted and about to be
+    JobQueue queue;
+    ResourceTable resources;             // Popped submissions waiting for tags
+    Governor governor;
+} Dispatch;
+
+typedef struct ServerRun
+{
+    PlatProcess proc;
+    uint64_t id;
+    uint64_t startNanos;
+    uint64_t spawnedNanos;
+    uint32_t track;
+    RunId run;                           // Assigned to the child launcher
+    GovernedRun govern;
+    ResourceClaim claim;                 // Held until it exits
+} ServerRun;
+
+typedef struct Connection
+{
+    PlatIpc conn;
+    PlatThread thread;
+    Arena arena;                         // Receive buffer and completions
+    Arena scratch;                       // One submission at a time
+    Arena queued;                        // Pending submissions; reset when none are left
+    const PSCHAR* self;
+    volatile uint32_t* stopping;
+    volatile uint32_t* nextTrack;        // Trace tracks, unique across connections
+    const RunId* session;                // The server's run: every launch's parent
+    const RunId* parent;
+    RunIdSource ids;
+    volatile uint32_t done;              // Set by the thread as it finishes
+    uint64_t readNanos;                  // Latest bytes in: when pending frames arrived
+    TraceBuffer trace;
+    bool used;
+    Dispatch* dispatch;
+    uint64_t submitter;                  // Fair-share key unless a submission names one
+    Pending* pending;                    // Queued, granted or started since the reset
+    uint32_t waiting;                    // Queued or granted, not started
+    uint32_t granted;                    // Under the dispatch lock
+    Pending* grants[SERVER_MAX_RUNNING];
+    uint32_t running;
+    ServerRun runs[SERVER_MAX_RUNNING];
+    ResourceClaim reaped[SERVER_MAX_RUNNING];   // Reap's claims to release; too big for its frame
+} Connection;
+
+typedef struct Server
+{
+    PSCHAR self[PS_MAX_PATH];
+    volatile uint32_t stopping;
+    volatile uint32_t nextTrack;
+    uint32_t accepted;                   // Connections so far: default submitter keys
+    RunId session;
+    RunId parent;
+    Dispatch dispatch;
+    Connection connections[SERVER_MAX_CONNECTIONS];
+} Server;
+
+//--------------------------------------------------------------------------
+// DISPATCH LOCK
+//--------------------------------------------------------------------------
+// Held for a few heap operations at a time, so spinning is enough
+static void Lock(Dispatch* d)
+{
+    while (!PsAtomicCompareExchange(&d->lock, 0, 1))
+        PlatSleepMillis(0);
+}
+
+static void Unlock(Dispatch* d)
+{
+    PsAtomicStore(&d->lock, 0);
+}
+
+//--------------------------------------------------------------------------
+// ONE SUBMISSION
+//--------------------------------------------------------------------------
+// SECURITY CHECK: A profile is a promise about what runs; only an alias
+// indexed with exactly that profile keeps it
+static bool ProfileAllowed(const IpcSubmit* submit)
+{
+    if (!submit->profile)
+        return true;
+#ifdef ENABLE_CATALOG
+    return submit->script[0] == PS_T('@') && CatalogAliasUsesProfile(submit->script + 1, submit->profile);
+#else
+    return false;
+#endif
+}
+
+// RESOURCES: The tags of an alias's profile, looked up as it is queued;
+// none for a script path
+static void Tags(Connection* c, const IpcSubmit* submit, CatalogResources* tags)
+{
+    tags->count = 0;
+#ifdef ENABLE_CATALOG
+    if (submit->script[0] == PS_T('@'))
+        CatalogAliasResources(&c->scratch, submit->script + 1, tags);
+#else
+    (void)c;
+    (void)submit;
+#endif
+}
+
+// "NAME=value" with a name; anything else would corrupt the block
+static bool ValidVariables(const IpcSubmit* submit)
+{
+    for (int i = 0; i < submit->envCount; i++)
+    {
+        const PSCHAR* v = submit->env[i];
+        if (v[0] == PS_T('='))
+            return false;
+        while (*v && *v != PS_T('='))
+            v++;
+        if (*v == 0)
+            return false;
+    }
+    return true;
+}
+
+// The submitted variables, then ours, last so they win: the run ids (the
+// launch is assigned job, its parent is the server's run) and, with
+// metrics, PS_LAUNCHER_QUEUED_NS=<arrived>, so the launch measures its
+// queue wait from the frame's arrival
+static const PSCHAR* ChildEnvironment(Connection* c, const IpcSubmit* submit, const RunId* job, uint64_t arrived)
+{
+    int count = submit->envCount;
+    const PSCHAR** vars = (const PSCHAR**)ArenaAlloc(&c->scratch, (size_t)(count + RUN_ID_VARS + 1) * sizeof(PSCHAR*));
+    if (!vars || !RunIdVariables(&c->scratch, c->session, c->parent, job, vars + count))
+        return NULL;
+    for (int i = 0; i < submit->envCount; i++)
+        vars[i] = submit->env[i];
+    count += RUN_ID_VARS;
+#ifdef ENABLE_METRICS
+    PSCHAR* stamp = (PSCHAR*)ArenaAlloc(&c->scratch, 64 * sizeof(PSCHAR));
+    size_t pos = 0;
+    if (!stamp || !AppendStr(stamp, 64, METRICS_QUEUED_ENV, &pos) ||
+        !AppendChar(stamp, 64, PS_T('='), &pos) || !AppendUInt(stamp, 64, arrived, &pos))
+        return NULL;
+    vars[count++] = stamp;
+#else
+    (void)arrived;
+#endif
+    return BuildEnvironmentBlock(&c->scratch, NULL, vars, count);
+}
+
+// "0" to "4294967295", nothing else
+static bool ParseNumber(const PSCHAR* s, size_t len, uint64_t* value)
+{
+    *value = 0;
+    if (len == 0 || len > 10)
+        return false;
+    for (size_t i = 0; i < len; i++)
+    {
+        if (s[i] < PS_T('0') || s[i] > PS_T('9'))
+            return false;
+        *value = *value * 10 + (uint64_t)(s[i] - PS_T('0'));
+    }
+    return *value <= UINT32_MAX;
+}
+
+// Class, deadline and fair-share group of a submission; false if one is
+// given and not valid
+static bool QueueFields(const Connection* c, const IpcSubmit* submit, JobClass* cls, uint64_t* deadline,
+                        uint64_t* submitter, uint32_t* weight)
+{
+    *cls = JOB_NORMAL;
+    *deadline = JOB_NO_DEADLINE;
+    *submitter = c->submitter;
+    *weight = 1;
+    if (submit->priority && !JobParseClass(submit->priority, cls))
+        return false;
+    uint64_t value;
+    if (submit->deadline)
+    {
+        if (!ParseNumber(submit->deadline, PsStrLen(submit->deadline), &value))
+            return false;
+        *deadline = c->readNanos / 1000000 + value;
+    }
+    if (submit->submitter)
+    {
+        // "name:weight": digits after the last colon are a weight
+        size_t len = PsStrLen(submit->submitter), colon = len;
+        while (colon > 0 && submit->submitter[colon - 1] != PS_T(':'))
+            colon--;
+        if (colon > 0 && ParseNumber(submit->submitter + colon, len - colon, &value))
+        {
+            if (value == 0 || value > JOB_MAX_WEIGHT)
+                return false;
+            *weight = (uint32_t)value;
+            len = colon - 1;
+        }
+        if (len == 0)
+            return false;
+        *submitter = JobSubmitterKey(submit->submitter, len);
+    }
+    return true;
+}
+
+// Check the submission and queue it, or answer at once with why not.
+// False when there is no room: the frame stays unread.
+static bool Queue(Connection* c, const IpcFrame* frame, const uint8_t* bytes, size_t size, IpcWriter* out)
+{
+    IpcCompletion answer = { frame->id, IPC_REJECTED, 0, 0 };
+    ArenaRestore(&c->scratch, 0);
+
+    IpcSubmit submit;
+    JobClass cls;
+    uint64_t deadline, submitter;
+    uint32_t weight;
+    if (!IpcDecodeSubmit(&c->scratch, frame, &submit) || !ProfileAllowed(&submit) || !ValidVariables(&submit) ||
+        !QueueFields(c, &submit, &cls, &deadline, &submitter, &weight))
+    {
+        IpcEncodeCompletion(out, &answer);
+        return true;
+    }
+
+    // The frame is kept whole until it starts
+    if (c->queued.used + sizeof(Pending) + size > SERVER_QUEUE_BYTES)
+        return false;
+    ArenaMark mark = ArenaSave(&c->queued);
+    Pending* p = (Pending*)ArenaAlloc(&c->queued, sizeof(Pending));
+    uint8_t* copy = (uint8_t*)ArenaAlloc(&c->queued, size);
+    if (!p || !copy)
+    {
+        ArenaRestore(&c->queued, mark);
+        return false;
+    }
+    PsMemCpy(copy, bytes, size);
+    p->item.slot = JOB_NOT_QUEUED;
+    p->owner = c;
+    p->frame = copy;
+    p->size = (uint32_t)size;
+    p->readNanos = c->readNanos;
+    CatalogResources tags;
+    Tags(c, &submit, &tags);
+    ResourceClaimInit(&p->claim);
+
+    // A tag past what the table or a job holds is not limited
+    Lock(c->dispatch);
+    CatalogClaimResources(&tags, &c->dispatch->resources, &p->claim);
+    bool queued = JobQueuePush(&c->dispatch->queue, &p->item, cls, deadline, submitter, weight);
+    Unlock(c->dispatch);
+    if (!queued)
+    {
+        ArenaRestore(&c->queued, mark);
+        return false;
+    }
+    p->next = c->pending;
+    c->pending = p;
+    c->waiting++;
+    return true;
+}
+
+// Start a granted submission; false, with its answer written, if it did
+// not start. Its run takes over its tags.
+static bool Start(Connection* c, Pending* p, IpcWriter* out)
+{
+    IpcFrame frame;
+    bool bad;
+    IpcParseFrame(p->frame, p->size, &frame, &bad);
+    IpcCompletion answer = { frame.id, IPC_REJECTED, 0, 0 };
+    ArenaRestore(&c->scratch, 0);
+
+    IpcSubmit submit;
+    if (!IpcDecodeSubmit(&c->scratch, &frame, &submit))
+    {
+        IpcEncodeCompletion(out, &answer);
+        return false;
+    }
+
+    StrBuf cmd;
+    bool built = StrBufInit(&cmd, &c->scratch, 256, PS_MAX_COMMAND_LINE) && AppendQuotedPath(&cmd, c->self) &&
+                 StrBufAppend(&cmd, PS_T(" -Script ")) && AppendQuotedParameter(&cmd, submit.script);
+    for (int i = 0; built && i < submit.argCount; i++)
+        built = StrBufAppendChar(&cmd, PS_T(' ')) && AppendQuotedParameter(&cmd, submit.args[i]);
+    RunId job = RunIdNext(&c->ids, PlatWallClockMillis());
+    const PSCHAR* envBlock = built ? ChildEnvironment(c, &submit, &job, p->readNanos) : NULL;
+    built = envBlock != NULL;
+    if (!built)
+    {
+        IpcEncodeCompletion(out, &answer);
+        return false;
+    }
+
+    ServerRun* run = &c->runs[c->running];
+    run->startNanos = PlatMonotonicNanos();
+    if (!PlatSpawnInDirectory(c->self, cmd.data, envBlock, submit.cwd, &run->proc))
+    {
+        answer.status = IPC_SPAWN_FAILED;
+        answer.exitCode = PlatLastError();
+        IpcEncodeCompletion(out, &answer);
+        return false;
+    }
+    run->id = frame.id;
+    run->run = job;
+    run->spawnedNanos = PlatMonotonicNanos();
+    GovernorAttach(&c->dispatch->governor, &run->govern, &run->proc, (JobClass)p->item.cls);
+    run->claim = p->claim;
+    ResourceClaimInit(&p->claim);
+    c->running++;
+
+    // TRACE: One track per submission; the child launcher adds its own.
+    // Admission runs from the frame's arrival, so it includes the queue.
+    run->track = PsAtomicFetchAdd(c->nextTrack, 1) + 1;
+    TraceNameTrack(&c->trace, run->track, "job", frame.id);
+    TraceSpan(&c->trace, run->track, &job, "admission", p->readNanos, run->startNanos);
+    TraceSpanArg(&c->trace, run->track, &job, "spawn", run->startNanos, run->spawnedNanos, "pid", run->proc.pid);
+    return true;
+}
+
+// GRANT: Free run slots go first to submissions whose tags came free,
+// then to the next jobs in the queue - which wait in line instead if
+// their tags are busy - whichever connection they came from; each
+// connection starts its own
+static void Grant(Connection* c, IpcWriter* out)
+{
+    Dispatch* d = c->dispatch;
+    Pending* mine[SERVER_MAX_RUNNING];
+    Lock(d);
+    while (d->running < SERVER_MAX_RUNNING)
+    {
+        Pending* p;
+        ResourceClaim* freed = ResourceNext(&d->resources);
+        if (freed)
+            p = (Pending*)((uint8_t*)freed - offsetof(Pending, claim));
+        else
+        {
+            p = (Pending*)JobQueuePop(&d->queue);
+            if (!p)
+                break;
+            if (!ResourceAcquire(&d->resources, &p->claim))
+                continue;
+        }
+        d->running++;
+        p->owner->grants[p->owner->granted++] = p;
+    }
+    uint32_t count = c->granted;
+    PsMemCpy(mine, c->grants, count * sizeof(Pending*));
+    c->granted = 0;
+    Unlock(d);
+
+    uint32_t failed = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        c->waiting--;
+        if (!Start(c, mine[i], out))
+            mine[failed++] = mine[i];
+    }
+    if (failed)
+    {
+        Lock(d);
+        d->running -= failed;
+        for (uint32_t i = 0; i < failed; i++)
+            ResourceRelease(&d->resources, &mine[i]->claim);
+        Unlock(d);
+    }
+    // RESET: Nothing of ours is queued or granted, so no frame is needed
+    if (c->waiting == 0 && c->pending)
+    {
+        ArenaRestore(&c->queued, 0);
+        c->pending = NULL;
+    }
+}
+
+// Completions for every run that has exited
+static void Reap(Connection* c, IpcWriter* out)
+{
+    uint32_t finished = 0;
+    for (uint32_t i = 0; i < c->running;)
+    {
+        ServerRun* run = &c->runs[i];
+        uint32_t exitCode;
+        if (!PlatPollProcess(&run->proc, &exitCode))
+        {
+            i++;
+            continue;
+        }
+        uint64_t now = PlatMonotonicNanos();
+        IpcCompletion done = { run->id, IPC_COMPLETED, exitCode, (now - run->startNanos) / 1000 };
+        TraceSpanArg(&c->trace, run->track, &run->run, "run", run->spawnedNanos, now, "exitCode", exitCode);
+        IpcEncodeCompletion(out, &done);
+        GovernorRelease(&run->govern);
+        PlatCloseProcess(&run->proc);
+        c->reaped[finished++] = run->claim;
+        c->runs[i] = c->runs[--c->running];
+    }
+    if (finished)
+    {
+        Lock(c->dispatch);
+        c->dispatch->running -= finished;
+        for (uint32_t i = 0; i < finished; i++)
+            ResourceRelease(&c->dispatch->resources, &c->reaped[i]);
+        Unlock(c->dispatch);
+    }
+}
+
+// GOVERNOR: Bulk runs follow the machine's pressure; whichever connection
+// finds a sample due takes it for all
+static void Govern(Connection* c)
+{
+    Dispatch* d = c->dispatch;
+    if (!GovernorEnabled(&d->governor) || c->running == 0)
+        return;
+    uint64_t now = PlatMonotonicNanos() / 1000000;
+    Lock(d);
+    bool pressed = GovernorCheck(&d->governor, now);
+    Unlock(d);
+    for (uint32_t i = 0; i < c->running; i++)
+        GovernorApply(&d->governor, &c->runs[i].govern, pressed, now);
+}
+
+//--------------------------------------------------------------------------
+// CONNECTION THREAD
+//--------------------------------------------------------------------------
+static void Serve(void* arg)
+{
+    Connection* c = (Connection*)arg;
+    TraceBegin(&c->trace, &c->arena, "ps-launcher -Serve", TRACE_DEFAULT_EVENTS);
+    TraceSetRun(&c->trace, c->session, c->parent);
+    uint8_t* in = (uint8_t*)ArenaAlloc(&c->arena, IPC_MAX_FRAME);
+    IpcWriter out;
+    size_t inLen = 0;
+    bool alive = in != NULL && IpcWriterInit(&out, &c->arena, 4096);
+
+    while (alive && PsAtomicFetchAdd(c->stopping, 0) == 0)
+    {
+        // SUBMISSIONS: Every whole frame, while there is room to queue it
+        size_t pos = 0, size;
+        IpcFrame frame;
+        bool bad = false, full = false;
+        while ((size = IpcParseFrame(in + pos, inLen - pos, &frame, &bad)) > 0)
+        {
+            if (!Queue(c, &frame, in + pos, size, &out))
+            {
+                full = true;
+                break;
+            }
+            pos += size;
+        }
+        if (bad)
+            break;
+        // OVERLAP: The rest is behind pos, so a forward byte copy is safe
+        inLen -= pos;
+        for (size_t i = 0; pos && i < inLen; i++)
+            in[i] = in[pos + i];
+
+        Reap(c, &out);
+        Grant(c, &out);
+        Govern(c);
+        if (out.len)
+        {
+            alive = PlatIpcWrite(&c->conn, out.data, out.len);
+            out.len = 0;
+        }
+
+        // BACKPRESSURE: With no room to queue, leave the client's frames unread
+        if (full)
+        {
+            PlatSleepMillis(SERVER_REAP_MS);
+            continue;
+        }
+        size_t got;
+        PlatIpcStatus status = PlatIpcRead(&c->conn, in + inLen, IPC_MAX_FRAME - inLen,
+                                           c->running || c->waiting ? SERVER_REAP_MS : SERVER_POLL_MS, &got);
+        if (status == PLAT_IPC_CLOSED)
+            break;
+        if (status == PLAT_IPC_OK)
+        {
+            inLen += got;
+            c->readNanos = PlatMonotonicNanos();
+        }
+    }
+
+    // Queued, waiting and granted submissions go with their client; runs
+    // outlive it, and only our handles - and their slots and tags - go
+    Lock(c->dispatch);
+    for (Pending* p = c->pending; p; p = p->next)
+    {
+        JobQueueRemove(&c->dispatch->queue, &p->item);
+        ResourceRelease(&c->dispatch->resources, &p->claim);
+    }
+    for (uint32_t i = 0; i < c->running; i++)
+        ResourceRelease(&c->dispatch->resources, &c->runs[i].claim);
+    c->dispatch->running -= c->granted + c->running;
+    c->granted = 0;
+    Unlock(c->dispatch);
+    for (uint32_t i = 0; i < c->running; i++)
+    {
+        GovernorRelease(&c->runs[i].govern);
+        PlatCloseProcess(&c->runs[i].proc);
+    }
+    c->running = 0;
+    TraceClose(&c->trace);
+    PlatIpcClose(&c->conn);
+    PsAtomicFetchAdd(&c->done, 1);
+}
+
+//--------------------------------------------------------------------------
+// ACCEPT LOOP
+//--------------------------------------------------------------------------
+static void Finish(Connection* c)
+{
+    PlatJoinThread(&c->thread);
+    ArenaRelease(&c->queued);
+    ArenaRelease(&c->scratch);
+    ArenaRelease(&c->arena);
+    c->used = false;
+}
+
+// A free slot, reclaiming those whose client has gone
+static Connection* FreeSlot(Server* server)
+{
+    Connection* found = NULL;
+    for (int i = 0; i < SERVER_MAX_CONNECTIONS; i++)
+    {
+        Connection* c = &server->connections[i];
+        if (c->used && PsAtomicFetchAdd(&c->done, 0) != 0)
+            Finish(c);
+        if (!c->used && !found)
+            found = c;
+    }
+    return found;
+}
+
+static bool StartConnection(Server* server, Connection* c, const PlatIpc* conn)
+{
+    if (!ArenaInit(&c->arena, ARENA_DEFAULT_RESERVE))
+        return false;
+    if (!ArenaInit(&c->scratch, SERVER_SCRATCH_RESERVE))
+    {
+        ArenaRelease(&c->arena);
+        return false;
+    }
+    if (!ArenaInit(&c->queued, SERVER_QUEUE_BYTES))
+    {
+        ArenaRelease(&c->scratch);
+        ArenaRelease(&c->arena);
+        return false;
+    }
+    c->conn = *conn;
+    c->self = server->self;
+    c->stopping = &server->stopping;
+    c->nextTrack = &server->nextTrack;
+    c->session = &server->session;
+    c->parent = &server->parent;
+    RunIdSeed(&c->ids);
+    c->readNanos = PlatMonotonicNanos();
+    c->done = 0;
+    c->dispatch = &server->dispatch;
+    c->submitter = ((uint64_t)1 << 63) | ++server->accepted;
+    c->pending = NULL;
+    c->waiting = 0;
+    c->granted = 0;
+    c->running = 0;
+    c->used = true;
+    if (PlatStartThread(&c->thread, Serve, c))
+        return true;
+    ArenaRelease(&c->queued);
+    ArenaRelease(&c->scratch);
+    ArenaRelease(&c->arena);
+    c->used = false;
+    return false;
+}
+
+int RunServer(Arena* arena, const PSCHAR* endpoint)
+{
+    PSCHAR defaultEndpoint[PS_MAX_PATH];
+    if (!endpoint)
+    {
+        if (!IpcEndpoint(defaultEndpoint, PS_MAX_PATH))
+        {
+            LogWrite(PS_T("ERROR: Cannot determine the server endpoint"));
+            return 1;
+        }
+        endpoint = defaultEndpoint;
+    }
+
+    Server* server = (Server*)ArenaAlloc(arena, sizeof(Server));
+    if (!server)
+        return 1;
+    PsMemSet(server, 0, sizeof(*server));
+    if (!JobQueueInit(&server->dispatch.queue, arena, SERVER_MAX_QUEUED))
+        return 1;
+    ResourceInit(&server->dispatch.resources);
+    if (!PlatGetExecutablePath(server->self, PS_MAX_PATH))
+    {
+        LogWrite(PS_T("ERROR: Cannot locate the launcher executable"));
+        return 1;
+    }
+
+    PlatIpc listener;
+    if (!PlatIpcListen(&listener, endpoint))
+    {
+        LogFormat(PS_T("ERROR: Cannot listen on endpoint (in use?): %s"), endpoint);
+        return 1;
+    }
+    LogFormat(PS_T("Serving: %s"), endpoint);
+    if (GovernorInit(&server->dispatch.governor))
+        LogNumber(PS_T("Governor: bulk runs suspended at pressure (%): "), server->dispatch.governor.suspendAbove / 100);
+    RunIdSource ids;
+    PSCHAR idText[RUN_ID_CHARS + 1];
+    RunIdBegin(&ids, &server->session, &server->parent);
+    RunIdFormat(&server->session, idText);
+    LogFormat(PS_T("Run id: %s"), idText);
+    CloseLog();                         // Child launches rewrite the log
+
+    for (;;)
+    {
+        PlatIpc conn;
+        if (PlatIpcAccept(&listener, &conn) != PLAT_IPC_OK)
+            break;
+        Connection* c = FreeSlot(server);
+        if (!c || !StartConnection(server, c, &conn))
+            PlatIpcClose(&conn);        // Full: the client sees it closed
+    }
+
+    // Endpoint gone: connections stop within a poll interval
+    PsAtomicFetchAdd(&server->stopping, 1);
+    for (int i = 0; i < SERVER_MAX_CONNECTIONS; i++)
+    {
+        if (server->connections[i].used)
+            Finish(&server->connections[i]);
+    }
+    PlatIpcClose(&listener);
+    return 0;
+}
@@ -0,0 +1,52 @@
+//--------------------------------------------------------------------------
+// SUBMISSION SERVER - Launches submitted over the local endpoint
+//--------------------------------------------------------------------------
+// "ps-launcher -Serve [endpoint]" stays resident and accepts submissions
+// in the framed protocol of ipc.h. The default endpoint is
+// PS_LAUNCHER_ENDPOINT, else <state directory>/ps-launcher.sock on POSIX
+// and \\.\pipe\ps-launcher-<user name> on Windows.
+//
+// Each submission becomes a child launcher of this executable:
+//   ps-launcher -Script <script> <args...>
+// with the submission's variables on top of the server's environment and
+// its working directory, so the whole launch sequence (policy, catalogue
+// aliases, incremental mode, result cache, journal) applies as if the
+// client had started it. A submission naming a profile is only run if its
+// script is a catalogue alias using that profile; anything else is
+// answered IPC_REJECTED without starting a process.
+//
+// Every connection has its own thread and arena. Up to SERVER_MAX_RUNNING
+// submissions run at once across the server; the rest wait in one queue
+// (jobqueue.h) ordered by the submission's class, then its deadline, then
+// fair share between submitters, so an interactive job or one due soon
+// never waits behind another client's 500-job batch. A submission without
+// a submitter field shares as its connection. Once SERVER_MAX_QUEUED wait,
+// or a connection holds SERVER_QUEUE_BYTES of waiting frames, the server
+// stops reading from that client, which holds it back. Completions are
+// written as runs exit, several per write when they finish together.
+//
+// On POSIX deleting the socket file stops the server. A client that
+// disconnects leaves its runs going, their completions dropped; what it
+// had queued is dropped with it.
+
+#ifndef PS_SERVER_H
+#define PS_SERVER_H
+
+#include "arena.h"
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+#define SERVER_MAX_CONNECTIONS 64
+#define SERVER_MAX_RUNNING     64        // Across every connection
+#define SERVER_MAX_QUEUED      131072    // Across every connection
+#define SERVER_QUEUE_BYTES     ((size_t)64 << 20)   // Waiting frames, per connection
+#define SERVER_REAP_MS         10        // Child exit checks while runs are going
+
+// Resident loop (-Serve). endpoint NULL means the default. Returns 0 once
+// the endpoint is removed, 1 if it cannot be created.
+int RunServer(Arena* arena, const PSCHAR* endpoint);
+
+PS_EXTERN_C_END
+
+#endif // PS_SERVER_H
@@ -0,0 +1,33 @@
+//--------------------------------------------------------------------------
+// SHA-256 - Content hashes for catalogued scripts, CRT-free
+//--------------------------------------------------------------------------
+// FIPS 180-4. Used where a hash must also stand up to deliberate tampering
+// (the catalogue's expected hashes), so FNV-style checksums will not do.
+
+#ifndef PS_SHA256_H
+#define PS_SHA256_H
+
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+#define SHA256_DIGEST_SIZE 32
+
+typedef struct Sha256
+{
+    uint32_t state[8];
+    uint64_t length;             // Bytes hashed so far
+    uint8_t block[64];
+    size_t blockLen;
+} Sha256;
+
+void Sha256Init(Sha256* ctx);
+void Sha256Update(Sha256* ctx, const void* data, size_t size);
+void Sha256Final(Sha256* ctx, uint8_t digest[SHA256_DIGEST_SIZE]);
+
+// One-shot convenience
+void Sha256Hash(const void* data, size_t size, uint8_t digest[SHA256_DIGEST_SIZE]);
+
+PS_EXTERN_C_END
+
+#endif // PS_SHA256_H
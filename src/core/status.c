@@ -0,0 +1,396 @@
+//--------------------------------------------------------------------------
+// STATUS BOARD - Live view of this user's launches in shared memory
+//--------------------------------------------------------------------------
+#include "status.h"
+#include "psatomic.h"
+#include "psmem.h"
+#include "psstr.h"
+
+#define STATUS_MAGIC   0x534C5350u     // "PSLS"
+#define STATUS_VERSION 1
+#define STATUS_ENV     PS_T("PS_LAUNCHER_STATUS_BOARD")
+
+struct StatusHeader
+{
+    volatile uint32_t magic;
+    volatile uint32_t version;
+    volatile uint32_t slotCount;
+    volatile uint32_t entrySize;
+    volatile uint32_t hint;            // Where the next claim starts probing
+    volatile uint32_t nextRunId;
+    uint32_t reserved[10];             // 64 bytes: slots start on a cache line
+};
+
+struct StatusSlot
+{
+    volatile uint32_t owner;           // Pid, 0 when free
+    volatile uint32_t seq;             // Odd while the owner is writing
+    StatusEntry entry;
+};
+
+// LAYOUT: Shared with other builds of the launcher; a change of either
+// size needs a new STATUS_VERSION
+typedef char StatusHeaderSize[sizeof(struct StatusHeader) == 64 ? 1 : -1];
+typedef char StatusSlotSize[sizeof(struct StatusSlot) == 256 ? 1 : -1];
+
+#define STATUS_BOARD_BYTES (sizeof(struct StatusHeader) + STATUS_SLOTS * sizeof(struct StatusSlot))
+
+bool StatusBoardOpen(StatusBoard* board, const PSCHAR* name, bool create)
+{
+    PSCHAR fromEnv[128];
+    if (!name)
+        name = PlatGetEnv(STATUS_ENV, fromEnv, 128) && fromEnv[0] ? fromEnv : STATUS_BOARD_NAME;
+    if (!PlatOpenShared(name, STATUS_BOARD_BYTES, create, &board->shared))
+        return false;
+    board->header = (struct StatusHeader*)board->shared.base;
+    board->slots = (struct StatusSlot*)(board->header + 1);
+
+    // FIRST OPEN: Everyone racing to set the header writes the same values,
+    // and the magic goes last
+    struct StatusHeader* h = board->header;
+    if (PsAtomicLoad(&h->magic) == 0)
+    {
+        PsAtomicStore(&h->version, STATUS_VERSION);
+        PsAtomicStore(&h->slotCount, STATUS_SLOTS);
+        PsAtomicStore(&h->entrySize, (uint32_t)sizeof(StatusEntry));
+        PsAtomicCompareExchange(&h->magic, 0, STATUS_MAGIC);
+    }
+    if (PsAtomicLoad(&h->magic) != STATUS_MAGIC || h->version != STATUS_VERSION ||
+        h->slotCount != STATUS_SLOTS || h->entrySize != sizeof(StatusEntry))
+    {
+        StatusBoardClose(board);
+        return false;
+    }
+    return true;
+}
+
+void StatusBoardClose(StatusBoard* board)
+{
+    PlatCloseShared(&board->shared);
+    board->header = NULL;
+    board->slots = NULL;
+}
+
+// Owner only: bracket the write with an odd count
+static void WriteEntry(struct StatusSlot* slot, const StatusEntry* entry)
+{
+    uint32_t seq = slot->seq;
+    PsAtomicStore(&slot->seq, seq + 1);
+    PsAtomicFence();                    // The odd count is seen before any new byte
+    PsMemCpy(&slot->entry, entry, sizeof(StatusEntry));
+    PsAtomicStore(&slot->seq, seq + 2);
+}
+
+int StatusClaim(StatusBoard* board, uint32_t ownerPid)
+{
+    static const StatusEntry empty;
+    uint32_t start = PsAtomicFetchAdd(&board->header->hint, 1);
+    int claimed = -1;
+
+    // PASS 1: Free slots, from a start that moves on with every claim
+    for (uint32_t i = 0; i < STATUS_SLOTS && claimed < 0; i++)
+    {
+        uint32_t index = (start + i) % STATUS_SLOTS;
+        if (PsAtomicLoad(&board->slots[index].owner) == 0 &&
+            PsAtomicCompareExchange(&board->slots[index].owner, 0, ownerPid))
+            claimed = (int)index;
+    }
+
+    // PASS 2: Slots of launchers that died holding them. Of several
+    // claimers that see the same dead owner, one swap succeeds.
+    for (uint32_t i = 0; i < STATUS_SLOTS && claimed < 0; i++)
+    {
+        uint32_t index = (start + i) % STATUS_SLOTS;
+        uint32_t owner = PsAtomicLoad(&board->slots[index].owner);
+        if (owner != 0 && owner != ownerPid && !PlatProcessAlive(owner) &&
+            PsAtomicCompareExchange(&board->slots[index].owner, owner, ownerPid))
+            claimed = (int)index;
+    }
+    if (claimed < 0)
+        return -1;
+
+    // A dead owner may have stopped mid-write: even the count out first
+    struct StatusSlot* slot = &board->slots[claimed];
+    if (slot->seq & 1)
+        PsAtomicStore(&slot->seq, slot->seq + 1);
+    WriteEntry(slot, &empty);
+    return claimed;
+}
+
+void StatusPublish(StatusBoard* board, int slot, const StatusEntry* entry)
+{
+    WriteEntry(&board->slots[slot], entry);
+}
+
+void StatusRelease(StatusBoard* board, int slot)
+{
+    static const StatusEntry empty;
+    WriteEntry(&board->slots[slot], &empty);
+    PsAtomicStore(&board->slots[slot].owner, 0);
+}
+
+uint64_t StatusNextRunId(StatusBoard* board)
+{
+    uint32_t id = PsAtomicFetchAdd(&board->header->nextRunId, 1) + 1;
+    if (id == 0)
+        id = PsAtomicFetchAdd(&board->header->nextRunId, 1) + 1;
+    return id;
+}
+
+size_t StatusSnapshot(StatusBoard* board, StatusEntry* out, size_t max)
+{
+    size_t count = 0;
+    for (uint32_t i = 0; i < STATUS_SLOTS && count < max; i++)
+    {
+        struct StatusSlot* slot = &board->slots[i];
+        uint32_t owner = PsAtomicLoad(&slot->owner);
+        if (owner == 0)
+            continue;
+
+        // READ: Retry while the owner is writing or has written meanwhile;
+        // a slot that never settles is left out of this snapshot
+        for (int tries = 0; tries < STATUS_READ_TRIES; tries++)
+        {
+            uint32_t before = PsAtomicLoad(&slot->seq);
+            if (before & 1)
+                continue;
+            PsMemCpy(&out[count], &slot->entry, sizeof(StatusEntry));
+            PsAtomicFence();
+            if (PsAtomicLoad(&slot->seq) != before)
+                continue;
+            // A new owner's first write has not landed yet
+            if (out[count].runId != 0 && out[count].launcherPid == owner)
+                count++;
+            break;
+        }
+    }
+    return count;
+}
+
+// A tail cut must not start inside a character
+static bool IsContinuation(PSCHAR c)
+{
+    return sizeof(PSCHAR) == 1 ? ((unsigned)c & 0xC0u) == 0x80u
+                               : ((unsigned)c & 0xFC00u) == 0xDC00u;
+}
+
+void StatusSetScript(StatusEntry* entry, const PSCHAR* script)
+{
+    size_t len = PsStrLen(script);
+    size_t utf8 = PlatToUtf8(script, len, entry->script, STATUS_SCRIPT_BYTES);
+    if (utf8 > 0 || len == 0)
+    {
+        entry->scriptLen = (uint16_t)utf8;
+        return;
+    }
+
+    // TOO LONG: Keep as much of the end as fits after "..."
+    PsMemCpy(entry->script, "...", 3);
+    size_t keep = STATUS_SCRIPT_BYTES - 3 < len ? STATUS_SCRIPT_BYTES - 3 : len;
+    for (; keep > 0; keep--)
+    {
+        const PSCHAR* tail = script + len - keep;
+        if (IsContinuation(tail[0]))
+            continue;
+        utf8 = PlatToUtf8(tail, keep, entry->script + 3, STATUS_SCRIPT_BYTES - 3);
+        if (utf8 > 0)
+            break;
+    }
+    entry->scriptLen = (uint16_t)(3 + utf8);
+}
+
+#ifdef ENABLE_STATUS_BOARD
+
+static StatusBoard g_board;
+static StatusEntry g_entry;
+static int g_slot = -1;
+
+void StatusBegin(const PSCHAR* script, StatusKind kind)
+{
+    if (g_slot >= 0 || !StatusBoardOpen(&g_board, NULL, true))
+        return;
+    uint32_t pid = PlatCurrentProcessId();
+    g_slot = StatusClaim(&g_board, pid);
+    if (g_slot < 0)
+    {
+        StatusBoardClose(&g_board);
+        return;
+    }
+    PsMemSet(&g_entry, 0, sizeof(g_entry));
+    g_entry.runId = StatusNextRunId(&g_board);
+    g_entry.startMillis = PlatWallClockMillis();
+    g_entry.launcherPid = pid;
+    g_entry.kind = (uint8_t)kind;
+    g_entry.phase = (uint8_t)(kind == STATUS_RUN ? STATUS_STARTING : STATUS_RESIDENT);
+    StatusSetScript(&g_entry, script ? script : PS_T(""));
+    StatusPublish(&g_board, g_slot, &g_entry);
+}
+
+void StatusSetPhase(StatusPhase phase, uint32_t childPid)
+{
+    if (g_slot < 0)
+        return;
+    g_entry.phase = (uint8_t)phase;
+    g_entry.childPid = childPid;
+    StatusPublish(&g_board, g_slot, &g_entry);
+}
+
+void StatusProgress(uint64_t cpuMicros, uint64_t outputBytes)
+{
+    if (g_slot < 0)
+        return;
+    g_entry.cpuMicros = cpuMicros;
+    g_entry.outputBytes = outputBytes;
+    StatusPublish(&g_board, g_slot, &g_entry);
+}
+
+void StatusEnd(void)
+{
+    if (g_slot < 0)
+        return;
+    StatusRelease(&g_board, g_slot);
+    StatusBoardClose(&g_board);
+    g_slot = -1;
+}
+
+//--------------------------------------------------------------------------
+// STATUS MODE - ps-launcher -Status
+//--------------------------------------------------------------------------
+// Lines are assembled in UTF-8: the scripts already are
+typedef struct StatusLine
+{
+    char text[STATUS_SCRIPT_BYTES + 128];
+    size_t len;
+} StatusLine;
+
+static void PutText(StatusLine* line, const char* text, size_t len)
+{
+    size_t room = sizeof(line->text) - line->len;
+    if (len > room)
+        len = room;
+    PsMemCpy(line->text + line->len, text, len);
+    line->len += len;
+}
+
+static void PutNumber(StatusLine* line, uint64_t value)
+{
+    char digits[20];
+    size_t n = 0;
+    do
+    {
+        digits[sizeof(digits) - ++n] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    PutText(line, digits + sizeof(digits) - n, n);
+}
+
+// Micro- or milliseconds as seconds with a fixed number of decimals
+static void PutSeconds(StatusLine* line, uint64_t value, uint64_t perSecond, int decimals)
+{
+    uint64_t scale = decimals == 1 ? 10 : 100;
+    uint64_t scaled = value / (perSecond / scale);
+    PutNumber(line, scaled / scale);
+    PutText(line, ".", 1);
+    uint64_t fraction = scaled % scale;
+    if (decimals == 2 && fraction < 10)
+        PutText(line, "0", 1);
+    PutNumber(line, fraction);
+    PutText(line, "s", 1);
+}
+
+static void PadTo(StatusLine* line, size_t column)
+{
+    while (line->len < column)
+        PutText(line, " ", 1);
+    if (line->len > column)
+        PutText(line, " ", 1);
+}
+
+static void PutLabel(StatusLine* line, const char* label)
+{
+    PutText(line, label, PsStrLen8(label));
+}
+
+static void WriteLine(StatusLine* line)
+{
+    PutText(line, "\n", 1);
+    PlatWriteFile(PlatStandardOutput(), line->text, line->len);
+    line->len = 0;
+}
+
+int ShowStatusBoard(Arena* arena)
+{
+    static const char* const kinds[] = { "run", "schedule", "watch", "serve" };
+    static const char* const phases[] = { "starting", "running", "finishing", "resident" };
+    static const size_t columns[] = { 0, 8, 16, 24, 34, 45, 55, 64, 76 };
+
+    StatusLine line = { { 0 }, 0 };
+    PutLabel(&line, "RUN");
+    PadTo(&line, columns[1]);
+    PutLabel(&line, "PID");
+    PadTo(&line, columns[2]);
+    PutLabel(&line, "CHILD");
+    PadTo(&line, columns[3]);
+    PutLabel(&line, "KIND");
+    PadTo(&line, columns[4]);
+    PutLabel(&line, "PHASE");
+    PadTo(&line, columns[5]);
+    PutLabel(&line, "ELAPSED");
+    PadTo(&line, columns[6]);
+    PutLabel(&line, "CPU");
+    PadTo(&line, columns[7]);
+    PutLabel(&line, "OUTPUT");
+    PadTo(&line, columns[8]);
+    PutLabel(&line, "SCRIPT");
+    WriteLine(&line);
+
+    // NO BOARD: Nothing has run since boot (POSIX) or nothing runs (Windows)
+    StatusBoard board;
+    if (!StatusBoardOpen(&board, NULL, false))
+        return 0;
+    StatusEntry* entries = (StatusEntry*)ArenaAlloc(arena, STATUS_SLOTS * sizeof(StatusEntry));
+    size_t count = entries ? StatusSnapshot(&board, entries, STATUS_SLOTS) : 0;
+    StatusBoardClose(&board);
+
+    // Oldest first (insertion sort: a few hundred entries at most)
+    for (size_t i = 1; i < count; i++)
+    {
+        StatusEntry e = entries[i];
+        size_t j = i;
+        for (; j > 0 && entries[j - 1].startMillis > e.startMillis; j--)
+            entries[j] = entries[j - 1];
+        entries[j] = e;
+    }
+
+    uint64_t now = PlatWallClockMillis();
+    for (size_t i = 0; i < count; i++)
+    {
+        const StatusEntry* e = &entries[i];
+        if (!PlatProcessAlive(e->launcherPid))
+            continue;
+        PutNumber(&line, e->runId);
+        PadTo(&line, columns[1]);
+        PutNumber(&line, e->launcherPid);
+        PadTo(&line, columns[2]);
+        if (e->childPid)
+            PutNumber(&line, e->childPid);
+        else
+            PutText(&line, "-", 1);
+        PadTo(&line, columns[3]);
+        PutLabel(&line, e->kind <= STATUS_SERVE ? kinds[e->kind] : "?");
+        PadTo(&line, columns[4]);
+        PutLabel(&line, e->phase <= STATUS_RESIDENT ? phases[e->phase] : "?");
+        PadTo(&line, columns[5]);
+        PutSeconds(&line, now > e->startMillis ? now - e->startMillis : 0, 1000, 1);
+        PadTo(&line, columns[6]);
+        PutSeconds(&line, e->cpuMicros, 1000000, 2);
+        PadTo(&line, columns[7]);
+        PutNumber(&line, e->outputBytes);
+        PadTo(&line, columns[8]);
+        PutText(&line, e->script, e->scriptLen <= STATUS_SCRIPT_BYTES ? e->scriptLen : 0);
+        WriteLine(&line);
+    }
+    return 0;
+}
+
+#endif // ENABLE_STATUS_BOARD
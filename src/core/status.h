@@ -0,0 +1,129 @@
+//--------------------------------------------------------------------------
+// STATUS BOARD - Live view of this user's launches in shared memory
+//--------------------------------------------------------------------------
+// Every launcher publishes what it is doing in one slot of a board shared
+// by all of the user's processes (PlatOpenShared): run id, script, its
+// own and the child's pid, start time, phase, and the child's CPU time
+// and captured output so far, refreshed every STATUS_REFRESH_MS while the
+// child runs. Resident modes (-Schedule, -Watch, -Serve) hold a slot for
+// as long as they are up; the launches they start publish their own.
+//
+// Nothing takes a lock and nothing touches disk:
+// - A slot is claimed by compare-and-swap of its owner pid from 0, probing
+//   from a rotating start. A slot whose owner is no longer alive is taken
+//   over the same way, so a launcher that crashed costs nothing.
+// - The owner writes its entry under a sequence counter that is odd while
+//   a write is in progress. Readers copy the entry and retry if the count
+//   was odd or has moved, so every entry read is one the owner wrote.
+// "ps-launcher -Status" copies the live slots and prints them; the log
+// file is not opened for it.
+//
+// PS_LAUNCHER_STATUS_BOARD names another board (the tests use their own).
+// With ENABLE_STATUS_BOARD undefined the launcher's calls compile away;
+// the board itself stays available to tests and tools.
+
+#ifndef PS_STATUS_H
+#define PS_STATUS_H
+
+#include "arena.h"
+#include "config.h"
+#include "platform.h"
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+#define STATUS_BOARD_NAME   PS_T("ps-launcher-status")
+#define STATUS_SLOTS        256
+#define STATUS_SCRIPT_BYTES 204     // UTF-8, cut at a character boundary to fit
+#define STATUS_REFRESH_MS   500     // CPU and output refresh while a child runs
+#define STATUS_READ_TRIES   64      // Seqlock retries before a slot is skipped
+
+typedef enum StatusKind
+{
+    STATUS_RUN,
+    STATUS_SCHEDULE,
+    STATUS_WATCH,
+    STATUS_SERVE
+} StatusKind;
+
+typedef enum StatusPhase
+{
+    STATUS_STARTING,       // Arguments, policy, lookups, caches
+    STATUS_RUNNING,        // The child is running
+    STATUS_FINISHING,      // The child has exited; results are being stored
+    STATUS_RESIDENT        // A resident mode waiting for its next run
+} StatusPhase;
+
+// One slot's published state. runId 0: claimed, nothing published yet.
+typedef struct StatusEntry
+{
+    uint64_t runId;
+    uint64_t startMillis;              // Unix epoch
+    uint64_t cpuMicros;                // The child's, as of the last refresh
+    uint64_t outputBytes;              // Captured output so far; 0 when not captured
+    uint32_t launcherPid;
+    uint32_t childPid;                 // 0 until the child starts
+    uint8_t kind;                      // StatusKind
+    uint8_t phase;                     // StatusPhase
+    uint16_t scriptLen;
+    char script[STATUS_SCRIPT_BYTES];  // Not terminated
+} StatusEntry;
+
+struct StatusHeader;
+struct StatusSlot;
+
+typedef struct StatusBoard
+{
+    PlatShared shared;
+    struct StatusHeader* header;
+    struct StatusSlot* slots;
+} StatusBoard;
+
+// name NULL: PS_LAUNCHER_STATUS_BOARD, else STATUS_BOARD_NAME. create
+// false fails while no launcher has created the board.
+bool StatusBoardOpen(StatusBoard* board, const PSCHAR* name, bool create);
+void StatusBoardClose(StatusBoard* board);
+
+// A free or abandoned slot now owned by ownerPid; -1 if every slot is
+// held by a live process
+int StatusClaim(StatusBoard* board, uint32_t ownerPid);
+
+// Owner only: replace the slot's entry / clear it and give the slot up
+void StatusPublish(StatusBoard* board, int slot, const StatusEntry* entry);
+void StatusRelease(StatusBoard* board, int slot);
+
+// Unique per board, never 0
+uint64_t StatusNextRunId(StatusBoard* board);
+
+// Copy every published entry into out (at most max). Owners are not
+// checked for liveness: an entry of a launcher that crashed stays until
+// its slot is claimed again. Returns the number copied.
+size_t StatusSnapshot(StatusBoard* board, StatusEntry* out, size_t max);
+
+// Fill entry's script in UTF-8. A path too long to fit keeps its end
+// (the file name), after "...".
+void StatusSetScript(StatusEntry* entry, const PSCHAR* script);
+
+#ifdef ENABLE_STATUS_BOARD
+
+// This process's slot on the default board. Every call is a no-op when
+// the board cannot be opened or is full: status is never worth a failed
+// launch.
+void StatusBegin(const PSCHAR* script, StatusKind kind);
+void StatusSetPhase(StatusPhase phase, uint32_t childPid);
+void StatusProgress(uint64_t cpuMicros, uint64_t outputBytes);
+void StatusEnd(void);
+
+// -Status: one line per live launcher on stdout. Returns 0.
+int ShowStatusBoard(Arena* arena);
+
+#else
+    #define StatusBegin(script, kind) ((void)0)
+    #define StatusSetPhase(phase, childPid) ((void)0)
+    #define StatusProgress(cpuMicros, outputBytes) ((void)0)
+    #define StatusEnd() ((void)0)
+#endif
+
+PS_EXTERN_C_END
+
+#endif // PS_STATUS_H
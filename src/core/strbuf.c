@@ -0,0 +1,80 @@
+//--------------------------------------------------------------------------
+// STRING BUILDER - Growable PSCHAR buffer on the bump arena
+//--------------------------------------------------------------------------
+#include "strbuf.h"
+#include "psmem.h"
+#include "psstr.h"
+
+bool StrBufInit(StrBuf* sb, Arena* arena, size_t initialCap, size_t limit)
+{
+    if (initialCap == 0)
+        initialCap = 1;
+    sb->arena = arena;
+    sb->len = 0;
+    sb->limit = limit;
+    sb->data = (PSCHAR*)ArenaAlloc(arena, initialCap * sizeof(PSCHAR));
+    sb->cap = sb->data ? initialCap : 0;
+    if (sb->data)
+        sb->data[0] = 0;
+    return sb->data != NULL;
+}
+
+bool StrBufReserve(StrBuf* sb, size_t extra)
+{
+    if (extra > sb->limit || sb->len > sb->limit - extra)
+        return false;
+    size_t needed = sb->len + extra + 1;
+    if (needed <= sb->cap)
+        return true;
+
+    // GEOMETRIC GROWTH: Double, so relocations stay O(log n) overall
+    size_t newCap = sb->cap * 2;
+    if (newCap < needed)
+        newCap = needed;
+
+    if (sb->data && ArenaExtend(sb->arena, sb->data, sb->cap * sizeof(PSCHAR),
+                                newCap * sizeof(PSCHAR)))
+    {
+        sb->cap = newCap;
+        return true;
+    }
+
+    PSCHAR* moved = (PSCHAR*)ArenaAlloc(sb->arena, newCap * sizeof(PSCHAR));
+    if (!moved)
+        return false;
+    PsMemCpy(moved, sb->data, (sb->len + 1) * sizeof(PSCHAR));
+    sb->data = moved;
+    sb->cap = newCap;
+    return true;
+}
+
+bool StrBufAppendN(StrBuf* sb, const PSCHAR* s, size_t n)
+{
+    if (!StrBufReserve(sb, n))
+        return false;
+    PsMemCpy(sb->data + sb->len, s, n * sizeof(PSCHAR));
+    sb->len += n;
+    sb->data[sb->len] = 0;
+    return true;
+}
+
+bool StrBufAppend(StrBuf* sb, const PSCHAR* s)
+{
+    return StrBufAppendN(sb, s, PsStrLen(s));
+}
+
+bool StrBufAppendChar(StrBuf* sb, PSCHAR c)
+{
+    if (!StrBufReserve(sb, 1))
+        return false;
+    sb->data[sb->len++] = c;
+    sb->data[sb->len] = 0;
+    return true;
+}
+
+bool StrBufAppendUInt(StrBuf* sb, uint64_t value)
+{
+    PSCHAR digits[24];
+    size_t len = 0;
+    return AppendUInt(digits, 24, value, &len) && StrBufAppendN(sb, digits, len);
+}
@@ -0,0 +1,42 @@
+//--------------------------------------------------------------------------
+// STRING BUILDER - Growable PSCHAR buffer on the bump arena
+//--------------------------------------------------------------------------
+// While a builder is the arena's most recent block it grows in place, so
+// growth costs at most one page commit and no copying. If something else
+// was allocated after it, it moves to a new block twice the size.
+//
+// The buffer is always terminated; len excludes the terminator. Appends
+// fail (leaving the content unchanged) once len would exceed limit.
+
+#ifndef PS_STRBUF_H
+#define PS_STRBUF_H
+
+#include "arena.h"
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+typedef struct StrBuf
+{
+    Arena* arena;
+    PSCHAR* data;
+    size_t len;            // Characters, excluding the terminator
+    size_t cap;            // Characters allocated, including the terminator
+    size_t limit;          // Maximum len
+} StrBuf;
+
+#define STRBUF_NO_LIMIT ((size_t)-1)
+
+bool StrBufInit(StrBuf* sb, Arena* arena, size_t initialCap, size_t limit);
+
+// Make room for extra more characters
+bool StrBufReserve(StrBuf* sb, size_t extra);
+
+bool StrBufAppendN(StrBuf* sb, const PSCHAR* s, size_t n);
+bool StrBufAppend(StrBuf* sb, const PSCHAR* s);
+bool StrBufAppendChar(StrBuf* sb, PSCHAR c);
+bool StrBufAppendUInt(StrBuf* sb, uint64_t value);
+
+PS_EXTERN_C_END
+
+#endif // PS_STRBUF_H
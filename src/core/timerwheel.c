@@ -0,0 +1,143 @@
+//--------------------------------------------------------------------------
+// TIMER WHEEL - Hierarchical timing wheel for the resident scheduler
+//--------------------------------------------------------------------------
+#include "timerwheel.h"
+#include "psbits.h"
+#include "psmem.h"
+
+#define LEVEL_BITS 6
+#define WHEEL_BITS (LEVEL_BITS * TIMER_WHEEL_LEVELS)
+
+void TimerWheelInit(TimerWheel* wheel, uint64_t now)
+{
+    PsMemSet(wheel, 0, sizeof(*wheel));
+    wheel->now = now;
+}
+
+// Link node into the slot for its expiry, relative to the current tick
+static void Place(TimerWheel* wheel, TimerNode* node)
+{
+    unsigned level = HighestBit64((node->expires ^ wheel->now) | (TIMER_WHEEL_SLOTS - 1)) / LEVEL_BITS;
+    unsigned slot = (unsigned)(node->expires >> (level * LEVEL_BITS)) & (TIMER_WHEEL_SLOTS - 1);
+
+    // Beyond the top level's current turn: the overflow list, re-placed
+    // when the wheel gets there
+    TimerNode** head;
+    if (level >= TIMER_WHEEL_LEVELS)
+    {
+        level = TIMER_WHEEL_LEVELS;
+        slot = 0;
+        head = &wheel->overflow;
+    }
+    else
+    {
+        head = &wheel->slots[level][slot];
+        wheel->occupied[level] |= (uint64_t)1 << slot;
+    }
+
+    node->level = (uint8_t)level;
+    node->slot = (uint8_t)slot;
+    node->next = *head;
+    node->pprev = head;
+    if (*head)
+        (*head)->pprev = &node->next;
+    *head = node;
+}
+
+void TimerWheelAdd(TimerWheel* wheel, TimerNode* node, uint64_t expires)
+{
+    if (node->pprev)
+        TimerWheelCancel(wheel, node);
+    node->expires = expires > wheel->now ? expires : wheel->now + 1;
+    Place(wheel, node);
+    wheel->count++;
+}
+
+void TimerWheelCancel(TimerWheel* wheel, TimerNode* node)
+{
+    if (!node->pprev)
+        return;
+    *node->pprev = node->next;
+    if (node->next)
+        node->next->pprev = node->pprev;
+    if (node->level < TIMER_WHEEL_LEVELS && !wheel->slots[node->level][node->slot])
+        wheel->occupied[node->level] &= ~((uint64_t)1 << node->slot);
+    node->next = NULL;
+    node->pprev = NULL;
+    wheel->count--;
+}
+
+// First tick of the earliest occupied slot; its level through *level
+static bool EarliestSlot(const TimerWheel* wheel, unsigned* level, uint64_t* start)
+{
+    for (unsigned l = 0; l < TIMER_WHEEL_LEVELS; l++)
+    {
+        if (!wheel->occupied[l])
+            continue;
+        // Higher groups match the current tick; this group is the slot
+        unsigned shift = l * LEVEL_BITS;
+        uint64_t above = (wheel->now >> (shift + LEVEL_BITS)) << (shift + LEVEL_BITS);
+        *level = l;
+        *start = above | ((uint64_t)LowestBit64(wheel->occupied[l]) << shift);
+        return true;
+    }
+    if (!wheel->overflow)
+        return false;
+    *level = TIMER_WHEEL_LEVELS;
+    *start = ((wheel->now >> WHEEL_BITS) + 1) << WHEEL_BITS;
+    return true;
+}
+
+bool TimerWheelNextExpiry(const TimerWheel* wheel, uint64_t* tick)
+{
+    unsigned level;
+    return EarliestSlot(wheel, &level, tick);
+}
+
+TimerNode* TimerWheelAdvance(TimerWheel* wheel, uint64_t to)
+{
+    TimerNode* expired = NULL;
+    TimerNode** tail = &expired;
+    unsigned level;
+    uint64_t start;
+
+    // Only slots whose start has come are visited; everything in between is
+    // skipped, since no timer can lie there
+    while (to > wheel->now && EarliestSlot(wheel, &level, &start) && start <= to)
+    {
+        wheel->now = start;
+        TimerNode* node;
+        if (level == TIMER_WHEEL_LEVELS)
+        {
+            node = wheel->overflow;
+            wheel->overflow = NULL;
+        }
+        else
+        {
+            unsigned slot = (unsigned)(start >> (level * LEVEL_BITS)) & (TIMER_WHEEL_SLOTS - 1);
+            node = wheel->slots[level][slot];
+            wheel->slots[level][slot] = NULL;
+            wheel->occupied[level] &= ~((uint64_t)1 << slot);
+        }
+
+        while (node)
+        {
+            TimerNode* next = node->next;
+            if (node->expires <= start)
+            {
+                // CASCADE DONE: Due now, hand it to the caller
+                node->next = NULL;
+                node->pprev = NULL;
+                *tail = node;
+                tail = &node->next;
+                wheel->count--;
+            }
+            else
+                Place(wheel, node);
+            node = next;
+        }
+    }
+    if (to > wheel->now)
+        wheel->now = to;
+    return expired;
+}
@@ -0,0 +1,74 @@
+//--------------------------------------------------------------------------
+// TIMER WHEEL - Hierarchical timing wheel for the resident scheduler
+//--------------------------------------------------------------------------
+// TIMER_WHEEL_LEVELS levels of 64 slots over an integer tick (the
+// scheduler uses seconds). A level-0 slot is one tick, a level-L slot 64^L
+// ticks, so six levels cover 2^36 ticks; later timers wait on an overflow
+// list until the top level comes round.
+//
+// A timer sits in the level of the highest 6-bit group in which its expiry
+// differs from the wheel's current tick. That keeps every occupied slot
+// ahead of the current one, so:
+// - adding and cancelling are O(1): a slot index and a list link
+// - the next expiry is the lowest set bit of the first non-empty level's
+//   occupancy mask, also O(1)
+// - advancing empties only slots whose time has come, moving timers that
+//   are not yet due into lower levels (each timer moves at most once per
+//   level), so a jump of any length costs no idle ticks
+//
+// Timers are intrusive: the caller embeds a TimerNode in its own record
+// and owns the storage. Nothing is allocated.
+
+#ifndef PS_TIMERWHEEL_H
+#define PS_TIMERWHEEL_H
+
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+#define TIMER_WHEEL_LEVELS 6
+#define TIMER_WHEEL_SLOTS  64
+
+typedef struct TimerNode
+{
+    struct TimerNode* next;          // Slot list, then the expired list
+    struct TimerNode** pprev;        // NULL when not in the wheel
+    uint64_t expires;                // Tick
+    uint8_t level;
+    uint8_t slot;
+} TimerNode;
+
+typedef struct TimerWheel
+{
+    uint64_t now;                    // Last tick processed
+    uint64_t occupied[TIMER_WHEEL_LEVELS];
+    TimerNode* slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    TimerNode* overflow;             // Beyond the top level's current turn
+    uint32_t count;
+} TimerWheel;
+
+void TimerWheelInit(TimerWheel* wheel, uint64_t now);
+
+// Schedule node at tick expires; earlier ticks fire on the next advance
+void TimerWheelAdd(TimerWheel* wheel, TimerNode* node, uint64_t expires);
+
+// Remove a pending timer (no effect if it is not in the wheel)
+void TimerWheelCancel(TimerWheel* wheel, TimerNode* node);
+
+static inline bool TimerPending(const TimerNode* node)
+{
+    return node->pprev != NULL;
+}
+
+// Earliest tick at which TimerWheelAdvance has work: exact for timers due
+// within 64 ticks, the start of the slot for later ones. False if empty.
+bool TimerWheelNextExpiry(const TimerWheel* wheel, uint64_t* tick);
+
+// Move the wheel to tick to and return the timers that expired on the way
+// as a list through next, in expiry order. They are out of the wheel, so
+// the caller may add them again.
+TimerNode* TimerWheelAdvance(TimerWheel* wheel, uint64_t to);
+
+PS_EXTERN_C_END
+
+#endif // PS_TIMERWHEEL_H
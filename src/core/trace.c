@@ -0,0 +1,257 @@
+//--------------------------------------------------------------------------
+// TRACE - Timelines of launches in the Chrome trace event format
+//--------------------------------------------------------------------------
+#include "trace.h"
+#include "psmem.h"
+#include "psstr.h"
+
+#define TRACE_LINE_BYTES 320             // One event without the detail
+
+bool TraceOpen(TraceBuffer* buffer, Arena* arena, const PSCHAR* path, const char* process,
+               size_t capacity)
+{
+    buffer->events = NULL;
+    size_t len = PsStrLen(path);
+    if (len == 0 || len >= PS_MAX_PATH || capacity == 0)
+        return false;
+    TraceEvent* events = (TraceEvent*)ArenaAlloc(arena, capacity * sizeof(TraceEvent));
+    if (!events)
+        return false;
+
+    // FIRST TRACER: Creates the file and opens the array; everyone else
+    // finds it there. Appends only follow a run, long after this write.
+    PlatFile file = PlatCreateFile(path, PLAT_FILE_CREATE_NEW);
+    if (file != PLAT_INVALID_FILE)
+    {
+        PlatWriteFile(file, "[\n", 2);
+        PlatCloseFile(file);
+    }
+
+    PsMemCpy(buffer->path, path, (len + 1) * sizeof(PSCHAR));
+    buffer->events = events;
+    buffer->count = 0;
+    buffer->capacity = capacity;
+    buffer->arena = arena;
+    buffer->pid = PlatCurrentProcessId();
+    buffer->process = process;
+    PsMemSet(&buffer->run, 0, sizeof(buffer->run));
+    PsMemSet(&buffer->parent, 0, sizeof(buffer->parent));
+    buffer->detailLen = 0;
+    return true;
+}
+
+void TraceClose(TraceBuffer* buffer)
+{
+    if (!buffer->events)
+        return;
+    TraceFlush(buffer);
+    buffer->events = NULL;
+}
+
+// A cut must not start inside a character
+static bool IsContinuation(PSCHAR c)
+{
+    return sizeof(PSCHAR) == 1 ? ((unsigned)c & 0xC0u) == 0x80u
+                               : ((unsigned)c & 0xFC00u) == 0xDC00u;
+}
+
+void TraceSetDetail(TraceBuffer* buffer, const PSCHAR* detail)
+{
+    if (!buffer->events)
+        return;
+    // TOO LONG: The end (the file name) matters most; a character takes at
+    // most three bytes per PSCHAR, so a third of the room always fits
+    size_t len = PsStrLen(detail);
+    size_t keep = len < TRACE_DETAIL_BYTES / 3 ? len : TRACE_DETAIL_BYTES / 3;
+    const PSCHAR* tail = detail + len - keep;
+    while (keep > 0 && IsContinuation(tail[0]))
+    {
+        tail++;
+        keep--;
+    }
+    size_t utf8 = PlatToUtf8(detail, len, buffer->detail, TRACE_DETAIL_BYTES);
+    buffer->detailLen = utf8 > 0 ? utf8 : PlatToUtf8(tail, keep, buffer->detail, TRACE_DETAIL_BYTES);
+}
+
+//--------------------------------------------------------------------------
+// JSON LINES
+//--------------------------------------------------------------------------
+typedef struct TraceText
+{
+    char* data;
+    size_t len;
+} TraceText;
+
+static void Put(TraceText* t, const char* text)
+{
+    size_t len = PsStrLen8(text);
+    PsMemCpy(t->data + t->len, text, len);
+    t->len += len;
+}
+
+static void PutNumber(TraceText* t, uint64_t value)
+{
+    char digits[20];
+    size_t n = 0;
+    do
+    {
+        digits[sizeof(digits) - ++n] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    PsMemCpy(t->data + t->len, digits + sizeof(digits) - n, n);
+    t->len += n;
+}
+
+// Trace timestamps are microseconds; nanoseconds become three decimals
+static void PutMicros(TraceText* t, uint64_t nanos)
+{
+    PutNumber(t, nanos / 1000);
+    uint32_t fraction = (uint32_t)(nanos % 1000);
+    char decimals[4] = { '.', (char)('0' + fraction / 100), (char)('0' + fraction / 10 % 10),
+                         (char)('0' + fraction % 10) };
+    PsMemCpy(t->data + t->len, decimals, 4);
+    t->len += 4;
+}
+
+static void PutIds(TraceText* t, const TraceBuffer* buffer, uint32_t track)
+{
+    Put(t, ",\"pid\":");
+    PutNumber(t, buffer->pid);
+    Put(t, ",\"tid\":");
+    PutNumber(t, track);
+}
+
+// The detail is UTF-8 already; quotes, backslashes and controls escaped
+static void PutDetail(TraceText* t, const TraceBuffer* buffer)
+{
+    static const char hex[] = "0123456789abcdef";
+    for (size_t i = 0; i < buffer->detailLen; i++)
+    {
+        uint8_t c = (uint8_t)buffer->detail[i];
+        if (c == '"' || c == '\\')
+        {
+            t->data[t->len++] = '\\';
+            t->data[t->len++] = (char)c;
+        }
+        else if (c < 0x20)
+        {
+            char u[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 15] };
+            PsMemCpy(t->data + t->len, u, 6);
+            t->len += 6;
+        }
+        else
+            t->data[t->len++] = (char)c;
+    }
+}
+
+static void PutRunId(TraceText* t, const char* key, const RunId* id)
+{
+    Put(t, key);
+    RunIdFormat8(id, t->data + t->len);
+    t->len += RUN_ID_CHARS;
+    Put(t, "\"");
+}
+
+static void PutEvent(TraceText* t, const TraceBuffer* buffer, const TraceEvent* e)
+{
+    switch (e->kind)
+    {
+    case TRACE_TRACK_NAME:
+        Put(t, "{\"name\":\"thread_name\",\"ph\":\"M\"");
+        PutIds(t, buffer, e->track);
+        Put(t, ",\"args\":{\"name\":\"");
+        Put(t, e->name);
+        Put(t, " ");
+        PutNumber(t, e->arg);
+        Put(t, "\"}},\n");
+        return;
+    case TRACE_INSTANT:
+        Put(t, "{\"name\":\"");
+        Put(t, e->name);
+        Put(t, "\",\"ph\":\"i\",\"s\":\"t\",\"ts\":");
+        PutMicros(t, e->startNanos);
+        break;
+    case TRACE_COUNTER:
+        Put(t, "{\"name\":\"");
+        Put(t, e->name);
+        Put(t, "\",\"ph\":\"C\",\"ts\":");
+        PutMicros(t, e->startNanos);
+        break;
+    default:
+        Put(t, "{\"name\":\"");
+        Put(t, e->name);
+        Put(t, "\",\"ph\":\"X\",\"ts\":");
+        PutMicros(t, e->startNanos);
+        Put(t, ",\"dur\":");
+        PutMicros(t, e->endNanos > e->startNanos ? e->endNanos - e->startNanos : 0);
+        break;
+    }
+    PutIds(t, buffer, e->track);
+    if (RunIdIsSet(&e->run) || e->argName)
+    {
+        Put(t, ",\"args\":{");
+        if (RunIdIsSet(&e->run))
+            PutRunId(t, "\"runId\":\"", &e->run);
+        if (e->argName)
+        {
+            Put(t, RunIdIsSet(&e->run) ? ",\"" : "\"");
+            Put(t, e->argName);
+            Put(t, "\":");
+            PutNumber(t, e->arg);
+        }
+        Put(t, "}");
+    }
+    Put(t, "},\n");
+}
+
+bool TraceFlush(TraceBuffer* buffer)
+{
+    if (!buffer->events || buffer->count == 0)
+        return true;
+    ArenaMark mark = ArenaSave(buffer->arena);
+    TraceText t;
+    t.len = 0;
+    t.data = (char*)ArenaAlloc(buffer->arena, (buffer->count + 1) * TRACE_LINE_BYTES + TRACE_DETAIL_BYTES * 6);
+    if (!t.data)
+        return false;
+
+    // Every flush names the process: a file may hold only the last one
+    Put(&t, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":");
+    PutNumber(&t, buffer->pid);
+    Put(&t, ",\"args\":{\"name\":\"");
+    Put(&t, buffer->process);
+    if (buffer->detailLen)
+    {
+        Put(&t, " ");
+        PutDetail(&t, buffer);
+    }
+    Put(&t, "\"");
+    if (RunIdIsSet(&buffer->run))
+        PutRunId(&t, ",\"runId\":\"", &buffer->run);
+    if (RunIdIsSet(&buffer->parent))
+        PutRunId(&t, ",\"parentId\":\"", &buffer->parent);
+    Put(&t, "}},\n");
+    for (size_t i = 0; i < buffer->count; i++)
+        PutEvent(&t, buffer, &buffer->events[i]);
+
+    // SINGLE WRITE: One append per flush keeps concurrent processes apart
+    PlatFile file = PlatCreateFile(buffer->path, PLAT_FILE_APPEND);
+    bool written = file != PLAT_INVALID_FILE && PlatWriteFile(file, t.data, t.len);
+    PlatCloseFile(file);
+    ArenaRestore(buffer->arena, mark);
+    if (written)
+        buffer->count = 0;
+    return written;
+}
+
+#ifdef ENABLE_TRACE
+
+bool TraceBegin(TraceBuffer* buffer, Arena* arena, const char* process, size_t capacity)
+{
+    PSCHAR path[PS_MAX_PATH];
+    buffer->events = NULL;
+    return PlatGetEnv(TRACE_ENV, path, PS_MAX_PATH) && path[0] &&
+           TraceOpen(buffer, arena, path, process, capacity);
+}
+
+#endif // ENABLE_TRACE
@@ -0,0 +1,169 @@
+//--------------------------------------------------------------------------
+// TRACE - Timelines of launches in the Chrome trace event format
+//--------------------------------------------------------------------------
+// With PS_LAUNCHER_TRACE naming a file, every launcher process records
+// what it spends its time on and appends it there as it finishes; the
+// file opens in Perfetto (ui.perfetto.dev) or chrome://tracing:
+// - a launch: queued (when the starter says), startup, resolve, checks,
+//   spawn, run, finish, on one track under the launcher's pid;
+// - -Serve: one track per submission with its admission wait (frames left
+//   unread at the running limit), spawn and run, next to the child
+//   launchers' own tracks;
+// - the engine (engine.h): one track per run with spawn, run and the
+//   first output byte; with adaptive concurrency, every decision on its
+//   own track and the limit and its signals as counters.
+// Child launchers inherit the variable, so a batch lands in one file.
+//
+// Events carry the id of the run they belong to and the process name
+// carries its own run and parent (runid.h), so a trace joins the journal.
+//
+// Recording is a store into a buffer owned by one thread (no locks, no
+// atomics, no formatting); spans are recorded once, when they end, with
+// both timestamps. A buffer is written when it fills and when its owner
+// finishes, as one append of JSON lines, so concurrent processes never
+// interleave inside an event. Timestamps are PlatMonotonicNanos, which
+// every process on the machine shares.
+//
+// The file is the JSON array format: "[" then one event per line, each
+// ending in a comma. The closing "]" is optional in that format, which is
+// what lets any number of processes append without coordinating; the
+// first process to trace creates the file and writes the "[".
+//
+// With ENABLE_TRACE undefined TraceBegin never starts a buffer, so every
+// record call returns at its first test.
+
+#ifndef PS_TRACE_H
+#define PS_TRACE_H
+
+#include "arena.h"
+#include "config.h"
+#include "platform.h"
+#include "pstypes.h"
+#include "runid.h"
+
+PS_EXTERN_C_BEGIN
+
+#define TRACE_ENV            PS_T("PS_LAUNCHER_TRACE")
+#define TRACE_LAUNCH_EVENTS  64          // A launch records about ten
+#define TRACE_DEFAULT_EVENTS 4096        // Resident modes and the engine
+#define TRACE_DETAIL_BYTES   120         // UTF-8 process detail (the script)
+
+typedef enum TraceKind
+{
+    TRACE_SPAN,            // startNanos to endNanos
+    TRACE_INSTANT,         // At startNanos
+    TRACE_TRACK_NAME,      // Names track: name followed by arg
+    TRACE_COUNTER          // Value arg of the process's counter name at startNanos
+} TraceKind;
+
+// name and argName are static strings: they are only read at flush
+typedef struct TraceEvent
+{
+    uint64_t startNanos;
+    uint64_t endNanos;
+    const char* name;
+    const char* argName;   // NULL: no argument
+    uint64_t arg;
+    uint32_t track;
+    uint32_t kind;         // TraceKind
+    RunId run;             // Unset: not one run's (runid.h)
+} TraceEvent;
+
+typedef struct TraceBuffer
+{
+    TraceEvent* events;    // NULL while not tracing: every call returns
+    size_t count;
+    size_t capacity;
+    Arena* arena;          // The owner's; flushes format on top of it
+    uint32_t pid;
+    const char* process;
+    RunId run;             // The process's own run and its parent
+    RunId parent;
+    size_t detailLen;
+    char detail[TRACE_DETAIL_BYTES];
+    PSCHAR path[PS_MAX_PATH];
+} TraceBuffer;
+
+// Start recording into a buffer for path, creating the file with its "["
+// if no process has yet. process names the process in the viewer.
+bool TraceOpen(TraceBuffer* buffer, Arena* arena, const PSCHAR* path, const char* process,
+               size_t capacity);
+
+// Flush and stop; the buffer records nothing more
+void TraceClose(TraceBuffer* buffer);
+
+// Append the events to the file in one write and empty the buffer
+bool TraceFlush(TraceBuffer* buffer);
+
+// Shown after the process name ("ps-launcher run.ps1"); cut to fit
+void TraceSetDetail(TraceBuffer* buffer, const PSCHAR* detail);
+
+static inline void TracePut(TraceBuffer* buffer, TraceKind kind, uint32_t track, const RunId* run,
+                            const char* name, uint64_t startNanos, uint64_t endNanos, const char* argName,
+                            uint64_t arg)
+{
+    if (!buffer->events)
+        return;
+    if (buffer->count == buffer->capacity && !TraceFlush(buffer))
+        buffer->count = 0;                  // Unwritable: keep the newest
+    TraceEvent* e = &buffer->events[buffer->count++];
+    e->startNanos = startNanos;
+    e->endNanos = endNanos;
+    e->name = name;
+    e->argName = argName;
+    e->arg = arg;
+    e->track = track;
+    e->kind = (uint32_t)kind;
+    e->run.high = run ? run->high : 0;
+    e->run.low = run ? run->low : 0;
+}
+
+static inline void TraceSpan(TraceBuffer* buffer, uint32_t track, const RunId* run, const char* name,
+                             uint64_t startNanos, uint64_t endNanos)
+{
+    TracePut(buffer, TRACE_SPAN, track, run, name, startNanos, endNanos, NULL, 0);
+}
+
+static inline void TraceSpanArg(TraceBuffer* buffer, uint32_t track, const RunId* run, const char* name,
+                                uint64_t startNanos, uint64_t endNanos, const char* argName, uint64_t arg)
+{
+    TracePut(buffer, TRACE_SPAN, track, run, name, startNanos, endNanos, argName, arg);
+}
+
+static inline void TraceInstant(TraceBuffer* buffer, uint32_t track, const RunId* run, const char* name,
+                                uint64_t atNanos)
+{
+    TracePut(buffer, TRACE_INSTANT, track, run, name, atNanos, atNanos, NULL, 0);
+}
+
+// Drawn as a graph per process, one series per argName
+static inline void TraceCounter(TraceBuffer* buffer, const char* name, const char* argName, uint64_t value,
+                                uint64_t atNanos)
+{
+    TracePut(buffer, TRACE_COUNTER, 0, NULL, name, atNanos, atNanos, argName, value);
+}
+
+// The track shows as "<prefix> <number>"
+static inline void TraceNameTrack(TraceBuffer* buffer, uint32_t track, const char* prefix, uint64_t number)
+{
+    TracePut(buffer, TRACE_TRACK_NAME, track, NULL, prefix, 0, 0, NULL, number);
+}
+
+// The run the process itself belongs to, shown with its name
+static inline void TraceSetRun(TraceBuffer* buffer, const RunId* run, const RunId* parent)
+{
+    buffer->run = *run;
+    buffer->parent = *parent;
+}
+
+#ifdef ENABLE_TRACE
+// TraceOpen on PS_LAUNCHER_TRACE; false (and a buffer that records
+// nothing) when it is unset or the file cannot be created
+bool TraceBegin(TraceBuffer* buffer, Arena* arena, const char* process, size_t capacity);
+#else
+    #define TraceBegin(buffer, arena, process, capacity) ((void)((buffer)->events = NULL))
+#endif
+
+PS_EXTERN_C_END
+
+#endif // PS_TRACE_H
@@ -0,0 +1,456 @@
+//--------------------------------------------------------------------------
+// WATCH MODE - One run per burst of changes in a directory
+//--------------------------------------------------------------------------
+#include "watch.h"
+#include "args.h"
+#include "config.h"
+#include "envblock.h"
+#include "log.h"
+#include "psmem.h"
+#include "psstr.h"
+#include "quote.h"
+#include "runid.h"
+
+#define CHANGESET_INITIAL_SLOTS 1024
+#define CHANGESET_MAX_NAMES     (1u << 24)
+#define CHANGELIST_CHUNK        (16 * 1024)
+
+//--------------------------------------------------------------------------
+// CHANGE SET
+//--------------------------------------------------------------------------
+// FNV-1a over the characters; names are compared exactly
+static uint32_t ChangeHash(const PSCHAR* name, size_t len)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+    {
+        h ^= (uint32_t)name[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static bool AllocSlots(ChangeSet* set, uint32_t capacity)
+{
+    uint32_t* slots = (uint32_t*)ArenaAlloc(&set->arena, capacity * sizeof(uint32_t));
+    if (!slots)
+        return false;
+    PsMemSet(slots, 0, capacity * sizeof(uint32_t));
+    set->slots = slots;
+    set->capacity = capacity;
+    return true;
+}
+
+static bool StartSet(ChangeSet* set)
+{
+    set->count = 0;
+    set->overflowed = false;
+    return AllocSlots(set, CHANGESET_INITIAL_SLOTS) &&
+           StrBufInit(&set->names, &set->arena, 4096, STRBUF_NO_LIMIT);
+}
+
+bool ChangeSetInit(ChangeSet* set)
+{
+    PsMemSet(set, 0, sizeof(*set));
+    if (!ArenaInit(&set->arena, ARENA_DEFAULT_RESERVE))
+        return false;
+    if (StartSet(set))
+        return true;
+    ArenaRelease(&set->arena);
+    return false;
+}
+
+void ChangeSetReset(ChangeSet* set)
+{
+    ArenaRestore(&set->arena, 0);
+    StartSet(set);                      // Cannot fail: it fitted before
+}
+
+void ChangeSetRelease(ChangeSet* set)
+{
+    ArenaRelease(&set->arena);
+    set->slots = NULL;
+    set->count = 0;
+}
+
+static uint32_t* FindSlot(uint32_t* slots, uint32_t mask, const PSCHAR* pool,
+                          const PSCHAR* name, size_t nameLen, uint32_t hash)
+{
+    for (uint32_t i = hash & mask;; i = (i + 1) & mask)
+    {
+        if (slots[i] == 0)
+            return &slots[i];
+        const PSCHAR* stored = pool + slots[i] - 1;
+        size_t n = 0;
+        while (n < nameLen && stored[n] == name[n])
+            n++;
+        if (n == nameLen && stored[n] == 0)
+            return &slots[i];
+    }
+}
+
+// Double the table once it is half full; the old one stays in the arena
+// until the next reset
+static bool GrowSlots(ChangeSet* set)
+{
+    uint32_t* old = set->slots;
+    uint32_t oldCapacity = set->capacity;
+    if (!AllocSlots(set, oldCapacity * 2))
+        return false;
+    for (uint32_t i = 0; i < oldCapacity; i++)
+    {
+        if (old[i] == 0)
+            continue;
+        const PSCHAR* name = set->names.data + old[i] - 1;
+        size_t len = PsStrLen(name);
+        *FindSlot(set->slots, set->capacity - 1, set->names.data, name, len, ChangeHash(name, len)) = old[i];
+    }
+    return true;
+}
+
+bool ChangeSetAdd(ChangeSet* set, const PSCHAR* name, size_t nameLen)
+{
+    uint32_t hash = ChangeHash(name, nameLen);
+    uint32_t* slot = FindSlot(set->slots, set->capacity - 1, set->names.data, name, nameLen, hash);
+    if (*slot != 0)
+        return false;                   // DEDUPE: Already in this batch
+
+    // The builder's data may move as it grows; offsets stay valid
+    size_t offset = set->names.len;
+    if (set->count >= CHANGESET_MAX_NAMES || offset + nameLen + 1 >= 0xFFFFFFFFu ||
+        !StrBufAppendN(&set->names, name, nameLen) || !StrBufAppendChar(&set->names, 0))
+    {
+        set->overflowed = true;         // Out of room: the rescan covers it
+        return false;
+    }
+    set->count++;
+    if (set->count * 2 > set->capacity)
+    {
+        if (!GrowSlots(set))
+        {
+            set->overflowed = true;
+            return false;
+        }
+        slot = FindSlot(set->slots, set->capacity - 1, set->names.data, name, nameLen, hash);
+    }
+    *slot = (uint32_t)offset + 1;
+    return true;
+}
+
+static bool ScanEntry(void* ctx, const PSCHAR* name, size_t nameLen, PlatEntryType type)
+{
+    if (type == PLAT_ENTRY_FILE)
+        ChangeSetAdd((ChangeSet*)ctx, name, nameLen);
+    return true;
+}
+
+bool ChangeSetScan(ChangeSet* set, const PSCHAR* directory)
+{
+    return PlatListDirectory(directory, ScanEntry, set);
+}
+
+bool WriteChangeList(Arena* arena, const ChangeSet* set, const PSCHAR* directory, const PSCHAR* path)
+{
+    // Directory prefix converted once, lines gathered into chunks; both
+    // from the arena, as they are too big for the stack
+    ArenaMark mark = ArenaSave(arena);
+    const size_t prefixSize = PS_MAX_PATH * 3 + 1;
+    char* prefix = (char*)ArenaAlloc(arena, prefixSize);
+    char* chunk = (char*)ArenaAlloc(arena, CHANGELIST_CHUNK);
+    size_t prefixLen = prefix && chunk ? PlatToUtf8(directory, PsStrLen(directory), prefix, prefixSize - 1) : 0;
+    PlatFile file = prefixLen ? PlatCreateFile(path, PLAT_FILE_OVERWRITE) : PLAT_INVALID_FILE;
+    if (file == PLAT_INVALID_FILE)
+    {
+        ArenaRestore(arena, mark);
+        return false;
+    }
+    if (prefix[prefixLen - 1] != '/' && prefix[prefixLen - 1] != '\\')
+        prefix[prefixLen++] = (char)PS_PATH_SEP;
+
+    bool ok = true;
+    size_t used = 0;
+    const PSCHAR* name = set->names.data;
+    const PSCHAR* end = set->names.data + set->names.len;
+    while (ok && name < end)
+    {
+        size_t len = PsStrLen(name);
+        // Worst case: prefix, three bytes per unit, newline
+        size_t worst = prefixLen + len * 3 + 1;
+        if (worst > CHANGELIST_CHUNK)
+        {
+            ok = false;
+            break;
+        }
+        if (CHANGELIST_CHUNK - used < worst)
+        {
+            ok = PlatWriteFile(file, chunk, used);
+            used = 0;
+        }
+        PsMemCpy(chunk + used, prefix, prefixLen);
+        size_t n = PlatToUtf8(name, len, chunk + used + prefixLen, CHANGELIST_CHUNK - used - prefixLen);
+        if (n > 0)
+        {
+            chunk[used + prefixLen + n] = '\n';
+            used += prefixLen + n + 1;
+        }
+        name += len + 1;
+    }
+    if (ok && used)
+        ok = PlatWriteFile(file, chunk, used);
+    PlatCloseFile(file);
+    if (!ok)
+        PlatDeleteFile(path);
+    ArenaRestore(arena, mark);
+    return ok;
+}
+
+//--------------------------------------------------------------------------
+// RESIDENT LOOP
+//--------------------------------------------------------------------------
+typedef struct Watcher
+{
+    ChangeSet changes;
+    uint64_t firstMillis;            // Oldest change in the batch; 0 when empty
+    uint64_t lastMillis;             // Newest change
+    uint64_t nowMillis;
+    uint64_t retryMillis;            // A failed batch is not retried before this
+    bool immediate;                  // The files found at start: no debounce
+} Watcher;
+
+static void Changed(Watcher* w)
+{
+    if (w->firstMillis == 0)
+        w->firstMillis = w->nowMillis;
+    w->lastMillis = w->nowMillis;
+}
+
+static void OnChange(void* ctx, const PSCHAR* name, size_t nameLen)
+{
+    Watcher* w = (Watcher*)ctx;
+    ChangeSetAdd(&w->changes, name, nameLen);
+    Changed(w);                         // Repeats still postpone the batch
+}
+
+// When the batch should run: quiet for the debounce window, or held back
+// for the longest delay allowed
+static uint64_t BatchDue(const Watcher* w, uint32_t debounce)
+{
+    if (w->immediate)
+        return 0;
+    uint64_t quiet = w->lastMillis + debounce;
+    uint64_t latest = w->firstMillis + WATCH_MAX_DELAY_MS;
+    uint64_t due = quiet < latest ? quiet : latest;
+    return due > w->retryMillis ? due : w->retryMillis;
+}
+
+static bool ParseMillis(const PSCHAR* s, uint32_t* millis)
+{
+    uint32_t value = 0;
+    if (*s == 0)
+        return false;
+    for (; *s; s++)
+    {
+        if (*s < PS_T('0') || *s > PS_T('9') || value > WATCH_MAX_DEBOUNCE_MS)
+            return false;
+        value = value * 10 + (uint32_t)(*s - PS_T('0'));
+    }
+    *millis = value;
+    return value <= WATCH_MAX_DEBOUNCE_MS;
+}
+
+static uint64_t NowMillis(void)
+{
+    return PlatMonotonicNanos() / 1000000;
+}
+
+// <state>/batches/batch-<pid>-<sequence>.txt: unique among watchers
+// sharing the state directory, however close together their batches
+static bool BatchPath(PSCHAR* out, size_t outSize, uint32_t sequence)
+{
+    if (!PlatGetStateDirectory(out, outSize))
+        return false;
+    size_t pos = PsStrLen(out);
+    if (!AppendChar(out, outSize, PS_PATH_SEP, &pos) ||
+        !AppendStr(out, outSize, WATCH_BATCH_DIRECTORY, &pos) ||
+        !PlatCreateDirectory(out))
+        return false;
+    return AppendChar(out, outSize, PS_PATH_SEP, &pos) &&
+           AppendStr(out, outSize, PS_T("batch-"), &pos) &&
+           AppendUInt(out, outSize, PlatCurrentProcessId(), &pos) &&
+           AppendChar(out, outSize, PS_T('-'), &pos) &&
+           AppendUInt(out, outSize, sequence, &pos) &&
+           AppendStr(out, outSize, PS_T(".txt"), &pos);
+}
+
+static bool StartBatch(Arena* arena, const PSCHAR* self, const PSCHAR* envBlock, const PSCHAR* directory,
+                       const ChangeSet* changes, PSCHAR* const* args, int argCount, const PSCHAR* listPath,
+                       PlatProcess* run)
+{
+    if (!WriteChangeList(arena, changes, directory, listPath))
+    {
+        LogFormat(PS_T("ERROR: Cannot write change list: %s"), listPath);
+        return false;
+    }
+
+    ArenaMark mark = ArenaSave(arena);
+    StrBuf cmd;
+    bool built = StrBufInit(&cmd, arena, 256, PS_MAX_COMMAND_LINE) && AppendQuotedPath(&cmd, self);
+    for (int i = 0; built && i < argCount; i++)
+        built = StrBufAppendChar(&cmd, PS_T(' ')) && AppendQuotedParameter(&cmd, args[i]);
+    built = built && StrBufAppend(&cmd, PS_T(" -ChangeList ")) && AppendQuotedPath(&cmd, listPath);
+    bool started = built && PlatSpawn(self, cmd.data, envBlock, run);
+    ArenaRestore(arena, mark);
+    if (!started)
+        PlatDeleteFile(listPath);
+    return started;
+}
+
+int RunWatch(Arena* arena, int argc, PSCHAR* const* argv)
+{
+    if (argc < 1)
+    {
+        LogWrite(PS_T("ERROR: -Watch needs a directory"));
+        return 1;
+    }
+    const PSCHAR* directory = argv[0];
+    uint32_t debounce = WATCH_DEBOUNCE_MS;
+    int first = 1;
+    if (first + 1 < argc && PsStrCmpI(argv[first], PS_T("-Debounce")) == 0)
+    {
+        if (!ParseMillis(argv[first + 1], &debounce))
+        {
+            LogWrite(PS_T("ERROR: -Debounce needs milliseconds (0 - 60000)"));
+            return 1;
+        }
+        first += 2;
+    }
+    PSCHAR* const* args = argv + first;
+    int argCount = argc - first;
+    if (argCount < 1)
+    {
+        LogWrite(PS_T("ERROR: -Watch needs the arguments of the runs (-Script ...)"));
+        return 1;
+    }
+
+    // SECURITY CHECK: Batches run launches, never another resident launcher
+    if (IsResidentMode(args[0]))
+    {
+        LogWrite(PS_T("ERROR: -Watch cannot run another resident mode"));
+        return 1;
+    }
+
+    PSCHAR self[PS_MAX_PATH];
+    if (!PlatGetExecutablePath(self, PS_MAX_PATH))
+    {
+        LogWrite(PS_T("ERROR: Cannot locate the launcher executable"));
+        return 1;
+    }
+
+    // ORDER: Watch first, then scan, so nothing written in between is missed
+    PlatWatch watch;
+    if (!PlatWatchOpen(&watch, directory))
+    {
+        LogFormat(PS_T("ERROR: Cannot watch directory: %s"), directory);
+        return 1;
+    }
+    Watcher* w = (Watcher*)ArenaAlloc(arena, sizeof(Watcher));
+    if (!w || !ChangeSetInit(&w->changes))
+    {
+        PlatWatchClose(&watch);
+        return 1;
+    }
+    w->nowMillis = NowMillis();
+    w->firstMillis = w->lastMillis = w->retryMillis = 0;
+    ChangeSetScan(&w->changes, directory);
+    w->immediate = w->changes.count > 0;
+    if (w->immediate)
+        Changed(w);
+
+    // RUN IDS: Every batch run is a child of this session
+    RunIdSource ids;
+    RunId session, parent;
+    const PSCHAR* vars[RUN_ID_VARS];
+    PSCHAR idText[RUN_ID_CHARS + 1];
+    RunIdBegin(&ids, &session, &parent);
+    const PSCHAR* envBlock = RunIdVariables(arena, &session, &parent, NULL, vars)
+                           ? BuildEnvironmentBlock(arena, NULL, vars, RUN_ID_VARS) : NULL;
+    RunIdFormat(&session, idText);
+
+    LogFormat(PS_T("Watching: %s"), directory);
+    LogNumber(PS_T("Debounce (ms): "), debounce);
+    LogFormat(PS_T("Run id: %s"), idText);
+    CloseLog();                         // Child launches rewrite the log
+
+    PSCHAR listPath[PS_MAX_PATH];
+    PlatProcess run;
+    uint32_t batches = 0;
+    bool running = false;
+    for (;;)
+    {
+        w->nowMillis = NowMillis();
+
+        // BATCH: One run at a time, once the changes have settled
+        if (!running && w->firstMillis != 0 && w->nowMillis >= BatchDue(w, debounce))
+        {
+            // OVERFLOW: Events were dropped; the directory itself is the truth
+            if (w->changes.overflowed)
+                ChangeSetScan(&w->changes, directory);
+            if (w->changes.count > 0 && BatchPath(listPath, PS_MAX_PATH, ++batches))
+                running = StartBatch(arena, self, envBlock, directory, &w->changes, args, argCount, listPath, &run);
+            w->immediate = false;
+            if (running || w->changes.count == 0)
+            {
+                ChangeSetReset(&w->changes);
+                w->firstMillis = w->lastMillis = w->retryMillis = 0;
+            }
+            else
+            {
+                // RETRY: Keep every change for the next attempt
+                LogWrite(PS_T("WARNING: Batch not started - retrying"));
+                w->retryMillis = w->nowMillis + WATCH_RETRY_MS;
+                w->firstMillis = w->lastMillis = w->nowMillis;
+            }
+        }
+
+        uint32_t timeout = PLAT_WAIT_FOREVER;
+        if (!running && w->firstMillis != 0)
+        {
+            uint64_t due = BatchDue(w, debounce);
+            timeout = due > w->nowMillis ? (uint32_t)(due - w->nowMillis) : 0;
+        }
+        PlatWatchWake wake = PlatWatchWait(&watch, running ? &run : NULL, timeout);
+        if (wake == PLAT_WAKE_ERROR)
+            break;
+
+        uint32_t code;
+        if (running && PlatPollProcess(&run, &code))
+        {
+            PlatCloseProcess(&run);
+            PlatDeleteFile(listPath);
+            running = false;
+        }
+
+        // DRAIN: Everything queued, also while a run is going
+        bool overflow = false;
+        w->nowMillis = NowMillis();
+        if (!PlatWatchRead(&watch, OnChange, w, &overflow))
+            break;                      // Directory deleted or moved
+        if (overflow)
+        {
+            w->changes.overflowed = true;
+            Changed(w);
+        }
+    }
+
+    // The last run finishes with its list in place
+    if (running)
+    {
+        uint32_t code;
+        PlatWait(&run, &code);
+        PlatCloseProcess(&run);
+        PlatDeleteFile(listPath);
+    }
+    PlatWatchClose(&watch);
+    ChangeSetRelease(&w->changes);
+    return 0;
+}
@@ -0,0 +1,78 @@
+//--------------------------------------------------------------------------
+// WATCH MODE - One run per burst of changes in a directory
+//--------------------------------------------------------------------------
+// "ps-launcher -Watch <dir> [-Debounce <ms>] -Script ..." stays resident
+// and runs the script whenever files in <dir> are written, created or
+// moved in (not in its subdirectories):
+//
+//   ps-launcher -Watch /srv/drop -Debounce 250 -Script @ingest -Queue fast
+//
+// Changes are collected until the directory has been quiet for the
+// debounce window (default WATCH_DEBOUNCE_MS), but a batch never waits
+// longer than WATCH_MAX_DELAY_MS behind a steady stream. The batch is then
+// one run: a child launcher of this executable with the arguments after
+// the directory plus "-ChangeList <file>", a UTF-8 file listing the
+// changed paths one per line. Files already in the directory when the
+// watch starts are the first batch.
+//
+// There is one run at a time. Changes arriving while it is going are
+// drained from the OS queue and deduplicated into the next batch, so a
+// burst of any size costs a handful of runs and never one per file. If
+// the OS queue overflows anyway (fs.inotify.max_queued_events on Linux,
+// the 64KB ReadDirectoryChangesW buffer on Windows) the directory is
+// rescanned and every file in it goes into the batch: a change may be
+// reported twice, never lost. A batch that cannot start (the change list
+// cannot be written, the spawn fails) keeps its changes and is retried
+// after the debounce window, at least WATCH_RETRY_MS later.
+//
+// Deleting or moving the watched directory stops the watch.
+
+#ifndef PS_WATCH_H
+#define PS_WATCH_H
+
+#include "arena.h"
+#include "platform.h"
+#include "pstypes.h"
+#include "strbuf.h"
+
+PS_EXTERN_C_BEGIN
+
+#define WATCH_DEBOUNCE_MS      500
+#define WATCH_MAX_DEBOUNCE_MS  60000
+#define WATCH_MAX_DELAY_MS     10000
+#define WATCH_RETRY_MS         1000      // After a batch that could not start
+#define WATCH_BATCH_DIRECTORY  PS_T("batches")   // Change lists, under the state directory
+
+// Distinct names changed since the last batch, each stored once. Lives in
+// its own arena, which ChangeSetReset empties for the next batch.
+typedef struct ChangeSet
+{
+    Arena arena;
+    StrBuf names;                    // Terminated names back to back
+    uint32_t* slots;                 // Open addressing: name offset + 1, 0 is empty
+    uint32_t capacity;               // Power of two
+    uint32_t count;
+    bool overflowed;                 // Events were lost; rescan before running
+} ChangeSet;
+
+bool ChangeSetInit(ChangeSet* set);
+void ChangeSetReset(ChangeSet* set);
+void ChangeSetRelease(ChangeSet* set);
+
+// False if the name was already in the set (or memory ran out)
+bool ChangeSetAdd(ChangeSet* set, const PSCHAR* name, size_t nameLen);
+
+// Add every file in directory; false if it cannot be read
+bool ChangeSetScan(ChangeSet* set, const PSCHAR* directory);
+
+// UTF-8 list of directory/name, one per line
+bool WriteChangeList(Arena* arena, const ChangeSet* set, const PSCHAR* directory, const PSCHAR* path);
+
+// Resident loop (-Watch). argv[0] is the directory; the rest are the
+// options and the launcher arguments of each run. Returns 0 once the
+// directory is gone, 1 on bad arguments or if it cannot be watched.
+int RunWatch(Arena* arena, int argc, PSCHAR* const* argv);
+
+PS_EXTERN_C_END
+
+#endif // PS_WATCH_H
@@ -0,0 +1,64 @@
+//--------------------------------------------------------------------------
+// WORK POOL - Parallel loops over independent items
+//--------------------------------------------------------------------------
+#include "workpool.h"
+#include "psatomic.h"
+
+bool WorkPoolInit(WorkPool* pool, size_t arenaReserve)
+{
+    uint32_t want = PlatProcessorCount();
+    if (want > WORKPOOL_MAX_WORKERS)
+        want = WORKPOOL_MAX_WORKERS;
+
+    pool->workerCount = 0;
+    while (pool->workerCount < want)
+    {
+        PoolWorker* w = &pool->workers[pool->workerCount];
+        w->pool = pool;
+        if (!ArenaInit(&w->arena, arenaReserve))
+            break;
+        pool->workerCount++;
+    }
+    return pool->workerCount > 0;
+}
+
+static void WorkerMain(void* arg)
+{
+    PoolWorker* w = (PoolWorker*)arg;
+    WorkPool* pool = w->pool;
+    for (;;)
+    {
+        uint32_t i = PsAtomicFetchAdd(&pool->next, 1);
+        if (i >= pool->count)
+            break;
+        pool->fn(pool->ctx, &w->arena, i);
+    }
+}
+
+void WorkPoolRun(WorkPool* pool, uint32_t count, WorkFn fn, void* ctx)
+{
+    pool->fn = fn;
+    pool->ctx = ctx;
+    pool->count = count;
+    pool->next = 0;
+
+    // No more threads than items
+    uint32_t workers = pool->workerCount < count ? pool->workerCount : count;
+    bool started[WORKPOOL_MAX_WORKERS] = { false };
+    for (uint32_t i = 1; i < workers; i++)
+        started[i] = PlatStartThread(&pool->workers[i].thread, WorkerMain, &pool->workers[i]);
+    if (workers > 0)
+        WorkerMain(&pool->workers[0]);
+    for (uint32_t i = 1; i < workers; i++)
+    {
+        if (started[i])
+            PlatJoinThread(&pool->workers[i].thread);
+    }
+}
+
+void WorkPoolRelease(WorkPool* pool)
+{
+    for (uint32_t i = 0; i < pool->workerCount; i++)
+        ArenaRelease(&pool->workers[i].arena);
+    pool->workerCount = 0;
+}
@@ -0,0 +1,55 @@
+//--------------------------------------------------------------------------
+// WORK POOL - Parallel loops over independent items
+//--------------------------------------------------------------------------
+// Up to WORKPOOL_MAX_WORKERS workers (one per processor), each with its
+// own arena so nothing is shared while they run. Items are claimed one at
+// a time from an atomic counter, so slow items (a large file, a deep
+// directory) do not hold up the rest. Worker 0 is the calling thread; if a
+// thread fails to start, the others pick up its share.
+//
+// Worker arenas live until WorkPoolRelease, so a run can leave results in
+// them for the caller to collect.
+
+#ifndef PS_WORKPOOL_H
+#define PS_WORKPOOL_H
+
+#include "arena.h"
+#include "platform.h"
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+#define WORKPOOL_MAX_WORKERS 8
+
+typedef void (*WorkFn)(void* ctx, Arena* arena, uint32_t index);
+
+typedef struct WorkPool WorkPool;
+
+typedef struct PoolWorker
+{
+    WorkPool* pool;
+    Arena arena;
+    PlatThread thread;
+} PoolWorker;
+
+struct WorkPool
+{
+    PoolWorker workers[WORKPOOL_MAX_WORKERS];
+    uint32_t workerCount;
+    WorkFn fn;                       // Current run
+    void* ctx;
+    uint32_t count;
+    volatile uint32_t next;          // Next unclaimed item
+};
+
+// False if not even one worker arena could be reserved
+bool WorkPoolInit(WorkPool* pool, size_t arenaReserve);
+
+// fn(ctx, worker arena, i) for every i below count; returns when all are done
+void WorkPoolRun(WorkPool* pool, uint32_t count, WorkFn fn, void* ctx);
+
+void WorkPoolRelease(WorkPool* pool);
+
+PS_EXTERN_C_END
+
+#endif // PS_WORKPOOL_H
@@ -0,0 +1,81 @@
+//--------------------------------------------------------------------------
+// CHARACTER TRAITS - Per-width primitives for the C++ string types
+//--------------------------------------------------------------------------
+// StringView and SmallString are templates over the code unit; everything
+// that depends on the width goes through CharTraits<C>, which forwards to
+// the CRT-free primitives in psmem.c:
+// - char     : UTF-8  (POSIX PSCHAR)
+// - char16_t : UTF-16 (testable on any platform)
+// - wchar_t  : UTF-16 where wchar_t is 16 bits (Windows PSCHAR)
+//
+// Nothing here needs the C++ runtime: no exceptions, no RTTI, no statics
+// with constructors (the /NODEFAULTLIB build never runs them).
+
+#ifndef PS_CHARTRAITS_HPP
+#define PS_CHARTRAITS_HPP
+
+#include "psmem.h"
+#include "pstypes.h"
+
+namespace ps {
+
+template <typename C>
+struct CharTraits;
+
+// UTF-8: byte primitives
+template <>
+struct CharTraits<char>
+{
+    typedef char Unit;
+
+    // Worst-case UTF-8 bytes per code unit (for sizing conversions)
+    static constexpr unsigned kMaxUtf8PerUnit = 1;
+
+    static size_t Length(const char* s) { return PsStrLen8(s); }
+
+    static const char* Find(const char* s, size_t n, char c)
+    {
+        return static_cast<const char*>(PsMemChr(s, static_cast<unsigned char>(c), n));
+    }
+
+    static void Copy(char* dest, const char* src, size_t n) { PsMemCpy(dest, src, n); }
+};
+
+// UTF-16: 16-bit primitives, shared by char16_t and a 16-bit wchar_t
+template <typename C>
+struct Utf16Traits
+{
+    static_assert(sizeof(C) == 2, "UTF-16 code units are 16 bits");
+    typedef C Unit;
+
+    static constexpr unsigned kMaxUtf8PerUnit = 3;
+
+    static size_t Length(const C* s) { return PsStrLen16(reinterpret_cast<const uint16_t*>(s)); }
+
+    static const C* Find(const C* s, size_t n, C c)
+    {
+        return reinterpret_cast<const C*>(
+            PsMemChr16(reinterpret_cast<const uint16_t*>(s), static_cast<uint16_t>(c), n));
+    }
+
+    static void Copy(C* dest, const C* src, size_t n) { PsMemCpy(dest, src, n * 2); }
+};
+
+template <>
+struct CharTraits<char16_t> : Utf16Traits<char16_t> {};
+
+#ifdef _WIN32
+template <>
+struct CharTraits<wchar_t> : Utf16Traits<wchar_t> {};
+#endif
+
+// ASCII case folding - the only folding the launcher's switches need
+template <typename C>
+constexpr C FoldAscii(C c)
+{
+    return (c >= C('A') && c <= C('Z')) ? C(c + ('a' - 'A')) : c;
+}
+
+} // namespace ps
+
+#endif // PS_CHARTRAITS_HPP
@@ -0,0 +1,177 @@
+//--------------------------------------------------------------------------
+// COMMAND LINE (C++) - Argument views, quoting and building
+//--------------------------------------------------------------------------
+// The C++ counterpart of args.c, quote.c and cmdline.c. Every argument is
+// a StringView whose length was measured once (or derived from the split
+// storage), so parsing, the policy check and quoting never rescan a
+// string.
+//
+// QUOTING STRATEGIES: BuildCommandLine takes the quoting rules as a policy
+// class with three static members (program, script, parameter):
+// - PowerShellQuoting : the C core's rules, byte-for-byte the same output
+// - ArgvQuoting       : exact CommandLineToArgvW inverse - every parameter
+//                       splits back to its original value, including ones
+//                       with trailing backslashes or surrounding quotes
+
+#ifndef PS_CMDLINE_HPP
+#define PS_CMDLINE_HPP
+
+#include "cmdline.h"
+#include "policy.h"
+#include "smallstring.hpp"
+
+namespace ps {
+
+// Parsed launcher invocation: ps-launcher -Script <path> [parameters]
+struct LaunchArgsView
+{
+    StringView script;
+    const StringView* params;
+    int paramCount;
+};
+
+inline bool ParseLaunchArgs(const StringView* argv, int argc, LaunchArgsView* out)
+{
+    if (argc < 3 || !argv[1].EqualsIgnoreCase(PS_T("-Script")))
+        return false;
+
+    out->script = argv[2];
+    out->params = argv + 3;
+    out->paramCount = argc - 3;
+    return true;
+}
+
+inline bool IsAlreadyQuoted(StringView param)
+{
+    return param.size() >= 2 && param.front() == PS_T('"') && param.back() == PS_T('"');
+}
+
+// Same rules as AppendQuotedParameter in quote.c
+template <typename Out>
+bool AppendQuotedParameter(Out& out, StringView param)
+{
+    // ALREADY QUOTED: Use parameter as-is
+    if (IsAlreadyQuoted(param))
+        return out.Append(param);
+
+    // Reserve the common case (no escapes) up front: one growth at most
+    if (!out.Reserve(param.size() + 2) || !out.Append(PS_T('"')))
+        return false;
+
+    // Copy each run of ordinary characters in one go, then the escaped quote
+    size_t run = 0;
+    size_t quote;
+    while ((quote = param.Find(PS_T('"'), run)) != StringView::npos)
+    {
+        if (!out.Append(param.Substr(run, quote - run)) ||
+            !out.Append(StringView(PS_T("\\\""))))
+            return false;
+        run = quote + 1;
+    }
+    return out.Append(param.Substr(run)) && out.Append(PS_T('"'));
+}
+
+template <typename Out>
+bool AppendQuotedPath(Out& out, StringView path)
+{
+    return out.Append(PS_T('"')) && out.Append(path) && out.Append(PS_T('"'));
+}
+
+// Exact inverse of the SplitCommandLine/CommandLineToArgvW rules: always
+// quoted; a backslash run is doubled when a quote (literal or closing)
+// follows it, and literal quotes become \"
+template <typename Out>
+bool AppendArgvQuoted(Out& out, StringView arg)
+{
+    // Common case (nothing to escape) needs one growth at most
+    if (!out.Reserve(arg.size() + 2) || !out.Append(PS_T('"')))
+        return false;
+
+    size_t slashes = 0;
+    for (size_t i = 0; i < arg.size(); i++)
+    {
+        PSCHAR c = arg[i];
+        if (c == PS_T('\\'))
+        {
+            slashes++;
+            continue;
+        }
+        // Backslashes before a quote are halved by the splitter: double them
+        // and add one more to escape the quote itself
+        size_t emit = c == PS_T('"') ? slashes * 2 + 1 : slashes;
+        for (size_t k = 0; k < emit; k++)
+        {
+            if (!out.Append(PS_T('\\')))
+                return false;
+        }
+        if (!out.Append(c))
+            return false;
+        slashes = 0;
+    }
+
+    // The closing quote follows any trailing run: double it as well
+    for (size_t k = 0; k < slashes * 2; k++)
+    {
+        if (!out.Append(PS_T('\\')))
+            return false;
+    }
+    return out.Append(PS_T('"'));
+}
+
+struct PowerShellQuoting
+{
+    template <typename Out>
+    static bool AppendProgram(Out& out, StringView path) { return AppendQuotedPath(out, path); }
+
+    template <typename Out>
+    static bool AppendScript(Out& out, StringView path) { return AppendQuotedPath(out, path); }
+
+    template <typename Out>
+    static bool AppendParameter(Out& out, StringView param) { return AppendQuotedParameter(out, param); }
+};
+
+struct ArgvQuoting
+{
+    // The program name is split without backslash processing
+    template <typename Out>
+    static bool AppendProgram(Out& out, StringView path) { return AppendQuotedPath(out, path); }
+
+    template <typename Out>
+    static bool AppendScript(Out& out, StringView path) { return AppendArgvQuoted(out, path); }
+
+    template <typename Out>
+    static bool AppendParameter(Out& out, StringView param) { return AppendArgvQuoted(out, param); }
+};
+
+// Build: "<interpreter>" <switches> "<script>" "<param>" ...
+template <typename Quoting, typename Out>
+CmdStatus BuildCommandLine(Out& cmd, StringView interpreter,
+                           const LaunchArgsView& args, int* blockedIndex)
+{
+    if (!Quoting::AppendProgram(cmd, interpreter) ||
+        !cmd.Append(StringView(PS_INTERPRETER_SWITCHES)) ||
+        !Quoting::AppendScript(cmd, args.script))
+    {
+        return CMD_OVERFLOW;
+    }
+
+    for (int i = 0; i < args.paramCount; i++)
+    {
+        const StringView& param = args.params[i];
+        if (CheckParameterPolicyN(param.data(), param.size()) != POLICY_OK)
+        {
+            if (blockedIndex)
+                *blockedIndex = i;
+            return CMD_BLOCKED;
+        }
+
+        if (!cmd.Append(PS_T(' ')) || !Quoting::AppendParameter(cmd, param))
+            return CMD_OVERFLOW;
+    }
+
+    return CMD_OK;
+}
+
+} // namespace ps
+
+#endif // PS_CMDLINE_HPP
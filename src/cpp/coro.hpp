@@ -0,0 +1,733 @@
+//--------------------------------------------------------------------------
+// COROUTINES (C++20) - Awaitable launches over the embedding engine
+//--------------------------------------------------------------------------
+// A Task is a lazy coroutine; an EventLoop owns a PslEngine (engine.h)
+// and a millisecond timer wheel and drives one root task to completion:
+//
+//   Task<uint32_t> Nightly(EventLoop& loop, CancelToken token)
+//   {
+//       LaunchOptions options;
+//       options.timeoutMillis = 60000;
+//       options.token = token;
+//       LaunchResult r = co_await Launch(loop, PS_T("nightly.ps1"), { PS_T("-Full") }, options);
+//       co_return r.outcome == LaunchOutcome::Completed ? r.stats.exitCode : 1;
+//   }
+//
+//   EventLoop loop(64);
+//   Task<uint32_t> task = Nightly(loop, CancelToken());
+//   loop.Run(task);
+//
+// Structured concurrency: WhenAll(tasks, count) starts every task and
+// resumes the caller once all have finished; a CancelSource cancels every
+// launch registered with its token (CancelAfter makes it a group timeout);
+// LaunchOptions::timeoutMillis bounds a single launch. Launches beyond
+// the engine's run limit - maxRuns, or what PslSetAdaptive(loop.Engine(),
+// true) makes of it - wait in FIFO order for a slot.
+//
+// NO ALLOCATION: Awaiters live in the awaiting coroutine's frame, and
+// everything the loop tracks - ready queue, slot queue, timers, token
+// registrations - is an intrusive link inside them. A coroutine frame is
+// the only allocation, made once per task.
+//
+// Everything runs on the thread that calls EventLoop::Run; engine
+// callbacks only queue the waiting coroutine, which is resumed after
+// PslPoll returns. A task must finish before it is destroyed. Needs C++20
+// (the rest of src/cpp is C++17) and builds without exceptions or RTTI.
+
+#ifndef PS_CORO_HPP
+#define PS_CORO_HPP
+
+#include <coroutine>
+#include <stdlib.h>
+#include <type_traits>
+#include <utility>
+
+#include "engine.h"
+#include "platform.h"
+#include "timerwheel.h"
+
+namespace ps {
+
+class EventLoop;
+class LaunchOperation;
+
+//--------------------------------------------------------------------------
+// TASKS
+//--------------------------------------------------------------------------
+// WhenAll's countdown: the last task to finish resumes the parent
+struct JoinState
+{
+    size_t remaining;
+    std::coroutine_handle<> parent;
+};
+
+namespace detail {
+
+struct PromiseBase
+{
+    std::coroutine_handle<> continuation;
+    JoinState* join = nullptr;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    // SYMMETRIC TRANSFER: Hand the thread straight to whoever waits, so
+    // chains of co_await do not grow the stack
+    struct FinalAwaiter
+    {
+        bool await_ready() noexcept { return false; }
+        template <typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> done) noexcept
+        {
+            PromiseBase& p = done.promise();
+            if (p.join)
+                return --p.join->remaining == 0 ? p.join->parent : std::noop_coroutine();
+            return p.continuation ? p.continuation : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+    };
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    // Built without exceptions; nothing can arrive here
+    void unhandled_exception() noexcept { abort(); }
+};
+
+template <typename T>
+struct TaskPromise;
+
+} // namespace detail
+
+template <typename T = void>
+class Task
+{
+public:
+    typedef detail::TaskPromise<T> promise_type;
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    Task() : m_handle(nullptr) {}      // Empty, so arrays of tasks can be filled in
+    explicit Task(Handle handle) : m_handle(handle) {}
+    Task(Task&& other) noexcept : m_handle(other.m_handle) { other.m_handle = nullptr; }
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (m_handle)
+                m_handle.destroy();
+            m_handle = other.m_handle;
+            other.m_handle = nullptr;
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task()
+    {
+        if (m_handle)
+            m_handle.destroy();
+    }
+
+    bool Done() const { return !m_handle || m_handle.done(); }
+    Handle GetHandle() const { return m_handle; }
+
+    // The co_return value once Done()
+    template <typename U = T>
+    std::enable_if_t<!std::is_void_v<U>, U&> Result()
+    {
+        return m_handle.promise().value;
+    }
+
+    // Awaiting a task starts it and resumes the awaiter when it finishes
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept
+    {
+        m_handle.promise().continuation = awaiter;
+        return m_handle;
+    }
+    T await_resume() noexcept
+    {
+        if constexpr (!std::is_void_v<T>)
+            return std::move(m_handle.promise().value);
+    }
+
+private:
+    Handle m_handle;
+};
+
+namespace detail {
+
+template <typename T>
+struct TaskPromise : PromiseBase
+{
+    T value{};
+    Task<T> get_return_object() noexcept { return Task<T>(Task<T>::Handle::from_promise(*this)); }
+    void return_value(T v) noexcept { value = std::move(v); }
+};
+
+template <>
+struct TaskPromise<void> : PromiseBase
+{
+    Task<void> get_return_object() noexcept
+    {
+        return Task<void>(Task<void>::Handle::from_promise(*this));
+    }
+    void return_void() noexcept {}
+};
+
+} // namespace detail
+
+// Start count tasks and resume once every one has finished. Tasks must
+// not have been started; read their results with Result() afterwards.
+template <typename T>
+class WhenAllAwaiter
+{
+public:
+    WhenAllAwaiter(Task<T>* tasks, size_t count) : m_tasks(tasks), m_count(count), m_join() {}
+
+    bool await_ready() const noexcept { return m_count == 0; }
+
+    bool await_suspend(std::coroutine_handle<> parent) noexcept
+    {
+        // One extra count held while starting: a task that finishes
+        // without suspending must not resume the parent from in here
+        m_join.remaining = m_count + 1;
+        m_join.parent = parent;
+        for (size_t i = 0; i < m_count; i++)
+        {
+            m_tasks[i].GetHandle().promise().join = &m_join;
+            m_tasks[i].GetHandle().resume();
+        }
+        return --m_join.remaining != 0;
+    }
+
+    void await_resume() noexcept {}
+
+private:
+    Task<T>* m_tasks;
+    size_t m_count;
+    JoinState m_join;
+};
+
+template <typename T>
+WhenAllAwaiter<T> WhenAll(Task<T>* tasks, size_t count)
+{
+    return WhenAllAwaiter<T>(tasks, count);
+}
+
+//--------------------------------------------------------------------------
+// EVENT LOOP
+//--------------------------------------------------------------------------
+// A coroutine waiting to be resumed, linked into one loop queue at a time
+struct Resumable
+{
+    Resumable* next = nullptr;
+    std::coroutine_handle<> handle;
+};
+
+// A timer wheel entry; node first, so a TimerNode* is a LoopTimer*
+struct LoopTimer
+{
+    TimerNode node = TimerNode();
+    void (*fire)(LoopTimer* timer) = nullptr;
+    void* owner = nullptr;
+};
+
+class EventLoop
+{
+public:
+    // maxRuns 0: PSL_DEFAULT_MAX_RUNS
+    explicit EventLoop(uint32_t maxRuns = 0)
+        : m_engine(PslCreate(maxRuns)), m_wheel(), m_ready(), m_readyTail(&m_ready.next),
+          m_waiting(nullptr), m_waitingTail(&m_waiting)
+    {
+        TimerWheelInit(&m_wheel, NowMillis());
+    }
+    ~EventLoop() { PslDestroy(m_engine); }
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    bool Valid() const { return m_engine != nullptr; }
+    PslEngine* Engine() { return m_engine; }
+    static uint64_t NowMillis() { return PlatMonotonicNanos() / 1000000; }
+
+    // Drive task to completion. False if it can no longer finish (it
+    // waits for something no run, timer or queue entry will deliver).
+    template <typename T>
+    bool Run(Task<T>& task)
+    {
+        std::coroutine_handle<> root = task.GetHandle();
+        root.resume();
+        for (;;)
+        {
+            ResumeReady();
+            if (root.done())
+                return true;
+
+            uint32_t timeout = PSL_WAIT_FOREVER;
+            uint64_t tick;
+            if (TimerWheelNextExpiry(&m_wheel, &tick))
+            {
+                uint64_t now = NowMillis();
+                timeout = tick > now ? (uint32_t)(tick - now) : 0;
+            }
+            if (PslRunning(m_engine) > 0)
+                PslPoll(m_engine, timeout);
+            else if (timeout == PSL_WAIT_FOREVER)
+                return false;
+            else if (timeout > 0)
+                PlatSleepMillis(timeout);
+
+            FireTimers();
+            StartWaiting();
+        }
+    }
+
+    // For the awaitables below
+    void Ready(Resumable* r)
+    {
+        r->next = nullptr;
+        *m_readyTail = r;
+        m_readyTail = &r->next;
+    }
+    void AddTimer(LoopTimer* timer, uint32_t millis)
+    {
+        TimerWheelAdd(&m_wheel, &timer->node, NowMillis() + millis);
+    }
+    void CancelTimer(LoopTimer* timer) { TimerWheelCancel(&m_wheel, &timer->node); }
+    void WaitForSlot(LaunchOperation* op);
+    bool LeaveSlotQueue(LaunchOperation* op);
+
+private:
+    void ResumeReady()
+    {
+        while (m_ready.next)
+        {
+            Resumable* r = m_ready.next;
+            m_ready.next = r->next;
+            if (!m_ready.next)
+                m_readyTail = &m_ready.next;
+            r->handle.resume();
+        }
+    }
+
+    void FireTimers()
+    {
+        TimerNode* expired = TimerWheelAdvance(&m_wheel, NowMillis());
+        while (expired)
+        {
+            LoopTimer* timer = reinterpret_cast<LoopTimer*>(expired);
+            expired = expired->next;
+            timer->fire(timer);
+        }
+    }
+
+    void StartWaiting();
+
+    PslEngine* m_engine;
+    TimerWheel m_wheel;
+    Resumable m_ready;                   // Head sentinel
+    Resumable** m_readyTail;
+    LaunchOperation* m_waiting;          // For a free run slot, oldest first
+    LaunchOperation** m_waitingTail;
+};
+
+//--------------------------------------------------------------------------
+// CANCELLATION
+//--------------------------------------------------------------------------
+class CancelSource;
+
+// What a launch is told to watch; default-constructed: never cancelled
+class CancelToken
+{
+public:
+    CancelToken() : m_source(nullptr) {}
+    explicit CancelToken(CancelSource* source) : m_source(source) {}
+    CancelSource* Source() const { return m_source; }
+    bool Cancelled() const;
+
+private:
+    CancelSource* m_source;
+};
+
+class CancelSource
+{
+public:
+    CancelSource() : m_cancelled(false), m_head(nullptr), m_loop(nullptr), m_timer() {}
+    ~CancelSource()
+    {
+        if (m_loop)
+            m_loop->CancelTimer(&m_timer);
+    }
+    CancelSource(const CancelSource&) = delete;
+    CancelSource& operator=(const CancelSource&) = delete;
+
+    CancelToken Token() { return CancelToken(this); }
+    bool Cancelled() const { return m_cancelled; }
+
+    // Every registered launch ends as Cancelled; later ones do not start
+    void Cancel();
+
+    // Cancel in millis from now, unless cancelled first (a group timeout)
+    void CancelAfter(EventLoop& loop, uint32_t millis)
+    {
+        m_loop = &loop;
+        m_timer.fire = [](LoopTimer* t) { static_cast<CancelSource*>(t->owner)->Cancel(); };
+        m_timer.owner = this;
+        loop.AddTimer(&m_timer, millis);
+    }
+
+    void Register(LaunchOperation* op);
+    void Unregister(LaunchOperation* op);
+
+private:
+    bool m_cancelled;
+    LaunchOperation* m_head;
+    EventLoop* m_loop;
+    LoopTimer m_timer;
+};
+
+inline bool CancelToken::Cancelled() const
+{
+    return m_source && m_source->Cancelled();
+}
+
+//--------------------------------------------------------------------------
+// LAUNCHES
+//--------------------------------------------------------------------------
+enum class LaunchOutcome
+{
+    Completed,                           // Ran and exited; stats.exitCode says how
+    Failed,                              // Never started; status says why
+    Cancelled,                           // By its token, started or not
+    TimedOut                             // Killed at timeoutMillis
+};
+
+struct LaunchOptions
+{
+    const PSCHAR* const* env = nullptr;  // "NAME=value" on top of ours
+    int envCount = 0;
+    const PSCHAR* directory = nullptr;
+    const PSCHAR* parent = nullptr;      // Run id this launch follows from; nullptr: the engine's
+    uint32_t timeoutMillis = 0;          // 0: none
+    CancelToken token;
+    char* output = nullptr;              // Captured stdout and stderr, up to
+    size_t outputCapacity = 0;           // ...this many bytes (the rest is counted)
+};
+
+// Up to kMax parameters held by value, so Launch(loop, script, { ... })
+// needs only the strings themselves to stay valid. (An array temporary in
+// a co_await expression trips GCC 12; a class holding one does not.)
+class LaunchParams
+{
+public:
+    static constexpr int kMax = 16;
+
+    LaunchParams() : m_items(), m_count(0) {}
+    template <typename... A>
+    LaunchParams(A... items) : m_items{ items... }, m_count((int)sizeof...(A))
+    {
+        static_assert(sizeof...(A) <= kMax, "more parameters: use the pointer and count overload");
+    }
+
+    const PSCHAR* const* Items() const { return m_items; }
+    int Count() const { return m_count; }
+
+private:
+    const PSCHAR* m_items[kMax];
+    int m_count;
+};
+
+struct LaunchResult
+{
+    LaunchOutcome outcome = LaunchOutcome::Failed;
+    PslStatus status = PSL_OK;
+    PslStats stats = PslStats();         // Zero unless the run started
+    size_t outputSize = 0;               // Bytes written to options.output
+};
+
+class LaunchOperation
+{
+public:
+    LaunchOperation(EventLoop& loop, const PSCHAR* script, const PSCHAR* const* params, int paramCount,
+                    const LaunchOptions& options)
+        : m_loop(loop), m_options(options), m_params(), m_run(nullptr), m_timedOut(false), m_result()
+    {
+        m_command.script = script;
+        m_command.params = params;
+        m_command.paramCount = paramCount;
+        m_command.env = options.env;
+        m_command.envCount = options.envCount;
+        m_command.directory = options.directory;
+        m_command.parent = options.parent;
+    }
+
+    // Only ever built in place (Launch returns a prvalue), so pointing the
+    // command into the object itself is safe
+    LaunchOperation(EventLoop& loop, const PSCHAR* script, const LaunchParams& params,
+                    const LaunchOptions& options)
+        : LaunchOperation(loop, script, nullptr, 0, options)
+    {
+        m_params = params;
+        m_command.params = m_params.Items();
+        m_command.paramCount = m_params.Count();
+    }
+    LaunchOperation(const LaunchOperation&) = delete;
+    LaunchOperation& operator=(const LaunchOperation&) = delete;
+
+    bool await_ready() const noexcept { return false; }
+
+    // False (resume at once) when the launch ends before it starts
+    bool await_suspend(std::coroutine_handle<> awaiter) noexcept
+    {
+        m_resume.handle = awaiter;
+        if (m_options.token.Cancelled())
+        {
+            Settle(LaunchOutcome::Cancelled, PSL_OK);
+            return false;
+        }
+        PslStatus status = Start();
+        if (status == PSL_BUSY)
+        {
+            m_loop.WaitForSlot(this);
+            Watch();
+            return true;
+        }
+        if (status != PSL_OK)
+        {
+            Settle(LaunchOutcome::Failed, status);
+            return false;
+        }
+        Watch();
+        return true;
+    }
+
+    LaunchResult await_resume() noexcept { return m_result; }
+
+    // Called by the loop when a slot frees; false if still busy
+    bool StartWaiting()
+    {
+        PslStatus status = Start();
+        if (status == PSL_BUSY)
+            return false;
+        if (status != PSL_OK)
+            Finish(LaunchOutcome::Failed, status);
+        return true;
+    }
+
+    // Called by the token's source and the timeout
+    void Cancel()
+    {
+        if (m_run)
+            PslCancel(m_loop.Engine(), m_run);         // Finishes through OnExit
+        else if (m_loop.LeaveSlotQueue(this))
+            Finish(m_timedOut ? LaunchOutcome::TimedOut : LaunchOutcome::Cancelled, PSL_OK);
+    }
+
+    LaunchOperation* nextWaiting = nullptr;            // EventLoop slot queue
+    LaunchOperation* nextRegistered = nullptr;         // CancelSource list
+    LaunchOperation** prevRegistered = nullptr;
+
+private:
+    PslStatus Start()
+    {
+        PslCallbacks callbacks = { OnOutput, OnExit, this };
+        return PslStart(m_loop.Engine(), &m_command, &callbacks, &m_run);
+    }
+
+    // Timer and token, from the co_await for as long as the launch is in
+    // flight (time spent waiting for a slot counts toward the timeout)
+    void Watch()
+    {
+        if (m_options.timeoutMillis > 0)
+        {
+            m_timer.fire = OnTimeout;
+            m_timer.owner = this;
+            m_loop.AddTimer(&m_timer, m_options.timeoutMillis);
+        }
+        if (m_options.token.Source())
+            m_options.token.Source()->Register(this);
+    }
+
+    void Settle(LaunchOutcome outcome, PslStatus status)
+    {
+        m_result.outcome = outcome;
+        m_result.status = status;
+        m_run = nullptr;
+        m_loop.CancelTimer(&m_timer);
+        if (m_options.token.Source())
+            m_options.token.Source()->Unregister(this);
+    }
+
+    // Settle, and resume the awaiter from the loop
+    void Finish(LaunchOutcome outcome, PslStatus status)
+    {
+        Settle(outcome, status);
+        m_loop.Ready(&m_resume);
+    }
+
+    static void OnOutput(void* ctx, PslRun* run, const void* data, size_t size)
+    {
+        (void)run;
+        LaunchOperation* self = static_cast<LaunchOperation*>(ctx);
+        LaunchResult& r = self->m_result;
+        size_t room = self->m_options.outputCapacity - r.outputSize;
+        size_t n = size < room ? size : room;
+        const char* from = static_cast<const char*>(data);
+        for (size_t i = 0; i < n; i++)
+            self->m_options.output[r.outputSize + i] = from[i];
+        r.outputSize += n;
+    }
+
+    static void OnExit(void* ctx, PslRun* run, const PslStats* stats)
+    {
+        (void)run;
+        LaunchOperation* self = static_cast<LaunchOperation*>(ctx);
+        self->m_result.stats = *stats;
+        LaunchOutcome outcome = LaunchOutcome::Completed;
+        if (self->m_timedOut)
+            outcome = LaunchOutcome::TimedOut;
+        else if (stats->cancelled)
+            outcome = LaunchOutcome::Cancelled;
+        self->Finish(outcome, PSL_OK);
+    }
+
+    static void OnTimeout(LoopTimer* timer)
+    {
+        LaunchOperation* self = static_cast<LaunchOperation*>(timer->owner);
+        self->m_timedOut = true;
+        self->Cancel();
+    }
+
+    EventLoop& m_loop;
+    LaunchOptions m_options;
+    LaunchParams m_params;
+    PslCommand m_command;
+    PslRun* m_run;
+    bool m_timedOut;
+    Resumable m_resume;
+    LoopTimer m_timer;
+    LaunchResult m_result;
+};
+
+// co_await Launch(...) runs the script and yields its LaunchResult. The
+// strings, environment and directory must stay valid until then
+// (temporaries in the co_await expression do).
+inline LaunchOperation Launch(EventLoop& loop, const PSCHAR* script, const PSCHAR* const* params,
+                              int paramCount, const LaunchOptions& options = LaunchOptions())
+{
+    return LaunchOperation(loop, script, params, paramCount, options);
+}
+
+inline LaunchOperation Launch(EventLoop& loop, const PSCHAR* script,
+                              const LaunchParams& params = LaunchParams(),
+                              const LaunchOptions& options = LaunchOptions())
+{
+    return LaunchOperation(loop, script, params, options);
+}
+
+// co_await Sleep(loop, millis): a pause between retries, or a poll interval
+class SleepOperation
+{
+public:
+    SleepOperation(EventLoop& loop, uint32_t millis) : m_loop(loop), m_millis(millis) {}
+
+    bool await_ready() const noexcept { return m_millis == 0; }
+    void await_suspend(std::coroutine_handle<> awaiter) noexcept
+    {
+        m_resume.handle = awaiter;
+        m_timer.fire = [](LoopTimer* t) {
+            SleepOperation* self = static_cast<SleepOperation*>(t->owner);
+            self->m_loop.Ready(&self->m_resume);
+        };
+        m_timer.owner = this;
+        m_loop.AddTimer(&m_timer, m_millis);
+    }
+    void await_resume() noexcept {}
+
+private:
+    EventLoop& m_loop;
+    uint32_t m_millis;
+    Resumable m_resume;
+    LoopTimer m_timer;
+};
+
+inline SleepOperation Sleep(EventLoop& loop, uint32_t millis)
+{
+    return SleepOperation(loop, millis);
+}
+
+//--------------------------------------------------------------------------
+// OUT-OF-LINE MEMBERS - need LaunchOperation complete
+//--------------------------------------------------------------------------
+inline void EventLoop::WaitForSlot(LaunchOperation* op)
+{
+    op->nextWaiting = nullptr;
+    *m_waitingTail = op;
+    m_waitingTail = &op->nextWaiting;
+}
+
+inline bool EventLoop::LeaveSlotQueue(LaunchOperation* op)
+{
+    for (LaunchOperation** link = &m_waiting; *link; link = &(*link)->nextWaiting)
+    {
+        if (*link != op)
+            continue;
+        *link = op->nextWaiting;
+        if (m_waitingTail == &op->nextWaiting)
+            m_waitingTail = link;
+        return true;
+    }
+    return false;
+}
+
+// Oldest first, until the engine is full again
+inline void EventLoop::StartWaiting()
+{
+    while (m_waiting)
+    {
+        LaunchOperation* op = m_waiting;
+        if (!op->StartWaiting())
+            return;
+        m_waiting = op->nextWaiting;
+        if (!m_waiting)
+            m_waitingTail = &m_waiting;
+    }
+}
+
+inline void CancelSource::Cancel()
+{
+    m_cancelled = true;
+    if (m_loop)
+        m_loop->CancelTimer(&m_timer);
+    // A queued launch unregisters as it settles, a running one later from
+    // its exit: take each next link before cancelling
+    LaunchOperation* op = m_head;
+    while (op)
+    {
+        LaunchOperation* next = op->nextRegistered;
+        op->Cancel();
+        op = next;
+    }
+}
+
+inline void CancelSource::Register(LaunchOperation* op)
+{
+    op->nextRegistered = m_head;
+    op->prevRegistered = &m_head;
+    if (m_head)
+        m_head->prevRegistered = &op->nextRegistered;
+    m_head = op;
+}
+
+inline void CancelSource::Unregister(LaunchOperation* op)
+{
+    if (!op->prevRegistered)
+        return;
+    *op->prevRegistered = op->nextRegistered;
+    if (op->nextRegistered)
+        op->nextRegistered->prevRegistered = op->prevRegistered;
+    op->nextRegistered = nullptr;
+    op->prevRegistered = nullptr;
+}
+
+} // namespace ps
+
+#endif // PS_CORO_HPP
@@ -0,0 +1,253 @@
+//--------------------------------------------------------------------------
+// LAUNCHER (C++) - The launch sequence on length-carrying strings
+//--------------------------------------------------------------------------
+// Same steps, log lines, run records and exit codes as launcher.c, but
+// every string is a StringView or SmallString: argument lengths come from
+// the split (or one scan of argv), the interpreter path is measured once,
+// and log lines are assembled from known lengths.
+//
+// The sequence is a template over a launch policy (variants.hpp): logging,
+// error reporting, spawning and quoting are member calls on policy
+// objects, fully inlined and removed when the policy is a no-op.
+//
+// Header-only so ps-launcher.cpp compiles the whole sequence in one unit.
+
+#ifndef PS_LAUNCHER_HPP
+#define PS_LAUNCHER_HPP
+
+#include "args.h"
+#include "cmdline.hpp"
+#include "config.h"
+#include "envblock.h"
+#include "launcher.h"
+#include "metrics.h"
+#include "platform.h"
+#include "runid.h"
+#include "runrecord.h"
+#include "status.h"
+#include "variants.hpp"
+
+namespace ps {
+
+// Usage text shown when -Script is missing. The C++ launcher runs script
+// files only: packing, the catalogue, the script search path and the
+// resident modes are launcher.c's.
+inline constexpr PSCHAR kLauncherUsage[] =
+    PS_T("PS-Launcher Usage:\n\n")
+    PS_T("ps-launcher.exe -Script <script_path> [parameters]\n\n")
+    PS_T("Examples:\n")
+    PS_T("  ps-launcher.exe -Script test.ps1\n")
+    PS_T("  ps-launcher.exe -Script test.ps1 -FilePath \"C:\\temp\\test.txt\"\n")
+    PS_T("  ps-launcher.exe -Script test.ps1 -FileList \"file1.txt,file2.txt\"\n")
+    PS_T("  ps-launcher.exe -Script test.ps1 -Name \"John Doe\" -Verbose\n\n")
+    PS_T("Notes:\n")
+    PS_T("- Parameters with spaces must be quoted\n")
+    PS_T("- Array parameters should be comma-separated within quotes\n")
+    PS_T("- Returns 0 for success, 1 for errors or if no script specified");
+
+template <typename Policy>
+class Launcher
+{
+public:
+    explicit Launcher(Arena* arena) : m_arena(arena) {}
+
+    int Launch(const StringView* argv, int argc, uint64_t startNanos)
+    {
+        m_timing = RunTiming();
+        m_timing.startNanos = startNanos;
+        m_timing.queuedNanos = QueuedSince();
+        m_record = RunRecord();
+        m_record.startMillis = PlatWallClockMillis();
+        RunIdSource ids;
+        RunIdBegin(&ids, &m_record.id, &m_record.parent);
+
+        m_log.Open(m_arena);
+        m_log.Write(PS_T("========================================"));
+        m_log.Write(PS_T("PS-Launcher Execution Log"));
+        m_log.Write(PS_T("========================================"));
+
+        LaunchArgsView args;
+        if (!ParseLaunchArgs(argv, argc, &args))
+        {
+            m_log.Write(PS_T("ERROR: Invalid arguments - must provide -Script parameter"));
+            m_report.Usage(StringView::FromTerminated(kLauncherUsage));
+            return Finish(RUN_USAGE, 1);
+        }
+
+        // Argument views are terminated: they point into argv or split storage
+        m_record.script = args.script.data();
+        StatusBegin(m_record.script, STATUS_RUN);
+        m_log.Write(PS_T("Script file: "), args.script);
+        PSCHAR idText[RUN_ID_CHARS + 1];
+        RunIdFormat(&m_record.id, idText);
+        m_log.Write(PS_T("Run id: "), StringView::FromTerminated(idText));
+        RunIdFormat(&m_record.parent, idText);
+        m_log.Write(PS_T("Parent run id: "), StringView::FromTerminated(idText));
+
+        PSCHAR psPathBuffer[PS_MAX_PATH];
+        if (!PlatGetInterpreterPath(psPathBuffer, PS_MAX_PATH))
+        {
+            m_log.Write(PS_T("ERROR: PowerShell path too long"));
+            m_report.Error(PS_T("PowerShell path too long."), PS_T("Error"));
+            return Finish(RUN_NOT_FOUND, 1);
+        }
+        StringView psPath = StringView::FromTerminated(psPathBuffer);
+        m_log.Write(PS_T("PowerShell path: "), psPath);
+
+        if (!PlatFileExists(psPath.data()))
+        {
+            m_log.Write(PS_T("ERROR: PowerShell executable not found"));
+            m_report.Error(PS_T("PowerShell executable not found."), PS_T("Error"));
+            return Finish(RUN_NOT_FOUND, 1);
+        }
+
+        if (!PlatFileExists(args.script.data()))
+        {
+            m_log.Write(PS_T("ERROR: Script file not found"));
+            m_report.Error(PS_T("Specified script file not found."), PS_T("Error"));
+            return Finish(RUN_NOT_FOUND, 1);
+        }
+
+        m_log.Write(PS_T("Processing script parameters..."));
+
+        CommandLineString cmd(m_arena, PS_MAX_COMMAND_LINE);
+        int blocked = -1;
+        switch (BuildCommandLine<typename Policy::Quoting>(cmd, psPath, args, &blocked))
+        {
+        case CMD_OK:
+            break;
+        case CMD_BLOCKED:
+            // Silent failure - return exit code 1 for semicolon injection attempts
+            m_log.Write(PS_T("ERROR: Semicolon detected in parameter (security block)"));
+            return Finish(RUN_BLOCKED, 1);
+        default:
+            m_log.Write(PS_T("ERROR: Command line exceeds the maximum length"));
+            m_report.Error(PS_T("Command line too long."), PS_T("Error"));
+            return Finish(RUN_OVERFLOW, 1);
+        }
+
+        m_log.Write(PS_T("Final command line:"));
+        m_log.Write(cmd);
+
+        // The script's environment: ours plus its run ids (unchanged when
+        // there is no memory for the copy)
+        const PSCHAR* vars[RUN_ID_VARS];
+        const PSCHAR* envBlock = RunIdVariables(m_arena, &m_record.id, &m_record.parent, nullptr, vars)
+                               ? BuildEnvironmentBlock(m_arena, nullptr, vars, RUN_ID_VARS) : nullptr;
+
+        m_log.Write(PS_T("Creating PowerShell process..."));
+
+        if (!m_spawn.Start(psPath.data(), cmd.data(), envBlock))
+        {
+            m_log.Write(PS_T("ERROR: Failed to create PowerShell process"));
+            uint32_t err = m_spawn.LastError();
+
+            PSCHAR errMsg[256];
+            PlatFormatError(err, errMsg, 256);
+            StringView errText = StringView::FromTerminated(errMsg);
+            m_log.Write(PS_T("System error: "), errText);
+            m_report.Error(errText, PS_T("Process Creation Failed"));
+            return Finish(RUN_SPAWN_FAILED, err);
+        }
+
+        m_timing.spawnNanos = PlatMonotonicNanos();
+        m_log.Write(PS_T("Process created successfully"));
+        StatusSetPhase(STATUS_RUNNING, 0);      // The spawn policy may not have a child
+        m_log.Write(PS_T("Waiting for script execution to complete..."));
+
+        uint32_t exitCode = 0;
+        if (m_spawn.Wait(&exitCode))
+            m_timing.exitNanos = PlatMonotonicNanos();
+        else
+            m_log.Write(PS_T("ERROR: Failed to retrieve script exit code"));
+        m_spawn.Close();
+
+        m_log.Number(PS_T("Script completed with exit code: "), exitCode);
+        m_log.Write(PS_T("========================================"));
+        m_log.Write(PS_T("Execution completed successfully"));
+        m_log.Write(PS_T("========================================"));
+
+        return Finish(RUN_COMPLETED, exitCode);
+    }
+
+private:
+    // Record the outcome of this launch, close the log and pass the code through
+    int Finish(RunStatus status, uint32_t exitCode)
+    {
+        m_record.status = status;
+        m_record.exitCode = exitCode;
+        m_record.durationMicros = (PlatMonotonicNanos() - m_timing.startNanos) / 1000;
+        AppendRunRecord(&m_record, m_arena);
+        RecordRunMetrics(&m_record, &m_timing);
+        StatusEnd();
+        m_log.Close();
+        return static_cast<int>(exitCode);
+    }
+
+    Arena* m_arena;
+    RunTiming m_timing = RunTiming();
+    RunRecord m_record = RunRecord();
+    typename Policy::Logger m_log;
+    typename Policy::Reporter m_report;
+    typename Policy::Spawner m_spawn;
+};
+
+// argv from main: each argument is measured exactly once
+template <typename Policy>
+int Run(int argc, PSCHAR* const* argv)
+{
+    uint64_t startNanos = PlatMonotonicNanos();
+    Arena arena;
+    if (!ArenaInit(&arena, ARENA_DEFAULT_RESERVE))
+        return 1;
+
+    StringView* views = static_cast<StringView*>(
+        ArenaAlloc(&arena, static_cast<size_t>(argc) * sizeof(StringView)));
+    int exitCode = 1;
+    if (views)
+    {
+        for (int i = 0; i < argc; i++)
+            views[i] = StringView::FromTerminated(argv[i]);
+        exitCode = Launcher<Policy>(&arena).Launch(views, argc, startNanos);
+    }
+
+    ArenaRelease(&arena);
+    return exitCode;
+}
+
+// GetCommandLineW on Windows: split into the arena, lengths from the split
+template <typename Policy>
+int RunCommandLine(const PSCHAR* cmdline)
+{
+    uint64_t startNanos = PlatMonotonicNanos();
+    Arena arena;
+    if (!ArenaInit(&arena, ARENA_DEFAULT_RESERVE))
+        return 1;
+
+    size_t len = StringView::Traits::Length(cmdline);
+    int maxArgs = static_cast<int>(len / 2 + 2);
+    PSCHAR* storage = static_cast<PSCHAR*>(ArenaAlloc(&arena, (len + 1) * sizeof(PSCHAR)));
+    PSCHAR** argv = static_cast<PSCHAR**>(
+        ArenaAlloc(&arena, static_cast<size_t>(maxArgs) * sizeof(PSCHAR*)));
+    int argc = (storage && argv) ? SplitCommandLine(cmdline, storage, argv, maxArgs) : -1;
+
+    StringView* views = argc >= 0 ? static_cast<StringView*>(
+        ArenaAlloc(&arena, static_cast<size_t>(argc) * sizeof(StringView))) : nullptr;
+    int exitCode = 1;
+    if (views)
+    {
+        // BACK TO BACK: Each argument ends where the next one starts
+        for (int i = 0; i + 1 < argc; i++)
+            views[i] = StringView(argv[i], static_cast<size_t>(argv[i + 1] - argv[i] - 1));
+        if (argc > 0)
+            views[argc - 1] = StringView::FromTerminated(argv[argc - 1]);
+        exitCode = Launcher<Policy>(&arena).Launch(views, argc, startNanos);
+    }
+
+    ArenaRelease(&arena);
+    return exitCode;
+}
+
+} // namespace ps
+
+#endif // PS_LAUNCHER_HPP
@@ -0,0 +1,265 @@
+//--------------------------------------------------------------------------
+// LAUNCH POLICIES - Logger sinks, error reporters and spawn backends
+//--------------------------------------------------------------------------
+// The C build switches features with macros that turn calls into
+// ((void)0). The C++ build picks them as template parameters instead
+// (see variants.hpp): a disabled feature is an empty class with inline
+// no-op members, so the optimizer removes the calls, their arguments and
+// everything only they referenced - the same dead-code-free result, with
+// every variant compiled from one source.
+//
+// LOGGER SINK      Open(arena) Write(line) Write(label, value)
+//                  Number(label, value) Close()
+// ERROR REPORTER   Error(message, title) Usage(text)
+// SPAWN BACKEND    Start(interpreter, cmdline, envBlock) Wait(&exitCode) Close()
+//                  LastError()
+// Quoting strategies live in cmdline.hpp.
+
+#ifndef PS_POLICIES_HPP
+#define PS_POLICIES_HPP
+
+#include "args.h"
+#include "ipc.h"
+#include "platform.h"
+#include "psstr.h"
+#include "smallstring.hpp"
+
+namespace ps {
+
+//--------------------------------------------------------------------------
+// LOGGER SINKS
+//--------------------------------------------------------------------------
+struct NullLogger
+{
+    void Open(Arena*) {}
+    void Write(StringView) {}
+    void Write(StringView, StringView) {}
+    void Number(StringView, uint64_t) {}
+    void Close() {}
+};
+
+// <state directory>/ps-launcher.log, overwritten on each run (as log.c)
+class FileLogger
+{
+public:
+    FileLogger() : m_file(PLAT_INVALID_FILE), m_arena(nullptr) {}
+
+    void Open(Arena* arena)
+    {
+        PSCHAR dir[PS_MAX_PATH];
+        m_arena = arena;
+        if (!PlatGetStateDirectory(dir, PS_MAX_PATH))
+            return;
+
+        PathString path;
+        if (path.Append(StringView::FromTerminated(dir)) && path.Append(PS_PATH_SEP) &&
+            path.Append(PS_T("ps-launcher.log")))
+        {
+            m_file = PlatCreateFile(path.c_str(), PLAT_FILE_OVERWRITE);
+        }
+    }
+
+    void Write(StringView line)
+    {
+        if (m_file == PLAT_INVALID_FILE)
+            return;
+
+        // SCRATCH BUFFER: Worst-case UTF-8 size plus CRLF, returned after the write
+        ArenaMark mark = ArenaSave(m_arena);
+        size_t room = line.size() * StringView::Traits::kMaxUtf8PerUnit;
+        char* utf8 = static_cast<char*>(ArenaAlloc(m_arena, room + 2));
+        if (utf8)
+        {
+            size_t utf8Len = PlatToUtf8(line.data(), line.size(), utf8, room);
+            utf8[utf8Len] = '\r';
+            utf8[utf8Len + 1] = '\n';
+            PlatWriteFile(m_file, utf8, utf8Len + 2);   // Best-effort
+        }
+        ArenaRestore(m_arena, mark);
+    }
+
+    void Write(StringView label, StringView value)
+    {
+        if (m_file == PLAT_INVALID_FILE)
+            return;
+        BasicSmallString<PSCHAR, 512> line(m_arena);
+        if (line.Append(label) && line.Append(value))
+            Write(line);
+    }
+
+    void Number(StringView label, uint64_t value)
+    {
+        if (m_file == PLAT_INVALID_FILE)
+            return;
+        BasicSmallString<PSCHAR, 128> line(m_arena);
+        if (line.Append(label) && line.AppendUInt(value))
+            Write(line);
+    }
+
+    void Close()
+    {
+        if (m_file != PLAT_INVALID_FILE)
+            PlatCloseFile(m_file);
+        m_file = PLAT_INVALID_FILE;
+    }
+
+private:
+    PlatFile m_file;
+    Arena* m_arena;
+};
+
+//--------------------------------------------------------------------------
+// ERROR REPORTERS
+//--------------------------------------------------------------------------
+// Strings passed here are terminated (literals, argv, platform buffers).
+
+// Errors are only logged; the usage text is still shown (the C default)
+struct SilentReporter
+{
+    void Error(StringView, StringView) {}
+    void Usage(StringView text)
+    {
+        PlatShowMessage(text.data(), PS_T("PS-Launcher Help"), PLAT_MESSAGE_INFO);
+    }
+};
+
+// MessageBox (stderr on POSIX) for every launch error
+struct DialogReporter
+{
+    void Error(StringView message, StringView title)
+    {
+        PlatShowMessage(message.data(), title.data(), PLAT_MESSAGE_ERROR);
+    }
+    void Usage(StringView text)
+    {
+        PlatShowMessage(text.data(), PS_T("PS-Launcher Help"), PLAT_MESSAGE_INFO);
+    }
+};
+
+// Unattended runs: nothing may block on a dialog, the exit code says it all
+struct QuietReporter
+{
+    void Error(StringView, StringView) {}
+    void Usage(StringView) {}
+};
+
+//--------------------------------------------------------------------------
+// SPAWN BACKENDS
+//--------------------------------------------------------------------------
+// Create the interpreter process here and wait for it
+class DirectSpawn
+{
+public:
+    DirectSpawn() : m_proc() {}
+
+    bool Start(const PSCHAR* interpreter, PSCHAR* cmdline, const PSCHAR* envBlock)
+    {
+        return PlatSpawn(interpreter, cmdline, envBlock, &m_proc);
+    }
+
+    bool Wait(uint32_t* exitCode) { return PlatWait(&m_proc, exitCode); }
+    void Close() { PlatCloseProcess(&m_proc); }
+    uint32_t LastError() const { return PlatLastError(); }
+
+private:
+    PlatProcess m_proc;
+};
+
+// Hand the run to a resident "ps-launcher -Serve" (server.h) and wait for
+// its completion. The script and parameters are the words after -File in
+// the interpreter command line, so pair it with ArgvQuoting (lossless
+// through SplitCommandLine); the working directory goes along with them,
+// as do PS_LAUNCHER_PRIORITY, PS_LAUNCHER_DEADLINE_MS and
+// PS_LAUNCHER_SUBMITTER when set, for the server's queue.
+// The server's own launcher runs the interpreter, logs and journals.
+class DaemonSpawn
+{
+public:
+    DaemonSpawn() : m_connected(false), m_finished(false), m_error(0), m_done() {}
+
+    bool Start(const PSCHAR* interpreter, PSCHAR* cmdline, const PSCHAR* envBlock)
+    {
+        // The server's launcher makes the run and its ids
+        (void)interpreter;
+        (void)envBlock;
+        if (!IpcClientConnect(&m_client, nullptr))
+        {
+            m_error = PlatLastError();
+            return false;
+        }
+        m_connected = true;
+
+        size_t len = PsStrLen(cmdline);
+        int maxArgs = (int)(len / 2 + 2);
+        PSCHAR* storage = (PSCHAR*)ArenaAlloc(&m_client.arena, (len + 1) * sizeof(PSCHAR));
+        PSCHAR** argv = (PSCHAR**)ArenaAlloc(&m_client.arena, (size_t)maxArgs * sizeof(PSCHAR*));
+        int argc = (storage && argv) ? SplitCommandLine(cmdline, storage, argv, maxArgs) : -1;
+        int file = 0;
+        while (file < argc && PsStrCmpI(argv[file], PS_T("-File")) != 0)
+            file++;
+        if (file + 1 >= argc)
+            return Fail();
+
+        PSCHAR cwd[PS_MAX_PATH];
+        IpcSubmit submit = IpcSubmit();
+        submit.id = 1;
+        submit.script = argv[file + 1];
+        submit.args = argv + file + 2;
+        submit.argCount = argc - file - 2;
+        submit.cwd = PlatGetCurrentDirectory(cwd, PS_MAX_PATH) ? cwd : nullptr;
+        PSCHAR priority[16], deadline[16], submitter[128];
+        submit.priority = PlatGetEnv(IPC_PRIORITY_ENV, priority, 16) && priority[0] ? priority : nullptr;
+        submit.deadline = PlatGetEnv(IPC_DEADLINE_ENV, deadline, 16) && deadline[0] ? deadline : nullptr;
+        submit.submitter = PlatGetEnv(IPC_SUBMITTER_ENV, submitter, 128) && submitter[0] ? submitter : nullptr;
+        if (!IpcClientSubmit(&m_client, &submit) || !IpcClientFlush(&m_client))
+            return Fail();
+        return true;
+    }
+
+    // Rejected and failed submissions count as a failed wait, exit code 1
+    bool Wait(uint32_t* exitCode)
+    {
+        while (!m_finished)
+        {
+            if (IpcClientPoll(&m_client, PLAT_WAIT_FOREVER, OnCompletion, this) < 0)
+                break;
+        }
+        bool ok = m_finished && m_done.status == IPC_COMPLETED;
+        *exitCode = ok ? m_done.exitCode : 1;
+        return ok;
+    }
+
+    void Close()
+    {
+        if (m_connected)
+            IpcClientClose(&m_client);
+        m_connected = false;
+    }
+
+    uint32_t LastError() const { return m_error; }
+
+private:
+    static void OnCompletion(void* ctx, const IpcCompletion* completion)
+    {
+        DaemonSpawn* self = static_cast<DaemonSpawn*>(ctx);
+        self->m_done = *completion;
+        self->m_finished = true;
+    }
+
+    bool Fail()
+    {
+        m_error = PlatLastError();
+        Close();
+        return false;
+    }
+
+    IpcClient m_client;
+    bool m_connected;
+    bool m_finished;
+    uint32_t m_error;
+    IpcCompletion m_done;
+};
+
+} // namespace ps
+
+#endif // PS_POLICIES_HPP
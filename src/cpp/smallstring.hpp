@@ -0,0 +1,132 @@
+//--------------------------------------------------------------------------
+// SMALL STRING - Inline buffer first, arena spill second
+//--------------------------------------------------------------------------
+// BasicSmallString<C, N> keeps up to N - 1 characters in the object itself
+// (on the stack for locals). Only a longer string spills onto the launch
+// arena, where it keeps growing in place while it is the top block - the
+// same strategy as the C StrBuf. Without an arena the inline buffer is the
+// hard limit.
+//
+// The length is carried at all times and the buffer is always terminated,
+// so c_str() can go straight to the C core and the platform layer.
+
+#ifndef PS_SMALLSTRING_HPP
+#define PS_SMALLSTRING_HPP
+
+#include "arena.h"
+#include "strview.hpp"
+
+namespace ps {
+
+template <typename C, size_t N>
+class BasicSmallString
+{
+    static_assert(N >= 2, "room for one character and the terminator");
+
+public:
+    typedef CharTraits<C> Traits;
+    typedef BasicStringView<C> View;
+    static constexpr size_t kNoLimit = static_cast<size_t>(-1);
+
+    explicit BasicSmallString(Arena* arena = nullptr, size_t limit = kNoLimit)
+        : m_data(m_inline), m_size(0), m_cap(N), m_limit(limit), m_arena(arena)
+    {
+        m_inline[0] = 0;
+    }
+
+    // m_data may point into the object itself: no copies
+    BasicSmallString(const BasicSmallString&) = delete;
+    BasicSmallString& operator=(const BasicSmallString&) = delete;
+
+    const C* c_str() const { return m_data; }
+    const C* data() const { return m_data; }
+    C* data() { return m_data; }       // CreateProcessW wants a writable command line
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    bool IsInline() const { return m_data == m_inline; }
+    View view() const { return View(m_data, m_size); }
+    operator View() const { return view(); }
+
+    void Clear()
+    {
+        m_size = 0;
+        m_data[0] = 0;
+    }
+
+    // Room for extra more characters; false past the limit or out of memory
+    bool Reserve(size_t extra)
+    {
+        if (extra > m_limit || m_size > m_limit - extra)
+            return false;
+        size_t needed = m_size + extra + 1;
+        if (needed <= m_cap)
+            return true;
+        if (!m_arena)
+            return false;
+
+        size_t newCap = m_cap * 2 < needed ? needed : m_cap * 2;
+        if (!IsInline() &&
+            ArenaExtend(m_arena, m_data, m_cap * sizeof(C), newCap * sizeof(C)))
+        {
+            m_cap = newCap;
+            return true;
+        }
+
+        C* moved = static_cast<C*>(ArenaAlloc(m_arena, newCap * sizeof(C)));
+        if (!moved)
+            return false;
+        Traits::Copy(moved, m_data, m_size + 1);
+        m_data = moved;
+        m_cap = newCap;
+        return true;
+    }
+
+    bool Append(View s)
+    {
+        if (!Reserve(s.size()))
+            return false;
+        Traits::Copy(m_data + m_size, s.data(), s.size());
+        m_size += s.size();
+        m_data[m_size] = 0;
+        return true;
+    }
+
+    bool Append(C c)
+    {
+        if (!Reserve(1))
+            return false;
+        m_data[m_size++] = c;
+        m_data[m_size] = 0;
+        return true;
+    }
+
+    // Decimal text of value (replaces wsprintfW "%u")
+    bool AppendUInt(uint64_t value)
+    {
+        const size_t kDigits = 20;     // UINT64_MAX has 20 digits
+        C digits[kDigits];
+        size_t count = 0;
+        do
+        {
+            digits[kDigits - 1 - count++] = C('0' + value % 10);
+            value /= 10;
+        } while (value);
+        return Append(View(digits + kDigits - count, count));
+    }
+
+private:
+    C* m_data;
+    size_t m_size;             // Characters, excluding the terminator
+    size_t m_cap;              // Characters available, including the terminator
+    size_t m_limit;            // Maximum m_size
+    Arena* m_arena;
+    C m_inline[N];
+};
+
+// Paths fit inline; command lines usually do, and spill when they do not
+typedef BasicSmallString<PSCHAR, PS_MAX_PATH> PathString;
+typedef BasicSmallString<PSCHAR, 1024> CommandLineString;
+
+} // namespace ps
+
+#endif // PS_SMALLSTRING_HPP
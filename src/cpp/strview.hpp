@@ -0,0 +1,113 @@
+//--------------------------------------------------------------------------
+// STRING VIEW - Pointer plus length, computed once
+//--------------------------------------------------------------------------
+// A BasicStringView never owns its characters and never recomputes its
+// length. Literals get their length at compile time; a bare pointer is
+// measured exactly once, when the view is made.
+//
+// Views are not necessarily terminated. Views made from argv entries or
+// from a SmallString are, and the launcher relies on that when it hands
+// them to the C core and the platform layer (IsTerminated documents it).
+
+#ifndef PS_STRVIEW_HPP
+#define PS_STRVIEW_HPP
+
+#include "chartraits.hpp"
+
+namespace ps {
+
+template <typename C>
+class BasicStringView
+{
+public:
+    typedef CharTraits<C> Traits;
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    constexpr BasicStringView() : m_data(nullptr), m_size(0) {}
+    constexpr BasicStringView(const C* data, size_t size) : m_data(data), m_size(size) {}
+
+    // LITERALS: Length known at compile time, no scan at run time
+    template <size_t N>
+    constexpr BasicStringView(const C (&literal)[N]) : m_data(literal), m_size(N - 1) {}
+
+    // A writable array is a buffer, not a literal: its contents are shorter
+    // than N - 1, so it must go through FromTerminated instead
+    template <size_t N>
+    BasicStringView(C (&buffer)[N]) = delete;
+
+    // Measure a terminated string once
+    static BasicStringView FromTerminated(const C* s)
+    {
+        return BasicStringView(s, s ? Traits::Length(s) : 0);
+    }
+
+    constexpr const C* data() const { return m_data; }
+    constexpr size_t size() const { return m_size; }
+    constexpr bool empty() const { return m_size == 0; }
+    constexpr C operator[](size_t i) const { return m_data[i]; }
+    constexpr const C* begin() const { return m_data; }
+    constexpr const C* end() const { return m_data + m_size; }
+    constexpr C front() const { return m_data[0]; }
+    constexpr C back() const { return m_data[m_size - 1]; }
+
+    bool IsTerminated() const { return m_data && m_data[m_size] == 0; }
+
+    // Index of the first c at or after from, or npos
+    size_t Find(C c, size_t from = 0) const
+    {
+        if (from >= m_size)
+            return npos;
+        const C* hit = Traits::Find(m_data + from, m_size - from, c);
+        return hit ? static_cast<size_t>(hit - m_data) : npos;
+    }
+
+    bool Contains(C c) const { return Find(c) != npos; }
+
+    constexpr BasicStringView Substr(size_t pos, size_t count = npos) const
+    {
+        return pos >= m_size ? BasicStringView(m_data + m_size, 0)
+             : BasicStringView(m_data + pos, count < m_size - pos ? count : m_size - pos);
+    }
+
+    bool Equals(BasicStringView other) const
+    {
+        if (m_size != other.m_size)
+            return false;
+        for (size_t i = 0; i < m_size; i++)
+        {
+            if (m_data[i] != other.m_data[i])
+                return false;
+        }
+        return true;
+    }
+
+    // ASCII case-insensitive, like PsStrCmpI but with an early length check
+    bool EqualsIgnoreCase(BasicStringView other) const
+    {
+        if (m_size != other.m_size)
+            return false;
+        for (size_t i = 0; i < m_size; i++)
+        {
+            if (FoldAscii(m_data[i]) != FoldAscii(other.m_data[i]))
+                return false;
+        }
+        return true;
+    }
+
+    bool StartsWith(BasicStringView prefix) const
+    {
+        return prefix.m_size <= m_size && Substr(0, prefix.m_size).Equals(prefix);
+    }
+
+private:
+    const C* m_data;
+    size_t m_size;
+};
+
+typedef BasicStringView<PSCHAR> StringView;
+typedef BasicStringView<char> Utf8View;
+typedef BasicStringView<char16_t> Utf16View;
+
+} // namespace ps
+
+#endif // PS_STRVIEW_HPP
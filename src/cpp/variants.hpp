@@ -0,0 +1,55 @@
+//--------------------------------------------------------------------------
+// LAUNCHER VARIANTS - Policy bundles, one binary each
+//--------------------------------------------------------------------------
+// A variant names one class per policy. ps-launcher.cpp is compiled once
+// per variant with PS_LAUNCHER_VARIANT set to one of these names (CMake
+// does this for the ps-launcher-<variant> targets), so each binary
+// contains only the code its policies use.
+//
+//   Variant          Logger       Errors   Spawn    Quoting
+//   SilentVariant    none         none     direct   PowerShell
+//   VerboseVariant   log file     dialogs  direct   PowerShell
+//   BatchVariant     log file     none     direct   argv-exact
+//   DaemonVariant    none         none     daemon   argv-exact
+//   DefaultVariant   build options (PSL_ENABLE_*), like the C launcher
+
+#ifndef PS_VARIANTS_HPP
+#define PS_VARIANTS_HPP
+
+#include "cmdline.hpp"
+#include "config.h"
+#include "policies.hpp"
+
+namespace ps {
+
+template <typename LoggerT, typename ReporterT, typename SpawnerT, typename QuotingT>
+struct LaunchPolicy
+{
+    typedef LoggerT Logger;
+    typedef ReporterT Reporter;
+    typedef SpawnerT Spawner;
+    typedef QuotingT Quoting;
+};
+
+typedef LaunchPolicy<NullLogger, SilentReporter, DirectSpawn, PowerShellQuoting> SilentVariant;
+typedef LaunchPolicy<FileLogger, DialogReporter, DirectSpawn, PowerShellQuoting> VerboseVariant;
+typedef LaunchPolicy<FileLogger, QuietReporter, DirectSpawn, ArgvQuoting> BatchVariant;
+typedef LaunchPolicy<NullLogger, QuietReporter, DaemonSpawn, ArgvQuoting> DaemonVariant;
+
+// The build options only choose types here; no call is rewritten
+#ifdef ENABLE_LOGGING
+typedef FileLogger DefaultLogger;
+#else
+typedef NullLogger DefaultLogger;
+#endif
+#ifdef ENABLE_ERROR_DIALOGS
+typedef DialogReporter DefaultReporter;
+#else
+typedef SilentReporter DefaultReporter;
+#endif
+
+typedef LaunchPolicy<DefaultLogger, DefaultReporter, DirectSpawn, PowerShellQuoting> DefaultVariant;
+
+} // namespace ps
+
+#endif // PS_VARIANTS_HPP
@@ -0,0 +1,443 @@
+//--------------------------------------------------------------------------
+// PLATFORM INTERFACE - Everything the core needs from the operating system
+//--------------------------------------------------------------------------
+// The core library only talks to the OS through these functions. There are
+// two implementations:
+// - platform_win32.c : kernel32/user32/shell32, no CRT
+// - platform_posix.c : libc and POSIX system calls (Linux, macOS)
+//
+// Handles are carried as intptr_t so this header needs no system includes:
+// a HANDLE on Windows, a file descriptor or pid on POSIX.
+
+#ifndef PS_PLATFORM_H
+#define PS_PLATFORM_H
+
+#include "pstypes.h"
+
+PS_EXTERN_C_BEGIN
+
+//--------------------------------------------------------------------------
+// VIRTUAL MEMORY
+//--------------------------------------------------------------------------
+// Address space is reserved once and committed in steps by the arena
+// (arena.c): VirtualAlloc MEM_RESERVE/MEM_COMMIT on Windows, mmap with
+// PROT_NONE then mprotect on POSIX. Committed pages read as zero.
+void* PlatReserve(size_t size);
+bool PlatCommit(void* address, size_t size);
+void PlatRelease(void* address, size_t size);
+
+//--------------------------------------------------------------------------
+// FILES
+//--------------------------------------------------------------------------
+typedef intptr_t PlatFile;
+#define PLAT_INVALID_FILE ((PlatFile)-1)
+
+typedef enum PlatFileMode
+{
+    PLAT_FILE_OVERWRITE,   // Create or truncate (CREATE_ALWAYS)
+    PLAT_FILE_APPEND,      // Create if missing, writes go to the end
+    PLAT_FILE_CREATE_NEW   // Create; fails if the file exists (CREATE_NEW)
+} PlatFileMode;
+
+bool PlatFileExists(const PSCHAR* path);
+PlatFile PlatCreateFile(const PSCHAR* path, PlatFileMode mode);
+bool PlatWriteFile(PlatFile file, const void* data, size_t size);
+void PlatCloseFile(PlatFile file);
+
+// Read-only access (scripts being packed); shared with other readers/writers
+PlatFile PlatOpenFile(const PSCHAR* path);
+bool PlatFileSize(PlatFile file, uint64_t* size);
+
+// Read exactly size bytes; false on error or a short file
+bool PlatReadFile(PlatFile file, void* data, size_t size);
+
+// Identity and change stamp of a file or directory. The same values mean
+// the same, unmodified file; units differ per platform, so only compare.
+typedef struct PlatFileInfo
+{
+    uint64_t volume;       // Volume serial number (Windows) or st_dev
+    uint64_t fileId;       // File index (Windows) or st_ino
+    uint64_t size;
+    uint64_t mtime;        // Last write: FILETIME ticks or nanoseconds
+} PlatFileInfo;
+
+#ifdef _WIN32
+    #define PLAT_FILE_TICKS_PER_SECOND 10000000ull
+#else
+    #define PLAT_FILE_TICKS_PER_SECOND 1000000000ull
+#endif
+
+// The current time in PlatFileInfo.mtime units
+uint64_t PlatFileTimeNow(void);
+
+bool PlatGetFileInfo(const PSCHAR* path, PlatFileInfo* info);
+
+// Replace "to" with "from" in one step (MoveFileExW / rename)
+bool PlatRenameFile(const PSCHAR* from, const PSCHAR* to);
+
+bool PlatDeleteFile(const PSCHAR* path);
+
+// Set the last write time to now (without opening for writing)
+bool PlatTouchFile(const PSCHAR* path);
+
+// The launcher's own stdout; PLAT_INVALID_FILE if it has none
+PlatFile PlatStandardOutput(void);
+
+// Read-only view of a whole file; NULL if it is missing or empty
+const void* PlatMapFile(const PSCHAR* path, size_t* size);
+void PlatUnmapFile(const void* view, size_t size);
+
+// Create one directory level; true if it exists afterwards
+bool PlatCreateDirectory(const PSCHAR* path);
+
+// Environment variable into out; false if unset or it does not fit
+bool PlatGetEnv(const PSCHAR* name, PSCHAR* out, size_t outSize);
+
+// Per-user state directory, created if missing:
+// %LOCALAPPDATA%\ps-launcher  or  $XDG_STATE_HOME/ps-launcher
+bool PlatGetStateDirectory(PSCHAR* out, size_t outSize);
+
+//--------------------------------------------------------------------------
+// DIRECTORIES
+//--------------------------------------------------------------------------
+// Called once per entry, without "." and "..". Symbolic links and reparse
+// points are reported as links, not followed, so walks cannot loop.
+// Return false to stop early.
+typedef enum PlatEntryType
+{
+    PLAT_ENTRY_FILE,
+    PLAT_ENTRY_DIRECTORY,
+    PLAT_ENTRY_LINK
+} PlatEntryType;
+
+typedef bool (*PlatDirCallback)(void* ctx, const PSCHAR* name, size_t nameLen, PlatEntryType type);
+
+// False if the directory cannot be read or the callback stopped the walk
+bool PlatListDirectory(const PSCHAR* path, PlatDirCallback fn, void* ctx);
+
+//--------------------------------------------------------------------------
+// THREADS
+//--------------------------------------------------------------------------
+// The caller owns the PlatThread storage until PlatJoinThread returns.
+typedef void (*PlatThreadFn)(void* arg);
+
+typedef struct PlatThread
+{
+    intptr_t handle;
+    PlatThreadFn fn;
+    void* arg;
+} PlatThread;
+
+bool PlatStartThread(PlatThread* thread, PlatThreadFn fn, void* arg);
+void PlatJoinThread(PlatThread* thread);
+uint32_t PlatProcessorCount(void);
+
+// Load on the whole machine; zero where the system does not say
+typedef struct PlatLoad
+{
+    uint32_t runnable;               // Threads running or waiting for a CPU, not the caller
+    uint64_t availableBytes;         // Memory to be had without swapping
+    uint64_t totalBytes;
+} PlatLoad;
+
+// Linux reads /proc/loadavg and /proc/meminfo. Windows reports memory
+// only: its ready queue is a performance counter, too slow to ask this
+// often. False when nothing is known.
+bool PlatSystemLoad(PlatLoad* load);
+
+// Share of recent time in which work stalled, in hundredths of a percent
+typedef struct PlatPressure
+{
+    uint32_t cpu;                    // Waiting for a processor
+    uint32_t io;                     // Waiting for storage
+} PlatPressure;
+
+// Linux reads the ten-second "some" averages of /proc/pressure (PSI), or
+// without PSI estimates cpu from the run queue against the processors.
+// Windows has no stall accounting: cpu is the share of processor time
+// busy since the previous call (GetSystemTimes), io is 0. False when
+// nothing is known.
+bool PlatSystemPressure(PlatPressure* pressure);
+
+//--------------------------------------------------------------------------
+// EMBEDDED PAYLOAD
+//--------------------------------------------------------------------------
+// Scripts attached to the executable by pack mode (payload.h):
+// - Windows : the PSPAYLOAD RCDATA resource (UpdateResourceW)
+// - POSIX   : appended to the file, then an 8-byte size and "PSPAYLD1"
+// The returned view is read-only and valid for the life of the process.
+const void* PlatFindPayload(size_t* size);
+
+// Copy this executable to outPath (POSIX: without any payload, mode 0755)
+bool PlatCopySelf(const PSCHAR* outPath);
+
+// Attach data to the executable at exePath, replacing any existing payload
+bool PlatEmbedPayload(const PSCHAR* exePath, const void* data, size_t size);
+
+//--------------------------------------------------------------------------
+// TEXT
+//--------------------------------------------------------------------------
+// Convert srcLen characters to UTF-8 (no terminator written)
+// Returns bytes written, or 0 if the output does not fit
+size_t PlatToUtf8(const PSCHAR* src, size_t srcLen, char* out, size_t outSize);
+
+typedef enum PlatMessageKind
+{
+    PLAT_MESSAGE_INFO,
+    PLAT_MESSAGE_ERROR
+} PlatMessageKind;
+
+// MessageBoxW on Windows, stderr on POSIX
+void PlatShowMessage(const PSCHAR* text, const PSCHAR* title, PlatMessageKind kind);
+
+//--------------------------------------------------------------------------
+// PROCESSES
+//--------------------------------------------------------------------------
+typedef struct PlatProcess
+{
+    intptr_t process;      // HANDLE (Windows) or pid (POSIX)
+    intptr_t thread;       // Primary thread HANDLE (Windows only)
+    uint32_t pid;
+} PlatProcess;
+
+// Absolute path of the PowerShell interpreter; never searched on PATH
+bool PlatGetInterpreterPath(PSCHAR* out, size_t outSize);
+
+// Absolute path of this executable (child launchers of the scheduler)
+bool PlatGetExecutablePath(PSCHAR* out, size_t outSize);
+
+// Working directory of this process (forwarded with daemon submissions)
+bool PlatGetCurrentDirectory(PSCHAR* out, size_t outSize);
+
+// Environment of the current process as a block: "K=V\0K=V\0\0"
+// The block stays valid until PlatFreeEnvironment.
+const PSCHAR* PlatGetEnvironment(void);
+void PlatFreeEnvironment(const PSCHAR* block);
+
+// Start interpreter with the given command line (CommandLineToArgvW syntax)
+// envBlock uses the PlatGetEnvironment layout; NULL inherits ours.
+// The child runs without a console window and inherits no handles.
+bool PlatSpawn(const PSCHAR* interpreter, PSCHAR* cmdline, const PSCHAR* envBlock,
+               PlatProcess* proc);
+
+// PlatSpawn, with input written to the child's stdin through a pipe that
+// is closed once everything is written. stdout and stderr are shared with
+// the launcher. A child that exits without reading its input is not an
+// error; its exit code tells the story.
+bool PlatSpawnWithInput(const PSCHAR* interpreter, PSCHAR* cmdline, const PSCHAR* envBlock,
+                        const void* input, size_t inputSize, PlatProcess* proc);
+
+// PlatSpawn, with the child's stdout written to output (at the file's
+// current position; stderr stays shared). The launcher keeps its handle,
+// and writes made through it after the child exits follow its output.
+bool PlatSpawnToFile(const PSCHAR* interpreter, PSCHAR* cmdline, const PSCHAR* envBlock,
+                     PlatFile output, PlatProcess* proc);
+
+// PlatSpawn, with the child started in directory (NULL: ours)
+bool PlatSpawnInDirectory(const PSCHAR* interpreter, PSCHAR* cmdline, const PSCHAR* envBlock,
+                          const PSCHAR* directory, PlatProcess* proc);
+
+// Block until the child exits and fetch its exit code
+bool PlatWait(PlatProcess* proc, uint32_t* exitCode);
+
+// PlatWait without blocking: false while the child is still running. A
+// child that can no longer be waited for counts as exited with code 1.
+bool PlatPollProcess(PlatProcess* proc, uint32_t* exitCode);
+void PlatCloseProcess(PlatProcess* proc);
+
+// PlatSpawnInDirectory, with the child's stdout and stderr both sent to a
+// pipe whose read end goes to *output (close it with PlatCloseFile). The
+// child gets no stdin. The pipe is inherited by this child alone, so
+// several can be started from different threads.
+bool PlatSpawnCaptured(const PSCHAR* interpreter, PSCHAR* cmdline, const PSCHAR* envBlock,
+                       const PSCHAR* directory, PlatProcess* proc, PlatFile* output);
+
+// Read what the pipe holds without blocking: true with *got = 0 when
+// nothing is waiting, false once every writer has closed it
+bool PlatReadAvailable(PlatFile pipe, void* data, size_t size, size_t* got);
+
+// Block until one of the pipes has data or is closed, one of the
+// processes exits, or the timeout passes. Linux polls the pipes and a
+// pidfd per process; Windows cannot wait on anonymous pipes, so it waits
+// on the processes for at most PLAT_OUTPUT_POLL_MS. Either may return
+// early for no reason; callers check what is ready.
+#define PLAT_OUTPUT_POLL_MS 10
+void PlatWaitOutput(const PlatFile* pipes, size_t pipeCount, const PlatProcess* procs, size_t procCount,
+                    uint32_t timeoutMillis);
+
+// Resources an exited child used
+typedef struct PlatUsage
+{
+    uint64_t userMicros;
+    uint64_t kernelMicros;
+    uint64_t peakMemoryBytes;        // Peak resident set / working set
+} PlatUsage;
+
+// PlatPollProcess that also fetches the child's resource usage
+bool PlatPollProcessUsage(PlatProcess* proc, uint32_t* exitCode, PlatUsage* usage);
+
+// Terminate the child at once (SIGKILL / TerminateProcess); it still has
+// to be collected with PlatWait or PlatPollProcess
+bool PlatKillProcess(PlatProcess* proc);
+
+typedef enum PlatChildState
+{
+    PLAT_CHILD_EXITED,     // *exitCode is set
+    PLAT_CHILD_RUNNING,    // The timeout passed first
+    PLAT_CHILD_LOST        // It cannot be waited for (PlatWait would fail)
+} PlatChildState;
+
+// PlatWait for at most timeoutMillis
+PlatChildState PlatWaitTimeout(PlatProcess* proc, uint32_t timeoutMillis, uint32_t* exitCode);
+
+// CPU time (user plus kernel) a running child has used so far. Linux
+// reads /proc/<pid>/stat (clock-tick resolution); false where there is
+// no such source.
+bool PlatProcessCpuMicros(const PlatProcess* proc, uint64_t* micros);
+
+uint32_t PlatCurrentProcessId(void);
+
+// Whether any process has this id, including other users' processes
+bool PlatProcessAlive(uint32_t pid);
+
+// A child's whole process tree, to be suspended and resumed together:
+// - Windows : a job object the child is assigned to; its descendants
+//             join it as they start. Suspending stops every thread of
+//             every process in the job.
+// - Linux   : a cgroup v2 leaf made under the launcher's own cgroup and
+//             frozen through cgroup.freeze, where that subtree is
+//             delegated to us; otherwise the descendants found through
+//             /proc, stopped with SIGSTOP until a pass finds no new one.
+// Open it as soon as the child is spawned: the child is moved in then,
+// before in practice it has started anything of its own.
+typedef struct PlatTree
+{
+    intptr_t handle;                 // Job HANDLE, cgroup directory fd; -1: none
+    uint32_t pid;
+} PlatTree;
+
+// False if the child cannot be tracked at all; the tree is then empty
+bool PlatTreeOpen(PlatTree* tree, const PlatProcess* proc);
+bool PlatTreeSuspend(PlatTree* tree, bool suspend);
+
+// The processes stay as they are: resume first
+void PlatTreeClose(PlatTree* tree);
+
+//--------------------------------------------------------------------------
+// SHARED MEMORY
+//--------------------------------------------------------------------------
+// A named region mapped read-write into every process of this user that
+// opens it, held in memory only:
+// - Windows : pagefile-backed section Local\<name>; gone with its last handle
+// - POSIX   : shm_open("/<name>-<uid>"), mode 0600; lasts until reboot
+// New memory reads as zero. Opening an existing region smaller than size
+// grows it, so processes that race to create it agree on its contents.
+typedef struct PlatShared
+{
+    void* base;
+    size_t size;
+    intptr_t handle;       // Section HANDLE (Windows only)
+} PlatShared;
+
+// create false: fail if nobody has created the region yet
+bool PlatOpenShared(const PSCHAR* name, size_t size, bool create, PlatShared* shared);
+
+// The same, backed by a file so the contents outlive every process. The
+// file is created (mode 0600) or grown to size as needed.
+bool PlatMapSharedFile(const PSCHAR* path, size_t size, PlatShared* shared);
+void PlatCloseShared(PlatShared* shared);
+
+//--------------------------------------------------------------------------
+// DIRECTORY WATCH
+//--------------------------------------------------------------------------
+// Files written, created or moved into one directory (not its
+// subdirectories): inotify IN_CLOSE_WRITE/IN_MOVED_TO on Linux,
+// ReadDirectoryChangesW on Windows. When the OS queue overflows, events
+// are lost and the caller must rescan the directory.
+typedef struct PlatWatch
+{
+    intptr_t handle;       // Directory HANDLE (Windows) or inotify descriptor
+    intptr_t event;        // Read completion event (Windows only)
+    void* buffer;          // Event buffer
+    bool pending;          // A read is outstanding (Windows only)
+} PlatWatch;
+
+#define PLAT_WAIT_FOREVER 0xFFFFFFFFu
+
+typedef enum PlatWatchWake
+{
+    PLAT_WAKE_TIMEOUT,
+    PLAT_WAKE_EVENTS,      // PlatWatchRead has something
+    PLAT_WAKE_CHILD,       // The child given to PlatWatchWait exited
+    PLAT_WAKE_ERROR
+} PlatWatchWake;
+
+// Called once per changed file; name is not terminated
+typedef void (*PlatWatchCallback)(void* ctx, const PSCHAR* name, size_t nameLen);
+
+bool PlatWatchOpen(PlatWatch* watch, const PSCHAR* path);
+
+// Block until changes are queued, child (if not NULL) exits, or the
+// timeout passes
+PlatWatchWake PlatWatchWait(PlatWatch* watch, const PlatProcess* child, uint32_t timeoutMillis);
+
+// Report every queued change without blocking. *overflow is set if the OS
+// dropped events. False once the watch has failed (directory deleted).
+bool PlatWatchRead(PlatWatch* watch, PlatWatchCallback fn, void* ctx, bool* overflow);
+
+void PlatWatchClose(PlatWatch* watch);
+
+//--------------------------------------------------------------------------
+// LOCAL IPC
+//--------------------------------------------------------------------------
+// Byte streams between processes of this machine and user:
+// - Windows : named pipe \\.\pipe\<name>, remote clients rejected
+// - POSIX   : Unix domain socket at a path, mode 0600
+// A listening endpoint on POSIX lasts until its socket file is deleted;
+// PlatIpcAccept then reports PLAT_IPC_CLOSED.
+typedef struct PlatIpc
+{
+    intptr_t handle;       // Pipe HANDLE (Windows) or socket descriptor
+    void* state;           // Overlapped I/O (Windows), socket path (POSIX listener)
+} PlatIpc;
+
+typedef enum PlatIpcStatus
+{
+    PLAT_IPC_OK,
+    PLAT_IPC_TIMEOUT,
+    PLAT_IPC_CLOSED        // Peer gone, endpoint removed, or an I/O error
+} PlatIpcStatus;
+
+// <state directory>/ps-launcher.sock  or  \\.\pipe\ps-launcher-<user name>
+bool PlatIpcDefaultEndpoint(PSCHAR* out, size_t outSize);
+
+// False if the endpoint is in use by a live server or cannot be created
+bool PlatIpcListen(PlatIpc* server, const PSCHAR* endpoint);
+PlatIpcStatus PlatIpcAccept(PlatIpc* server, PlatIpc* conn);
+bool PlatIpcConnect(PlatIpc* conn, const PSCHAR* endpoint);
+
+// Up to size bytes, waiting at most timeoutMillis for the first
+PlatIpcStatus PlatIpcRead(PlatIpc* conn, void* buffer, size_t size, uint32_t timeoutMillis, size_t* got);
+
+// All of data, or false
+bool PlatIpcWrite(PlatIpc* conn, const void* data, size_t size);
+void PlatIpcClose(PlatIpc* conn);
+
+//--------------------------------------------------------------------------
+// ERRORS AND TIME
+//--------------------------------------------------------------------------
+uint32_t PlatLastError(void);
+void PlatFormatError(uint32_t err, PSCHAR* out, size_t outSize);
+
+uint64_t PlatMonotonicNanos(void);      // For durations
+uint64_t PlatWallClockMillis(void);     // Unix epoch milliseconds
+
+// Local time minus UTC, in minutes, at the given instant (daylight saving
+// included)
+int32_t PlatLocalOffsetMinutes(uint64_t unixMillis);
+
+void PlatSleepMillis(uint32_t millis);
+
+PS_EXTERN_C_END
+
+#endif // PS_PLATFORM_H
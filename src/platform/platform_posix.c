@@ -0,0 +1,1512 @@
+//--------------------------------------------------------------------------
+// POSIX BACKEND - Platform interface on libc and POSIX system calls
+//--------------------------------------------------------------------------
+// PSCHAR is char here, so every string is UTF-8 and passes straight
+// through to the system calls. The child command line is split with the
+// same rules powershell.exe applies on Windows, so what pwsh receives on
+// Linux is exactly what the Windows build would have delivered.
+
+#define _GNU_SOURCE
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "args.h"
+#include "platform.h"
+#include "psstr.h"
+
+extern char** environ;
+
+//--------------------------------------------------------------------------
+// VIRTUAL MEMORY
+//--------------------------------------------------------------------------
+void* PlatReserve(size_t size)
+{
+    // MAP_NORESERVE: Reserved-but-untouched pages are not charged to swap
+    void* p = mmap(NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return p == MAP_FAILED ? NULL : p;
+}
+
+bool PlatCommit(void* address, size_t size)
+{
+    return mprotect(address, size, PROT_READ | PROT_WRITE) == 0;
+}
+
+void PlatRelease(void* address, size_t size)
+{
+    munmap(address, size);
+}
+
+//--------------------------------------------------------------------------
+// FILES
+//--------------------------------------------------------------------------
+bool PlatFileExists(const PSCHAR* path)
+{
+    return access(path, F_OK) == 0;
+}
+
+PlatFile PlatCreateFile(const PSCHAR* path, PlatFileMode mode)
+{
+    int flags = O_WRONLY | O_CREAT | O_CLOEXEC;
+    flags |= (mode == PLAT_FILE_APPEND) ? O_APPEND : (mode == PLAT_FILE_CREATE_NEW) ? O_EXCL : O_TRUNC;
+    int fd = open(path, flags, 0644);
+    return fd < 0 ? PLAT_INVALID_FILE : (PlatFile)fd;
+}
+
+bool PlatWriteFile(PlatFile file, const void* data, size_t size)
+{
+    const char* p = (const char*)data;
+    while (size > 0)
+    {
+        ssize_t n = write((int)file, p, size);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+void PlatCloseFile(PlatFile file)
+{
+    if (file != PLAT_INVALID_FILE)
+        close((int)file);
+}
+
+PlatFile PlatOpenFile(const PSCHAR* path)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    return fd < 0 ? PLAT_INVALID_FILE : (PlatFile)fd;
+}
+
+bool PlatFileSize(PlatFile file, uint64_t* size)
+{
+    struct stat st;
+    if (fstat((int)file, &st) != 0)
+        return false;
+    *size = (uint64_t)st.st_size;
+    return true;
+}
+
+bool PlatReadFile(PlatFile file, void* data, size_t size)
+{
+    char* p = (char*)data;
+    while (size > 0)
+    {
+        ssize_t n = read((int)file, p, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+bool PlatGetFileInfo(const PSCHAR* path, PlatFileInfo* info)
+{
+    struct stat st;
+    if (stat(path, &st) != 0)
+        return false;
+    info->volume = (uint64_t)st.st_dev;
+    info->fileId = (uint64_t)st.st_ino;
+    info->size = (uint64_t)st.st_size;
+    info->mtime = (uint64_t)st.st_mtim.tv_sec * 1000000000ull + (uint64_t)st.st_mtim.tv_nsec;
+    return true;
+}
+
+bool PlatRenameFile(const PSCHAR* from, const PSCHAR* to)
+{
+    return rename(from, to) == 0;
+}
+
+bool PlatDeleteFile(const PSCHAR* path)
+{
+    return unlink(path) == 0;
+}
+
+bool PlatTouchFile(const PSCHAR* path)
+{
+    return utimensat(AT_FDCWD, path, NULL, 0) == 0;
+}
+
+PlatFile PlatStandardOutput(void)
+{
+    return (PlatFile)STDOUT_FILENO;
+}
+
+const void* PlatMapFile(const PSCHAR* path, size_t* size)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    void* view = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+        return NULL;
+    *size = (size_t)st.st_size;
+    return view;
+}
+
+void PlatUnmapFile(const void* view, size_t size)
+{
+    if (view)
+        munmap((void*)view, size);
+}
+
+// mkdir -p: create each missing component in turn
+static void MakeDirectories(char* path)
+{
+    for (char* p = path + 1; *p; p++)
+    {
+        if (*p == '/')
+        {
+            *p = 0;
+            mkdir(path, 0700);
+            *p = '/';
+        }
+    }
+    mkdir(path, 0700);
+}
+
+bool PlatCreateDirectory(const PSCHAR* path)
+{
+    return mkdir(path, 0700) == 0 || errno == EEXIST;
+}
+
+bool PlatGetEnv(const PSCHAR* name, PSCHAR* out, size_t outSize)
+{
+    const char* value = getenv(name);
+    size_t pos = 0;
+    return value && AppendStr(out, outSize, value, &pos);
+}
+
+bool PlatGetStateDirectory(PSCHAR* out, size_t outSize)
+{
+    const char* base = getenv("XDG_STATE_HOME");
+    size_t pos = 0;
+    out[0] = 0;
+
+    if (base && base[0] == '/')
+    {
+        if (!AppendStr(out, outSize, base, &pos))
+            return false;
+    }
+    else
+    {
+        const char* home = getenv("HOME");
+        if (!home || !home[0])
+            return false;
+        if (!AppendStr(out, outSize, home, &pos) ||
+            !AppendStr(out, outSize, "/.local/state", &pos))
+            return false;
+    }
+
+    if (!AppendStr(out, outSize, "/ps-launcher", &pos))
+        return false;
+    MakeDirectories(out);
+    return true;
+}
+
+//--------------------------------------------------------------------------
+// DIRECTORIES
+//--------------------------------------------------------------------------
+bool PlatListDirectory(const PSCHAR* path, PlatDirCallback fn, void* ctx)
+{
+    DIR* dir = opendir(path);
+    if (!dir)
+        return false;
+
+    bool ok = true;
+    struct dirent* entry;
+    while (ok && (entry = readdir(dir)) != NULL)
+    {
+        const char* name = entry->d_name;
+        if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0)))
+            continue;
+
+        // Some file systems leave d_type unknown: ask without following links
+        unsigned char type = entry->d_type;
+        if (type == DT_UNKNOWN)
+        {
+            struct stat st;
+            if (fstatat(dirfd(dir), name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+                continue;
+            type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG
+                 : S_ISLNK(st.st_mode) ? DT_LNK : DT_UNKNOWN;
+        }
+        if (type != DT_DIR && type != DT_REG && type != DT_LNK)
+            continue;
+
+        ok = fn(ctx, name, strlen(name),
+                type == DT_DIR ? PLAT_ENTRY_DIRECTORY : type == DT_LNK ? PLAT_ENTRY_LINK : PLAT_ENTRY_FILE);
+    }
+    closedir(dir);
+    return ok;
+}
+
+//--------------------------------------------------------------------------
+// THREADS
+//--------------------------------------------------------------------------
+static void* ThreadMain(void* p)
+{
+    PlatThread* thread = (PlatThread*)p;
+    thread->fn(thread->arg);
+    return NULL;
+}
+
+bool PlatStartThread(PlatThread* thread, PlatThreadFn fn, void* arg)
+{
+    pthread_t id;
+    thread->fn = fn;
+    thread->arg = arg;
+    if (pthread_create(&id, NULL, ThreadMain, thread) != 0)
+        return false;
+    thread->handle = (intptr_t)id;
+    return true;
+}
+
+void PlatJoinThread(PlatThread* thread)
+{
+    pthread_join((pthread_t)thread->handle, NULL);
+    thread->handle = 0;
+}
+
+uint32_t PlatProcessorCount(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (uint32_t)n : 1;
+}
+
+static ssize_t ReadProcFile(const char* path, char* text, size_t size)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    ssize_t n = read(fd, text, size - 1);
+    close(fd);
+    if (n >= 0)
+        text[n] = 0;
+    return n;
+}
+
+// The "<name>: <n> kB" line of /proc/meminfo, in bytes
+static uint64_t MemInfoBytes(const char* text, const char* name)
+{
+    const char* p = strstr(text, name);
+    return p ? (uint64_t)strtoull(p + strlen(name), NULL, 10) * 1024u : 0;
+}
+
+bool PlatSystemLoad(PlatLoad* load)
+{
+    memset(load, 0, sizeof(*load));
+    char text[4096];
+
+    // The fourth field is "running/total"; running counts the caller
+    bool known = false;
+    if (ReadProcFile("/proc/loadavg", text, sizeof(text)) > 0)
+    {
+        const char* p = text;
+        for (int field = 0; field < 3 && p; field++)
+            p = strchr(p + 1, ' ');
+        if (p)
+        {
+            unsigned long running = strtoul(p + 1, NULL, 10);
+            load->runnable = running > 0 ? (uint32_t)(running - 1) : 0;
+            known = true;
+        }
+    }
+    if (ReadProcFile("/proc/meminfo", text, sizeof(text)) > 0)
+    {
+        load->totalBytes = MemInfoBytes(text, "MemTotal:");
+        load->availableBytes = MemInfoBytes(text, "MemAvailable:");
+        known = known || load->totalBytes > 0;
+    }
+    return known;
+}
+
+// "some avg10=12.34 ..." -> 1234
+static bool PressureAverage(const char* path, uint32_t* value)
+{
+    char text[512];
+    if (ReadProcFile(path, text, sizeof(text)) <= 0)
+        return false;
+    const char* p = strstr(text, "avg10=");
+    if (!p)
+        return false;
+    char* end;
+    unsigned long whole = strtoul(p + 6, &end, 10);
+    unsigned long hundredths = 0;
+    if (*end == '.' && end[1] >= '0' && end[1] <= '9')
+    {
+        hundredths = (unsigned long)(end[1] - '0') * 10;
+        if (end[2] >= '0' && end[2] <= '9')
+            hundredths += (unsigned long)(end[2] - '0');
+    }
+    *value = (uint32_t)(whole * 100 + hundredths);
+    return true;
+}
+
+bool PlatSystemPressure(PlatPressure* pressure)
+{
+    memset(pressure, 0, sizeof(*pressure));
+    if (PressureAverage("/proc/pressure/cpu", &pressure->cpu))
+    {
+        PressureAverage("/proc/pressure/io", &pressure->io);
+        return true;
+    }
+
+    // NO PSI: Runnable threads beyond the processors are waiting for one
+    PlatLoad load;
+    if (!PlatSystemLoad(&load) || load.runnable == 0)
+        return load.totalBytes > 0;
+    uint32_t cpus = PlatProcessorCount();
+    pressure->cpu = load.runnable > cpus ? (load.runnable - cpus) * 10000 / load.runnable : 0;
+    return true;
+}
+
+//--------------------------------------------------------------------------
+// EMBEDDED PAYLOAD
+//--------------------------------------------------------------------------
+// ELF has no resource section, so the payload goes after the image:
+//   <executable> <payload> <u64 payload size, little-endian> "PSPAYLD1"
+// The loader ignores trailing bytes, and stripping the payload is a
+// truncate. The running image is found through /proc/self/exe (Linux).
+#define TRAILER_MAGIC "PSPAYLD1"
+#define TRAILER_SIZE  16
+
+static int OpenSelf(void)
+{
+    return open("/proc/self/exe", O_RDONLY | O_CLOEXEC);
+}
+
+// Size of the payload attached to fd (0 if none); *fileSize gets the total
+static uint64_t AttachedPayloadSize(int fd, uint64_t* fileSize)
+{
+    struct stat st;
+    unsigned char trailer[TRAILER_SIZE];
+    if (fstat(fd, &st) != 0)
+        return 0;
+    *fileSize = (uint64_t)st.st_size;
+    if (*fileSize < TRAILER_SIZE ||
+        pread(fd, trailer, TRAILER_SIZE, st.st_size - TRAILER_SIZE) != TRAILER_SIZE ||
+        memcmp(trailer + 8, TRAILER_MAGIC, 8) != 0)
+        return 0;
+
+    uint64_t size = 0;
+    for (int i = 7; i >= 0; i--)
+        size = (size << 8) | trailer[i];
+    return size <= *fileSize - TRAILER_SIZE ? size : 0;
+}
+
+const void* PlatFindPayload(size_t* size)
+{
+    // Probed once per process; the mapping lives until exit
+    static const void* payload;
+    static size_t payloadSize;
+    static bool probed;
+
+    if (!probed)
+    {
+        probed = true;
+        int fd = OpenSelf();
+        uint64_t fileSize = 0;
+        uint64_t attached = fd < 0 ? 0 : AttachedPayloadSize(fd, &fileSize);
+        if (attached > 0)
+        {
+            // mmap offsets must be page aligned
+            uint64_t offset = fileSize - TRAILER_SIZE - attached;
+            uint64_t aligned = offset & ~(uint64_t)(sysconf(_SC_PAGESIZE) - 1);
+            size_t delta = (size_t)(offset - aligned);
+            void* map = mmap(NULL, (size_t)attached + delta, PROT_READ, MAP_PRIVATE, fd, (off_t)aligned);
+            if (map != MAP_FAILED)
+            {
+                payload = (const char*)map + delta;
+                payloadSize = (size_t)attached;
+            }
+        }
+        if (fd >= 0)
+            close(fd);
+    }
+
+    *size = payloadSize;
+    return payload;
+}
+
+bool PlatCopySelf(const PSCHAR* outPath)
+{
+    int in = OpenSelf();
+    if (in < 0)
+        return false;
+
+    uint64_t fileSize = 0;
+    uint64_t attached = AttachedPayloadSize(in, &fileSize);
+    uint64_t remaining = attached ? fileSize - TRAILER_SIZE - attached : fileSize;
+
+    int out = open(outPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0755);
+    bool ok = out >= 0;
+    char buffer[65536];
+    while (ok && remaining > 0)
+    {
+        size_t chunk = remaining < sizeof(buffer) ? (size_t)remaining : sizeof(buffer);
+        ok = PlatReadFile(in, buffer, chunk) && PlatWriteFile(out, buffer, chunk);
+        remaining -= chunk;
+    }
+
+    close(in);
+    if (out >= 0 && close(out) != 0)
+        ok = false;
+    return ok;
+}
+
+bool PlatEmbedPayload(const PSCHAR* exePath, const void* data, size_t size)
+{
+    int fd = open(exePath, O_RDWR | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    // Replace, never stack: drop an existing payload first
+    uint64_t fileSize = 0;
+    uint64_t attached = AttachedPayloadSize(fd, &fileSize);
+    uint64_t end = attached ? fileSize - TRAILER_SIZE - attached : fileSize;
+
+    unsigned char trailer[TRAILER_SIZE];
+    for (int i = 0; i < 8; i++)
+        trailer[i] = (unsigned char)((uint64_t)size >> (8 * i));
+    memcpy(trailer + 8, TRAILER_MAGIC, 8);
+
+    bool ok = ftruncate(fd, (off_t)end) == 0 &&
+              lseek(fd, (off_t)end, SEEK_SET) == (off_t)end &&
+              PlatWriteFile(fd, data, size) &&
+              PlatWriteFile(fd, trailer, TRAILER_SIZE);
+    if (close(fd) != 0)
+        ok = false;
+    return ok;
+}
+
+//--------------------------------------------------------------------------
+// TEXT
+//--------------------------------------------------------------------------
+size_t PlatToUtf8(const PSCHAR* src, size_t srcLen, char* out, size_t outSize)
+{
+    if (srcLen > outSize)
+        return 0;
+    memcpy(out, src, srcLen);
+    return srcLen;
+}
+
+void PlatShowMessage(const PSCHAR* text, const PSCHAR* title, PlatMessageKind kind)
+{
+    (void)kind;
+    fprintf(stderr, "%s: %s\n", title, text);
+}
+
+//--------------------------------------------------------------------------
+// PROCESSES
+//--------------------------------------------------------------------------
+bool PlatGetInterpreterPath(PSCHAR* out, size_t outSize)
+{
+    static const char* const candidates[] = {
+        "/usr/bin/pwsh",
+        "/usr/local/bin/pwsh",
+        "/opt/microsoft/powershell/7/pwsh",
+    };
+    size_t pos = 0;
+
+    // Override for tests and non-standard installs; must be absolute
+    const char* configured = getenv("PS_LAUNCHER_INTERPRETER");
+    if (configured && configured[0] == '/')
+        return AppendStr(out, outSize, configured, &pos);
+
+    for (size_t i = 0; i < sizeof(candidates) / sizeof(candidates[0]); i++)
+    {
+        if (access(candidates[i], X_OK) == 0)
+            return AppendStr(out, outSize, candidates[i], &pos);
+    }
+
+    // Report the preferred location so the "not found" path is logged
+    return AppendStr(out, outSize, candidates[0], &pos);
+}
+
+bool PlatGetExecutablePath(PSCHAR* out, size_t outSize)
+{
+    ssize_t len = readlink("/proc/self/exe", out, outSize);
+    if (len <= 0 || (size_t)len >= outSize)
+        return false;
+    out[len] = 0;
+    return true;
+}
+
+bool PlatGetCurrentDirectory(PSCHAR* out, size_t outSize)
+{
+    return getcwd(out, outSize) != NULL;
+}
+
+const PSCHAR* PlatGetEnvironment(void)
+{
+    // Join environ into one block, the same layout Windows uses
+    size_t total = 1;
+    for (char** e = environ; *e; e++)
+        total += strlen(*e) + 1;
+
+    char* block = malloc(total);
+    if (!block)
+        return NULL;
+    char* out = block;
+    for (char** e = environ; *e; e++)
+    {
+        size_t len = strlen(*e) + 1;
+        memcpy(out, *e, len);
+        out += len;
+    }
+    *out = 0;
+    return block;
+}
+
+void PlatFreeEnvironment(const PSCHAR* block)
+{
+    free((void*)block);
+}
+
+// Shared by PlatSpawn and PlatSpawnWithInput; actions may be NULL
+static bool Spawn(const PSCHAR* interpreter, PSCHAR* cmdline, const PSCHAR* envBlock,
+                  const posix_spawn_file_actions_t* actions, PlatProcess* proc)
+{
+    size_t len = PsStrLen(cmdline);
+    int maxArgs = (int)(len / 2 + 2);  // At most one argument per two characters
+    char* storage = malloc(len + 1);
+    char** argv = malloc(sizeof(char*) * (size_t)(maxArgs + 1));
+    char** envp = environ;
+    bool ok = false;
+
+    // Environment block -> envp array (pointers into the caller's block)
+    if (envBlock)
+    {
+        size_t count = 0;
+        for (const char* e = envBlock; *e; e += strlen(e) + 1)
+            count++;
+        envp = malloc(sizeof(char*) * (count + 1));
+        if (envp)
+        {
+            size_t i = 0;
+            for (const char* e = envBlock; *e; e += strlen(e) + 1)
+                envp[i++] = (char*)e;
+            envp[i] = NULL;
+        }
+    }
+
+    if (storage && argv && envp)
+    {
+        int argc = SplitCommandLine(cmdline, storage, argv, maxArgs);
+        if (argc > 0)
+        {
+            argv[argc] = NULL;
+            pid_t pid;
+            int rc = posix_spawn(&pid, interpreter, actions, NULL, argv, envp);
+            if (rc == 0)
+            {
+                proc->process = pid;
+                proc->thread = 0;
+                proc->pid = (uint32_t)pid;
+                ok = true;
+            }
+            else
+            {
+                errno = rc;
+            }
+        }
+        else
+        {
+            errno = E2BIG;
+        }
+    }
+    else
+    {
+        errno = ENOMEM;
+    }
+
+    free(storage);
+    free(argv);
+    if (envp != environ)
+        free(envp);
+    return ok;
+}
+
+bool PlatSpawn(const PSCHAR* interpreter, PSCHAR* cmdline, const PSCHAR* envBlock,
+               PlatProcess* proc)
+{
+    return Spawn(interpreter, cmdline, envBlock, NULL, proc);
+}
+
+bool PlatSpawnWithInput(const PSCHAR* interpreter, PSCHAR* cmdline, const PSCHAR* envBlock,
+                        const void* input, size_t inputSize, PlatProcess* proc)
+{
+    // Both ends close-on-exec: dup2 onto fd 0 gives the child the only copy
+    int fds[2];
+    if (pipe(fds) != 0)
+        return false;
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[0], 0);
+    bool ok = Spawn(interpreter, cmdline, envBlock, &actions, proc);
+    int err = errno;
+    posix_spawn_file_actions_destroy(&actions);
+    close(fds[0]);
+
+    if (ok)
+    {
+        // SIGPIPE: Ignored only while writing, so a child that exits early
+        // cannot kill the launcher. The child was spawned before this and
+        // keeps the default disposition.
+        struct sigaction ignore, previous;
+        memset(&ignore, 0, sizeof(ignore));
+        ignore.sa_handler = SIG_IGN;
+        sigemptyset(&ignore.sa_mask);
+        sigaction(SIGPIPE, &ignore, &previous);
+        PlatWriteFile(fds[1], input, inputSize);
+        sigaction(SIGPIPE, &previous, NULL);
+    }
+
+    close(fds[1]);
+    errno = err;
+    return ok;
+}
+
+bool PlatSpawnToFile(const PSCHAR* interpreter, PSCHAR* cmdline, const PSCHAR* envBlock,
+                     PlatFile output, PlatProcess* proc)
+{
+    // dup2 shares the open file description, and with it the offset
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, (int)output, 1);
+    bool ok = Spawn(interpreter, cmdline, envBlock, &actions, proc);
+    int err = errno;
+    posix_spawn_file_actions_destroy(&actions);
+    errno = err;
+    return ok;
+}
+
+bool PlatSpawnInDirectory(const PSCHAR* interpreter, PSCHAR* cmdline, const PSCHAR* envBlock,
+                          const PSCHAR* directory, PlatProcess* proc)
+{
+    if (!directory)
+        return Spawn(interpreter, cmdline, envBlock, NULL, proc);
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addchdir_np(&actions, directory);
+    bool ok = Spawn(interpreter, cmdline, envBlock, &actions, proc);
+    int err = errno;
+    posix_spawn_file_actions_destroy(&actions);
+    errno = err;
+    return ok;
+}
+
+bool PlatWait(PlatProcess* proc, uint32_t* exitCode)
+{
+    int status;
+    while (waitpid((pid_t)proc->process, &status, 0) < 0)
+    {
+        if (errno != EINTR)
+            return false;
+    }
+
+    // Signals map to 128+N, the shell convention
+    if (WIFEXITED(status))
+        *exitCode = (uint32_t)WEXITSTATUS(status);
+    else if (WIFSIGNALED(status))
+        *exitCode = 128u + (uint32_t)WTERMSIG(status);
+    else
+        *exitCode = 1;
+    proc->process = 0;
+    return true;
+}
+
+bool PlatPollProcess(PlatProcess* proc, uint32_t* exitCode)
+{
+    return PlatPollProcessUsage(proc, exitCode, NULL);
+}
+
+bool PlatPollProcessUsage(PlatProcess* proc, uint32_t* exitCode, PlatUsage* usage)
+{
+    int status;
+    pid_t pid;
+    struct rusage ru;
+    while ((pid = wait4((pid_t)proc->process, &status, WNOHANG, &ru)) < 0 && errno == EINTR)
+        ;
+    if (pid == 0)
+        return false;
+
+    if (pid < 0)
+        *exitCode = 1;
+    else if (WIFEXITED(status))
+        *exitCode = (uint32_t)WEXITSTATUS(status);
+    else if (WIFSIGNALED(status))
+        *exitCode = 128u + (uint32_t)WTERMSIG(status);
+    else
+        *exitCode = 1;
+    if (usage)
+    {
+        // ru_maxrss is in kilobytes on Linux
+        memset(usage, 0, sizeof(*usage));
+        if (pid > 0)
+        {
+            usage->userMicros = (uint64_t)ru.ru_utime.tv_sec * 1000000u + (uint64_t)ru.ru_utime.tv_usec;
+            usage->kernelMicros = (uint64_t)ru.ru_stime.tv_sec * 1000000u + (uint64_t)ru.ru_stime.tv_usec;
+            usage->peakMemoryBytes = (uint64_t)ru.ru_maxrss * 1024u;
+        }
+    }
+    proc->process = 0;
+    return true;
+}
+
+void PlatCloseProcess(PlatProcess* proc)
+{
+    // Nothing to release: the pid is reaped by PlatWait
+    proc->process = 0;
+}
+
+bool PlatKillProcess(PlatProcess* proc)
+{
+    return proc->process > 0 && kill((pid_t)proc->process, SIGKILL) == 0;
+}
+
+PlatChildState PlatWaitTimeout(PlatProcess* proc, uint32_t timeoutMillis, uint32_t* exitCode)
+{
+    // The pidfd wakes the wait as soon as the child exits
+    PlatWaitOutput(NULL, 0, proc, 1, timeoutMillis);
+    int status;
+    pid_t pid;
+    while ((pid = waitpid((pid_t)proc->process, &status, WNOHANG)) < 0 && errno == EINTR)
+        ;
+    if (pid == 0)
+        return PLAT_CHILD_RUNNING;
+    if (pid < 0)
+        return PLAT_CHILD_LOST;
+    if (WIFEXITED(status))
+        *exitCode = (uint32_t)WEXITSTATUS(status);
+    else if (WIFSIGNALED(status))
+        *exitCode = 128u + (uint32_t)WTERMSIG(status);
+    else
+        *exitCode = 1;
+    proc->process = 0;
+    return PLAT_CHILD_EXITED;
+}
+
+bool PlatProcessCpuMicros(const PlatProcess* proc, uint64_t* micros)
+{
+    char path[64], text[1024];
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int)proc->process);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    ssize_t n = read(fd, text, sizeof(text) - 1);
+    close(fd);
+    if (n <= 0)
+        return false;
+    text[n] = 0;
+
+    // The command name may hold spaces and parentheses: fields are counted
+    // from the last ')'. utime and stime are the 12th and 13th after it.
+    char* p = strrchr(text, ')');
+    if (!p)
+        return false;
+    for (int field = 0; field < 12; field++)
+    {
+        p = strchr(p + 1, ' ');
+        if (!p)
+            return false;
+    }
+    char* end;
+    unsigned long long user = strtoull(p + 1, &end, 10);
+    unsigned long long kernel = strtoull(end, NULL, 10);
+    long ticks = sysconf(_SC_CLK_TCK);
+    if (ticks <= 0)
+        return false;
+    *micros = (uint64_t)(user + kernel) * 1000000u / (uint64_t)ticks;
+    return true;
+}
+
+uint32_t PlatCurrentProcessId(void)
+{
+    return (uint32_t)getpid();
+}
+
+bool PlatProcessAlive(uint32_t pid)
+{
+    // EPERM: it exists but belongs to someone else
+    return pid != 0 && (kill((pid_t)pid, 0) == 0 || errno == EPERM);
+}
+
+//--------------------------------------------------------------------------
+// PROCESS TREES
+//--------------------------------------------------------------------------
+#define TREE_MAX_PROCESSES 32768      // Processes on the machine looked at
+#define TREE_PASSES        8
+
+// Our cgroup v2 directory, from the "0::<path>" line of /proc/self/cgroup,
+// where v2 is mounted alone or beside v1 (hybrid)
+static bool OwnCgroup(char* out, size_t outSize)
+{
+    char text[4096];
+    if (ReadProcFile("/proc/self/cgroup", text, sizeof(text)) <= 0)
+        return false;
+    char* line = strstr(text, "0::");
+    if (!line || (line != text && line[-1] != '\n'))
+        return false;
+    char* end = strchr(line, '\n');
+    if (end)
+        *end = 0;
+    static const char* const mounts[] = { "/sys/fs/cgroup", "/sys/fs/cgroup/unified" };
+    for (int i = 0; i < 2; i++)
+    {
+        char procs[PS_MAX_PATH];
+        if (snprintf(out, outSize, "%s%s", mounts[i], line + 3) < (int)outSize &&
+            snprintf(procs, sizeof(procs), "%s/cgroup.procs", out) < (int)sizeof(procs) &&
+            access(procs, W_OK) == 0)
+            return true;
+    }
+    return false;
+}
+
+static bool WriteAt(int dir, const char* name, const char* text)
+{
+    int fd = openat(dir, name, O_WRONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    bool ok = write(fd, text, strlen(text)) == (ssize_t)strlen(text);
+    close(fd);
+    return ok;
+}
+
+bool PlatTreeOpen(PlatTree* tree, const PlatProcess* proc)
+{
+    tree->handle = -1;
+    tree->pid = proc->pid;
+    if (proc->pid == 0)
+        return false;
+
+    // FREEZER: A leaf of our own cgroup, if we may make one and move into it
+    char dir[PS_MAX_PATH], pid[16];
+    if (!OwnCgroup(dir, sizeof(dir)))
+        return true;
+    size_t len = strlen(dir);
+    if (snprintf(dir + len, sizeof(dir) - len, "/ps-launcher-%u", proc->pid) >= (int)(sizeof(dir) - len) ||
+        mkdir(dir, 0700) != 0)
+        return true;
+    // cgroup.freeze came with Linux 5.2
+    int fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    snprintf(pid, sizeof(pid), "%u", proc->pid);
+    if (fd < 0 || faccessat(fd, "cgroup.freeze", W_OK, 0) != 0 || !WriteAt(fd, "cgroup.procs", pid))
+    {
+        if (fd >= 0)
+            close(fd);
+        rmdir(dir);
+        return true;
+    }
+    tree->handle = fd;
+    return true;
+}
+
+// Parent of every process, as (pid, ppid) pairs; count 0 if /proc is
+// unreadable
+static uint32_t ListParents(uint32_t* pairs, uint32_t max)
+{
+    DIR* proc = opendir("/proc");
+    if (!proc)
+        return 0;
+    uint32_t count = 0;
+    struct dirent* d;
+    while (count < max && (d = readdir(proc)) != NULL)
+    {
+        if (d->d_name[0] < '1' || d->d_name[0] > '9')
+            continue;
+        char path[300], text[512];
+        snprintf(path, sizeof(path), "/proc/%s/stat", d->d_name);
+        if (ReadProcFile(path, text, sizeof(text)) <= 0)
+            continue;
+        // "pid (comm) state ppid": comm may hold anything, so from the last ')'
+        char* p = strrchr(text, ')');
+        if (!p || p[1] != ' ' || !p[2] || p[3] != ' ')
+            continue;
+        pairs[2 * count] = (uint32_t)strtoul(d->d_name, NULL, 10);
+        pairs[2 * count + 1] = (uint32_t)strtoul(p + 4, NULL, 10);
+        count++;
+    }
+    closedir(proc);
+    return count;
+}
+
+// Signal the root and every descendant; returns how many were signalled
+static uint32_t SignalTree(uint32_t root, int sig, uint32_t* pairs, uint32_t* tree)
+{
+    uint32_t count = ListParents(pairs, TREE_MAX_PROCESSES);
+    uint32_t found = 1;
+    tree[0] = root;
+    kill((pid_t)root, sig);
+    // Breadth first: each process found is a parent to look for
+    for (uint32_t next = 0; next < found; next++)
+    {
+        for (uint32_t i = 0; i < count && found < TREE_MAX_PROCESSES; i++)
+        {
+            if (pairs[2 * i + 1] == tree[next])
+            {
+                tree[found++] = pairs[2 * i];
+                kill((pid_t)pairs[2 * i], sig);
+            }
+        }
+    }
+    return found;
+}
+
+bool PlatTreeSuspend(PlatTree* tree, bool suspend)
+{
+    if (tree->pid == 0)
+        return false;
+    if (tree->handle >= 0)
+        return WriteAt((int)tree->handle, "cgroup.freeze", suspend ? "1" : "0");
+
+    // SIGSTOP: A process may fork before it is stopped, so passes go on
+    // until one finds nothing new; stopped processes cannot add more
+    uint32_t* pairs = malloc(sizeof(uint32_t) * 3 * TREE_MAX_PROCESSES);
+    if (!pairs)
+        return false;
+    uint32_t last = 0;
+    for (int pass = 0; pass < (suspend ? TREE_PASSES : 1); pass++)
+    {
+        uint32_t found = SignalTree(tree->pid, suspend ? SIGSTOP : SIGCONT, pairs, pairs + 2 * TREE_MAX_PROCESSES);
+        if (found == last)
+            break;
+        last = found;
+    }
+    free(pairs);
+    return true;
+}
+
+void PlatTreeClose(PlatTree* tree)
+{
+    // The cgroup goes once its processes have; one still in use is left
+    if (tree->handle >= 0)
+    {
+        char dir[PS_MAX_PATH];
+        size_t len;
+        if (OwnCgroup(dir, sizeof(dir)) && (len = strlen(dir)) < sizeof(dir))
+        {
+            snprintf(dir + len, sizeof(dir) - len, "/ps-launcher-%u", tree->pid);
+            rmdir(dir);
+        }
+        close((int)tree->handle);
+    }
+    tree->handle = -1;
+    tree->pid = 0;
+}
+
+bool PlatSpawnCaptured(const PSCHAR* interpreter, PSCHAR* cmdline, const PSCHAR* envBlock,
+                       const PSCHAR* directory, PlatProcess* proc, PlatFile* output)
+{
+    // Both ends close-on-exec: the dup2 copies are the child's only ones
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0)
+        return false;
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, 0, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], 1);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], 2);
+    if (directory)
+        posix_spawn_file_actions_addchdir_np(&actions, directory);
+    bool ok = Spawn(interpreter, cmdline, envBlock, &actions, proc);
+    int err = errno;
+    posix_spawn_file_actions_destroy(&actions);
+    close(fds[1]);
+    if (!ok)
+    {
+        close(fds[0]);
+        errno = err;
+        return false;
+    }
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    *output = fds[0];
+    return true;
+}
+
+bool PlatReadAvailable(PlatFile pipe, void* data, size_t size, size_t* got)
+{
+    ssize_t n;
+    *got = 0;
+    while ((n = read((int)pipe, data, size)) < 0 && errno == EINTR)
+        ;
+    if (n < 0)
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    *got = (size_t)n;
+    return n > 0;
+}
+
+void PlatWaitOutput(const PlatFile* pipes, size_t pipeCount, const PlatProcess* procs, size_t procCount,
+                    uint32_t timeoutMillis)
+{
+    struct pollfd local[64];
+    size_t count = pipeCount + procCount;
+    struct pollfd* pfds = count <= 64 ? local : malloc(count * sizeof(struct pollfd));
+    int timeout = timeoutMillis == PLAT_WAIT_FOREVER ? -1 : (int)timeoutMillis;
+    if (!pfds)
+    {
+        PlatSleepMillis(PLAT_OUTPUT_POLL_MS);
+        return;
+    }
+    for (size_t i = 0; i < pipeCount; i++)
+    {
+        pfds[i].fd = (int)pipes[i];
+        pfds[i].events = POLLIN;
+        pfds[i].revents = 0;
+    }
+    // A pidfd becomes readable as the process exits; without pidfd_open
+    // (before Linux 5.3) the exit is only noticed by polling for it
+    size_t n = pipeCount;
+    for (size_t i = 0; i < procCount; i++)
+    {
+        int pidfd = -1;
+#ifdef SYS_pidfd_open
+        pidfd = (int)syscall(SYS_pidfd_open, (pid_t)procs[i].process, 0);
+#endif
+        if (pidfd < 0)
+        {
+            if (timeout < 0 || timeout > PLAT_OUTPUT_POLL_MS)
+                timeout = PLAT_OUTPUT_POLL_MS;
+            continue;
+        }
+        pfds[n].fd = pidfd;
+        pfds[n].events = POLLIN;
+        pfds[n].revents = 0;
+        n++;
+    }
+    poll(pfds, (nfds_t)n, timeout);
+    for (size_t i = pipeCount; i < n; i++)
+        close(pfds[i].fd);
+    if (pfds != local)
+        free(pfds);
+}
+
+//--------------------------------------------------------------------------
+// SHARED MEMORY
+//--------------------------------------------------------------------------
+bool PlatOpenShared(const PSCHAR* name, size_t size, bool create, PlatShared* shared)
+{
+    // Per user: another user's region of the same name is never opened
+    char objectName[256];
+    if (snprintf(objectName, sizeof(objectName), "/%s-%u", name, (unsigned)getuid()) >= (int)sizeof(objectName))
+        return false;
+    int fd = shm_open(objectName, O_RDWR | O_CLOEXEC | (create ? O_CREAT : 0), 0600);
+    if (fd < 0)
+        return false;
+
+    // GROW: The creator and anyone racing it all extend to the same size;
+    // the new pages read as zero whoever gets there first
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0 && st.st_uid == getuid() &&
+              ((size_t)st.st_size >= size || ftruncate(fd, (off_t)size) == 0);
+    void* base = ok ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (base == MAP_FAILED)
+        return false;
+    shared->base = base;
+    shared->size = size;
+    shared->handle = 0;
+    return true;
+}
+
+bool PlatMapSharedFile(const PSCHAR* path, size_t size, PlatShared* shared)
+{
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0 && ((size_t)st.st_size >= size || ftruncate(fd, (off_t)size) == 0);
+    void* base = ok ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (base == MAP_FAILED)
+        return false;
+    shared->base = base;
+    shared->size = size;
+    shared->handle = 0;
+    return true;
+}
+
+void PlatCloseShared(PlatShared* shared)
+{
+    if (shared->base)
+        munmap(shared->base, shared->size);
+    shared->base = NULL;
+}
+
+//--------------------------------------------------------------------------
+// DIRECTORY WATCH
+//--------------------------------------------------------------------------
+// The kernel queue holds fs.inotify.max_queued_events (16384 by default);
+// a large buffer drains it in few reads. Needs Linux (inotify).
+#define WATCH_BUFFER_SIZE (256 * 1024)
+#define WATCH_EVENTS      (IN_CLOSE_WRITE | IN_MOVED_TO)
+#define WATCH_GONE        (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT)
+
+// Without pidfd_open (before Linux 5.3) a running child is checked this often
+#define WATCH_CHILD_RECHECK_MS 100
+
+bool PlatWatchOpen(PlatWatch* watch, const PSCHAR* path)
+{
+    watch->buffer = NULL;
+    watch->pending = false;
+    watch->event = 0;
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+        return false;
+    if (inotify_add_watch(fd, path, WATCH_EVENTS | IN_ONLYDIR | IN_DELETE_SELF | IN_MOVE_SELF) < 0 ||
+        (watch->buffer = malloc(WATCH_BUFFER_SIZE)) == NULL)
+    {
+        close(fd);
+        return false;
+    }
+    watch->handle = fd;
+    return true;
+}
+
+PlatWatchWake PlatWatchWait(PlatWatch* watch, const PlatProcess* child, uint32_t timeoutMillis)
+{
+    struct pollfd fds[2];
+    nfds_t count = 1;
+    fds[0].fd = (int)watch->handle;
+    fds[0].events = POLLIN;
+    int pidfd = -1;
+    if (child)
+    {
+#ifdef SYS_pidfd_open
+        pidfd = (int)syscall(SYS_pidfd_open, (pid_t)child->process, 0);
+#endif
+        if (pidfd >= 0)
+        {
+            fds[1].fd = pidfd;
+            fds[1].events = POLLIN;
+            count = 2;
+        }
+        else if (timeoutMillis > WATCH_CHILD_RECHECK_MS)
+            timeoutMillis = WATCH_CHILD_RECHECK_MS;
+    }
+
+    int ready = poll(fds, count, timeoutMillis == PLAT_WAIT_FOREVER ? -1 : (int)timeoutMillis);
+    if (pidfd >= 0)
+        close(pidfd);
+    if (ready < 0)
+        return errno == EINTR ? PLAT_WAKE_TIMEOUT : PLAT_WAKE_ERROR;
+    if (ready == 0)
+        return child && pidfd < 0 ? PLAT_WAKE_CHILD : PLAT_WAKE_TIMEOUT;   // Caller polls it
+    if (count == 2 && fds[1].revents)
+        return PLAT_WAKE_CHILD;
+    return PLAT_WAKE_EVENTS;
+}
+
+bool PlatWatchRead(PlatWatch* watch, PlatWatchCallback fn, void* ctx, bool* overflow)
+{
+    *overflow = false;
+    char* buffer = (char*)watch->buffer;
+    for (;;)
+    {
+        ssize_t n = read((int)watch->handle, buffer, WATCH_BUFFER_SIZE);
+        if (n < 0)
+            return errno == EAGAIN || errno == EINTR;
+        if (n == 0)
+            return true;
+
+        for (ssize_t pos = 0; pos + (ssize_t)sizeof(struct inotify_event) <= n;)
+        {
+            const struct inotify_event* ev = (const struct inotify_event*)(buffer + pos);
+            pos += (ssize_t)sizeof(struct inotify_event) + ev->len;
+            if (ev->mask & IN_Q_OVERFLOW)
+                *overflow = true;
+            else if (ev->mask & WATCH_GONE)
+                return false;
+            else if ((ev->mask & WATCH_EVENTS) && !(ev->mask & IN_ISDIR) && ev->len > 0)
+                fn(ctx, ev->name, strlen(ev->name));
+        }
+    }
+}
+
+void PlatWatchClose(PlatWatch* watch)
+{
+    if (watch->buffer)
+    {
+        close((int)watch->handle);
+        free(watch->buffer);
+        watch->buffer = NULL;
+    }
+}
+
+//--------------------------------------------------------------------------
+// LOCAL IPC
+//--------------------------------------------------------------------------
+#define IPC_SOCKET_NAME    "/ps-launcher.sock"
+#define IPC_BACKLOG        128
+#define IPC_RECHECK_MS     1000      // Listener: how often the socket file is checked
+
+typedef struct ListenState
+{
+    struct stat bound;               // Identity of the socket file we created
+    char path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+} ListenState;
+
+static bool SocketAddress(const PSCHAR* endpoint, struct sockaddr_un* addr)
+{
+    size_t len = strlen(endpoint);
+    if (len >= sizeof(addr->sun_path))
+        return false;
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    memcpy(addr->sun_path, endpoint, len + 1);
+    return true;
+}
+
+bool PlatIpcDefaultEndpoint(PSCHAR* out, size_t outSize)
+{
+    size_t pos;
+    if (!PlatGetStateDirectory(out, outSize))
+        return false;
+    pos = strlen(out);
+    return AppendStr(out, outSize, IPC_SOCKET_NAME, &pos);
+}
+
+bool PlatIpcListen(PlatIpc* server, const PSCHAR* endpoint)
+{
+    struct sockaddr_un addr;
+    if (!SocketAddress(endpoint, &addr))
+    {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+
+    // STALE SOCKET: A file nobody answers on is left over from a crash
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe < 0)
+        return false;
+    bool live = connect(probe, (struct sockaddr*)&addr, sizeof(addr)) == 0;
+    close(probe);
+    if (live)
+    {
+        errno = EADDRINUSE;
+        return false;
+    }
+    unlink(endpoint);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    ListenState* st = malloc(sizeof(ListenState));
+    if (fd < 0 || !st)
+    {
+        if (fd >= 0)
+            close(fd);
+        free(st);
+        return false;
+    }
+
+    // SECURITY CHECK: Only this user may connect (mode set before anyone can)
+    mode_t mask = umask(0177);
+    bool ok = bind(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0;
+    umask(mask);
+    if (!ok || listen(fd, IPC_BACKLOG) != 0 || stat(endpoint, &st->bound) != 0)
+    {
+        int err = errno;
+        close(fd);
+        free(st);
+        errno = err;
+        return false;
+    }
+    memcpy(st->path, addr.sun_path, sizeof(st->path));
+    server->handle = fd;
+    server->state = st;
+    return true;
+}
+
+// Still our socket file: not deleted, not replaced by another server's
+static bool StillBound(const ListenState* st)
+{
+    struct stat now;
+    return stat(st->path, &now) == 0 && now.st_ino == st->bound.st_ino && now.st_dev == st->bound.st_dev;
+}
+
+PlatIpcStatus PlatIpcAccept(PlatIpc* server, PlatIpc* conn)
+{
+    const ListenState* st = (const ListenState*)server->state;
+    for (;;)
+    {
+        struct pollfd pfd = { (int)server->handle, POLLIN, 0 };
+        int ready = poll(&pfd, 1, IPC_RECHECK_MS);
+        if (ready < 0 && errno != EINTR)
+            return PLAT_IPC_CLOSED;
+        if (!StillBound(st))
+            return PLAT_IPC_CLOSED;
+        if (ready <= 0)
+            continue;
+
+        int fd = accept4((int)server->handle, NULL, NULL, SOCK_CLOEXEC);
+        if (fd >= 0)
+        {
+            conn->handle = fd;
+            conn->state = NULL;
+            return PLAT_IPC_OK;
+        }
+        if (errno != EINTR && errno != EAGAIN && errno != ECONNABORTED)
+            return PLAT_IPC_CLOSED;
+    }
+}
+
+bool PlatIpcConnect(PlatIpc* conn, const PSCHAR* endpoint)
+{
+    struct sockaddr_un addr;
+    if (!SocketAddress(endpoint, &addr))
+    {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return false;
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0)
+    {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return false;
+    }
+    conn->handle = fd;
+    conn->state = NULL;
+    return true;
+}
+
+PlatIpcStatus PlatIpcRead(PlatIpc* conn, void* buffer, size_t size, uint32_t timeoutMillis, size_t* got)
+{
+    *got = 0;
+    struct pollfd pfd = { (int)conn->handle, POLLIN, 0 };
+    int ready = poll(&pfd, 1, timeoutMillis == PLAT_WAIT_FOREVER ? -1 : (int)timeoutMillis);
+    if (ready == 0 || (ready < 0 && errno == EINTR))
+        return PLAT_IPC_TIMEOUT;
+    if (ready < 0)
+        return PLAT_IPC_CLOSED;
+
+    ssize_t n;
+    do
+        n = recv((int)conn->handle, buffer, size, 0);
+    while (n < 0 && errno == EINTR);
+    if (n <= 0)
+        return PLAT_IPC_CLOSED;
+    *got = (size_t)n;
+    return PLAT_IPC_OK;
+}
+
+bool PlatIpcWrite(PlatIpc* conn, const void* data, size_t size)
+{
+    // MSG_NOSIGNAL: A vanished peer is an error, not SIGPIPE
+    const char* p = (const char*)data;
+    while (size > 0)
+    {
+        ssize_t n = send((int)conn->handle, p, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+void PlatIpcClose(PlatIpc* conn)
+{
+    if (conn->handle >= 0)
+        close((int)conn->handle);
+    if (conn->state)
+    {
+        // A listener removes its socket file, unless it is not ours any more
+        ListenState* st = (ListenState*)conn->state;
+        if (StillBound(st))
+            unlink(st->path);
+        free(st);
+    }
+    conn->handle = -1;
+    conn->state = NULL;
+}
+
+//--------------------------------------------------------------------------
+// ERRORS AND TIME
+//--------------------------------------------------------------------------
+uint32_t PlatLastError(void)
+{
+    return (uint32_t)errno;
+}
+
+void PlatFormatError(uint32_t err, PSCHAR* out, size_t outSize)
+{
+    size_t pos = 0;
+    out[0] = 0;
+    AppendStr(out, outSize, strerror((int)err), &pos);
+}
+
+uint64_t PlatMonotonicNanos(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t PlatFileTimeNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t PlatWallClockMillis(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000ull + (uint64_t)ts.tv_nsec / 1000000ull;
+}
+
+int32_t PlatLocalOffsetMinutes(uint64_t unixMillis)
+{
+    time_t t = (time_t)(unixMillis / 1000);
+    struct tm local;
+    if (!localtime_r(&t, &local))
+        return 0;
+    return (int32_t)(local.tm_gmtoff / 60);
+}
+
+void PlatSleepMillis(uint32_t millis)
+{
+    struct timespec ts = { (time_t)(millis / 1000), (long)(millis % 1000) * 1000000L };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+        ;
+}
@@ -0,0 +1,1298 @@
+//--------------------------------------------------------------------------
+// WIN32 BACKEND - Platform interface on kernel32/user32/shell32
+//--------------------------------------------------------------------------
+// Built with /NODEFAULTLIB: only Windows API calls, no CRT functions.
+
+#define WIN32_LEAN_AND_MEAN  // PREPROCESSOR: Reduces Windows header size
+#include <windows.h>         // HEADERS: Core Windows API types and functions
+#include <shlobj.h>          // HEADERS: Shell folder API for AppData path
+#include <psapi.h>           // HEADERS: K32GetProcessMemoryInfo (kernel32)
+#include <tlhelp32.h>        // HEADERS: Thread snapshots for suspending job trees
+
+#include "platform.h"
+#include "psstr.h"
+
+//--------------------------------------------------------------------------
+// VIRTUAL MEMORY
+//--------------------------------------------------------------------------
+void* PlatReserve(size_t size)
+{
+    return VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+bool PlatCommit(void* address, size_t size)
+{
+    return VirtualAlloc(address, size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+}
+
+void PlatRelease(void* address, size_t size)
+{
+    UNREFERENCED_PARAMETER(size);
+    VirtualFree(address, 0, MEM_RELEASE);   // Whole reservation in one call
+}
+
+//--------------------------------------------------------------------------
+// FILES
+//--------------------------------------------------------------------------
+bool PlatFileExists(const PSCHAR* path)
+{
+    // WINDOWS API: Returns INVALID_FILE_ATTRIBUTES if not found
+    return GetFileAttributesW(path) != INVALID_FILE_ATTRIBUTES;
+}
+
+PlatFile PlatCreateFile(const PSCHAR* path, PlatFileMode mode)
+{
+    // FILE_APPEND_DATA without FILE_WRITE_DATA makes every write an atomic
+    // append, so concurrent launchers never interleave inside a record
+    DWORD access = (mode == PLAT_FILE_APPEND) ? FILE_APPEND_DATA : GENERIC_WRITE;
+    DWORD disposition = (mode == PLAT_FILE_APPEND) ? OPEN_ALWAYS
+                      : (mode == PLAT_FILE_CREATE_NEW) ? CREATE_NEW : CREATE_ALWAYS;
+    HANDLE h = CreateFileW(path, access, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                           disposition, FILE_ATTRIBUTE_NORMAL, NULL);
+    return (h == INVALID_HANDLE_VALUE) ? PLAT_INVALID_FILE : (PlatFile)h;
+}
+
+bool PlatWriteFile(PlatFile file, const void* data, size_t size)
+{
+    DWORD written;
+    return WriteFile((HANDLE)file, data, (DWORD)size, &written, NULL) && written == size;
+}
+
+void PlatCloseFile(PlatFile file)
+{
+    if (file != PLAT_INVALID_FILE)
+        CloseHandle((HANDLE)file);
+}
+
+PlatFile PlatOpenFile(const PSCHAR* path)
+{
+    HANDLE h = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                           OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    return (h == INVALID_HANDLE_VALUE) ? PLAT_INVALID_FILE : (PlatFile)h;
+}
+
+bool PlatFileSize(PlatFile file, uint64_t* size)
+{
+    LARGE_INTEGER li;
+    if (!GetFileSizeEx((HANDLE)file, &li))
+        return false;
+    *size = (uint64_t)li.QuadPart;
+    return true;
+}
+
+bool PlatReadFile(PlatFile file, void* data, size_t size)
+{
+    BYTE* p = (BYTE*)data;
+    while (size > 0)
+    {
+        DWORD chunk = size > 0x40000000 ? 0x40000000 : (DWORD)size;
+        DWORD read = 0;
+        if (!ReadFile((HANDLE)file, p, chunk, &read, NULL) || read == 0)
+            return false;
+        p += read;
+        size -= read;
+    }
+    return true;
+}
+
+bool PlatGetFileInfo(const PSCHAR* path, PlatFileInfo* info)
+{
+    // FILE_FLAG_BACKUP_SEMANTICS: Required to open directories as well
+    HANDLE h = CreateFileW(path, FILE_READ_ATTRIBUTES,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                           OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+    if (h == INVALID_HANDLE_VALUE)
+        return false;
+
+    BY_HANDLE_FILE_INFORMATION fi;
+    BOOL ok = GetFileInformationByHandle(h, &fi);
+    CloseHandle(h);
+    if (!ok)
+        return false;
+
+    info->volume = fi.dwVolumeSerialNumber;
+    info->fileId = ((uint64_t)fi.nFileIndexHigh << 32) | fi.nFileIndexLow;
+    info->size = ((uint64_t)fi.nFileSizeHigh << 32) | fi.nFileSizeLow;
+    info->mtime = ((uint64_t)fi.ftLastWriteTime.dwHighDateTime << 32) | fi.ftLastWriteTime.dwLowDateTime;
+    return true;
+}
+
+bool PlatRenameFile(const PSCHAR* from, const PSCHAR* to)
+{
+    return MoveFileExW(from, to, MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
+bool PlatDeleteFile(const PSCHAR* path)
+{
+    return DeleteFileW(path) != 0;
+}
+
+bool PlatTouchFile(const PSCHAR* path)
+{
+    HANDLE h = CreateFileW(path, FILE_WRITE_ATTRIBUTES,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (h == INVALID_HANDLE_VALUE)
+        return false;
+    FILETIME now;
+    GetSystemTimeAsFileTime(&now);
+    BOOL ok = SetFileTime(h, NULL, NULL, &now);
+    CloseHandle(h);
+    return ok != 0;
+}
+
+PlatFile PlatStandardOutput(void)
+{
+    // A GUI-subsystem launcher has no stdout unless its parent passed one
+    HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE);
+    return (h == NULL || h == INVALID_HANDLE_VALUE) ? PLAT_INVALID_FILE : (PlatFile)h;
+}
+
+const void* PlatMapFile(const PSCHAR* path, size_t* size)
+{
+    // FILE_SHARE_DELETE: A writer may rename a new file over this one
+    HANDLE file = CreateFileW(path, GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    LARGE_INTEGER li;
+    HANDLE mapping = NULL;
+    if (GetFileSizeEx(file, &li) && li.QuadPart > 0)
+        mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+
+    // The view keeps the mapping alive on its own
+    if (mapping)
+        CloseHandle(mapping);
+    CloseHandle(file);
+    if (view)
+        *size = (size_t)li.QuadPart;
+    return view;
+}
+
+void PlatUnmapFile(const void* view, size_t size)
+{
+    UNREFERENCED_PARAMETER(size);
+    if (view)
+        UnmapViewOfFile(view);
+}
+
+bool PlatCreateDirectory(const PSCHAR* path)
+{
+    return CreateDirectoryW(path, NULL) || GetLastError() == ERROR_ALREADY_EXISTS;
+}
+
+bool PlatGetEnv(const PSCHAR* name, PSCHAR* out, size_t outSize)
+{
+    DWORD len = GetEnvironmentVariableW(name, out, (DWORD)outSize);
+    return len > 0 && len < outSize;
+}
+
+bool PlatGetStateDirectory(PSCHAR* out, size_t outSize)
+{
+    WCHAR appDataPath[MAX_PATH];
+
+    // Get user's AppData\Local directory
+    if (SHGetFolderPathW(NULL, CSIDL_LOCAL_APPDATA, NULL, 0, appDataPath) != S_OK)
+        return false;
+
+    size_t pos = 0;
+    if (!AppendStr(out, outSize, appDataPath, &pos) ||
+        !AppendStr(out, outSize, L"\\ps-launcher", &pos))
+        return false;
+
+    // Create directory if it doesn't exist
+    CreateDirectoryW(out, NULL);
+    return true;
+}
+
+//--------------------------------------------------------------------------
+// DIRECTORIES
+//--------------------------------------------------------------------------
+bool PlatListDirectory(const PSCHAR* path, PlatDirCallback fn, void* ctx)
+{
+    WCHAR pattern[PS_MAX_PATH + 2];
+    size_t pos = 0;
+    if (!AppendStr(pattern, PS_MAX_PATH + 2, path, &pos) ||
+        !AppendStr(pattern, PS_MAX_PATH + 2, L"\\*", &pos))
+        return false;
+
+    // FindExInfoBasic skips the short name; LARGE_FETCH cuts round trips
+    // on network shares
+    WIN32_FIND_DATAW fd;
+    HANDLE find = FindFirstFileExW(pattern, FindExInfoBasic, &fd, FindExSearchNameMatch,
+                                   NULL, FIND_FIRST_EX_LARGE_FETCH);
+    if (find == INVALID_HANDLE_VALUE)
+        return false;
+
+    bool ok = true;
+    do
+    {
+        const WCHAR* name = fd.cFileName;
+        if (name[0] == L'.' && (name[1] == 0 || (name[1] == L'.' && name[2] == 0)))
+            continue;
+        PlatEntryType type = (fd.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) ? PLAT_ENTRY_LINK
+                           : (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ? PLAT_ENTRY_DIRECTORY
+                           : PLAT_ENTRY_FILE;
+        ok = fn(ctx, name, PsStrLen(name), type);
+    } while (ok && FindNextFileW(find, &fd));
+
+    FindClose(find);
+    return ok;
+}
+
+//--------------------------------------------------------------------------
+// THREADS
+//--------------------------------------------------------------------------
+static DWORD WINAPI ThreadMain(LPVOID p)
+{
+    PlatThread* thread = (PlatThread*)p;
+    thread->fn(thread->arg);
+    return 0;
+}
+
+bool PlatStartThread(PlatThread* thread, PlatThreadFn fn, void* arg)
+{
+    thread->fn = fn;
+    thread->arg = arg;
+    HANDLE h = CreateThread(NULL, 0, ThreadMain, thread, 0, NULL);
+    thread->handle = (intptr_t)h;
+    return h != NULL;
+}
+
+void PlatJoinThread(PlatThread* thread)
+{
+    WaitForSingleObject((HANDLE)thread->handle, INFINITE);
+    CloseHandle((HANDLE)thread->handle);
+    thread->handle = 0;
+}
+
+uint32_t PlatProcessorCount(void)
+{
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwNumberOfProcessors ? si.dwNumberOfProcessors : 1;
+}
+
+bool PlatSystemLoad(PlatLoad* load)
+{
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    load->runnable = 0;
+    if (!GlobalMemoryStatusEx(&status))
+    {
+        load->availableBytes = 0;
+        load->totalBytes = 0;
+        return false;
+    }
+    load->availableBytes = status.ullAvailPhys;
+    load->totalBytes = status.ullTotalPhys;
+    return true;
+}
+
+static uint64_t FileTimeTicks(const FILETIME* t)
+{
+    return ((uint64_t)t->dwHighDateTime << 32) | t->dwLowDateTime;
+}
+
+bool PlatSystemPressure(PlatPressure* pressure)
+{
+    // Kernel time includes idle time; the first call covers since boot
+    static uint64_t lastIdle, lastTotal;
+    FILETIME idle, kernel, user;
+    pressure->cpu = 0;
+    pressure->io = 0;
+    if (!GetSystemTimes(&idle, &kernel, &user))
+        return false;
+    uint64_t idleTicks = FileTimeTicks(&idle);
+    uint64_t total = FileTimeTicks(&kernel) + FileTimeTicks(&user);
+    uint64_t spent = total - lastTotal, rested = idleTicks - lastIdle;
+    if (spent > 0 && rested <= spent)
+        pressure->cpu = (uint32_t)((spent - rested) * 10000 / spent);
+    lastIdle = idleTicks;
+    lastTotal = total;
+    return true;
+}
+
+//--------------------------------------------------------------------------
+// EMBEDDED PAYLOAD
+//--------------------------------------------------------------------------
+// RCDATA resource, language neutral so FindResourceW matches it for every
+// user locale. Resources are mapped with the image: no file I/O at all.
+#define PAYLOAD_RESOURCE_NAME L"PSPAYLOAD"
+#define PAYLOAD_RESOURCE_TYPE MAKEINTRESOURCEW(10)   // RT_RCDATA
+#define PAYLOAD_RESOURCE_LANG MAKELANGID(LANG_NEUTRAL, SUBLANG_NEUTRAL)
+
+const void* PlatFindPayload(size_t* size)
+{
+    *size = 0;
+    HRSRC res = FindResourceW(NULL, PAYLOAD_RESOURCE_NAME, PAYLOAD_RESOURCE_TYPE);
+    HGLOBAL loaded = res ? LoadResource(NULL, res) : NULL;
+    const void* data = loaded ? LockResource(loaded) : NULL;
+    if (data)
+        *size = SizeofResource(NULL, res);
+    return data;
+}
+
+bool PlatCopySelf(const PSCHAR* outPath)
+{
+    WCHAR self[MAX_PATH];
+    DWORD len = GetModuleFileNameW(NULL, self, MAX_PATH);
+    if (len == 0 || len >= MAX_PATH)
+        return false;
+    return CopyFileW(self, outPath, FALSE) != 0;
+}
+
+bool PlatEmbedPayload(const PSCHAR* exePath, const void* data, size_t size)
+{
+    // Same name and language replaces the payload of a packed copy
+    HANDLE update = BeginUpdateResourceW(exePath, FALSE);
+    if (!update)
+        return false;
+    BOOL ok = UpdateResourceW(update, PAYLOAD_RESOURCE_TYPE, PAYLOAD_RESOURCE_NAME,
+                              PAYLOAD_RESOURCE_LANG, (LPVOID)data, (DWORD)size);
+    return EndUpdateResourceW(update, !ok) && ok;
+}
+
+//--------------------------------------------------------------------------
+// TEXT
+//--------------------------------------------------------------------------
+size_t PlatToUtf8(const PSCHAR* src, size_t srcLen, char* out, size_t outSize)
+{
+    if (srcLen == 0)
+        return 0;
+    int len = WideCharToMultiByte(CP_UTF8, 0, src, (int)srcLen, out, (int)outSize, NULL, NULL);
+    return len > 0 ? (size_t)len : 0;
+}
+
+void PlatShowMessage(const PSCHAR* text, const PSCHAR* title, PlatMessageKind kind)
+{
+    UINT icon = (kind == PLAT_MESSAGE_ERROR) ? MB_ICONERROR : MB_ICONINFORMATION;
+    MessageBoxW(NULL, text, title, MB_OK | icon);
+}
+
+//--------------------------------------------------------------------------
+// PROCESSES
+//--------------------------------------------------------------------------
+bool PlatGetInterpreterPath(PSCHAR* out, size_t outSize)
+{
+    // WINDOWS API: Get system directory for security (no PATH hijacking)
+    UINT len = GetSystemDirectoryW(out, (UINT)outSize);
+
+    // BOUNDARY CHECKING: Validate return values
+    if (len == 0 || len > outSize - 1)
+        return false;
+
+    size_t pos = len;
+    if (out[len - 1] != L'\\' && !AppendChar(out, outSize, L'\\', &pos))
+        return false;
+
+    return AppendStr(out, outSize, L"WindowsPowerShell\\v1.0\\powershell.exe", &pos);
+}
+
+bool PlatGetExecutablePath(PSCHAR* out, size_t outSize)
+{
+    DWORD len = GetModuleFileNameW(NULL, out, (DWORD)outSize);
+    return len > 0 && len < outSize;
+}
+
+bool PlatGetCurrentDirectory(PSCHAR* out, size_t outSize)
+{
+    DWORD len = GetCurrentDirectoryW((DWORD)outSize, out);
+    return len > 0 && len < outSize;
+}
+
+const PSCHAR* PlatGetEnvironment(void)
+{
+    return GetEnvironmentStringsW();
+}
+
+void PlatFreeEnvironment(const PSCHAR* block)
+{
+    if (block)
+        FreeEnvironmentStringsW((LPWCH)block);
+}
+
+bool PlatSpawn(const PSCHAR* interpreter, PSCHAR* cmdline, const PSCHAR* envBlock,
+               PlatProcess* proc)
+{
+    // STRUCTURE INITIALIZATION: Stack-allocated Windows API structures
+    STARTUPINFOW si;
+    ZeroMemory(&si, sizeof(si));
+    si.cb = sizeof(si);
+
+    PROCESS_INFORMATION pi;
+    ZeroMemory(&pi, sizeof(pi));
+
+    // CREATE_NO_WINDOW: The whole point of the launcher - no console flash
+    // CREATE_UNICODE_ENVIRONMENT: Our blocks are always UTF-16
+    if (!CreateProcessW(interpreter, cmdline, NULL, NULL, FALSE,
+                        CREATE_NO_WINDOW | CREATE_UNICODE_ENVIRONMENT,
+                        (LPVOID)envBlock, NULL, &si, &pi))
+        return false;
+
+    proc->process = (intptr_t)pi.hProcess;
+    proc->thread = (intptr_t)pi.hThread;
+    proc->pid = pi.dwProcessId;
+    return true;
+}
+
+bool PlatSpawnWithInput(const PSCHAR* interpreter, PSCHAR* cmdline, const PSCHAR* envBlock,
+                        const void* input, size_t inputSize, PlatProcess* proc)
+{
+    // PIPE: Only the read end is inheritable; the write end stays with us
+    SECURITY_ATTRIBUTES sa = { sizeof(sa), NULL, TRUE };
+    HANDLE readEnd, writeEnd;
+    if (!CreatePipe(&readEnd, &writeEnd, &sa, 0))
+        return false;
+    SetHandleInformation(writeEnd, HANDLE_FLAG_INHERIT, 0);
+
+    STARTUPINFOW si;
+    ZeroMemory(&si, sizeof(si));
+    si.cb = sizeof(si);
+    si.dwFlags = STARTF_USESTDHANDLES;
+    si.hStdInput = readEnd;
+    si.hStdOutput = GetStdHandle(STD_OUTPUT_HANDLE);
+    si.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+
+    PROCESS_INFORMATION pi;
+    ZeroMemory(&pi, sizeof(pi));
+
+    // bInheritHandles TRUE is required for the pipe; every handle the
+    // launcher opens itself is non-inheritable, so nothing else leaks
+    BOOL ok = CreateProcessW(interpreter, cmdline, NULL, NULL, TRUE,
+                             CREATE_NO_WINDOW | CREATE_UNICODE_ENVIRONMENT,
+                             (LPVOID)envBlock, NULL, &si, &pi);
+    DWORD err = GetLastError();
+    CloseHandle(readEnd);
+
+    if (ok)
+    {
+        proc->process = (intptr_t)pi.hProcess;
+        proc->thread = (intptr_t)pi.hThread;
+        proc->pid = pi.dwProcessId;
+
+        const BYTE* p = (const BYTE*)input;
+        DWORD written;
+        while (inputSize > 0 &&
+               WriteFile(writeEnd, p, inputSize > 65536 ? 65536 : (DWORD)inputSize, &written, NULL))
+        {
+            p += written;
+            inputSize -= written;
+        }
+    }
+
+    CloseHandle(writeEnd);
+    SetLastError(err);
+    return ok != 0;
+}
+
+bool PlatSpawnToFile(const PSCHAR* interpreter, PSCHAR* cmdline, const PSCHAR* envBlock,
+                     PlatFile output, PlatProcess* proc)
+{
+    // INHERITANCE: Only for the duration of CreateProcessW; the child's
+    // copy refers to the same file object, so it shares the position
+    HANDLE file = (HANDLE)output;
+    if (!SetHandleInformation(file, HANDLE_FLAG_INHERIT, HANDLE_FLAG_INHERIT))
+        return false;
+
+    STARTUPINFOW si;
+    ZeroMemory(&si, sizeof(si));
+    si.cb = sizeof(si);
+    si.dwFlags = STARTF_USESTDHANDLES;
+    si.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+    si.hStdOutput = file;
+    si.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+
+    PROCESS_INFORMATION pi;
+    ZeroMemory(&pi, sizeof(pi));
+    BOOL ok = CreateProcessW(interpreter, cmdline, NULL, NULL, TRUE,
+                             CREATE_NO_WINDOW | CREATE_UNICODE_ENVIRONMENT,
+                             (LPVOID)envBlock, NULL, &si, &pi);
+    DWORD err = GetLastError();
+    SetHandleInformation(file, HANDLE_FLAG_INHERIT, 0);
+
+    if (ok)
+    {
+        proc->process = (intptr_t)pi.hProcess;
+        proc->thread = (intptr_t)pi.hThread;
+        proc->pid = pi.dwProcessId;
+    }
+    SetLastError(err);
+    return ok != 0;
+}
+
+bool PlatSpawnInDirectory(const PSCHAR* interpreter, PSCHAR* cmdline, const PSCHAR* envBlock,
+                          const PSCHAR* directory, PlatProcess* proc)
+{
+    STARTUPINFOW si;
+    ZeroMemory(&si, sizeof(si));
+    si.cb = sizeof(si);
+
+    PROCESS_INFORMATION pi;
+    ZeroMemory(&pi, sizeof(pi));
+    if (!CreateProcessW(interpreter, cmdline, NULL, NULL, FALSE,
+                        CREATE_NO_WINDOW | CREATE_UNICODE_ENVIRONMENT,
+                        (LPVOID)envBlock, directory, &si, &pi))
+        return false;
+
+    proc->process = (intptr_t)pi.hProcess;
+    proc->thread = (intptr_t)pi.hThread;
+    proc->pid = pi.dwProcessId;
+    return true;
+}
+
+bool PlatWait(PlatProcess* proc, uint32_t* exitCode)
+{
+    DWORD code = 0;
+    if (WaitForSingleObject((HANDLE)proc->process, INFINITE) != WAIT_OBJECT_0)
+        return false;
+    if (!GetExitCodeProcess((HANDLE)proc->process, &code))
+        return false;
+    *exitCode = code;
+    return true;
+}
+
+bool PlatPollProcess(PlatProcess* proc, uint32_t* exitCode)
+{
+    DWORD code = 1;
+    DWORD state = WaitForSingleObject((HANDLE)proc->process, 0);
+    if (state == WAIT_TIMEOUT)
+        return false;
+    if (state != WAIT_OBJECT_0 || !GetExitCodeProcess((HANDLE)proc->process, &code))
+        code = 1;
+    *exitCode = code;
+    return true;
+}
+
+// FILETIME counts 100 ns units
+static uint64_t FileTimeMicros(const FILETIME* ft)
+{
+    return (((uint64_t)ft->dwHighDateTime << 32) | ft->dwLowDateTime) / 10;
+}
+
+bool PlatPollProcessUsage(PlatProcess* proc, uint32_t* exitCode, PlatUsage* usage)
+{
+    if (!PlatPollProcess(proc, exitCode))
+        return false;
+    ZeroMemory(usage, sizeof(*usage));
+    FILETIME created, exited, kernel, user;
+    if (GetProcessTimes((HANDLE)proc->process, &created, &exited, &kernel, &user))
+    {
+        usage->userMicros = FileTimeMicros(&user);
+        usage->kernelMicros = FileTimeMicros(&kernel);
+    }
+    PROCESS_MEMORY_COUNTERS counters;
+    if (K32GetProcessMemoryInfo((HANDLE)proc->process, &counters, sizeof(counters)))
+        usage->peakMemoryBytes = counters.PeakWorkingSetSize;
+    return true;
+}
+
+bool PlatKillProcess(PlatProcess* proc)
+{
+    return proc->process && TerminateProcess((HANDLE)proc->process, 1);
+}
+
+PlatChildState PlatWaitTimeout(PlatProcess* proc, uint32_t timeoutMillis, uint32_t* exitCode)
+{
+    DWORD code = 0;
+    DWORD state = WaitForSingleObject((HANDLE)proc->process, timeoutMillis);
+    if (state == WAIT_TIMEOUT)
+        return PLAT_CHILD_RUNNING;
+    if (state != WAIT_OBJECT_0 || !GetExitCodeProcess((HANDLE)proc->process, &code))
+        return PLAT_CHILD_LOST;
+    *exitCode = code;
+    return PLAT_CHILD_EXITED;
+}
+
+bool PlatProcessCpuMicros(const PlatProcess* proc, uint64_t* micros)
+{
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes((HANDLE)proc->process, &created, &exited, &kernel, &user))
+        return false;
+    *micros = FileTimeMicros(&user) + FileTimeMicros(&kernel);
+    return true;
+}
+
+uint32_t PlatCurrentProcessId(void)
+{
+    return GetCurrentProcessId();
+}
+
+bool PlatProcessAlive(uint32_t pid)
+{
+    // ACCESS DENIED: it exists but belongs to someone else
+    HANDLE h = OpenProcess(SYNCHRONIZE, FALSE, pid);
+    if (!h)
+        return GetLastError() == ERROR_ACCESS_DENIED;
+    bool alive = WaitForSingleObject(h, 0) == WAIT_TIMEOUT;
+    CloseHandle(h);
+    return alive;
+}
+
+//--------------------------------------------------------------------------
+// PROCESS TREES
+//--------------------------------------------------------------------------
+#define TREE_MAX_PROCESSES 1024
+
+typedef struct TreeProcessList
+{
+    JOBOBJECT_BASIC_PROCESS_ID_LIST list;
+    ULONG_PTR more[TREE_MAX_PROCESSES - 1];
+} TreeProcessList;
+
+bool PlatTreeOpen(PlatTree* tree, const PlatProcess* proc)
+{
+    tree->handle = -1;
+    tree->pid = proc->pid;
+    HANDLE job = CreateJobObjectW(NULL, NULL);
+    if (!job)
+        return false;
+    if (!AssignProcessToJobObject(job, (HANDLE)proc->process))
+    {
+        CloseHandle(job);
+        return false;
+    }
+    tree->handle = (intptr_t)job;
+    return true;
+}
+
+bool PlatTreeSuspend(PlatTree* tree, bool suspend)
+{
+    // WINDOWS API: Jobs cannot be suspended as such, so every thread of
+    // every process in the job is, from one snapshot of the system's threads
+    if (tree->handle == -1)
+        return false;
+    TreeProcessList ids;
+    if (!QueryInformationJobObject((HANDLE)tree->handle, JobObjectBasicProcessIdList, &ids, sizeof(ids), NULL))
+        return false;
+    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (snapshot == INVALID_HANDLE_VALUE)
+        return false;
+    THREADENTRY32 entry;
+    entry.dwSize = sizeof(entry);
+    for (BOOL more = Thread32First(snapshot, &entry); more; more = Thread32Next(snapshot, &entry))
+    {
+        DWORD i = 0;
+        while (i < ids.list.NumberOfProcessIdsInList && ids.list.ProcessIdList[i] != entry.th32OwnerProcessID)
+            i++;
+        if (i == ids.list.NumberOfProcessIdsInList)
+            continue;
+        HANDLE thread = OpenThread(THREAD_SUSPEND_RESUME, FALSE, entry.th32ThreadID);
+        if (!thread)
+            continue;
+        if (suspend)
+            SuspendThread(thread);
+        else
+            ResumeThread(thread);
+        CloseHandle(thread);
+    }
+    CloseHandle(snapshot);
+    return true;
+}
+
+void PlatTreeClose(PlatTree* tree)
+{
+    // No kill-on-close limit: the processes outlive the handle
+    if (tree->handle != -1)
+        CloseHandle((HANDLE)tree->handle);
+    tree->handle = -1;
+    tree->pid = 0;
+}
+
+bool PlatSpawnCaptured(const PSCHAR* interpreter, PSCHAR* cmdline, const PSCHAR* envBlock,
+                       const PSCHAR* directory, PlatProcess* proc, PlatFile* output)
+{
+    // PIPE: Only the write end is inheritable, and the handle list below
+    // limits inheritance to it, so concurrent spawns never pick it up
+    SECURITY_ATTRIBUTES sa = { sizeof(sa), NULL, TRUE };
+    HANDLE readEnd, writeEnd;
+    if (!CreatePipe(&readEnd, &writeEnd, &sa, 0))
+        return false;
+    SetHandleInformation(readEnd, HANDLE_FLAG_INHERIT, 0);
+
+    // ATTRIBUTE LIST: One entry; the list is a few dozen bytes
+    SIZE_T listSize = 0;
+    InitializeProcThreadAttributeList(NULL, 1, 0, &listSize);
+    void* listBuffer[16];
+    LPPROC_THREAD_ATTRIBUTE_LIST list = (LPPROC_THREAD_ATTRIBUTE_LIST)listBuffer;
+    BOOL ok = listSize <= sizeof(listBuffer) && InitializeProcThreadAttributeList(list, 1, 0, &listSize);
+    if (ok)
+        ok = UpdateProcThreadAttribute(list, 0, PROC_THREAD_ATTRIBUTE_HANDLE_LIST, &writeEnd,
+                                       sizeof(HANDLE), NULL, NULL);
+
+    STARTUPINFOEXW si;
+    ZeroMemory(&si, sizeof(si));
+    si.StartupInfo.cb = sizeof(si);
+    si.StartupInfo.dwFlags = STARTF_USESTDHANDLES;
+    si.StartupInfo.hStdInput = NULL;
+    si.StartupInfo.hStdOutput = writeEnd;
+    si.StartupInfo.hStdError = writeEnd;
+    si.lpAttributeList = list;
+
+    PROCESS_INFORMATION pi;
+    ZeroMemory(&pi, sizeof(pi));
+    if (ok)
+        ok = CreateProcessW(interpreter, cmdline, NULL, NULL, TRUE,
+                            CREATE_NO_WINDOW | CREATE_UNICODE_ENVIRONMENT | EXTENDED_STARTUPINFO_PRESENT,
+                            (LPVOID)envBlock, directory, &si.StartupInfo, &pi);
+    DWORD err = GetLastError();
+    if (listSize <= sizeof(listBuffer))
+        DeleteProcThreadAttributeList(list);
+    CloseHandle(writeEnd);
+
+    if (!ok)
+    {
+        CloseHandle(readEnd);
+        SetLastError(err);
+        return false;
+    }
+    proc->process = (intptr_t)pi.hProcess;
+    proc->thread = (intptr_t)pi.hThread;
+    proc->pid = pi.dwProcessId;
+    *output = (PlatFile)readEnd;
+    return true;
+}
+
+bool PlatReadAvailable(PlatFile pipe, void* data, size_t size, size_t* got)
+{
+    // PeekNamedPipe fails with ERROR_BROKEN_PIPE once the writers are gone
+    DWORD available = 0, read = 0;
+    *got = 0;
+    if (!PeekNamedPipe((HANDLE)pipe, NULL, 0, NULL, &available, NULL))
+        return false;
+    if (available == 0)
+        return true;
+    if (!ReadFile((HANDLE)pipe, data, available < size ? available : (DWORD)size, &read, NULL))
+        return false;
+    *got = read;
+    return true;
+}
+
+void PlatWaitOutput(const PlatFile* pipes, size_t pipeCount, const PlatProcess* procs, size_t procCount,
+                    uint32_t timeoutMillis)
+{
+    UNREFERENCED_PARAMETER(pipes);
+    UNREFERENCED_PARAMETER(pipeCount);
+    DWORD wait = timeoutMillis < PLAT_OUTPUT_POLL_MS ? timeoutMillis : PLAT_OUTPUT_POLL_MS;
+    if (procCount == 0)
+    {
+        if (wait > 0)
+            Sleep(wait);
+        return;
+    }
+    HANDLE handles[MAXIMUM_WAIT_OBJECTS];
+    DWORD count = procCount < MAXIMUM_WAIT_OBJECTS ? (DWORD)procCount : MAXIMUM_WAIT_OBJECTS;
+    for (DWORD i = 0; i < count; i++)
+        handles[i] = (HANDLE)procs[i].process;
+    WaitForMultipleObjects(count, handles, FALSE, wait);
+}
+
+void PlatCloseProcess(PlatProcess* proc)
+{
+    // HANDLE CLEANUP: Always close handles to prevent resource leaks
+    if (proc->process)
+        CloseHandle((HANDLE)proc->process);
+    if (proc->thread)
+        CloseHandle((HANDLE)proc->thread);
+    proc->process = 0;
+    proc->thread = 0;
+}
+
+//--------------------------------------------------------------------------
+// SHARED MEMORY
+//--------------------------------------------------------------------------
+bool PlatOpenShared(const PSCHAR* name, size_t size, bool create, PlatShared* shared)
+{
+    // Local\ is the session namespace: no privilege needed to create it
+    WCHAR objectName[256];
+    size_t pos = 0;
+    objectName[0] = 0;
+    if (!AppendStr(objectName, 256, L"Local\\", &pos) || !AppendStr(objectName, 256, name, &pos))
+        return false;
+    HANDLE section = create
+        ? CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                             (DWORD)((uint64_t)size >> 32), (DWORD)size, objectName)
+        : OpenFileMappingW(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, objectName);
+    if (!section)
+        return false;
+    // A section is never smaller than its creator made it, and every
+    // creator asks for the same size
+    void* base = MapViewOfFile(section, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, size);
+    if (!base)
+    {
+        CloseHandle(section);
+        return false;
+    }
+    shared->base = base;
+    shared->size = size;
+    shared->handle = (intptr_t)section;
+    return true;
+}
+
+bool PlatMapSharedFile(const PSCHAR* path, size_t size, PlatShared* shared)
+{
+    HANDLE file = CreateFileW(path, GENERIC_READ | GENERIC_WRITE,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                              OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    // The section extends a smaller file to size; the view keeps the file open
+    HANDLE section = CreateFileMappingW(file, NULL, PAGE_READWRITE,
+                                       (DWORD)((uint64_t)size >> 32), (DWORD)size, NULL);
+    CloseHandle(file);
+    if (!section)
+        return false;
+    void* base = MapViewOfFile(section, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, size);
+    if (!base)
+    {
+        CloseHandle(section);
+        return false;
+    }
+    shared->base = base;
+    shared->size = size;
+    shared->handle = (intptr_t)section;
+    return true;
+}
+
+void PlatCloseShared(PlatShared* shared)
+{
+    if (shared->base)
+        UnmapViewOfFile(shared->base);
+    if (shared->handle)
+        CloseHandle((HANDLE)shared->handle);
+    shared->base = NULL;
+    shared->handle = 0;
+}
+
+//--------------------------------------------------------------------------
+// DIRECTORY WATCH
+//--------------------------------------------------------------------------
+// 64KB is the largest buffer ReadDirectoryChangesW accepts for a share
+#define WATCH_BUFFER_SIZE (64 * 1024)
+#define WATCH_FILTER      (FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE)
+
+typedef struct WatchBuffer
+{
+    OVERLAPPED overlapped;
+    DWORD data[WATCH_BUFFER_SIZE / sizeof(DWORD)];   // FILE_NOTIFY_INFORMATION is DWORD aligned
+} WatchBuffer;
+
+static bool IssueWatchRead(PlatWatch* watch)
+{
+    WatchBuffer* buf = (WatchBuffer*)watch->buffer;
+    ZeroMemory(&buf->overlapped, sizeof(buf->overlapped));
+    buf->overlapped.hEvent = (HANDLE)watch->event;
+    watch->pending = ReadDirectoryChangesW((HANDLE)watch->handle, buf->data, sizeof(buf->data), FALSE,
+                                           WATCH_FILTER, NULL, &buf->overlapped, NULL) != 0;
+    return watch->pending;
+}
+
+bool PlatWatchOpen(PlatWatch* watch, const PSCHAR* path)
+{
+    watch->pending = false;
+    watch->buffer = NULL;
+    HANDLE dir = CreateFileW(path, FILE_LIST_DIRECTORY,
+                             FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+                             FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+    if (dir == INVALID_HANDLE_VALUE)
+        return false;
+    HANDLE event = CreateEventW(NULL, TRUE, FALSE, NULL);
+    void* buffer = VirtualAlloc(NULL, sizeof(WatchBuffer), MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    watch->handle = (intptr_t)dir;
+    watch->event = (intptr_t)event;
+    watch->buffer = buffer;
+    if (event && buffer && IssueWatchRead(watch))
+        return true;
+
+    DWORD err = GetLastError();
+    if (buffer)
+        VirtualFree(buffer, 0, MEM_RELEASE);
+    if (event)
+        CloseHandle(event);
+    CloseHandle(dir);
+    watch->buffer = NULL;
+    SetLastError(err);
+    return false;
+}
+
+PlatWatchWake PlatWatchWait(PlatWatch* watch, const PlatProcess* child, uint32_t timeoutMillis)
+{
+    HANDLE handles[2] = {(HANDLE)watch->event, child ? (HANDLE)child->process : NULL};
+    DWORD state = WaitForMultipleObjects(child ? 2 : 1, handles, FALSE,
+                                         timeoutMillis == PLAT_WAIT_FOREVER ? INFINITE : timeoutMillis);
+    if (state == WAIT_TIMEOUT)
+        return PLAT_WAKE_TIMEOUT;
+    if (state == WAIT_OBJECT_0)
+        return PLAT_WAKE_EVENTS;
+    if (state == WAIT_OBJECT_0 + 1)
+        return PLAT_WAKE_CHILD;
+    return PLAT_WAKE_ERROR;
+}
+
+bool PlatWatchRead(PlatWatch* watch, PlatWatchCallback fn, void* ctx, bool* overflow)
+{
+    *overflow = false;
+    if (!watch->pending)
+        return false;
+    WatchBuffer* buf = (WatchBuffer*)watch->buffer;
+    DWORD bytes = 0;
+    if (!GetOverlappedResult((HANDLE)watch->handle, &buf->overlapped, &bytes, FALSE))
+    {
+        DWORD err = GetLastError();
+        if (err == ERROR_IO_INCOMPLETE)
+            return true;                    // Nothing queued yet
+        watch->pending = false;
+        if (err != ERROR_NOTIFY_ENUM_DIR)
+            return false;                   // Directory deleted, share gone, ...
+        *overflow = true;
+        return IssueWatchRead(watch);
+    }
+    watch->pending = false;
+
+    // OVERFLOW: Zero bytes means the system buffer overflowed
+    if (bytes == 0)
+        *overflow = true;
+    else
+    {
+        const BYTE* pos = (const BYTE*)buf->data;
+        for (;;)
+        {
+            const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*)pos;
+            if (info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_MODIFIED ||
+                info->Action == FILE_ACTION_RENAMED_NEW_NAME)
+                fn(ctx, info->FileName, info->FileNameLength / sizeof(WCHAR));
+            if (info->NextEntryOffset == 0)
+                break;
+            pos += info->NextEntryOffset;
+        }
+    }
+    ResetEvent((HANDLE)watch->event);
+    return IssueWatchRead(watch);
+}
+
+void PlatWatchClose(PlatWatch* watch)
+{
+    if (!watch->buffer)
+        return;
+    WatchBuffer* buf = (WatchBuffer*)watch->buffer;
+    if (watch->pending)
+    {
+        // The kernel writes into the buffer until the read has completed
+        DWORD bytes = 0;
+        CancelIoEx((HANDLE)watch->handle, &buf->overlapped);
+        GetOverlappedResult((HANDLE)watch->handle, &buf->overlapped, &bytes, TRUE);
+    }
+    CloseHandle((HANDLE)watch->handle);
+    CloseHandle((HANDLE)watch->event);
+    VirtualFree(buf, 0, MEM_RELEASE);
+    watch->buffer = NULL;
+    watch->pending = false;
+}
+
+//--------------------------------------------------------------------------
+// LOCAL IPC
+//--------------------------------------------------------------------------
+// Every pipe handle is overlapped, so a read can wait with a timeout (and
+// stay pending across calls) while the other direction is written.
+#define IPC_PIPE_PREFIX  L"\\\\.\\pipe\\ps-launcher-"
+#define IPC_PIPE_BUFFER  (64 * 1024)
+
+typedef struct PipeState
+{
+    OVERLAPPED readOv;
+    OVERLAPPED writeOv;
+    bool readPending;
+    DWORD have;                      // Bytes in buffer not yet returned
+    DWORD pos;
+    WCHAR name[PS_MAX_PATH];         // Listener: for the next instance
+    BYTE buffer[IPC_PIPE_BUFFER];
+} PipeState;
+
+static PipeState* NewPipeState(void)
+{
+    PipeState* st = (PipeState*)VirtualAlloc(NULL, sizeof(PipeState), MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (!st)
+        return NULL;
+    st->readOv.hEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    st->writeOv.hEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    if (st->readOv.hEvent && st->writeOv.hEvent)
+        return st;
+    if (st->readOv.hEvent)
+        CloseHandle(st->readOv.hEvent);
+    VirtualFree(st, 0, MEM_RELEASE);
+    return NULL;
+}
+
+static void FreePipeState(PipeState* st)
+{
+    CloseHandle(st->readOv.hEvent);
+    CloseHandle(st->writeOv.hEvent);
+    VirtualFree(st, 0, MEM_RELEASE);
+}
+
+// SECURITY CHECK: Local clients only; the default DACL gives write access
+// to the creator and administrators
+static HANDLE NewPipeInstance(const WCHAR* name, bool first)
+{
+    return CreateNamedPipeW(name, PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED |
+                                  (first ? FILE_FLAG_FIRST_PIPE_INSTANCE : 0),
+                            PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                            PIPE_UNLIMITED_INSTANCES, IPC_PIPE_BUFFER, IPC_PIPE_BUFFER, 0, NULL);
+}
+
+bool PlatIpcDefaultEndpoint(PSCHAR* out, size_t outSize)
+{
+    WCHAR user[257];
+    DWORD userLen = 257;
+    size_t pos = 0;
+    out[0] = 0;
+    return GetUserNameW(user, &userLen) &&
+           AppendStr(out, outSize, IPC_PIPE_PREFIX, &pos) &&
+           AppendStr(out, outSize, user, &pos);
+}
+
+bool PlatIpcListen(PlatIpc* server, const PSCHAR* endpoint)
+{
+    PipeState* st = NewPipeState();
+    size_t pos = 0;
+    if (!st)
+        return false;
+    if (!AppendStr(st->name, PS_MAX_PATH, endpoint, &pos))
+    {
+        FreePipeState(st);
+        SetLastError(ERROR_FILENAME_EXCED_RANGE);
+        return false;
+    }
+
+    // FIRST INSTANCE: Fails if another server already owns the name
+    HANDLE pipe = NewPipeInstance(st->name, true);
+    if (pipe == INVALID_HANDLE_VALUE)
+    {
+        DWORD err = GetLastError();
+        FreePipeState(st);
+        SetLastError(err);
+        return false;
+    }
+    server->handle = (intptr_t)pipe;
+    server->state = st;
+    return true;
+}
+
+PlatIpcStatus PlatIpcAccept(PlatIpc* server, PlatIpc* conn)
+{
+    PipeState* listener = (PipeState*)server->state;
+    HANDLE pipe = (HANDLE)server->handle;
+
+    // Connect the waiting instance, then put up the next one before
+    // handing this one over, so clients never find the name missing
+    ResetEvent(listener->readOv.hEvent);
+    if (!ConnectNamedPipe(pipe, &listener->readOv))
+    {
+        DWORD err = GetLastError();
+        DWORD bytes;
+        if (err == ERROR_IO_PENDING)
+        {
+            if (!GetOverlappedResult(pipe, &listener->readOv, &bytes, TRUE))
+                return PLAT_IPC_CLOSED;
+        }
+        else if (err != ERROR_PIPE_CONNECTED)
+            return PLAT_IPC_CLOSED;
+    }
+
+    PipeState* st = NewPipeState();
+    HANDLE next = NewPipeInstance(listener->name, false);
+    if (!st || next == INVALID_HANDLE_VALUE)
+    {
+        if (st)
+            FreePipeState(st);
+        if (next != INVALID_HANDLE_VALUE)
+            CloseHandle(next);
+        DisconnectNamedPipe(pipe);
+        return PLAT_IPC_CLOSED;
+    }
+    conn->handle = (intptr_t)pipe;
+    conn->state = st;
+    server->handle = (intptr_t)next;
+    return PLAT_IPC_OK;
+}
+
+bool PlatIpcConnect(PlatIpc* conn, const PSCHAR* endpoint)
+{
+    PipeState* st = NewPipeState();
+    if (!st)
+        return false;
+    for (;;)
+    {
+        HANDLE pipe = CreateFileW(endpoint, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING,
+                                  FILE_FLAG_OVERLAPPED, NULL);
+        if (pipe != INVALID_HANDLE_VALUE)
+        {
+            conn->handle = (intptr_t)pipe;
+            conn->state = st;
+            return true;
+        }
+        // BUSY: Every instance taken; the server is putting up the next
+        DWORD err = GetLastError();
+        if (err != ERROR_PIPE_BUSY || !WaitNamedPipeW(endpoint, 5000))
+        {
+            FreePipeState(st);
+            SetLastError(err);
+            return false;
+        }
+    }
+}
+
+PlatIpcStatus PlatIpcRead(PlatIpc* conn, void* buffer, size_t size, uint32_t timeoutMillis, size_t* got)
+{
+    PipeState* st = (PipeState*)conn->state;
+    HANDLE pipe = (HANDLE)conn->handle;
+    *got = 0;
+    if (st->have == 0)
+    {
+        DWORD bytes = 0;
+        if (!st->readPending)
+        {
+            ResetEvent(st->readOv.hEvent);
+            if (ReadFile(pipe, st->buffer, IPC_PIPE_BUFFER, &bytes, &st->readOv))
+                st->have = bytes;
+            else if (GetLastError() == ERROR_IO_PENDING)
+                st->readPending = true;
+            else
+                return PLAT_IPC_CLOSED;
+        }
+        if (st->readPending)
+        {
+            DWORD wait = timeoutMillis == PLAT_WAIT_FOREVER ? INFINITE : timeoutMillis;
+            if (WaitForSingleObject(st->readOv.hEvent, wait) == WAIT_TIMEOUT)
+                return PLAT_IPC_TIMEOUT;
+            st->readPending = false;
+            if (!GetOverlappedResult(pipe, &st->readOv, &bytes, FALSE))
+                return PLAT_IPC_CLOSED;
+            st->have = bytes;
+        }
+        if (st->have == 0)
+            return PLAT_IPC_CLOSED;
+        st->pos = 0;
+    }
+
+    size_t n = st->have < size ? st->have : size;
+    CopyMemory(buffer, st->buffer + st->pos, n);
+    st->pos += (DWORD)n;
+    st->have -= (DWORD)n;
+    *got = n;
+    return PLAT_IPC_OK;
+}
+
+bool PlatIpcWrite(PlatIpc* conn, const void* data, size_t size)
+{
+    PipeState* st = (PipeState*)conn->state;
+    HANDLE pipe = (HANDLE)conn->handle;
+    const BYTE* p = (const BYTE*)data;
+    while (size > 0)
+    {
+        DWORD chunk = size > IPC_PIPE_BUFFER ? IPC_PIPE_BUFFER : (DWORD)size;
+        DWORD written = 0;
+        ResetEvent(st->writeOv.hEvent);
+        if (!WriteFile(pipe, p, chunk, &written, &st->writeOv))
+        {
+            if (GetLastError() != ERROR_IO_PENDING ||
+                !GetOverlappedResult(pipe, &st->writeOv, &written, TRUE))
+                return false;
+        }
+        p += written;
+        size -= written;
+    }
+    return true;
+}
+
+void PlatIpcClose(PlatIpc* conn)
+{
+    PipeState* st = (PipeState*)conn->state;
+    HANDLE pipe = (HANDLE)conn->handle;
+    if (st && st->readPending)
+    {
+        // The kernel writes into the buffer until the read has completed
+        DWORD bytes;
+        CancelIoEx(pipe, &st->readOv);
+        GetOverlappedResult(pipe, &st->readOv, &bytes, TRUE);
+    }
+    if (pipe && pipe != INVALID_HANDLE_VALUE)
+        CloseHandle(pipe);
+    if (st)
+        FreePipeState(st);
+    conn->handle = 0;
+    conn->state = NULL;
+}
+
+//--------------------------------------------------------------------------
+// ERRORS AND TIME
+//--------------------------------------------------------------------------
+uint32_t PlatLastError(void)
+{
+    return GetLastError();
+}
+
+void PlatFormatError(uint32_t err, PSCHAR* out, size_t outSize)
+{
+    if (!FormatMessageW(FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+                        NULL, err, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
+                        out, (DWORD)outSize, NULL))
+    {
+        size_t pos = 0;
+        out[0] = 0;
+        AppendStr(out, outSize, L"Windows error ", &pos);
+        AppendUInt(out, outSize, err, &pos);
+    }
+}
+
+uint64_t PlatMonotonicNanos(void)
+{
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+    if (freq.QuadPart == 0)
+        QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+
+    // Split the multiply so a long uptime cannot overflow 64 bits
+    uint64_t ticks = (uint64_t)now.QuadPart;
+    uint64_t f = (uint64_t)freq.QuadPart;
+    return (ticks / f) * 1000000000ull + (ticks % f) * 1000000000ull / f;
+}
+
+uint64_t PlatFileTimeNow(void)
+{
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+    return ((uint64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+}
+
+uint64_t PlatWallClockMillis(void)
+{
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+    uint64_t t = ((uint64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+    return (t - 116444736000000000ull) / 10000;  // 1601 -> 1970, 100ns -> ms
+}
+
+int32_t PlatLocalOffsetMinutes(uint64_t unixMillis)
+{
+    // The rules in force at that instant, not today's
+    uint64_t t = unixMillis * 10000 + 116444736000000000ull;
+    FILETIME utcTime = { (DWORD)t, (DWORD)(t >> 32) };
+    SYSTEMTIME utc, local;
+    FILETIME localTime;
+    if (!FileTimeToSystemTime(&utcTime, &utc) ||
+        !SystemTimeToTzSpecificLocalTime(NULL, &utc, &local) ||
+        !SystemTimeToFileTime(&local, &localTime))
+        return 0;
+    uint64_t l = ((uint64_t)localTime.dwHighDateTime << 32) | localTime.dwLowDateTime;
+    return (int32_t)(((int64_t)l - (int64_t)t) / 600000000);
+}
+
+void PlatSleepMillis(uint32_t millis)
+{
+    Sleep(millis);
+}
@@ -0,0 +1,223 @@
+//--------------------------------------------------------------------------
+// STAND-IN INTERPRETER - Replaces pwsh in tests and benchmarks
+//--------------------------------------------------------------------------
+// Accepts the launcher's switches, then treats everything after -File as
+// "<script> [parameters]". Like pwsh it exits with 64 when the script
+// cannot be opened from its working directory; otherwise it prints the
+// script and each parameter in brackets, one per line, and understands
+// these parameters of its own:
+//   -ExitCode <n>      exit with n
+//   -SleepMs <n>       sleep n milliseconds before exiting
+//   -ChangeList <f>    also print "[changes <lines in f>]" (watch mode)
+//   -BusyMs <n>        spin on the CPU for n milliseconds
+//   -CpuMs <n>         spin until it has had n milliseconds of CPU time
+//                      (CPU-bound: takes longer while CPUs are shared)
+//   -EmitBytes <n>     print n bytes of 'x' and a newline (output volume)
+//   -PrintEnv <name>   also print "[name=<value>]" from the environment
+//
+// With -EncodedCommand <base64> instead of -File (embedded scripts) it
+// prints the decoded command, then everything read from stdin, each in
+// brackets. Decoding assumes ASCII text, which is all the tests send.
+// A startup probe wrapper (cmdline.h) is acted out instead: the marker
+// its first statement prints, then the script and parameters it names,
+// as if they had come after -File.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Base64 of UTF-16LE -> ASCII (high bytes dropped)
+static void Decode(const char* b64, char* text, size_t size)
+{
+    static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    unsigned bits = 0, count = 0, index = 0;
+    size_t len = 0;
+
+    for (; *b64 && *b64 != '='; b64++)
+    {
+        const char* p = strchr(alphabet, *b64);
+        if (!p)
+            break;
+        bits = (bits << 6) | (unsigned)(p - alphabet);
+        count += 6;
+        if (count >= 8)
+        {
+            count -= 8;
+            if ((index++ & 1) == 0 && len + 1 < size)
+                text[len++] = (char)((bits >> count) & 0xFF);
+        }
+    }
+    text[len] = 0;
+}
+
+static void PrintLineCount(const char* path)
+{
+    FILE* f = fopen(path, "rb");
+    long lines = 0;
+    int c;
+    if (f)
+    {
+        while ((c = fgetc(f)) != EOF)
+            lines += c == '\n';
+        fclose(f);
+    }
+    printf("[changes %ld]\n", f ? lines : -1L);
+}
+
+static void PrintStdin(void)
+{
+    char buffer[4096];
+    size_t n;
+    putchar('[');
+    while ((n = fread(buffer, 1, sizeof(buffer), stdin)) > 0)
+        fwrite(buffer, 1, n, stdout);
+    printf("]\n");
+}
+
+static void Spin(long ms)
+{
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    volatile unsigned long spins = 0;
+    do
+    {
+        for (int i = 0; i < 10000; i++)
+            spins++;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } while ((now.tv_sec - start.tv_sec) * 1000L + (now.tv_nsec - start.tv_nsec) / 1000000L < ms);
+}
+
+static void SpinCpu(long ms)
+{
+    struct timespec used;
+    volatile unsigned long spins = 0;
+    do
+    {
+        for (int i = 0; i < 10000; i++)
+            spins++;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &used);
+    } while (used.tv_sec * 1000L + used.tv_nsec / 1000000L < ms);
+}
+
+static void Emit(long bytes)
+{
+    char line[4096];
+    memset(line, 'x', sizeof(line));
+    for (; bytes > 0; bytes -= (long)sizeof(line))
+        fwrite(line, 1, bytes < (long)sizeof(line) ? (size_t)bytes : sizeof(line), stdout);
+    putchar('\n');
+}
+
+// The script and its parameters, as -File hands them over
+static int RunScript(int argc, char** argv)
+{
+    FILE* script = argc > 0 ? fopen(argv[0], "rb") : NULL;
+    if (!script)
+    {
+        fprintf(stderr, "The argument '%s' is not recognized as a script file\n", argc > 0 ? argv[0] : "");
+        return 64;
+    }
+    fclose(script);
+
+    int exitCode = 0;
+    for (int i = 0; i < argc; i++)
+    {
+        printf("[%s]\n", argv[i]);
+        if (i + 1 < argc && strcmp(argv[i], "-ExitCode") == 0)
+            exitCode = atoi(argv[i + 1]);
+        if (i + 1 < argc && strcmp(argv[i], "-SleepMs") == 0)
+        {
+            long ms = atol(argv[i + 1]);
+            struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+            nanosleep(&ts, NULL);
+        }
+        if (i + 1 < argc && strcmp(argv[i], "-ChangeList") == 0)
+            PrintLineCount(argv[i + 1]);
+        if (i + 1 < argc && strcmp(argv[i], "-BusyMs") == 0)
+            Spin(atol(argv[i + 1]));
+        if (i + 1 < argc && strcmp(argv[i], "-CpuMs") == 0)
+            SpinCpu(atol(argv[i + 1]));
+        if (i + 1 < argc && strcmp(argv[i], "-EmitBytes") == 0)
+            Emit(atol(argv[i + 1]));
+        if (i + 1 < argc && strcmp(argv[i], "-PrintEnv") == 0)
+            printf("[%s=%s]\n", argv[i + 1], getenv(argv[i + 1]) ? getenv(argv[i + 1]) : "");
+    }
+
+    fflush(stdout);
+    return exitCode;
+}
+
+// "...;& 'script' -Name 'value' ...;exit $LASTEXITCODE": the marker, then
+// the words between "& " and ";exit", with '' inside quotes unescaped
+static int RunProbeWrapper(char* text)
+{
+    printf("\x1b]psl;prologue\x07");
+    fflush(stdout);
+
+    char* words[64];
+    int count = 0;
+    char* p = strstr(text, ";& ");
+    char* end = strstr(text, ";exit $LASTEXITCODE");
+    if (!p || !end)
+        return 64;
+    *end = 0;
+    for (p += 3; *p && count < 64;)
+    {
+        while (*p == ' ')
+            p++;
+        if (!*p)
+            break;
+        char* out = p;
+        words[count++] = out;
+        if (*p == '\'')
+        {
+            for (p++; *p && !(*p == '\'' && p[1] != '\''); p++)
+            {
+                *out++ = *p;
+                if (*p == '\'')
+                    p++;
+            }
+            p += *p != 0;
+        }
+        else
+        {
+            while (*p && *p != ' ')
+                *out++ = *p++;
+        }
+        char next = *p;
+        *out = 0;
+        p += next != 0;
+    }
+    return RunScript(count, words);
+}
+
+int main(int argc, char** argv)
+{
+    int first = 1;
+
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], "-EncodedCommand") == 0)
+        {
+            static char text[65536];
+            Decode(argv[i + 1], text, sizeof(text));
+            if (strstr(text, "]psl;prologue"))
+                return RunProbeWrapper(text);
+            printf("[%s]\n", text);
+            PrintStdin();
+            fflush(stdout);
+            return 0;
+        }
+    }
+
+    while (first < argc && strcmp(argv[first], "-File") != 0)
+        first++;
+    if (first >= argc - 1)
+    {
+        fprintf(stderr, "fake_interpreter: missing -File <script>\n");
+        return 64;
+    }
+    return RunScript(argc - first - 1, argv + first + 1);
+}
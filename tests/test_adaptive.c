@@ -0,0 +1,158 @@
+//--------------------------------------------------------------------------
+// TESTS: adaptive.c decisions over synthetic windows
+//--------------------------------------------------------------------------
+#include <string.h>
+
+#include "adaptive.h"
+#include "testing.h"
+
+#define MS 1000000ull
+
+static uint64_t g_now;
+
+// One window: completions and a refusal up front, then samples 100 ms
+// apart until it closes
+static AdaptiveDecision Window(Adaptive* a, uint32_t completions, bool refused, uint32_t runnable,
+                               uint64_t available, uint64_t total)
+{
+    for (uint32_t i = 0; i < completions; i++)
+        AdaptiveCompleted(a);
+    if (refused)
+        AdaptiveRefused(a);
+    AdaptiveSignals signals = { runnable, available, total };
+    AdaptiveDecision d;
+    for (;;)
+    {
+        CHECK(AdaptiveSampleDue(a, g_now));
+        bool decided = AdaptiveSample(a, g_now, &signals, &d);
+        g_now += ADAPTIVE_SAMPLE_MS * MS;
+        if (decided)
+            return d;
+    }
+}
+
+// Throughput grows with the limit up to a peak of eight runs
+static uint32_t Completions(const Adaptive* a)
+{
+    uint32_t limit = AdaptiveLimit(a);
+    return (limit < 8 ? limit : 8) * 10;
+}
+
+static void TestSlowStartAndBack(void)
+{
+    Adaptive a;
+    AdaptiveInit(&a, 64, 2, g_now);
+    CHECK(AdaptiveLimit(&a) == 2);
+
+    static const uint32_t limits[] = { 4, 8, 16, 8 };
+    static const AdaptiveReason reasons[] = { ADAPT_RAISE, ADAPT_RAISE, ADAPT_RAISE, ADAPT_BACK };
+    for (int i = 0; i < 4; i++)
+    {
+        AdaptiveDecision d = Window(&a, Completions(&a), true, 1, 0, 0);
+        CHECK(d.reason == reasons[i] && d.limit == limits[i]);
+    }
+
+    // SETTLE: Then one probe past the peak, and back
+    for (int i = 0; i < ADAPTIVE_SETTLE; i++)
+        CHECK(Window(&a, Completions(&a), true, 1, 0, 0).reason == ADAPT_HOLD);
+    AdaptiveDecision d = Window(&a, Completions(&a), true, 1, 0, 0);
+    CHECK(d.reason == ADAPT_RAISE && d.limit == 9);
+    d = Window(&a, Completions(&a), true, 1, 0, 0);
+    CHECK(d.reason == ADAPT_BACK && d.limit == 8 && d.previous == 9);
+    CHECK(d.completions == 80 && d.ratePerKs == 160000);
+}
+
+static void TestRunQueue(void)
+{
+    Adaptive a;
+    AdaptiveInit(&a, 64, 4, g_now);
+    CHECK(Window(&a, 20, true, 4, 0, 0).limit == 8);
+
+    // CPU-bound: eight runs on four CPUs go straight back to four
+    AdaptiveDecision d = Window(&a, 40, true, 8, 0, 0);
+    CHECK(d.reason == ADAPT_CPU && d.limit == 4 && d.runnable == 8);
+
+    // Within a quarter over the CPUs is not a queue
+    Adaptive b;
+    AdaptiveInit(&b, 64, 4, g_now);
+    CHECK(Window(&b, 20, true, 5, 0, 0).reason == ADAPT_RAISE);
+
+    // Someone else's load: never more than half at once
+    Adaptive c;
+    AdaptiveInit(&c, 64, 4, g_now);
+    d = Window(&c, 20, true, 40, 0, 0);
+    CHECK(d.reason == ADAPT_CPU && d.limit == 2);
+    d = Window(&c, 20, true, 40, 0, 0);
+    CHECK(d.reason == ADAPT_CPU && d.limit == 1);
+    d = Window(&c, 20, true, 40, 0, 0);
+    CHECK(d.limit == 1);
+}
+
+static void TestMemory(void)
+{
+    Adaptive a;
+    AdaptiveInit(&a, 64, 8, g_now);
+    AdaptiveDecision d = Window(&a, 20, true, 1, 50, 1000);
+    CHECK(d.reason == ADAPT_MEMORY && d.limit == 6 && d.availableBytes == 50);
+
+    // Under twice the floor nothing is added
+    Adaptive b;
+    AdaptiveInit(&b, 64, 8, g_now);
+    CHECK(Window(&b, 20, true, 1, 150, 1000).reason == ADAPT_HOLD);
+    CHECK(Window(&b, 20, true, 1, 250, 1000).reason == ADAPT_RAISE);
+}
+
+static void TestHold(void)
+{
+    // Nothing waited for a slot: the limit is not what binds
+    Adaptive a;
+    AdaptiveInit(&a, 64, 2, g_now);
+    CHECK(Window(&a, 20, false, 1, 0, 0).reason == ADAPT_HOLD);
+
+    // Never past maxRuns, and never above it to begin with
+    Adaptive b;
+    AdaptiveInit(&b, 3, 2, g_now);
+    CHECK(Window(&b, 20, true, 1, 0, 0).limit == 3);
+    CHECK(Window(&b, 40, true, 1, 0, 0).reason == ADAPT_HOLD);
+    Adaptive c;
+    AdaptiveInit(&c, 2, 16, g_now);
+    CHECK(AdaptiveLimit(&c) == 2);
+}
+
+static void TestLongRuns(void)
+{
+    // Too few completions to judge: the window runs long, and only idle
+    // CPUs justify another run
+    Adaptive a;
+    AdaptiveInit(&a, 64, 4, g_now);
+    uint64_t start = g_now;
+    AdaptiveDecision d = Window(&a, 1, true, 2, 0, 0);
+    CHECK(g_now - start > ADAPTIVE_LONG_WINDOW_MS * MS);
+    CHECK(d.reason == ADAPT_RAISE && d.limit == 8);
+    CHECK(Window(&a, 1, true, 5, 0, 0).reason == ADAPT_HOLD);
+
+    // A restart forgets the window so far
+    AdaptiveCompleted(&a);
+    AdaptiveRefused(&a);
+    AdaptiveRestart(&a, g_now);
+    CHECK(Window(&a, 0, false, 1, 0, 0).completions == 0);
+}
+
+static void TestReasonNames(void)
+{
+    CHECK(strcmp(AdaptiveReasonText(ADAPT_HOLD), "hold") == 0);
+    CHECK(strcmp(AdaptiveReasonText(ADAPT_CPU), "cut: run queue") == 0);
+    CHECK(strcmp(AdaptiveReasonText(ADAPT_MEMORY), "cut: memory") == 0);
+}
+
+int main(void)
+{
+    g_now = 1000 * MS;
+    RUN_TEST(TestSlowStartAndBack);
+    RUN_TEST(TestRunQueue);
+    RUN_TEST(TestMemory);
+    RUN_TEST(TestHold);
+    RUN_TEST(TestLongRuns);
+    RUN_TEST(TestReasonNames);
+    return TEST_SUMMARY();
+}
@@ -0,0 +1,150 @@
+//--------------------------------------------------------------------------
+// TESTS: arena.c, strbuf.c and envblock.c
+//--------------------------------------------------------------------------
+#include "arena.h"
+#include "envblock.h"
+#include "psstr.h"
+#include "strbuf.h"
+#include "testing.h"
+
+static void TestAlignmentAndBump(void)
+{
+    Arena arena;
+    CHECK(ArenaInit(&arena, ARENA_COMMIT_GRANULE * 4));
+    CHECK(arena.committed == 0);
+
+    unsigned char* a = (unsigned char*)ArenaAlloc(&arena, 3);
+    unsigned char* b = (unsigned char*)ArenaAlloc(&arena, 1);
+    CHECK(a != NULL && b != NULL);
+    CHECK(((size_t)a % ARENA_ALIGNMENT) == 0);
+    CHECK(((size_t)b % ARENA_ALIGNMENT) == 0);
+    CHECK(b == a + ARENA_ALIGNMENT);
+    CHECK(arena.committed == ARENA_COMMIT_GRANULE);
+    ArenaRelease(&arena);
+    CHECK(arena.base == NULL);
+}
+
+// Blocks spanning a commit boundary must be fully writable
+static void TestCommitAcrossGranules(void)
+{
+    Arena arena;
+    CHECK(ArenaInit(&arena, ARENA_COMMIT_GRANULE * 4));
+    size_t size = ARENA_COMMIT_GRANULE + 100;
+    unsigned char* p = (unsigned char*)ArenaAlloc(&arena, size);
+    CHECK(p != NULL);
+    for (size_t i = 0; p && i < size; i++)
+        p[i] = (unsigned char)i;
+    CHECK(p && p[size - 1] == (unsigned char)(size - 1));
+    CHECK(arena.committed == ARENA_COMMIT_GRANULE * 2);
+
+    // Reservation exhausted, and no wrap-around on huge requests
+    CHECK(ArenaAlloc(&arena, ARENA_COMMIT_GRANULE * 3) == NULL);
+    CHECK(ArenaAlloc(&arena, (size_t)-1) == NULL);
+    CHECK(ArenaAlloc(&arena, 16) != NULL);
+    ArenaRelease(&arena);
+}
+
+static void TestExtendAndScratch(void)
+{
+    Arena arena;
+    CHECK(ArenaInit(&arena, ARENA_COMMIT_GRANULE));
+    void* a = ArenaAlloc(&arena, 32);
+    CHECK(ArenaExtend(&arena, a, 32, 64));
+    CHECK(arena.used == 64);
+
+    ArenaMark mark = ArenaSave(&arena);
+    void* b = ArenaAlloc(&arena, 16);
+    CHECK(!ArenaExtend(&arena, a, 64, 128));     // No longer the top block
+    ArenaRestore(&arena, mark);
+    CHECK(ArenaAlloc(&arena, 16) == b);          // Scratch space is reused
+    ArenaRelease(&arena);
+}
+
+static void TestStrBufGrowth(void)
+{
+    Arena arena;
+    StrBuf sb;
+    CHECK(ArenaInit(&arena, ARENA_COMMIT_GRANULE * 4));
+    CHECK(StrBufInit(&sb, &arena, 4, STRBUF_NO_LIMIT));
+
+    // In place while on top of the arena
+    PSCHAR* first = sb.data;
+    CHECK(StrBufAppend(&sb, PS_T("hello ")));
+    CHECK(sb.data == first);
+
+    // Relocates (keeping the content) once something sits above it
+    ArenaAlloc(&arena, 8);
+    CHECK(StrBufAppend(&sb, PS_T("world, and then some more text")));
+    CHECK(sb.data != first);
+    CHECK_STR(sb.data, PS_T("hello world, and then some more text"));
+    CHECK(StrBufAppendUInt(&sb, 42));
+    CHECK(sb.len == PsStrLen(sb.data));
+    ArenaRelease(&arena);
+}
+
+static void TestStrBufLimit(void)
+{
+    Arena arena;
+    StrBuf sb;
+    CHECK(ArenaInit(&arena, ARENA_COMMIT_GRANULE));
+    CHECK(StrBufInit(&sb, &arena, 1, 5));
+    CHECK(StrBufAppend(&sb, PS_T("abcd")));
+    CHECK(StrBufAppendChar(&sb, PS_T('e')));
+    CHECK(!StrBufAppendChar(&sb, PS_T('f')));
+    CHECK(!StrBufAppend(&sb, PS_T("xy")));
+    CHECK_STR(sb.data, PS_T("abcde"));
+    ArenaRelease(&arena);
+}
+
+static void TestEnvironmentOverrides(void)
+{
+    static const PSCHAR base[] = PS_T("PATH=/bin\0HOME=/root\0EMPTY=\0");
+    const PSCHAR* overrides[] = { PS_T("HOME=/tmp"), PS_T("PS_NEW=1") };
+    Arena arena;
+    CHECK(ArenaInit(&arena, ARENA_COMMIT_GRANULE));
+
+    const PSCHAR* block = BuildEnvironmentBlock(&arena, base, overrides, 2);
+    CHECK(block != NULL);
+    if (block)
+    {
+        CHECK_STR(block, PS_T("PATH=/bin"));
+        CHECK_STR(FindEnvironmentValue(block, PS_T("HOME")), PS_T("/tmp"));
+        CHECK_STR(FindEnvironmentValue(block, PS_T("PS_NEW")), PS_T("1"));
+        CHECK_STR(FindEnvironmentValue(block, PS_T("EMPTY")), PS_T(""));
+        CHECK(FindEnvironmentValue(block, PS_T("HOM")) == NULL);
+
+        // Replaced in place of being duplicated: four entries, then "\0"
+        int count = 0;
+        const PSCHAR* entry = block;
+        for (; *entry; entry += PsStrLen(entry) + 1)
+            count++;
+        CHECK(count == 4);
+    }
+
+    // A bare name only takes the inherited variable out
+    const PSCHAR* removals[] = { PS_T("HOME"), PS_T("PS_ABSENT") };
+    block = BuildEnvironmentBlock(&arena, base, removals, 2);
+    CHECK(block != NULL);
+    if (block)
+    {
+        CHECK(FindEnvironmentValue(block, PS_T("HOME")) == NULL);
+        CHECK(FindEnvironmentValue(block, PS_T("PS_ABSENT")) == NULL);
+        CHECK_STR(block, PS_T("PATH=/bin"));
+    }
+
+    // An inherited environment has at least one variable in this process
+    block = BuildEnvironmentBlock(&arena, NULL, NULL, 0);
+    CHECK(block != NULL && block[0] != 0);
+    ArenaRelease(&arena);
+}
+
+int main(void)
+{
+    RUN_TEST(TestAlignmentAndBump);
+    RUN_TEST(TestCommitAcrossGranules);
+    RUN_TEST(TestExtendAndScratch);
+    RUN_TEST(TestStrBufGrowth);
+    RUN_TEST(TestStrBufLimit);
+    RUN_TEST(TestEnvironmentOverrides);
+    return TEST_SUMMARY();
+}
@@ -0,0 +1,87 @@
+//--------------------------------------------------------------------------
+// TESTS: args.c
+//--------------------------------------------------------------------------
+#include "args.h"
+#include "testing.h"
+
+static void TestParseRequiresScript(void)
+{
+    PSCHAR* none[] = { PS_T("ps-launcher") };
+    PSCHAR* missing[] = { PS_T("ps-launcher"), PS_T("-Script") };
+    PSCHAR* wrong[] = { PS_T("ps-launcher"), PS_T("-File"), PS_T("a.ps1") };
+    LaunchArgs args;
+
+    CHECK(!ParseLaunchArgs(1, none, &args));
+    CHECK(!ParseLaunchArgs(2, missing, &args));
+    CHECK(!ParseLaunchArgs(3, wrong, &args));
+}
+
+static void TestParseForwardsParameters(void)
+{
+    PSCHAR* argv[] = { PS_T("ps-launcher"), PS_T("-script"), PS_T("a.ps1"),
+                       PS_T("-Name"), PS_T("John Doe") };
+    LaunchArgs args;
+
+    CHECK(ParseLaunchArgs(5, argv, &args));
+    CHECK_STR(args.script, PS_T("a.ps1"));
+    CHECK(args.paramCount == 2);
+    CHECK_STR(args.params[0], PS_T("-Name"));
+    CHECK_STR(args.params[1], PS_T("John Doe"));
+}
+
+static void TestResidentModes(void)
+{
+    CHECK(IsResidentMode(PS_T("-Schedule")));
+    CHECK(IsResidentMode(PS_T("-watch")));
+    CHECK(IsResidentMode(PS_T("-SERVE")));
+    CHECK(!IsResidentMode(PS_T("-Script")));
+    CHECK(!IsResidentMode(PS_T("-Status")));
+    CHECK(!IsResidentMode(PS_T("-Serves")));
+}
+
+static void TestSplitProgramName(void)
+{
+    PSCHAR storage[64];
+    PSCHAR* argv[8];
+
+    // Backslashes in the program name are literal, even before a quote
+    int argc = SplitCommandLine(PS_T("\"C:\\Program Files\\ps.exe\" -x"), storage, argv, 8);
+    CHECK(argc == 2);
+    CHECK_STR(argv[0], PS_T("C:\\Program Files\\ps.exe"));
+    CHECK_STR(argv[1], PS_T("-x"));
+}
+
+static void TestSplitQuotesAndBackslashes(void)
+{
+    PSCHAR storage[128];
+    PSCHAR* argv[16];
+
+    int argc = SplitCommandLine(
+        PS_T("p \"a b\" \"\" c\\\\\"d e\" f\\\"g h\\i \"x\"\"y\""), storage, argv, 16);
+    CHECK(argc == 7);
+    CHECK_STR(argv[1], PS_T("a b"));
+    CHECK_STR(argv[2], PS_T(""));
+    CHECK_STR(argv[3], PS_T("c\\d e"));
+    CHECK_STR(argv[4], PS_T("f\"g"));
+    CHECK_STR(argv[5], PS_T("h\\i"));
+    CHECK_STR(argv[6], PS_T("x\"y"));
+}
+
+static void TestSplitLimit(void)
+{
+    PSCHAR storage[32];
+    PSCHAR* argv[2];
+    CHECK(SplitCommandLine(PS_T("p a b"), storage, argv, 2) == -1);
+    CHECK(SplitCommandLine(PS_T("   "), storage, argv, 2) == 1);
+}
+
+int main(void)
+{
+    RUN_TEST(TestParseRequiresScript);
+    RUN_TEST(TestParseForwardsParameters);
+    RUN_TEST(TestResidentModes);
+    RUN_TEST(TestSplitProgramName);
+    RUN_TEST(TestSplitQuotesAndBackslashes);
+    RUN_TEST(TestSplitLimit);
+    return TEST_SUMMARY();
+}
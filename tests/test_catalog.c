@@ -0,0 +1,263 @@
+//--------------------------------------------------------------------------
+// TESTS: catalog.c and indexer.c (POSIX file system)
+//--------------------------------------------------------------------------
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "catalog.h"
+#include "indexer.h"
+#include "testing.h"
+
+static char g_dir[400];
+static char g_source[512];
+static char g_index[512];
+static Arena g_arena;
+
+static void WriteFile(const char* name, const char* text)
+{
+    char path[600];
+    snprintf(path, sizeof(path), "%s/%s", g_dir, name);
+    FILE* f = fopen(path, "w");
+    if (f)
+    {
+        fputs(text, f);
+        fclose(f);
+    }
+}
+
+// Coarse file system clocks may not move between two quick writes
+static void SetModified(const char* name, time_t seconds)
+{
+    char path[600];
+    snprintf(path, sizeof(path), "%s/%s", g_dir, name);
+    struct timespec times[2] = { { seconds, 0 }, { seconds, 0 } };
+    utimensat(AT_FDCWD, path, times, 0);
+}
+
+static bool Build(IndexStats* stats)
+{
+    ArenaMark mark = ArenaSave(&g_arena);
+    bool ok = BuildCatalogIndex(&g_arena, g_source, g_index, stats);
+    ArenaRestore(&g_arena, mark);
+    return ok;
+}
+
+static const char* EntryPath(const Catalog* cat, const char* alias)
+{
+    static char path[600];
+    const CatalogEntry* e = CatalogFind(cat, alias, strlen(alias));
+    const char* s = e ? CatalogString(cat, e->pathOffset, e->pathLen) : NULL;
+    if (!s)
+        return "";
+    memcpy(path, s, e->pathLen);
+    path[e->pathLen] = 0;
+    return path;
+}
+
+static void TestBuildAndLookup(void)
+{
+    char source[2048];
+    snprintf(source, sizeof(source),
+             "\xEF\xBB\xBF# Catalogue\n"
+             "tags nightly sales-db share\n"
+             "profile nightly -Mode Nightly -Target \"all hosts\"\n"
+             "resource sales-db 1\n"
+             "resource share 3\n"
+             "alias backup \"%s/tools/do backup.ps1\" nightly\r\n"
+             "root %s/scripts\n"
+             "root %s/tools\n",
+             g_dir, g_dir, g_dir);
+    WriteFile("ps-launcher.catalog", source);
+
+    IndexStats stats;
+    CHECK(Build(&stats));
+    CHECK(stats.scripts == 4);       // backup, report, deploy, do backup
+    CHECK(stats.hashed == 4);
+    CHECK(stats.reused == 0);
+    CHECK(stats.skipped == 1);       // tools/Report.PS1 behind scripts/report.ps1
+
+    Catalog cat;
+    CHECK(CatalogOpen(&cat, g_index));
+    char expected[600];
+    snprintf(expected, sizeof(expected), "%s/tools/do backup.ps1", g_dir);
+    CHECK(strcmp(EntryPath(&cat, "BACKUP"), expected) == 0);
+    snprintf(expected, sizeof(expected), "%s/scripts/report.ps1", g_dir);
+    CHECK(strcmp(EntryPath(&cat, "report"), expected) == 0);   // Earlier root wins
+    snprintf(expected, sizeof(expected), "%s/scripts/sub/deploy.ps1", g_dir);
+    CHECK(strcmp(EntryPath(&cat, "deploy"), expected) == 0);
+    CHECK(CatalogFind(&cat, "notes", 5) == NULL);               // Not a .ps1
+    CHECK(CatalogFind(&cat, "missing", 7) == NULL);
+    CatalogClose(&cat);
+}
+
+static void TestResolveWithProfile(void)
+{
+    ArenaMark mark = ArenaSave(&g_arena);
+    PSCHAR* params[] = { "-Verbose" };
+    CatalogScript script;
+    CHECK(CatalogResolve(&g_arena, "backup", params, 1, &script) == CATALOG_OK);
+    CHECK(script.paramCount == 5);
+    if (script.paramCount == 5)
+    {
+        CHECK_STR(script.params[0], "-Mode");
+        CHECK_STR(script.params[3], "all hosts");
+        CHECK_STR(script.params[4], "-Verbose");
+    }
+    CHECK(CatalogResolve(&g_arena, "deploy", params, 1, &script) == CATALOG_OK);
+    CHECK(script.paramCount == 1 && script.params == params);
+    CHECK(CatalogResolve(&g_arena, "nothing", params, 1, &script) == CATALOG_NOT_FOUND);
+    ArenaRestore(&g_arena, mark);
+}
+
+static void TestResourceTags(void)
+{
+    ArenaMark mark = ArenaSave(&g_arena);
+    CatalogResources tags;
+    CHECK(CatalogAliasResources(&g_arena, "backup", &tags));
+    CHECK(tags.count == 2);
+    if (tags.count == 2)
+    {
+        CHECK_STR(tags.names[0], "sales-db");
+        CHECK(tags.limits[0] == 1 && tags.limits[1] == 3);
+    }
+    CHECK(CatalogAliasResources(&g_arena, "deploy", &tags) && tags.count == 0);
+    CHECK(!CatalogAliasResources(&g_arena, "nothing", &tags) && tags.count == 0);
+
+    // Into a table: the limits come with the tags
+    ResourceTable table;
+    ResourceClaim first, second;
+    ResourceInit(&table);
+    ResourceClaimInit(&first);
+    ResourceClaimInit(&second);
+    CHECK(CatalogAliasResources(&g_arena, "backup", &tags));
+    CHECK(CatalogClaimResources(&tags, &table, &first) && CatalogClaimResources(&tags, &table, &second));
+    CHECK(table.count == 2 && first.count == 2);
+    CHECK(ResourceAcquire(&table, &first) && !ResourceAcquire(&table, &second));
+    ArenaRestore(&g_arena, mark);
+}
+
+// Unchanged files keep their hashes; only changed and new ones are read
+static void TestIncrementalRefresh(void)
+{
+    WriteFile("scripts/sub/deploy.ps1", "Write-Output 'deploy v2 - longer'\n");
+    WriteFile("tools/new.ps1", "exit 3\n");
+
+    IndexStats stats;
+    CHECK(Build(&stats));
+    CHECK(stats.scripts == 5);
+    CHECK(stats.hashed == 2);
+    CHECK(stats.reused == 3);
+}
+
+static void TestStaleAndMissing(void)
+{
+    ArenaMark mark = ArenaSave(&g_arena);
+    CatalogScript script;
+
+    // Same size, new content: identity moves, hash no longer matches
+    WriteFile("tools/new.ps1", "exit 4\n");
+    SetModified("tools/new.ps1", 1000000000);
+    CHECK(CatalogResolve(&g_arena, "new", NULL, 0, &script) == CATALOG_STALE);
+
+    // Touched but identical content still runs
+    WriteFile("scripts/report.ps1", "Write-Output 'report'\n");
+    SetModified("scripts/report.ps1", 1000000000);
+    CHECK(CatalogResolve(&g_arena, "report", NULL, 0, &script) == CATALOG_OK);
+
+    char path[600];
+    snprintf(path, sizeof(path), "%s/scripts/sub/deploy.ps1", g_dir);
+    unlink(path);
+    CHECK(CatalogResolve(&g_arena, "deploy", NULL, 0, &script) == CATALOG_MISSING);
+
+    IndexStats stats;
+    CHECK(Build(&stats));
+    CHECK(stats.scripts == 4);
+    CHECK(CatalogResolve(&g_arena, "new", NULL, 0, &script) == CATALOG_OK);
+    ArenaRestore(&g_arena, mark);
+}
+
+static void TestCorruptIndexRejected(void)
+{
+    Catalog cat;
+    CHECK(CatalogOpen(&cat, g_index));
+    size_t size = cat.size;
+    uint8_t* copy = (uint8_t*)malloc(size);
+    memcpy(copy, cat.view, size);
+    CatalogClose(&cat);
+
+    CHECK(CatalogAttach(&cat, copy, size));
+    CHECK(!CatalogAttach(&cat, copy, size - 1));
+    CatalogHeader* h = (CatalogHeader*)copy;
+    h->bucketCount = 3;                       // Not a power of two
+    CHECK(!CatalogAttach(&cat, copy, size));
+    h->bucketCount = 1u << 30;                // Framing overflows the file
+    CHECK(!CatalogAttach(&cat, copy, size));
+    free(copy);
+
+    WriteFile("ps-launcher/ps-launcher.catalog.idx", "PSCI");
+    CatalogScript script;
+    CHECK(CatalogResolve(&g_arena, "report", NULL, 0, &script) == CATALOG_NO_INDEX);
+}
+
+static void TestBadSourceRejected(void)
+{
+    IndexStats stats;
+    WriteFile("ps-launcher.catalog", "root /tmp unknownprofile\n");
+    CHECK(!Build(&stats));
+    WriteFile("ps-launcher.catalog", "scripts /tmp\n");
+    CHECK(!Build(&stats));
+    WriteFile("ps-launcher.catalog", "profile p\ntags p db\n");
+    CHECK(!Build(&stats));                    // Tag never declared
+    WriteFile("ps-launcher.catalog", "resource db 0\n");
+    CHECK(!Build(&stats));
+    WriteFile("ps-launcher.catalog", "resource db 1\nresource DB 2\n");
+    CHECK(!Build(&stats));
+}
+
+int main(void)
+{
+    char cwd[300];
+    if (!getcwd(cwd, sizeof(cwd)))
+        return 1;
+    snprintf(g_dir, sizeof(g_dir), "%s/catalog_scratch", cwd);
+    snprintf(g_source, sizeof(g_source), "%s/ps-launcher.catalog", g_dir);
+    snprintf(g_index, sizeof(g_index), "%s/ps-launcher/ps-launcher.catalog.idx", g_dir);
+
+    // Fresh tree: <dir>/scripts, <dir>/tools and the state directory
+    char cmd[600];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", g_dir);
+    if (system(cmd) != 0)
+        return 1;
+    char sub[600];
+    mkdir(g_dir, 0700);
+    snprintf(sub, sizeof(sub), "%s/scripts", g_dir);
+    mkdir(sub, 0700);
+    snprintf(sub, sizeof(sub), "%s/scripts/sub", g_dir);
+    mkdir(sub, 0700);
+    snprintf(sub, sizeof(sub), "%s/tools", g_dir);
+    mkdir(sub, 0700);
+    snprintf(sub, sizeof(sub), "%s/ps-launcher", g_dir);
+    mkdir(sub, 0700);
+    WriteFile("scripts/report.ps1", "Write-Output 'report'\n");
+    WriteFile("scripts/notes.txt", "not a script\n");
+    WriteFile("scripts/sub/deploy.ps1", "Write-Output 'deploy'\n");
+    WriteFile("tools/Report.PS1", "Write-Output 'shadowed'\n");
+    WriteFile("tools/do backup.ps1", "Write-Output 'backup'\n");
+    setenv("XDG_STATE_HOME", g_dir, 1);
+
+    if (!ArenaInit(&g_arena, ARENA_DEFAULT_RESERVE))
+        return 1;
+    RUN_TEST(TestBuildAndLookup);
+    RUN_TEST(TestResolveWithProfile);
+    RUN_TEST(TestResourceTags);
+    RUN_TEST(TestIncrementalRefresh);
+    RUN_TEST(TestStaleAndMissing);
+    RUN_TEST(TestCorruptIndexRejected);
+    RUN_TEST(TestBadSourceRejected);
+    ArenaRelease(&g_arena);
+    return TEST_SUMMARY();
+}
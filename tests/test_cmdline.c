@@ -0,0 +1,174 @@
+//--------------------------------------------------------------------------
+// TESTS: cmdline.c and policy.c
+//--------------------------------------------------------------------------
+#include "args.h"
+#include "cmdline.h"
+#include "config.h"
+#include "encoding.h"
+#include "policy.h"
+#include "psstr.h"
+#include "testing.h"
+
+static Arena g_arena;
+
+static CmdStatus Build(StrBuf* cmd, size_t limit, const PSCHAR* interpreter,
+                       const LaunchArgs* args, int* blockedIndex)
+{
+    CHECK(StrBufInit(cmd, &g_arena, 16, limit));
+    return BuildCommandLine(cmd, interpreter, args, blockedIndex);
+}
+
+static void TestExactCommandLine(void)
+{
+    PSCHAR* params[] = { PS_T("-Name"), PS_T("John Doe") };
+    LaunchArgs args = { PS_T("C:\\s\\a.ps1"), params, 2 };
+    StrBuf cmd;
+
+    CHECK(Build(&cmd, STRBUF_NO_LIMIT, PS_T("C:\\ps.exe"), &args, NULL) == CMD_OK);
+    CHECK_STR(cmd.data, PS_T("\"C:\\ps.exe\" -NonInteractive -NoProfile -ExecutionPolicy Bypass ")
+                   PS_T("-File \"C:\\s\\a.ps1\" \"-Name\" \"John Doe\""));
+    CHECK(cmd.len == PsStrLen(cmd.data));
+}
+
+// Whatever the launcher builds must split back into the original values
+static void TestRoundTripThroughSplit(void)
+{
+    PSCHAR* params[] = { PS_T(""), PS_T("a b"), PS_T("say \"hi\""), PS_T("-42"),
+                         PS_T("Caf\xC3\xA9"), PS_T("@#&%") };
+    LaunchArgs args = { PS_T("/tmp/x y.ps1"), params, 6 };
+    StrBuf cmd;
+    PSCHAR storage[256];
+    PSCHAR* argv[32];
+
+    CHECK(Build(&cmd, 255, PS_T("/usr/bin/pwsh"), &args, NULL) == CMD_OK);
+    int argc = SplitCommandLine(cmd.data, storage, argv, 32);
+    CHECK(argc == 7 + 6);
+    CHECK_STR(argv[0], PS_T("/usr/bin/pwsh"));
+    CHECK_STR(argv[5], PS_T("-File"));
+    CHECK_STR(argv[6], PS_T("/tmp/x y.ps1"));
+    for (int i = 0; i < 6 && argc == 13; i++)
+        CHECK_STR(argv[7 + i], params[i]);
+}
+
+static void TestSemicolonBlocked(void)
+{
+    PSCHAR* params[] = { PS_T("ok"), PS_T("a; Remove-Item x") };
+    LaunchArgs args = { PS_T("a.ps1"), params, 2 };
+    StrBuf cmd;
+    int blocked = -1;
+
+    CHECK(CheckParameterPolicy(PS_T("fine")) == POLICY_OK);
+    CHECK(CheckParameterPolicy(PS_T(";")) == POLICY_SEMICOLON);
+    CHECK(Build(&cmd, STRBUF_NO_LIMIT, PS_T("ps"), &args, &blocked) == CMD_BLOCKED);
+    CHECK(blocked == 1);
+}
+
+static void TestOverflowReported(void)
+{
+    PSCHAR* params[] = { PS_T("0123456789012345678901234567890123456789") };
+    LaunchArgs args = { PS_T("a.ps1"), params, 1 };
+    StrBuf cmd;
+
+    CHECK(Build(&cmd, 95, PS_T("ps"), &args, NULL) == CMD_OVERFLOW);
+    CHECK(Build(&cmd, 0, PS_T("ps"), &args, NULL) == CMD_OVERFLOW);
+}
+
+// No fixed buffer any more: only the OS limit bounds the command line
+static void TestLongCommandLineFits(void)
+{
+    PSCHAR* params[200];
+    PSCHAR value[101];
+    for (int i = 0; i < 100; i++)
+        value[i] = PS_T('v');
+    value[100] = 0;
+    for (int i = 0; i < 200; i++)
+        params[i] = value;
+    LaunchArgs args = { PS_T("a.ps1"), params, 200 };
+    StrBuf cmd;
+
+    CHECK(Build(&cmd, PS_MAX_COMMAND_LINE, PS_T("ps"), &args, NULL) == CMD_OK);
+    CHECK(cmd.len > 200 * 103);
+    CHECK(PS_MAX_COMMAND_LINE + 1 == 32767);    // With its NUL, CreateProcessW's limit
+    CHECK(Build(&cmd, 200 * 103, PS_T("ps"), &args, NULL) == CMD_OVERFLOW);
+}
+
+static void TestEmbeddedWrapper(void)
+{
+    PSCHAR* params[] = { PS_T("-Name"), PS_T("John Doe"), PS_T("it's"), PS_T("\"as is\""),
+                         PS_T("-5"), PS_T("-Path:"), PS_T("$(whoami)"), PS_T("") };
+    LaunchArgs args = { PS_T("a.ps1"), params, 8 };
+    StrBuf out;
+    CHECK(StrBufInit(&out, &g_arena, 16, STRBUF_NO_LIMIT));
+
+    CHECK(BuildEmbeddedWrapper(&out, &args, NULL) == CMD_OK);
+    CHECK_STR(out.data, PS_EMBEDDED_PROLOGUE
+                        PS_T(" -Name 'John Doe' 'it''s' 'as is' '-5' -Path: '$(whoami)' ''"));
+
+    // Typographic quotes end a single-quoted string too
+#ifndef _WIN32
+    PSCHAR* smart[] = { "\xE2\x80\x98x\xE2\x80\x99" };
+    LaunchArgs smartArgs = { "a.ps1", smart, 1 };
+    CHECK(StrBufInit(&out, &g_arena, 16, STRBUF_NO_LIMIT));
+    CHECK(BuildEmbeddedWrapper(&out, &smartArgs, NULL) == CMD_OK);
+    CHECK_STR(out.data, PS_EMBEDDED_PROLOGUE
+                        " '\xE2\x80\x98\xE2\x80\x98x\xE2\x80\x99\xE2\x80\x99'");
+#endif
+
+    PSCHAR* bad[] = { PS_T("x;y") };
+    LaunchArgs badArgs = { PS_T("a.ps1"), bad, 1 };
+    int blocked = -1;
+    CHECK(StrBufInit(&out, &g_arena, 16, STRBUF_NO_LIMIT));
+    CHECK(BuildEmbeddedWrapper(&out, &badArgs, &blocked) == CMD_BLOCKED);
+    CHECK(blocked == 0);
+}
+
+static void TestEmbeddedCommandLine(void)
+{
+    LaunchArgs args = { PS_T("a.ps1"), NULL, 0 };
+    StrBuf cmd;
+    CHECK(StrBufInit(&cmd, &g_arena, 16, STRBUF_NO_LIMIT));
+    CHECK(BuildEmbeddedCommandLine(&cmd, PS_T("ps"), &args, NULL) == CMD_OK);
+
+    // "& (" in UTF-16LE is 26 00 20 00 28 00
+    static const PSCHAR prefix[] = PS_T("\"ps\"") PS_EMBEDDED_SWITCHES PS_T("JgAgACgA");
+    size_t prefixLen = sizeof(prefix) / sizeof(PSCHAR) - 1;
+    size_t fixed = prefixLen - 8;
+    size_t prologue = sizeof(PS_EMBEDDED_PROLOGUE) / sizeof(PSCHAR) - 1;
+    CHECK(cmd.len == fixed + BASE64_LENGTH(prologue * 2));
+    cmd.data[prefixLen] = 0;
+    CHECK_STR(cmd.data, prefix);
+}
+
+static void TestProbeWrapper(void)
+{
+    PSCHAR* params[] = { PS_T("-Name"), PS_T("it's") };
+    LaunchArgs args = { PS_T("C:\\jobs\\Bob's job.ps1"), params, 2 };
+    StrBuf out;
+    CHECK(StrBufInit(&out, &g_arena, 16, STRBUF_NO_LIMIT));
+    CHECK(BuildProbeWrapper(&out, &args, NULL) == CMD_OK);
+    CHECK_STR(out.data, PS_PROBE_PROLOGUE PS_T("'C:\\jobs\\Bob''s job.ps1' -Name 'it''s'") PS_PROBE_EPILOGUE);
+
+    PSCHAR* bad[] = { PS_T("ok"), PS_T("x;y") };
+    LaunchArgs badArgs = { PS_T("a.ps1"), bad, 2 };
+    int blocked = -1;
+    StrBuf cmd;
+    CHECK(StrBufInit(&cmd, &g_arena, 16, STRBUF_NO_LIMIT));
+    CHECK(BuildProbeCommandLine(&cmd, PS_T("ps"), &badArgs, &blocked) == CMD_BLOCKED);
+    CHECK(blocked == 1);
+}
+
+int main(void)
+{
+    if (!ArenaInit(&g_arena, ARENA_COMMIT_GRANULE * 16))
+        return 1;
+    RUN_TEST(TestExactCommandLine);
+    RUN_TEST(TestRoundTripThroughSplit);
+    RUN_TEST(TestSemicolonBlocked);
+    RUN_TEST(TestOverflowReported);
+    RUN_TEST(TestLongCommandLineFits);
+    RUN_TEST(TestEmbeddedWrapper);
+    RUN_TEST(TestEmbeddedCommandLine);
+    RUN_TEST(TestProbeWrapper);
+    ArenaRelease(&g_arena);
+    return TEST_SUMMARY();
+}
@@ -0,0 +1,318 @@
+//--------------------------------------------------------------------------
+// TESTS: src/cpp/coro.hpp tasks, launches, WhenAll, timeouts, cancellation
+//--------------------------------------------------------------------------
+// Usage: test_coro <interpreter>
+// Launches run the stand-in interpreter on an empty script in a scratch
+// directory. Global operator new is counted to check that awaiting
+// allocates nothing once the task frames exist.
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "coro.hpp"
+#include "testing.h"
+
+using namespace ps;
+
+static char g_dir[400];
+static char g_script[512];
+static size_t g_allocations;
+
+void* operator new(size_t size)
+{
+    g_allocations++;
+    void* p = malloc(size ? size : 1);
+    if (!p)
+        abort();
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+//--------------------------------------------------------------------------
+// TASKS WITHOUT RUNS
+//--------------------------------------------------------------------------
+static Task<int> Leaf(int depth)
+{
+    co_return depth;
+}
+
+static Task<int> Chain(int depth)
+{
+    if (depth == 0)
+        co_return 0;
+    int below = co_await Chain(depth - 1);
+    co_return below + 1;
+}
+
+// Symmetric transfer: ten thousand nested awaits must not overflow the stack
+static void TestTaskChain(void)
+{
+    EventLoop loop(1);
+    Task<int> leaf = Leaf(7);
+    CHECK(loop.Run(leaf));
+    CHECK(leaf.Done() && leaf.Result() == 7);
+
+    Task<int> deep = Chain(10000);
+    CHECK(loop.Run(deep));
+    CHECK(deep.Result() == 10000);
+}
+
+template <typename T>
+static Task<void> AwaitAll(Task<T>* tasks, size_t count)
+{
+    co_await WhenAll(tasks, count);
+}
+
+static Task<void> SleepThenMark(EventLoop& loop, uint32_t millis, int* order, int* next)
+{
+    co_await Sleep(loop, millis);
+    *order = (*next)++;
+}
+
+static void TestSleepOrder(void)
+{
+    EventLoop loop(1);
+    int a = -1, b = -1, c = -1, next = 0;
+    Task<void> tasks[3];
+    tasks[0] = SleepThenMark(loop, 60, &a, &next);
+    tasks[1] = SleepThenMark(loop, 20, &b, &next);
+    tasks[2] = SleepThenMark(loop, 0, &c, &next);
+    Task<void> all = AwaitAll(tasks, 3);
+    uint64_t start = EventLoop::NowMillis();
+    CHECK(loop.Run(all));
+    CHECK(EventLoop::NowMillis() - start >= 60);
+    CHECK(c == 0 && b == 1 && a == 2);
+}
+
+//--------------------------------------------------------------------------
+// LAUNCHES
+//--------------------------------------------------------------------------
+static Task<LaunchResult> LaunchCaptured(EventLoop& loop, char* output, size_t capacity)
+{
+    LaunchOptions options;
+    options.output = output;
+    options.outputCapacity = capacity;
+    co_return co_await Launch(loop, g_script, { "-Tag", "one", "-ExitCode", "3" }, options);
+}
+
+static void TestLaunchCapture(void)
+{
+    EventLoop loop;
+    char output[256] = { 0 };
+    Task<LaunchResult> task = LaunchCaptured(loop, output, sizeof(output) - 1);
+    CHECK(loop.Run(task));
+    LaunchResult& r = task.Result();
+    CHECK(r.outcome == LaunchOutcome::Completed);
+    CHECK(r.stats.exitCode == 3);
+    char expected[700];
+    snprintf(expected, sizeof(expected), "[%s]\n[-Tag]\n[one]\n[-ExitCode]\n[3]\n", g_script);
+    CHECK_STR(output, expected);
+    CHECK(r.outputSize == strlen(expected) && r.stats.outputBytes == r.outputSize);
+
+    // Truncated capture still counts every byte
+    char small[8];
+    Task<LaunchResult> truncated = LaunchCaptured(loop, small, sizeof(small));
+    CHECK(loop.Run(truncated));
+    CHECK(truncated.Result().outputSize == sizeof(small));
+    CHECK(truncated.Result().stats.outputBytes == strlen(expected));
+}
+
+static Task<LaunchResult> LaunchMissing(EventLoop& loop)
+{
+    co_return co_await Launch(loop, "/nonexistent/nowhere.ps1", {});
+}
+
+static void TestLaunchFailure(void)
+{
+    EventLoop loop;
+    Task<LaunchResult> task = LaunchMissing(loop);
+    CHECK(loop.Run(task));
+    CHECK(task.Result().outcome == LaunchOutcome::Failed);
+    CHECK(task.Result().status == PSL_NOT_FOUND);
+}
+
+// Sequential awaits reuse the frame: nothing else is allocated
+static Task<int> Sequential(EventLoop& loop, int count)
+{
+    int ok = 0;
+    for (int i = 0; i < count; i++)
+    {
+        LaunchResult r = co_await Launch(loop, g_script, { "-ExitCode", "0" });
+        ok += r.outcome == LaunchOutcome::Completed && r.stats.exitCode == 0;
+    }
+    co_return ok;
+}
+
+static void TestNoAllocationPerAwait(void)
+{
+    EventLoop loop;
+    Task<int> task = Sequential(loop, 50);
+    size_t before = g_allocations;
+    CHECK(loop.Run(task));
+    CHECK(g_allocations == before);
+    CHECK(task.Result() == 50);
+}
+
+//--------------------------------------------------------------------------
+// STRUCTURED CONCURRENCY
+//--------------------------------------------------------------------------
+#define MATRIX_ROWS 12
+#define MATRIX_COLS 10
+
+static Task<uint32_t> MatrixJob(EventLoop& loop, int row, int col)
+{
+    char rowText[8], code[8];
+    snprintf(rowText, sizeof(rowText), "%d", row);
+    snprintf(code, sizeof(code), "%d", (row * MATRIX_COLS + col) % 11);
+    LaunchResult r =
+        co_await Launch(loop, g_script, { "-Row", rowText, "-SleepMs", "10", "-ExitCode", code });
+    co_return r.outcome == LaunchOutcome::Completed ? r.stats.exitCode : 0xFFFFFFFFu;
+}
+
+// More jobs than run slots: the rest wait their turn, all complete
+static void TestWhenAllMatrix(void)
+{
+    EventLoop loop(8);
+    Task<uint32_t> jobs[MATRIX_ROWS * MATRIX_COLS];
+    for (int r = 0; r < MATRIX_ROWS; r++)
+    {
+        for (int c = 0; c < MATRIX_COLS; c++)
+            jobs[r * MATRIX_COLS + c] = MatrixJob(loop, r, c);
+    }
+    Task<void> all = AwaitAll(jobs, MATRIX_ROWS * MATRIX_COLS);
+    size_t before = g_allocations;
+    CHECK(loop.Run(all));
+    CHECK(g_allocations == before);
+
+    int wrong = 0;
+    for (int i = 0; i < MATRIX_ROWS * MATRIX_COLS; i++)
+    {
+        if (!jobs[i].Done() || jobs[i].Result() != (uint32_t)(i % 11))
+            wrong++;
+    }
+    CHECK(wrong == 0);
+    CHECK(PslRunning(loop.Engine()) == 0);
+}
+
+static Task<LaunchResult> LongRun(EventLoop& loop, uint32_t timeoutMillis, CancelToken token)
+{
+    LaunchOptions options;
+    options.timeoutMillis = timeoutMillis;
+    options.token = token;
+    co_return co_await Launch(loop, g_script, { "-SleepMs", "10000" }, options);
+}
+
+static void TestTimeout(void)
+{
+    EventLoop loop;
+    Task<LaunchResult> task = LongRun(loop, 100, CancelToken());
+    uint64_t start = EventLoop::NowMillis();
+    CHECK(loop.Run(task));
+    CHECK(EventLoop::NowMillis() - start < 3000);
+    CHECK(task.Result().outcome == LaunchOutcome::TimedOut);
+    CHECK(task.Result().stats.exitCode == 128 + 9);
+}
+
+static Task<void> CancelLater(EventLoop& loop, CancelSource* source, uint32_t millis)
+{
+    co_await Sleep(loop, millis);
+    source->Cancel();
+}
+
+// Some running, some still waiting for a slot: all end as Cancelled
+static void TestCancelToken(void)
+{
+    EventLoop loop(4);
+    CancelSource source;
+    Task<LaunchResult> jobs[10];
+    for (int i = 0; i < 10; i++)
+        jobs[i] = LongRun(loop, 0, source.Token());
+    // The canceller runs alongside the jobs
+    Task<void> both[2];
+    both[0] = AwaitAll(jobs, 10);
+    both[1] = CancelLater(loop, &source, 100);
+    Task<void> together = AwaitAll(both, 2);
+
+    uint64_t start = EventLoop::NowMillis();
+    CHECK(loop.Run(together));
+    CHECK(EventLoop::NowMillis() - start < 3000);
+    int cancelled = 0;
+    for (int i = 0; i < 10; i++)
+        cancelled += jobs[i].Result().outcome == LaunchOutcome::Cancelled;
+    CHECK(cancelled == 10);
+
+    // Cancelled before it starts: no run at all
+    Task<LaunchResult> late = LongRun(loop, 0, source.Token());
+    CHECK(loop.Run(late));
+    CHECK(late.Result().outcome == LaunchOutcome::Cancelled);
+    CHECK(late.Result().stats.wallMicros == 0);
+}
+
+// CancelAfter bounds the whole group
+static void TestGroupTimeout(void)
+{
+    EventLoop loop(2);
+    CancelSource source;
+    source.CancelAfter(loop, 150);
+    Task<LaunchResult> jobs[4];
+    for (int i = 0; i < 4; i++)
+        jobs[i] = LongRun(loop, 0, source.Token());
+    Task<void> all = AwaitAll(jobs, 4);
+    uint64_t start = EventLoop::NowMillis();
+    CHECK(loop.Run(all));
+    uint64_t elapsed = EventLoop::NowMillis() - start;
+    CHECK(elapsed >= 150 && elapsed < 3000);
+    CHECK(source.Cancelled());
+    for (int i = 0; i < 4; i++)
+        CHECK(jobs[i].Result().outcome == LaunchOutcome::Cancelled);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argv[1][0] != '/')
+    {
+        fprintf(stderr, "usage: test_coro <absolute interpreter path>\n");
+        return 2;
+    }
+    setenv("PS_LAUNCHER_INTERPRETER", argv[1], 1);
+    snprintf(g_dir, sizeof(g_dir), "/tmp/psl-coro-XXXXXX");
+    if (!mkdtemp(g_dir))
+        return 2;
+
+    // Engine runs are journaled: keep the journal and metrics in here
+    char state[512];
+    snprintf(state, sizeof(state), "%s/state", g_dir);
+    setenv("XDG_STATE_HOME", state, 1);
+    snprintf(g_script, sizeof(g_script), "%s/job.ps1", g_dir);
+    FILE* f = fopen(g_script, "w");
+    if (!f)
+        return 2;
+    fclose(f);
+
+    RUN_TEST(TestTaskChain);
+    RUN_TEST(TestSleepOrder);
+    RUN_TEST(TestLaunchCapture);
+    RUN_TEST(TestLaunchFailure);
+    RUN_TEST(TestNoAllocationPerAwait);
+    RUN_TEST(TestWhenAllMatrix);
+    RUN_TEST(TestTimeout);
+    RUN_TEST(TestCancelToken);
+    RUN_TEST(TestGroupTimeout);
+
+    char cmd[600];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", g_dir);
+    if (system(cmd) != 0)
+        return 1;
+    return TEST_SUMMARY();
+}
@@ -0,0 +1,147 @@
+//--------------------------------------------------------------------------
+// TESTS: cron.c
+//--------------------------------------------------------------------------
+#include "cron.h"
+#include "testing.h"
+
+// Local minute of a calendar date and time
+static int64_t At(int64_t year, unsigned month, unsigned day, unsigned hour, unsigned minute)
+{
+    return CronDaysFromCivil(year, month, day) * 1440 + hour * 60 + minute;
+}
+
+static bool Parse(const PSCHAR* minute, const PSCHAR* hour, const PSCHAR* day,
+                  const PSCHAR* month, const PSCHAR* weekday, CronExpr* expr)
+{
+    const PSCHAR* fields[CRON_FIELDS] = { minute, hour, day, month, weekday };
+    return CronParse((PSCHAR* const*)fields, expr);
+}
+
+// Next match after from, or -1
+static int64_t Next(const CronExpr* expr, int64_t from)
+{
+    int64_t next;
+    return CronNext(expr, from, &next) ? next : -1;
+}
+
+static void TestCalendar(void)
+{
+    CHECK(CronDaysFromCivil(1970, 1, 1) == 0);
+    CHECK(CronDaysFromCivil(2000, 3, 1) == 11017);
+    CHECK(CronDaysFromCivil(1969, 12, 31) == -1);
+
+    int64_t year;
+    unsigned month, day;
+    for (int64_t d = -800000; d < 800000; d += 997)
+    {
+        CronCivilFromDays(d, &year, &month, &day);
+        CHECK(CronDaysFromCivil(year, month, day) == d);
+    }
+    CronCivilFromDays(CronDaysFromCivil(2024, 2, 29), &year, &month, &day);
+    CHECK(year == 2024 && month == 2 && day == 29);
+}
+
+static void TestParse(void)
+{
+    CronExpr e;
+    CHECK(Parse(PS_T("*/15"), PS_T("8-18/2"), PS_T("*"), PS_T("*"), PS_T("mon-fri"), &e));
+    CHECK(e.minutes == ((1ull << 0) | (1ull << 15) | (1ull << 30) | (1ull << 45)));
+    CHECK(e.hours == ((1u << 8) | (1u << 10) | (1u << 12) | (1u << 14) | (1u << 16) | (1u << 18)));
+    CHECK(e.weekdays == 0x3E && e.anyDay && !e.anyWeekday);
+
+    CHECK(Parse(PS_T("0"), PS_T("0"), PS_T("1,15"), PS_T("JAN,jul"), PS_T("7"), &e));
+    CHECK(e.days == ((1u << 1) | (1u << 15)));
+    CHECK(e.months == ((1u << 1) | (1u << 7)));
+    CHECK(e.weekdays == 1);                   // 7 is Sunday
+
+    CHECK(Parse(PS_T("5/20"), PS_T("*"), PS_T("*"), PS_T("*"), PS_T("*"), &e));
+    CHECK(e.minutes == ((1ull << 5) | (1ull << 25) | (1ull << 45)));
+
+    CHECK(!Parse(PS_T("60"), PS_T("*"), PS_T("*"), PS_T("*"), PS_T("*"), &e));
+    CHECK(!Parse(PS_T("*"), PS_T("24"), PS_T("*"), PS_T("*"), PS_T("*"), &e));
+    CHECK(!Parse(PS_T("*"), PS_T("*"), PS_T("0"), PS_T("*"), PS_T("*"), &e));
+    CHECK(!Parse(PS_T("*"), PS_T("*"), PS_T("*"), PS_T("13"), PS_T("*"), &e));
+    CHECK(!Parse(PS_T("*/0"), PS_T("*"), PS_T("*"), PS_T("*"), PS_T("*"), &e));
+    CHECK(!Parse(PS_T("9-3"), PS_T("*"), PS_T("*"), PS_T("*"), PS_T("*"), &e));
+    CHECK(!Parse(PS_T("1,"), PS_T("*"), PS_T("*"), PS_T("*"), PS_T("*"), &e));
+    CHECK(!Parse(PS_T("*"), PS_T("*"), PS_T("*"), PS_T("*"), PS_T("fun"), &e));
+    CHECK(!Parse(PS_T("99999999999"), PS_T("*"), PS_T("*"), PS_T("*"), PS_T("*"), &e));
+
+    CHECK(CronParseMacro(PS_T("@Daily"), &e) && e.minutes == 1 && e.hours == 1);
+    CHECK(CronParseMacro(PS_T("@weekly"), &e) && e.weekdays == 1 && !e.anyWeekday);
+    CHECK(!CronParseMacro(PS_T("@reboot"), &e));
+}
+
+static void TestNext(void)
+{
+    CronExpr e;
+    int64_t from = At(2024, 3, 15, 10, 7);      // Friday
+
+    CHECK(Parse(PS_T("*/15"), PS_T("*"), PS_T("*"), PS_T("*"), PS_T("*"), &e));
+    CHECK(Next(&e, from) == At(2024, 3, 15, 10, 15));
+    CHECK(Next(&e, At(2024, 3, 15, 10, 45)) == At(2024, 3, 15, 11, 0));
+
+    // Strictly after: the current minute never matches again
+    CHECK(Parse(PS_T("7"), PS_T("10"), PS_T("*"), PS_T("*"), PS_T("*"), &e));
+    CHECK(Next(&e, from) == At(2024, 3, 16, 10, 7));
+
+    // Weekdays only: Friday evening goes to Monday
+    CHECK(Parse(PS_T("30"), PS_T("9"), PS_T("*"), PS_T("*"), PS_T("1-5"), &e));
+    CHECK(Next(&e, from) == At(2024, 3, 18, 9, 30));
+
+    // Month boundaries, leap days and year ends
+    CHECK(Parse(PS_T("0"), PS_T("0"), PS_T("31"), PS_T("*"), PS_T("*"), &e));
+    CHECK(Next(&e, from) == At(2024, 3, 31, 0, 0));
+    CHECK(Next(&e, At(2024, 3, 31, 0, 0)) == At(2024, 5, 31, 0, 0));
+    CHECK(Parse(PS_T("0"), PS_T("12"), PS_T("29"), PS_T("2"), PS_T("*"), &e));
+    CHECK(Next(&e, from) == At(2028, 2, 29, 12, 0));
+    CHECK(CronParseMacro(PS_T("@yearly"), &e));
+    CHECK(Next(&e, from) == At(2025, 1, 1, 0, 0));
+
+    // Both day fields restricted: either one matches
+    CHECK(Parse(PS_T("0"), PS_T("0"), PS_T("1"), PS_T("*"), PS_T("sun"), &e));
+    CHECK(Next(&e, from) == At(2024, 3, 17, 0, 0));
+    CHECK(Next(&e, At(2024, 3, 31, 0, 0)) == At(2024, 4, 1, 0, 0));
+
+    // Never: 30 February
+    CHECK(Parse(PS_T("0"), PS_T("0"), PS_T("30"), PS_T("2"), PS_T("*"), &e));
+    CHECK(Next(&e, from) == -1);
+
+    // Before 1970 the calendar still works
+    CHECK(Parse(PS_T("0"), PS_T("0"), PS_T("1"), PS_T("1"), PS_T("*"), &e));
+    CHECK(Next(&e, At(1969, 6, 1, 0, 0)) == At(1970, 1, 1, 0, 0));
+}
+
+static void TestNextMatchesBruteForce(void)
+{
+    // Every minute of a month against a plain field-by-field check
+    CronExpr e;
+    CHECK(Parse(PS_T("5,35"), PS_T("*/3"), PS_T("10-20"), PS_T("*"), PS_T("tue,thu"), &e));
+    int64_t start = At(2023, 12, 25, 0, 0);
+    int64_t expected = -1;
+    for (int64_t t = start + 60 * 24 * 40; t > start; t--)
+    {
+        int64_t days = t / 1440;
+        int64_t year;
+        unsigned month, day;
+        CronCivilFromDays(days, &year, &month, &day);
+        unsigned weekday = (unsigned)((days + 4) % 7);
+        unsigned minute = (unsigned)(t % 60);
+        unsigned hour = (unsigned)(t % 1440 / 60);
+        bool match = (minute == 5 || minute == 35) && hour % 3 == 0 &&
+                     ((day >= 10 && day <= 20) || weekday == 2 || weekday == 4);
+        if (expected != -1)
+            CHECK(Next(&e, t) == expected);
+        if (match)
+            expected = t;
+    }
+}
+
+int main(void)
+{
+    RUN_TEST(TestCalendar);
+    RUN_TEST(TestParse);
+    RUN_TEST(TestNext);
+    RUN_TEST(TestNextMatchesBruteForce);
+    return TEST_SUMMARY();
+}
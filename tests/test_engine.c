@@ -0,0 +1,572 @@
+//--------------------------------------------------------------------------
+// TESTS: engine.c C API against the stand-in interpreter (POSIX)
+//--------------------------------------------------------------------------
+// Usage: test_engine <interpreter>
+// The interpreter path goes to PS_LAUNCHER_INTERPRETER before each engine
+// is created; scripts are empty files in a scratch directory.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "engine.h"
+#include "platform.h"
+#include "testing.h"
+
+#define CONCURRENT_RUNS 200
+
+static char g_dir[400];
+static char g_script[512];
+
+typedef struct Captured
+{
+    char text[4096];
+    size_t len;
+    uint64_t bytes;
+} Captured;
+
+static void Capture(void* ctx, PslRun* run, const void* data, size_t size)
+{
+    (void)run;
+    Captured* c = (Captured*)ctx;
+    c->bytes += size;
+    size_t room = sizeof(c->text) - 1 - c->len;
+    size_t n = size < room ? size : room;
+    memcpy(c->text + c->len, data, n);
+    c->len += n;
+    c->text[c->len] = 0;
+}
+
+static void TestBuildCommand(void)
+{
+    PslEngine* e = PslCreate(0);
+    CHECK(e != NULL);
+    char out[2048];
+
+    const char* params[] = { "-Name", "John Doe" };
+    PslCommand cmd = { g_script, params, 2, NULL, 0, NULL, NULL };
+    CHECK(PslBuildCommand(e, &cmd, out, sizeof(out)) == PSL_OK);
+    CHECK(strstr(out, "-File") != NULL);
+    CHECK(strstr(out, g_script) != NULL);
+    CHECK(strstr(out, "\"John Doe\"") != NULL);
+    CHECK(PslBuildCommand(e, &cmd, out, 8) == PSL_TOO_LONG);
+
+    // SECURITY CHECK: The launcher's parameter policy applies here too
+    const char* bad[] = { "-Name", "x; Remove-Item *" };
+    PslCommand blocked = { g_script, bad, 2, NULL, 0, NULL, NULL };
+    CHECK(PslBuildCommand(e, &blocked, out, sizeof(out)) == PSL_BLOCKED);
+
+    PslCommand missing = { "/nonexistent/nowhere.ps1", NULL, 0, NULL, 0, NULL, NULL };
+    CHECK(PslBuildCommand(e, &missing, out, sizeof(out)) == PSL_NOT_FOUND);
+    PslRun* run;
+    CHECK(PslStart(e, &missing, NULL, &run) == PSL_NOT_FOUND && run == NULL);
+    CHECK(PslRunning(e) == 0);
+    PslDestroy(e);
+}
+
+static void TestRunSync(void)
+{
+    PslEngine* e = PslCreate(0);
+    const char* params[] = { "-ExitCode", "42" };
+    PslCommand cmd = { g_script, params, 2, NULL, 0, NULL, NULL };
+    Captured c = { { 0 }, 0, 0 };
+    PslStats stats;
+    CHECK(PslRunSync(e, &cmd, Capture, &c, &stats) == PSL_OK);
+    char expected[700];
+    snprintf(expected, sizeof(expected), "[%s]\n[-ExitCode]\n[42]\n", g_script);
+    CHECK_STR(c.text, expected);
+    CHECK(stats.exitCode == 42);
+    CHECK(stats.cancelled == 0);
+    CHECK(stats.outputBytes == c.bytes);
+    CHECK(PslRunning(e) == 0);
+    PslDestroy(e);
+}
+
+typedef struct Batch
+{
+    Captured out[CONCURRENT_RUNS];
+    uint32_t exitCodes[CONCURRENT_RUNS];
+    int finished;
+} Batch;
+
+static Batch g_batch;
+
+static void BatchOutput(void* ctx, PslRun* run, const void* data, size_t size)
+{
+    (void)run;
+    Capture(&g_batch.out[(intptr_t)ctx], NULL, data, size);
+}
+
+static void BatchExit(void* ctx, PslRun* run, const PslStats* stats)
+{
+    (void)run;
+    g_batch.exitCodes[(intptr_t)ctx] = stats->exitCode;
+    g_batch.finished++;
+}
+
+static void TestManyConcurrent(void)
+{
+    PslEngine* e = PslCreate(CONCURRENT_RUNS);
+    char tags[CONCURRENT_RUNS][16], codes[CONCURRENT_RUNS][16];
+    int started = 0;
+    for (intptr_t i = 0; i < CONCURRENT_RUNS; i++)
+    {
+        snprintf(tags[i], sizeof(tags[i]), "run-%d", (int)i);
+        snprintf(codes[i], sizeof(codes[i]), "%d", (int)(i % 7));
+        const char* params[] = { tags[i], "-SleepMs", "20", "-ExitCode", codes[i] };
+        PslCommand cmd = { g_script, params, 5, NULL, 0, NULL, NULL };
+        PslCallbacks callbacks = { BatchOutput, BatchExit, (void*)i };
+        PslRun* run;
+        g_batch.exitCodes[i] = 0xFFFFFFFFu;
+        if (PslStart(e, &cmd, &callbacks, &run) == PSL_OK)
+            started++;
+    }
+    CHECK(started == CONCURRENT_RUNS);
+    CHECK(PslRunning(e) == CONCURRENT_RUNS);
+
+    while (PslRunning(e) > 0)
+        PslPoll(e, 1000);
+    CHECK(g_batch.finished == CONCURRENT_RUNS);
+    int wrong = 0;
+    for (int i = 0; i < CONCURRENT_RUNS; i++)
+    {
+        char line[32];
+        snprintf(line, sizeof(line), "[run-%d]\n", i);
+        if (g_batch.exitCodes[i] != (uint32_t)(i % 7) || !strstr(g_batch.out[i].text, line))
+            wrong++;
+    }
+    CHECK(wrong == 0);
+    PslDestroy(e);
+}
+
+static void TestStats(void)
+{
+    PslEngine* e = PslCreate(0);
+    PslStats stats;
+
+    const char* sleep[] = { "-SleepMs", "100" };
+    PslCommand sleepCmd = { g_script, sleep, 2, NULL, 0, NULL, NULL };
+    CHECK(PslRunSync(e, &sleepCmd, NULL, NULL, &stats) == PSL_OK);
+    CHECK(stats.wallMicros >= 100000);
+    CHECK(stats.peakMemoryBytes > 0);
+
+    // A fixed amount of CPU work, so a loaded machine only makes it slower
+    const char* busy[] = { "-CpuMs", "200" };
+    PslCommand busyCmd = { g_script, busy, 2, NULL, 0, NULL, NULL };
+    CHECK(PslRunSync(e, &busyCmd, NULL, NULL, &stats) == PSL_OK);
+    CHECK(stats.userMicros + stats.kernelMicros >= 100000);
+
+    // A megabyte is far more than the pipe holds: it must be drained as it comes
+    const char* emit[] = { "-EmitBytes", "1000000" };
+    PslCommand emitCmd = { g_script, emit, 2, NULL, 0, NULL, NULL };
+    CHECK(PslRunSync(e, &emitCmd, NULL, NULL, &stats) == PSL_OK);
+    CHECK(stats.outputBytes > 1000000);
+    CHECK(stats.exitCode == 0);
+    PslDestroy(e);
+}
+
+static void TestCancel(void)
+{
+    PslEngine* e = PslCreate(0);
+    const char* params[] = { "-SleepMs", "10000" };
+    PslCommand cmd = { g_script, params, 2, NULL, 0, NULL, NULL };
+    PslRun* run;
+    CHECK(PslStart(e, &cmd, NULL, &run) == PSL_OK);
+    CHECK(PslRunPid(run) != 0);
+    CHECK(PslPoll(e, 50) == 0);
+    CHECK(PslCancel(e, run));
+
+    PslStats stats;
+    PslWait(e, run, &stats);
+    CHECK(stats.cancelled == 1);
+    CHECK(stats.exitCode == 128 + 9);
+    CHECK(stats.wallMicros < 5000000);
+    CHECK(!PslCancel(e, run));
+    PslDestroy(e);
+}
+
+static void TestEnvironmentAndDirectory(void)
+{
+    PslEngine* e = PslCreate(0);
+    Captured c = { { 0 }, 0, 0 };
+    PslStats stats;
+
+    // A relative script resolves against the run's directory
+    const char* params[] = { "-PrintEnv", "PSL_TEST_TAG" };
+    const char* env[] = { "PSL_TEST_TAG=embedded" };
+    PslCommand cmd = { "job.ps1", params, 2, env, 1, g_dir, NULL };
+    CHECK(PslRunSync(e, &cmd, Capture, &c, &stats) == PSL_OK);
+    CHECK(strstr(c.text, "[PSL_TEST_TAG=embedded]") != NULL);
+    CHECK(strncmp(c.text, "[job.ps1]\n", 9) == 0);
+
+    // ... and so does one under a relative directory, opened exactly once
+    char cwd[400];
+    CHECK(getcwd(cwd, sizeof(cwd)) != NULL);
+    CHECK(chdir("/tmp") == 0);
+    Captured r = { { 0 }, 0, 0 };
+    PslCommand nested = { "job.ps1", NULL, 0, NULL, 0, g_dir + strlen("/tmp/"), NULL };
+    CHECK(PslRunSync(e, &nested, Capture, &r, &stats) == PSL_OK);
+    CHECK(stats.exitCode == 0);
+    CHECK(strncmp(r.text, "[job.ps1]\n", 9) == 0);
+    CHECK(chdir(cwd) == 0);
+
+    const char* empty[] = { "" };
+    PslCommand badEnv = { g_script, NULL, 0, empty, 1, NULL, NULL };
+    PslRun* run;
+    CHECK(PslStart(e, &badEnv, NULL, &run) == PSL_BLOCKED);
+    PslDestroy(e);
+}
+
+// Runs are children of the engine's run, or of the run named as parent
+static void TestRunIds(void)
+{
+    PslEngine* e = PslCreate(0);
+    char engineId[PSL_RUN_ID_CHARS + 1], firstId[PSL_RUN_ID_CHARS + 1], line[128];
+    PslEngineId(e, engineId);
+    CHECK(strlen(engineId) == PSL_RUN_ID_CHARS);
+
+    const char* params[] = { "-PrintEnv", "PS_LAUNCHER_RUN_ID", "-PrintEnv", "PS_LAUNCHER_PARENT_ID" };
+    PslCommand cmd = { g_script, params, 4, NULL, 0, NULL, NULL };
+    Captured c = { { 0 }, 0, 0 };
+    PslCallbacks callbacks = { Capture, NULL, &c };
+    PslRun* run;
+    CHECK(PslStart(e, &cmd, &callbacks, &run) == PSL_OK);
+    PslRunId(run, firstId);
+    PslWait(e, run, NULL);
+    snprintf(line, sizeof(line), "[PS_LAUNCHER_RUN_ID=%s]", firstId);
+    CHECK(strstr(c.text, line) != NULL);
+    snprintf(line, sizeof(line), "[PS_LAUNCHER_PARENT_ID=%s]", engineId);
+    CHECK(strstr(c.text, line) != NULL);
+    CHECK(strcmp(firstId, engineId) > 0);
+
+    // A step that follows the first
+    Captured next = { { 0 }, 0, 0 };
+    cmd.parent = firstId;
+    CHECK(PslRunSync(e, &cmd, Capture, &next, NULL) == PSL_OK);
+    snprintf(line, sizeof(line), "[PS_LAUNCHER_PARENT_ID=%s]", firstId);
+    CHECK(strstr(next.text, line) != NULL);
+
+    cmd.parent = "not a run id";
+    CHECK(PslStart(e, &cmd, NULL, &run) == PSL_BLOCKED);
+    PslDestroy(e);
+}
+
+typedef struct Chain
+{
+    PslEngine* engine;
+    int remaining;
+    int finished;
+} Chain;
+
+static void ChainExit(void* ctx, PslRun* run, const PslStats* stats)
+{
+    (void)run;
+    (void)stats;
+    Chain* chain = (Chain*)ctx;
+    chain->finished++;
+    if (chain->remaining-- > 0)
+    {
+        PslCommand cmd = { g_script, NULL, 0, NULL, 0, NULL, NULL };
+        PslCallbacks callbacks = { NULL, ChainExit, chain };
+        PslRun* next;
+        PslStart(chain->engine, &cmd, &callbacks, &next);
+    }
+}
+
+static void TestLimitAndCallbackStarts(void)
+{
+    PslEngine* e = PslCreate(2);
+    const char* params[] = { "-SleepMs", "50" };
+    PslCommand cmd = { g_script, params, 2, NULL, 0, NULL, NULL };
+    PslRun* a;
+    PslRun* b;
+    PslRun* c;
+    CHECK(PslStart(e, &cmd, NULL, &a) == PSL_OK);
+    CHECK(PslStart(e, &cmd, NULL, &b) == PSL_OK);
+    CHECK(PslStart(e, &cmd, NULL, &c) == PSL_BUSY);
+    while (PslRunning(e) > 0)
+        PslPoll(e, PSL_WAIT_FOREVER);
+
+    // Exit callbacks start the next run; the poll loop picks each one up
+    Chain chain = { e, 4, 0 };
+    PslCallbacks callbacks = { NULL, ChainExit, &chain };
+    CHECK(PslStart(e, &cmd, &callbacks, &a) == PSL_OK);
+    while (PslRunning(e) > 0)
+        PslPoll(e, PSL_WAIT_FOREVER);
+    CHECK(chain.finished == 5);
+    PslDestroy(e);
+}
+
+static void TestAdaptiveLimit(void)
+{
+    PslEngine* e = PslCreate(4);
+    CHECK(PslRunLimit(e) == 4);
+    PslSetAdaptive(e, true);
+    uint32_t limit = PslRunLimit(e);
+    CHECK(limit >= 1 && limit <= 4);
+
+    // A batch that starts what it can after every poll
+    const char* params[] = { "-SleepMs", "20" };
+    PslCommand cmd = { g_script, params, 2, NULL, 0, NULL, NULL };
+    int toStart = 24, busy = 0;
+    while (toStart > 0 || PslRunning(e) > 0)
+    {
+        PslRun* run;
+        while (toStart > 0)
+        {
+            PslStatus status = PslStart(e, &cmd, NULL, &run);
+            if (status == PSL_BUSY)
+            {
+                busy++;
+                break;
+            }
+            CHECK(status == PSL_OK);
+            toStart--;
+        }
+        CHECK(PslRunning(e) <= 4);
+        PslPoll(e, PSL_WAIT_FOREVER);
+    }
+    CHECK(busy > 0 && PslRunLimit(e) >= 1 && PslRunLimit(e) <= 4);
+
+    PslSetAdaptive(e, false);
+    CHECK(PslRunLimit(e) == 4);
+    PslDestroy(e);
+}
+
+typedef struct Sequence
+{
+    char started[8];
+    int count;
+} Sequence;
+
+typedef struct Tag
+{
+    Sequence* sequence;
+    char name;
+} Tag;
+
+// One run at a time, so the order of exits is the order of starts
+static void Record(void* ctx, PslRun* run, const PslStats* stats)
+{
+    (void)run;
+    (void)stats;
+    Tag* tag = (Tag*)ctx;
+    if (tag->sequence->count < 7)
+        tag->sequence->started[tag->sequence->count++] = tag->name;
+}
+
+static void TestBatch(void)
+{
+    // HISTORY: b.ps1 is long, a.ps1 short, c.ps1 unknown and so typical
+    char journalDir[600], journal[700], a[512], b[512], c[512];
+    snprintf(journalDir, sizeof(journalDir), "%s/state/ps-launcher", g_dir);
+    snprintf(journal, sizeof(journal), "%s/ps-launcher.runs", journalDir);
+    snprintf(a, sizeof(a), "%s/a.ps1", g_dir);
+    snprintf(b, sizeof(b), "%s/b.ps1", g_dir);
+    snprintf(c, sizeof(c), "%s/c.ps1", g_dir);
+    mkdir(journalDir, 0700);            // Earlier tests' runs may have made it
+    FILE* f = fopen(journal, "w");
+    CHECK(f != NULL);
+    fprintf(f, "1000\t1000\t0\tcompleted\t%s\n", a);
+    fprintf(f, "1000\t900000\t0\tcompleted\t%s\n", b);
+    fprintf(f, "1000\t200000\t0\tcompleted\t%s/d.ps1\n", g_dir);
+    fclose(f);
+    const char* scripts[] = { a, b, c };
+    for (int i = 0; i < 3; i++)
+    {
+        f = fopen(scripts[i], "w");
+        CHECK(f != NULL);
+        fclose(f);
+    }
+
+    PslEngine* e = PslCreate(1);
+    Sequence sequence;
+    Tag tags[4] = { { &sequence, 'a' }, { &sequence, 'b' }, { &sequence, 'c' }, { &sequence, 'A' } };
+    PslJob jobs[4];
+    PslJobResult results[4];
+    memset(jobs, 0, sizeof(jobs));
+    for (int i = 0; i < 3; i++)
+    {
+        jobs[i].command.script = scripts[i];
+        jobs[i].callbacks.exit = Record;
+        jobs[i].callbacks.ctx = &tags[i];
+    }
+
+    memset(&sequence, 0, sizeof(sequence));
+    CHECK(PslRunBatch(e, jobs, 3, PSL_ORDER_HISTORY, results) == PSL_OK);
+    CHECK(strcmp(sequence.started, "bca") == 0);
+    CHECK(results[0].status == PSL_OK && results[1].status == PSL_OK && results[2].status == PSL_OK);
+
+    // JOURNAL: The engine's runs are history for the next batch
+    char line[1024], expected[600];
+    snprintf(expected, sizeof(expected), "\t%s\n", c);
+    int journaled = 0;
+    f = fopen(journal, "r");
+    while (f && fgets(line, sizeof(line), f))
+    {
+        size_t len = strlen(line), tail = strlen(expected);
+        journaled += strstr(line, "\tcompleted\t") && len > tail && strcmp(line + len - tail, expected) == 0;
+    }
+    if (f)
+        fclose(f);
+    CHECK(journaled == 1);
+
+    memset(&sequence, 0, sizeof(sequence));
+    CHECK(PslRunBatch(e, jobs, 3, PSL_ORDER_FIFO, results) == PSL_OK);
+    CHECK(strcmp(sequence.started, "abc") == 0);
+
+    // FAILURE: a fails, so b and c after it are skipped; A alone still runs
+    static const uint32_t after0[] = { 0 }, after1[] = { 1 };
+    const char* fail[] = { "-ExitCode", "1" };
+    jobs[0].command.params = fail;
+    jobs[0].command.paramCount = 2;
+    jobs[1].after = after0;
+    jobs[1].afterCount = 1;
+    jobs[2].after = after1;
+    jobs[2].afterCount = 1;
+    jobs[3].command.script = a;
+    jobs[3].callbacks.exit = Record;
+    jobs[3].callbacks.ctx = &tags[3];
+    memset(&sequence, 0, sizeof(sequence));
+    CHECK(PslRunBatch(e, jobs, 4, PSL_ORDER_HISTORY, results) == PSL_OK);
+    CHECK(strcmp(sequence.started, "aA") == 0);
+    CHECK(results[0].status == PSL_OK && results[0].stats.exitCode == 1);
+    CHECK(results[1].status == PSL_SKIPPED && results[2].status == PSL_SKIPPED);
+    CHECK(results[3].status == PSL_OK && results[3].stats.exitCode == 0);
+
+    // A job that cannot start fails the same way
+    jobs[0].command.script = "/no/such/script.ps1";
+    jobs[0].command.paramCount = 0;
+    CHECK(PslRunBatch(e, jobs, 3, PSL_ORDER_FIFO, results) == PSL_OK);
+    CHECK(results[0].status == PSL_NOT_FOUND && results[1].status == PSL_SKIPPED);
+
+    // CYCLE: Refused before anything starts
+    static const uint32_t after2[] = { 2 };
+    jobs[0].command.script = a;
+    jobs[0].after = after2;
+    jobs[0].afterCount = 1;
+    memset(&sequence, 0, sizeof(sequence));
+    CHECK(PslRunBatch(e, jobs, 3, PSL_ORDER_HISTORY, results) == PSL_BLOCKED);
+    CHECK(sequence.count == 0 && PslRunning(e) == 0);
+    PslDestroy(e);
+
+    for (int i = 0; i < 3; i++)
+        unlink(scripts[i]);
+}
+
+typedef struct Span
+{
+    uint64_t start;
+    uint64_t end;
+} Span;
+
+// Exit time, and start time from the run's wall time
+static void Measure(void* ctx, PslRun* run, const PslStats* stats)
+{
+    (void)run;
+    Span* span = (Span*)ctx;
+    span->end = PlatMonotonicNanos();
+    span->start = span->end - stats->wallMicros * 1000;
+}
+
+// Most spans of first..first+count under way at once, within slack
+static int MostAtOnce(const Span* spans, int first, int count)
+{
+    const uint64_t slack = 30000000;
+    int most = 0;
+    for (int i = first; i < first + count; i++)
+    {
+        int overlapping = 0;
+        for (int j = first; j < first + count; j++)
+            overlapping += spans[j].start <= spans[i].start + slack && spans[j].end > spans[i].start + slack;
+        most = overlapping > most ? overlapping : most;
+    }
+    return most;
+}
+
+static void TestBatchResources(void)
+{
+    // Three jobs on db (limit 1), four on share (limit 2), two on a tag
+    // with no limit: db jobs one at a time, share jobs two, the rest freely
+    PslEngine* e = PslCreate(8);
+    CHECK(PslSetResourceLimit(e, "db", 1));
+    CHECK(PslSetResourceLimit(e, "SHARE", 2));
+    CHECK(!PslSetResourceLimit(e, "db", 0));
+    static const char* db[] = { "db" };
+    static const char* share[] = { "share" };
+    static const char* unlimited[] = { "scratch" };
+    static const char* sleep[] = { "-SleepMs", "150" };
+    PslJob jobs[9];
+    PslJobResult results[9];
+    Span spans[9];
+    memset(jobs, 0, sizeof(jobs));
+    for (int i = 0; i < 9; i++)
+    {
+        jobs[i].command.script = g_script;
+        jobs[i].command.params = sleep;
+        jobs[i].command.paramCount = 2;
+        jobs[i].callbacks.exit = Measure;
+        jobs[i].callbacks.ctx = &spans[i];
+        jobs[i].resources = i < 3 ? db : i < 7 ? share : unlimited;
+        jobs[i].resourceCount = 1;
+    }
+    CHECK(PslRunBatch(e, jobs, 9, PSL_ORDER_FIFO, results) == PSL_OK);
+    for (int i = 0; i < 9; i++)
+        CHECK(results[i].status == PSL_OK && results[i].stats.exitCode == 0);
+    CHECK(MostAtOnce(spans, 0, 3) == 1);
+    CHECK(MostAtOnce(spans, 3, 4) == 2);
+    CHECK(MostAtOnce(spans, 7, 2) == 2);
+    CHECK(PslRunning(e) == 0);
+
+    // More tags than a job holds: refused before anything starts
+    static const char* many[] = { "db", "share", "a", "b", "c", "d", "e", "f", "g" };
+    for (int i = 2; i < 9; i++)
+        CHECK(PslSetResourceLimit(e, many[i], 1));
+    jobs[0].resources = many;
+    jobs[0].resourceCount = 9;
+    CHECK(PslRunBatch(e, jobs, 9, PSL_ORDER_FIFO, results) == PSL_BLOCKED);
+    CHECK(PslRunning(e) == 0);
+    PslDestroy(e);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argv[1][0] != '/')
+    {
+        fprintf(stderr, "usage: test_engine <absolute interpreter path>\n");
+        return 2;
+    }
+    setenv("PS_LAUNCHER_INTERPRETER", argv[1], 1);
+    snprintf(g_dir, sizeof(g_dir), "/tmp/psl-engine-XXXXXX");
+    if (!mkdtemp(g_dir))
+        return 2;
+
+    // Runs are journaled: keep the journal and metrics in the scratch directory
+    char state[512];
+    snprintf(state, sizeof(state), "%s/state", g_dir);
+    setenv("XDG_STATE_HOME", state, 1);
+    snprintf(g_script, sizeof(g_script), "%s/job.ps1", g_dir);
+    FILE* f = fopen(g_script, "w");
+    if (!f)
+        return 2;
+    fclose(f);
+
+    RUN_TEST(TestBuildCommand);
+    RUN_TEST(TestRunSync);
+    RUN_TEST(TestManyConcurrent);
+    RUN_TEST(TestStats);
+    RUN_TEST(TestCancel);
+    RUN_TEST(TestEnvironmentAndDirectory);
+    RUN_TEST(TestRunIds);
+    RUN_TEST(TestLimitAndCallbackStarts);
+    RUN_TEST(TestAdaptiveLimit);
+    RUN_TEST(TestBatch);
+    RUN_TEST(TestBatchResources);
+
+    char cmd[600];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", g_dir);
+    if (system(cmd) != 0)
+        return 1;
+    return TEST_SUMMARY();
+}
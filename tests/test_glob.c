@@ -0,0 +1,168 @@
+//--------------------------------------------------------------------------
+// TESTS: glob.c (POSIX file system)
+//--------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "glob.h"
+#include "testing.h"
+
+static char g_dir[400];
+static Arena g_arena;
+
+static bool Match(const char* pattern, const char* name)
+{
+    return WildcardMatch(pattern, strlen(pattern), name, strlen(name));
+}
+
+static void MakeDir(const char* name)
+{
+    char path[600];
+    snprintf(path, sizeof(path), "%s/%s", g_dir, name);
+    mkdir(path, 0700);
+}
+
+static void WriteFile(const char* name)
+{
+    char path[600];
+    snprintf(path, sizeof(path), "%s/%s", g_dir, name);
+    FILE* f = fopen(path, "w");
+    if (f)
+        fclose(f);
+}
+
+// Matches collected as "name,name," relative to g_dir, in walk order
+typedef struct Found
+{
+    char text[2048];
+    int count;
+} Found;
+
+static bool OnMatch(void* ctx, const PSCHAR* path, size_t pathLen)
+{
+    Found* f = (Found*)ctx;
+    size_t skip = strlen(g_dir) + 1;
+    if (pathLen > skip)
+    {
+        strncat(f->text, path + skip, pathLen - skip);
+        strcat(f->text, ",");
+    }
+    f->count++;
+    return true;
+}
+
+static bool Has(const Found* f, const char* name)
+{
+    char needle[300];
+    snprintf(needle, sizeof(needle), "%s,", name);
+    for (const char* p = f->text; (p = strstr(p, needle)) != NULL; p++)
+    {
+        if (p == f->text || p[-1] == ',')
+            return true;
+    }
+    return false;
+}
+
+static int Expand(const char* pattern, Found* f)
+{
+    char full[600];
+    snprintf(full, sizeof(full), "%s/%s", g_dir, pattern);
+    memset(f, 0, sizeof(*f));
+    ArenaMark mark = ArenaSave(&g_arena);
+    bool ok = ExpandGlob(&g_arena, full, OnMatch, f);
+    ArenaRestore(&g_arena, mark);
+    return ok ? f->count : -1;
+}
+
+static void TestWildcards(void)
+{
+    CHECK(Match("*.csv", "data.csv"));
+    CHECK(Match("*.csv", ".csv"));
+    CHECK(!Match("*.csv", "data.csv.bak"));
+    CHECK(Match("summary-??.xml", "summary-01.xml"));
+    CHECK(!Match("summary-??.xml", "summary-1.xml"));
+    CHECK(Match("*", ""));
+    CHECK(Match("a*b*c", "aXXbYYbZZc"));
+    CHECK(!Match("a*b*c", "aXXbYY"));
+    CHECK(Match("**", "anything"));
+    // POSIX names are case-sensitive
+    CHECK(!Match("*.CSV", "data.csv"));
+
+    // Backtracking stays linear on inputs that defeat naive recursion
+    char name[4097];
+    memset(name, 'a', 4096);
+    name[4096] = 0;
+    CHECK(!Match("*a*a*a*a*a*a*a*a*b", name));
+}
+
+static void TestExpansion(void)
+{
+    Found f;
+    CHECK(Expand("*.csv", &f) == 2);
+    CHECK(Has(&f, "top.csv") && Has(&f, "other.csv"));
+
+    // "**" matches no directory as well as any depth of them
+    CHECK(Expand("**/*.csv", &f) == 5);
+    CHECK(Has(&f, "top.csv") && Has(&f, "sub/mid.csv") && Has(&f, "sub/deeper/low.csv"));
+    CHECK(Has(&f, "sub/deeper/csvdir/inner.csv"));
+
+    CHECK(Expand("sub/*/low.csv", &f) == 1);
+    CHECK(Has(&f, "sub/deeper/low.csv"));
+
+    // Directories are walked, never matched
+    CHECK(Expand("sub/*", &f) == 2);
+    CHECK(!Has(&f, "sub/deeper"));
+
+    // Without wildcards: the file itself, if it exists
+    CHECK(Expand("notes.txt", &f) == 1);
+    CHECK(Expand("absent.txt", &f) == 0);
+    CHECK(Expand("nosuchdir/*.csv", &f) == 0);
+}
+
+static void TestLinksNotFollowed(void)
+{
+    char target[600], link[600];
+    snprintf(target, sizeof(target), "%s/sub", g_dir);
+    snprintf(link, sizeof(link), "%s/sub/deeper/loop", g_dir);
+    CHECK(symlink(target, link) == 0);
+
+    Found f;
+    CHECK(Expand("**/*.csv", &f) == 5);
+    unlink(link);
+}
+
+int main(void)
+{
+    char cwd[300];
+    if (!getcwd(cwd, sizeof(cwd)))
+        return 1;
+    snprintf(g_dir, sizeof(g_dir), "%s/glob_scratch", cwd);
+
+    char cmd[600];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", g_dir);
+    if (system(cmd) != 0)
+        return 1;
+    mkdir(g_dir, 0700);
+    MakeDir("sub");
+    MakeDir("sub/deeper");
+    MakeDir("sub/deeper/csvdir.csv");
+    MakeDir("sub/deeper/csvdir");
+    WriteFile("top.csv");
+    WriteFile("other.csv");
+    WriteFile("notes.txt");
+    WriteFile("sub/mid.csv");
+    WriteFile("sub/readme.md");
+    WriteFile("sub/deeper/low.csv");
+    WriteFile("sub/deeper/csvdir/inner.csv");
+
+    if (!ArenaInit(&g_arena, ARENA_DEFAULT_RESERVE))
+        return 1;
+    RUN_TEST(TestWildcards);
+    RUN_TEST(TestExpansion);
+    RUN_TEST(TestLinksNotFollowed);
+    ArenaRelease(&g_arena);
+    return TEST_SUMMARY();
+}
@@ -0,0 +1,172 @@
+//--------------------------------------------------------------------------
+// TESTS: governor.c settings, hysteresis and cap; suspending a real tree
+//--------------------------------------------------------------------------
+#include <dirent.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "governor.h"
+#include "testing.h"
+
+static void TestSettings(void)
+{
+    Governor g;
+    CHECK(GovernorParse(&g, "60"));
+    CHECK(g.suspendAbove == 6000 && g.resumeBelow == 3000);
+    CHECK(g.capMillis == GOVERNOR_CAP_SECONDS * 1000ull && GovernorEnabled(&g));
+    CHECK(GovernorParse(&g, "40,10,120"));
+    CHECK(g.suspendAbove == 4000 && g.resumeBelow == 1000 && g.capMillis == 120000);
+    CHECK(GovernorParse(&g, "25,0"));
+
+    CHECK(!GovernorParse(&g, "") && !GovernorEnabled(&g));
+    CHECK(!GovernorParse(&g, "0"));
+    CHECK(!GovernorParse(&g, "101"));
+    CHECK(!GovernorParse(&g, "40,40"));          // Resume below suspend
+    CHECK(!GovernorParse(&g, "40,10,"));
+    CHECK(!GovernorParse(&g, "40%"));
+}
+
+static void TestHysteresis(void)
+{
+    Governor g;
+    CHECK(GovernorParse(&g, "50,20"));
+    uint64_t t = 1000;
+    CHECK(!GovernorUpdate(&g, 4999, t));
+    CHECK(GovernorUpdate(&g, 5000, t += 1000));
+
+    // Between the marks nothing changes; below the lower one only once
+    // the dwell time has passed
+    CHECK(GovernorUpdate(&g, 3000, t += 1000));
+    CHECK(GovernorUpdate(&g, 1000, t += 1000));
+    t += GOVERNOR_DWELL_MS;
+    CHECK(!GovernorUpdate(&g, 1000, t));
+    CHECK(!GovernorUpdate(&g, 4000, t += 1000));
+    CHECK(!GovernorUpdate(&g, 9000, t += 1000));
+    CHECK(GovernorUpdate(&g, 9000, t += GOVERNOR_DWELL_MS) && g.pressure == 9000);
+
+    // Off: never sampled, never pressed
+    Governor off;
+    GovernorParse(&off, "");
+    CHECK(!GovernorCheck(&off, t));
+}
+
+//--------------------------------------------------------------------------
+// PROCESS TREES
+//--------------------------------------------------------------------------
+// Field 3 (state) and 4 (ppid) of /proc/<pid>/stat
+static bool ReadStat(unsigned pid, char* state, unsigned* parent)
+{
+    char path[64], text[512];
+    snprintf(path, sizeof(path), "/proc/%u/stat", pid);
+    FILE* f = fopen(path, "r");
+    if (!f)
+        return false;
+    size_t n = fread(text, 1, sizeof(text) - 1, f);
+    fclose(f);
+    text[n] = 0;
+    char* p = strrchr(text, ')');
+    return p && sscanf(p + 2, "%c %u", state, parent) == 2;
+}
+
+static unsigned FindChild(unsigned parent)
+{
+    DIR* proc = opendir("/proc");
+    struct dirent* d;
+    unsigned found = 0;
+    while (proc && !found && (d = readdir(proc)) != NULL)
+    {
+        char state;
+        unsigned pid = (unsigned)strtoul(d->d_name, NULL, 10), ppid;
+        if (pid && ReadStat(pid, &state, &ppid) && ppid == parent)
+            found = pid;
+    }
+    if (proc)
+        closedir(proc);
+    return found;
+}
+
+// Stopped by signal (T), or in a frozen cgroup (sleeping, but frozen)
+static bool Held(const PlatTree* tree, unsigned pid)
+{
+    char state;
+    unsigned ppid;
+    if (!ReadStat(pid, &state, &ppid))
+        return false;
+    if (tree->handle < 0)
+        return state == 'T';
+    char path[128], text[256];
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", (int)tree->handle);
+    ssize_t n = readlink(path, text, sizeof(text) - 16);
+    if (n <= 0)
+        return false;
+    strcpy(text + n, "/cgroup.events");
+    FILE* f = fopen(text, "r");
+    bool frozen = false;
+    while (f && fgets(text, sizeof(text), f))
+        frozen = frozen || strcmp(text, "frozen 1\n") == 0;
+    if (f)
+        fclose(f);
+    return frozen;
+}
+
+static void TestSuspendTree(void)
+{
+    // A process with a child of its own: the whole tree stops and goes on
+    PlatProcess shell;
+    char cmdline[] = "sh -c \"sleep 30 & exec sleep 30\"";
+    CHECK(PlatSpawn("/bin/sh", cmdline, NULL, &shell));
+    PlatTree tree;
+    CHECK(PlatTreeOpen(&tree, &shell));
+    unsigned child = 0;
+    for (int i = 0; i < 200 && !child; i++)
+    {
+        PlatSleepMillis(10);
+        child = FindChild(shell.pid);
+    }
+    CHECK(child != 0);
+
+    CHECK(PlatTreeSuspend(&tree, true));
+    PlatSleepMillis(50);
+    CHECK(Held(&tree, shell.pid) && Held(&tree, child));
+    CHECK(PlatTreeSuspend(&tree, false));
+    PlatSleepMillis(50);
+    CHECK(!Held(&tree, shell.pid) && !Held(&tree, child));
+    PlatTreeClose(&tree);
+
+    // The governor suspends a bulk run under pressure, and its cap ends that
+    Governor g;
+    CHECK(GovernorParse(&g, "50,20,1"));
+    GovernedRun run;
+    GovernorAttach(&g, &run, &shell, JOB_NORMAL);
+    CHECK(!run.governed);
+    GovernorAttach(&g, &run, &shell, JOB_BULK);
+    CHECK(run.governed);
+    GovernorApply(&g, &run, true, 10000);
+    PlatSleepMillis(50);
+    CHECK(run.since == 10000 && Held(&run.tree, child));
+    GovernorApply(&g, &run, true, 10500);
+    CHECK(run.since == 10000);
+    GovernorApply(&g, &run, true, 11000);
+    PlatSleepMillis(50);
+    CHECK(run.since == 0 && run.exempt && run.suspendedMillis == 1000 && !Held(&run.tree, child));
+    GovernorApply(&g, &run, true, 12000);
+    CHECK(run.since == 0);
+    GovernorRelease(&run);
+    CHECK(!run.governed);
+
+    kill((pid_t)child, SIGKILL);
+    PlatKillProcess(&shell);
+    uint32_t code;
+    PlatWait(&shell, &code);
+}
+
+int main(void)
+{
+    RUN_TEST(TestSettings);
+    RUN_TEST(TestHysteresis);
+    RUN_TEST(TestSuspendTree);
+    return TEST_SUMMARY();
+}
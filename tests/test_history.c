@@ -0,0 +1,106 @@
+//--------------------------------------------------------------------------
+// TESTS: history.c expected durations from journal text
+//--------------------------------------------------------------------------
+#include <string.h>
+
+#include "history.h"
+#include "testing.h"
+
+static Arena g_arena;
+
+static void TestMovingAverage(void)
+{
+    static const char journal[] =
+        "1000\t400000\t0\tcompleted\t01J0000000000000000000000A\t-\t/jobs/nightly.ps1\n"
+        "2000\t800000\t0\tcompleted\t01J0000000000000000000000B\t-\t/jobs/nightly.ps1\n"
+        "3000\t100000\t0\tcompleted\t01J0000000000000000000000C\t-\t/jobs/quick.ps1\n";
+    History h;
+    ArenaRestore(&g_arena, 0);
+    CHECK(HistoryParse(&h, &g_arena, journal, sizeof(journal) - 1));
+    CHECK(h.scripts == 2);
+
+    // A newer run moves the estimate a quarter of the way
+    bool known;
+    CHECK(HistoryEstimate(&h, PS_T("/jobs/nightly.ps1"), &known) == 500000 && known);
+    CHECK(HistoryEstimate(&h, PS_T("/jobs/quick.ps1"), &known) == 100000 && known);
+}
+
+static void TestFileNameAndFallback(void)
+{
+    static const char journal[] =
+        "1000\t300000\t0\tcompleted\t/srv/a.ps1\n"
+        "1000\t100000\t0\tcompleted\t/srv/b.ps1\n"
+        "1000\t900000\t0\tcompleted\t/srv/c.ps1\r\n";
+    History h;
+    ArenaRestore(&g_arena, 0);
+    CHECK(HistoryParse(&h, &g_arena, journal, sizeof(journal) - 1));
+
+    // The older journal format, a carriage return, a file name alone
+    bool known;
+    CHECK(HistoryEstimate(&h, PS_T("/srv/c.ps1"), &known) == 900000 && known);
+    CHECK(HistoryEstimate(&h, PS_T("a.ps1"), &known) == 300000 && known);
+    CHECK(HistoryEstimate(&h, PS_T("/elsewhere/b.ps1"), &known) == 100000 && known);
+
+    // NEVER SEEN: The median script
+    CHECK(HistoryEstimate(&h, PS_T("/srv/new.ps1"), &known) == 300000 && !known);
+}
+
+static void TestOnlyCompletedRuns(void)
+{
+    static const char journal[] =
+        "1000\t0\t0\tup-to-date\t/srv/a.ps1\n"
+        "1000\t5\t1\tcached\t/srv/a.ps1\n"
+        "not a record\n"
+        "1000\t0\t2\tfailed-to-start\t/srv/a.ps1\n";
+    History h;
+    ArenaRestore(&g_arena, 0);
+    CHECK(HistoryParse(&h, &g_arena, journal, sizeof(journal) - 1));
+    CHECK(h.scripts == 0);
+    bool known;
+    CHECK(HistoryEstimate(&h, PS_T("/srv/a.ps1"), &known) == 0 && !known);
+
+    History empty;
+    CHECK(HistoryParse(&empty, &g_arena, "", 0));
+    CHECK(HistoryEstimate(&empty, PS_T("/srv/a.ps1"), &known) == 0 && !known);
+}
+
+static void TestTail(void)
+{
+    // Only the newest HISTORY_LINES lines count: the first run is too old
+    static const char line[] = "1000\t7\t0\tcompleted\t/srv/x.ps1\n";
+    static const char first[] = "1000\t99\t0\tcompleted\t/srv/old.ps1\n";
+    size_t size = sizeof(first) - 1 + HISTORY_LINES * (sizeof(line) - 1);
+    ArenaRestore(&g_arena, 0);
+    char* text = (char*)ArenaAlloc(&g_arena, size);
+    CHECK(text != NULL);
+    memcpy(text, first, sizeof(first) - 1);
+    for (size_t i = 0; i < HISTORY_LINES; i++)
+        memcpy(text + sizeof(first) - 1 + i * (sizeof(line) - 1), line, sizeof(line) - 1);
+
+    History h;
+    CHECK(HistoryParse(&h, &g_arena, text, size));
+    bool known;
+    CHECK(HistoryEstimate(&h, PS_T("/srv/x.ps1"), &known) == 7 && known);
+    HistoryEstimate(&h, PS_T("/srv/old.ps1"), &known);
+    CHECK(!known);
+}
+
+static void TestMissingJournal(void)
+{
+    History h;
+    ArenaRestore(&g_arena, 0);
+    CHECK(HistoryLoad(&h, &g_arena, PS_T("no-such-dir/ps-launcher.runs")));
+    CHECK(h.scripts == 0 && h.typicalMicros == 0);
+}
+
+int main(void)
+{
+    CHECK(ArenaInit(&g_arena, ARENA_DEFAULT_RESERVE));
+    RUN_TEST(TestMovingAverage);
+    RUN_TEST(TestFileNameAndFallback);
+    RUN_TEST(TestOnlyCompletedRuns);
+    RUN_TEST(TestTail);
+    RUN_TEST(TestMissingJournal);
+    ArenaRelease(&g_arena);
+    return TEST_SUMMARY();
+}
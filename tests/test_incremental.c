@@ -0,0 +1,220 @@
+//--------------------------------------------------------------------------
+// TESTS: incremental.c (POSIX file system)
+//--------------------------------------------------------------------------
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "incremental.h"
+#include "testing.h"
+
+static char g_dir[400];
+static char g_manifest[600];
+static Arena g_arena;
+
+static PSCHAR* g_inputs[] = { "in/*.txt", "config.json" };
+static PSCHAR* g_outputs[] = { "out.bin" };
+static uint8_t g_scriptSha[SHA256_DIGEST_SIZE] = { 1 };
+
+static void FullPath(const char* name, char* out, size_t size)
+{
+    snprintf(out, size, "%s/%s", g_dir, name);
+}
+
+static void WriteFile(const char* name, const char* content)
+{
+    char path[600];
+    FullPath(name, path, sizeof(path));
+    FILE* f = fopen(path, "w");
+    if (f)
+    {
+        fputs(content, f);
+        fclose(f);
+    }
+}
+
+// Back-date a file so its identity is trusted (outside the racy window)
+static void SetModified(const char* name, time_t seconds)
+{
+    char path[600];
+    FullPath(name, path, sizeof(path));
+    struct timespec times[2] = { { seconds, 0 }, { seconds, 0 } };
+    utimensat(AT_FDCWD, path, times, 0);
+}
+
+static IncrementalStatus Check(IncrementalState* state)
+{
+    return CheckIncremental(&g_arena, g_manifest, g_scriptSha, g_dir, g_inputs, 2, g_outputs, 1, state);
+}
+
+// Check, and record a successful run if it was out of date
+static IncrementalStatus CheckAndRecord(IncrementalState* state)
+{
+    IncrementalStatus status = Check(state);
+    if (status == INCREMENTAL_OUT_OF_DATE)
+        CHECK(RecordIncremental(&g_arena, state, 0));
+    return status;
+}
+
+static void TestFirstRunThenUpToDate(void)
+{
+    IncrementalState state;
+    CHECK(CheckAndRecord(&state) == INCREMENTAL_OUT_OF_DATE);
+    CHECK(state.stats.inputs == 3);
+    CHECK(state.stats.hashed == 3);
+    CHECK(state.stats.changed == 3);
+
+    // Identities unchanged: metadata only, nothing read
+    CHECK(Check(&state) == INCREMENTAL_UP_TO_DATE);
+    CHECK(state.exitCode == 0);
+    CHECK(state.stats.hashed == 0);
+    CHECK(state.stats.changed == 0);
+}
+
+static void TestTouchedButSameContent(void)
+{
+    IncrementalState state;
+    WriteFile("in/a.txt", "alpha");
+    SetModified("in/a.txt", 1000000100);
+    CHECK(Check(&state) == INCREMENTAL_UP_TO_DATE);
+    CHECK(state.stats.hashed == 1);
+    CHECK(state.stats.changed == 0);
+}
+
+static void TestChangedContent(void)
+{
+    IncrementalState state;
+    WriteFile("in/b.txt", "bravo, revised");
+    SetModified("in/b.txt", 1000000200);
+    CHECK(CheckAndRecord(&state) == INCREMENTAL_OUT_OF_DATE);
+    CHECK(state.stats.changed == 1);
+    CHECK(Check(&state) == INCREMENTAL_UP_TO_DATE);
+
+    // Rewritten within the clock tick of the last check: never trusted
+    // on identity alone, so a same-size edit cannot slip through
+    WriteFile("config.json", "{ \"v\": 2 }");
+    CHECK(CheckAndRecord(&state) == INCREMENTAL_OUT_OF_DATE);
+    WriteFile("config.json", "{ \"v\": 3 }");
+    CHECK(CheckAndRecord(&state) == INCREMENTAL_OUT_OF_DATE);
+    CHECK(state.stats.hashed == 1 && state.stats.changed == 1);
+    SetModified("config.json", 1000000300);
+    CHECK(CheckAndRecord(&state) == INCREMENTAL_UP_TO_DATE);
+    CHECK(state.stats.hashed == 1);
+}
+
+static void TestInputSetChanges(void)
+{
+    IncrementalState state;
+    CHECK(Check(&state) == INCREMENTAL_UP_TO_DATE);
+
+    // A new file matching a glob
+    WriteFile("in/c.txt", "charlie");
+    SetModified("in/c.txt", 1000000000);
+    CHECK(CheckAndRecord(&state) == INCREMENTAL_OUT_OF_DATE);
+    CHECK(state.stats.inputs == 4 && state.stats.changed == 1);
+    CHECK(Check(&state) == INCREMENTAL_UP_TO_DATE);
+
+    // ... and one that went away
+    char path[600];
+    FullPath("in/c.txt", path, sizeof(path));
+    unlink(path);
+    CHECK(CheckAndRecord(&state) == INCREMENTAL_OUT_OF_DATE);
+    CHECK(state.stats.inputs == 3 && state.stats.changed == 0);
+    CHECK(Check(&state) == INCREMENTAL_UP_TO_DATE);
+}
+
+static void TestScriptEdited(void)
+{
+    IncrementalState state;
+    CHECK(Check(&state) == INCREMENTAL_UP_TO_DATE);
+
+    // Same inputs, but the script itself was edited (and re-indexed)
+    g_scriptSha[0] = 2;
+    CHECK(CheckAndRecord(&state) == INCREMENTAL_OUT_OF_DATE);
+    CHECK(state.stats.changed == 0);
+    CHECK(Check(&state) == INCREMENTAL_UP_TO_DATE);
+}
+
+static void TestOutputs(void)
+{
+    IncrementalState state;
+    char path[600];
+    FullPath("out.bin", path, sizeof(path));
+    unlink(path);
+    CHECK(Check(&state) == INCREMENTAL_OUT_OF_DATE);
+    // A run that leaves its outputs missing is not recorded
+    CHECK(!RecordIncremental(&g_arena, &state, 0));
+
+    WriteFile("out.bin", "output, rebuilt");
+    SetModified("out.bin", 1000000000);
+    CHECK(CheckAndRecord(&state) == INCREMENTAL_OUT_OF_DATE);
+    CHECK(Check(&state) == INCREMENTAL_UP_TO_DATE);
+    SetModified("out.bin", 1000000400);
+    CHECK(Check(&state) == INCREMENTAL_OUT_OF_DATE);
+}
+
+static void TestManifestPaths(void)
+{
+    PSCHAR* joined[] = { "a b" };
+    PSCHAR* split[] = { "a", "b" };
+    PSCHAR* one = IncrementalManifestPath(&g_arena, "/state", "/s/job.ps1", joined, 1);
+    PSCHAR* two = IncrementalManifestPath(&g_arena, "/state", "/s/job.ps1", split, 2);
+    PSCHAR* again = IncrementalManifestPath(&g_arena, "/state", "/s/job.ps1", split, 2);
+    CHECK(one && two && again);
+    CHECK(strncmp(one, "/state/manifests/", 17) == 0);
+    CHECK(strcmp(one + strlen(one) - 9, ".manifest") == 0);
+    CHECK(strcmp(one, two) != 0);
+    CHECK(strcmp(two, again) == 0);
+
+    // A damaged manifest just means out of date
+    FILE* f = fopen(g_manifest, "w");
+    if (f)
+    {
+        fputs("PSIM garbage", f);
+        fclose(f);
+    }
+    IncrementalState state;
+    CHECK(Check(&state) == INCREMENTAL_OUT_OF_DATE);
+}
+
+int main(void)
+{
+    char cwd[300];
+    if (!getcwd(cwd, sizeof(cwd)))
+        return 1;
+    snprintf(g_dir, sizeof(g_dir), "%s/incremental_scratch", cwd);
+    snprintf(g_manifest, sizeof(g_manifest), "%s/manifests/job.manifest", g_dir);
+
+    char cmd[600];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", g_dir);
+    if (system(cmd) != 0)
+        return 1;
+    mkdir(g_dir, 0700);
+    char in[600];
+    FullPath("in", in, sizeof(in));
+    mkdir(in, 0700);
+    WriteFile("in/a.txt", "alpha");
+    WriteFile("in/b.txt", "bravo");
+    WriteFile("in/notes.md", "not an input");
+    WriteFile("config.json", "{ \"v\": 1 }");
+    WriteFile("out.bin", "output");
+    SetModified("in/a.txt", 1000000000);
+    SetModified("in/b.txt", 1000000000);
+    SetModified("config.json", 1000000000);
+    SetModified("out.bin", 1000000000);
+
+    if (!ArenaInit(&g_arena, ARENA_DEFAULT_RESERVE))
+        return 1;
+    RUN_TEST(TestFirstRunThenUpToDate);
+    RUN_TEST(TestTouchedButSameContent);
+    RUN_TEST(TestChangedContent);
+    RUN_TEST(TestInputSetChanges);
+    RUN_TEST(TestScriptEdited);
+    RUN_TEST(TestOutputs);
+    RUN_TEST(TestManifestPaths);
+    ArenaRelease(&g_arena);
+    return TEST_SUMMARY();
+}
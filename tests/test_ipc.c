@@ -0,0 +1,430 @@
+//--------------------------------------------------------------------------
+// TESTS: ipc.c framing and client, and the -Serve server (POSIX sockets)
+//--------------------------------------------------------------------------
+// Usage: test_ipc [<ps-launcher> <interpreter> <ps-launcher-daemon>]
+// With the binaries given it also runs a server and submits to it, both
+// through IpcClient and through the daemon-client launcher variant.
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ipc.h"
+#include "psatomic.h"
+#include "testing.h"
+
+#define LOOPBACK_SUBMISSIONS 2000
+
+static Arena g_arena;
+static char g_dir[400];
+
+static void PutU32(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+// A hand-built submission frame: header, then the given raw fields
+static size_t RawFrame(uint8_t* out, const uint8_t* fields, size_t fieldsLen)
+{
+    PutU32(out, (uint32_t)(IPC_HEADER_SIZE - 4 + fieldsLen));
+    out[4] = IPC_SUBMIT;
+    out[5] = IPC_VERSION;
+    out[6] = out[7] = 0;
+    memset(out + 8, 0, 8);
+    out[8] = 9;
+    memcpy(out + IPC_HEADER_SIZE, fields, fieldsLen);
+    return IPC_HEADER_SIZE + fieldsLen;
+}
+
+static void TestSubmitRoundTrip(void)
+{
+    static char* const args[] = { "-Name", "John Doe", "", "caf\xc3\xa9" };
+    static char* const env[] = { "A=1", "PATHISH=/x:/y" };
+    IpcSubmit in = { 0x1122334455667788ull, "@nightly", args, 4, env, 2, "/tmp", "prod", "interactive", "250", "ops:2" };
+
+    ArenaMark mark = ArenaSave(&g_arena);
+    IpcWriter w;
+    CHECK(IpcWriterInit(&w, &g_arena, 16));      // Grows on the way
+    CHECK(IpcEncodeSubmit(&w, &in));
+
+    IpcFrame frame;
+    bool bad;
+    CHECK(IpcParseFrame(w.data, w.len, &frame, &bad) == w.len);
+    CHECK(frame.type == IPC_SUBMIT && frame.id == in.id);
+
+    IpcSubmit out;
+    CHECK(IpcDecodeSubmit(&g_arena, &frame, &out));
+    CHECK(out.id == in.id);
+    CHECK_STR(out.script, "@nightly");
+    CHECK(out.argCount == 4 && out.envCount == 2);
+    for (int i = 0; i < out.argCount && i < 4; i++)
+        CHECK_STR(out.args[i], args[i]);
+    CHECK_STR(out.env[1], "PATHISH=/x:/y");
+    CHECK_STR(out.cwd, "/tmp");
+    CHECK_STR(out.profile, "prod");
+    CHECK_STR(out.priority, "interactive");
+    CHECK_STR(out.deadline, "250");
+    CHECK_STR(out.submitter, "ops:2");
+
+    // Only what is set goes out
+    IpcSubmit bare = { 2, "s.ps1", NULL, 0, NULL, 0, NULL, NULL, NULL, NULL, NULL };
+    w.len = 0;
+    CHECK(IpcEncodeSubmit(&w, &bare));
+    CHECK(w.len == IPC_HEADER_SIZE + 5 + 5);
+    CHECK(IpcParseFrame(w.data, w.len, &frame, &bad) == w.len);
+    CHECK(IpcDecodeSubmit(&g_arena, &frame, &out));
+    CHECK(out.cwd == NULL && out.profile == NULL && out.argCount == 0);
+    CHECK(out.priority == NULL && out.deadline == NULL && out.submitter == NULL);
+    ArenaRestore(&g_arena, mark);
+}
+
+static void TestCompletionAndPartialFrames(void)
+{
+    ArenaMark mark = ArenaSave(&g_arena);
+    IpcWriter w;
+    CHECK(IpcWriterInit(&w, &g_arena, 256));
+    IpcCompletion c1 = { 7, IPC_COMPLETED, 42, 1234567 };
+    IpcCompletion c2 = { 8, IPC_SPAWN_FAILED, 2, 0 };
+    CHECK(IpcEncodeCompletion(&w, &c1));
+    CHECK(IpcEncodeCompletion(&w, &c2));
+    CHECK(w.len == 2 * (IPC_HEADER_SIZE + IPC_COMPLETE_BODY));
+
+    // Every prefix short of a whole frame asks for more, never "bad"
+    IpcFrame frame;
+    bool bad;
+    for (size_t len = 0; len < IPC_HEADER_SIZE + IPC_COMPLETE_BODY; len++)
+    {
+        CHECK(IpcParseFrame(w.data, len, &frame, &bad) == 0);
+        CHECK(!bad);
+    }
+
+    size_t size = IpcParseFrame(w.data, w.len, &frame, &bad);
+    IpcCompletion out;
+    CHECK(size == IPC_HEADER_SIZE + IPC_COMPLETE_BODY);
+    CHECK(IpcDecodeCompletion(&frame, &out));
+    CHECK(out.id == 7 && out.status == IPC_COMPLETED && out.exitCode == 42 && out.durationMicros == 1234567);
+    CHECK(IpcParseFrame(w.data + size, w.len - size, &frame, &bad) == size);
+    CHECK(IpcDecodeCompletion(&frame, &out));
+    CHECK(out.id == 8 && out.status == IPC_SPAWN_FAILED);
+
+    // A completion is not a submission
+    IpcSubmit submit;
+    CHECK(!IpcDecodeSubmit(&g_arena, &frame, &submit));
+    ArenaRestore(&g_arena, mark);
+}
+
+static void TestMalformedFrames(void)
+{
+    uint8_t buf[128];
+    IpcFrame frame;
+    IpcSubmit submit;
+    bool bad;
+
+    // Length shorter than a header, over the limit, wrong version
+    PutU32(buf, 4);
+    CHECK(IpcParseFrame(buf, 4, &frame, &bad) == 0 && bad);
+    PutU32(buf, IPC_MAX_FRAME);
+    CHECK(IpcParseFrame(buf, 4, &frame, &bad) == 0 && bad);
+    size_t len = RawFrame(buf, (const uint8_t*)"\x01\x01\0\0\0s", 6);
+    buf[5] = IPC_VERSION + 1;
+    CHECK(IpcParseFrame(buf, len, &frame, &bad) == 0 && bad);
+
+    // Unknown tags are skipped
+    len = RawFrame(buf, (const uint8_t*)"\x09\x02\0\0\0zz\x01\x01\0\0\0s", 13);
+    CHECK(IpcParseFrame(buf, len, &frame, &bad) == len);
+    CHECK(IpcDecodeSubmit(&g_arena, &frame, &submit));
+    CHECK_STR(submit.script, "s");
+    CHECK(frame.id == 9 && submit.id == 9);
+
+    // Embedded NUL, a field running past the frame, no script at all
+    len = RawFrame(buf, (const uint8_t*)"\x01\x03\0\0\0a\0b", 8);
+    CHECK(IpcParseFrame(buf, len, &frame, &bad) == len);
+    CHECK(!IpcDecodeSubmit(&g_arena, &frame, &submit));
+    len = RawFrame(buf, (const uint8_t*)"\x01\x09\0\0\0s", 6);
+    CHECK(IpcParseFrame(buf, len, &frame, &bad) == len);
+    CHECK(!IpcDecodeSubmit(&g_arena, &frame, &submit));
+    len = RawFrame(buf, (const uint8_t*)"\x02\x01\0\0\0x", 6);
+    CHECK(IpcParseFrame(buf, len, &frame, &bad) == len);
+    CHECK(!IpcDecodeSubmit(&g_arena, &frame, &submit));
+}
+
+//--------------------------------------------------------------------------
+// Client against an in-process stand-in server: every submission is
+// answered, newest first within each read, exit code = id
+//--------------------------------------------------------------------------
+static char g_endpoint[500];
+static volatile uint32_t g_listening;
+
+static void StandInServer(void* arg)
+{
+    (void)arg;
+    Arena arena;
+    PlatIpc listener, conn;
+    IpcWriter out;
+    static uint8_t in[IPC_MAX_FRAME];
+    size_t inLen = 0, got;
+    if (!ArenaInit(&arena, ARENA_DEFAULT_RESERVE) || !IpcWriterInit(&out, &arena, 4096) ||
+        !PlatIpcListen(&listener, g_endpoint))
+        return;
+    PsAtomicFetchAdd(&g_listening, 1);
+    if (PlatIpcAccept(&listener, &conn) != PLAT_IPC_OK)
+        return;
+
+    while (PlatIpcRead(&conn, in + inLen, sizeof(in) - inLen, PLAT_WAIT_FOREVER, &got) == PLAT_IPC_OK)
+    {
+        inLen += got;
+        IpcFrame frame;
+        IpcCompletion done[256];
+        size_t pos = 0, size;
+        int n = 0;
+        bool bad;
+        do
+        {
+            n = 0;
+            while (n < 256 && (size = IpcParseFrame(in + pos, inLen - pos, &frame, &bad)) > 0)
+            {
+                IpcCompletion c = { frame.id, IPC_COMPLETED, (uint32_t)frame.id, 0 };
+                done[n++] = c;
+                pos += size;
+            }
+            for (int i = n; i > 0; i--)
+                IpcEncodeCompletion(&out, &done[i - 1]);
+        } while (n == 256);
+        memmove(in, in + pos, inLen - pos);
+        inLen -= pos;
+        if (!PlatIpcWrite(&conn, out.data, out.len))
+            break;
+        out.len = 0;
+    }
+    PlatIpcClose(&conn);
+    PlatIpcClose(&listener);
+    ArenaRelease(&arena);
+}
+
+typedef struct Tally
+{
+    uint32_t count;
+    uint32_t wrong;
+    unsigned char seen[LOOPBACK_SUBMISSIONS + 1];
+} Tally;
+
+static void Count(void* ctx, const IpcCompletion* c)
+{
+    Tally* t = (Tally*)ctx;
+    t->count++;
+    if (c->id == 0 || c->id > LOOPBACK_SUBMISSIONS || t->seen[c->id] || c->exitCode != c->id)
+        t->wrong++;
+    else
+        t->seen[c->id] = 1;
+}
+
+static void TestClientPipelining(void)
+{
+    snprintf(g_endpoint, sizeof(g_endpoint), "%s/loopback.sock", g_dir);
+    PlatThread server;
+    CHECK(PlatStartThread(&server, StandInServer, NULL));
+    for (int i = 0; i < 500 && PsAtomicFetchAdd(&g_listening, 0) == 0; i++)
+        PlatSleepMillis(10);
+
+    IpcClient client;
+    CHECK(IpcClientConnect(&client, g_endpoint));
+    static Tally tally;
+    static char* const args[] = { "-Name", "value with spaces" };
+    for (uint64_t id = 1; id <= LOOPBACK_SUBMISSIONS; id++)
+    {
+        IpcSubmit s = { id, "script.ps1", args, 2, NULL, 0, NULL, NULL, NULL, NULL, NULL };
+        CHECK(IpcClientSubmit(&client, &s));
+        if (id % 64 == 0)
+            CHECK(IpcClientFlush(&client));
+    }
+    CHECK(IpcClientFlush(&client));
+    CHECK(client.pending == LOOPBACK_SUBMISSIONS);
+    while (client.pending > 0 && IpcClientPoll(&client, 5000, Count, &tally) > 0)
+        ;
+    CHECK(tally.count == LOOPBACK_SUBMISSIONS);
+    CHECK(tally.wrong == 0);
+    CHECK(client.pending == 0);
+    IpcClientClose(&client);
+    PlatJoinThread(&server);
+
+    // The listener removed its socket file
+    struct stat st;
+    CHECK(stat(g_endpoint, &st) != 0);
+}
+
+//--------------------------------------------------------------------------
+// ps-launcher -Serve end to end
+//--------------------------------------------------------------------------
+typedef struct Outcome
+{
+    int order;
+    IpcCompletion byId[12];
+    int position[12];
+} Outcome;
+
+static void Record(void* ctx, const IpcCompletion* c)
+{
+    Outcome* o = (Outcome*)ctx;
+    if (c->id < 12)
+    {
+        o->byId[c->id] = *c;
+        o->position[c->id] = ++o->order;
+    }
+}
+
+static pid_t Spawn(char* const* argv, const char* output)
+{
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if (output)
+        posix_spawn_file_actions_addopen(&actions, 1, output, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    extern char** environ;
+    pid_t pid;
+    int rc = posix_spawn(&pid, argv[0], &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    return rc == 0 ? pid : -1;
+}
+
+static void TestServeEndToEnd(const char* launcher, const char* daemonClient)
+{
+    char endpoint[500], script[500], output[500], line[256];
+    snprintf(endpoint, sizeof(endpoint), "%s/serve.sock", g_dir);
+    snprintf(script, sizeof(script), "%s/job.ps1", g_dir);
+    snprintf(output, sizeof(output), "%s/serve.out", g_dir);
+    FILE* f = fopen(script, "w");
+    if (f)
+        fclose(f);
+
+    char* serveArgv[] = { (char*)launcher, "-Serve", endpoint, NULL };
+    pid_t server = Spawn(serveArgv, output);
+    CHECK(server > 0);
+    if (server <= 0)
+        return;
+    IpcClient client;
+    bool connected = false;
+    for (int i = 0; i < 500 && !connected; i++)
+    {
+        connected = IpcClientConnect(&client, endpoint);
+        if (!connected)
+            PlatSleepMillis(10);
+    }
+    CHECK(connected);
+    if (!connected)
+    {
+        kill(server, SIGKILL);
+        waitpid(server, NULL, 0);
+        return;
+    }
+
+    // A second server on a live endpoint is refused
+    PlatIpc second;
+    CHECK(!PlatIpcListen(&second, endpoint));
+
+    // Pipelined: the slow run is submitted first and finishes last
+    static char* const slow[] = { "-SleepMs", "400", "-ExitCode", "4" };
+    static char* const quick[] = { "-ExitCode", "3" };
+    static char* const relative[] = { "-ExitCode", "5", "-Tag" };
+    static char* const env[] = { "PS_TEST_TAG=from-env" };
+    static char* const noInterpreter[] = { "PS_LAUNCHER_INTERPRETER=/nonexistent/pwsh" };
+    static char* const badEnv[] = { "NOEQUALS" };
+    IpcSubmit submits[] = {
+        { 1, script, slow, 4, NULL, 0, NULL, NULL, NULL, NULL, NULL },
+        { 2, script, quick, 2, NULL, 0, NULL, NULL, NULL, NULL, NULL },
+        { 3, "job.ps1", relative, 3, env, 1, g_dir, NULL, NULL, NULL, NULL },    // Relative to cwd
+        { 4, script, NULL, 0, NULL, 0, NULL, "prod", NULL, NULL, NULL },           // Profile without an alias
+        { 5, script, NULL, 0, badEnv, 1, NULL, NULL, NULL, NULL, NULL },
+        { 6, "/nonexistent/job.ps1", NULL, 0, NULL, 0, NULL, NULL, NULL, NULL, NULL },
+        { 7, script, NULL, 0, noInterpreter, 1, NULL, NULL, NULL, NULL, NULL },
+        { 8, script, quick, 2, NULL, 0, NULL, NULL, "interactive", "500", "ops:3" },
+        { 9, script, NULL, 0, NULL, 0, NULL, NULL, "urgent", NULL, NULL },         // Unknown class
+        { 10, script, NULL, 0, NULL, 0, NULL, NULL, NULL, "-5", NULL },
+        { 11, script, NULL, 0, NULL, 0, NULL, NULL, NULL, NULL, "ops:0" },
+    };
+    for (int i = 0; i < 11; i++)
+        CHECK(IpcClientSubmit(&client, &submits[i]));
+    CHECK(IpcClientFlush(&client));
+
+    Outcome o;
+    memset(&o, 0, sizeof(o));
+    for (int i = 0; i < 100 && client.pending > 0; i++)
+        IpcClientPoll(&client, 100, Record, &o);
+    CHECK(client.pending == 0);
+    CHECK(o.byId[1].status == IPC_COMPLETED && o.byId[1].exitCode == 4);
+    CHECK(o.byId[1].durationMicros >= 400000);
+    CHECK(o.byId[2].status == IPC_COMPLETED && o.byId[2].exitCode == 3);
+    CHECK(o.byId[3].status == IPC_COMPLETED && o.byId[3].exitCode == 5);
+    CHECK(o.byId[4].status == IPC_REJECTED);
+    CHECK(o.byId[5].status == IPC_REJECTED);
+    CHECK(o.byId[6].status == IPC_COMPLETED && o.byId[6].exitCode == 1);
+    CHECK(o.byId[7].status == IPC_COMPLETED && o.byId[7].exitCode == 1);   // Its variable applied
+    CHECK(o.byId[8].status == IPC_COMPLETED && o.byId[8].exitCode == 3);
+    CHECK(o.byId[9].status == IPC_REJECTED);
+    CHECK(o.byId[10].status == IPC_REJECTED);
+    CHECK(o.byId[11].status == IPC_REJECTED);
+    CHECK(o.position[1] == 11);
+    IpcClientClose(&client);
+
+    // The daemon-client variant hands its run over and returns its exit code
+    setenv("PS_LAUNCHER_ENDPOINT", endpoint, 1);
+    char* clientArgv[] = { (char*)daemonClient, "-Script", script, "-ExitCode", "6", NULL };
+    pid_t pid = Spawn(clientArgv, NULL);
+    int status = -1;
+    CHECK(pid > 0);
+    if (pid > 0)
+        waitpid(pid, &status, 0);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 6);
+    unsetenv("PS_LAUNCHER_ENDPOINT");
+
+    // Deleting the socket stops the server
+    CHECK(unlink(endpoint) == 0);
+    waitpid(server, &status, 0);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    // The relative script was found in the submitted working directory
+    int tagged = 0;
+    f = fopen(output, "r");
+    while (f && fgets(line, sizeof(line), f))
+        tagged += strcmp(line, "[-Tag]\n") == 0;
+    if (f)
+        fclose(f);
+    CHECK(tagged == 1);
+}
+
+int main(int argc, char** argv)
+{
+    char cwd[300];
+    if (!getcwd(cwd, sizeof(cwd)) || !ArenaInit(&g_arena, ARENA_DEFAULT_RESERVE))
+        return 1;
+    // The -Serve registration gets its own directory so ctest -j can run both
+    snprintf(g_dir, sizeof(g_dir), "%s/ipc_scratch%s", cwd, argc == 4 ? "_serve" : "");
+    char cmd[600];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", g_dir);
+    if (system(cmd) != 0)
+        return 1;
+    mkdir(g_dir, 0700);
+
+    RUN_TEST(TestSubmitRoundTrip);
+    RUN_TEST(TestCompletionAndPartialFrames);
+    RUN_TEST(TestMalformedFrames);
+    RUN_TEST(TestClientPipelining);
+    if (argc == 4)
+    {
+        char state[500];
+        snprintf(state, sizeof(state), "%s/state", g_dir);
+        setenv("PS_LAUNCHER_INTERPRETER", argv[2], 1);
+        setenv("XDG_STATE_HOME", state, 1);
+        int before = g_failures;
+        TestServeEndToEnd(argv[1], argv[3]);
+        printf("%-40s %s\n", "TestServeEndToEnd", g_failures == before ? "ok" : "FAILED");
+    }
+    ArenaRelease(&g_arena);
+    return TEST_SUMMARY();
+}
@@ -0,0 +1,137 @@
+//--------------------------------------------------------------------------
+// TESTS: jobqueue.c class, deadline and fair-share order
+//--------------------------------------------------------------------------
+#include "jobqueue.h"
+#include "testing.h"
+
+#define BATCH 500
+
+static Arena g_arena;
+static JobItem g_items[BATCH + 16];
+
+static uint32_t Index(const JobItem* item)
+{
+    return item ? (uint32_t)(item - g_items) : UINT32_MAX;
+}
+
+static void Fresh(JobQueue* q, uint32_t capacity)
+{
+    ArenaRestore(&g_arena, 0);
+    CHECK(JobQueueInit(q, &g_arena, capacity));
+}
+
+static void TestClassesAndDeadlines(void)
+{
+    JobQueue q;
+    Fresh(&q, 8);
+    CHECK(JobQueuePush(&q, &g_items[0], JOB_BULK, 10, 1, 1));
+    CHECK(JobQueuePush(&q, &g_items[1], JOB_NORMAL, JOB_NO_DEADLINE, 1, 1));
+    CHECK(JobQueuePush(&q, &g_items[2], JOB_NORMAL, 500, 2, 1));
+    CHECK(JobQueuePush(&q, &g_items[3], JOB_INTERACTIVE, JOB_NO_DEADLINE, 3, 1));
+    CHECK(JobQueuePush(&q, &g_items[4], JOB_NORMAL, 200, 4, 1));
+    CHECK(JobQueueCount(&q) == 5);
+
+    // Class first; within it the earliest deadline, then those without
+    CHECK(Index(JobQueuePop(&q)) == 3);
+    CHECK(Index(JobQueuePop(&q)) == 4);
+    CHECK(Index(JobQueuePop(&q)) == 2);
+    CHECK(Index(JobQueuePop(&q)) == 1);
+    CHECK(Index(JobQueuePop(&q)) == 0);
+    CHECK(JobQueuePop(&q) == NULL && !JobQueued(&g_items[0]));
+}
+
+static void TestBatchDoesNotBlock(void)
+{
+    // A 500-job batch queued at once, then one job from someone else: it
+    // goes after at most a turn of the batch
+    JobQueue q;
+    Fresh(&q, BATCH + 1);
+    uint64_t batch = JobSubmitterKey(PS_T("nightly"), 7);
+    uint64_t other = JobSubmitterKey(PS_T("alice"), 5);
+    for (uint32_t i = 0; i < BATCH; i++)
+        CHECK(JobQueuePush(&q, &g_items[i], JOB_NORMAL, JOB_NO_DEADLINE, batch, 1));
+    CHECK(Index(JobQueuePop(&q)) == 0);
+    CHECK(Index(JobQueuePop(&q)) == 1);
+    CHECK(JobQueuePush(&q, &g_items[BATCH], JOB_NORMAL, JOB_NO_DEADLINE, other, 1));
+    uint32_t position = 0;
+    while (Index(JobQueuePop(&q)) != BATCH)
+        position++;
+    CHECK(position <= 1);
+    CHECK(JobQueueCount(&q) == BATCH - 2 - position);
+}
+
+static void TestWeights(void)
+{
+    // Two backlogged submitters, weights 2 and 1: two turns to one
+    JobQueue q;
+    Fresh(&q, 64);
+    for (uint32_t i = 0; i < 30; i++)
+    {
+        CHECK(JobQueuePush(&q, &g_items[i], JOB_BULK, JOB_NO_DEADLINE, 7, 2));
+        CHECK(JobQueuePush(&q, &g_items[30 + i], JOB_BULK, JOB_NO_DEADLINE, 8, 1));
+    }
+    uint32_t heavy = 0;
+    for (uint32_t i = 0; i < 30; i++)
+        heavy += Index(JobQueuePop(&q)) < 30;
+    CHECK(heavy == 20);
+}
+
+static void TestRemoveAndFull(void)
+{
+    JobQueue q;
+    Fresh(&q, 4);
+    for (uint32_t i = 0; i < 4; i++)
+        CHECK(JobQueuePush(&q, &g_items[i], JOB_NORMAL, 100 + i, 1, 1));
+    CHECK(!JobQueuePush(&q, &g_items[4], JOB_INTERACTIVE, 0, 1, 1));
+    CHECK(!JobQueued(&g_items[4]));
+
+    // Removing from the middle keeps the rest in order; twice is harmless
+    JobQueueRemove(&q, &g_items[1]);
+    JobQueueRemove(&q, &g_items[1]);
+    CHECK(!JobQueued(&g_items[1]) && JobQueueCount(&q) == 3);
+    CHECK(Index(JobQueuePop(&q)) == 0);
+    CHECK(Index(JobQueuePop(&q)) == 2);
+    CHECK(Index(JobQueuePop(&q)) == 3);
+    CHECK(JobQueueCount(&q) == 0);
+}
+
+static void TestManySubmitters(void)
+{
+    // More submitters than the table holds: stale slots are reused, and a
+    // job whose submitter finds no slot is still queued
+    JobQueue q;
+    Fresh(&q, 2);
+    bool ok = true;
+    for (uint64_t key = 1; key <= 4 * JOB_SUBMITTERS; key++)
+    {
+        ok = ok && JobQueuePush(&q, &g_items[0], JOB_NORMAL, JOB_NO_DEADLINE, key * 0x9E3779B97F4A7C15ull, 1);
+        ok = ok && JobQueuePop(&q) == &g_items[0];
+    }
+    CHECK(ok);
+    CHECK(JobQueuePush(&q, &g_items[1], JOB_NORMAL, JOB_NO_DEADLINE, 0, 1));
+    CHECK(JobQueuePop(&q) == &g_items[1]);
+}
+
+static void TestClassNames(void)
+{
+    JobClass cls = JOB_NORMAL;
+    CHECK(JobParseClass(PS_T("Interactive"), &cls) && cls == JOB_INTERACTIVE);
+    CHECK(JobParseClass(PS_T("BULK"), &cls) && cls == JOB_BULK);
+    CHECK(!JobParseClass(PS_T("urgent"), &cls) && cls == JOB_BULK);
+    CHECK(!JobParseClass(PS_T(""), &cls));
+    CHECK_STR(JobClassName(JOB_NORMAL), PS_T("normal"));
+    CHECK(JobSubmitterKey(PS_T("a"), 1) != JobSubmitterKey(PS_T("b"), 1));
+}
+
+int main(void)
+{
+    CHECK(ArenaInit(&g_arena, ARENA_DEFAULT_RESERVE));
+    RUN_TEST(TestClassesAndDeadlines);
+    RUN_TEST(TestBatchDoesNotBlock);
+    RUN_TEST(TestWeights);
+    RUN_TEST(TestRemoveAndFull);
+    RUN_TEST(TestManySubmitters);
+    RUN_TEST(TestClassNames);
+    ArenaRelease(&g_arena);
+    return TEST_SUMMARY();
+}
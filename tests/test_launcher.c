@@ -0,0 +1,804 @@
+//--------------------------------------------------------------------------
+// TESTS: end-to-end launches on the POSIX backend
+//--------------------------------------------------------------------------
+// Usage: test_launcher <ps-launcher> <fake_interpreter> <scratch dir> [--extras]
+// Runs the real launcher binary with the stand-in interpreter and checks
+// argument delivery, exit code propagation, policy and the run journal.
+// --extras also covers the C launcher's own modes: pack mode with embedded
+// scripts, the script search path, the script catalogue, the resident
+// scheduler, watch mode, the status board, -Metrics and trace export.
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cmdline.h"
+#include "config.h"
+#include "testing.h"
+
+static const char* g_launcher;
+static char g_script[512];
+static char g_stateDir[512];
+static bool g_extras;
+
+// Run the launcher, capture stdout into out, return its exit code
+static int Launch(char* const* extraArgs, char* out, size_t outSize)
+{
+    char* argv[32];
+    int argc = 0;
+    argv[argc++] = (char*)g_launcher;
+    for (int i = 0; extraArgs[i]; i++)
+        argv[argc++] = extraArgs[i];
+    argv[argc] = NULL;
+
+    int fds[2];
+    if (pipe(fds) != 0)
+        return -1;
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], 1);
+    posix_spawn_file_actions_addclose(&actions, fds[0]);
+
+    extern char** environ;
+    pid_t pid;
+    int rc = posix_spawn(&pid, g_launcher, &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(fds[1]);
+    if (rc != 0)
+    {
+        close(fds[0]);
+        return -1;
+    }
+
+    size_t total = 0;
+    ssize_t n;
+    while ((n = read(fds[0], out + total, outSize - 1 - total)) > 0)
+        total += (size_t)n;
+    out[total] = 0;
+    close(fds[0]);
+
+    int status;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+static void TestArgumentsDelivered(void)
+{
+    char out[1024];
+    char* args[] = { "-Script", g_script, "-Name", "John Doe", "", "say \"hi\"", NULL };
+    CHECK(Launch(args, out, sizeof(out)) == 0);
+    char expected[1024];
+    snprintf(expected, sizeof(expected), "[%s]\n[-Name]\n[John Doe]\n[]\n[say \"hi\"]\n", g_script);
+    CHECK(strcmp(out, expected) == 0);
+}
+
+static void TestExitCodePropagated(void)
+{
+    char out[1024];
+    char* args[] = { "-Script", g_script, "-ExitCode", "42", NULL };
+    CHECK(Launch(args, out, sizeof(out)) == 42);
+}
+
+static void TestUsageAndMissingScript(void)
+{
+    char out[1024];
+    char* usage[] = { "-File", g_script, NULL };
+    char* missing[] = { "-Script", "/nonexistent/x.ps1", NULL };
+    CHECK(Launch(usage, out, sizeof(out)) == 1);
+    CHECK(Launch(missing, out, sizeof(out)) == 1);
+}
+
+static void TestSemicolonBlockedBeforeSpawn(void)
+{
+    char out[1024];
+    char* args[] = { "-Script", g_script, "a;b", NULL };
+    CHECK(Launch(args, out, sizeof(out)) == 1);
+    CHECK(out[0] == 0);  // Interpreter never ran
+}
+
+static void WriteFile(const char* path, const char* text)
+{
+    FILE* f = fopen(path, "w");
+    if (f)
+    {
+        fputs(text, f);
+        fclose(f);
+    }
+}
+
+// -Pack, then run the packed copy with no script on disk
+static void TestPackedLauncher(void)
+{
+    char dir[512], hello[600], other[600], packed[600], repacked[600];
+    char out[4096], expected[4096];
+    snprintf(dir, sizeof(dir), "%s", g_stateDir);
+    *strrchr(dir, '/') = 0;
+    snprintf(hello, sizeof(hello), "%s/hello.ps1", dir);
+    snprintf(other, sizeof(other), "%s/other.ps1", dir);
+    snprintf(packed, sizeof(packed), "%s/packed", dir);
+    snprintf(repacked, sizeof(repacked), "%s/repacked", dir);
+    WriteFile(hello, "Write-Output 'hi'\n");
+    WriteFile(other, "exit 0\n");
+
+    char* pack[] = { "-Pack", packed, hello, other, NULL };
+    CHECK(Launch(pack, out, sizeof(out)) == 0);
+    char* missing[] = { "-Pack", repacked, "/nonexistent/x.ps1", NULL };
+    CHECK(Launch(missing, out, sizeof(out)) == 1);
+    unlink(hello);
+
+    const char* launcher = g_launcher;
+    g_launcher = packed;
+
+    // No -Script: the first embedded script gets every argument
+    char* plain[] = { "-Name", "John Doe", NULL };
+    CHECK(Launch(plain, out, sizeof(out)) == 0);
+    snprintf(expected, sizeof(expected), "[%s -Name 'John Doe']\n[Write-Output 'hi'\n]\n",
+             PS_EMBEDDED_PROLOGUE);
+    CHECK(strcmp(out, expected) == 0);
+
+    char* named[] = { "-Script", "OTHER.ps1", "it's", NULL };
+    CHECK(Launch(named, out, sizeof(out)) == 0);
+    snprintf(expected, sizeof(expected), "[%s 'it''s']\n[exit 0\n]\n", PS_EMBEDDED_PROLOGUE);
+    CHECK(strcmp(out, expected) == 0);
+
+    // A -Script that is not embedded still runs from disk
+    char* onDisk[] = { "-Script", g_script, NULL };
+    CHECK(Launch(onDisk, out, sizeof(out)) == 0);
+    snprintf(expected, sizeof(expected), "[%s]\n", g_script);
+    CHECK(strcmp(out, expected) == 0);
+
+    // Repacking a packed launcher replaces its payload
+    WriteFile(hello, "Write-Output 'v2'\n");
+    char* repack[] = { "-Pack", repacked, hello, NULL };
+    CHECK(Launch(repack, out, sizeof(out)) == 0);
+    g_launcher = repacked;
+    char* none[] = { NULL };
+    CHECK(Launch(none, out, sizeof(out)) == 0);
+    snprintf(expected, sizeof(expected), "[%s]\n[Write-Output 'v2'\n]\n", PS_EMBEDDED_PROLOGUE);
+    CHECK(strcmp(out, expected) == 0);
+    char* gone[] = { "-Script", "other.ps1", NULL };
+    CHECK(Launch(gone, out, sizeof(out)) == 1);
+
+    g_launcher = launcher;
+}
+
+// A relative -Script missing from the current directory is found on
+// PS_LAUNCHER_SCRIPT_PATH; the launch gets the full path
+static void TestScriptSearchPath(void)
+{
+    char dir[512], out[4096], expected[4096];
+    snprintf(dir, sizeof(dir), "%s", g_script);
+    *strrchr(dir, '/') = 0;
+    setenv("PS_LAUNCHER_SCRIPT_PATH", "/nonexistent:", 1);
+
+    char* args[] = { "-Script", "test script.ps1", "-A", NULL };
+    CHECK(Launch(args, out, sizeof(out)) == 1);
+
+    char path[600];
+    snprintf(path, sizeof(path), "/nonexistent:%s", dir);
+    setenv("PS_LAUNCHER_SCRIPT_PATH", path, 1);
+    for (int i = 0; i < 2; i++)   // Listing, then the cached listing
+    {
+        CHECK(Launch(args, out, sizeof(out)) == 0);
+        snprintf(expected, sizeof(expected), "[%s]\n[-A]\n", g_script);
+        CHECK(strcmp(out, expected) == 0);
+    }
+    unsetenv("PS_LAUNCHER_SCRIPT_PATH");
+}
+
+#ifdef ENABLE_CATALOG
+// -Index, then -Script @alias with a profile; a changed script is refused
+static void TestCatalogAlias(void)
+{
+    char source[600], text[1200], out[4096], expected[4096];
+    snprintf(source, sizeof(source), "%s/ps-launcher/ps-launcher.catalog", g_stateDir);
+    snprintf(text, sizeof(text), "profile quick -Mode Fast\nalias hello \"%s\" quick\n", g_script);
+    WriteFile(source, text);
+
+    char* alias[] = { "-Script", "@Hello", "-X", NULL };
+    char* index[] = { "-Index", NULL };
+    CHECK(Launch(index, out, sizeof(out)) == 0);
+    CHECK(Launch(alias, out, sizeof(out)) == 0);
+    snprintf(expected, sizeof(expected), "[%s]\n[-Mode]\n[Fast]\n[-X]\n", g_script);
+    CHECK(strcmp(out, expected) == 0);
+
+    char* unknown[] = { "-Script", "@nothing", NULL };
+    CHECK(Launch(unknown, out, sizeof(out)) == 1);
+
+    WriteFile(g_script, "Write-Output 'changed'\n");
+    CHECK(Launch(alias, out, sizeof(out)) == 1);
+    CHECK(out[0] == 0);  // Interpreter never ran
+    CHECK(Launch(index, out, sizeof(out)) == 0);
+    CHECK(Launch(alias, out, sizeof(out)) == 0);
+}
+
+static void TestIncrementalSkip(void)
+{
+    // <scratch>/build/job.ps1 with inputs and an output next to it
+    char dir[600], script[700], path[800], text[2048], out[4096];
+    snprintf(dir, sizeof(dir), "%s", g_script);
+    *strrchr(dir, '/') = 0;
+    strcat(dir, "/build");
+    mkdir(dir, 0700);
+    snprintf(path, sizeof(path), "%s/src", dir);
+    mkdir(path, 0700);
+    snprintf(script, sizeof(script), "%s/job.ps1", dir);
+    WriteFile(script, "Write-Output 'build'\n");
+    snprintf(path, sizeof(path), "%s/src/one.txt", dir);
+    WriteFile(path, "one");
+    snprintf(path, sizeof(path), "%s/src/two.txt", dir);
+    unlink(path);
+
+    // Manifests left by an earlier run of this test would skip the first run
+    snprintf(text, sizeof(text), "rm -rf '%s/ps-launcher/manifests'", g_stateDir);
+    CHECK(system(text) == 0);
+    snprintf(path, sizeof(path), "%s/out.txt", dir);
+    WriteFile(path, "result");
+
+    snprintf(path, sizeof(path), "%s/ps-launcher/ps-launcher.catalog", g_stateDir);
+    snprintf(text, sizeof(text),
+             "profile build\ninputs build src/*.txt\noutputs build out.txt\n"
+             "alias job \"%s\" build\n", script);
+    WriteFile(path, text);
+    char* index[] = { "-Index", NULL };
+    CHECK(Launch(index, out, sizeof(out)) == 0);
+
+    // First run records; the second is skipped with the recorded exit code
+    char* job[] = { "-Script", "@job", NULL };
+    CHECK(Launch(job, out, sizeof(out)) == 0);
+    CHECK(strstr(out, "job.ps1") != NULL);
+    CHECK(Launch(job, out, sizeof(out)) == 0);
+    CHECK(out[0] == 0);  // Interpreter never ran
+
+    // Other parameters are another run; a failed run is never recorded
+    char* failing[] = { "-Script", "@job", "-ExitCode", "3", NULL };
+    CHECK(Launch(failing, out, sizeof(out)) == 3);
+    CHECK(Launch(failing, out, sizeof(out)) == 3);
+    CHECK(out[0] != 0);
+
+    // A new input runs it again
+    snprintf(path, sizeof(path), "%s/src/two.txt", dir);
+    WriteFile(path, "two");
+    CHECK(Launch(job, out, sizeof(out)) == 0);
+    CHECK(out[0] != 0);
+    CHECK(Launch(job, out, sizeof(out)) == 0);
+    CHECK(out[0] == 0);
+}
+
+static void TestResultCache(void)
+{
+    char path[600], text[1200], first[4096], out[4096];
+    snprintf(text, sizeof(text), "rm -rf '%s/ps-launcher/results'", g_stateDir);
+    CHECK(system(text) == 0);
+    snprintf(path, sizeof(path), "%s/ps-launcher/ps-launcher.catalog", g_stateDir);
+    snprintf(text, sizeof(text),
+             "profile query -Format Table\ncache query 300 stdout\n"
+             "profile status\ncache status 300\n"
+             "alias inventory \"%s\" query\nalias status \"%s\" status\n", g_script, g_script);
+    WriteFile(path, text);
+    char* index[] = { "-Index", NULL };
+    CHECK(Launch(index, out, sizeof(out)) == 0);
+
+    // The second call is served from the cache, output and exit code alike
+    char* inventory[] = { "-Script", "@inventory", "-ExitCode", "5", NULL };
+    CHECK(Launch(inventory, first, sizeof(first)) == 5);
+    CHECK(strstr(first, "[-Format]\n[Table]\n") != NULL);
+    CHECK(Launch(inventory, out, sizeof(out)) == 5);
+    CHECK(strcmp(out, first) == 0);
+
+    // Parameter names fold, values do not
+    char* folded[] = { "-Script", "@inventory", "-exitcode", "5", NULL };
+    CHECK(Launch(folded, out, sizeof(out)) == 5);
+    char* other[] = { "-Script", "@inventory", "-ExitCode", "6", NULL };
+    CHECK(Launch(other, out, sizeof(out)) == 6);
+
+    // Without "stdout" only the exit code is kept: the hit prints nothing
+    char* status[] = { "-Script", "@status", "-ExitCode", "2", NULL };
+    CHECK(Launch(status, out, sizeof(out)) == 2);
+    CHECK(out[0] != 0);
+    CHECK(Launch(status, out, sizeof(out)) == 2);
+    CHECK(out[0] == 0);
+}
+#endif
+
+#ifdef ENABLE_RUN_JOURNAL
+// A journal line with this status and a script starting with script; the
+// run and parent ids sit between the two
+static bool JournalMatch(const char* line, const char* status, const char* script)
+{
+    char field[64];
+    snprintf(field, sizeof(field), "\t%s\t", status);
+    const char* p = strstr(line, field);
+    if (!p)
+        return false;
+    p += strlen(field);
+    for (int skip = 0; skip < 2 && p; skip++)
+    {
+        p = strchr(p, '\t');
+        p = p ? p + 1 : NULL;
+    }
+    return p && strncmp(p, script, strlen(script)) == 0;
+}
+#endif
+
+#if defined(ENABLE_SCHEDULER) && defined(ENABLE_RUN_JOURNAL)
+// Journal lines with this status and script
+static int CountJournal(const char* status, const char* script)
+{
+    char path[600];
+    char line[2048];
+    snprintf(path, sizeof(path), "%s/ps-launcher/ps-launcher.runs", g_stateDir);
+    FILE* f = fopen(path, "r");
+    int count = 0;
+    while (f && fgets(line, sizeof(line), f))
+        count += JournalMatch(line, status, script);
+    if (f)
+        fclose(f);
+    return count;
+}
+
+static void TestResidentScheduler(void)
+{
+    char path[600], job[600], text[2048], out[256];
+    snprintf(path, sizeof(path), "%s/test.schedule", g_stateDir);
+    snprintf(job, sizeof(job), "%s/scheduled job.ps1", g_stateDir);
+    WriteFile(job, "");
+
+    // A schedule that does not load is an error straight away
+    WriteFile(path, "@every 1s\n");
+    char* schedule[] = { "-Schedule", path, NULL };
+    CHECK(Launch(schedule, out, sizeof(out)) == 1);
+
+    // One quick entry and one that overruns its interval
+    snprintf(text, sizeof(text),
+             "# test schedule\n"
+             "@every 1s -Script \"%s\" -Tag fast\n"
+             "@every 1s -Script \"%s\" -Tag slow -SleepMs 2500\n", job, g_script);
+    WriteFile(path, text);
+    int before = CountJournal("completed", job);
+    int overlapsBefore = CountJournal("overlap", "-Script");
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+    char* argv[] = { (char*)g_launcher, "-Schedule", path, NULL };
+    extern char** environ;
+    pid_t pid;
+    int rc = posix_spawn(&pid, g_launcher, &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    CHECK(rc == 0);
+    if (rc != 0)
+        return;
+
+    // Deleting the file stops the scheduler at its next wake
+    usleep(3300 * 1000);
+    unlink(path);
+    int status;
+    waitpid(pid, &status, 0);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    usleep(200 * 1000);                 // The last quick run finishing
+    CHECK(CountJournal("completed", job) - before >= 2);
+    CHECK(CountJournal("overlap", "-Script") - overlapsBefore >= 1);
+}
+
+#ifdef ENABLE_CATALOG
+// Two entries every second whose profile holds a tag with limit 1: their
+// runs take turns, never overlapping in the journal
+static void TestSchedulerResourceTags(void)
+{
+    char source[600], path[600], job[600], text[2048], out[256], line[2048];
+    snprintf(source, sizeof(source), "%s/ps-launcher/ps-launcher.catalog", g_stateDir);
+    snprintf(path, sizeof(path), "%s/tags.schedule", g_stateDir);
+    snprintf(job, sizeof(job), "%s/tagged job.ps1", g_stateDir);
+    WriteFile(job, "");
+    snprintf(text, sizeof(text),
+             "resource db 1\n"
+             "profile locked -SleepMs 600\n"
+             "tags locked db\n"
+             "alias first \"%s\" locked\n"
+             "alias second \"%s\" locked\n", job, job);
+    WriteFile(source, text);
+    char* index[] = { "-Index", NULL };
+    CHECK(Launch(index, out, sizeof(out)) == 0);
+
+    WriteFile(path, "@every 1s -Script @first\n@every 1s -Script @second\n");
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+    char* argv[] = { (char*)g_launcher, "-Schedule", path, NULL };
+    extern char** environ;
+    pid_t pid;
+    int rc = posix_spawn(&pid, g_launcher, &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    CHECK(rc == 0);
+    if (rc != 0)
+        return;
+    usleep(3300 * 1000);
+    unlink(path);
+    int status;
+    waitpid(pid, &status, 0);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    usleep(800 * 1000);                 // A run still holding the tag
+
+    // Journal order is finishing order; with one holder at a time each run
+    // starts after the one before it ended
+    snprintf(path, sizeof(path), "%s/ps-launcher/ps-launcher.runs", g_stateDir);
+    FILE* f = fopen(path, "r");
+    unsigned long long start, micros, lastEnd = 0;
+    int runs = 0;
+    bool apart = true;
+    while (f && fgets(line, sizeof(line), f))
+    {
+        bool tagged = JournalMatch(line, "completed", "@first") || JournalMatch(line, "completed", "@second");
+        if (!tagged || sscanf(line, "%llu\t%llu", &start, &micros) != 2)
+            continue;
+        apart = apart && start >= lastEnd;
+        lastEnd = start + micros / 1000;
+        runs++;
+    }
+    if (f)
+        fclose(f);
+    CHECK(runs >= 2);
+    CHECK(apart);
+}
+#endif
+#endif
+
+#ifdef ENABLE_WATCH
+static void TestWatchBatches(void)
+{
+    char dir[600], file[700], output[600], line[256];
+    snprintf(dir, sizeof(dir), "%s/watched", g_stateDir);
+    snprintf(output, sizeof(output), "%s/watch.out", g_stateDir);
+    mkdir(dir, 0700);
+    for (int i = 0; i < 3; i++)
+    {
+        snprintf(file, sizeof(file), "%s/before-%d.txt", dir, i);
+        WriteFile(file, "x");
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, 1, output, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    char* argv[] = { (char*)g_launcher, "-Watch", dir, "-Debounce", "200",
+                     "-Script", g_script, "-Tag", "watched", NULL };
+    extern char** environ;
+    pid_t pid;
+    int rc = posix_spawn(&pid, g_launcher, &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    CHECK(rc == 0);
+    if (rc != 0)
+        return;
+
+    // The files present at start run at once; a burst is a few batches,
+    // not one run per file
+    usleep(500 * 1000);
+    for (int i = 0; i < 1000; i++)
+    {
+        snprintf(file, sizeof(file), "%s/burst-%04d.txt", dir, i);
+        WriteFile(file, "x");
+    }
+    usleep(1500 * 1000);
+
+    // Deleting the directory stops the watch
+    char command[700];
+    snprintf(command, sizeof(command), "rm -rf '%s'", dir);
+    CHECK(system(command) == 0);
+    int status;
+    waitpid(pid, &status, 0);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    int runs = 0, changes = 0, tagged = 0, count;
+    FILE* f = fopen(output, "r");
+    while (f && fgets(line, sizeof(line), f))
+    {
+        tagged += strcmp(line, "[watched]\n") == 0;
+        if (sscanf(line, "[changes %d]", &count) == 1)
+        {
+            runs++;
+            changes += count;
+        }
+    }
+    if (f)
+        fclose(f);
+    CHECK(changes == 1003);
+    CHECK(runs >= 2 && runs <= 6);
+    CHECK(tagged == runs);
+}
+#endif
+
+#ifdef ENABLE_STATUS_BOARD
+// A run shows on the board while it goes and is gone once it ends
+static void TestStatusBoard(void)
+{
+    char board[64], out[4096], object[128];
+    snprintf(board, sizeof(board), "psl-launcher-test-%d", (int)getpid());
+    setenv("PS_LAUNCHER_STATUS_BOARD", board, 1);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+    char* argv[] = { (char*)g_launcher, "-Script", g_script, "-SleepMs", "1500", NULL };
+    extern char** environ;
+    pid_t pid;
+    int rc = posix_spawn(&pid, g_launcher, &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    CHECK(rc == 0);
+
+    char* status[] = { "-Status", NULL };
+    bool seen = false;
+    for (int i = 0; i < 50 && rc == 0 && !seen; i++)
+    {
+        usleep(20 * 1000);
+        CHECK(Launch(status, out, sizeof(out)) == 0);
+        seen = strstr(out, "running") != NULL && strstr(out, g_script) != NULL;
+    }
+    CHECK(strncmp(out, "RUN", 3) == 0);
+    CHECK(seen);
+
+    int exitStatus;
+    if (rc == 0)
+        waitpid(pid, &exitStatus, 0);
+    CHECK(Launch(status, out, sizeof(out)) == 0);
+    CHECK(strstr(out, g_script) == NULL);
+
+    unsetenv("PS_LAUNCHER_STATUS_BOARD");
+    snprintf(object, sizeof(object), "/%s-%u", board, (unsigned)getuid());
+    shm_unlink(object);
+}
+#endif
+
+#ifdef ENABLE_RUN_JOURNAL
+static void TestRunJournalWritten(void)
+{
+    char path[600];
+    char line[1024];
+    snprintf(path, sizeof(path), "%s/ps-launcher/ps-launcher.runs", g_stateDir);
+    FILE* f = fopen(path, "r");
+    CHECK(f != NULL);
+    if (!f)
+        return;
+
+    int completed = 0, blocked = 0, stale = 0, upToDate = 0, cached = 0;
+    while (fgets(line, sizeof(line), f))
+    {
+        completed += strstr(line, "\tcompleted\t") != NULL;
+        blocked += strstr(line, "\tblocked\t") != NULL;
+        stale += JournalMatch(line, "stale", "@Hello");
+        upToDate += JournalMatch(line, "up-to-date", "@job");
+        cached += JournalMatch(line, "cached", "@");
+    }
+    fclose(f);
+    CHECK(completed >= 2);
+    CHECK(blocked >= 1);
+#ifdef ENABLE_CATALOG
+    CHECK(stale == g_extras);
+    CHECK(upToDate == 2 * g_extras);
+    CHECK(cached == 3 * g_extras);
+#else
+    (void)stale;
+    (void)upToDate;
+    (void)cached;
+#endif
+}
+#endif
+
+// The script sees its run id, and the run it was started from as parent
+static void TestRunIdsPassed(void)
+{
+    static const char parent[] = "01ARYZ6S410000000000000002";
+    char out[1024], id[32] = "";
+    setenv("PS_LAUNCHER_RUN_ID", parent, 1);
+    char* run[] = { "-Script", g_script, "-PrintEnv", "PS_LAUNCHER_RUN_ID",
+                    "-PrintEnv", "PS_LAUNCHER_PARENT_ID", NULL };
+    CHECK(Launch(run, out, sizeof(out)) == 0);
+    unsetenv("PS_LAUNCHER_RUN_ID");
+
+    const char* at = strstr(out, "[PS_LAUNCHER_RUN_ID=");
+    CHECK(at != NULL);
+    if (!at)
+        return;
+    at += strlen("[PS_LAUNCHER_RUN_ID=");
+    const char* end = strchr(at, ']');
+    CHECK(end && end - at == 26);
+    if (end && end - at == 26)
+        memcpy(id, at, 26);
+    CHECK(strcmp(id, parent) != 0 && strcmp(id, "01ARYZ6S41") > 0);
+    char line[128];
+    snprintf(line, sizeof(line), "[PS_LAUNCHER_PARENT_ID=%s]", parent);
+    CHECK(strstr(out, line) != NULL);
+
+#ifdef ENABLE_RUN_JOURNAL
+    // The same pair in its journal line
+    char path[600], text[2048];
+    snprintf(path, sizeof(path), "%s/ps-launcher/ps-launcher.runs", g_stateDir);
+    snprintf(line, sizeof(line), "\tcompleted\t%s\t%s\t", id, parent);
+    FILE* f = fopen(path, "r");
+    int found = 0;
+    while (f && fgets(text, sizeof(text), f))
+        found += strstr(text, line) != NULL;
+    if (f)
+        fclose(f);
+    CHECK(found == 1);
+#endif
+}
+
+// A probed run: same output and exit code, and where its time went
+static void TestStartupProbe(void)
+{
+    char out[1024], expected[700];
+    setenv("PS_LAUNCHER_PROBE", "1", 1);
+    char* run[] = { "-Script", g_script, "-Name", "it's", "-ExitCode", "4", NULL };
+    CHECK(Launch(run, out, sizeof(out)) == 4);
+    unsetenv("PS_LAUNCHER_PROBE");
+    snprintf(expected, sizeof(expected), "[%s]\n[-Name]\n[it's]\n[-ExitCode]\n[4]\n", g_script);
+    CHECK(strcmp(out, expected) == 0);
+
+#ifdef ENABLE_LOGGING
+    char path[600], text[4096];
+    snprintf(path, sizeof(path), "%s/ps-launcher/ps-launcher.log", g_stateDir);
+    FILE* f = fopen(path, "r");
+    size_t n = f ? fread(text, 1, sizeof(text) - 1, f) : 0;
+    if (f)
+        fclose(f);
+    text[n] = 0;
+    CHECK(strstr(text, "Interpreter startup (us): ") != NULL);
+    CHECK(strstr(text, "Script body (us): ") != NULL);
+    CHECK(strstr(text, "Time to first output (us): ") != NULL);
+#endif
+#ifdef ENABLE_METRICS
+    static char metrics[256 * 1024];
+    char* show[] = { "-Metrics", NULL };
+    CHECK(Launch(show, metrics, sizeof(metrics)) == 0);
+    static const char* const kinds[] = { "interpreter_startup", "script_body", "first_output" };
+    for (size_t i = 0; i < sizeof(kinds) / sizeof(kinds[0]); i++)
+    {
+        snprintf(expected, sizeof(expected), "ps_launcher_%s_seconds_count{script=\"%s\",exit=\"error\"} 1\n",
+                 kinds[i], g_script);
+        CHECK(strstr(metrics, expected) != NULL);
+    }
+#endif
+}
+
+#ifdef ENABLE_METRICS
+// The runs above, as histograms; a run that says when it was queued
+static void TestMetricsRecorded(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    char queued[32];
+    snprintf(queued, sizeof(queued), "%llu", (unsigned long long)now.tv_sec * 1000000000ull + (unsigned long long)now.tv_nsec);
+    setenv("PS_LAUNCHER_QUEUED_NS", queued, 1);
+    static char out[256 * 1024];
+    char* run[] = { "-Script", g_script, NULL };
+    CHECK(Launch(run, out, sizeof(out)) == 0);
+    unsetenv("PS_LAUNCHER_QUEUED_NS");
+
+    char* metrics[] = { "-Metrics", NULL };
+    CHECK(Launch(metrics, out, sizeof(out)) == 0);
+    char line[800];
+    snprintf(line, sizeof(line), "ps_launcher_duration_seconds_count{script=\"%s\",exit=\"ok\"} ", g_script);
+    const char* count = strstr(out, line);
+    CHECK(count && strtoul(count + strlen(line), NULL, 10) >= 2);
+    snprintf(line, sizeof(line), "ps_launcher_duration_seconds_count{script=\"%s\",exit=\"error\"} ", g_script);
+    CHECK(strstr(out, line) != NULL);
+    snprintf(line, sizeof(line), "ps_launcher_queue_wait_seconds_count{script=\"%s\",exit=\"ok\"} 1\n", g_script);
+    CHECK(strstr(out, line) != NULL);
+    CHECK(strstr(out, "ps_launcher_launch_overhead_seconds_count{script=\"/nonexistent/x.ps1\",exit=\"failed\"} ") != NULL);
+
+    char* json[] = { "-Metrics", "-Json", NULL };
+    CHECK(Launch(json, out, sizeof(out)) == 0);
+    CHECK(strstr(out, "\"exit\":\"error\",\"metric\":\"duration\",\"count\":") != NULL);
+    char* missing[] = { "-Metrics", "/nonexistent/other.metrics", NULL };
+    CHECK(Launch(missing, out, sizeof(out)) == 1);
+}
+#endif
+
+#ifdef ENABLE_TRACE
+// One launch in the trace file: its phases on one track, named after it
+static void TestTraceWritten(void)
+{
+    char path[600], out[1024];
+    snprintf(path, sizeof(path), "%s/launch.trace.json", g_stateDir);
+    unlink(path);
+    setenv("PS_LAUNCHER_TRACE", path, 1);
+    char* run[] = { "-Script", g_script, "-ExitCode", "3", NULL };
+    CHECK(Launch(run, out, sizeof(out)) == 3);
+    unsetenv("PS_LAUNCHER_TRACE");
+
+    static char text[64 * 1024];
+    FILE* f = fopen(path, "rb");
+    size_t n = f ? fread(text, 1, sizeof(text) - 1, f) : 0;
+    if (f)
+        fclose(f);
+    text[n] = 0;
+    CHECK(strncmp(text, "[\n", 2) == 0);
+    CHECK(strstr(text, "\"ph\":\"M\"") != NULL && strstr(text, "test script.ps1\",\"runId\":\"") != NULL);
+    static const char* const phases[] = { "startup", "resolve", "checks", "spawn", "run", "finish" };
+    for (size_t i = 0; i < sizeof(phases) / sizeof(phases[0]); i++)
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "{\"name\":\"%s\",\"ph\":\"X\"", phases[i]);
+        CHECK(strstr(text, name) != NULL);
+    }
+    CHECK(strstr(text, "\"args\":{\"runId\":\"") != NULL && strstr(text, "\",\"exitCode\":3}") != NULL);
+    unlink(path);
+}
+#endif
+
+int main(int argc, char** argv)
+{
+    g_extras = argc == 5 && strcmp(argv[4], "--extras") == 0;
+    if (argc != 4 && !g_extras)
+    {
+        fprintf(stderr, "usage: test_launcher <ps-launcher> <interpreter> <scratch dir> [--extras]\n");
+        return 2;
+    }
+    g_launcher = argv[1];
+
+    // Isolated state directory and a script file that exists
+    snprintf(g_stateDir, sizeof(g_stateDir), "%s/state", argv[3]);
+    snprintf(g_script, sizeof(g_script), "%s/test script.ps1", argv[3]);
+    mkdir(argv[3], 0700);
+    FILE* f = fopen(g_script, "w");
+    if (f)
+        fclose(f);
+    char journal[600];
+    snprintf(journal, sizeof(journal), "%s/ps-launcher/ps-launcher.runs", g_stateDir);
+    unlink(journal);
+    snprintf(journal, sizeof(journal), "%s/ps-launcher/ps-launcher.metrics", g_stateDir);
+    unlink(journal);
+
+    setenv("PS_LAUNCHER_INTERPRETER", argv[2], 1);
+    setenv("XDG_STATE_HOME", g_stateDir, 1);
+
+    RUN_TEST(TestArgumentsDelivered);
+    RUN_TEST(TestExitCodePropagated);
+    RUN_TEST(TestUsageAndMissingScript);
+    RUN_TEST(TestSemicolonBlockedBeforeSpawn);
+    RUN_TEST(TestRunIdsPassed);
+    if (g_extras)
+    {
+        RUN_TEST(TestPackedLauncher);
+        RUN_TEST(TestScriptSearchPath);
+#ifdef ENABLE_CATALOG
+        RUN_TEST(TestCatalogAlias);
+        RUN_TEST(TestIncrementalSkip);
+        RUN_TEST(TestResultCache);
+#endif
+#if defined(ENABLE_SCHEDULER) && defined(ENABLE_RUN_JOURNAL)
+        RUN_TEST(TestResidentScheduler);
+#ifdef ENABLE_CATALOG
+        RUN_TEST(TestSchedulerResourceTags);
+#endif
+#endif
+#ifdef ENABLE_WATCH
+        RUN_TEST(TestWatchBatches);
+#endif
+#ifdef ENABLE_STATUS_BOARD
+        RUN_TEST(TestStatusBoard);
+#endif
+        RUN_TEST(TestStartupProbe);
+    }
+#ifdef ENABLE_RUN_JOURNAL
+    RUN_TEST(TestRunJournalWritten);
+#endif
+#ifdef ENABLE_METRICS
+    if (g_extras)
+        RUN_TEST(TestMetricsRecorded);
+#endif
+#ifdef ENABLE_TRACE
+    if (g_extras)
+        RUN_TEST(TestTraceWritten);
+#endif
+    return TEST_SUMMARY();
+}
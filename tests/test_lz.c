@@ -0,0 +1,114 @@
+//--------------------------------------------------------------------------
+// TESTS: lz.c
+//--------------------------------------------------------------------------
+#include "lz.h"
+#include "psmem.h"
+#include "testing.h"
+
+static uint32_t g_workspace[LZ_WORKSPACE_SIZE / 4];
+static uint8_t g_packed[LZ_COMPRESS_BOUND(200000)];
+static uint8_t g_unpacked[200000];
+
+static uint32_t g_seed = 12345;
+static uint32_t NextRandom(void)
+{
+    g_seed = g_seed * 1103515245u + 12345u;
+    return g_seed >> 16;
+}
+
+// Compress, decompress and compare; returns the packed size
+static size_t RoundTrip(const uint8_t* data, size_t size)
+{
+    size_t packed = LzCompress(data, size, g_packed, sizeof(g_packed), g_workspace);
+    CHECK(packed > 0 && packed <= LZ_COMPRESS_BOUND(size));
+    CHECK(LzDecompress(g_packed, packed, g_unpacked, size));
+    size_t i = 0;
+    while (i < size && g_unpacked[i] == data[i])
+        i++;
+    CHECK(i == size);
+    return packed;
+}
+
+static void TestSmallInputs(void)
+{
+    static const uint8_t text[] = "Write-Host 'Hello'; Write-Host 'Hello'; Write-Host 'Hello'";
+    for (size_t n = 0; n < sizeof(text); n++)
+        RoundTrip(text, n);
+}
+
+static void TestCompressesScripts(void)
+{
+    static uint8_t script[60000];
+    static const char line[] = "    Write-Output \"Processing item $i of $($items.Count)\"\r\n";
+    size_t size = 0;
+    for (int i = 0; size + sizeof(line) < sizeof(script); i++)
+    {
+        PsMemCpy(script + size, line, sizeof(line) - 1);
+        size += sizeof(line) - 1;
+        script[size++] = (uint8_t)('0' + i % 10);
+    }
+    CHECK(RoundTrip(script, size) < size / 4);
+}
+
+// Long runs exercise length extensions and overlapping copies
+static void TestLongRuns(void)
+{
+    static uint8_t data[70000];
+    PsMemSet(data, 'a', sizeof(data));
+    CHECK(RoundTrip(data, sizeof(data)) < 400);
+
+    for (size_t i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t)"abc"[i % 3];
+    RoundTrip(data, sizeof(data));
+}
+
+static void TestIncompressible(void)
+{
+    static uint8_t data[100000];
+    for (size_t i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t)NextRandom();
+    size_t packed = RoundTrip(data, sizeof(data));
+    CHECK(packed > sizeof(data));
+
+    // Too small an output buffer is reported, not overrun
+    CHECK(LzCompress(data, sizeof(data), g_packed, sizeof(data), g_workspace) == 0);
+}
+
+static void TestMalformedRejected(void)
+{
+    static const uint8_t text[] = "abcdabcdabcdabcdabcdabcdabcdabcd-end";
+    size_t size = sizeof(text) - 1;
+    size_t packed = LzCompress(text, size, g_packed, sizeof(g_packed), g_workspace);
+    CHECK(packed > 0);
+
+    // Truncated input, wrong expected size
+    for (size_t n = 0; n < packed; n++)
+        CHECK(!LzDecompress(g_packed, n, g_unpacked, size));
+    CHECK(!LzDecompress(g_packed, packed, g_unpacked, size - 1));
+    CHECK(!LzDecompress(g_packed, packed, g_unpacked, size + 1));
+
+    // Offset reaching before the start of the output
+    static const uint8_t badOffset[] = { 0x10, 'a', 0x05, 0x00, 0x00 };
+    CHECK(!LzDecompress(badOffset, sizeof(badOffset), g_unpacked, 5));
+    static const uint8_t zeroOffset[] = { 0x10, 'a', 0x00, 0x00, 0x00 };
+    CHECK(!LzDecompress(zeroOffset, sizeof(zeroOffset), g_unpacked, 5));
+
+    // Random garbage must fail cleanly (checked under sanitizers too)
+    static uint8_t garbage[256];
+    for (int round = 0; round < 2000; round++)
+    {
+        for (size_t i = 0; i < sizeof(garbage); i++)
+            garbage[i] = (uint8_t)NextRandom();
+        LzDecompress(garbage, 1 + NextRandom() % sizeof(garbage), g_unpacked, NextRandom() % 4096);
+    }
+}
+
+int main(void)
+{
+    RUN_TEST(TestSmallInputs);
+    RUN_TEST(TestCompressesScripts);
+    RUN_TEST(TestLongRuns);
+    RUN_TEST(TestIncompressible);
+    RUN_TEST(TestMalformedRejected);
+    return TEST_SUMMARY();
+}
@@ -0,0 +1,289 @@
+//--------------------------------------------------------------------------
+// TESTS: metrics.c histograms, the shared table and its exposition
+//--------------------------------------------------------------------------
+// Tables are files under /tmp named for this process, removed at the end.
+// Concurrent recording is checked with forked recorders adding to the same
+// series and claiming new ones at the same time.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "metrics.h"
+#include "testing.h"
+
+#define RECORDERS       4
+#define SAMPLES_EACH    20000
+
+static char g_table[64];
+static char g_other[64];
+static char g_text[64];
+
+static void TestBucketBounds(void)
+{
+    // Every value lies inside its bucket, and buckets leave no gaps
+    bool inside = true, contiguous = true, narrow = true;
+    for (uint64_t v = 0; v < 200000; v += 1 + v / 64)
+    {
+        uint32_t i = HistogramIndex(v);
+        inside = inside && HistogramLowest(i) <= v && v <= HistogramHighest(i);
+    }
+    for (uint32_t i = 0; i + 1 < METRICS_BUCKETS; i++)
+    {
+        contiguous = contiguous && HistogramHighest(i) + 1 == HistogramLowest(i + 1);
+        uint64_t width = HistogramHighest(i) - HistogramLowest(i) + 1;
+        narrow = narrow && (i < 32 ? width == 1 : width * METRICS_SUB_COUNT <= HistogramLowest(i));
+    }
+    CHECK(inside);
+    CHECK(contiguous);
+    CHECK(narrow);
+    CHECK(HistogramIndex(31) == 31 && HistogramIndex(32) == 32 && HistogramIndex(63) == 47);
+    CHECK(HistogramIndex(((uint64_t)1 << 37) - 1) == METRICS_BUCKETS - 1);
+    CHECK(HistogramIndex(UINT64_MAX) == METRICS_BUCKETS - 1);     // Clamped, not wrapped
+}
+
+static void TestQuantiles(void)
+{
+    static Histogram h;
+    CHECK(HistogramQuantile(&h, 500000) == 0);
+    for (uint64_t v = 1; v <= 10000; v++)
+        HistogramRecord(&h, v);
+    CHECK(h.count == 10000 && h.sum == 50005000);
+
+    // Reported as the bucket's highest value: never below, at most 1/16 above
+    uint64_t p50 = HistogramQuantile(&h, 500000);
+    uint64_t p99 = HistogramQuantile(&h, 990000);
+    uint64_t max = HistogramQuantile(&h, 1000000);
+    CHECK(p50 >= 5000 && p50 <= 5000 + 5000 / 16);
+    CHECK(p99 >= 9900 && p99 <= 9900 + 9900 / 16);
+    CHECK(max >= 10000 && max <= 10000 + 10000 / 16);
+    CHECK(HistogramQuantile(&h, 0) == 1);
+}
+
+static void TestMerge(void)
+{
+    static Histogram a, b, all;
+    for (uint64_t v = 0; v < 5000; v++)
+    {
+        HistogramRecord(v % 3 ? &a : &b, v * 37);
+        HistogramRecord(&all, v * 37);
+    }
+    HistogramMerge(&a, &b);
+    CHECK(memcmp(&a, &all, sizeof(a)) == 0);
+}
+
+static void TestClassify(void)
+{
+    CHECK(ClassifyRun(RUN_COMPLETED, 0) == EXIT_CLASS_OK);
+    CHECK(ClassifyRun(RUN_COMPLETED, 1) == EXIT_CLASS_ERROR);
+    CHECK(ClassifyRun(RUN_COMPLETED, 127) == EXIT_CLASS_ERROR);
+    CHECK(ClassifyRun(RUN_COMPLETED, 137) == EXIT_CLASS_ABNORMAL);
+    CHECK(ClassifyRun(RUN_CACHED, 0) == EXIT_CLASS_SKIPPED);
+    CHECK(ClassifyRun(RUN_UP_TO_DATE, 3) == EXIT_CLASS_SKIPPED);
+    CHECK(ClassifyRun(RUN_NOT_FOUND, 1) == EXIT_CLASS_FAILED);
+    CHECK(ClassifyRun(RUN_SPAWN_FAILED, 2) == EXIT_CLASS_FAILED);
+}
+
+static void TestStoreClaim(void)
+{
+    MetricsStore store, again;
+    CHECK(MetricsOpen(&store, g_table));
+    Histogram* ok = MetricsFind(&store, "/srv/a.ps1", EXIT_CLASS_OK, METRIC_DURATION, NULL);
+    Histogram* err = MetricsFind(&store, "/srv/a.ps1", EXIT_CLASS_ERROR, METRIC_DURATION, NULL);
+    CHECK(ok && err && ok != err);
+    CHECK(MetricsFind(&store, "/srv/a.ps1", EXIT_CLASS_OK, METRIC_DURATION, NULL) == ok);
+    HistogramRecord(ok, 1234);
+
+    // A second mapping sees the same series and sample
+    CHECK(MetricsOpen(&again, g_table));
+    Histogram* seen = MetricsFind(&again, "/srv/a.ps1", EXIT_CLASS_OK, METRIC_DURATION, NULL);
+    CHECK(seen && seen->count == 1 && seen->sum == 1234);
+    MetricsClose(&again);
+
+    // Full: every slot holds a series, the next new one has nowhere to go
+    char name[32];
+    int claimed = 2;
+    for (int i = 0; i < METRICS_SLOTS; i++)
+    {
+        snprintf(name, sizeof(name), "/srv/s%d.ps1", i);
+        claimed += MetricsFind(&store, name, EXIT_CLASS_OK, METRIC_OVERHEAD, NULL) != NULL;
+    }
+    CHECK(claimed == METRICS_SLOTS);
+    CHECK(MetricsFind(&store, "/srv/a.ps1", EXIT_CLASS_OK, METRIC_QUEUE, NULL) == ok - METRIC_DURATION + METRIC_QUEUE);
+    MetricsClose(&store);
+    unlink(g_table);
+
+    // Not a metrics table: rejected, not reinitialised
+    FILE* f = fopen(g_table, "wb");
+    fputs("not a table", f);
+    fclose(f);
+    CHECK(truncate(g_table, 4 << 20) == 0);
+    FILE* g = fopen(g_table, "r+b");
+    fputs("JUNK", g);
+    fclose(g);
+    CHECK(!MetricsOpen(&store, g_table));
+    unlink(g_table);
+}
+
+static void TestConcurrentRecorders(void)
+{
+    pid_t pids[RECORDERS];
+    for (int r = 0; r < RECORDERS; r++)
+    {
+        pids[r] = fork();
+        if (pids[r] == 0)
+        {
+            MetricsStore store;
+            if (!MetricsOpen(&store, g_table))
+                _exit(1);
+            char name[32];
+            for (int i = 0; i < SAMPLES_EACH; i++)
+            {
+                Histogram* h = MetricsFind(&store, "/srv/shared.ps1", EXIT_CLASS_OK, METRIC_DURATION, NULL);
+                if (!h)
+                    _exit(1);
+                HistogramRecord(h, (uint64_t)i);
+                // New series claimed while the others record: one slot each
+                snprintf(name, sizeof(name), "/srv/new%d.ps1", i / 1000 % 16);
+                if (i % 1000 == 0 && !MetricsFind(&store, name, EXIT_CLASS_OK, METRIC_OVERHEAD, NULL))
+                    _exit(1);
+            }
+            _exit(0);
+        }
+    }
+    bool exited = true;
+    for (int r = 0; r < RECORDERS; r++)
+    {
+        int status;
+        waitpid(pids[r], &status, 0);
+        exited = exited && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    CHECK(exited);
+
+    MetricsStore store;
+    CHECK(MetricsOpen(&store, g_table));
+    Histogram* h = MetricsFind(&store, "/srv/shared.ps1", EXIT_CLASS_OK, METRIC_DURATION, NULL);
+    uint64_t buckets = 0;
+    for (int i = 0; i < METRICS_BUCKETS; i++)
+        buckets += h->buckets[i];
+    CHECK(h->count == (uint64_t)RECORDERS * SAMPLES_EACH);
+    CHECK(buckets == h->count);
+    CHECK(h->sum == (uint64_t)RECORDERS * SAMPLES_EACH * (SAMPLES_EACH - 1) / 2);
+    MetricsClose(&store);
+
+    // One series per name, however many recorders raced to claim it
+    size_t size = 0;
+    const void* image = PlatMapFile(g_table, &size);
+    Arena arena;
+    MetricsSet set;
+    CHECK(image && ArenaInit(&arena, 64 << 20) && MetricsSetInit(&set, &arena, METRICS_SLOTS));
+    CHECK(MetricsSetMerge(&set, image, size));
+    CHECK(set.count == 1 + 16);
+    PlatUnmapFile(image, size);
+    ArenaRelease(&arena);
+}
+
+static char* ReadAll(const char* path)
+{
+    static char text[1 << 20];
+    FILE* f = fopen(path, "rb");
+    size_t n = f ? fread(text, 1, sizeof(text) - 1, f) : 0;
+    if (f)
+        fclose(f);
+    text[n] = 0;
+    return text;
+}
+
+static void TestExport(void)
+{
+    // Two machines' tables, the same script in both; the later exemplar wins
+    MetricsStore a, b;
+    MetricsExemplar* last;
+    RunId newer = { 0x0123456789AB0000ull, 1 }, older = { 0x0123456789AA0000ull, 2 };
+    CHECK(MetricsOpen(&a, g_table) && MetricsOpen(&b, g_other));
+    HistogramRecord(MetricsFind(&a, "C:\\jobs\\say \"hi\".ps1", EXIT_CLASS_OK, METRIC_DURATION, &last), 2000);
+    ExemplarRecord(last, &newer, 2000, 1700000000500ull);
+    ExemplarRecord(last, &older, 9, 1700000000400ull);             // Recorded late, but older
+    CHECK(MetricsFind(&b, "C:\\jobs\\say \"hi\".ps1", EXIT_CLASS_OK, METRIC_DURATION, &last) != NULL);
+    ExemplarRecord(last, &older, 400, 1700000000100ull);
+    HistogramRecord(MetricsFind(&b, "C:\\jobs\\say \"hi\".ps1", EXIT_CLASS_OK, METRIC_DURATION, NULL), 2000000);
+    HistogramRecord(MetricsFind(&b, "C:\\jobs\\say \"hi\".ps1", EXIT_CLASS_OK, METRIC_DURATION, NULL), 400);
+    HistogramRecord(MetricsFind(&b, "/srv/b.ps1", EXIT_CLASS_FAILED, METRIC_OVERHEAD, NULL), 1500);
+    MetricsClose(&a);
+    MetricsClose(&b);
+
+    Arena arena;
+    MetricsSet set;
+    CHECK(ArenaInit(&arena, 64 << 20) && MetricsSetInit(&set, &arena, 2 * METRICS_SLOTS));
+    size_t size;
+    const void* image = PlatMapFile(g_table, &size);
+    CHECK(image && MetricsSetMerge(&set, image, size));
+    PlatUnmapFile(image, size);
+    image = PlatMapFile(g_other, &size);
+    CHECK(image && MetricsSetMerge(&set, image, size));
+    PlatUnmapFile(image, size);
+    CHECK(!MetricsSetMerge(&set, "PSLM", 4));
+
+    PlatFile out = PlatCreateFile(g_text, PLAT_FILE_OVERWRITE);
+    CHECK(MetricsFormatPrometheus(&arena, &set, out));
+    PlatCloseFile(out);
+    const char* text = ReadAll(g_text);
+    CHECK(strstr(text, "# TYPE ps_launcher_duration_seconds histogram\n") != NULL);
+    CHECK(strstr(text, "ps_launcher_duration_seconds_bucket{script=\"C:\\\\jobs\\\\say \\\"hi\\\".ps1\","
+                       "exit=\"ok\",le=\"0.001\"} 1\n") != NULL);
+    CHECK(strstr(text, "exit=\"ok\",le=\"0.005\"} 2\n") != NULL);
+    CHECK(strstr(text, "exit=\"ok\",le=\"2.5\"} 3\n") != NULL);
+    CHECK(strstr(text, "exit=\"ok\",le=\"+Inf\"} 3\n") != NULL);
+    CHECK(strstr(text, "ps_launcher_duration_seconds_sum{script=\"C:\\\\jobs\\\\say \\\"hi\\\".ps1\","
+                       "exit=\"ok\"} 2.0024\n") != NULL);
+    CHECK(strstr(text, "ps_launcher_duration_seconds_count{script=\"C:\\\\jobs\\\\say \\\"hi\\\".ps1\","
+                       "exit=\"ok\"} 3\n") != NULL);
+    CHECK(strstr(text, "ps_launcher_launch_overhead_seconds_count{script=\"/srv/b.ps1\",exit=\"failed\"} 1\n") != NULL);
+    CHECK(strstr(text, "exit=\"ok\",quantile=\"0.5\"} 0.002047\n") != NULL);
+    CHECK(strstr(text, "queue_wait_seconds_bucket") == NULL);       // No samples, no series
+    // The latest sample without its run id or time: the textfile collector
+    // rejects timestamps, and a run id label would add a series per run
+    CHECK(strstr(text, "# TYPE ps_launcher_duration_last_seconds gauge\n") != NULL);
+    CHECK(strstr(text, "ps_launcher_duration_last_seconds{script=\"C:\\\\jobs\\\\say \\\"hi\\\".ps1\","
+                       "exit=\"ok\"} 0.002\n") != NULL);
+    CHECK(strstr(text, "run_id") == NULL);
+
+    out = PlatCreateFile(g_text, PLAT_FILE_OVERWRITE);
+    CHECK(MetricsFormatJson(&arena, &set, out));
+    PlatCloseFile(out);
+    text = ReadAll(g_text);
+    CHECK(strncmp(text, "{\"unit\":\"us\",\"subBuckets\":16,\"series\":[", 39) == 0);
+    CHECK(strstr(text, "{\"script\":\"/srv/b.ps1\",\"exit\":\"failed\",\"metric\":\"launch_overhead\","
+                       "\"count\":1,\"sum\":1500,") != NULL);
+    char bucket[64];
+    snprintf(bucket, sizeof(bucket), "\"buckets\":[[%u,1],[%u,1],[%u,1]]",
+             HistogramIndex(400), HistogramIndex(2000), HistogramIndex(2000000));
+    CHECK(strstr(text, bucket) != NULL);
+    char run[RUN_ID_CHARS + 1], line[256];
+    RunIdFormat8(&newer, run);
+    snprintf(line, sizeof(line), "]],\"last\":{\"runId\":\"%s\",\"value\":2000,\"at\":1700000000500}}", run);
+    CHECK(strstr(text, line) != NULL);
+    ArenaRelease(&arena);
+}
+
+int main(void)
+{
+    snprintf(g_table, sizeof(g_table), "/tmp/psl-metrics-test-%d", (int)getpid());
+    snprintf(g_other, sizeof(g_other), "/tmp/psl-metrics-test-%d.other", (int)getpid());
+    snprintf(g_text, sizeof(g_text), "/tmp/psl-metrics-test-%d.txt", (int)getpid());
+
+    RUN_TEST(TestBucketBounds);
+    RUN_TEST(TestQuantiles);
+    RUN_TEST(TestMerge);
+    RUN_TEST(TestClassify);
+    RUN_TEST(TestStoreClaim);
+    RUN_TEST(TestConcurrentRecorders);
+    unlink(g_table);
+    RUN_TEST(TestExport);
+
+    unlink(g_table);
+    unlink(g_other);
+    unlink(g_text);
+    return TEST_SUMMARY();
+}
@@ -0,0 +1,136 @@
+//--------------------------------------------------------------------------
+// TESTS: payload.c and encoding.c
+//--------------------------------------------------------------------------
+#include "encoding.h"
+#include "payload.h"
+#include "psmem.h"
+#include "testing.h"
+
+static Arena g_arena;
+
+static bool BytesEqual(const void* a, const void* b, size_t n)
+{
+    const uint8_t* x = (const uint8_t*)a;
+    const uint8_t* y = (const uint8_t*)b;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (x[i] != y[i])
+            return false;
+    }
+    return true;
+}
+
+static const char g_first[] = "param($Name)\nWrite-Output \"Hello $Name\"\nWrite-Output \"Hello $Name\"\n";
+static const char g_second[] = "exit 3\n";
+
+static void* BuildSample(size_t* size)
+{
+    PayloadSource sources[] = {
+        { "Deploy.ps1", 10, g_first, sizeof(g_first) - 1 },
+        { "empty.ps1", 9, "", 0 },
+        { "second.ps1", 10, g_second, sizeof(g_second) - 1 },
+    };
+    return PayloadBuild(&g_arena, sources, 3, size);
+}
+
+static void TestBuildAndExtract(void)
+{
+    size_t size = 0;
+    uint8_t* payload = (uint8_t*)BuildSample(&size);
+    CHECK(payload != NULL);
+    CHECK(PayloadCount(payload, size) == 3);
+
+    // Lookup is case-insensitive on the exact name
+    CHECK(PayloadFind(payload, size, "deploy.PS1", 10) == 0);
+    CHECK(PayloadFind(payload, size, "second.ps1", 10) == 2);
+    CHECK(PayloadFind(payload, size, "second", 6) == -1);
+
+    PayloadScript script;
+    CHECK(PayloadGet(payload, size, 0, &script));
+    CHECK(script.rawSize == sizeof(g_first) - 1);
+    uint8_t* raw = PayloadExtract(&g_arena, &script);
+    CHECK(raw && BytesEqual(raw, g_first, script.rawSize));
+    CHECK_STR(PayloadScriptName(&g_arena, &script), PS_T("Deploy.ps1"));
+
+    CHECK(PayloadGet(payload, size, 1, &script));
+    CHECK(script.rawSize == 0 && PayloadExtract(&g_arena, &script) != NULL);
+
+    CHECK(PayloadGet(payload, size, 2, &script));
+    raw = PayloadExtract(&g_arena, &script);
+    CHECK(raw && BytesEqual(raw, g_second, script.rawSize));
+    CHECK(!PayloadGet(payload, size, 3, &script));
+}
+
+static void TestDamageDetected(void)
+{
+    size_t size = 0;
+    uint8_t* payload = (uint8_t*)BuildSample(&size);
+    CHECK(payload != NULL);
+    if (!payload)
+        return;
+
+    // Every truncation is rejected by the framing check
+    for (size_t n = 0; n < size; n++)
+        CHECK(PayloadCount(payload, n) == -1);
+    CHECK(PayloadCount(NULL, 0) == -1);
+
+    // A flipped bit in script data fails decompression or the checksum
+    PayloadScript script;
+    CHECK(PayloadGet(payload, size, 0, &script));
+    ((uint8_t*)script.packed)[script.packedSize - 1] ^= 0x01;
+    CHECK(PayloadExtract(&g_arena, &script) == NULL);
+
+    payload[0] = 'X';
+    CHECK(PayloadCount(payload, size) == -1);
+}
+
+static void TestBase64(void)
+{
+    static const char* const inputs[] = { "", "f", "fo", "foo", "foob", "fooba", "foobar" };
+    static const PSCHAR* const expected[] = {
+        PS_T(""), PS_T("Zg=="), PS_T("Zm8="), PS_T("Zm9v"),
+        PS_T("Zm9vYg=="), PS_T("Zm9vYmE="), PS_T("Zm9vYmFy")
+    };
+    for (int i = 0; i < 7; i++)
+    {
+        StrBuf sb;
+        CHECK(StrBufInit(&sb, &g_arena, 4, STRBUF_NO_LIMIT));
+        size_t n = 0;
+        while (inputs[i][n])
+            n++;
+        CHECK(StrBufAppendBase64(&sb, inputs[i], n));
+        CHECK_STR(sb.data, expected[i]);
+        CHECK(sb.len == BASE64_LENGTH(n));
+    }
+}
+
+static void TestUtf8ToUtf16(void)
+{
+    // A, e-acute, euro sign, U+1F600 (surrogate pair)
+    static const char text[] = "A\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80";
+    uint16_t out[16];
+    size_t n = Utf8ToUtf16(text, sizeof(text) - 1, out, 16);
+    CHECK(n == 5);
+    CHECK(out[0] == 'A' && out[1] == 0xE9 && out[2] == 0x20AC);
+    CHECK(out[3] == 0xD83D && out[4] == 0xDE00);
+
+    // Truncated, overlong and stray continuation bytes become U+FFFD
+    static const char bad[] = "\xE2\x82" "x" "\xC0\xAF" "\x80";
+    n = Utf8ToUtf16(bad, sizeof(bad) - 1, out, 16);
+    CHECK(n == 5);
+    CHECK(out[0] == 0xFFFD && out[1] == 'x' && out[2] == 0xFFFD && out[4] == 0xFFFD);
+
+    CHECK(Utf8ToUtf16(text, sizeof(text) - 1, out, 4) == 0);
+}
+
+int main(void)
+{
+    if (!ArenaInit(&g_arena, ARENA_COMMIT_GRANULE * 16))
+        return 1;
+    RUN_TEST(TestBuildAndExtract);
+    RUN_TEST(TestDamageDetected);
+    RUN_TEST(TestBase64);
+    RUN_TEST(TestUtf8ToUtf16);
+    ArenaRelease(&g_arena);
+    return TEST_SUMMARY();
+}
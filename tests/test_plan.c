@@ -0,0 +1,127 @@
+//--------------------------------------------------------------------------
+// TESTS: plan.c ready order, skipping and simulated makespans
+//--------------------------------------------------------------------------
+#include "plan.h"
+#include "testing.h"
+
+static Arena g_arena;
+
+// Take every ready job without finishing any
+static uint32_t Drain(PlanGraph* g, uint32_t* order, uint32_t max)
+{
+    uint32_t n = 0, job;
+    while (n < max && PlanNext(g, &job))
+        order[n++] = job;
+    return n;
+}
+
+static void TestLongestFirst(void)
+{
+    PlanJob jobs[] = { { 1, NULL, 0 }, { 5, NULL, 0 }, { 3, NULL, 0 }, { 5, NULL, 0 } };
+    PlanGraph g;
+    uint32_t order[4];
+    ArenaRestore(&g_arena, 0);
+    CHECK(PlanBuild(&g, &g_arena, jobs, 4, true) == PLAN_OK);
+    CHECK(Drain(&g, order, 4) == 4);
+    CHECK(order[0] == 1 && order[1] == 3 && order[2] == 2 && order[3] == 0);
+
+    // UNRANKED: The batch's own order, whatever the durations
+    CHECK(PlanBuild(&g, &g_arena, jobs, 4, false) == PLAN_OK);
+    CHECK(Drain(&g, order, 4) == 4);
+    CHECK(order[0] == 0 && order[1] == 1 && order[2] == 2 && order[3] == 3);
+}
+
+static void TestCriticalPath(void)
+{
+    // A short job gating a long one goes before a longer job alone
+    static const uint32_t after0[] = { 0 };
+    PlanJob jobs[] = { { 1, NULL, 0 }, { 10, after0, 1 }, { 8, NULL, 0 } };
+    PlanGraph g;
+    uint32_t job;
+    ArenaRestore(&g_arena, 0);
+    CHECK(PlanBuild(&g, &g_arena, jobs, 3, true) == PLAN_OK);
+    CHECK(g.rank[0] == 11 && g.rank[1] == 10 && g.rank[2] == 8);
+    CHECK(PlanNext(&g, &job) && job == 0);
+    CHECK(PlanNext(&g, &job) && job == 2);
+    CHECK(!PlanNext(&g, &job));
+    PlanDone(&g, 0, true);
+    CHECK(PlanNext(&g, &job) && job == 1);
+    PlanDone(&g, 2, true);
+    PlanDone(&g, 1, true);
+    CHECK(g.open == 0);
+}
+
+static void TestBadGraphs(void)
+{
+    static const uint32_t after0[] = { 0 }, after1[] = { 1 }, after2[] = { 2 }, after9[] = { 9 };
+    PlanGraph g;
+    ArenaRestore(&g_arena, 0);
+
+    PlanJob cycle[] = { { 1, after2, 1 }, { 1, after0, 1 }, { 1, after1, 1 } };
+    CHECK(PlanBuild(&g, &g_arena, cycle, 3, true) == PLAN_BAD_GRAPH);
+    PlanJob self[] = { { 1, after0, 1 } };
+    CHECK(PlanBuild(&g, &g_arena, self, 1, false) == PLAN_BAD_GRAPH);
+    PlanJob range[] = { { 1, NULL, 0 }, { 1, after9, 1 } };
+    CHECK(PlanBuild(&g, &g_arena, range, 2, false) == PLAN_BAD_GRAPH);
+
+    CHECK(PlanBuild(&g, &g_arena, NULL, 0, true) == PLAN_OK);
+    uint32_t job;
+    CHECK(!PlanNext(&g, &job) && g.open == 0);
+}
+
+static void TestFailureSkips(void)
+{
+    // 0 -> 1 -> 2, 1 -> 3 <- 4, and 5 alone
+    static const uint32_t after0[] = { 0 }, after1[] = { 1 }, after14[] = { 1, 4 };
+    PlanJob jobs[] = { { 1, NULL, 0 }, { 1, after0, 1 }, { 1, after1, 1 },
+                       { 1, after14, 2 }, { 1, NULL, 0 }, { 1, NULL, 0 } };
+    PlanGraph g;
+    uint32_t order[6];
+    ArenaRestore(&g_arena, 0);
+    CHECK(PlanBuild(&g, &g_arena, jobs, 6, false) == PLAN_OK);
+    CHECK(Drain(&g, order, 6) == 3);
+    CHECK(order[0] == 0 && order[1] == 4 && order[2] == 5);
+
+    PlanDone(&g, 0, false);
+    CHECK(g.skipped[1] && g.skipped[2] && g.skipped[3]);
+    CHECK(!g.skipped[4] && !g.skipped[5]);
+    CHECK(g.open == 2);
+
+    // A skipped job never becomes ready, whatever else succeeds
+    PlanDone(&g, 4, true);
+    PlanDone(&g, 5, true);
+    uint32_t job;
+    CHECK(!PlanNext(&g, &job) && g.open == 0);
+}
+
+static void TestSimulate(void)
+{
+    // Two slots: four short jobs, the long one last in the batch
+    PlanJob jobs[] = { { 1, NULL, 0 }, { 1, NULL, 0 }, { 1, NULL, 0 }, { 1, NULL, 0 }, { 4, NULL, 0 } };
+    uint64_t fifo, ranked;
+    ArenaRestore(&g_arena, 0);
+    CHECK(PlanSimulate(&g_arena, jobs, 5, 2, false, &fifo) && fifo == 6);
+    CHECK(PlanSimulate(&g_arena, jobs, 5, 2, true, &ranked) && ranked == 4);
+    CHECK(PlanSimulate(&g_arena, jobs, 5, 8, false, &fifo) && fifo == 4);
+
+    // A chain bounds the makespan however many slots there are
+    static const uint32_t after0[] = { 0 }, after1[] = { 1 };
+    PlanJob chain[] = { { 2, NULL, 0 }, { 3, after0, 1 }, { 4, after1, 1 }, { 1, NULL, 0 } };
+    CHECK(PlanSimulate(&g_arena, chain, 4, 4, true, &ranked) && ranked == 9);
+    CHECK(PlanSimulate(&g_arena, chain, 4, 1, true, &ranked) && ranked == 10);
+
+    CHECK(!PlanSimulate(&g_arena, jobs, 5, 0, true, &ranked));
+    CHECK(g_arena.used == 0);
+}
+
+int main(void)
+{
+    CHECK(ArenaInit(&g_arena, ARENA_DEFAULT_RESERVE));
+    RUN_TEST(TestLongestFirst);
+    RUN_TEST(TestCriticalPath);
+    RUN_TEST(TestBadGraphs);
+    RUN_TEST(TestFailureSkips);
+    RUN_TEST(TestSimulate);
+    ArenaRelease(&g_arena);
+    return TEST_SUMMARY();
+}
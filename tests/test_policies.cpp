@@ -0,0 +1,153 @@
+//--------------------------------------------------------------------------
+// TESTS: src/cpp policies (quoting strategies, launch sequence, variants)
+//--------------------------------------------------------------------------
+#include <stdlib.h>
+#include <type_traits>
+
+#include "launcher.hpp"
+#include "testing.h"
+
+using namespace ps;
+
+static Arena g_arena;
+
+// ArgvQuoting must be the exact inverse of SplitCommandLine
+static void TestArgvQuotingRoundTrip(void)
+{
+    static const PSCHAR* const values[] = {
+        PS_T(""), PS_T("plain"), PS_T("a b"), PS_T("C:\\dir\\"), PS_T("C:\\dir\\\\"),
+        PS_T("\"quoted\""), PS_T("say \"hi\""), PS_T("\\\""), PS_T("a\\\\\"b"),
+        PS_T("\\\\server\\share"), PS_T("tab\there"), PS_T("\""),
+    };
+    const int count = sizeof(values) / sizeof(values[0]);
+
+    CommandLineString cmd(&g_arena);
+    CHECK(cmd.Append(PS_T("prog")));
+    for (int i = 0; i < count; i++)
+        CHECK(cmd.Append(PS_T(' ')) && AppendArgvQuoted(cmd, StringView::FromTerminated(values[i])));
+
+    PSCHAR storage[512];
+    PSCHAR* argv[32];
+    int argc = SplitCommandLine(cmd.c_str(), storage, argv, 32);
+    CHECK(argc == count + 1);
+    for (int i = 0; i < count && argc == count + 1; i++)
+        CHECK_STR(argv[i + 1], values[i]);
+}
+
+// The PowerShell rules are lossy on exactly these; the argv rules are not
+static void TestQuotingStrategiesDiffer(void)
+{
+    CommandLineString ps(&g_arena), argv(&g_arena);
+    CHECK(PowerShellQuoting::AppendParameter(ps, PS_T("C:\\dir\\")));
+    CHECK(ArgvQuoting::AppendParameter(argv, PS_T("C:\\dir\\")));
+    CHECK(ps.view().Equals(PS_T("\"C:\\dir\\\"")));
+    CHECK(argv.view().Equals(PS_T("\"C:\\dir\\\\\"")));
+
+    ps.Clear();
+    argv.Clear();
+    CHECK(PowerShellQuoting::AppendParameter(ps, PS_T("\"as is\"")));
+    CHECK(ArgvQuoting::AppendParameter(argv, PS_T("\"as is\"")));
+    CHECK(ps.view().Equals(PS_T("\"as is\"")));
+    CHECK(argv.view().Equals(PS_T("\"\\\"as is\\\"\"")));
+}
+
+// Disabled policies carry no state, so they cost nothing in the launcher
+static void TestNoOpPoliciesAreEmpty(void)
+{
+    CHECK(std::is_empty<NullLogger>::value);
+    CHECK(std::is_empty<SilentReporter>::value);
+    CHECK(std::is_empty<QuietReporter>::value);
+    CHECK(!std::is_empty<FileLogger>::value);
+}
+
+//--------------------------------------------------------------------------
+// Launch sequence with a recording spawn backend - no process is created
+//--------------------------------------------------------------------------
+struct Recorded
+{
+    int starts;
+    int errors;
+    uint32_t exitCode;
+    PSCHAR cmdline[512];
+};
+static Recorded g_rec;
+
+struct RecordingSpawn
+{
+    bool Start(const PSCHAR*, PSCHAR* cmdline, const PSCHAR*)
+    {
+        g_rec.starts++;
+        size_t i = 0;
+        for (; cmdline[i] && i + 1 < 512; i++)
+            g_rec.cmdline[i] = cmdline[i];
+        g_rec.cmdline[i] = 0;
+        return true;
+    }
+    bool Wait(uint32_t* exitCode)
+    {
+        *exitCode = g_rec.exitCode;
+        return true;
+    }
+    void Close() {}
+    uint32_t LastError() const { return 0; }
+};
+
+struct CountingReporter
+{
+    void Error(StringView, StringView) { g_rec.errors++; }
+    void Usage(StringView) { g_rec.errors++; }
+};
+
+typedef LaunchPolicy<NullLogger, CountingReporter, RecordingSpawn, ArgvQuoting> TestVariant;
+
+static int LaunchWith(const PSCHAR* const* args, int count)
+{
+    StringView views[8];
+    for (int i = 0; i < count; i++)
+        views[i] = StringView::FromTerminated(args[i]);
+    return Launcher<TestVariant>(&g_arena).Launch(views, count, PlatMonotonicNanos());
+}
+
+static void TestLaunchSequence(const char* self)
+{
+    g_rec = Recorded();
+    g_rec.exitCode = 7;
+    const PSCHAR* ok[] = { PS_T("x"), PS_T("-Script"), self, PS_T("C:\\dir\\") };
+    CHECK(LaunchWith(ok, 4) == 7);
+    CHECK(g_rec.starts == 1);
+    CHECK(g_rec.errors == 0);
+    StringView cmd = StringView::FromTerminated(g_rec.cmdline);
+    CHECK(cmd.Substr(cmd.size() - 11).Equals(PS_T(" \"C:\\dir\\\\\"")));
+
+    const PSCHAR* blocked[] = { PS_T("x"), PS_T("-Script"), self, PS_T("a;b") };
+    CHECK(LaunchWith(blocked, 4) == 1);
+    CHECK(g_rec.starts == 1);                  // Never spawned
+
+    const PSCHAR* missing[] = { PS_T("x"), PS_T("-Script"), PS_T("/nonexistent/s.ps1") };
+    CHECK(LaunchWith(missing, 3) == 1);
+    CHECK(g_rec.errors == 1);
+
+    const PSCHAR* usage[] = { PS_T("x") };
+    CHECK(LaunchWith(usage, 1) == 1);
+    CHECK(g_rec.errors == 2);
+}
+
+int main(int argc, char** argv)
+{
+    (void)argc;
+    if (!ArenaInit(&g_arena, ARENA_COMMIT_GRANULE * 4))
+        return 1;
+
+    // Any existing file will do as the interpreter; keep the journal local
+    setenv("PS_LAUNCHER_INTERPRETER", "/bin/sh", 1);
+    setenv("XDG_STATE_HOME", "policies_scratch", 1);
+
+    RUN_TEST(TestArgvQuotingRoundTrip);
+    RUN_TEST(TestQuotingStrategiesDiffer);
+    RUN_TEST(TestNoOpPoliciesAreEmpty);
+    int before = g_failures;
+    TestLaunchSequence(argv[0]);
+    printf("%-40s %s\n", "TestLaunchSequence", g_failures == before ? "ok" : "FAILED");
+    ArenaRelease(&g_arena);
+    return TEST_SUMMARY();
+}
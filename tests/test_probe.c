@@ -0,0 +1,76 @@
+//--------------------------------------------------------------------------
+// TESTS: probe.c marker scan over chunked streams
+//--------------------------------------------------------------------------
+#include <string.h>
+
+#include "probe.h"
+#include "testing.h"
+
+// Feed text in pieces of step bytes; collect what would be relayed
+static bool Scan(const char* text, size_t step, char* relayed, int* prologueAt)
+{
+    ProbeScan scan = { 0, false };
+    ProbeChunk chunk;
+    size_t len = strlen(text), out = 0;
+    *prologueAt = -1;
+    for (size_t at = 0; at < len; at += step)
+    {
+        size_t n = len - at < step ? len - at : step;
+        ProbeFeed(&scan, text + at, n, &chunk);
+        if (chunk.prologue)
+            *prologueAt = (int)at;
+        memcpy(relayed + out, PROBE_MARKER, chunk.held);
+        out += chunk.held;
+        memcpy(relayed + out, text + at + chunk.start, n - chunk.start);
+        out += n - chunk.start;
+    }
+    if (!scan.done)
+    {
+        memcpy(relayed + out, PROBE_MARKER, scan.matched);
+        out += scan.matched;
+    }
+    relayed[out] = 0;
+    return scan.done;
+}
+
+static void TestMarkerStripped(void)
+{
+    char relayed[256];
+    int at;
+    CHECK(sizeof(PROBE_MARKER) - 1 == PROBE_MARKER_LEN);
+    for (size_t step = 1; step <= 32; step++)
+    {
+        CHECK(Scan(PROBE_MARKER "hello\n", step, relayed, &at));
+        CHECK(strcmp(relayed, "hello\n") == 0);
+        CHECK(at == (int)((PROBE_MARKER_LEN - 1) / step * step));
+    }
+}
+
+static void TestOutputWithoutMarker(void)
+{
+    char relayed[256];
+    int at;
+    for (size_t step = 1; step <= 32; step++)
+    {
+        // Output that starts like the marker is relayed whole
+        CHECK(Scan("\x1b]psl;pro-logue\n", step, relayed, &at));
+        CHECK(strcmp(relayed, "\x1b]psl;pro-logue\n") == 0 && at == -1);
+        CHECK(Scan("plain\n", step, relayed, &at));
+        CHECK(strcmp(relayed, "plain\n") == 0 && at == -1);
+
+        // The marker only counts at the start
+        CHECK(Scan("x" PROBE_MARKER, step, relayed, &at));
+        CHECK(strcmp(relayed, "x" PROBE_MARKER) == 0 && at == -1);
+    }
+
+    // A stream that ends inside the marker gives it back
+    CHECK(!Scan("\x1b]psl", 2, relayed, &at));
+    CHECK(strcmp(relayed, "\x1b]psl") == 0);
+}
+
+int main(void)
+{
+    RUN_TEST(TestMarkerStripped);
+    RUN_TEST(TestOutputWithoutMarker);
+    return TEST_SUMMARY();
+}
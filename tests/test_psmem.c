@@ -0,0 +1,254 @@
+//--------------------------------------------------------------------------
+// TESTS: psmem.c against the C library
+//--------------------------------------------------------------------------
+// Every size/alignment combination is checked against glibc (or the MSVC
+// CRT), and the NUL-terminated scans are run on strings that end right
+// before an unmapped page to prove the vector tails never fault.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "psmem.h"
+#include "testing.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static int Sign(int v)
+{
+    return (v > 0) - (v < 0);
+}
+
+static void TestMemSetMatchesLibc(void)
+{
+    unsigned char a[320], b[320];
+    for (size_t align = 0; align < 16; align++)
+    {
+        for (size_t n = 0; n < 260; n++)
+        {
+            memset(a, 0xAA, sizeof(a));
+            memset(b, 0xAA, sizeof(b));
+            CHECK(PsMemSet(a + align, (int)(n & 0xFF), n) == a + align);
+            memset(b + align, (int)(n & 0xFF), n);
+            if (memcmp(a, b, sizeof(a)) != 0)
+            {
+                CHECK(!"memset mismatch");
+                return;
+            }
+        }
+    }
+}
+
+static void TestMemCpyMatchesLibc(void)
+{
+    unsigned char src[320], a[320], b[320];
+    for (size_t i = 0; i < sizeof(src); i++)
+        src[i] = (unsigned char)(i * 7 + 3);
+
+    for (size_t sa = 0; sa < 16; sa += 3)
+    {
+        for (size_t da = 0; da < 16; da++)
+        {
+            for (size_t n = 0; n < 290; n++)
+            {
+                memset(a, 0x55, sizeof(a));
+                memset(b, 0x55, sizeof(b));
+                PsMemCpy(a + da, src + sa, n);
+                memcpy(b + da, src + sa, n);
+                if (memcmp(a, b, sizeof(a)) != 0)
+                {
+                    CHECK(!"memcpy mismatch");
+                    return;
+                }
+            }
+        }
+    }
+}
+
+static void TestMemChrMatchesLibc(void)
+{
+    unsigned char buf[300];
+    for (size_t i = 0; i < sizeof(buf); i++)
+        buf[i] = (unsigned char)(i % 251);
+
+    for (size_t start = 0; start < 16; start++)
+    {
+        for (size_t n = 0; n + start < sizeof(buf); n += 7)
+        {
+            for (int c = 0; c < 256; c += 37)
+            {
+                if (PsMemChr(buf + start, c, n) != memchr(buf + start, c, n))
+                {
+                    CHECK(!"memchr mismatch");
+                    return;
+                }
+            }
+        }
+    }
+    CHECK(PsMemChr(buf, 250, 251) == buf + 250);
+    CHECK(PsMemChr(buf, 250, 250) == NULL);
+}
+
+// Reference: first unit equal to c, scalar
+static const uint16_t* RefMemChr16(const uint16_t* s, uint16_t c, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        if (s[i] == c)
+            return s + i;
+    }
+    return NULL;
+}
+
+static void TestMemChr16(void)
+{
+    uint16_t buf[160];
+    for (size_t i = 0; i < 160; i++)
+        buf[i] = (uint16_t)(0x0100 * (i % 7) + i);   // High and low bytes both vary
+
+    for (size_t start = 0; start < 8; start++)
+    {
+        for (size_t n = 0; n + start <= 160; n += 3)
+        {
+            for (size_t k = 0; k < 160; k += 13)
+            {
+                if (PsMemChr16(buf + start, buf[k], n) != RefMemChr16(buf + start, buf[k], n))
+                {
+                    CHECK(!"memchr16 mismatch");
+                    return;
+                }
+            }
+        }
+    }
+
+    // A match on one byte of a unit only is not a match
+    CHECK(PsMemChr16(buf, (uint16_t)(buf[9] & 0xFF), 160) == RefMemChr16(buf, (uint16_t)(buf[9] & 0xFF), 160));
+}
+
+static void TestStrLenAndChr8(void)
+{
+    char buf[128];
+    for (size_t start = 0; start < 16; start++)
+    {
+        for (size_t len = 0; len + start < sizeof(buf) - 1; len++)
+        {
+            memset(buf, 'x', sizeof(buf));
+            buf[start + len] = 0;
+            buf[start + len / 2] = ';';
+            if (PsStrLen8(buf + start) != strlen(buf + start) ||
+                PsStrChr8(buf + start, ';') != strchr(buf + start, ';') ||
+                PsStrChr8(buf + start, '"') != NULL)
+            {
+                CHECK(!"strlen/strchr mismatch");
+                return;
+            }
+        }
+    }
+}
+
+static size_t RefLen16(const uint16_t* s)
+{
+    size_t n = 0;
+    while (s[n])
+        n++;
+    return n;
+}
+
+static void TestStrLenAndChr16(void)
+{
+    uint16_t buf[96];
+    for (size_t start = 0; start < 8; start++)
+    {
+        for (size_t len = 0; len + start < 95; len++)
+        {
+            for (size_t i = 0; i < 96; i++)
+                buf[i] = (uint16_t)(0x4100 + i);  // High byte set: no false NULs
+            buf[start + len] = 0;
+            const uint16_t* expectChr = len > 2 ? buf + start + 2 : NULL;
+            if (PsStrLen16(buf + start) != RefLen16(buf + start) ||
+                PsStrChr16(buf + start, (uint16_t)(0x4100 + start + 2)) != expectChr)
+            {
+                CHECK(!"strlen16/strchr16 mismatch");
+                return;
+            }
+        }
+    }
+}
+
+static void TestStrCmp(void)
+{
+    char a[64], b[64];
+    for (size_t len = 0; len < 40; len++)
+    {
+        for (size_t diff = 0; diff <= len; diff++)
+        {
+            memset(a, 'k', len);
+            memset(b, 'k', len);
+            a[len] = b[len] = 0;
+            if (diff < len)
+                b[diff] = (diff & 1) ? 'a' : (char)0xE9;   // Below and above, unsigned
+            if (Sign(PsStrCmp8(a, b)) != Sign(strcmp(a, b)))
+            {
+                CHECK(!"strcmp mismatch");
+                return;
+            }
+        }
+    }
+
+    uint16_t w1[] = { 'a', 'b', 0xD83D, 0 };
+    uint16_t w2[] = { 'a', 'b', 'c', 0 };
+    uint16_t w3[] = { 'a', 'b', 0 };
+    CHECK(PsStrCmp16(w1, w2) > 0);
+    CHECK(PsStrCmp16(w3, w2) < 0);
+    CHECK(PsStrCmp16(w2, w2) == 0);
+}
+
+static void TestScansStopAtPageBoundary(void)
+{
+#ifndef _WIN32
+    long page = sysconf(_SC_PAGESIZE);
+    unsigned char* map = mmap(NULL, (size_t)page * 2, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    CHECK(map != MAP_FAILED);
+    if (map == MAP_FAILED)
+        return;
+    mprotect(map + page, (size_t)page, PROT_NONE);
+
+    // Strings whose terminator is the very last byte before the guard page
+    char* end8 = (char*)map + page - 1;
+    uint16_t* end16 = (uint16_t*)(map + page) - 1;
+    for (size_t len = 0; len < 40; len++)
+    {
+        char* s8 = end8 - len;
+        memset(s8, 'y', len);
+        *end8 = 0;
+        CHECK(PsStrLen8(s8) == len);
+        CHECK(PsStrChr8(s8, ';') == NULL);
+        CHECK(PsStrCmp8(s8, s8) == 0);
+
+        uint16_t* s16 = end16 - len;
+        for (size_t i = 0; i < len; i++)
+            s16[i] = 'y';
+        *end16 = 0;
+        CHECK(PsStrLen16(s16) == len);
+        CHECK(PsStrChr16(s16, ';') == NULL);
+        CHECK(PsStrCmp16(s16, s16) == 0);
+    }
+    munmap(map, (size_t)page * 2);
+#endif
+}
+
+int main(void)
+{
+    RUN_TEST(TestMemSetMatchesLibc);
+    RUN_TEST(TestMemCpyMatchesLibc);
+    RUN_TEST(TestMemChrMatchesLibc);
+    RUN_TEST(TestMemChr16);
+    RUN_TEST(TestStrLenAndChr8);
+    RUN_TEST(TestStrLenAndChr16);
+    RUN_TEST(TestStrCmp);
+    RUN_TEST(TestScansStopAtPageBoundary);
+    return TEST_SUMMARY();
+}
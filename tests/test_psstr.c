@@ -0,0 +1,74 @@
+//--------------------------------------------------------------------------
+// TESTS: psstr.c
+//--------------------------------------------------------------------------
+#include "psstr.h"
+#include "testing.h"
+
+static void TestLength(void)
+{
+    CHECK(PsStrLen(PS_T("")) == 0);
+    CHECK(PsStrLen(PS_T("powershell.exe")) == 14);
+}
+
+static void TestCompareIgnoringCase(void)
+{
+    CHECK(PsStrCmpI(PS_T("-Script"), PS_T("-script")) == 0);
+    CHECK(PsStrCmpI(PS_T("-SCRIPT"), PS_T("-Script")) == 0);
+    CHECK(PsStrCmpI(PS_T("-Scrip"), PS_T("-Script")) < 0);
+    CHECK(PsStrCmpI(PS_T("-Scripts"), PS_T("-Script")) > 0);
+}
+
+static void TestFindChar(void)
+{
+    const PSCHAR* s = PS_T("a;b");
+    CHECK(PsStrChr(s, PS_T(';')) == s + 1);
+    CHECK(PsStrChr(s, PS_T('"')) == NULL);
+}
+
+static void TestAppendBounds(void)
+{
+    PSCHAR buf[8];
+    size_t pos = 0;
+    buf[0] = 0;
+    CHECK(AppendStr(buf, 8, PS_T("abc"), &pos));
+    CHECK(AppendChar(buf, 8, PS_T('d'), &pos));
+    CHECK_STR(buf, PS_T("abcd"));
+
+    // Exactly fills the buffer including the terminator
+    CHECK(AppendStr(buf, 8, PS_T("efg"), &pos));
+    CHECK(pos == 7);
+
+    // No room left: refused and buffer unchanged
+    CHECK(!AppendChar(buf, 8, PS_T('h'), &pos));
+    CHECK(!AppendStr(buf, 8, PS_T("h"), &pos));
+    CHECK_STR(buf, PS_T("abcdefg"));
+}
+
+static void TestAppendUInt(void)
+{
+    PSCHAR buf[32];
+    size_t pos = 0;
+    CHECK(AppendUInt(buf, 32, 0, &pos));
+    CHECK_STR(buf, PS_T("0"));
+
+    pos = 0;
+    CHECK(AppendUInt(buf, 32, 4294967295u, &pos));
+    CHECK_STR(buf, PS_T("4294967295"));
+
+    pos = 0;
+    CHECK(AppendUInt(buf, 32, 18446744073709551615ull, &pos));
+    CHECK_STR(buf, PS_T("18446744073709551615"));
+
+    pos = 0;
+    CHECK(!AppendUInt(buf, 3, 123, &pos));
+}
+
+int main(void)
+{
+    RUN_TEST(TestLength);
+    RUN_TEST(TestCompareIgnoringCase);
+    RUN_TEST(TestFindChar);
+    RUN_TEST(TestAppendBounds);
+    RUN_TEST(TestAppendUInt);
+    return TEST_SUMMARY();
+}
@@ -0,0 +1,63 @@
+//--------------------------------------------------------------------------
+// TESTS: quote.c
+//--------------------------------------------------------------------------
+#include "quote.h"
+#include "testing.h"
+
+static Arena g_arena;
+
+static const PSCHAR* Quote(const PSCHAR* param)
+{
+    StrBuf sb;
+    CHECK(StrBufInit(&sb, &g_arena, 8, STRBUF_NO_LIMIT));
+    CHECK(AppendQuotedParameter(&sb, param));
+    return sb.data;
+}
+
+static void TestPlainAndEmpty(void)
+{
+    CHECK_STR(Quote(PS_T("value")), PS_T("\"value\""));
+    CHECK_STR(Quote(PS_T("")), PS_T("\"\""));
+    CHECK_STR(Quote(PS_T("-42")), PS_T("\"-42\""));
+}
+
+static void TestSpacesAndSpecials(void)
+{
+    CHECK_STR(Quote(PS_T("C:\\Program Files\\App")), PS_T("\"C:\\Program Files\\App\""));
+    CHECK_STR(Quote(PS_T("@#&%")), PS_T("\"@#&%\""));
+}
+
+static void TestInternalQuotesEscaped(void)
+{
+    CHECK_STR(Quote(PS_T("say \"hi\"")), PS_T("\"say \\\"hi\\\"\""));
+}
+
+static void TestAlreadyQuotedPassesThrough(void)
+{
+    CHECK_STR(Quote(PS_T("\"as is\"")), PS_T("\"as is\""));
+    CHECK(IsAlreadyQuoted(PS_T("\"\""), 2));
+    CHECK(!IsAlreadyQuoted(PS_T("\""), 1));
+}
+
+static void TestLimitRefused(void)
+{
+    StrBuf sb;
+    CHECK(StrBufInit(&sb, &g_arena, 2, 5));
+    CHECK(!AppendQuotedParameter(&sb, PS_T("abcdef")));
+    CHECK(sb.len == 0);
+    CHECK(AppendQuotedParameter(&sb, PS_T("abc")));
+    CHECK(sb.len == 5);
+}
+
+int main(void)
+{
+    if (!ArenaInit(&g_arena, ARENA_COMMIT_GRANULE * 4))
+        return 1;
+    RUN_TEST(TestPlainAndEmpty);
+    RUN_TEST(TestSpacesAndSpecials);
+    RUN_TEST(TestInternalQuotesEscaped);
+    RUN_TEST(TestAlreadyQuotedPassesThrough);
+    RUN_TEST(TestLimitRefused);
+    ArenaRelease(&g_arena);
+    return TEST_SUMMARY();
+}
@@ -0,0 +1,172 @@
+//--------------------------------------------------------------------------
+// TESTS: resource.c limits, lines and starvation freedom
+//--------------------------------------------------------------------------
+#include "resource.h"
+#include "testing.h"
+
+static ResourceTable g_table;
+
+// A free claim on the named tags (NULL-terminated)
+static void Claim(ResourceClaim* claim, const PSCHAR* a, const PSCHAR* b)
+{
+    ResourceClaimInit(claim);
+    if (a)
+        CHECK(ResourceClaimAdd(&g_table, claim, a));
+    if (b)
+        CHECK(ResourceClaimAdd(&g_table, claim, b));
+}
+
+static void TestLimits(void)
+{
+    ResourceInit(&g_table);
+    CHECK(ResourceDeclare(&g_table, PS_T("db"), 1));
+    CHECK(ResourceDeclare(&g_table, PS_T("share"), 2));
+    CHECK(!ResourceDeclare(&g_table, PS_T(""), 1));
+    CHECK(!ResourceDeclare(&g_table, PS_T("zero"), 0));
+
+    // Disjoint tags go side by side; the same tag up to its limit
+    ResourceClaim a, b, c, d, none;
+    Claim(&a, PS_T("DB"), NULL);
+    Claim(&b, PS_T("share"), NULL);
+    Claim(&c, PS_T("share"), NULL);
+    Claim(&d, PS_T("db"), NULL);
+    Claim(&none, PS_T("undeclared"), NULL);
+    CHECK(none.count == 0 && ResourceAcquire(&g_table, &none));
+    CHECK(ResourceAcquire(&g_table, &a));
+    CHECK(ResourceAcquire(&g_table, &b) && ResourceAcquire(&g_table, &c));
+    CHECK(!ResourceAcquire(&g_table, &d) && ResourceWaiting(&d));
+    CHECK(ResourceNext(&g_table) == NULL);
+
+    ResourceRelease(&g_table, &b);
+    CHECK(ResourceNext(&g_table) == NULL);
+    ResourceRelease(&g_table, &a);
+    CHECK(ResourceNext(&g_table) == &d && d.state == RESOURCE_HELD);
+    CHECK(ResourceNext(&g_table) == NULL && g_table.waiting == 0);
+
+    // A raised limit lets the line move without anyone letting go
+    CHECK(!ResourceAcquire(&g_table, &a));
+    CHECK(ResourceDeclare(&g_table, PS_T("db"), 2));
+    CHECK(ResourceNext(&g_table) == &a);
+}
+
+static void TestNoOvertaking(void)
+{
+    // big needs db and share; a stream of db-only and share-only jobs
+    // cannot keep it waiting once it is in line
+    ResourceInit(&g_table);
+    CHECK(ResourceDeclare(&g_table, PS_T("db"), 1));
+    CHECK(ResourceDeclare(&g_table, PS_T("share"), 1));
+    ResourceClaim first, big, later, other;
+    Claim(&first, PS_T("db"), NULL);
+    Claim(&big, PS_T("db"), PS_T("share"));
+    Claim(&later, PS_T("share"), NULL);
+    Claim(&other, PS_T("db"), NULL);
+    CHECK(ResourceAcquire(&g_table, &first));
+    CHECK(!ResourceAcquire(&g_table, &big));
+
+    // share has room, but big is in its line
+    CHECK(!ResourceAcquire(&g_table, &later));
+    CHECK(!ResourceAcquire(&g_table, &other));
+    ResourceRelease(&g_table, &first);
+    CHECK(ResourceNext(&g_table) == &big);
+    CHECK(ResourceNext(&g_table) == NULL);
+    ResourceRelease(&g_table, &big);
+    ResourceClaim* one = ResourceNext(&g_table);
+    ResourceClaim* two = ResourceNext(&g_table);
+    CHECK((one == &later && two == &other) || (one == &other && two == &later));
+    CHECK(g_table.waiting == 0);
+}
+
+static void TestLeaveLine(void)
+{
+    // Taken out of the middle of its lines, the rest keep their order
+    ResourceInit(&g_table);
+    CHECK(ResourceDeclare(&g_table, PS_T("db"), 1));
+    CHECK(ResourceDeclare(&g_table, PS_T("share"), 1));
+    ResourceClaim holder, a, b, c;
+    Claim(&holder, PS_T("db"), PS_T("share"));
+    Claim(&a, PS_T("db"), NULL);
+    Claim(&b, PS_T("share"), PS_T("db"));
+    Claim(&c, PS_T("db"), NULL);
+    CHECK(ResourceAcquire(&g_table, &holder));
+    CHECK(!ResourceAcquire(&g_table, &a) && !ResourceAcquire(&g_table, &b) && !ResourceAcquire(&g_table, &c));
+    ResourceRelease(&g_table, &b);
+    CHECK(b.state == RESOURCE_FREE && g_table.waiting == 2);
+    ResourceRelease(&g_table, &b);
+    ResourceRelease(&g_table, &holder);
+    CHECK(ResourceNext(&g_table) == &a);
+    CHECK(ResourceNext(&g_table) == NULL);
+    ResourceRelease(&g_table, &a);
+    CHECK(ResourceNext(&g_table) == &c);
+
+    // Too many tags for one job
+    ResourceClaim wide;
+    ResourceClaimInit(&wide);
+    PSCHAR name[4] = { PS_T('t'), 0, 0, 0 };
+    bool added = true;
+    for (int i = 0; i < RESOURCE_MAX_HELD + 1; i++)
+    {
+        name[1] = (PSCHAR)(PS_T('a') + i);
+        CHECK(ResourceDeclare(&g_table, name, 1));
+        added = ResourceClaimAdd(&g_table, &wide, name);
+    }
+    CHECK(!added && wide.count == RESOURCE_MAX_HELD);
+}
+
+static void TestStarvation(void)
+{
+    // Many rounds of mixed one- and two-tag jobs, let go in the order they
+    // went: every waiting job is held within a bounded number of turns
+    enum { JOBS = 64, ROUNDS = 2000 };
+    ResourceInit(&g_table);
+    CHECK(ResourceDeclare(&g_table, PS_T("a"), 2));
+    CHECK(ResourceDeclare(&g_table, PS_T("b"), 1));
+    CHECK(ResourceDeclare(&g_table, PS_T("c"), 3));
+    static const PSCHAR* names[] = { PS_T("a"), PS_T("b"), PS_T("c") };
+    ResourceClaim jobs[JOBS];
+    uint32_t joined[JOBS] = { 0 };
+    ResourceClaim* holding[JOBS];
+    uint32_t held = 0, longest = 0, random = 12345;
+
+    for (uint32_t turn = 0; turn < ROUNDS; turn++)
+    {
+        // Everything free asks again, with one or two tags
+        for (uint32_t i = 0; i < JOBS; i++)
+        {
+            if (jobs[i].state != RESOURCE_FREE && turn > 0)
+                continue;
+            random = random * 1103515245u + 12345u;
+            uint32_t r = random >> 16;
+            Claim(&jobs[i], names[r % 3], (r >> 4) % 2 ? names[(r >> 6) % 3] : NULL);
+            joined[i] = turn;
+            if (ResourceAcquire(&g_table, &jobs[i]))
+                holding[held++] = &jobs[i];
+        }
+        ResourceClaim* next;
+        while ((next = ResourceNext(&g_table)) != NULL)
+        {
+            uint32_t waited = turn - joined[next - jobs];
+            longest = waited > longest ? waited : longest;
+            holding[held++] = next;
+        }
+
+        // The oldest holder lets go
+        CHECK(held > 0);
+        ResourceRelease(&g_table, holding[0]);
+        for (uint32_t i = 1; i < held; i++)
+            holding[i - 1] = holding[i];
+        held--;
+    }
+    // Each turn one holder lets go: ahead of a job are at most the holders
+    // when it joined and the jobs in its lines, each going once
+    CHECK(longest > 0 && longest < 2 * JOBS);
+}
+
+int main(void)
+{
+    RUN_TEST(TestLimits);
+    RUN_TEST(TestNoOvertaking);
+    RUN_TEST(TestLeaveLine);
+    RUN_TEST(TestStarvation);
+    return TEST_SUMMARY();
+}
@@ -0,0 +1,223 @@
+//--------------------------------------------------------------------------
+// TESTS: resultcache.c (POSIX file system)
+//--------------------------------------------------------------------------
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "resultcache.h"
+#include "testing.h"
+
+#define NOW 1700000000000ull
+
+static char g_dir[400];
+static char g_results[500];
+static Arena g_arena;
+static const uint8_t g_sha[SHA256_DIGEST_SIZE] = { 1, 2, 3 };
+
+static bool Open(PSCHAR* const* params, int count, bool capture, ResultCache* cache)
+{
+    return ResultCacheOpen(&g_arena, g_dir, g_sha, "/scripts/inventory.ps1", params, count,
+                           60, capture, cache);
+}
+
+// Contents of a scratch file, for replayed output
+static const char* ReadBack(const char* path)
+{
+    static char text[256];
+    text[0] = 0;
+    FILE* f = fopen(path, "r");
+    if (f)
+    {
+        size_t n = fread(text, 1, sizeof(text) - 1, f);
+        text[n] = 0;
+        fclose(f);
+    }
+    return text;
+}
+
+static void TestKeys(void)
+{
+    PSCHAR* upper[] = { "-ComputerName", "SRV01" };
+    PSCHAR* lower[] = { "-computername", "SRV01" };
+    PSCHAR* value[] = { "-ComputerName", "srv01" };
+    PSCHAR* joined[] = { "-ComputerName SRV01" };
+    ResultCache a, b, c, d, e;
+    CHECK(Open(upper, 2, false, &a));
+    CHECK(Open(lower, 2, false, &b));
+    CHECK(Open(value, 2, false, &c));
+    CHECK(Open(joined, 1, false, &d));
+    CHECK(Open(upper, 2, true, &e));
+
+    // Parameter names fold; values, splitting and output capture do not
+    CHECK(strcmp(a.entryPath, b.entryPath) == 0);
+    CHECK(strcmp(a.entryPath, c.entryPath) != 0);
+    CHECK(strcmp(a.entryPath, d.entryPath) != 0);
+    CHECK(strcmp(a.entryPath, e.entryPath) != 0);
+    CHECK(strncmp(a.entryPath, g_results, strlen(g_results)) == 0);
+
+    // "-5" is a value, not a parameter name
+    PSCHAR* negative[] = { "-Offset", "-5" };
+    PSCHAR* named[] = { "-offset", "-5" };
+    CHECK(Open(negative, 2, false, &a) && Open(named, 2, false, &b));
+    CHECK(strcmp(a.entryPath, b.entryPath) == 0);
+}
+
+static void TestExitCodeOnly(void)
+{
+    PSCHAR* params[] = { "-Query", "disks" };
+    ResultCache cache;
+    uint32_t code = 0;
+    CHECK(Open(params, 2, false, &cache));
+    CHECK(!ResultCacheLookup(&cache, NOW, PLAT_INVALID_FILE, &code));
+    CHECK(ResultCacheStore(&g_arena, &cache, 7, NOW, PLAT_INVALID_FILE));
+
+    CHECK(ResultCacheLookup(&cache, NOW + 1000, PLAT_INVALID_FILE, &code));
+    CHECK(code == 7);
+    CHECK(ResultCacheLookup(&cache, NOW + 59999, PLAT_INVALID_FILE, &code));
+
+    // Expired entries are gone for good; so are ones from "the future"
+    CHECK(!ResultCacheLookup(&cache, NOW + 60000, PLAT_INVALID_FILE, &code));
+    CHECK(access(cache.entryPath, F_OK) != 0);
+    CHECK(ResultCacheStore(&g_arena, &cache, 7, NOW, PLAT_INVALID_FILE));
+    CHECK(!ResultCacheLookup(&cache, NOW - 1, PLAT_INVALID_FILE, &code));
+}
+
+static void TestCapturedOutput(void)
+{
+    PSCHAR* params[] = { "-Query", "services" };
+    ResultCache cache;
+    uint32_t code = 99;
+    char replay[600];
+    snprintf(replay, sizeof(replay), "%s/replay.txt", g_dir);
+
+    CHECK(Open(params, 2, true, &cache));
+    PlatFile capture = ResultCacheBeginCapture(&cache);
+    CHECK(capture != PLAT_INVALID_FILE);
+    CHECK(PlatWriteFile(capture, "svc1 running\nsvc2 stopped\n", 26));
+
+    // The run's own output reaches the caller as well as the cache
+    PlatFile out = PlatCreateFile(replay, PLAT_FILE_OVERWRITE);
+    CHECK(ResultCacheStore(&g_arena, &cache, 0, NOW, out));
+    PlatCloseFile(out);
+    CHECK(strcmp(ReadBack(replay), "svc1 running\nsvc2 stopped\n") == 0);
+    CHECK(access(cache.tempPath, F_OK) != 0);
+
+    out = PlatCreateFile(replay, PLAT_FILE_OVERWRITE);
+    CHECK(ResultCacheLookup(&cache, NOW + 5, out, &code));
+    PlatCloseFile(out);
+    CHECK(code == 0);
+    CHECK(strcmp(ReadBack(replay), "svc1 running\nsvc2 stopped\n") == 0);
+
+    // An aborted capture leaves nothing behind
+    ResultCache other;
+    PSCHAR* more[] = { "-Query", "users" };
+    CHECK(Open(more, 2, true, &other));
+    CHECK(ResultCacheBeginCapture(&other) != PLAT_INVALID_FILE);
+    ResultCacheAbort(&other);
+    CHECK(access(other.tempPath, F_OK) != 0);
+    CHECK(!ResultCacheLookup(&other, NOW, PLAT_INVALID_FILE, &code));
+}
+
+static void TestTornEntries(void)
+{
+    PSCHAR* params[] = { "-Query", "torn" };
+    ResultCache cache;
+    uint32_t code = 0;
+    CHECK(Open(params, 2, true, &cache));
+    CHECK(ResultCacheBeginCapture(&cache) != PLAT_INVALID_FILE);
+    CHECK(PlatWriteFile(cache.temp, "complete output", 15));
+    CHECK(ResultCacheStore(&g_arena, &cache, 3, NOW, PLAT_INVALID_FILE));
+
+    // Cut short (a copy or a crash outside the rename): trailer check fails
+    CHECK(truncate(cache.entryPath, 20) == 0);
+    CHECK(!ResultCacheLookup(&cache, NOW, PLAT_INVALID_FILE, &code));
+    CHECK(access(cache.entryPath, F_OK) != 0);
+
+    // Another key's entry under this name (a half-key collision)
+    ResultCache other;
+    PSCHAR* more[] = { "-Query", "other" };
+    CHECK(Open(more, 2, true, &other));
+    CHECK(ResultCacheStore(&g_arena, &other, 4, NOW, PLAT_INVALID_FILE));
+    CHECK(rename(other.entryPath, cache.entryPath) == 0);
+    CHECK(!ResultCacheLookup(&cache, NOW, PLAT_INVALID_FILE, &code));
+}
+
+static void SetModified(const char* path, time_t seconds)
+{
+    struct timespec times[2] = { { seconds, 0 }, { seconds, 0 } };
+    utimensat(AT_FDCWD, path, times, 0);
+}
+
+static void TestLeastRecentlyUsedTrimmed(void)
+{
+    char cmd[600];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", g_results);
+    CHECK(system(cmd) == 0);
+
+    // Three 1000-byte outputs, stored oldest first
+    ResultCache entries[3];
+    char output[1000];
+    memset(output, 'x', sizeof(output));
+    for (int i = 0; i < 3; i++)
+    {
+        char name[16];
+        snprintf(name, sizeof(name), "host%d", i);
+        PSCHAR* params[] = { "-Host", name };
+        CHECK(Open(params, 2, true, &entries[i]));
+        CHECK(ResultCacheBeginCapture(&entries[i]) != PLAT_INVALID_FILE);
+        CHECK(PlatWriteFile(entries[i].temp, output, sizeof(output)));
+        CHECK(ResultCacheStore(&g_arena, &entries[i], 0, NOW, PLAT_INVALID_FILE));
+        SetModified(entries[i].entryPath, 1000000000 + i);
+    }
+
+    // A hit makes the oldest the most recently used
+    uint32_t code;
+    CHECK(ResultCacheLookup(&entries[0], NOW, PLAT_INVALID_FILE, &code));
+
+    size_t entrySize = sizeof(output) + sizeof(ResultTrailer);
+    CHECK(ResultCacheTrim(&g_arena, g_results, 3 * entrySize) == 0);
+    CHECK(ResultCacheTrim(&g_arena, g_results, 2 * entrySize) == 1);
+    CHECK(access(entries[1].entryPath, F_OK) != 0);
+    CHECK(access(entries[0].entryPath, F_OK) == 0);
+    CHECK(access(entries[2].entryPath, F_OK) == 0);
+    CHECK(ResultCacheTrim(&g_arena, g_results, 0) == 2);
+
+    // Abandoned captures go; recent ones may still be running
+    char temp[600];
+    snprintf(temp, sizeof(temp), "%s/0123.tmp42", g_results);
+    FILE* f = fopen(temp, "w");
+    if (f)
+        fclose(f);
+    CHECK(ResultCacheTrim(&g_arena, g_results, 0) == 0);
+    SetModified(temp, 1000000000);
+    CHECK(ResultCacheTrim(&g_arena, g_results, 0) == 1);
+}
+
+int main(void)
+{
+    char cwd[300];
+    if (!getcwd(cwd, sizeof(cwd)))
+        return 1;
+    snprintf(g_dir, sizeof(g_dir), "%s/resultcache_scratch", cwd);
+    snprintf(g_results, sizeof(g_results), "%s/results", g_dir);
+
+    char cmd[600];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", g_dir);
+    if (system(cmd) != 0)
+        return 1;
+    mkdir(g_dir, 0700);
+
+    if (!ArenaInit(&g_arena, ARENA_DEFAULT_RESERVE))
+        return 1;
+    RUN_TEST(TestKeys);
+    RUN_TEST(TestExitCodeOnly);
+    RUN_TEST(TestCapturedOutput);
+    RUN_TEST(TestTornEntries);
+    RUN_TEST(TestLeastRecentlyUsedTrimmed);
+    ArenaRelease(&g_arena);
+    return TEST_SUMMARY();
+}
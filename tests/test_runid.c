@@ -0,0 +1,123 @@
+//--------------------------------------------------------------------------
+// TESTS: runid.c ids, their text form and environment variables
+//--------------------------------------------------------------------------
+#include <stdlib.h>
+#include <string.h>
+
+#include "runid.h"
+#include "testing.h"
+
+static Arena g_arena;
+
+static void TestFormat(void)
+{
+    // The ULID specification's example timestamp
+    RunId id = { 1469918176385ull << 16, 0 };
+    char text[RUN_ID_CHARS + 1];
+    RunIdFormat8(&id, text);
+    CHECK(strcmp(text, "01ARYZ6S410000000000000000") == 0);
+
+    RunId max = { UINT64_MAX, UINT64_MAX };
+    RunIdFormat8(&max, text);
+    CHECK(strcmp(text, "7ZZZZZZZZZZZZZZZZZZZZZZZZZ") == 0);
+
+    RunId none = { 0, 0 };
+    PSCHAR wide[RUN_ID_CHARS + 1];
+    RunIdFormat(&none, wide);
+    CHECK_STR(wide, PS_T("-"));
+}
+
+static void TestParse(void)
+{
+    RunIdSource source;
+    RunIdSeed(&source);
+    RunId id = RunIdNext(&source, 1700000000123ull), back;
+    PSCHAR text[RUN_ID_CHARS + 1];
+    RunIdFormat(&id, text);
+    CHECK(RunIdParse(text, &back) && back.high == id.high && back.low == id.low);
+    CHECK(back.high >> 16 == 1700000000123ull);
+
+    // Either case; I and L read as 1, O as 0
+    CHECK(RunIdParse(PS_T("01aryz6s41000000000000000i"), &back));
+    CHECK(back.high == 1469918176385ull << 16 && back.low == 1);
+    CHECK(RunIdParse(PS_T("O1ARYZ6S41OOOOOOOOOOOOOOOL"), &back) && back.low == 1);
+
+    CHECK(!RunIdParse(PS_T(""), &back));
+    CHECK(!RunIdParse(PS_T("01ARYZ6S41000000000000000"), &back));      // Short
+    CHECK(!RunIdParse(PS_T("01ARYZ6S4100000000000000000"), &back));    // Long
+    CHECK(!RunIdParse(PS_T("81ARYZ6S410000000000000000"), &back));     // Over 128 bits
+    CHECK(!RunIdParse(PS_T("01ARYZ6S41000000000000000U"), &back));     // Not in the alphabet
+    CHECK(!RunIdIsSet(&back));
+}
+
+static void TestOrder(void)
+{
+    RunIdSource source;
+    RunIdSeed(&source);
+    RunId a = RunIdNext(&source, 5000), b = RunIdNext(&source, 5000);
+    RunId c = RunIdNext(&source, 4000);                 // The clock went back
+    RunId d = RunIdNext(&source, 6000);
+    CHECK(b.high == a.high ? b.low == a.low + 1 : b.high == a.high + 1);
+    CHECK(c.high > b.high || (c.high == b.high && c.low > b.low));
+    CHECK(d.high >> 16 == 6000);
+
+    // Sorted text is sorted time
+    char early[RUN_ID_CHARS + 1], late[RUN_ID_CHARS + 1];
+    RunIdFormat8(&b, early);
+    RunIdFormat8(&d, late);
+    CHECK(strcmp(early, late) < 0);
+
+    // Two sources in one millisecond differ
+    RunIdSource other;
+    RunIdSeed(&other);
+    RunId e = RunIdNext(&other, 5000);
+    CHECK(e.high != a.high || e.low != a.low);
+}
+
+static void TestVariables(void)
+{
+    RunId run = { 1469918176385ull << 16, 1 }, parent = { 0, 0 };
+    const PSCHAR* vars[RUN_ID_VARS];
+    CHECK(RunIdVariables(&g_arena, &run, &parent, NULL, vars));
+    CHECK_STR(vars[0], PS_T("PS_LAUNCHER_RUN_ID=01ARYZ6S410000000000000001"));
+    CHECK_STR(vars[1], PS_T("PS_LAUNCHER_PARENT_ID"));
+    CHECK_STR(vars[2], PS_T("PS_LAUNCHER_ASSIGNED_ID"));
+}
+
+static void TestBegin(void)
+{
+    RunIdSource source;
+    RunId id, parent;
+    unsetenv("PS_LAUNCHER_ASSIGNED_ID");
+    unsetenv("PS_LAUNCHER_RUN_ID");
+    RunIdBegin(&source, &id, &parent);
+    CHECK(RunIdIsSet(&id) && !RunIdIsSet(&parent));
+
+    // Started from inside a run, with an id assigned by the starter
+    setenv("PS_LAUNCHER_RUN_ID", "01ARYZ6S410000000000000002", 1);
+    setenv("PS_LAUNCHER_ASSIGNED_ID", "01ARYZ6S410000000000000003", 1);
+    RunIdBegin(&source, &id, &parent);
+    CHECK(id.high == 1469918176385ull << 16 && id.low == 3);
+    CHECK(parent.high == 1469918176385ull << 16 && parent.low == 2);
+
+    // Garbage is no id
+    setenv("PS_LAUNCHER_RUN_ID", "not an id", 1);
+    setenv("PS_LAUNCHER_ASSIGNED_ID", "01ARYZ6S410000000000000003 ", 1);
+    RunIdBegin(&source, &id, &parent);
+    CHECK(id.low != 3 && RunIdIsSet(&id) && !RunIdIsSet(&parent));
+    unsetenv("PS_LAUNCHER_ASSIGNED_ID");
+    unsetenv("PS_LAUNCHER_RUN_ID");
+}
+
+int main(void)
+{
+    if (!ArenaInit(&g_arena, ARENA_COMMIT_GRANULE))
+        return 1;
+    RUN_TEST(TestFormat);
+    RUN_TEST(TestParse);
+    RUN_TEST(TestOrder);
+    RUN_TEST(TestVariables);
+    RUN_TEST(TestBegin);
+    ArenaRelease(&g_arena);
+    return TEST_SUMMARY();
+}
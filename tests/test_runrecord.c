@@ -0,0 +1,60 @@
+//--------------------------------------------------------------------------
+// TESTS: runrecord.c
+//--------------------------------------------------------------------------
+#include "runrecord.h"
+#include "testing.h"
+
+static Arena g_arena;
+
+static void TestFormatLine(void)
+{
+    RunRecord record = { PS_T("backup.ps1"), 1700000000123ull, 4567, 3, RUN_COMPLETED, { 0, 0 }, { 0, 0 } };
+    StrBuf line;
+
+    CHECK(StrBufInit(&line, &g_arena, 8, STRBUF_NO_LIMIT));
+    CHECK(FormatRunRecord(&record, &line));
+    CHECK_STR(line.data, PS_T("1700000000123\t4567\t3\tcompleted\t-\t-\tbackup.ps1\n"));
+    CHECK(line.len == 46);
+}
+
+static void TestRunIds(void)
+{
+    RunRecord record = { PS_T("child.ps1"), 1469918176385ull, 10, 0, RUN_COMPLETED,
+                         { 1469918176385ull << 16, 1 }, { 1469918176384ull << 16, 0 } };
+    StrBuf line;
+
+    CHECK(StrBufInit(&line, &g_arena, 8, STRBUF_NO_LIMIT));
+    CHECK(FormatRunRecord(&record, &line));
+    CHECK_STR(line.data, PS_T("1469918176385\t10\t0\tcompleted\t01ARYZ6S410000000000000001\t")
+                         PS_T("01ARYZ6S400000000000000000\tchild.ps1\n"));
+}
+
+static void TestStatusNames(void)
+{
+    CHECK_STR(RunStatusText(RUN_BLOCKED), PS_T("blocked"));
+    CHECK_STR(RunStatusText(RUN_SPAWN_FAILED), PS_T("spawn-failed"));
+    CHECK_STR(RunStatusText(RUN_STALE), PS_T("stale"));
+    CHECK_STR(RunStatusText(RUN_UP_TO_DATE), PS_T("up-to-date"));
+    CHECK_STR(RunStatusText(RUN_CACHED), PS_T("cached"));
+    CHECK_STR(RunStatusText(RUN_OVERLAP), PS_T("overlap"));
+}
+
+static void TestTooSmall(void)
+{
+    RunRecord record = { PS_T("backup.ps1"), 1, 2, 3, RUN_USAGE, { 0, 0 }, { 0, 0 } };
+    StrBuf line;
+    CHECK(StrBufInit(&line, &g_arena, 8, 7));
+    CHECK(!FormatRunRecord(&record, &line));
+}
+
+int main(void)
+{
+    if (!ArenaInit(&g_arena, ARENA_COMMIT_GRANULE))
+        return 1;
+    RUN_TEST(TestFormatLine);
+    RUN_TEST(TestRunIds);
+    RUN_TEST(TestStatusNames);
+    RUN_TEST(TestTooSmall);
+    ArenaRelease(&g_arena);
+    return TEST_SUMMARY();
+}
@@ -0,0 +1,135 @@
+//--------------------------------------------------------------------------
+// TESTS: scheduler.c (schedule files; the resident loop is in test_launcher)
+//--------------------------------------------------------------------------
+#include "scheduler.h"
+#include "psmem.h"
+#include "psstr.h"
+#include "testing.h"
+
+static Arena g_arena;
+
+// Parse a copy of text (ParseSchedule cuts it up)
+static bool ParseText(const PSCHAR* text, Schedule* schedule)
+{
+    size_t len = PsStrLen(text);
+    PSCHAR* copy = (PSCHAR*)ArenaAlloc(&g_arena, (len + 1) * sizeof(PSCHAR));
+    PsMemCpy(copy, text, (len + 1) * sizeof(PSCHAR));
+    return ParseSchedule(&g_arena, copy, len, schedule);
+}
+
+static void TestParseEntries(void)
+{
+    Schedule s;
+    CHECK(ParseText(PS_T("# nightly jobs\r\n")
+                    PS_T("\r\n")
+                    PS_T("*/5 * * * *   -Script @inventory  \r\n")
+                    PS_T("  0 2 * * mon-fri -Script \"/jobs/back up.ps1\" -Target x\n")
+                    PS_T("@daily -Script @cleanup\n")
+                    PS_T("@every 90s\t-Script @heartbeat"), &s));
+    CHECK(s.count == 4);
+
+    CHECK_STR(s.entries[0].line, PS_T("*/5 * * * *   -Script @inventory"));
+    CHECK_STR(s.entries[0].args, PS_T("-Script @inventory"));
+    CHECK(s.entries[0].lineNumber == 3);
+    uint64_t fives = 0;
+    for (int m = 0; m < 60; m += 5)
+        fives |= 1ull << m;
+    CHECK(s.entries[0].cron.minutes == fives);
+    CHECK(s.entries[0].everySeconds == 0);
+
+    CHECK_STR(s.entries[1].args, PS_T("-Script \"/jobs/back up.ps1\" -Target x"));
+    CHECK(s.entries[1].cron.weekdays == 0x3E);
+
+    CHECK_STR(s.entries[2].args, PS_T("-Script @cleanup"));
+    CHECK(s.entries[2].cron.minutes == 1 && s.entries[2].cron.hours == 1);
+
+    CHECK_STR(s.entries[3].args, PS_T("-Script @heartbeat"));
+    CHECK(s.entries[3].everySeconds == 90);
+    CHECK(!TimerPending(&s.entries[3].timer) && !s.entries[3].running);
+}
+
+static void TestIntervals(void)
+{
+    Schedule s;
+    CHECK(ParseText(PS_T("@every 15m -Script a\n@every 2h -Script b\n@EVERY 30 -Script c"), &s));
+    CHECK(s.count == 3);
+    CHECK(s.entries[0].everySeconds == 900);
+    CHECK(s.entries[1].everySeconds == 7200);
+    CHECK(s.entries[2].everySeconds == 30);
+    CHECK(ScheduleNextRun(&s.entries[0], 1000) == 1900);
+}
+
+static void TestClassesAndDeadlines(void)
+{
+    Schedule s;
+    CHECK(ParseText(PS_T("0 * * * * bulk -Script @reindex\n")
+                    PS_T("*/5 * * * * Interactive within 30s -Script @health\n")
+                    PS_T("@every 1m within 2m -Script @poll\n")
+                    PS_T("@hourly -Script bulk"), &s));
+    CHECK(s.count == 4);
+    CHECK(s.entries[0].cls == JOB_BULK && s.entries[0].withinSeconds == 0);
+    CHECK_STR(s.entries[0].args, PS_T("-Script @reindex"));
+    CHECK(s.entries[1].cls == JOB_INTERACTIVE && s.entries[1].withinSeconds == 30);
+    CHECK_STR(s.entries[1].args, PS_T("-Script @health"));
+    CHECK(s.entries[2].cls == JOB_NORMAL && s.entries[2].withinSeconds == 120);
+    CHECK(s.entries[2].everySeconds == 60);
+    CHECK(s.entries[3].cls == JOB_NORMAL);
+    CHECK_STR(s.entries[3].args, PS_T("-Script bulk"));
+    CHECK(!JobQueued(&s.entries[0].queued));
+
+    CHECK(!ParseText(PS_T("@hourly within -Script a"), &s));
+    CHECK(!ParseText(PS_T("@hourly within 0s -Script a"), &s));
+    CHECK(!ParseText(PS_T("@hourly bulk within 10s"), &s));        // No arguments
+}
+
+static void TestInvalidLines(void)
+{
+    Schedule s;
+    CHECK(!ParseText(PS_T("* * * * -Script a"), &s));            // Four fields
+    CHECK(!ParseText(PS_T("* * * * *"), &s));                    // No arguments
+    CHECK(!ParseText(PS_T("61 * * * * -Script a"), &s));
+    CHECK(!ParseText(PS_T("@reboot -Script a"), &s));
+    CHECK(!ParseText(PS_T("@every -Script a"), &s));
+    CHECK(!ParseText(PS_T("@every 0s -Script a"), &s));
+    CHECK(!ParseText(PS_T("@every 5d -Script a"), &s));
+    CHECK(!ParseText(PS_T("@every 9999h -Script a"), &s));
+    CHECK(!ParseText(PS_T("@hourly"), &s));
+
+    // SECURITY CHECK: No resident launcher started from a schedule
+    CHECK(!ParseText(PS_T("@hourly -schedule"), &s));
+    CHECK(!ParseText(PS_T("@hourly -Schedule other.schedule"), &s));
+    CHECK(!ParseText(PS_T("@hourly -Watch /srv/drop -Script a"), &s));
+    CHECK(!ParseText(PS_T("@hourly -serve"), &s));
+    CHECK(ParseText(PS_T("@hourly -Script a -Schedule"), &s) && s.count == 1);
+
+    // One bad line fails the file
+    CHECK(!ParseText(PS_T("@hourly -Script a\nnonsense\n"), &s));
+    CHECK(ParseText(PS_T(""), &s) && s.count == 0);
+}
+
+static void TestCronOccurrences(void)
+{
+    // Whatever the local zone, hourly runs land on a minute boundary
+    // within the next hour and a half (offsets can be :30 or :45)
+    Schedule s;
+    CHECK(ParseText(PS_T("@hourly -Script a\n*/10 * * * * -Script b\n0 0 30 2 * -Script c"), &s));
+    uint64_t now = 1710497222;              // 2024-03-15 10:07:02 UTC
+    uint64_t hourly = ScheduleNextRun(&s.entries[0], now);
+    CHECK(hourly > now && hourly <= now + 3600 && hourly % 60 == 0);
+    uint64_t tens = ScheduleNextRun(&s.entries[1], now);
+    CHECK(tens > now && tens <= now + 600 && tens % 60 == 0);
+    CHECK(ScheduleNextRun(&s.entries[2], now) == 0);
+}
+
+int main(void)
+{
+    if (!ArenaInit(&g_arena, ARENA_DEFAULT_RESERVE))
+        return 1;
+    RUN_TEST(TestParseEntries);
+    RUN_TEST(TestIntervals);
+    RUN_TEST(TestClassesAndDeadlines);
+    RUN_TEST(TestInvalidLines);
+    RUN_TEST(TestCronOccurrences);
+    ArenaRelease(&g_arena);
+    return TEST_SUMMARY();
+}
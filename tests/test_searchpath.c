@@ -0,0 +1,178 @@
+//--------------------------------------------------------------------------
+// TESTS: searchpath.c (POSIX file system)
+//--------------------------------------------------------------------------
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "searchpath.h"
+#include "testing.h"
+
+static char g_dir[400];
+static char g_path[1400];
+static char g_cache[512];
+static Arena g_arena;
+
+static void MakeDir(const char* name)
+{
+    char path[600];
+    snprintf(path, sizeof(path), "%s/%s", g_dir, name);
+    mkdir(path, 0700);
+}
+
+static void WriteFile(const char* name)
+{
+    char path[600];
+    snprintf(path, sizeof(path), "%s/%s", g_dir, name);
+    FILE* f = fopen(path, "w");
+    if (f)
+        fclose(f);
+}
+
+// Back-date a directory so its listing is not "racy" (same clock tick)
+static void SetModified(const char* name, time_t seconds)
+{
+    char path[600];
+    snprintf(path, sizeof(path), "%s/%s", g_dir, name);
+    struct timespec times[2] = { { seconds, 0 }, { seconds, 0 } };
+    utimensat(AT_FDCWD, path, times, 0);
+}
+
+// Look script up and compare against <dir>/<expected> (NULL: not found)
+static bool Finds(const char* script, const char* expected, SearchStats* stats)
+{
+    ArenaMark mark = ArenaSave(&g_arena);
+    PSCHAR* found = SearchScriptPath(&g_arena, g_path, g_cache, script, stats);
+    char want[600];
+    if (expected)
+        snprintf(want, sizeof(want), "%s/%s", g_dir, expected);
+    bool ok = expected ? (found && strcmp(found, want) == 0) : found == NULL;
+    ArenaRestore(&g_arena, mark);
+    return ok;
+}
+
+static void TestRelativePaths(void)
+{
+    CHECK(IsRelativePath("task.ps1"));
+    CHECK(IsRelativePath("sub/task.ps1"));
+    CHECK(IsRelativePath("../task.ps1"));
+    CHECK(!IsRelativePath("/opt/task.ps1"));
+}
+
+static void TestFirstListingThenCached(void)
+{
+    SearchStats stats;
+    CHECK(Finds("report.ps1", "c/report.ps1", &stats));
+    CHECK(stats.validated == 3);
+    CHECK(stats.listed == 3);
+    CHECK(stats.probed == 0);
+
+    // Unchanged directories: stamps only, no listing and no opens
+    CHECK(Finds("report.ps1", "c/report.ps1", &stats));
+    CHECK(stats.validated == 3);
+    CHECK(stats.listed == 0);
+    CHECK(stats.probed == 0);
+
+    // Earlier directories win; the search stops at the match
+    CHECK(Finds("shared.ps1", "a/shared.ps1", &stats));
+    CHECK(stats.validated == 1);
+    CHECK(Finds("missing.ps1", NULL, &stats));
+    CHECK(stats.validated == 3 && stats.listed == 0 && stats.probed == 0);
+}
+
+static void TestChangedDirectoryRelisted(void)
+{
+    SearchStats stats;
+    WriteFile("b/report.ps1");
+    SetModified("b", 1000000100);
+    CHECK(Finds("report.ps1", "b/report.ps1", &stats));
+    CHECK(stats.listed == 1);
+    CHECK(Finds("report.ps1", "b/report.ps1", &stats));
+    CHECK(stats.listed == 0);
+
+    // A directory listed within the racy window is listed again next time
+    WriteFile("a/fresh.ps1");
+    CHECK(Finds("fresh.ps1", "a/fresh.ps1", &stats));
+    CHECK(stats.listed == 1);
+    CHECK(Finds("fresh.ps1", "a/fresh.ps1", &stats));
+    CHECK(stats.listed == 1);
+    SetModified("a", 1000000200);
+}
+
+static void TestNestedAndDotted(void)
+{
+    SearchStats stats;
+    // "sub" is a directory in c's listing; only then is the file probed
+    CHECK(Finds("sub/deep.ps1", "c/sub/deep.ps1", &stats));
+    CHECK(stats.probed == 1);
+    CHECK(Finds("nosuch/deep.ps1", NULL, &stats));
+    CHECK(stats.probed == 0);
+    // A directory named like the script is not a match
+    CHECK(Finds("sub", NULL, &stats));
+    CHECK(Finds("./report.ps1", "b/./report.ps1", &stats));
+    CHECK(stats.probed == 2);
+    CHECK(Finds("/abs/report.ps1", NULL, &stats));
+    CHECK(stats.validated == 0);
+}
+
+static void TestMissingDirectoryAndDamagedCache(void)
+{
+    SearchStats stats;
+    char saved[sizeof(g_path)];
+    memcpy(saved, g_path, sizeof(g_path));
+    snprintf(g_path, sizeof(g_path), "%s/gone::%s/c/", g_dir, g_dir);
+    CHECK(Finds("report.ps1", "c/report.ps1", &stats));
+    CHECK(stats.validated == 2);
+    memcpy(g_path, saved, sizeof(g_path));
+
+    FILE* f = fopen(g_cache, "w");
+    if (f)
+    {
+        fputs("PSDC garbage", f);
+        fclose(f);
+    }
+    CHECK(Finds("report.ps1", "b/report.ps1", &stats));
+    CHECK(stats.listed == 2);
+    CHECK(Finds("report.ps1", "b/report.ps1", &stats));
+    CHECK(stats.listed == 0);
+}
+
+int main(void)
+{
+    char cwd[300];
+    if (!getcwd(cwd, sizeof(cwd)))
+        return 1;
+    snprintf(g_dir, sizeof(g_dir), "%s/searchpath_scratch", cwd);
+    snprintf(g_cache, sizeof(g_cache), "%s/ps-launcher.dircache", g_dir);
+    snprintf(g_path, sizeof(g_path), "%s/a:%s/b:%s/c", g_dir, g_dir, g_dir);
+
+    char cmd[600];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", g_dir);
+    if (system(cmd) != 0)
+        return 1;
+    mkdir(g_dir, 0700);
+    MakeDir("a");
+    MakeDir("b");
+    MakeDir("c");
+    MakeDir("c/sub");
+    WriteFile("a/shared.ps1");
+    WriteFile("c/shared.ps1");
+    WriteFile("c/report.ps1");
+    WriteFile("c/sub/deep.ps1");
+    SetModified("a", 1000000000);
+    SetModified("b", 1000000000);
+    SetModified("c", 1000000000);
+
+    if (!ArenaInit(&g_arena, ARENA_DEFAULT_RESERVE))
+        return 1;
+    RUN_TEST(TestRelativePaths);
+    RUN_TEST(TestFirstListingThenCached);
+    RUN_TEST(TestChangedDirectoryRelisted);
+    RUN_TEST(TestNestedAndDotted);
+    RUN_TEST(TestMissingDirectoryAndDamagedCache);
+    ArenaRelease(&g_arena);
+    return TEST_SUMMARY();
+}
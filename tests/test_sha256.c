@@ -0,0 +1,75 @@
+//--------------------------------------------------------------------------
+// TESTS: sha256.c
+//--------------------------------------------------------------------------
+#include "psmem.h"
+#include "sha256.h"
+#include "testing.h"
+
+static int DigestIs(const uint8_t digest[SHA256_DIGEST_SIZE], const char* hex)
+{
+    static const char digits[] = "0123456789abcdef";
+    for (int i = 0; i < SHA256_DIGEST_SIZE; i++)
+    {
+        if (hex[2 * i] != digits[digest[i] >> 4] || hex[2 * i + 1] != digits[digest[i] & 15])
+            return 0;
+    }
+    return hex[2 * SHA256_DIGEST_SIZE] == 0;
+}
+
+// FIPS 180-4 example vectors
+static void TestKnownVectors(void)
+{
+    uint8_t d[SHA256_DIGEST_SIZE];
+    Sha256Hash("", 0, d);
+    CHECK(DigestIs(d, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"));
+    Sha256Hash("abc", 3, d);
+    CHECK(DigestIs(d, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+    static const char two[] = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    Sha256Hash(two, sizeof(two) - 1, d);
+    CHECK(DigestIs(d, "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"));
+}
+
+static void TestMillionA(void)
+{
+    uint8_t chunk[1000];
+    PsMemSet(chunk, 'a', sizeof(chunk));
+    Sha256 ctx;
+    Sha256Init(&ctx);
+    for (int i = 0; i < 1000; i++)
+        Sha256Update(&ctx, chunk, sizeof(chunk));
+    uint8_t d[SHA256_DIGEST_SIZE];
+    Sha256Final(&ctx, d);
+    CHECK(DigestIs(d, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"));
+}
+
+// Updates split at every offset give the one-shot digest
+static void TestIncrementalMatchesOneShot(void)
+{
+    uint8_t data[200];
+    for (int i = 0; i < 200; i++)
+        data[i] = (uint8_t)(i * 7);
+    uint8_t expected[SHA256_DIGEST_SIZE];
+    Sha256Hash(data, sizeof(data), expected);
+
+    int mismatches = 0;
+    for (size_t split = 0; split <= sizeof(data); split++)
+    {
+        Sha256 ctx;
+        uint8_t d[SHA256_DIGEST_SIZE];
+        Sha256Init(&ctx);
+        Sha256Update(&ctx, data, split);
+        Sha256Update(&ctx, data + split, sizeof(data) - split);
+        Sha256Final(&ctx, d);
+        for (int i = 0; i < SHA256_DIGEST_SIZE; i++)
+            mismatches += d[i] != expected[i];
+    }
+    CHECK(mismatches == 0);
+}
+
+int main(void)
+{
+    RUN_TEST(TestKnownVectors);
+    RUN_TEST(TestMillionA);
+    RUN_TEST(TestIncrementalMatchesOneShot);
+    return TEST_SUMMARY();
+}
@@ -0,0 +1,215 @@
+//--------------------------------------------------------------------------
+// TESTS: status.c board over POSIX shared memory
+//--------------------------------------------------------------------------
+// Every test uses a board of its own name, removed at the end. Torn reads
+// are looked for with a writer in another process publishing entries
+// whose every field derives from one counter.
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "status.h"
+#include "testing.h"
+
+#define WRITER_MILLIS 300
+
+static char g_name[64];
+
+static void FillEntry(StatusEntry* e, uint64_t n, uint32_t pid)
+{
+    memset(e, 0, sizeof(*e));
+    e->runId = n + 1;
+    e->startMillis = n * 3;
+    e->cpuMicros = n * 5;
+    e->outputBytes = n * 7;
+    e->launcherPid = pid;
+    e->childPid = (uint32_t)n;
+    e->kind = STATUS_RUN;
+    e->phase = STATUS_RUNNING;
+    e->scriptLen = (uint16_t)(100 + n % 100);
+    memset(e->script, 'a' + (int)(n % 26), e->scriptLen);
+}
+
+// Every field agrees with runId: the entry is one the writer wrote
+static bool Consistent(const StatusEntry* e)
+{
+    uint64_t n = e->runId - 1;
+    if (e->startMillis != n * 3 || e->cpuMicros != n * 5 || e->outputBytes != n * 7 ||
+        e->childPid != (uint32_t)n || e->scriptLen != 100 + n % 100)
+        return false;
+    for (size_t i = 0; i < e->scriptLen; i++)
+    {
+        if (e->script[i] != 'a' + (int)(n % 26))
+            return false;
+    }
+    return true;
+}
+
+static void TestClaimPublishRelease(void)
+{
+    StatusBoard board, other;
+    CHECK(StatusBoardOpen(&board, g_name, true));
+    CHECK(StatusBoardOpen(&other, g_name, false));      // A second mapping of the same board
+    StatusEntry entries[STATUS_SLOTS];
+    uint32_t pid = (uint32_t)getpid();
+
+    int slot = StatusClaim(&board, pid);
+    CHECK(slot >= 0);
+    CHECK(StatusSnapshot(&other, entries, STATUS_SLOTS) == 0);    // Nothing published yet
+
+    StatusEntry e;
+    FillEntry(&e, 41, pid);
+    StatusPublish(&board, slot, &e);
+    CHECK(StatusSnapshot(&other, entries, STATUS_SLOTS) == 1);
+    CHECK(memcmp(&entries[0], &e, sizeof(e)) == 0);
+
+    StatusRelease(&board, slot);
+    CHECK(StatusSnapshot(&other, entries, STATUS_SLOTS) == 0);
+
+    uint64_t a = StatusNextRunId(&board);
+    uint64_t b = StatusNextRunId(&other);
+    CHECK(a != 0 && b == a + 1);
+    StatusBoardClose(&other);
+    StatusBoardClose(&board);
+
+    // Reading never creates a board
+    CHECK(!StatusBoardOpen(&other, "psl-status-test-missing", false));
+}
+
+static void TestFullBoard(void)
+{
+    StatusBoard board;
+    CHECK(StatusBoardOpen(&board, g_name, true));
+    uint32_t pid = (uint32_t)getpid();
+    static int slots[STATUS_SLOTS];
+    bool seen[STATUS_SLOTS] = { false };
+    int distinct = 0;
+    for (int i = 0; i < STATUS_SLOTS; i++)
+    {
+        slots[i] = StatusClaim(&board, pid);
+        if (slots[i] >= 0 && !seen[slots[i]])
+        {
+            seen[slots[i]] = true;
+            distinct++;
+        }
+    }
+    CHECK(distinct == STATUS_SLOTS);
+    CHECK(StatusClaim(&board, pid) == -1);                   // Every owner is alive
+    for (int i = 0; i < STATUS_SLOTS; i++)
+        StatusRelease(&board, slots[i]);
+    StatusBoardClose(&board);
+}
+
+static void TestDeadOwnerReclaimed(void)
+{
+    pid_t dead = fork();
+    if (dead == 0)
+        _exit(0);
+    int status;
+    waitpid(dead, &status, 0);
+
+    StatusBoard board;
+    CHECK(StatusBoardOpen(&board, g_name, true));
+    static int slots[STATUS_SLOTS];
+    for (int i = 0; i < STATUS_SLOTS; i++)
+    {
+        slots[i] = StatusClaim(&board, (uint32_t)dead);
+        StatusEntry e;
+        FillEntry(&e, (uint64_t)i, (uint32_t)dead);
+        StatusPublish(&board, slots[i], &e);
+    }
+    StatusEntry entries[STATUS_SLOTS];
+    CHECK(StatusSnapshot(&board, entries, STATUS_SLOTS) == STATUS_SLOTS);
+
+    // The board is full of a crashed launcher's slots: one is taken over
+    // and no longer shows its stale entry
+    int slot = StatusClaim(&board, (uint32_t)getpid());
+    CHECK(slot >= 0);
+    CHECK(StatusSnapshot(&board, entries, STATUS_SLOTS) == STATUS_SLOTS - 1);
+    for (int i = 0; i < STATUS_SLOTS; i++)
+        StatusRelease(&board, slots[i]);
+    StatusBoardClose(&board);
+}
+
+static void TestNoTornReads(void)
+{
+    pid_t writer = fork();
+    if (writer == 0)
+    {
+        StatusBoard board;
+        if (!StatusBoardOpen(&board, g_name, true))
+            _exit(1);
+        int slot = StatusClaim(&board, (uint32_t)getpid());
+        StatusEntry e;
+        for (uint64_t n = 0;; n++)
+        {
+            FillEntry(&e, n, (uint32_t)getpid());
+            StatusPublish(&board, slot, &e);
+        }
+    }
+
+    StatusBoard board;
+    CHECK(StatusBoardOpen(&board, g_name, true));
+    StatusEntry entries[STATUS_SLOTS];
+    uint64_t reads = 0, torn = 0, last = 0;
+    bool ordered = true;
+    uint64_t start = PlatMonotonicNanos();
+    while (PlatMonotonicNanos() - start < WRITER_MILLIS * 1000000ull)
+    {
+        size_t count = StatusSnapshot(&board, entries, STATUS_SLOTS);
+        for (size_t i = 0; i < count; i++)
+        {
+            reads++;
+            torn += !Consistent(&entries[i]);
+            // One writer: runs seen in order, never one from the past
+            ordered = ordered && entries[i].runId >= last;
+            last = entries[i].runId;
+        }
+    }
+    kill(writer, SIGKILL);
+    int status;
+    waitpid(writer, &status, 0);
+    StatusBoardClose(&board);
+
+    CHECK(reads > 100);
+    CHECK(torn == 0);
+    CHECK(ordered);
+    printf("  %llu reads, last entry %llu\n", (unsigned long long)reads, (unsigned long long)last);
+}
+
+static void TestScriptTail(void)
+{
+    StatusEntry e;
+    StatusSetScript(&e, "/srv/jobs/nightly.ps1");
+    CHECK(e.scriptLen == 21 && memcmp(e.script, "/srv/jobs/nightly.ps1", 21) == 0);
+
+    // Too long: the end survives, after "...", with no partial character
+    char path[400];
+    memset(path, 'd', sizeof(path));
+    memcpy(path + 197, "\xc3\xa9", 2);                 // U+00E9 across the cut
+    memcpy(path + sizeof(path) - 12, "/report.ps1", 12);
+    StatusSetScript(&e, path);
+    CHECK(e.scriptLen <= STATUS_SCRIPT_BYTES);
+    CHECK(memcmp(e.script, "...", 3) == 0);
+    CHECK(memcmp(e.script + e.scriptLen - 11, "/report.ps1", 11) == 0);
+    CHECK(((unsigned char)e.script[3] & 0xC0) != 0x80);
+}
+
+int main(void)
+{
+    snprintf(g_name, sizeof(g_name), "psl-status-test-%d", (int)getpid());
+
+    RUN_TEST(TestClaimPublishRelease);
+    RUN_TEST(TestFullBoard);
+    RUN_TEST(TestDeadOwnerReclaimed);
+    RUN_TEST(TestNoTornReads);
+    RUN_TEST(TestScriptTail);
+
+    char object[128];
+    snprintf(object, sizeof(object), "/%s-%u", g_name, (unsigned)getuid());
+    shm_unlink(object);
+    return TEST_SUMMARY();
+}
@@ -0,0 +1,140 @@
+//--------------------------------------------------------------------------
+// TESTS: src/cpp (StringView, SmallString, C++ command line building)
+//--------------------------------------------------------------------------
+#include "cmdline.hpp"
+#include "psstr.h"
+#include "quote.h"
+#include "testing.h"
+
+using namespace ps;
+
+static Arena g_arena;
+
+template <typename C>
+static bool Same(BasicStringView<C> a, BasicStringView<C> b)
+{
+    return a.Equals(b);
+}
+
+static void TestUtf8View(void)
+{
+    Utf8View v("Caf\xC3\xA9 -Script");
+    CHECK(v.size() == 13);
+    CHECK(v.Find(' ') == 5);
+    CHECK(v.Find('x') == Utf8View::npos);
+    CHECK(v.Find('C', 1) == Utf8View::npos);
+    CHECK(Same(v.Substr(6), Utf8View("-Script")));
+    CHECK(v.Substr(6).EqualsIgnoreCase("-SCRIPT"));
+    CHECK(!v.Substr(6).EqualsIgnoreCase("-Scrip"));
+    CHECK(v.StartsWith("Caf"));
+    CHECK(Utf8View::FromTerminated("abc").size() == 3);
+    CHECK(Utf8View::FromTerminated(nullptr).empty());
+}
+
+static void TestUtf16View(void)
+{
+    // Long enough to take the vector path of the 16-bit search
+    Utf16View v(u"C:\\Program Files\\PowerShell\\7\\pwsh.exe");
+    CHECK(v.size() == 38);
+    CHECK(v.Find(u'7') == 28);
+    CHECK(v.Find(u'\u00E9') == Utf16View::npos);
+    CHECK(v.Substr(30).Equals(u"pwsh.exe"));
+    CHECK(v.Substr(30).EqualsIgnoreCase(u"PWSH.EXE"));
+    CHECK(v.Substr(100).empty());
+    CHECK(Utf16View::FromTerminated(u"\u00E9t\u00E9").size() == 3);
+    CHECK(v.IsTerminated());
+}
+
+static void TestSmallStringInline(void)
+{
+    BasicSmallString<char16_t, 8> s;
+    CHECK(s.Append(u"abc") && s.Append(u'd') && s.AppendUInt(123));
+    CHECK(s.IsInline());
+    CHECK(s.view().Equals(u"abcd123"));
+    CHECK(s.c_str()[7] == 0);
+
+    // No arena: the inline buffer is the limit, and a failed append is a no-op
+    CHECK(!s.Append(u'x'));
+    CHECK(s.size() == 7);
+    s.Clear();
+    CHECK(s.empty() && s.c_str()[0] == 0);
+}
+
+static void TestSmallStringSpill(void)
+{
+    BasicSmallString<char, 4> s(&g_arena);
+    CHECK(s.Append("hello"));
+    CHECK(!s.IsInline());
+    const char* spilled = s.c_str();
+    CHECK(s.Append(" world"));
+    CHECK(s.c_str() == spilled);                 // Grew in place on the arena
+    ArenaAlloc(&g_arena, 8);
+    CHECK(s.Append(", and more"));
+    CHECK(s.view().Equals("hello world, and more"));
+
+    BasicSmallString<char, 4> limited(&g_arena, 5);
+    CHECK(limited.Append("abcde"));
+    CHECK(!limited.Append('f'));
+    CHECK(limited.view().Equals("abcde"));
+    CHECK(limited.AppendUInt(0) == false);
+}
+
+// The C++ builder must produce exactly what the C core produces
+static void TestMatchesCoreQuoting(void)
+{
+    static const PSCHAR* const params[] = {
+        PS_T(""), PS_T("value"), PS_T("a b"), PS_T("say \"hi\""), PS_T("\"as is\""),
+        PS_T("\""), PS_T("x\"\"y\"z"), PS_T("C:\\Program Files\\App\\"), PS_T("-42"),
+    };
+
+    for (const PSCHAR* param : params)
+    {
+        StrBuf core;
+        CHECK(StrBufInit(&core, &g_arena, 16, STRBUF_NO_LIMIT));
+        CHECK(AppendQuotedParameter(&core, param));
+
+        BasicSmallString<PSCHAR, 16> cpp(&g_arena);
+        CHECK(AppendQuotedParameter(cpp, StringView::FromTerminated(param)));
+        CHECK(cpp.view().Equals(StringView(core.data, core.len)));
+    }
+}
+
+static void TestBuildCommandLine(void)
+{
+    StringView argv[] = { PS_T("ps-launcher"), PS_T("-script"), PS_T("C:\\s\\a.ps1"),
+                          PS_T("-Name"), PS_T("John Doe") };
+    LaunchArgsView args;
+    CHECK(ParseLaunchArgs(argv, 5, &args));
+    CHECK(args.paramCount == 2);
+    CHECK(!ParseLaunchArgs(argv, 2, &args));
+
+    CommandLineString cmd(&g_arena);
+    CHECK(BuildCommandLine<PowerShellQuoting>(cmd, PS_T("C:\\ps.exe"), args, nullptr) == CMD_OK);
+    CHECK(cmd.view().Equals(PS_T("\"C:\\ps.exe\" -NonInteractive -NoProfile -ExecutionPolicy Bypass ")
+                            PS_T("-File \"C:\\s\\a.ps1\" \"-Name\" \"John Doe\"")));
+
+    StringView blockedArgv[] = { PS_T("x"), PS_T("-Script"), PS_T("a.ps1"),
+                                 PS_T("ok"), PS_T("a; Remove-Item x") };
+    int blocked = -1;
+    CommandLineString cmd2(&g_arena);
+    CHECK(ParseLaunchArgs(blockedArgv, 5, &args));
+    CHECK(BuildCommandLine<PowerShellQuoting>(cmd2, PS_T("ps"), args, &blocked) == CMD_BLOCKED);
+    CHECK(blocked == 1);
+
+    CommandLineString small(&g_arena, 20);
+    CHECK(BuildCommandLine<PowerShellQuoting>(small, PS_T("ps"), args, nullptr) == CMD_OVERFLOW);
+}
+
+int main(void)
+{
+    if (!ArenaInit(&g_arena, ARENA_COMMIT_GRANULE * 4))
+        return 1;
+    RUN_TEST(TestUtf8View);
+    RUN_TEST(TestUtf16View);
+    RUN_TEST(TestSmallStringInline);
+    RUN_TEST(TestSmallStringSpill);
+    RUN_TEST(TestMatchesCoreQuoting);
+    RUN_TEST(TestBuildCommandLine);
+    ArenaRelease(&g_arena);
+    return TEST_SUMMARY();
+}
@@ -0,0 +1,148 @@
+//--------------------------------------------------------------------------
+// TESTS: timerwheel.c
+//--------------------------------------------------------------------------
+#include "timerwheel.h"
+#include "testing.h"
+
+#define TIMER_COUNT 4000
+
+static TimerNode g_nodes[TIMER_COUNT];
+static uint64_t g_due[TIMER_COUNT];       // 0 when not scheduled
+static TimerWheel g_wheel;
+
+static uint64_t g_seed = 88172645463325252ull;
+static uint64_t NextRandom(void)
+{
+    g_seed ^= g_seed << 13;
+    g_seed ^= g_seed >> 7;
+    g_seed ^= g_seed << 17;
+    return g_seed;
+}
+
+static uint32_t IndexOf(const TimerNode* node)
+{
+    return (uint32_t)(node - g_nodes);
+}
+
+// Advance and check every expired timer against the brute-force list
+static void AdvanceAndCheck(uint64_t to)
+{
+    uint64_t last = 0;
+    uint32_t fired = 0;
+    for (TimerNode* node = TimerWheelAdvance(&g_wheel, to); node; node = node->next)
+    {
+        uint32_t i = IndexOf(node);
+        CHECK(g_due[i] != 0 && g_due[i] <= to);
+        CHECK(node->expires >= last);      // In expiry order
+        CHECK(!TimerPending(node));
+        last = node->expires;
+        g_due[i] = 0;
+        fired++;
+    }
+    (void)fired;
+    for (uint32_t i = 0; i < TIMER_COUNT; i++)
+        CHECK(g_due[i] == 0 || g_due[i] > to);
+}
+
+static void TestSingleTimers(void)
+{
+    TimerWheelInit(&g_wheel, 1000);
+    uint64_t tick;
+    CHECK(!TimerWheelNextExpiry(&g_wheel, &tick));
+    CHECK(TimerWheelAdvance(&g_wheel, 5000) == NULL);
+    CHECK(g_wheel.now == 5000);
+
+    TimerNode a = { 0 };
+    TimerWheelAdd(&g_wheel, &a, 5010);
+    CHECK(TimerPending(&a));
+    CHECK(TimerWheelNextExpiry(&g_wheel, &tick) && tick == 5010);
+    CHECK(TimerWheelAdvance(&g_wheel, 5009) == NULL);
+    CHECK(TimerWheelAdvance(&g_wheel, 5010) == &a);
+    CHECK(g_wheel.count == 0);
+
+    // Far timers: slot starts first, the exact tick after the cascade
+    TimerWheelAdd(&g_wheel, &a, 5010 + 100000);
+    CHECK(TimerWheelNextExpiry(&g_wheel, &tick) && tick <= 105010);
+    CHECK(TimerWheelAdvance(&g_wheel, 105009) == NULL);
+    CHECK(TimerWheelNextExpiry(&g_wheel, &tick) && tick == 105010);
+    CHECK(TimerWheelAdvance(&g_wheel, 105010) == &a);
+
+    // The past fires on the next advance, and cancel takes effect
+    TimerWheelAdd(&g_wheel, &a, 3);
+    CHECK(a.expires == 105011);
+    TimerWheelCancel(&g_wheel, &a);
+    CHECK(!TimerPending(&a) && g_wheel.count == 0);
+    TimerWheelCancel(&g_wheel, &a);
+    CHECK(TimerWheelAdvance(&g_wheel, 200000) == NULL);
+}
+
+static void TestBeyondTopLevel(void)
+{
+    // More than 2^36 ticks ahead goes through the overflow list
+    TimerNode a = { 0 };
+    TimerNode b = { 0 };
+    TimerWheelInit(&g_wheel, 7);
+    TimerWheelAdd(&g_wheel, &a, ((uint64_t)1 << 40) + 3);
+    TimerWheelAdd(&g_wheel, &b, ((uint64_t)1 << 37));
+    CHECK(TimerWheelAdvance(&g_wheel, ((uint64_t)1 << 37) - 1) == NULL);
+    TimerNode* fired = TimerWheelAdvance(&g_wheel, ((uint64_t)1 << 37));
+    CHECK(fired == &b && fired->next == NULL);
+    CHECK(TimerWheelAdvance(&g_wheel, ((uint64_t)1 << 40) + 2) == NULL);
+    CHECK(TimerWheelAdvance(&g_wheel, ((uint64_t)1 << 40) + 3) == &a);
+}
+
+static void TestRandomAgainstBruteForce(void)
+{
+    uint64_t now = 1700000000;
+    TimerWheelInit(&g_wheel, now);
+    for (uint32_t i = 0; i < TIMER_COUNT; i++)
+        g_due[i] = 0;
+
+    for (int round = 0; round < 3000; round++)
+    {
+        // Add, re-add or cancel a few timers at mixed distances
+        for (int k = 0; k < 4; k++)
+        {
+            uint32_t i = (uint32_t)(NextRandom() % TIMER_COUNT);
+            uint64_t r = NextRandom();
+            if (r % 5 == 0)
+            {
+                TimerWheelCancel(&g_wheel, &g_nodes[i]);
+                g_due[i] = 0;
+                continue;
+            }
+            static const uint64_t spans[] = { 1, 64, 4096, 262144, 16777216 };
+            uint64_t at = now + 1 + (r >> 8) % spans[(r >> 4) % 5];
+            TimerWheelAdd(&g_wheel, &g_nodes[i], at);
+            g_due[i] = at;
+        }
+
+        uint32_t pending = 0;
+        uint64_t earliest = UINT64_MAX;
+        for (uint32_t i = 0; i < TIMER_COUNT; i++)
+        {
+            if (g_due[i])
+            {
+                pending++;
+                earliest = g_due[i] < earliest ? g_due[i] : earliest;
+            }
+        }
+        CHECK(g_wheel.count == pending);
+        uint64_t next;
+        CHECK(TimerWheelNextExpiry(&g_wheel, &next) == (pending > 0));
+        if (pending)
+            CHECK(next <= earliest);
+
+        // Step to the next expiry, or jump far ahead now and then
+        now = (NextRandom() % 16 == 0 || !pending) ? now + NextRandom() % 100000 : next;
+        AdvanceAndCheck(now);
+    }
+}
+
+int main(void)
+{
+    RUN_TEST(TestSingleTimers);
+    RUN_TEST(TestBeyondTopLevel);
+    RUN_TEST(TestRandomAgainstBruteForce);
+    return TEST_SUMMARY();
+}
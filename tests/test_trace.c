@@ -0,0 +1,166 @@
+//--------------------------------------------------------------------------
+// TESTS: trace.c buffers, their JSON lines and concurrent appends
+//--------------------------------------------------------------------------
+// Trace files go under /tmp, named for this process, and are removed at
+// the end. Concurrent appends are checked with forked writers flushing
+// small buffers into the same file.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "trace.h"
+#include "testing.h"
+
+#define WRITERS        8
+#define SPANS_EACH     1000
+
+static char g_path[64];
+static char g_text[1 << 21];
+
+static const char* ReadTrace(void)
+{
+    FILE* f = fopen(g_path, "rb");
+    size_t n = f ? fread(g_text, 1, sizeof(g_text) - 1, f) : 0;
+    if (f)
+        fclose(f);
+    g_text[n] = 0;
+    return g_text;
+}
+
+static size_t CountOf(const char* text, const char* needle)
+{
+    size_t count = 0;
+    for (const char* p = strstr(text, needle); p; p = strstr(p + 1, needle))
+        count++;
+    return count;
+}
+
+static void TestEventLines(void)
+{
+    Arena arena;
+    TraceBuffer trace;
+    CHECK(ArenaInit(&arena, 1 << 20));
+    CHECK(TraceOpen(&trace, &arena, g_path, "ps-launcher", 16));
+    TraceSetDetail(&trace, "/srv/say \"hi\".ps1");
+    RunId session = { 1469918176385ull << 16, 0 }, run = { 1469918176385ull << 16, 1 }, none = { 0, 0 };
+    TraceSetRun(&trace, &session, &none);
+    TraceNameTrack(&trace, 3, "job", 42);
+    TraceSpan(&trace, 3, NULL, "admission", 1000, 1500);
+    TraceSpanArg(&trace, 3, &run, "run", 1500, 3500123, "exitCode", 7);
+    TraceInstant(&trace, 3, &run, "first output", 2000001);
+    TraceCounter(&trace, "run limit", "limit", 12, 4000000);
+    TraceClose(&trace);
+    TracePut(&trace, TRACE_SPAN, 1, NULL, "late", 0, 1, NULL, 0);   // Closed: nothing recorded
+    CHECK(trace.count == 0);
+
+    char pid[32], line[256];
+    snprintf(pid, sizeof(pid), "\"pid\":%u", (unsigned)getpid());
+    const char* text = ReadTrace();
+    CHECK(strncmp(text, "[\n{\"name\":\"process_name\",\"ph\":\"M\",", 34) == 0);
+    snprintf(line, sizeof(line), "{\"name\":\"process_name\",\"ph\":\"M\",%s,"
+             "\"args\":{\"name\":\"ps-launcher /srv/say \\\"hi\\\".ps1\",\"runId\":\"01ARYZ6S410000000000000000\"}},\n", pid);
+    CHECK(strstr(text, line) != NULL);
+    snprintf(line, sizeof(line), "{\"name\":\"thread_name\",\"ph\":\"M\",%s,\"tid\":3,"
+             "\"args\":{\"name\":\"job 42\"}},\n", pid);
+    CHECK(strstr(text, line) != NULL);
+    snprintf(line, sizeof(line), "{\"name\":\"admission\",\"ph\":\"X\",\"ts\":1.000,\"dur\":0.500,%s,\"tid\":3},\n", pid);
+    CHECK(strstr(text, line) != NULL);
+    snprintf(line, sizeof(line), "{\"name\":\"run\",\"ph\":\"X\",\"ts\":1.500,\"dur\":3498.623,%s,\"tid\":3,"
+             "\"args\":{\"runId\":\"01ARYZ6S410000000000000001\",\"exitCode\":7}},\n", pid);
+    CHECK(strstr(text, line) != NULL);
+    snprintf(line, sizeof(line), "{\"name\":\"first output\",\"ph\":\"i\",\"s\":\"t\",\"ts\":2000.001,%s,\"tid\":3,"
+             "\"args\":{\"runId\":\"01ARYZ6S410000000000000001\"}},\n", pid);
+    CHECK(strstr(text, line) != NULL);
+    snprintf(line, sizeof(line), "{\"name\":\"run limit\",\"ph\":\"C\",\"ts\":4000.000,%s,\"tid\":0,"
+             "\"args\":{\"limit\":12}},\n", pid);
+    CHECK(strstr(text, line) != NULL);
+    CHECK(CountOf(text, "\n") == 7);
+    ArenaRelease(&arena);
+    unlink(g_path);
+}
+
+static void TestFullBufferFlushes(void)
+{
+    Arena arena;
+    TraceBuffer trace;
+    CHECK(ArenaInit(&arena, 1 << 20));
+    CHECK(TraceOpen(&trace, &arena, g_path, "engine", 4));
+    ArenaMark mark = ArenaSave(&arena);
+    for (uint64_t i = 0; i < 10; i++)
+        TraceSpan(&trace, 1, NULL, "step", i * 1000, i * 1000 + 500);
+    CHECK(trace.count == 2);                    // Two full flushes went out
+    CHECK(ArenaSave(&arena) == mark);           // ...on scratch space given back
+    TraceClose(&trace);
+    const char* text = ReadTrace();
+    CHECK(CountOf(text, "\"name\":\"step\"") == 10);
+    CHECK(CountOf(text, "process_name") == 3);
+    CHECK(CountOf(text, "[\n") == 1);
+
+    // Not tracing: nothing is opened or written
+    CHECK(!TraceOpen(&trace, &arena, "", "engine", 4));
+    TraceSpan(&trace, 1, NULL, "step", 0, 1);
+    TraceClose(&trace);
+    ArenaRelease(&arena);
+    unlink(g_path);
+}
+
+static void TestConcurrentAppends(void)
+{
+    pid_t pids[WRITERS];
+    for (int w = 0; w < WRITERS; w++)
+    {
+        pids[w] = fork();
+        if (pids[w] == 0)
+        {
+            Arena arena;
+            TraceBuffer trace;
+            if (!ArenaInit(&arena, 1 << 20) || !TraceOpen(&trace, &arena, g_path, "writer", 100))
+                _exit(1);
+            TraceSetDetail(&trace, "a fairly long detail to make every flush a few kilobytes");
+            for (uint64_t i = 0; i < SPANS_EACH; i++)
+                TraceSpanArg(&trace, (uint32_t)w + 1, NULL, "span", i, i + 10, "index", i);
+            TraceClose(&trace);
+            _exit(0);
+        }
+    }
+    bool exited = true;
+    for (int w = 0; w < WRITERS; w++)
+    {
+        int status;
+        waitpid(pids[w], &status, 0);
+        exited = exited && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    CHECK(exited);
+
+    // Every line after the "[" is one whole event
+    const char* text = ReadTrace();
+    CHECK(strncmp(text, "[\n", 2) == 0);
+    size_t lines = 0, whole = 0;
+    for (const char* p = text + 2; *p; lines++)
+    {
+        const char* end = strchr(p, '\n');
+        if (!end)
+            break;
+        whole += strncmp(p, "{\"name\":\"", 9) == 0 && end - p > 4 && strncmp(end - 2, "},", 2) == 0;
+        p = end + 1;
+    }
+    CHECK(lines == whole);
+    CHECK(CountOf(text, "\"ph\":\"X\"") == (size_t)WRITERS * SPANS_EACH);
+    CHECK(CountOf(text, "[\n") == 1);
+    unlink(g_path);
+}
+
+int main(void)
+{
+    snprintf(g_path, sizeof(g_path), "/tmp/psl-trace-test-%d.json", (int)getpid());
+    unlink(g_path);
+
+    RUN_TEST(TestEventLines);
+    RUN_TEST(TestFullBufferFlushes);
+    RUN_TEST(TestConcurrentAppends);
+
+    unlink(g_path);
+    return TEST_SUMMARY();
+}
@@ -0,0 +1,162 @@
+//--------------------------------------------------------------------------
+// TESTS: watch.c and the platform directory watch (POSIX file system)
+//--------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "watch.h"
+#include "testing.h"
+
+#define BURST_FILES 20000                // More than the default inotify queue
+
+static char g_dir[400];
+static Arena g_arena;
+
+static void Touch(const char* dir, const char* name)
+{
+    char path[600];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE* f = fopen(path, "w");
+    if (f)
+        fclose(f);
+}
+
+static void AddChange(void* ctx, const PSCHAR* name, size_t nameLen)
+{
+    ChangeSetAdd((ChangeSet*)ctx, name, nameLen);
+}
+
+static void TestChangeSetDedupe(void)
+{
+    ChangeSet set;
+    CHECK(ChangeSetInit(&set));
+    CHECK(ChangeSetAdd(&set, "report.csv", 10));
+    CHECK(ChangeSetAdd(&set, "report.csv.tmp", 14));
+    CHECK(!ChangeSetAdd(&set, "report.csv", 10));
+    CHECK(ChangeSetAdd(&set, "report", 6));       // Prefix of a stored name
+    CHECK(set.count == 3);
+
+    // Past several table doublings, every name still found once
+    char name[32];
+    for (int round = 0; round < 2; round++)
+    {
+        for (int i = 0; i < 5000; i++)
+        {
+            int n = snprintf(name, sizeof(name), "file-%d", i);
+            CHECK(ChangeSetAdd(&set, name, (size_t)n) == (round == 0));
+        }
+    }
+    CHECK(set.count == 5003);
+    CHECK(!set.overflowed);
+
+    ChangeSetReset(&set);
+    CHECK(set.count == 0);
+    CHECK(ChangeSetAdd(&set, "report.csv", 10));
+    ChangeSetRelease(&set);
+}
+
+static void TestScanAndChangeList(void)
+{
+    char dir[500], sub[600], list[500], line[700], expected[700];
+    snprintf(dir, sizeof(dir), "%s/scan", g_dir);
+    snprintf(sub, sizeof(sub), "%s/nested", dir);
+    snprintf(list, sizeof(list), "%s/changes.txt", g_dir);
+    mkdir(dir, 0700);
+    mkdir(sub, 0700);
+    Touch(dir, "a.txt");
+    Touch(dir, "b.txt");
+
+    ChangeSet set;
+    CHECK(ChangeSetInit(&set));
+    CHECK(ChangeSetScan(&set, dir));
+    CHECK(set.count == 2);                        // Files only
+    CHECK(!ChangeSetAdd(&set, "a.txt", 5));
+
+    CHECK(WriteChangeList(&g_arena, &set, dir, list));
+    FILE* f = fopen(list, "r");
+    int lines = 0, matched = 0;
+    while (f && fgets(line, sizeof(line), f))
+    {
+        lines++;
+        snprintf(expected, sizeof(expected), "%s/a.txt\n", dir);
+        matched += strcmp(line, expected) == 0;
+        snprintf(expected, sizeof(expected), "%s/b.txt\n", dir);
+        matched += strcmp(line, expected) == 0;
+    }
+    if (f)
+        fclose(f);
+    CHECK(lines == 2);
+    CHECK(matched == 2);
+    ChangeSetRelease(&set);
+}
+
+// A burst larger than the OS queue: whatever the events miss, the rescan
+// after an overflow finds
+static void TestBurstNothingLost(void)
+{
+    char dir[500], name[32];
+    snprintf(dir, sizeof(dir), "%s/burst", g_dir);
+    mkdir(dir, 0700);
+
+    PlatWatch watch;
+    CHECK(PlatWatchOpen(&watch, dir));
+    CHECK(PlatWatchWait(&watch, NULL, 0) == PLAT_WAKE_TIMEOUT);
+
+    ChangeSet set;
+    CHECK(ChangeSetInit(&set));
+    for (int i = 0; i < BURST_FILES; i++)
+    {
+        snprintf(name, sizeof(name), "f%05d", i);
+        Touch(dir, name);
+    }
+
+    CHECK(PlatWatchWait(&watch, NULL, 1000) == PLAT_WAKE_EVENTS);
+    bool overflow = false;
+    CHECK(PlatWatchRead(&watch, AddChange, &set, &overflow));
+    if (overflow)
+        CHECK(ChangeSetScan(&set, dir));
+    CHECK(set.count == BURST_FILES);
+
+    // Rewriting a file reports it again, once
+    ChangeSetReset(&set);
+    Touch(dir, "f00042");
+    CHECK(PlatWatchWait(&watch, NULL, 1000) == PLAT_WAKE_EVENTS);
+    CHECK(PlatWatchRead(&watch, AddChange, &set, &overflow));
+    CHECK(!overflow);
+    CHECK(set.count == 1);
+
+    // Removing the directory ends the watch
+    char cmd[600];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", dir);
+    CHECK(system(cmd) == 0);
+    CHECK(PlatWatchWait(&watch, NULL, 1000) == PLAT_WAKE_EVENTS);
+    bool alive = true;
+    for (int i = 0; i < 10 && alive; i++)
+        alive = PlatWatchRead(&watch, AddChange, &set, &overflow);
+    CHECK(!alive);
+    PlatWatchClose(&watch);
+    ChangeSetRelease(&set);
+}
+
+int main(void)
+{
+    char cwd[300];
+    if (!getcwd(cwd, sizeof(cwd)) || !ArenaInit(&g_arena, ARENA_DEFAULT_RESERVE))
+        return 1;
+    snprintf(g_dir, sizeof(g_dir), "%s/watch_scratch", cwd);
+
+    char cmd[600];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", g_dir);
+    if (system(cmd) != 0)
+        return 1;
+    mkdir(g_dir, 0700);
+
+    RUN_TEST(TestChangeSetDedupe);
+    RUN_TEST(TestScanAndChangeList);
+    RUN_TEST(TestBurstNothingLost);
+    ArenaRelease(&g_arena);
+    return TEST_SUMMARY();
+}
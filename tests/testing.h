@@ -0,0 +1,55 @@
+//--------------------------------------------------------------------------
+// TEST HARNESS - Minimal CHECK macros for the core unit tests
+//--------------------------------------------------------------------------
+// Each tests/test_*.c (test_*.cpp for src/cpp) file is its own executable
+// registered with CTest.
+// A test program returns non-zero if any CHECK failed.
+
+#ifndef PS_TESTING_H
+#define PS_TESTING_H
+
+#include <stdio.h>
+
+#include "pstypes.h"
+
+static int g_checks;
+static int g_failures;
+
+#define CHECK(cond)                                                         \
+    do                                                                      \
+    {                                                                       \
+        g_checks++;                                                         \
+        if (!(cond))                                                        \
+        {                                                                   \
+            g_failures++;                                                   \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n",                    \
+                    __FILE__, __LINE__, #cond);                             \
+        }                                                                   \
+    } while (0)
+
+#define CHECK_STR(actual, expected) CHECK(TestStrEq((actual), (expected)))
+
+#define RUN_TEST(fn)                                                        \
+    do                                                                      \
+    {                                                                       \
+        int before = g_failures;                                            \
+        fn();                                                               \
+        printf("%-40s %s\n", #fn, g_failures == before ? "ok" : "FAILED");  \
+    } while (0)
+
+#define TEST_SUMMARY()                                                      \
+    (printf("%d checks, %d failures\n", g_checks, g_failures), g_failures != 0)
+
+static inline int TestStrEq(const PSCHAR* a, const PSCHAR* b)
+{
+    if (!a || !b)
+        return a == b;
+    while (*a && *a == *b)
+    {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+#endif // PS_TESTING_H